@@ -243,6 +243,17 @@ iflag_duplicate=1  # 0=ignore, 1=abort, 2=merge
 
 snid_mucovdump='5944'  # after each fit iteration, full muCOV dump 
 
+nthread=4   # number of threads for data loop in fcn (default=1),
+            #  and to parse TEXT simfile_biascor & simfile_ccprior
+
+cachedir_simfile=<dir>  # binary copy of columns read from biasCor and
+                        # CCprior files; later jobs read it instead
+                        # of the unchanged TEXT file
+
+mngrad=1    # fcn computes analytic gradient; MINUIT checks it first
+mngrad=2    # idem, but MINUIT does not check (SET GRAD 1)
+            #  (ignored with CCprior or 5D biasCor)
+
 
 Default output files (can change names with "prefix" argument)
   SALT2mu.log
@@ -605,6 +616,29 @@ Default output files (can change names with "prefix" argument)
    + refactor biasCor to read comma-separated list of simFile_biasCor 
    + same for CCprior.
 
+ Oct 2026:
+   + new input nthread=<N> to split the fcn data loop among N threads
+     (fcn_data_loop). Each event stores its chi2 terms, which are
+     then summed in data order so that results do not depend on N.
+   + compact SoA copy (FCNDATA) of the data fields read by fcn, loaded
+     before each MINUIT sequence (load_FCNDATA); alpha, beta, muerrsq
+     and mB+alpha*x1-beta*c are computed for all events in a
+     vectorizable kernel (fcn_data_kernel).
+   + new input mngrad=1(2) for analytic chi2 gradient (fcn_grad) 
+     passed to MINUIT with SET GRAD; see prep_fcn_grad for which
+     fit options are supported.
+     For iflag=2, d(dl)/d(cosPar) is interpolated from DCHITAB,
+     tabulated on the DLTAB z-grid once per fcn call.
+   + cosmodl uses tabulated comoving integral from sntools (DLTAB),
+     computed once per cosmology in fcn (prep_cosmodl_DLTAB) instead
+     of a rombint integration for each event.
+   + TEXT biasCor & CCprior files are staged (SNTABLE_STAGE_XXX in
+     sntools_output) if nthread>1 or cachedir_simfile is set: only
+     requested columns are parsed, by nthread threads, without
+     the SNTABLE_NEVT pass. With cachedir_simfile, columns are
+     written to a binary stage file that is read by later jobs
+     if the TEXT file is unchanged (name, size, time stamp).
+
 ******************************************************/
 
 #include <stdio.h>      
@@ -614,6 +648,7 @@ Default output files (can change names with "prefix" argument)
 #include <unistd.h>
 #include <math.h>
 #include <gsl/gsl_fit.h>  // Jun 13 2016
+#include <pthread.h>      // Oct 2026
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -1248,6 +1283,9 @@ struct INPUTS {
 
   char SNID_MUCOVDUMP[40]; // dump MUERR info for this SNID (Jun 2018)
 
+  int nthread ;  // number of threads for fcn data loop (Oct 2026)
+  int mngrad ;   // 1,2 -> analytic gradient with(out) MINUIT check
+  char cachedir_simFile[MXCHAR_FILENAME]; // stage files for biasCor,CCprior
   
 } INPUTS ;
 
@@ -1319,6 +1357,8 @@ struct {
 
   int ISFLOAT_z[MAXBIN_z] ; // 1->floated, vs. z-index
   int ISFLOAT[MAXPAR];      // 1-> floated in fit; 0->fixed, vs. ipar index
+
+  int USE_GRAD ; // 1 -> fcn returns analytic gradient (Oct 2026)
   
 } FITINP ; 
 
@@ -1397,6 +1437,68 @@ void setup_BININFO_logz(void);
 void fcn(int* npar, double grad[], double* fval,
 	 double xval[], int* iflag, void *);
 
+// Oct 2026: inputs/outputs for each thread of the fcn data loop
+#define MXTHREAD_FCN 64
+typedef struct {
+  int    k0, k1 ;        // process FCNDATA rows k0 : k1-1
+  int    iflag ;
+  double *xval, cosPar[NCOSPAR], scalePCC_fitpar ;
+  int    INTERPFLAG_ab ;
+  INTERPWGT_ALPHABETA INTERPWGT ; // private copy for each thread
+  // outputs
+  int    nsnfit, nsnfit_truecc ;
+  double alpha, beta ;   // for last event
+} FCNLOOP_DEF ;
+
+// chi2 terms for each event, summed in data order after the loop
+struct {
+  int    NSN_ALLOC ;
+  int    *use ;
+  double *chi2_tot0, *chi2_tot1, *chi2_1a, *prob_1a, *sqdelta ;
+
+  // for analytic gradient (iflag=2): dchi2/d(delta,alpha,beta)
+  // and dmumodel/dcosPar for each event
+  double *dchi2_ddelta, *dchi2_dalpha, *dchi2_dbeta ;
+  double *dmu_dcosPar[NCOSPAR] ;
+} FCN_EVENT ;
+
+// Oct 2026: d(dflat)/d(cosPar) = int_0^z inc_grad dz, tabulated on
+// the DLTAB z-grid for cosPar and the OL extrapolation points used
+// by cosmodl_forFit; filled by prep_cosmodl_DLTAB for iflag=2.
+#define MXTAB_DCHI 3
+struct {
+  int    NTAB, NZBIN_ALLOC ;
+  double COSPAR[MXTAB_DCHI][NCOSPAR] ;
+  int    MASK[MXTAB_DCHI][NCOSPAR] ;
+  double *DCHI[MXTAB_DCHI][NCOSPAR] ; // at z = iz*DLTAB.ZBIN
+} DCHITAB ;
+
+// Compact structure-of-arrays copy of data[] fields read by fcn;
+// one row per event with skipfit=0. Loaded by load_FCNDATA before
+// each MINUIT fit sequence since skipfit, covmat_tot & muerrsq_last
+// change only between fits.
+struct {
+  int    NSN ;          // FITINP.NSNCUTS at load time
+  int    NROW, NROW_ALLOC ;
+  int    *isn ;         // data index for each row
+  double *z, *mB, *x1, *c, *logmass ;
+  double *COV[NLCPAR][NLCPAR] ;   // covmat_tot
+  double *dmuzsq, *dmuLenssq ;    // muerr^2 from zerr and lensing
+
+  // computed in fcn_data_kernel for each fcn call
+  double *VEC[NLCPAR] ;           // 1, alpha, -beta
+  double *alpha, *beta, *muerrsq ; // alpha = VEC[1]
+  double *mu_raw ;      // mB + alpha*x1 - beta*c
+} FCNDATA ;
+
+void  fcn_data_loop(FCNLOOP_DEF *LOOP) ;
+void  fcn_data_kernel(int k0, int k1, double *xval) ;
+void *fcn_data_thread(void *arg) ;
+void  malloc_FCN_EVENT(int NSN) ;
+void  load_FCNDATA(void);
+void  prep_fcn_grad(void);
+void  fcn_grad(double *xval, double *grad);
+
 void fitsc(int n,double *s, double *c);
 void parse_parFile(char *parFile );
 void override_parFile(int argc, char **argv);
@@ -1502,6 +1604,7 @@ int   storeDataBias(int n, int dumpFlag ) ;
 int   biasMapSelect(int i) ;
 void  dumpStages_biasMapSelect(void);
 void  read_simFile_biasCor(void);
+int   use_stage_simFile(int NFILE, char **simFile);
 void  prep_biasCor_misc(void);
 void  set_MAPCELL_biasCor(int IDSAMPLE) ;
 void  store_iaib_biasCor(void) ;
@@ -1563,6 +1666,14 @@ void    recalc_dataCov();
 double cosmodl_forFit(double z, double *cosPar);
 double cosmodl(double z, double *cosPar);
 double inc    (double z, double *cosPar);
+double dflat_cosmodl(double z, double *cosPar);
+void   prep_cosmodl_DLTAB(double *cosPar, int DO_GRAD);
+void   fill_DCHITAB(double *cosPar, int *MASK);
+double dchi_cosmodl(double z, double *cosPar, int ipar);
+void   cosmodl_forFit_grad(double z, double *cosPar, int *MASK, 
+			   double *dl_grad);
+void   cosmodl_grad(double z, double *cosPar, int *MASK, double *dl_grad);
+double inc_grad(double z, double *cosPar);
 
 void gengauss(double r[2]);
 void ludcmp(double* a, const int n, const int ndim, int* indx, 
@@ -1575,6 +1686,7 @@ double rombint(double f(double z, double *cosPar),
 double avemag0_calc(int opt_dump);
 void   M0dif_calc(void) ;
 double fcn_M0(int n, double *M0LIST );
+int    fcn_M0_zbins(int n, int *iz0, int *iz1, double *zfrac);
 
 void   printCOVMAT(int NPAR);
 double fcn_muerrsq(char *name,double alpha,double beta,
@@ -1768,6 +1880,8 @@ int main(int argc,char* argv[ ])
   // Beginning of DOFIT loop
   while ( DOFIT_FLAG != FITFLAG_DONE  ) {
 
+    load_FCNDATA(); // compact copy of data for fcn (Oct 2026)
+
     if ( NOMNPRI ) 
       { strcpy(mcom,"SET PRI -1"); } // turn off MINUIT printing
     else
@@ -1939,6 +2053,18 @@ void exec_mnparm(void) {
     }
   }
 
+  // Oct 2026: optional analytic gradient
+  prep_fcn_grad();
+  if ( FITINP.USE_GRAD ) {
+    load_FCNDATA(); // SET GRAD without force calls fcn to check grad
+    if ( INPUTS.mngrad == 2 ) 
+      { sprintf(text,"SET GRAD 1"); } // no check
+    else
+      { sprintf(text,"SET GRAD"); } 
+    len = strlen(text);
+    mncomd_(fcn, text, &icondn, &null, len);
+  }
+
   fflush(stdout);
 
   // Jan 2018: after passing param names to MINIUT, remove blank
@@ -2872,26 +2998,24 @@ void fcn(int *npar, double grad[], double *fval, double xval[],
 	 int *iflag, void *not)
 {
   //c flat=1 read input, flag 2=gradient, flag=3 is final value
-  double M0, alpha, beta, alpha0, beta0, da_dz, db_dz, da_dm, db_dm ;
-  double scalePCC, scalePCC_fitpar, nsnfit1a, afix, bfix ;
-  int i, n, errmask, nsnfit, nsnfit_truecc, idsample ;
-  int DOBIASCOR_1D, DOBIASCOR_5D, DUMPFLAG=0, dumpFlag_muerrsq=0 ;
-  double chi2sum_tot, delta, sqdelta, hrms_sum;
-  double muerrsq, muerrsq_last, muerrsq_raw, muerrsq_tmp, sqsigCC=0.001 ;
-  double chi2, chi2_1a, chi2sum_1a, sigCC_chi2penalty=0.0 ;
-  double mb, s, c, z, zerr, logmass;
-  double dl, mumodel, muBias, muBiasErr, muCOVscale, magoff_host ;
-  double muerr, muerr_raw, muerr_last, COVINT[NLCPAR][NLCPAR] ;
-  int    ipar,  INTERPFLAG_ab;
+  //
+  // Oct 2026: data loop moved to fcn_data_loop, which can run in
+  //           INPUTS.nthread threads. Chi2 terms are stored for each
+  //           event and summed here in data order, so that the result
+  //           is identical for any number of threads.
+  // Oct 2026: if FITINP.USE_GRAD, return analytic grad for iflag=2.
+
+  double alpha, beta, alpha0, beta0 ;
+  double scalePCC_fitpar, nsnfit1a ;
+  int i, n, nsnfit, nsnfit_truecc, idsample ;
+  double chi2sum_tot, hrms_sum, chi2sum_1a ;
+  int    INTERPFLAG_ab, NTHREAD, ithread, NSN, NROW, NROW_THREAD, istat ;
   double omega_l, omega_k, wde, wa, cosPar[NCOSPAR] ;
-  double *hostPar, gamma0, gamma1, logmass_cen, logmass_tau ;
-  double ProbRatio_1a, ProbRatio_CC, betaTmp ;
-  char   *name ;
 
-  BIASCORLIST_DEF     BIASCORLIST ;
   INTERPWGT_ALPHABETA INTERPWGT ;
+  FCNLOOP_DEF  LOOP[MXTHREAD_FCN] ;
+  pthread_t    THREAD[MXTHREAD_FCN] ;
   int NSAMPLE = NSAMPLE_BIASCOR ;
-  int IVAR_GAMMA = rawdata.ICUTWIN_GAMMA ;
   char fnam[]= "fcn";
 
   // --------------- BEGIN -------------
@@ -2902,26 +3026,12 @@ void fcn(int *npar, double grad[], double *fval, double xval[],
 
   alpha0       = xval[1];
   beta0        = xval[2];
-  da_dz        = xval[3];
-  db_dz        = xval[4];
-  gamma0       = xval[5];
-  gamma1       = xval[6];
-  logmass_cen  = xval[7];
-  logmass_tau  = xval[8];
   omega_l      = xval[9];
   omega_k      = xval[10];
   wde          = xval[11];
   wa           = xval[12];
   scalePCC_fitpar  = xval[13] ;
 
-  da_dm        = xval[15];  // added Apr 2 2018
-  db_dm        = xval[16];  // idem
-
-  DOBIASCOR_1D = ( INPUTS.opt_biasCor & MASK_BIASCOR_1DZ );
-  DOBIASCOR_5D = ( INPUTS.opt_biasCor & MASK_BIASCOR_5D  );
-	
-  hostPar = &xval[IPAR_GAMMA0];
-
   /*
   // xxxxxxxxx
   if ( (ncall_fcn > 1000 && ncall_fcn < 1065) || ncall_fcn<10 ) {
@@ -2939,6 +3049,10 @@ void fcn(int *npar, double grad[], double *fval, double xval[],
   cosPar[2] = wde ;
   cosPar[3] = wa ;
 
+  // tabulate dl(z) once for all events (Oct 2026)
+  if ( INPUTS.FLOAT_COSPAR ) 
+    { prep_cosmodl_DLTAB(cosPar, (*iflag==2 && FITINP.USE_GRAD) ); }
+
   // -------------------------------
   if ( simdata_ccprior.USE > 0 ) {   
 
@@ -2965,7 +3079,6 @@ void fcn(int *npar, double grad[], double *fval, double xval[],
 	{ simdata_ccprior.MUZMAP.H11_fitpar[i] = xval[IPAR_H11+i] ; }
     }
 
-    ProbRatio_1a = ProbRatio_CC = 0.0 ;
   }
 
   // -------------------------------
@@ -2987,20 +3100,204 @@ void fcn(int *npar, double grad[], double *fval, double xval[],
 
 
   // -------------------------------
+  FITRESULT.NSNFIT = 0;
+  FITRESULT.NSNFIT_TRUECC = 0;
+  FITRESULT.HRMS   = 0.0;
+
+  NSN = FITINP.NSNCUTS ;
+  if ( FCNDATA.NSN != NSN ) { load_FCNDATA(); }
+  NROW = FCNDATA.NROW ;
+  malloc_FCN_EVENT(NSN);
+  for(n=0; n < NSN; n++ ) { FCN_EVENT.use[n] = 0 ; }
+
+  // final pass (iflag=3) stores extra info & dumps; keep it serial
+  NTHREAD = INPUTS.nthread ;
+  if ( *iflag == 3       ) { NTHREAD = 1; }
+  if ( NTHREAD > NROW    ) { NTHREAD = NROW; }
+  if ( NTHREAD < 1       ) { NTHREAD = 1; }
+  NROW_THREAD = (NROW + NTHREAD - 1) / NTHREAD ;
+
+  for(ithread=0; ithread < NTHREAD; ithread++ ) {
+    LOOP[ithread].k0    = ithread * NROW_THREAD ;
+    LOOP[ithread].k1    = LOOP[ithread].k0 + NROW_THREAD ;
+    if ( LOOP[ithread].k1 > NROW ) { LOOP[ithread].k1 = NROW; }
+    LOOP[ithread].iflag = *iflag ;
+    LOOP[ithread].xval  = xval ;
+    for(i=0; i < NCOSPAR; i++ ) { LOOP[ithread].cosPar[i] = cosPar[i]; }
+    LOOP[ithread].scalePCC_fitpar = scalePCC_fitpar ;
+    LOOP[ithread].INTERPFLAG_ab   = INTERPFLAG_ab ;
+    LOOP[ithread].INTERPWGT       = INTERPWGT ;
+  }
+
+  if ( NTHREAD == 1 ) 
+    { fcn_data_loop(&LOOP[0]); }
+  else {
+    for(ithread=0; ithread < NTHREAD; ithread++ ) {
+      istat = pthread_create(&THREAD[ithread], NULL, 
+			     fcn_data_thread, &LOOP[ithread]);
+      if ( istat != 0 ) {
+	sprintf(c1err,"pthread_create returned %d for ithread=%d", 
+		istat, ithread);
+	sprintf(c2err,"Try smaller nthread (=%d)", NTHREAD);
+	errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+      }
+    }
+    for(ithread=0; ithread < NTHREAD; ithread++ ) 
+      { pthread_join(THREAD[ithread], NULL); }
+  }
+
+  // -------------------------------
+  // sum chi2 terms in data order
   chi2sum_tot = chi2sum_1a = 0.0;
   nsnfit      = nsnfit_truecc = 0 ;
   nsnfit1a = 0.0 ;
   hrms_sum  = 0.0 ;
+  alpha = beta = 0.0 ;
+
+  for(ithread=0; ithread < NTHREAD; ithread++ ) {
+    nsnfit        += LOOP[ithread].nsnfit ;
+    nsnfit_truecc += LOOP[ithread].nsnfit_truecc ;
+  }
+  alpha = LOOP[NTHREAD-1].alpha ;
+  beta  = LOOP[NTHREAD-1].beta ;
+
+  for (n=0; n < NSN; ++n)  {
+    if ( FCN_EVENT.use[n] == 0 ) { continue ; }
+    chi2sum_tot += FCN_EVENT.chi2_tot0[n] ;
+    chi2sum_tot += FCN_EVENT.chi2_tot1[n] ;
+    chi2sum_1a  += FCN_EVENT.chi2_1a[n] ;
+    if ( simdata_ccprior.USE > 0 ) 
+      { nsnfit1a += FCN_EVENT.prob_1a[n] ; }
+    else
+      { hrms_sum += FCN_EVENT.sqdelta[n] ; }
+  }
+  if ( simdata_ccprior.USE == 0 ) { nsnfit1a = (double)nsnfit ; }
 
-  FITRESULT.NSNFIT = 0;
-  FITRESULT.NSNFIT_TRUECC = 0;
-  FITRESULT.HRMS   = 0.0;
+  if ( *iflag == 2 && FITINP.USE_GRAD ) { fcn_grad(xval, grad); }
 
-  for (n=0; n<FITINP.NSNCUTS; ++n)  {
 
-    errmask = data[n].errmask ;
+  // ===============================================
+  // ============= WRAP UP =========================
+  // ===============================================
 
-    if ( data[n].skipfit ) { continue ; }
+  FITRESULT.NSNFIT        = nsnfit ;
+  FITRESULT.NSNFIT_TRUECC = nsnfit_truecc ;
+  FITRESULT.NSNFIT_SPLITRAN[NJOB_SPLITRAN] = nsnfit ;
+  
+  if (*iflag==3)  { // done with fit
+    FITRESULT.HRMS = sqrt(hrms_sum/nsnfit); 
+    FITRESULT.CHI2SUM_1A = chi2sum_1a ;
+    FITRESULT.CHI2RED_1A = chi2sum_1a/(double)(nsnfit1a-FITINP.NFITPAR_FLOAT) ;
+    FITRESULT.NSNFIT_1A  = nsnfit1a ; 
+    FITRESULT.ALPHA      = alpha ;
+    FITRESULT.BETA       = beta ;
+  }
+
+  *fval = chi2sum_tot;
+
+  return;
+
+}    // end of fcn
+
+
+// ******************************************
+void malloc_FCN_EVENT(int NSN) {
+
+  // Created Oct 2026
+  // Allocate per-event chi2 terms used by fcn.
+
+  int MEMD = NSN * sizeof(double);
+  int MEMI = NSN * sizeof(int);
+  int i ;
+
+  if ( NSN <= FCN_EVENT.NSN_ALLOC ) { return ; }
+
+  if ( FCN_EVENT.NSN_ALLOC > 0 ) {
+    free(FCN_EVENT.use);     free(FCN_EVENT.chi2_tot0);
+    free(FCN_EVENT.chi2_tot1);  free(FCN_EVENT.chi2_1a);
+    free(FCN_EVENT.prob_1a); free(FCN_EVENT.sqdelta);
+    free(FCN_EVENT.dchi2_ddelta);  free(FCN_EVENT.dchi2_dalpha);
+    free(FCN_EVENT.dchi2_dbeta);
+    for(i=0; i < NCOSPAR; i++ ) { free(FCN_EVENT.dmu_dcosPar[i]); }
+  }
+
+  FCN_EVENT.use       = (int   *) malloc(MEMI);
+  FCN_EVENT.chi2_tot0 = (double*) malloc(MEMD);
+  FCN_EVENT.chi2_tot1 = (double*) malloc(MEMD);
+  FCN_EVENT.chi2_1a   = (double*) malloc(MEMD);
+  FCN_EVENT.prob_1a   = (double*) malloc(MEMD);
+  FCN_EVENT.sqdelta   = (double*) malloc(MEMD);
+  FCN_EVENT.dchi2_ddelta = (double*) malloc(MEMD);
+  FCN_EVENT.dchi2_dalpha = (double*) malloc(MEMD);
+  FCN_EVENT.dchi2_dbeta  = (double*) malloc(MEMD);
+  for(i=0; i < NCOSPAR; i++ ) 
+    { FCN_EVENT.dmu_dcosPar[i] = (double*) malloc(MEMD); }
+  FCN_EVENT.NSN_ALLOC = NSN ;
+
+} // end malloc_FCN_EVENT
+
+
+// ******************************************
+void *fcn_data_thread(void *arg) {
+  // Oct 2026: pthread wrapper
+  fcn_data_loop( (FCNLOOP_DEF*)arg );
+  return(NULL);
+} 
+
+
+// ******************************************
+void fcn_data_loop(FCNLOOP_DEF *LOOP) {
+
+  // Created Oct 2026 (moved from fcn)
+  // Loop over FCNDATA rows LOOP->k0 : LOOP->k1-1 and store chi2 terms 
+  // for each event in FCN_EVENT; fcn sums them after all threads finish.
+  // Only data[n], FCN_EVENT[n] and FCNDATA[k] are written here, so 
+  // that different threads do not touch the same memory.
+  // Alpha, beta, muerrsq and mB+alpha*x1-beta*c are first computed
+  // for all rows in fcn_data_kernel.
+
+  double *xval = LOOP->xval ;
+  double *cosPar = LOOP->cosPar ;
+  double M0, alpha=0.0, beta=0.0, scalePCC, scalePCC_fitpar ;
+  int n, k, errmask, idsample ;
+  int DOBIASCOR_1D, DOBIASCOR_5D, DUMPFLAG=0, dumpFlag_muerrsq=0 ;
+  double delta, sqdelta;
+  double muerrsq, muerrsq_last, muerrsq_raw, muerrsq_tmp, sqsigCC=0.001 ;
+  double chi2, chi2_1a, sigCC_chi2penalty=0.0 ;
+  double z, zerr;
+  double dl, mumodel, muBias, muBiasErr, muCOVscale, magoff_host ;
+  double muerr, muerr_raw, muerr_last ;
+  int    ipar,  INTERPFLAG_ab;
+  double *hostPar ;
+  double ProbRatio_1a ;
+  char   *name ;
+
+  BIASCORLIST_DEF     BIASCORLIST ;
+  INTERPWGT_ALPHABETA *INTERPWGT = &LOOP->INTERPWGT ;
+  char fnam[]= "fcn_data_loop";
+
+  // --------------- BEGIN -------------
+
+  scalePCC_fitpar = LOOP->scalePCC_fitpar ;
+  INTERPFLAG_ab   = LOOP->INTERPFLAG_ab ;
+
+  DOBIASCOR_1D = ( INPUTS.opt_biasCor & MASK_BIASCOR_1DZ );
+  DOBIASCOR_5D = ( INPUTS.opt_biasCor & MASK_BIASCOR_5D  );
+	
+  hostPar = &xval[IPAR_GAMMA0];
+
+  LOOP->nsnfit = LOOP->nsnfit_truecc = 0 ;
+
+  fcn_data_kernel(LOOP->k0, LOOP->k1, xval);
+
+  for (k=LOOP->k0; k < LOOP->k1; ++k)  {
+
+    n = FCNDATA.isn[k] ;
+    FCN_EVENT.chi2_tot0[n] = FCN_EVENT.chi2_tot1[n] = 0.0 ;
+    FCN_EVENT.chi2_1a[n]   = FCN_EVENT.prob_1a[n]   = 0.0 ;
+    FCN_EVENT.sqdelta[n]   = 0.0 ;
+
+    errmask = data[n].errmask ;
 
     data[n].mures   = -999. ;
     data[n].pull    = -999. ;
@@ -3008,21 +3305,17 @@ void fcn(int *npar, double grad[], double *fval, double xval[],
     data[n].muerr   = -999. ;    
     data[n].muerr_raw = -999. ;  // no scale and no sigInt
 
-    z       = data[n].zhd;    if(z<1.0E-8) {continue ;} // Jun 3 2013
+    z       = FCNDATA.z[k];    if(z<1.0E-8) {continue ;} // Jun 3 2013
     zerr    = data[n].zhderr ;
-    mb      = data[n].fitpar[INDEX_mB];
-    s       = data[n].fitpar[INDEX_x1];
-    c       = data[n].fitpar[INDEX_c];
-    //    logmass = data[n].host_logmass ;
-    logmass = rawdata.CUTVAL[IVAR_GAMMA][n] ;  // Jan 20, 2019
 
     name     = data[n].name ;
     idsample = data[n].idsample ;
 
-    fcn_AlphaBeta(xval, z, logmass, &alpha, &beta); // return alpha,beta
+    alpha   = FCNDATA.alpha[k] ;  // from fcn_data_kernel
+    beta    = FCNDATA.beta[k] ;
 
     // for z-dependent alpha,beta, interpolate each event
-    if (INTERPFLAG_ab==2) { fcn_AlphaBetaWGT(alpha,beta,0,&INTERPWGT,fnam); }
+    if (INTERPFLAG_ab==2) { fcn_AlphaBetaWGT(alpha,beta,0,INTERPWGT,fnam); }
 
     // get mag offset for this z-bin
     M0    = fcn_M0(n, &xval[MXCOSPAR] );
@@ -3036,9 +3329,13 @@ void fcn(int *npar, double grad[], double *fval, double xval[],
       { mumodel = data[n].mumodel ; }
 
 
-    // compute error-squared on distance mod
-    muerrsq  = fcn_muerrsq(name, alpha, beta, data[n].covmat_tot,
-			   z, zerr, 0);
+    // error-squared on distance mod (from fcn_data_kernel)
+    muerrsq  = FCNDATA.muerrsq[k] ;
+    if (muerrsq  <= 0.0 )  {
+      sprintf(c1err,"non-positive muerrsq = %le", muerrsq);	
+      sprintf(c2err,"for SN = %s  alpha=%f  beta=%f", name, alpha, beta );
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    }
        
     // add optional user-input sigma_int (July 5 2018)    
     // xxx    muerrsq += SNDATA_INFO.sqsigint_fix[idsample]; 
@@ -3059,7 +3356,7 @@ void fcn(int *npar, double grad[], double *fval, double xval[],
       get_muBias(name, &BIASCORLIST,           // (I) misc inputs
 		 data[n].FITPARBIAS_ALPHABETA, // (I) bias at each a,b
 		 data[n].MUCOVSCALE_ALPHABETA, // (I) muCOVscale at each a,b
-		 &INTERPWGT,             // (I) wgt at each a,b grid point
+		 INTERPWGT,              // (I) wgt at each a,b grid point
 		 data[n].fitParBias,     // (O) interp bias on mB,x1,c
 		 &muBias,        // (O) interp bias on mu
 		 &muBiasErr,     // (O) stat-error on above
@@ -3087,7 +3384,7 @@ void fcn(int *npar, double grad[], double *fval, double xval[],
 	
     // ------------------------
 
-    delta    = mb  + alpha*s - beta*c;
+    delta    = FCNDATA.mu_raw[k] ;  // mb + alpha*s - beta*c
     //    delta   += s*s*zeta + s*c*eta + c*c*theta; // leftover from J.M. ??
     delta   -= muBias ;     // bias correction (Jun 2016)
     delta   += magoff_host;  // correct SN mag based on host (Sep 2016)
@@ -3121,17 +3418,48 @@ void fcn(int *npar, double grad[], double *fval, double xval[],
 
     if ( errmask == 0  && simdata_ccprior.USE == 0 ) {
       // original SALT2mu chi2 with only spec-confirmed SNIa 
-      nsnfit++ ;        nsnfit1a  = (double)nsnfit ;
-      hrms_sum       += sqdelta ;    
+      LOOP->nsnfit++ ;
+      FCN_EVENT.use[n]     = 1 ;
+      FCN_EVENT.sqdelta[n] = sqdelta ;    
 
       chi2_1a       = sqdelta/muerrsq ;
       chi2          = sqdelta/muerrsq ;
-      chi2sum_1a   += chi2_1a ;
-      chi2sum_tot  += chi2 ;
+      FCN_EVENT.chi2_1a[n]   = chi2_1a ;
+      FCN_EVENT.chi2_tot0[n] = chi2 ;
 
       // check option to add log(sigma) term for 5D biasCor
       if ( INPUTS.fitflag_sigmb == 2 ) 
-      	{ chi2sum_tot  += log(muerrsq/muerrsq_last); }
+      	{ FCN_EVENT.chi2_tot1[n] = log(muerrsq/muerrsq_last); }
+
+      if ( LOOP->iflag == 2 && FITINP.USE_GRAD ) {
+	// dchi2/dmuerrsq, and dmuerrsq/d(alpha,beta) from 
+	// MUERRSQ = (1,a,-b) x COV x (1,a,-b)
+	double dchi2_dsq, dsq_da=0.0, dsq_db=0.0 ;
+	int    j ;
+	dchi2_dsq = -sqdelta/(muerrsq*muerrsq) ;
+	if ( INPUTS.fitflag_sigmb == 2 ) { dchi2_dsq += 1.0/muerrsq ; }
+	for(j=0; j < NLCPAR; j++ ) {
+	  dsq_da += (FCNDATA.COV[1][j][k] + FCNDATA.COV[j][1][k]) * 
+	    FCNDATA.VEC[j][k] ;
+	  dsq_db -= (FCNDATA.COV[2][j][k] + FCNDATA.COV[j][2][k]) * 
+	    FCNDATA.VEC[j][k] ;
+	}
+	dsq_da *= muCOVscale ;  dsq_db *= muCOVscale ;
+
+	FCN_EVENT.dchi2_ddelta[n] = 2.0*delta/muerrsq ;
+	FCN_EVENT.dchi2_dalpha[n] = 
+	  FCN_EVENT.dchi2_ddelta[n]*FCNDATA.x1[k] + dchi2_dsq*dsq_da ;
+	FCN_EVENT.dchi2_dbeta[n]  = 
+	  -FCN_EVENT.dchi2_ddelta[n]*FCNDATA.c[k] + dchi2_dsq*dsq_db ;
+
+	if ( INPUTS.FLOAT_COSPAR ) {
+	  double dl_grad[NCOSPAR];
+	  cosmodl_forFit_grad(z, LOOP->cosPar, &FITINP.ISFLOAT[IPAR_OL],
+			      dl_grad);
+	  for(j=0; j < NCOSPAR; j++ ) 
+	    { FCN_EVENT.dmu_dcosPar[j][n] = 5.0*dl_grad[j]/(LOGTEN*dl); }
+	}
+      }
 
     } // end of errmask==0 loop
 
@@ -3143,7 +3471,8 @@ void fcn(int *npar, double grad[], double *fval, double xval[],
       double muerrsq_update, muerr_update ;
       DUMPFLAG = (n == -44);
 
-      nsnfit++ ;
+      LOOP->nsnfit++ ;
+      FCN_EVENT.use[n] = 1 ;
       scalePCC = scalePCC_fitpar ;
 
       PTOTRAW_1a  = data[n].pIa ;       // NN_PROB_Ia
@@ -3196,23 +3525,22 @@ void fcn(int *npar, double grad[], double *fval, double xval[],
       // sum total chi2 that includes Ia + CC
       if ( Prob_SUM > 0.0 ) {
 	ProbRatio_1a = Prob_1a / Prob_SUM ;
-	ProbRatio_CC = Prob_CC / Prob_SUM ;
-	nsnfit1a   +=  ProbRatio_1a ; 
-	chi2sum_1a += (ProbRatio_1a * chi2_1a) ; 
+	FCN_EVENT.prob_1a[n] = ProbRatio_1a ; 
+	FCN_EVENT.chi2_1a[n] = (ProbRatio_1a * chi2_1a) ; 
 
 	Prob_SUM    *= (0.15/PIFAC)  ;  
-	chi2sum_tot += ( -2.0*log(Prob_SUM) ) ;
+	FCN_EVENT.chi2_tot0[n] = ( -2.0*log(Prob_SUM) ) ;
 	//  chi2sum_tot += sigCC_chi2penalty ; // prevent sigCC<0 (7.17.2018)
       }
       else {
-	chi2sum_tot += 1.0E8 ;
+	FCN_EVENT.chi2_tot0[n] = 1.0E8 ;
       }
 
     } // end CCprios.USE if block
 
 
     // check things on final pass
-    if ( errmask == 0 && *iflag==3 ) {
+    if ( errmask == 0 && LOOP->iflag==3 ) {
 	
       // Jan 26 2018: store raw muerr without intrinsic cov
       muerrsq_raw = fcn_muerrsq(name,alpha,beta, data[n].covmat_fit,
@@ -3229,7 +3557,7 @@ void fcn(int *npar, double grad[], double *fval, double xval[],
       data[n].muerr_raw = muerr_raw ;
     
       if ( FOUNDKEY_SIM  ) {
-	if ( data[n].sim_nonIa_index>0) { nsnfit_truecc++ ; }
+	if ( data[n].sim_nonIa_index>0) { LOOP->nsnfit_truecc++ ; }
       }
 
       // store reference errors for 1/sigma term
@@ -3246,29 +3574,311 @@ void fcn(int *npar, double grad[], double *fval, double xval[],
 	  
   } // end loop over SN
 
+  LOOP->alpha = alpha ;
+  LOOP->beta  = beta ;
 
-  // ===============================================
-  // ============= WRAP UP =========================
-  // ===============================================
+  return ;
 
-  FITRESULT.NSNFIT        = nsnfit ;
-  FITRESULT.NSNFIT_TRUECC = nsnfit_truecc ;
-  FITRESULT.NSNFIT_SPLITRAN[NJOB_SPLITRAN] = nsnfit ;
-  
-  if (*iflag==3)  { // done with fit
-    FITRESULT.HRMS = sqrt(hrms_sum/nsnfit); 
-    FITRESULT.CHI2SUM_1A = chi2sum_1a ;
-    FITRESULT.CHI2RED_1A = chi2sum_1a/(double)(nsnfit1a-FITINP.NFITPAR_FLOAT) ;
-    FITRESULT.NSNFIT_1A  = nsnfit1a ; 
-    FITRESULT.ALPHA      = alpha ;
-    FITRESULT.BETA       = beta ;
+} // end fcn_data_loop
+
+
+// ******************************************
+void fcn_data_kernel(int k0, int k1, double *xval) {
+
+  // Created Oct 2026
+  // For FCNDATA rows k0 : k1-1, compute alpha, beta (as in
+  // fcn_AlphaBeta), muerrsq (as in fcn_muerrsq) and 
+  // mu_raw = mB + alpha*x1 - beta*c. Loops run over contiguous 
+  // arrays with no function calls, so that compiler can vectorize.
+  // Arithmetic order is the same as in the scalar functions.
+
+  double a0          = xval[1] ; // alpha0
+  double b0          = xval[2] ; // beta0
+  double da_dz       = xval[3] ; // dalpha/dz
+  double db_dz       = xval[4] ; // dbeta/dz
+  double aHost       = xval[15]; // dalpha/dlog(Mhost)
+  double bHost       = xval[16]; // dbeta/dlog(Mhost)
+  double logmass_cen = xval[7];  // log(Msplit) for gamma0
+
+  double *z       = FCNDATA.z ;
+  double *logmass = FCNDATA.logmass ;
+  double *alpha   = FCNDATA.alpha ;
+  double *beta    = FCNDATA.beta ;
+  double *mbeta   = FCNDATA.VEC[2] ;  // -beta
+  double *muerrsq = FCNDATA.muerrsq ;
+  double *VECi, *VECj, *COVij, dlogmass ;
+  int    k, i, j, OPT_LOGMASS_SLOPE=0, OPT_LOGMASS_SPLIT=0 ;
+
+  // ------------ BEGIN -------------
+
+  if ( INPUTS.ipar[15]<=1 || INPUTS.ipar[16]<=1 ) 
+    { OPT_LOGMASS_SLOPE = 1; }
+
+  if ( INPUTS.ipar[15]==2 || INPUTS.ipar[16]==2 ) 
+    { OPT_LOGMASS_SPLIT = 1; }
+
+  for(k=k0; k < k1; k++ ) {
+    alpha[k] = a0 + z[k]*da_dz ;
+    beta[k]  = b0 + z[k]*db_dz ;
   }
 
-  *fval = chi2sum_tot;
+  if ( OPT_LOGMASS_SLOPE ) {
+    for(k=k0; k < k1; k++ ) {
+      dlogmass  = logmass[k] - logmass_cen ;
+      alpha[k] += (aHost * dlogmass ) ; 
+      beta[k]  += (bHost * dlogmass ) ;
+    }
+  }
 
-  return;
+  if ( OPT_LOGMASS_SPLIT ) {
+    for(k=k0; k < k1; k++ ) {
+      dlogmass  = logmass[k] - logmass_cen ;
+      if ( dlogmass > 0.0 ) 
+	{ alpha[k] += aHost/2;  beta[k] += bHost/2.0; }
+      else
+	{ alpha[k] -= aHost/2;  beta[k] -= bHost/2.0; }
+    }
+  }
 
-}    // end of fcn
+  // MUERRSQ = (1,a,-b) x COV x (1,a,-b)
+  for(k=k0; k < k1; k++ ) { mbeta[k] = -beta[k];  muerrsq[k] = 0.0 ; }
+
+  for(i=0; i < NLCPAR; i++ ) {
+    VECi = FCNDATA.VEC[i] ;
+    for(j=0; j < NLCPAR; j++ ) {
+      VECj  = FCNDATA.VEC[j] ;
+      COVij = FCNDATA.COV[i][j] ;
+      for(k=k0; k < k1; k++ ) 
+	{ muerrsq[k] += VECj[k] * COVij[k] * VECi[k] ; }
+    }
+  }
+
+  for(k=k0; k < k1; k++ ) {
+    muerrsq[k] += FCNDATA.dmuzsq[k] ;
+    muerrsq[k] += FCNDATA.dmuLenssq[k] ;
+    FCNDATA.mu_raw[k] = FCNDATA.mB[k] + alpha[k]*FCNDATA.x1[k] 
+      - beta[k]*FCNDATA.c[k] ;
+  }
+
+  return ;
+
+} // end fcn_data_kernel
+
+
+// ******************************************
+void load_FCNDATA(void) {
+
+  // Created Oct 2026
+  // Load compact SoA copy (FCNDATA) of data fields used in fcn,
+  // one row per event with skipfit=0. Called before each MINUIT
+  // sequence because skipfit, covmat_tot and muerrsq_last can 
+  // change between fits.
+
+  int NSN  = FITINP.NSNCUTS ;
+  int MEMD = NSN * sizeof(double) ;
+  int IVAR_GAMMA = rawdata.ICUTWIN_GAMMA ;
+  int n, k, i, j ;
+  double z, zerr, dmuz, dmuLens ;
+
+  // ------------ BEGIN -------------
+
+  if ( NSN > FCNDATA.NROW_ALLOC ) {
+    if ( FCNDATA.NROW_ALLOC > 0 ) {
+      free(FCNDATA.isn);  free(FCNDATA.z);  free(FCNDATA.mB);
+      free(FCNDATA.x1);   free(FCNDATA.c);  free(FCNDATA.logmass);
+      free(FCNDATA.dmuzsq);  free(FCNDATA.dmuLenssq);
+      free(FCNDATA.beta);    free(FCNDATA.muerrsq);  
+      free(FCNDATA.mu_raw);
+      for(i=0; i < NLCPAR; i++ ) {
+	free(FCNDATA.VEC[i]);
+	for(j=0; j < NLCPAR; j++ ) { free(FCNDATA.COV[i][j]); }
+      }
+    }
+
+    FCNDATA.isn       = (int*)malloc( NSN * sizeof(int) );
+    FCNDATA.z         = (double*)malloc(MEMD);
+    FCNDATA.mB        = (double*)malloc(MEMD);
+    FCNDATA.x1        = (double*)malloc(MEMD);
+    FCNDATA.c         = (double*)malloc(MEMD);
+    FCNDATA.logmass   = (double*)malloc(MEMD);
+    FCNDATA.dmuzsq    = (double*)malloc(MEMD);
+    FCNDATA.dmuLenssq = (double*)malloc(MEMD);
+    FCNDATA.beta      = (double*)malloc(MEMD);
+    FCNDATA.muerrsq   = (double*)malloc(MEMD);
+    FCNDATA.mu_raw    = (double*)malloc(MEMD);
+    for(i=0; i < NLCPAR; i++ ) {
+      FCNDATA.VEC[i] = (double*)malloc(MEMD);
+      for(j=0; j < NLCPAR; j++ ) 
+	{ FCNDATA.COV[i][j] = (double*)malloc(MEMD); }
+    }
+    FCNDATA.alpha      = FCNDATA.VEC[1] ;
+    FCNDATA.NROW_ALLOC = NSN ;
+  }
+
+  k = 0 ;
+  for(n=0; n < NSN; n++ ) {
+    if ( data[n].skipfit ) { continue ; }
+
+    z    = data[n].zhd ;
+    zerr = data[n].zhderr ;
+    FCNDATA.isn[k]     = n ;
+    FCNDATA.z[k]       = z ;
+    FCNDATA.mB[k]      = data[n].fitpar[INDEX_mB] ;
+    FCNDATA.x1[k]      = data[n].fitpar[INDEX_x1] ;
+    FCNDATA.c[k]       = data[n].fitpar[INDEX_c] ;
+    FCNDATA.logmass[k] = rawdata.CUTVAL[IVAR_GAMMA][n] ;
+    FCNDATA.VEC[0][k]  = 1.0 ;
+    for(i=0; i < NLCPAR; i++ ) {
+      for(j=0; j < NLCPAR; j++ ) 
+	{ FCNDATA.COV[i][j][k] = data[n].covmat_tot[i][j] ; }
+    }
+
+    // redshift & lensing terms of fcn_muerrsq do not depend on fit params
+    dmuz = dmuLens = 0.0 ;
+    if ( z >= 1.0E-8 ) {
+      dmuz    = fcn_muerrz(1, z, zerr );
+      dmuLens = INPUTS.lensing_zpar * z;
+    }
+    FCNDATA.dmuzsq[k]    = dmuz * dmuz ;
+    FCNDATA.dmuLenssq[k] = dmuLens * dmuLens ;
+    k++ ;
+  }
+
+  FCNDATA.NROW = k ;
+  FCNDATA.NSN  = NSN ;
+
+} // end load_FCNDATA
+
+
+// ******************************************
+void prep_fcn_grad(void) {
+
+  // Created Oct 2026
+  // Check if analytic gradient (fcn_grad) is requested and valid 
+  // for this fit, and set FITINP.USE_GRAD.
+  // The gradient is implemented for the chi2 of spec-confirmed SNIa 
+  // with no biasCor or 1D biasCor, where muBias and muCOVscale do
+  // not depend on the fit params. For CCprior or 5D biasCor, MINUIT
+  // computes numerical derivatives as before.
+
+  char fnam[] = "prep_fcn_grad" ;
+
+  // ------------ BEGIN -------------
+
+  FITINP.USE_GRAD = 0 ;
+  if ( INPUTS.mngrad == 0 ) { return ; }
+
+  if ( simdata_ccprior.USE > 0 ) {
+    printf("\t %s: no analytic gradient with CCprior.\n", fnam);
+    return ;
+  }
+
+  if ( INPUTS.opt_biasCor & MASK_BIASCOR_5D ) {
+    printf("\t %s: no analytic gradient with 5D biasCor.\n", fnam);
+    return ;
+  }
+
+  printf("\t %s: use analytic gradient (mngrad=%d)\n", 
+	 fnam, INPUTS.mngrad );
+  fflush(stdout);
+  FITINP.USE_GRAD = 1 ;
+
+} // end prep_fcn_grad
+
+
+// ******************************************
+void fcn_grad(double *xval, double *grad) {
+
+  // Created Oct 2026
+  // Return grad[ipar] = dchi2/dxval[ipar] from the terms stored for 
+  // each event in fcn_data_loop:
+  //    dchi2/ddelta, dchi2/dalpha, dchi2/dbeta, dmumodel/dcosPar,
+  // with delta = mB + alpha*x1 - beta*c + magoff_host - M0 - mumodel.
+  // Events are summed in data order as for chi2.
+  // Params not used in the chi2 (e.g., sigint, scalePCC) get grad=0.
+
+  double aHost       = xval[15]; // dalpha/dlog(Mhost)
+  double bHost       = xval[16]; // dbeta/dlog(Mhost)
+  double gamma0      = xval[IPAR_GAMMA0] ;
+  double gamma1      = xval[IPAR_GAMMA1] ;
+  double logmass_cen = xval[IPAR_LOGMASS_CEN] ;
+  double logmass_tau = xval[IPAR_LOGMASS_TAU] ;
+
+  int    NPAR = FITINP.NFITPAR_ALL ;
+  int    k, n, ipar, NBIN_M0, iz0, iz1 ;
+  int    OPT_LOGMASS_SLOPE=0, OPT_LOGMASS_SPLIT=0 ;
+  double gd, ga, gb, z, dlogmass, zfrac, gamma, arg, F, dF ;
+
+  // ------------ BEGIN -------------
+
+  for(ipar=0; ipar < NPAR; ipar++ ) { grad[ipar] = 0.0 ; }
+
+  if ( INPUTS.ipar[15]<=1 || INPUTS.ipar[16]<=1 ) 
+    { OPT_LOGMASS_SLOPE = 1; }
+
+  if ( INPUTS.ipar[15]==2 || INPUTS.ipar[16]==2 ) 
+    { OPT_LOGMASS_SPLIT = 1; }
+
+  for(k=0; k < FCNDATA.NROW; k++ ) {
+    n = FCNDATA.isn[k] ;
+    if ( FCN_EVENT.use[n] == 0 ) { continue ; }
+
+    gd = FCN_EVENT.dchi2_ddelta[n] ;
+    ga = FCN_EVENT.dchi2_dalpha[n] ;
+    gb = FCN_EVENT.dchi2_dbeta[n] ;
+    z  = FCNDATA.z[k] ;
+    dlogmass = FCNDATA.logmass[k] - logmass_cen ;
+
+    // alpha & beta params (see fcn_AlphaBeta)
+    grad[IPAR_ALPHA0] += ga ;
+    grad[IPAR_BETA0]  += gb ;
+    grad[3]           += ga*z ;
+    grad[4]           += gb*z ;
+
+    if ( OPT_LOGMASS_SLOPE ) {
+      grad[15] += ga*dlogmass ;
+      grad[16] += gb*dlogmass ;
+      grad[IPAR_LOGMASS_CEN] -= (ga*aHost + gb*bHost) ;
+    }
+    if ( OPT_LOGMASS_SPLIT ) {
+      if ( dlogmass > 0.0 ) 
+	{ grad[15] += ga*0.5 ;  grad[16] += gb*0.5 ; }
+      else
+	{ grad[15] -= ga*0.5 ;  grad[16] -= gb*0.5 ; }
+    }
+
+    // host mag offset (see get_magoff_host)
+    if ( INPUTS.USE_GAMMA0 ) {
+      gamma = gamma0 + z*gamma1 ;
+      arg   = -dlogmass / logmass_tau ;
+      F     = 1.0 / ( 1.0 + exp(arg) ) ;
+      dF    = -F*(1.0-F) ;  // dF/darg
+      grad[IPAR_GAMMA0]       += gd * (F-0.5) ;
+      grad[IPAR_GAMMA1]       += gd * (F-0.5) * z ;
+      grad[IPAR_LOGMASS_CEN]  += gd * gamma * dF / logmass_tau ;
+      grad[IPAR_LOGMASS_TAU]  += gd * gamma * dF * dlogmass / 
+	(logmass_tau*logmass_tau) ;
+    }
+
+    // M0 in z bins (see fcn_M0)
+    NBIN_M0 = fcn_M0_zbins(n, &iz0, &iz1, &zfrac);
+    if ( NBIN_M0 == 1 ) 
+      { grad[MXCOSPAR+iz0] -= gd ; }
+    else if ( NBIN_M0 == 2 ) {
+      grad[MXCOSPAR+iz0] -= gd*(1.0-zfrac) ;
+      grad[MXCOSPAR+iz1] -= gd*zfrac ;
+    }
+
+    // cosmology params
+    if ( INPUTS.FLOAT_COSPAR ) {
+      for(ipar=0; ipar < NCOSPAR; ipar++ ) {
+	if ( FITINP.ISFLOAT[IPAR_OL+ipar] == 0 ) { continue ; }
+	grad[IPAR_OL+ipar] -= gd * FCN_EVENT.dmu_dcosPar[ipar][n] ;
+      }
+    }
+  } // end k loop
+
+} // end fcn_grad
 
 // ==============================================
 void  fcn_AlphaBeta(double *xval, double z, double logmass, 
@@ -3328,20 +3938,54 @@ double fcn_M0(int n, double *M0LIST) {
   // and list of M0LIST in each z bin
   // Jun 27 2017: REFACTOR z bins
   // Jan 29 2019: if no iz1 bin, return(M0) instead of retrn(M0bin0)
+  // Oct 2026: z-bin selection moved to fcn_M0_zbins (also used by fcn_grad)
 
-  int LDMP=0;
-  int iz, iz0, iz1, impar, NBINz ;
-  double M0, zdata, zbin0, zbin1, zfrac, M0bin0, M0bin1 ;  
-  char fnam[] = "fcn_M0";
+  int NBIN_M0, iz0, iz1 ;
+  double M0, zfrac, M0bin0, M0bin1 ;  
+  //  char fnam[] = "fcn_M0";
 
   // ----------- BEGIN ----------
 
   M0 = M0_DEFAULT ;
- 
+
+  NBIN_M0 = fcn_M0_zbins(n, &iz0, &iz1, &zfrac);
+
+  if ( NBIN_M0 == 1 ) {
+    M0    = M0LIST[iz0] ;
+  }
+  else if ( NBIN_M0 == 2 ) {
+    M0bin0 = M0LIST[iz0];
+    M0bin1 = M0LIST[iz1];
+    M0     = M0bin0 + (M0bin1-M0bin0) * zfrac ;
+  }
+
+  return(M0);
+
+} // end fcn_M0
+
+
+// ================================
+int fcn_M0_zbins(int n, int *iz0, int *iz1, double *zfrac) {
+
+  // Created Oct 2026 (moved from fcn_M0)
+  // For data index n, return number of M0 z-bins used for M0:
+  //   0 -> M0 = M0_DEFAULT
+  //   1 -> M0 = M0LIST[iz0]
+  //   2 -> M0 = M0LIST[iz0] + (M0LIST[iz1]-M0LIST[iz0])*zfrac
+
+  int LDMP=0;
+  int NBINz ;
+  double zdata, zbin0, zbin1 ;  
+  char fnam[] = "fcn_M0_zbins";
+
+  // ----------- BEGIN ----------
+
+  *iz0 = *iz1 = -9 ;  *zfrac = 0.0 ;
+
   if ( INPUTS.uM0 == M0FITFLAG_CONSTANT ||
        INPUTS.uM0 == M0FITFLAG_ZBINS_FLAT ) {
-    iz    = data[n].izbin;  
-    M0    = M0LIST[iz] ;
+    *iz0  = data[n].izbin;  
+    return(1);
   }
   else if ( INPUTS.uM0 == M0FITFLAG_ZBINS_INTERP ) {
     // linear interp
@@ -3353,52 +3997,46 @@ double fcn_M0(int n, double *M0LIST) {
     
     NBINz   = INPUTS.BININFO_z.nbin ;
     zdata   = data[n].zhd ;
-    iz0     = data[n].izbin;  
-    zbin0   = simdata_bias.zM0[iz0]; // wgt z-avg in this z bin
+    *iz0    = data[n].izbin;  
+    zbin0   = simdata_bias.zM0[*iz0]; // wgt z-avg in this z bin
 
     // get neighbor-bin z value to use for interp
-    if ( iz0 == 0 )           // 1st z-bin
-      { iz1 = iz0 + 1 ; }
+    if ( *iz0 == 0 )           // 1st z-bin
+      { *iz1 = *iz0 + 1 ; }
 
-    else if ( iz0 == NBINz-1 ) // last z-bin
-      { iz1 = iz0 - 1 ; }
+    else if ( *iz0 == NBINz-1 ) // last z-bin
+      { *iz1 = *iz0 - 1 ; }
 
     else if ( zdata > zbin0 ) 
-      { iz1 = iz0 + 1 ; }
+      { *iz1 = *iz0 + 1 ; }
 
     else if ( zdata < zbin0 ) 
-      { iz1 = iz0 - 1 ; }
+      { *iz1 = *iz0 - 1 ; }
 
     else {
-      iz1 = -9 ;
+      *iz1 = -9 ;
       sprintf(c1err,"Could not determine iz1" );
-      sprintf(c2err,"iz0=%d zbin0=%f  NBINz=%d", iz0, zbin0, NBINz);
+      sprintf(c2err,"iz0=%d zbin0=%f  NBINz=%d", *iz0, zbin0, NBINz);
       errmsg(SEV_FATAL, 0, fnam, c1err, c2err);  
     }
 
     // if interp z-bin does not float M0, then just return
     // constant M0 in this z-bin (Jun 2017)
-    if ( FITINP.ISFLOAT_z[iz1] == 0  ) { return(M0); }
-
-    zbin1 = simdata_bias.zM0[iz1];
-    M0bin0 = M0LIST[iz0];
-    M0bin1 = M0LIST[iz1];
+    if ( FITINP.ISFLOAT_z[*iz1] == 0  ) { return(0); }
 
-    zfrac = ( zdata - zbin0 ) / ( zbin1 - zbin0) ;
-    M0    = M0bin0 + (M0bin1-M0bin0) * zfrac ;
+    zbin1  = simdata_bias.zM0[*iz1];
+    *zfrac = ( zdata - zbin0 ) / ( zbin1 - zbin0) ;
 
-    LDMP = (iz0 >= 8888  ) ;
+    LDMP = (*iz0 >= 8888  ) ;
     if ( LDMP ) {    
       printf(" xxx -------------------------- \n");
-      printf(" xxx iz0=%d  iz1=%d \n", iz0, iz1);
+      printf(" xxx iz0=%d  iz1=%d \n", *iz0, *iz1);
       printf(" xxx zdata=%.4f  zbin0=%.4f zbin1=%.4f  zfrac=%.3f\n",
-	     zdata, zbin0, zbin1, zfrac );
-      printf(" xxx M0bin0=%.3f  M0bin1=%.3f   M0=%.3f\n",
-	     M0bin0, M0bin1, M0);
+	     zdata, zbin0, zbin1, *zfrac );
       fflush(stdout);
       //      debugexit(fnam);
     }
-
+    return(2);
   }
   else {
     sprintf(c1err,"Invalid uM0=%d", INPUTS.uM0 );
@@ -3406,9 +4044,9 @@ double fcn_M0(int n, double *M0LIST) {
     errmsg(SEV_FATAL, 0, fnam, c1err, c2err);  
   }
 
-  return(M0);
+  return(0);
 
-} // end fcn_M0
+} // end fcn_M0_zbins
 
 // ==================================================
 void fcn_AlphaBetaWGT(double alpha, double beta, int DUMPFLAG,
@@ -3955,6 +4593,9 @@ void set_defaults(void) {
 
   INPUTS.iflag_duplicate = IFLAG_DUPLICATE_ABORT ;
 
+  INPUTS.nthread = 1 ;
+  INPUTS.mngrad  = 0 ;
+  INPUTS.cachedir_simFile[0] = 0 ;
 
   INPUTS.NCUTWIN = 0;
 
@@ -5986,10 +6627,12 @@ void  read_simFile_biasCor(void) {
   // Jun 02 2018: fix bug by requiring true Ia in loop over events.
   // May 14,2019: if OPT_PHOTOZ is not read, init opt_photoz[i]=0
   // May 20 2019: major refactor to read & append multiple biasCor files.
+  // Oct 2026: optional staged read (see use_stage_simFile)
 
   int NFILE = INPUTS.nfile_biasCor;
   int NROW, ISTART, IFILETYPE, ifile, NVAR_ORIG, LEN_MALLOC ;   
-  int NEVT[MXFILE_BIASCOR], NEVT_TOT;
+  int NEVT[MXFILE_BIASCOR], NEVT_TOT, ISTAGE[MXFILE_BIASCOR] ;
+  int USE_STAGE = use_stage_simFile(NFILE, INPUTS.simFile_biasCor);
   char *simFile ;
   char fnam[] = "read_simFile_biasCor" ;
 
@@ -6001,11 +6644,18 @@ void  read_simFile_biasCor(void) {
   simdata_bias.IVAR_SIM_VPEC  = 0 ;
   simdata_bias.IVAR_OPT_PHOTO = 0 ;
 
-  // read each file quickly to get total size of arrays to malloc
+  // read each file quickly to get total size of arrays to malloc;
+  // staged read parses needed columns here instead of counting rows.
   NEVT_TOT = 0 ;
   for(ifile=0; ifile < NFILE; ifile++ ) {
     simFile     = INPUTS.simFile_biasCor[ifile];
-    NEVT[ifile] = SNTABLE_NEVT(simFile,TABLENAME_FITRES);  
+    if ( USE_STAGE ) {
+      ISTAGE[ifile] = SNTABLE_STAGE_OPEN(simFile,TABLENAME_FITRES);
+      SNTABLE_READPREP_biasCor(0,0); // define columns only
+      NEVT[ifile]   = SNTABLE_STAGE_READ();
+    }
+    else 
+      { NEVT[ifile] = SNTABLE_NEVT(simFile,TABLENAME_FITRES); }
     NEVT_TOT   += NEVT[ifile];
     printf("\t Found %d events in %s. \n", NEVT[ifile], simFile);
     fflush(stdout);
@@ -6019,8 +6669,12 @@ void  read_simFile_biasCor(void) {
   // loop again over each data file: read and append arrays
   for(ifile=0; ifile < NFILE; ifile++ ) {
     simFile     = INPUTS.simFile_biasCor[ifile];
-    IFILETYPE   = TABLEFILE_OPEN(simFile,"read");
-    NVAR_ORIG   = SNTABLE_READPREP(IFILETYPE,"FITRES");
+    if ( USE_STAGE ) 
+      { NVAR_ORIG = SNTABLE_READPREP_STAGE(ISTAGE[ifile]); }
+    else {
+      IFILETYPE   = TABLEFILE_OPEN(simFile,"read");
+      NVAR_ORIG   = SNTABLE_READPREP(IFILETYPE,"FITRES");
+    }
     ISTART      = simdata_bias.NROW;
     SNTABLE_READPREP_biasCor(ISTART,NEVT[ifile]);
 
@@ -6040,6 +6694,36 @@ void  read_simFile_biasCor(void) {
 } // end read_simFile_biasCor
 
 
+// ================================================================
+int use_stage_simFile(int NFILE, char **simFile) {
+
+  // Created Oct 2026
+  // Return 1 to read simFile list (biasCor or CCprior) with the
+  // staged read, SNTABLE_STAGE_OPEN; i.e., if nthread > 1 or
+  // cachedir_simfile is set, and all files are TEXT. 
+  // Return 0 for the regular SNTABLE_NEVT + SNTABLE_READ_EXEC.
+
+  int ifile ;
+
+  // ----------- BEGIN -------------
+
+  if ( INPUTS.nthread <= 1 && strlen(INPUTS.cachedir_simFile) == 0 ) 
+    { return(0); }
+
+  if ( NFILE > MXSTAGE_READTABLE ) { return(0); }
+
+  for(ifile=0; ifile < NFILE; ifile++ ) {
+    if ( get_TABLEFILE_TYPE(simFile[ifile]) != IFILETYPE_TEXT ) 
+      { return(0); }
+  }
+
+  SNTABLE_STAGE_CONFIG(INPUTS.nthread, INPUTS.cachedir_simFile);
+
+  return(1);
+
+} // end use_stage_simFile
+
+
 // ================================================================
 void SNTABLE_READPREP_biasCor(int ISTART, int LEN) {
 
@@ -6049,9 +6733,10 @@ void SNTABLE_READPREP_biasCor(int ISTART, int LEN) {
   // Inputs:
   //   ISTART = start index to read
   //   LEN    = approx length to read
+  //            (LEN=0 -> define columns for staged read; Oct 2026)
 
   int NROW, icut, ivar, ivar2 ;
-  int vbose = 1 ;  // verbose, but no abort on missing variable
+  int vbose = ( LEN > 0 ) ; // verbose, but no abort on missing variable
   int ABORT = 3 ;  
   int USE_FIELDGROUP  = INPUTS.use_fieldGroup_biasCor ;
   int IDEAL = ( INPUTS.opt_biasCor & MASK_BIASCOR_COVINT ) ;
@@ -9989,10 +10674,12 @@ void  read_simFile_CCprior(SIMFILE_INFO_DEF *SIMFILE_INFO) {
   // Read simFile(s) and load SIMFILE_INFO struct.
   //
   // May 2019: major refactor to read multiple CCprior files.
+  // Oct 2026: optional staged read (see use_stage_simFile)
 
   int  NFILE    = INPUTS.nfile_CCprior;
-  int  NEVT[MXFILE_CCPRIOR], NEVT_TOT;
+  int  NEVT[MXFILE_CCPRIOR], NEVT_TOT, ISTAGE[MXFILE_CCPRIOR];
   int  IFILETYPE, NVAR_ORIG, LEN_MALLOC, NROW, ifile, ISTART ;
+  int  USE_STAGE = use_stage_simFile(NFILE, INPUTS.simFile_CCprior);
   char *simFile ;
   char fnam[] = "read_simFile_CCprior" ;
 
@@ -10002,7 +10689,13 @@ void  read_simFile_CCprior(SIMFILE_INFO_DEF *SIMFILE_INFO) {
   NEVT_TOT = 0 ;
   for(ifile=0; ifile < NFILE; ifile++ ) {
     simFile = INPUTS.simFile_CCprior[ifile];
-    NEVT[ifile] = SNTABLE_NEVT(simFile,TABLENAME_FITRES); 
+    if ( USE_STAGE ) {
+      ISTAGE[ifile] = SNTABLE_STAGE_OPEN(simFile,TABLENAME_FITRES);
+      SNTABLE_READPREP_CCprior(SIMFILE_INFO, 0, 0); // define columns only
+      NEVT[ifile]   = SNTABLE_STAGE_READ();
+    }
+    else
+      { NEVT[ifile] = SNTABLE_NEVT(simFile,TABLENAME_FITRES); }
     NEVT_TOT += NEVT[ifile];
     printf("\t Found %d events in %s. \n", NEVT[ifile], simFile) ;
   }
@@ -10018,8 +10711,12 @@ void  read_simFile_CCprior(SIMFILE_INFO_DEF *SIMFILE_INFO) {
   SIMFILE_INFO->NROW = 0 ;
   for(ifile=0; ifile < NFILE; ifile++ ) {
     simFile   = INPUTS.simFile_CCprior[ifile];
-    IFILETYPE = TABLEFILE_OPEN(simFile,"read");
-    NVAR_ORIG = SNTABLE_READPREP(IFILETYPE,"FITRES");
+    if ( USE_STAGE ) 
+      { NVAR_ORIG = SNTABLE_READPREP_STAGE(ISTAGE[ifile]); }
+    else {
+      IFILETYPE = TABLEFILE_OPEN(simFile,"read");
+      NVAR_ORIG = SNTABLE_READPREP(IFILETYPE,"FITRES");
+    }
   
     ISTART = SIMFILE_INFO->NROW; // start index to load SIMFILE_INFO
     SNTABLE_READPREP_CCprior(SIMFILE_INFO, ISTART, NEVT[ifile] );
@@ -10107,8 +10804,9 @@ void SNTABLE_READPREP_CCprior(SIMFILE_INFO_DEF *SIMFILE_INFO,
 
   // May 2019
   // Wrapper to call SNTABLE_READPREP_VARDEF.
+  // Oct 2026: LEN=0 -> define columns for staged read.
 
-  int  vbose=1;
+  int  vbose = ( LEN > 0 ) ;
   int  icut, ivar ;
   char vartmp[60], str_z[40], str_zerr[40] ;
   int  USE_FIELDGROUP  = INPUTS.use_fieldGroup_biasCor ;
@@ -12161,6 +12859,23 @@ int ppar(char* item) {
 
   if ( uniqueOverlap(item,"snid_mucovdump=")) 
     { sscanf(&item[15],"%s", INPUTS.SNID_MUCOVDUMP); return(1); }
+
+  if ( uniqueOverlap(item,"nthread=")) { 
+    sscanf(&item[8],"%d", &INPUTS.nthread ); 
+    if ( INPUTS.nthread > MXTHREAD_FCN ) {
+      printf("\t WARNING: nthread=%d -> %d (MXTHREAD_FCN) \n",
+	     INPUTS.nthread, MXTHREAD_FCN );
+      fflush(stdout);
+      INPUTS.nthread = MXTHREAD_FCN ;
+    }
+    return(1); 
+  }
+
+  if ( uniqueOverlap(item,"mngrad=")) 
+    { sscanf(&item[7],"%d", &INPUTS.mngrad ); return(1); }
+
+  if ( uniqueOverlap(item,"cachedir_simfile=")) 
+    { sscanf(&item[17],"%s", INPUTS.cachedir_simFile ); return(1); }
     
   return(0);
   
@@ -13374,6 +14089,7 @@ void prep_input(void) {
 
   // check for fast lookup option if all cosmo params are fixed.
   // arg, not needed.  prep_cosmodl_lookup();
+  prep_cosmodl_DLTAB(INPUTS.COSPAR, 0); // Oct 2026
 
   printf("\n"); fflush(stdout);
 
@@ -14655,7 +15371,7 @@ double cosmodl(double z, double *cosPar)
 
   //comoving distance to redshift
 
-  dflat = rombint(inc, 0.0, z, cosPar, tol);
+  dflat = dflat_cosmodl(z, cosPar);
 
   H0inv = 1.0/INPUTS.H0 ;
 
@@ -14671,6 +15387,197 @@ double cosmodl(double z, double *cosPar)
 } // end cosmodl
 
 
+// ==================================================
+double dflat_cosmodl(double z, double *cosPar) {
+
+  // Created Oct 2026
+  // Return comoving integral int_0^z dz/E(z) for cosmodl.
+  // Use tabulated integral (sntools DLTAB) if this cosmology was 
+  // prepared with prep_cosmodl_DLTAB; otherwise use rombint.
+  // DLTAB is only read here, so that this function is safe to
+  // call from the fcn_data_loop threads.
+
+  const double tol = 1.e-6;
+  double omega_l = cosPar[0], omega_k = cosPar[1] ;
+  double omega_m ;
+  int    islot ;
+
+  if ( fabs(omega_k) < tol ) { omega_k = 0.0; }
+  omega_m = 1.0 - omega_l - omega_k;
+
+  if ( z < DLTAB.ZMAX ) {
+    islot = find_DLTAB(omega_m, omega_l, cosPar[2], cosPar[3]);
+    if ( islot >= 0 ) { return( chi_DLTAB(islot,z) ); }
+  }
+
+  return( rombint(inc, 0.0, z, cosPar, tol) );
+
+} // end dflat_cosmodl
+
+
+// ==================================================
+void prep_cosmodl_DLTAB(double *cosPar, int DO_GRAD) {
+
+  // Created Oct 2026
+  // Fill DLTAB tables needed by cosmodl_forFit for this cosPar:
+  // cosPar itself, and the OL values used for extrapolation 
+  // when OL > 0.97. Must be called outside of threads.
+  // If DO_GRAD, also fill DCHITAB for the floated cosPar so that
+  // cosmodl_forFit_grad does not integrate for each event.
+
+  double OL_extrap[2] = { 0.97, 0.99 } ; // same as cosmodl_forFit
+  double omega_k = cosPar[1], OL, cosPar_local[NCOSPAR] ;
+  int    *MASK = &FITINP.ISFLOAT[IPAR_OL] ;
+  int    i, ipar;
+
+  if ( DLTAB.INIT_FLAG == 0 ) {
+    double ZMAX = INPUTS.zmax + 0.1 ;
+    if ( ZMAX > ZMAX_SNANA ) { ZMAX = ZMAX_SNANA; }
+    init_DLTAB(ZMAX, ZBIN_DLTAB);
+  }
+
+  if ( fabs(omega_k) < 1.e-6 ) { omega_k = 0.0; }
+
+  OL = cosPar[0] ;
+  get_DLTAB(1.0-OL-omega_k, OL, cosPar[2], cosPar[3]);
+
+  if ( OL > OL_extrap[0] ) {
+    for(i=0; i < 2; i++ ) {
+      OL = OL_extrap[i] ;
+      get_DLTAB(1.0-OL-omega_k, OL, cosPar[2], cosPar[3]);
+    }
+  }
+
+  if ( !DO_GRAD ) { return ; }
+
+  DCHITAB.NTAB = 0 ;
+  if ( OL > OL_extrap[0] ) {
+    for(ipar=0; ipar < NCOSPAR; ipar++ ) 
+      { cosPar_local[ipar] = cosPar[ipar]; }
+    for(i=0; i < 2; i++ ) {
+      cosPar_local[0] = OL_extrap[i] ;
+      fill_DCHITAB(cosPar_local, MASK);
+    }
+  }
+  else {
+    fill_DCHITAB(cosPar, MASK);
+  }
+
+} // end prep_cosmodl_DLTAB
+
+
+// ==================================================
+void fill_DCHITAB(double *cosPar, int *MASK) {
+
+  // Created Oct 2026
+  // Add DCHITAB table for this cosPar: for each cosPar with 
+  // MASK != 0, cumulative Simpson integral of inc_grad on the 
+  // DLTAB z-grid. Must be called outside of threads.
+
+  int    NZBIN = DLTAB.NZBIN ;
+  double ZBIN  = DLTAB.ZBIN ;
+  int    itab, ipar, iz ;
+  double cosPar_local[NCOSPAR+1], z0, f0, fmid, f1, *DCHI ;
+  char   fnam[] = "fill_DCHITAB" ;
+
+  // ------------ BEGIN ------------
+
+  itab = DCHITAB.NTAB ;
+  if ( itab >= MXTAB_DCHI ) {
+    sprintf(c1err,"Cannot add table %d", itab);
+    sprintf(c2err,"MXTAB_DCHI = %d", MXTAB_DCHI );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  }
+
+  // (re)allocate if DLTAB z-grid has changed
+  if ( DCHITAB.NZBIN_ALLOC != NZBIN ) {
+    int i;
+    for(i=0; i < MXTAB_DCHI; i++ ) {
+      for(ipar=0; ipar < NCOSPAR; ipar++ ) {
+	if ( DCHITAB.NZBIN_ALLOC > 0 ) { free(DCHITAB.DCHI[i][ipar]); }
+	DCHITAB.DCHI[i][ipar] = (double*)malloc((NZBIN+1)*sizeof(double));
+      }
+    }
+    DCHITAB.NZBIN_ALLOC = NZBIN ;
+  }
+
+  for(ipar=0; ipar < NCOSPAR; ipar++ ) {
+    cosPar_local[ipar]          = cosPar[ipar] ;
+    DCHITAB.COSPAR[itab][ipar]  = cosPar[ipar] ;
+    DCHITAB.MASK[itab][ipar]    = MASK[ipar] ;
+  }
+
+  for(ipar=0; ipar < NCOSPAR; ipar++ ) {
+    if ( MASK[ipar] == 0 ) { continue ; }
+    cosPar_local[NCOSPAR] = (double)ipar ; // tells inc_grad which param
+    DCHI    = DCHITAB.DCHI[itab][ipar] ;
+    DCHI[0] = 0.0 ;
+    f0      = inc_grad(0.0, cosPar_local);
+    for(iz=0; iz < NZBIN; iz++ ) {
+      z0   = ZBIN * (double)iz ;
+      fmid = inc_grad(z0 + 0.5*ZBIN, cosPar_local);
+      f1   = inc_grad(z0 + ZBIN,     cosPar_local);
+      DCHI[iz+1] = DCHI[iz] + ZBIN*(f0 + 4.0*fmid + f1)/6.0 ;
+      f0   = f1 ;
+    }
+  }
+
+  DCHITAB.NTAB++ ;
+
+} // end fill_DCHITAB
+
+
+// ==================================================
+double dchi_cosmodl(double z, double *cosPar, int ipar) {
+
+  // Created Oct 2026
+  // Return d(dflat)/d(cosPar[ipar]) = int_0^z inc_grad dz from 
+  // DCHITAB if this cosPar was prepared (plus Simpson integral 
+  // over partial bin); otherwise use rombint. DCHITAB is only read
+  // here, so that this function is safe in fcn_data_loop threads.
+
+  const double tol = 1.e-6;
+  double cosPar_local[NCOSPAR+1], ZBIN = DLTAB.ZBIN ;
+  double z0, dz, dchi, f0, fmid, f1 ;
+  int    itab, i, iz, NSTEP, istep, ITAB = -1 ;
+
+  for(i=0; i < NCOSPAR; i++ ) { cosPar_local[i] = cosPar[i]; }
+  cosPar_local[NCOSPAR] = (double)ipar ;
+
+  if ( z < DLTAB.ZMAX ) {
+    for(itab=0; itab < DCHITAB.NTAB; itab++ ) {
+      if ( DCHITAB.MASK[itab][ipar] == 0 ) { continue; }
+      for(i=0; i < NCOSPAR; i++ ) 
+	{ if ( DCHITAB.COSPAR[itab][i] != cosPar[i] ) { break; } }
+      if ( i == NCOSPAR ) { ITAB = itab; break; }
+    }
+  }
+
+  if ( ITAB < 0 ) 
+    { return( rombint(inc_grad, 0.0, z, cosPar_local, tol) ); }
+
+  if ( z <= 0.0 ) { return(0.0); }
+
+  iz    = (int)(z/ZBIN) ;
+  z0    = ZBIN * (double)iz ;
+  dchi  = DCHITAB.DCHI[ITAB][ipar][iz] ;
+
+  NSTEP = (int)ceil( (z-z0)/ZBIN - 1.0E-9 ) ;
+  if ( NSTEP < 1 ) { NSTEP = 1; }
+  dz  = (z-z0) / (double)NSTEP ;
+  f0  = inc_grad(z0, cosPar_local);
+  for(istep=0; istep < NSTEP; istep++ ) {
+    fmid  = inc_grad(z0 + 0.5*dz, cosPar_local);
+    f1    = inc_grad(z0 + dz,     cosPar_local);
+    dchi += dz*(f0 + 4.0*fmid + f1)/6.0 ;
+    z0   += dz;   f0 = f1 ;
+  }
+
+  return(dchi);
+
+} // end dchi_cosmodl
+
+
 
 double rombint(double f(double z, double *cosPar),
 	       double a, double b, double *cosPar, double tol) {
@@ -14766,6 +15673,145 @@ double inc(double z, double *cosPar) {
 					  
 } // end inc
 
+
+// ==================================================
+void cosmodl_forFit_grad(double z, double *cosPar, int *MASK, 
+			 double *dl_grad) {
+
+  // Created Oct 2026
+  // Return dl_grad[ipar] = d(dl)/d(cosPar[ipar]) for the dl returned
+  // by cosmodl_forFit, including the extrapolation for OL > 0.97.
+  // Only parameters with MASK[ipar] != 0 are computed; others are 0.
+
+  int ipar, i;
+  int IPAR_OL = 0 ;
+  double DL[2], DL_GRAD[2][NCOSPAR], OL, slp, cosPar_local[10] ;
+  double OL_extrap[2] = { 0.97, 0.99 } ;
+
+  // -------------- BEGIN -------------
+
+  OL = cosPar[0];
+
+  if ( OL > OL_extrap[0] ) {
+    for(ipar=0 ; ipar< NCOSPAR ; ipar++ ) 
+      { cosPar_local[ipar] = cosPar[ipar] ; }
+
+    for(i=0; i <2; i++ ) {
+      cosPar_local[IPAR_OL] = OL_extrap[i] ;
+      DL[i] = cosmodl(z,cosPar_local);
+      cosmodl_grad(z, cosPar_local, MASK, DL_GRAD[i] );
+    }
+
+    slp = (DL[1] - DL[0]) / (OL_extrap[1] - OL_extrap[0]) ;
+    for(ipar=0 ; ipar< NCOSPAR ; ipar++ ) {
+      dl_grad[ipar] = DL_GRAD[0][ipar] + ( OL - OL_extrap[0] ) *
+	(DL_GRAD[1][ipar] - DL_GRAD[0][ipar]) / (OL_extrap[1]-OL_extrap[0]);
+    }
+    if ( MASK[IPAR_OL] ) { dl_grad[IPAR_OL] = slp ; }
+  }
+  else {
+    cosmodl_grad(z, cosPar, MASK, dl_grad);
+  }
+
+} // end cosmodl_forFit_grad
+
+
+void cosmodl_grad(double z, double *cosPar, int *MASK, double *dl_grad) {
+
+  // Created Oct 2026
+  // Analytic derivative of cosmodl w.r.t. each cosPar with MASK != 0.
+  // The derivative of the comoving integral is taken from DCHITAB
+  // (see dchi_cosmodl); the curvature dependence of sin/sinh is 
+  // differentiated explicitly.
+
+  const double  cvel = LIGHT_km; // 2.99792458e5;
+  const double  tol  = 1.e-6;
+  double dflat, ddflat, H0inv, omega_k, OK, sqOK, arg;
+  double dS_dflat, dS_dOk ;
+  int    ipar, IPAR_Ok=1 ;
+
+  // ------------- BEGIN --------------
+
+  omega_k = cosPar[1];
+  if(fabs(omega_k)<tol) { omega_k = 0.0; }
+  OK   = fabs(omega_k);
+  sqOK = sqrt(OK);
+
+  dflat = dflat_cosmodl(z, cosPar);
+  H0inv = 1.0/INPUTS.H0 ;
+
+  // S = distance/(c/H0) as a function of dflat and omega_k
+  if( omega_k == 0.0  ) { 
+    dS_dflat = 1.0 ;
+    dS_dOk   = dflat*dflat*dflat/6.0 ;
+  }
+  else if(omega_k<0.0) {
+    arg      = sqOK*dflat ;
+    dS_dflat = cos(arg) ;
+    dS_dOk   = -(dflat*cos(arg)/sqOK - sin(arg)/OK) / (2.0*sqOK) ;
+  }
+  else {
+    arg      = sqOK*dflat ;
+    dS_dflat = cosh(arg) ;
+    dS_dOk   = +(dflat*cosh(arg)/sqOK - sinh(arg)/OK) / (2.0*sqOK) ;
+  }
+
+  for(ipar=0; ipar < NCOSPAR; ipar++ ) { dl_grad[ipar] = 0.0 ; }
+
+  for(ipar=0; ipar < NCOSPAR; ipar++ ) {
+    if ( MASK[ipar] == 0 ) { continue ; }
+    ddflat = dchi_cosmodl(z, cosPar, ipar);
+    dl_grad[ipar] = dS_dflat * ddflat ;
+    if ( ipar == IPAR_Ok ) { dl_grad[ipar] += dS_dOk ; }
+    dl_grad[ipar] *= ( (1.0+z) * cvel * H0inv ) ;
+  }
+
+} // end cosmodl_grad
+
+
+double inc_grad(double z, double *cosPar) {
+
+  // Created Oct 2026
+  // Return derivative of inc(z) w.r.t. cosPar[ipar],
+  // where ipar = cosPar[NCOSPAR]. 
+  //   d(1/E)/dp = -0.5 * dE^2/dp / E^3
+
+  double hubble, rhode, fde, omega_m, omega_k, omega_l, wde, wa ;
+  double zz, zzpow, dEsq ;
+  int    ipar = (int)cosPar[NCOSPAR] ;
+
+  zz = 1.0 + z;
+  
+  omega_l = cosPar[0]; 
+  omega_k = cosPar[1];
+  wde     = cosPar[2];
+  wa      = cosPar[3];
+
+  if ( fabs(omega_k) < 1.0E-6 ) { omega_k = 0.0 ; }
+  omega_m = 1.0 - omega_l - omega_k;
+
+  zzpow = 3.0 * ( 1.0 + wde + wa ) ;
+
+  fde = 1.0 ;
+  if ( fabs(zzpow) > 1.0E-9 ) { fde *= pow(zz,zzpow); }
+  if ( fabs(wa)    > 1.0E-6 ) { fde *= exp(-3.0*(wa*z/zz)); }
+  rhode = omega_l * fde ;
+  
+  hubble = sqrt( (omega_m*(zz*zz*zz)) + rhode + (omega_k*(zz*zz)) );
+
+  if ( ipar == 0 )       // Omega_L
+    { dEsq = fde - zz*zz*zz ; }
+  else if ( ipar == 1 )  // Omega_k
+    { dEsq = zz*zz - zz*zz*zz ; }
+  else if ( ipar == 2 )  // w0
+    { dEsq = rhode * 3.0*log(zz) ; }
+  else                   // wa
+    { dEsq = rhode * 3.0*( log(zz) - z/zz ) ; }
+
+  return( -0.5 * dEsq / (hubble*hubble*hubble) );
+					  
+} // end inc_grad
+
 void gengauss(double r[2])
 {
   double radius, phi;
@@ -21,6 +21,9 @@
   Mar 30 2019 RK - fix hc factors in spectra
   Apr 11 2019 RK - check for intrinsic scatter models (e.g., C11, G10 ...)
   Apr 18 2019 RK - if not USE_PYTHON, add dummy parNames and parVal.
+  Oct 2026: fetch SEDs for all epochs of a genmag_BYOSED call in one
+            python call (fetchSED_BATCH_BYOSED), returned as contiguous
+            [epoch][lam] buffer; wavelength grid is fetched once at init.
 
  *****************************************/
 
@@ -28,6 +31,7 @@
 #include  <stdio.h> 
 #include  <math.h>     
 #include  <stdlib.h>   
+#include  <string.h>   
 #include  <sys/stat.h>
 
 
@@ -94,6 +98,10 @@ void init_genmag_BYOSED(char *PATH_VERSION, int OPTMASK, char *ARGLIST ) {
   Event_BYOSED.LAST_EXTERNAL_ID = -9;
   Event_BYOSED.LAM  = (double*) malloc( MXLAM_BYOSED*MEMD ) ;
   Event_BYOSED.SED  = (double*) malloc( MXLAM_BYOSED*MEMD ) ;
+  Event_BYOSED.NLAM = 0 ;
+  Event_BYOSED.MXEP_BATCH = 0 ;
+  Event_BYOSED.SED_BATCH  = NULL ;
+  Event_BYOSED.Trest_BATCH = NULL ;
 
   SEDMODEL_MWEBV_LAST     = -999.   ;
   SEDMODEL_HOSTXT_LAST.AV = -999.   ;
@@ -143,6 +151,12 @@ void init_genmag_BYOSED(char *PATH_VERSION, int OPTMASK, char *ARGLIST ) {
 
   printf("\t Finished python-init from C code \n");
 #endif
+
+  // wavelength grid is the same for all SEDs; fetch it only once
+  fetchSED_LAM_BYOSED(MXLAM_BYOSED, &Event_BYOSED.NLAM, Event_BYOSED.LAM);
+  printf("\t BYOSED SED has %d wavelength bins (%.1f - %.1f A)\n",
+	 Event_BYOSED.NLAM, Event_BYOSED.LAM[0], 
+	 Event_BYOSED.LAM[Event_BYOSED.NLAM-1] );
   
   // -----------------------------------------------------
   // set SED par names and allocate arrays for parameters
@@ -209,7 +223,7 @@ void genmag_BYOSED(int EXTERNAL_ID, double zHEL, double MU,
   int    NEWEVT_FLAG = 0 ;
 
   int    NLAM, o ;
-  double Tobs, Trest, FLUXSUM_OBS, FspecDUM[2], magobs ; 
+  double Tobs, FLUXSUM_OBS, FspecDUM[2], magobs, *SED_EP ; 
 
   char fnam[] = "genmag_BYOSED" ;
 
@@ -243,18 +257,27 @@ void genmag_BYOSED(int EXTERNAL_ID, double zHEL, double MU,
   fill_TABLE_MWXT_SEDMODEL(MWXT_SEDMODEL.RV, MWEBV);
   fill_TABLE_HOSTXT_SEDMODEL(RV_host, AV_host, zHEL);   // July 2016
 
-  for(o=0; o < NOBS; o++ ) {
-    Tobs  = TOBS_list[o];
-    Trest = Tobs/z1;
+  if ( NOBS <= 0 ) { return ; }
+
+  // fetch rest-frame SED for all epochs with one call
+  malloc_BATCH_BYOSED(NOBS);
+  for(o=0; o < NOBS; o++ ) 
+    { Event_BYOSED.Trest_BATCH[o] = TOBS_list[o]/z1 ; }
 
-    fetchSED_BYOSED(EXTERNAL_ID, NEWEVT_FLAG, Trest, 
-		    MXLAM_BYOSED, HOSTPAR_LIST, &NLAM, LAM, SED );  
-    Event_BYOSED.NLAM = NLAM ;
+  fetchSED_BATCH_BYOSED(EXTERNAL_ID, NEWEVT_FLAG, 
+			NOBS, Event_BYOSED.Trest_BATCH,
+			MXLAM_BYOSED, HOSTPAR_LIST, 
+			&NLAM, LAM, Event_BYOSED.SED_BATCH );  
+  Event_BYOSED.NLAM = NLAM ;
+
+  for(o=0; o < NOBS; o++ ) {
+    Tobs   = TOBS_list[o];
+    SED_EP = &Event_BYOSED.SED_BATCH[o*NLAM] ;
 
     // integrate redshifted SED to get observer-frame flux in IFILT_OBS band.
     // FLUXSUM_OBS is returned (ignore FspecDUM)
     INTEG_zSED_BYOSED(0, IFILT_OBS, Tobs, zHEL, x0,RV_host,AV_host, 
-		      NLAM, LAM, SED, 
+		      NLAM, LAM, SED_EP, 
 		      &FLUXSUM_OBS, FspecDUM ); // <= returned 
 
     
@@ -268,6 +291,9 @@ void genmag_BYOSED(int EXTERNAL_ID, double zHEL, double MU,
     MAGERR_list[o] = 0.01;    // not used
   }
 
+  // keep last SED for genSpec_BYOSED
+  memcpy(SED, &Event_BYOSED.SED_BATCH[(NOBS-1)*NLAM], NLAM*sizeof(double));
+
   // for NEW EVENT, store SED parameters so that sim can 
   // write them to data files
   if ( NEWEVT_FLAG ) { 
@@ -419,50 +445,32 @@ void fetchSED_BYOSED(int EXTERNAL_ID, int NEWEVT_FLAG, double Trest, int MXLAM,
   *NLAM_SED = 0 ; // init output
 
 #ifdef USE_PYTHON
-  PyObject *pmeth, *pargs, *pNLAM, *pLAM, *pFLUX, *plammeth, *pnlammeth;
+  PyObject *pmeth, *pargs, *pFLUX;
   int NLAM, ilam;
-  PyListObject *arrLAM, *arrFLUX;
-  PyObject *pylamitem, *pyfluxitem;
+  PyListObject *arrFLUX;
+  PyObject *pyfluxitem;
   //int numpy_initialized =  init_numpy();
   
   // python declarations here
   pmeth  = PyObject_GetAttrString(geninit_BYOSED, "fetchSED_BYOSED");
-  plammeth  = PyObject_GetAttrString(geninit_BYOSED, "fetchSED_LAM");
-  pnlammeth  = PyObject_GetAttrString(geninit_BYOSED, "fetchSED_NLAM");
   pargs  = Py_BuildValue("diii",Trest,MXLAM,EXTERNAL_ID,NEWEVT_FLAG);
-
-  pNLAM  = PyEval_CallObject(pnlammeth, NULL);
-  pLAM  = PyEval_CallObject(plammeth, NULL);
   pFLUX   = PyEval_CallObject(pmeth, pargs);
-
   Py_DECREF(pmeth);
-  Py_DECREF(plammeth);
-  Py_DECREF(pnlammeth);
   
-  NLAM = PyFloat_AsDouble(pNLAM);
-  Py_DECREF(pNLAM);
-  
-  arrLAM = (PyListObject *)(pLAM);
+  // Oct 2026: wavelength grid is cached at init
+  NLAM = Event_BYOSED.NLAM ;
   arrFLUX = (PyListObject *)(pFLUX);
 
   for(ilam=0; ilam < NLAM; ilam++ ) {
-    // interpolate flux to Trest
-    pylamitem = PyList_GetItem(arrLAM,ilam);
     pyfluxitem = PyList_GetItem(arrFLUX,ilam);
-
-    LAM_SED[ilam]  = PyFloat_AsDouble(pylamitem);
+    LAM_SED[ilam]  = Event_BYOSED.LAM[ilam] ;
     FLUX_SED[ilam] = PyFloat_AsDouble(pyfluxitem);
   }
 
   *NLAM_SED = NLAM;
   
-  Py_DECREF(pLAM);
   Py_DECREF(pFLUX);
-  Py_DECREF(arrLAM);
-  Py_DECREF(arrFLUX);
   Py_DECREF(pargs);
-  //Py_DECREF(pylamitem);
-  //Py_DECREF(pyfluxitem);
 
 #endif
 
@@ -507,6 +515,172 @@ void fetchSED_BYOSED(int EXTERNAL_ID, int NEWEVT_FLAG, double Trest, int MXLAM,
 } // end fetchSED_BYOSED
 
 
+// =================================================
+void fetchSED_LAM_BYOSED(int MXLAM, int *NLAM_SED, double *LAM_SED) {
+
+  // Created Oct 2026
+  // Return wavelength grid of BYOSED SED. Called once at init;
+  // the grid is then stored in Event_BYOSED and re-used for
+  // every SED.
+
+  int NLAM = 0, ilam ;
+  char fnam[] = "fetchSED_LAM_BYOSED" ;
+
+  // ------------ BEGIN -----------
+
+#ifdef USE_PYTHON
+  PyObject *plammeth, *pnlammeth, *pNLAM, *pLAM ;
+  PyListObject *arrLAM ;
+
+  plammeth   = PyObject_GetAttrString(geninit_BYOSED, "fetchSED_LAM");
+  pnlammeth  = PyObject_GetAttrString(geninit_BYOSED, "fetchSED_NLAM");
+  pNLAM      = PyEval_CallObject(pnlammeth, NULL);
+  pLAM       = PyEval_CallObject(plammeth, NULL);
+
+  NLAM   = (int)PyFloat_AsDouble(pNLAM);
+  arrLAM = (PyListObject *)(pLAM);
+  if ( NLAM < MXLAM ) {
+    for(ilam=0; ilam < NLAM; ilam++ ) 
+      { LAM_SED[ilam] = PyFloat_AsDouble(PyList_GetItem(arrLAM,ilam)); }
+  }
+
+  Py_DECREF(plammeth);
+  Py_DECREF(pnlammeth);
+  Py_DECREF(pNLAM);
+  Py_DECREF(pLAM);
+#endif
+
+#ifndef USE_PYTHON
+  NLAM = TEMP_SEDMODEL.NLAM ;
+  if ( NLAM < MXLAM ) {
+    for(ilam=0; ilam < NLAM; ilam++ ) 
+      { LAM_SED[ilam] = TEMP_SEDMODEL.LAM[ilam] ; }
+  }
+#endif
+
+  if ( NLAM >= MXLAM || NLAM < 3 ) {
+    sprintf(c1err,"NLAM=%d is invalid or exceeds bound of %d", 
+	    NLAM, MXLAM);
+    sprintf(c2err,"Check BYOSED wavelength grid.");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err);
+  } 
+
+  *NLAM_SED = NLAM ;
+  return ;
+
+} // end fetchSED_LAM_BYOSED
+
+
+// =================================================
+void malloc_BATCH_BYOSED(int NEP) {
+
+  // Created Oct 2026
+  // Make sure that batch arrays can hold NEP epochs.
+
+  int NLAM = Event_BYOSED.NLAM ;
+  int MXEP ;
+
+  // ------------ BEGIN -----------
+
+  if ( NEP <= Event_BYOSED.MXEP_BATCH ) { return ; }
+
+  MXEP = NEP + 20 ;  // a little extra to avoid many reallocs
+  if ( Event_BYOSED.MXEP_BATCH > 0 ) {
+    free(Event_BYOSED.SED_BATCH);
+    free(Event_BYOSED.Trest_BATCH);
+  }
+  Event_BYOSED.SED_BATCH   = (double*)malloc(MXEP*NLAM*sizeof(double));
+  Event_BYOSED.Trest_BATCH = (double*)malloc(MXEP*sizeof(double));
+  Event_BYOSED.MXEP_BATCH  = MXEP ;
+
+} // end malloc_BATCH_BYOSED
+
+
+// =================================================
+void fetchSED_BATCH_BYOSED(int EXTERNAL_ID, int NEWEVT_FLAG, 
+			   int NEP, double *Trest_list, int MXLAM,
+			   double *HOSTPAR_LIST, int *NLAM_SED, 
+			   double *LAM_SED, double *FLUX_SED) {
+
+  // Created Oct 2026
+  // Same as fetchSED_BYOSED, but return SED for NEP rest-frame
+  // epochs (*Trest_list) with one python call. 
+  // Output *FLUX_SED is contiguous, FLUX_SED[iep*NLAM + ilam],
+  // and is copied directly from the python buffer (no per-element
+  // conversion). *LAM_SED is from the wavelength grid cached at init.
+
+  int NLAM = Event_BYOSED.NLAM ;
+  int ilam ;
+  char fnam[] = "fetchSED_BATCH_BYOSED" ;
+
+  // ------------ BEGIN -----------
+
+  *NLAM_SED = 0 ;
+
+  if ( NLAM >= MXLAM ) {
+    sprintf(c1err,"NLAM=%d exceeds bound of %d", NLAM, MXLAM);
+    sprintf(c2err,"NEP=%d  Trest[0]=%.2f ", NEP, Trest_list[0] );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err);
+  } 
+
+  if ( LAM_SED != Event_BYOSED.LAM ) {
+    for(ilam=0; ilam < NLAM; ilam++ ) 
+      { LAM_SED[ilam] = Event_BYOSED.LAM[ilam] ; }
+  }
+
+#ifdef USE_PYTHON
+  PyObject *pmeth, *pargs, *pTLIST, *pFLUX ;
+  Py_buffer view ;
+  Py_ssize_t NBYTE = (Py_ssize_t)NEP * NLAM * sizeof(double) ;
+  int iep ;
+
+  pTLIST = PyList_New(NEP);
+  for(iep=0; iep < NEP; iep++ ) 
+    { PyList_SetItem(pTLIST, iep, PyFloat_FromDouble(Trest_list[iep])); }
+
+  pmeth  = PyObject_GetAttrString(geninit_BYOSED, "fetchSED_BYOSED_BATCH");
+  pargs  = Py_BuildValue("(Oiii)",pTLIST,MXLAM,EXTERNAL_ID,NEWEVT_FLAG);
+  pFLUX  = PyEval_CallObject(pmeth, pargs);
+
+  if ( pFLUX == NULL ) {
+    PyErr_Print();
+    sprintf(c1err,"python fetchSED_BYOSED_BATCH failed for NEP=%d", NEP);
+    sprintf(c2err,"EXTERNAL_ID=%d", EXTERNAL_ID);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err);
+  }
+
+  if ( PyObject_GetBuffer(pFLUX, &view, PyBUF_C_CONTIGUOUS) != 0 ||
+       view.len != NBYTE ) {
+    sprintf(c1err,"Invalid SED buffer from python (expect %d x %d doubles)",
+	    NEP, NLAM);
+    sprintf(c2err,"EXTERNAL_ID=%d", EXTERNAL_ID);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err);
+  }
+
+  memcpy(FLUX_SED, view.buf, NBYTE);
+  PyBuffer_Release(&view);
+
+  Py_DECREF(pFLUX);
+  Py_DECREF(pargs);
+  Py_DECREF(pmeth);
+  Py_DECREF(pTLIST);
+#endif
+
+#ifndef USE_PYTHON
+  // C-code: one epoch at a time
+  int iep, NLAM_TMP ;
+  for(iep=0; iep < NEP; iep++ ) {
+    fetchSED_BYOSED(EXTERNAL_ID, NEWEVT_FLAG, Trest_list[iep], MXLAM,
+		    HOSTPAR_LIST, &NLAM_TMP, LAM_SED, &FLUX_SED[iep*NLAM] );
+  }
+#endif
+
+  *NLAM_SED = NLAM ;
+  return ;
+
+} // end fetchSED_BATCH_BYOSED
+
+
 // =====================================================
 void INTEG_zSED_BYOSED(int OPT_SPEC, int ifilt_obs, double Tobs, 
 		       double zHEL, double x0, 
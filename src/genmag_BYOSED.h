@@ -12,6 +12,12 @@
 struct {
   int NLAM;           // number of bins in SED
   double *LAM, *SED;  // SED
+
+  // Oct 2026: SEDs for all epochs of genmag_BYOSED call
+  int    MXEP_BATCH ;   // allocated number of epochs
+  double *Trest_BATCH ; // [iep]
+  double *SED_BATCH ;   // [iep*NLAM + ilam]
+
   int LAST_EXTERNAL_ID ;
 
   int    NPAR ;
@@ -34,6 +40,13 @@ void fetchParVal_BYOSED(double *parVal);
 void fetchSED_BYOSED(int EXTERNAL_ID, int NEWEVT_FLAG, double Tobs, int MXLAM, 
 		     double *HOSTPAR_LIST, int *NLAM, double *LAM, double *FLUX);
 
+void fetchSED_LAM_BYOSED(int MXLAM, int *NLAM, double *LAM);
+void malloc_BATCH_BYOSED(int NEP);
+void fetchSED_BATCH_BYOSED(int EXTERNAL_ID, int NEWEVT_FLAG, 
+			   int NEP, double *Trest_list, int MXLAM,
+			   double *HOSTPAR_LIST, int *NLAM, 
+			   double *LAM, double *FLUX);
+
 void INTEG_zSED_BYOSED(int OPT_SPEC, int IFILT_OBS, double Tobs, 
 		       double zHEL, double x0,
 		       double RV, double AV,
@@ -138,6 +138,26 @@ class genmag_BYOSED:
                                           self.warping_functions[warp](trest,self.wave)[0,:])
 
                 return list(fluxsmear) 
+
+        def fetchSED_BYOSED_BATCH(self,trest_list,maxlam,external_id,new_event):
+                # SED for all epochs in trest_list with one call from C;
+                # returns C-contiguous float64 array [epoch,lam] so that C
+                # can copy the buffer directly. One magsmear draw per epoch
+                # in the order of trest_list, as for fetchSED_BYOSED.
+                if len(self.wave)>maxlam:
+                        raise RuntimeError("Your wavelength array cannot be larger than %i but is %i"%(maxlam,len(self.wave)))
+                trest = np.atleast_1d(np.asarray(trest_list,dtype=float))
+                isort = np.argsort(trest,kind='mergesort')
+
+                fluxsmear = np.empty((len(trest),len(self.wave)))
+                fluxsmear[isort] = self.sedInterp(trest[isort],self.wave)
+                fluxsmear *= 10**(0.4*(np.random.normal(0,self.options.magsmear,size=len(trest))))[:,None]
+                for warp in self.warping_types:
+                        if self.warp_bools[warp]:
+                                fluxsmear[isort]*=10**(self.warping_params[warp]*\
+                                          self.warping_functions[warp](trest[isort],self.wave))
+
+                return np.ascontiguousarray(fluxsmear,dtype=np.float64)
                 
         def fetchParNames_BYOSED(self):
                 parnames = []
@@ -69,12 +69,26 @@
  Aug 31 2016: in genSpec_SALT2(), return of Trest is outside epoch
               range of SALT2 ; cannot extrapolate spectra.
 
+ Oct 2026: new INTEG_zSED_SALT2_BATCH computes Finteg and Fratio for
+           all epochs of one filter; genmag_SALT2 uses it for the
+           interpolated epochs. SEDFLUX rows are now contiguous.
+
+ Oct 2026: new genmag_SALT2_EVENT evaluates all bands & epochs of
+           one event; per-band work moved to genmag_SALT2_BAND.
+
+ Oct 2026: optional SALT2_FLUXTABLE of filter integrals vs. log z and
+           Trest, with color & MW-extinction moments; enabled with
+           sim-input key SALT2_FLUXTABLE_PRECISION.
+
+ Oct 2026: faster gencovar_SALT2 with epochs grouped by filter.
+
 *************************************/
 
 
 #include <stdio.h> 
 #include <math.h>     // log10, pow, ceil, floor
 #include <stdlib.h>   // includes exit(),atof()
+#include <string.h>
 
 #include "sntools.h"           // community tools
 #include "sntools_genSmear.h"
@@ -339,6 +353,9 @@ int init_genmag_SALT2(char *MODEL_VERSION, char *MODEL_EXTRAP_LATETIME,
   init_SALT2interp_SEDFLUX();
   init_SALT2interp_ERRMAP();
 
+  // optional flux table is filled on first call to genmag_SALT2
+  SALT2_FLUXTABLE.INIT_DONE = 0 ;
+
   NCALL_DBUG_SALT2 = 0;
 
   // Summarize CL and errors vs. lambda for Trest = x1 = 0.
@@ -469,10 +486,15 @@ void fill_SALT2_TABLE_SED(int ISED) {
   LAMSTEP_ORIG = TEMP_SEDMODEL.LAMSTEP ;
 
   // --------------------------------------
-  // allocate memory for SED surface
+  // allocate memory for SED surface.
+  // Oct 2026: rows point into one contiguous block so that
+  //           INTEG_zSED_SALT2_BATCH can stream adjacent days.
   SALT2_TABLE.SEDFLUX[ISED] = (double**)malloc(I8p*NDAY_TABLE);
+  SALT2_TABLE.SEDFLUX_BLOCK[ISED] = 
+    (double*)malloc(I8*NDAY_TABLE*NLAM_TABLE);
   for ( IDAY=0; IDAY < NDAY_TABLE; IDAY++ ) {
-    SALT2_TABLE.SEDFLUX[ISED][IDAY] = (double*)malloc(I8*NLAM_TABLE); 
+    SALT2_TABLE.SEDFLUX[ISED][IDAY] = 
+      &SALT2_TABLE.SEDFLUX_BLOCK[ISED][IDAY*NLAM_TABLE] ;
   }
 
   // --------------------------------------
@@ -1524,9 +1546,149 @@ void genmag_SALT2(
 		  ,double *magerr_list  // (O) model mag errors
 		  ) {
 
+  // Return observer frame mag in absolute filter index "ifilt_obs" 
+  // for input SALT2 parameters; see genmag_SALT2_BAND.
+  //
+  // Oct 2026: move everything except extinction tables to
+  //           genmag_SALT2_BAND, which is also used by genmag_SALT2_EVENT.
+
+  // store info for Galactic & host extinction
+  fill_TABLE_MWXT_SEDMODEL(MWXT_SEDMODEL.RV, mwebv);
+  fill_TABLE_HOSTXT_SEDMODEL(RV_host, AV_host, z);   // July 2016
+
+  genmag_SALT2_BAND(OPTMASK, ifilt_obs, x0, x1, x1_forErr, c, mwebv,
+		    RV_host, AV_host, z, z_forErr, Nobs, Tobs_list,
+		    magobs_list, magerr_list, NULL );
+
+} // end of genmag_SALT2
+
+
+// ****************************************************************
+void genmag_SALT2_EVENT(
+		  int OPTMASK     // (I) bit-mask of options (as genmag_SALT2)
+		  ,int NOBS       // (I) number of (filter,epoch) pairs
+		  ,int *ifilt_obs_list // (I) absolute filter index per obs
+		  ,double *Tobs_list   // (I) obs time (since mB max) per obs
+		  ,double x0      // (I) SALT2 x0 parameter
+		  ,double x1      // (I) SALT2 x1-stretch parameter
+		  ,double x1_forErr // (I) x1 used for error calc.
+		  ,double c       // (I) SALT2 color parameter 
+		  ,double mwebv   // (I) Galactic extinction: E(B-V)
+		  ,double RV_host // (I) host RV
+		  ,double AV_host // (I) host AV
+		  ,double z       // (I) Supernova redshift
+		  ,double z_forErr// (I) z used for error calc
+		  ,double *magobs_list  // (O) observed mag per obs
+		  ,double *magerr_list  // (O) model mag error per obs
+		  ,double *Fratio_list  // (O) flux ratio, or NULL
+		  ) {
+
+  // Created Oct 2026
+  // Evaluate SALT2 model for all (filter,epoch) pairs of one event
+  // in any order. Extinction tables are filled once per event,
+  // then epochs are grouped by filter so that each band is integrated
+  // (or interpolated from SALT2_FLUXTABLE) with one call to
+  // genmag_SALT2_BAND, and results are returned in the input order.
+  // Fratio_list is the flux ratio (M1/M0 integrals without Galactic
+  // extinction) used for the model error.
+
+  int MEMD = (NOBS+1) * sizeof(double);
+  int MEMI = (NOBS+1) * sizeof(int);
+  int NFILT_OBS[MXFILTINDX], IOBS_START[MXFILTINDX] ;
+  int ifilt_obs, iobs, i, N, NSUM ;
+  int    *IOBS_SORT ;
+  double *Tobs_band, *mag_band, *err_band, *Fratio_band ;
+  char fnam[] = "genmag_SALT2_EVENT" ;
+
+  // ------------- BEGIN -------------
+
+  if ( NOBS <= 0 ) { return ; }
+
+  fill_TABLE_MWXT_SEDMODEL(MWXT_SEDMODEL.RV, mwebv);
+  fill_TABLE_HOSTXT_SEDMODEL(RV_host, AV_host, z);
+
+  // counting-sort obs by filter
+  for(ifilt_obs=0; ifilt_obs < MXFILTINDX; ifilt_obs++ ) 
+    { NFILT_OBS[ifilt_obs] = 0 ; }
+
+  for(iobs=0; iobs < NOBS; iobs++ ) {
+    ifilt_obs = ifilt_obs_list[iobs] ;
+    if ( ifilt_obs < 0 || ifilt_obs >= MXFILTINDX ) {
+      sprintf(c1err,"Invalid ifilt_obs=%d for iobs=%d", ifilt_obs, iobs);
+      sprintf(c2err,"Valid range is 0 to %d", MXFILTINDX-1);
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    }
+    NFILT_OBS[ifilt_obs]++ ;
+  }
+
+  NSUM = 0 ;
+  for(ifilt_obs=0; ifilt_obs < MXFILTINDX; ifilt_obs++ ) 
+    { IOBS_START[ifilt_obs] = NSUM ;  NSUM += NFILT_OBS[ifilt_obs] ; }
+
+  IOBS_SORT   = (int   *)malloc(MEMI);
+  Tobs_band   = (double*)malloc(MEMD);
+  mag_band    = (double*)malloc(MEMD);
+  err_band    = (double*)malloc(MEMD);
+  Fratio_band = (double*)malloc(MEMD);
+
+  for(ifilt_obs=0; ifilt_obs < MXFILTINDX; ifilt_obs++ ) 
+    { NFILT_OBS[ifilt_obs] = 0 ; }
+  for(iobs=0; iobs < NOBS; iobs++ ) {
+    ifilt_obs = ifilt_obs_list[iobs] ;
+    i = IOBS_START[ifilt_obs] + NFILT_OBS[ifilt_obs] ;
+    IOBS_SORT[i] = iobs ;
+    Tobs_band[i] = Tobs_list[iobs] ;
+    NFILT_OBS[ifilt_obs]++ ;
+  }
+
+  // evaluate each band
+  for(ifilt_obs=0; ifilt_obs < MXFILTINDX; ifilt_obs++ ) {
+    N = NFILT_OBS[ifilt_obs] ;
+    if ( N == 0 ) { continue ; }
+    i = IOBS_START[ifilt_obs] ;
+    genmag_SALT2_BAND(OPTMASK, ifilt_obs, x0, x1, x1_forErr, c, mwebv,
+		      RV_host, AV_host, z, z_forErr, N, &Tobs_band[i],
+		      &mag_band[i], &err_band[i], &Fratio_band[i] );
+  }
+
+  // return in original order
+  for(i=0; i < NOBS; i++ ) {
+    iobs = IOBS_SORT[i] ;
+    magobs_list[iobs] = mag_band[i] ;
+    magerr_list[iobs] = err_band[i] ;
+    if ( Fratio_list != NULL ) { Fratio_list[iobs] = Fratio_band[i] ; }
+  }
+
+  free(IOBS_SORT);  free(Tobs_band);  
+  free(mag_band);   free(err_band);   free(Fratio_band);
+
+} // end of genmag_SALT2_EVENT
+
+
+// ****************************************************************
+void genmag_SALT2_BAND(
+		  int OPTMASK     // (I) bit-mask of options (LSB=0)
+		  ,int ifilt_obs  // (I) absolute filter index
+		  ,double x0      // (I) SALT2 x0 parameter
+		  ,double x1      // (I) SALT2 x1-stretch parameter
+		  ,double x1_forErr // (I) x1 used for error calc.
+		  ,double c       // (I) SALT2 color parameter 
+		  ,double mwebv   // (I) Galactic extinction: E(B-V)
+		  ,double RV_host // (I) for Mandel SALT2+XThost model
+		  ,double AV_host // (I) for Mandel SALT2+XThost model
+		  ,double z       // (I) Supernova redshift
+		  ,double z_forErr// (I) z used for error calc (Mar 2018)
+		  ,int Nobs       // (I) number of epochs
+		  ,double *Tobs_list   // (I) list of obs times (since mB max) 
+		  ,double *magobs_list  // (O) observed mag values
+		  ,double *magerr_list  // (O) model mag errors
+		  ,double *Fratio_list  // (O) flux ratio for errors, or NULL
+		  ) {
+
   /****
   Return observer frame mag in absolute filter index "ifilt_obs" 
-  for input SALT2 parameters.
+  for input SALT2 parameters. Extinction tables must already be
+  filled (see genmag_SALT2 and genmag_SALT2_EVENT).
 
    OPTMASK=1 => return flux instead of mag ; magerr still in mag.
                      (to avoid discontinuity for negative flux)
@@ -1573,7 +1735,7 @@ void genmag_SALT2(
   int  LDMP_DEBUG,OPT_PRINT_BADFLUX, OPT_RETURN_MAG ;
   int  OPT_RETURN_FLUX, OPT_DOERR ;    
 
-  char fnam[] = "genmag_SALT2" ;
+  char fnam[] = "genmag_SALT2_BAND" ;
 
   // ----------------- BEGIN -----------------
 
@@ -1601,9 +1763,45 @@ void genmag_SALT2(
   // make sure filter-lambda range is valid
   checkLamRange_SEDMODEL(ifilt,z,fnam);
 
-  // store info for Galactic & host extinction
-  fill_TABLE_MWXT_SEDMODEL(MWXT_SEDMODEL.RV, mwebv);
-  fill_TABLE_HOSTXT_SEDMODEL(RV_host, AV_host, z);   // July 2016
+  // Oct 2026: compute Trest_interp for all epochs first, then
+  // integrate all epochs with one call to INTEG_zSED_SALT2_BATCH.
+  double *Tobs_interp_list   = (double*)malloc(Nobs*sizeof(double));
+  double *Finteg_interp_list = (double*)malloc(Nobs*sizeof(double));
+  double *Fratio_interp_list = (double*)malloc(Nobs*sizeof(double));
+  for ( epobs=0; epobs < Nobs; epobs++ ) {
+    Trest = Tobs_list[epobs] / z1 ;
+    Trest_interp = Trest ;
+    if ( Trest <= SALT2_TABLE.DAYMIN+epsT )
+      { Trest_interp = SALT2_TABLE.DAYMIN+epsT ; }
+    else if ( Trest >= SALT2_TABLE.DAYMAX-epsT ) 
+      { Trest_interp = SALT2_TABLE.DAYMAX-epsT ; }
+    if ( INPUT_EXTRAP_LATETIME.NLAMBIN && 
+	 Trest > INPUT_EXTRAP_LATETIME.DAYMIN ) 
+      { Trest_interp = INPUT_EXTRAP_LATETIME.DAYMIN ; }
+    Tobs_interp_list[epobs] = Trest_interp * z1 ;
+  }
+
+  // Oct 2026: check option to interpolate flux table instead of
+  // integrating; any epoch that fails the precision requirement
+  // reverts to integration for this filter. Table does not include
+  // intrinsic smearing or host extinction.
+  int NTABLE = 0 ;
+  if ( !SALT2_FLUXTABLE.INIT_DONE ) { init_FLUXTABLE_SALT2(); }
+  if ( SALT2_FLUXTABLE.USE && !istat_genSmear() && AV_host < 1.0E-9 ) {
+    for ( epobs=0; epobs < Nobs; epobs++ ) {
+      NTABLE += 
+	interp_FLUXTABLE_SALT2(ifilt_obs, z, Tobs_interp_list[epobs],
+			       x0, x1, c, mwebv, &Finteg_interp_list[epobs],
+			       &Fratio_interp_list[epobs] );
+      if ( NTABLE <= epobs ) { break ; }
+    }
+  }
+
+  if ( NTABLE < Nobs ) {
+    INTEG_zSED_SALT2_BATCH(ifilt_obs, z, Nobs, Tobs_interp_list, 
+			   x0, x1, c, RV_host, AV_host,
+			   Finteg_interp_list, Fratio_interp_list ); // returned
+  }
 
   //determine integer times which sandwich the times in Tobs
 
@@ -1630,11 +1828,22 @@ void genmag_SALT2(
     }
    
 
-    // brute force integration
-    Tobs_interp = Trest_interp * z1 ;
-    INTEG_zSED_SALT2(0,ifilt_obs, z, Tobs_interp, x0,x1,c, RV_host, AV_host,
-		     &Finteg, &Finteg_ratio, FspecDum ); // returned
-    flux_interp = Finteg ;
+    // brute force integration (from batch call above)
+    Tobs_interp  = Tobs_interp_list[epobs] ;
+    Finteg       = Finteg_interp_list[epobs] ;
+    Finteg_ratio = Fratio_interp_list[epobs] ;
+    flux_interp  = Finteg ;
+
+    if ( LDMP_DEBUG ) {
+      // compare batch integration with scalar integration
+      double Finteg_scalar, Fratio_scalar ;
+      INTEG_zSED_SALT2(0,ifilt_obs, z, Tobs_interp, x0,x1,c, RV_host,AV_host,
+		       &Finteg_scalar, &Fratio_scalar, FspecDum ); 
+      printf(" xxxx %s: Finteg(%s,SCALAR) = %le, %le  "
+	     "Fratio(%s,SCALAR) = %le, %le \n",
+	     fnam, (NTABLE==Nobs ? "TABLE" : "BATCH"), Finteg, Finteg_scalar, 
+	     (NTABLE==Nobs ? "TABLE" : "BATCH"), Finteg_ratio, Fratio_scalar );
+    }
 
     // ------------------------
 
@@ -1728,14 +1937,16 @@ void genmag_SALT2(
 
     // load magerr onto output list
     magerr_list[epobs] = magerr ;  // load error to output array
+    if ( Fratio_list != NULL ) { Fratio_list[epobs] = Finteg_ratio ; }
 
 
   } // end epobs loop over epochs
 
+  free(Tobs_interp_list);  free(Finteg_interp_list);  free(Fratio_interp_list);
 
   return ;
 
-} // end of genmag_SALT2
+} // end of genmag_SALT2_BAND
 
 
 // *****************************************
@@ -2217,6 +2428,674 @@ void INTEG_zSED_SALT2(int OPT_SPEC, int ifilt_obs, double z, double Tobs,
 } // end of INTEG_zSED_SALT2
 
 
+// **********************************************
+void INTEG_zSED_SALT2_BATCH(int ifilt_obs, double z, int NEP, 
+			    double *Tobs_list, double x0, double x1, double c,
+			    double RV_host, double AV_host,
+			    double *Finteg_list, double *Fratio_list ) {
+
+  // Created Oct 2026
+  // Same as INTEG_zSED_SALT2 with OPT_SPEC=0, but for NEP epochs
+  // of one filter. Returns Finteg_list[iep] and Fratio_list[iep].
+  //
+  // Everything except the SED flux is independent of epoch, so the
+  // filter-bin weights (color law, host & MW extinction, LAMSED*TRANS)
+  // and the lambda-interpolation fractions are folded onto the SED
+  // lambda grid once per call. Each epoch then needs only branch-free
+  // dot products of the folded weights with two contiguous SEDFLUX
+  // rows (IDAY and IDAY+1). With intrinsic smearing the folded weights
+  // are re-computed for each epoch only if magSmear depends on Trest
+  // (istat_genSmear_Trest).
+  //
+  // Results agree with INTEG_zSED_SALT2 up to round-off from the
+  // different summation order; see LDMP_DEBUG dump in genmag_SALT2.
+
+  int  ifilt, NLAMFILT, ilamobs, ilamsed, ibin, NBIN, j ;
+  int  iep, IDAY, ised, ic, ISTAT_SMEAR, LABORT, NLAMSUM, ILAMMIN, ILAMMAX;
+  int  TRESTDEP_SMEAR ;
+  double z1, Trest, LAMOBS, LAMSED, LAMDIF, LAMSED_STEP, LAMFILT_STEP ;
+  double TRANS, MWXT_FRAC, HOSTXT_FRAC, CCOR, CCOR_LAM0, CCOR_LAM1 ;
+  double VAL0, VAL1, CDIF, CNEAR, FRAC_INTERP_COLOR, FRAC_INTERP_LAMSED ;
+  double FRAC_INTERP_DAY, MODELNORM_Finteg, FSMEAR, W0, W1, FRAC ;
+  double D0, D1, F_flux[2], F_err[2], *ROW0, *ROW1 ;
+  double lam[MXBIN_LAMFILT_SEDMODEL], magSmear[MXBIN_LAMFILT_SEDMODEL] ;
+  double hc8 = (double)hc ;
+  char *cfilt ;
+  char fnam[] = "INTEG_zSED_SALT2_BATCH" ;
+
+  // ----------- BEGIN ---------------
+
+  for(iep=0; iep < NEP; iep++ ) 
+    { Finteg_list[iep] = Fratio_list[iep] = 0.0 ; }
+  if ( NEP <= 0 ) { return ; }
+
+  if ( SALT2_BATCH.MXLAM == 0 ) { init_SALT2_BATCH(0); }
+
+  ifilt     = IFILTMAP_SEDMODEL[ifilt_obs] ;
+  NLAMFILT  = FILTER_SEDMODEL[ifilt].NLAM ;
+  cfilt     = FILTER_SEDMODEL[ifilt].name ;
+  z1        = 1. + z ;
+
+  LAMFILT_STEP = FILTER_SEDMODEL[ifilt].lamstep; 
+  LAMSED_STEP  = SALT2_TABLE.LAMSTEP ;
+  MODELNORM_Finteg = LAMFILT_STEP * SEDMODEL.FLUXSCALE / hc8 ;
+
+  CDIF  = c - SALT2_TABLE.CMIN ;
+  ic    = (int)(CDIF / SALT2_TABLE.CSTEP) ;
+  if ( ic < 0 ) 
+    { ic = 0 ; }
+  if ( ic > SALT2_TABLE.NCBIN - 2 ) 
+    { ic = SALT2_TABLE.NCBIN - 2 ; }
+  CNEAR = SALT2_TABLE.COLOR[ic] ;
+  FRAC_INTERP_COLOR = (c - CNEAR)/SALT2_TABLE.CSTEP ;
+
+  // - - - - - - - - - - - - - - - - - - - - - - - -
+  // store epoch-independent weight for each used filter bin
+  NBIN = 0 ;  ILAMMIN = 999999 ;  ILAMMAX = -9 ;
+  for ( ilamobs=0; ilamobs < NLAMFILT; ilamobs++ ) {
+
+    TRANS  = FILTER_SEDMODEL[ifilt].transSN[ilamobs] ;
+    if ( TRANS < 1.0E-12 ) { continue ; } 
+
+    LAMOBS = FILTER_SEDMODEL[ifilt].lam[ilamobs] ;
+    LAMSED = LAMOBS / z1 ;
+    if ( LAMSED <= SALT2_TABLE.LAMMIN ) { continue ; }
+    if ( LAMSED >= SALT2_TABLE.LAMMAX ) { continue ; } 
+
+    LAMDIF  = LAMSED - SALT2_TABLE.LAMMIN ;
+    ilamsed = (int)(LAMDIF/LAMSED_STEP);
+    LAMDIF  = LAMSED - SALT2_TABLE.LAMSED[ilamsed] ;
+    FRAC_INTERP_LAMSED = LAMDIF / LAMSED_STEP ;
+
+    LABORT = ( FRAC_INTERP_LAMSED < -1.0E-8 || 
+	       FRAC_INTERP_LAMSED > 1.0000000001 ) ;
+    if ( LABORT ) {
+      sprintf(c1err,"Invalid FRAC_INTERP_LAMSED=%le for LAMOBS=%.2f", 
+	      FRAC_INTERP_LAMSED, LAMOBS );
+      sprintf(c2err,"check filter %s at z=%5.3f  c=%6.3f", cfilt, z, c);
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    }
+
+    MWXT_FRAC  = SEDMODEL_TABLE_MWXT_FRAC[ifilt][ilamobs] ;
+    if( RV_host > 1.0E-9 && AV_host > 1.0E-9 ) 
+      { HOSTXT_FRAC = SEDMODEL_TABLE_HOSTXT_FRAC[ifilt][ilamobs] ; }
+    else 
+      { HOSTXT_FRAC = 1.0 ; }
+
+    VAL0  = SALT2_TABLE.COLORLAW[ic+0][ilamsed];
+    VAL1  = SALT2_TABLE.COLORLAW[ic+1][ilamsed];
+    CCOR_LAM0  = VAL0 + (VAL1-VAL0) * FRAC_INTERP_COLOR ;
+    VAL0  = SALT2_TABLE.COLORLAW[ic+0][ilamsed+1];
+    VAL1  = SALT2_TABLE.COLORLAW[ic+1][ilamsed+1];
+    CCOR_LAM1  = VAL0 + (VAL1-VAL0) * FRAC_INTERP_COLOR ;
+    CCOR = CCOR_LAM0 + (CCOR_LAM1-CCOR_LAM0)*FRAC_INTERP_LAMSED ;
+
+    SALT2_BATCH.ILAMOBS[NBIN]     = ilamobs ;
+    SALT2_BATCH.ILAMSED[NBIN]     = ilamsed ;
+    SALT2_BATCH.FRAC_LAMSED[NBIN] = FRAC_INTERP_LAMSED ;
+    SALT2_BATCH.WGT_ERR[NBIN]     = CCOR * HOSTXT_FRAC * LAMSED * TRANS ;
+    SALT2_BATCH.WGT_FLUX[NBIN]    = SALT2_BATCH.WGT_ERR[NBIN] * MWXT_FRAC;
+    if ( ilamsed < ILAMMIN ) { ILAMMIN = ilamsed ; }
+    if ( ilamsed > ILAMMAX ) { ILAMMAX = ilamsed ; }
+    NBIN++ ;
+  }
+
+  SALT2_BATCH.NBIN        = NBIN ;
+  if ( NBIN == 0 ) { return ; }
+
+  NLAMSUM = ILAMMAX - ILAMMIN + 2 ;  // includes ilamsed+1 of last bin
+  SALT2_BATCH.ILAMSED_MIN = ILAMMIN ;
+  SALT2_BATCH.NLAMSED     = NLAMSUM ;
+
+  ISTAT_SMEAR    = istat_genSmear();  
+  TRESTDEP_SMEAR = ISTAT_SMEAR && istat_genSmear_Trest() ;
+  if ( ISTAT_SMEAR ) {
+    for ( ilamobs=0; ilamobs < NLAMFILT; ilamobs++ ) {
+      LAMOBS       = FILTER_SEDMODEL[ifilt].lam[ilamobs] ;
+      lam[ilamobs] = LAMOBS/z1 ;
+    }
+  }
+  else 
+    { for(ilamobs=0; ilamobs < NLAMFILT; ilamobs++) { magSmear[ilamobs]=0.0;} }
+
+  // - - - - - - - - - - - - - - - - - - - - - - - -
+  // loop over epochs
+  for(iep=0; iep < NEP; iep++ ) {
+
+    Trest = Tobs_list[iep]/z1 ;
+    IDAY  = (int)((Trest - SALT2_TABLE.DAY[0])/SALT2_TABLE.DAYSTEP);
+    FRAC_INTERP_DAY = (Trest - SALT2_TABLE.DAY[IDAY])/SALT2_TABLE.DAYSTEP ;
+
+    // fold weights onto SED lambda grid; for smearing, this must
+    // be done for each epoch unless smear is independent of Trest.
+    if ( iep == 0 || TRESTDEP_SMEAR ) {
+
+      if ( ISTAT_SMEAR ) {
+	int NLAMTMP = 0 ;
+	for ( ilamobs=0; ilamobs < NLAMFILT; ilamobs++ ) {
+	  magSmear[ilamobs] = 0.0 ;
+	  if ( lam[ilamobs] >= SALT2_TABLE.LAMMAX ) { continue ; }       
+	  NLAMTMP++ ;
+	}
+	get_genSmear( Trest, NLAMTMP, lam, magSmear) ;
+      }
+
+      for(j=0; j < NLAMSUM; j++ ) 
+	{ SALT2_BATCH.SUMWGT_FLUX[j] = SALT2_BATCH.SUMWGT_ERR[j] = 0.0 ; }
+
+      for(ibin=0; ibin < NBIN; ibin++ ) {
+	j      = SALT2_BATCH.ILAMSED[ibin] - ILAMMIN ;
+	FRAC   = SALT2_BATCH.FRAC_LAMSED[ibin] ;
+	FSMEAR = 1.0 ;
+	if ( ISTAT_SMEAR ) 
+	  { FSMEAR = pow(TEN,-0.4*magSmear[SALT2_BATCH.ILAMOBS[ibin]]); }
+
+	W0 = SALT2_BATCH.WGT_FLUX[ibin] * FSMEAR ;
+	SALT2_BATCH.SUMWGT_FLUX[j]   += W0 * (1.0-FRAC) ;
+	SALT2_BATCH.SUMWGT_FLUX[j+1] += W0 * FRAC ;
+	W1 = SALT2_BATCH.WGT_ERR[ibin] * FSMEAR ;
+	SALT2_BATCH.SUMWGT_ERR[j]    += W1 * (1.0-FRAC) ;
+	SALT2_BATCH.SUMWGT_ERR[j+1]  += W1 * FRAC ;
+      }
+    }
+
+    for(ised=0; ised<=1; ised++ ) {
+      ROW0 = &SALT2_TABLE.SEDFLUX[ised][IDAY][ILAMMIN] ;
+      ROW1 = &SALT2_TABLE.SEDFLUX[ised][IDAY+1][ILAMMIN] ;
+
+      D0 = dot_SALT2_BATCH(NLAMSUM, SALT2_BATCH.SUMWGT_FLUX, ROW0);
+      D1 = dot_SALT2_BATCH(NLAMSUM, SALT2_BATCH.SUMWGT_FLUX, ROW1);
+      F_flux[ised] = D0 + (D1-D0)*FRAC_INTERP_DAY ;
+
+      D0 = dot_SALT2_BATCH(NLAMSUM, SALT2_BATCH.SUMWGT_ERR, ROW0);
+      D1 = dot_SALT2_BATCH(NLAMSUM, SALT2_BATCH.SUMWGT_ERR, ROW1);
+      F_err[ised]  = D0 + (D1-D0)*FRAC_INTERP_DAY ;
+    }
+
+    Finteg_list[iep] = x0*(F_flux[0] + x1*F_flux[1]) * MODELNORM_Finteg ;
+    if ( F_flux[0] != 0.0 ) 
+      { Fratio_list[iep] = F_err[1] / F_err[0] ; }
+
+  } // end iep
+
+  return ;
+
+} // end of INTEG_zSED_SALT2_BATCH
+
+
+// **********************************************
+void init_SALT2_BATCH(int MXLAM) {
+
+  // Created Oct 2026
+  // Allocate work space for INTEG_zSED_SALT2_BATCH.
+  // MXLAM=0 -> size for largest filter or SED lambda grid.
+
+  int MEMI, MEMD ;
+
+  if ( MXLAM <= 0 ) {
+    MXLAM = MXBIN_LAMFILT_SEDMODEL ;
+    if ( SALT2_TABLE.NLAMSED+2 > MXLAM ) { MXLAM = SALT2_TABLE.NLAMSED+2 ; }
+  }
+  MEMI = MXLAM * sizeof(int);
+  MEMD = MXLAM * sizeof(double);
+
+  SALT2_BATCH.MXLAM       = MXLAM ;
+  SALT2_BATCH.ILAMOBS     = (int   *)malloc(MEMI);
+  SALT2_BATCH.ILAMSED     = (int   *)malloc(MEMI);
+  SALT2_BATCH.FRAC_LAMSED = (double*)malloc(MEMD);
+  SALT2_BATCH.WGT_FLUX    = (double*)malloc(MEMD);
+  SALT2_BATCH.WGT_ERR     = (double*)malloc(MEMD);
+  SALT2_BATCH.SUMWGT_FLUX = (double*)malloc(MEMD);
+  SALT2_BATCH.SUMWGT_ERR  = (double*)malloc(MEMD);
+
+} // end of init_SALT2_BATCH
+
+
+// **********************************************
+double dot_SALT2_BATCH(int N, double *A, double *B) {
+
+  // Created Oct 2026
+  // Return sum A[i]*B[i] over contiguous arrays.
+  // Four independent partial sums allow the compiler to
+  // vectorize without re-ordering a single serial sum.
+
+  int i, N4 = N - (N % 4) ;
+  double S0=0.0, S1=0.0, S2=0.0, S3=0.0 ;
+
+  for ( i=0; i < N4; i+=4 ) {
+    S0 += A[i+0]*B[i+0] ;
+    S1 += A[i+1]*B[i+1] ;
+    S2 += A[i+2]*B[i+2] ;
+    S3 += A[i+3]*B[i+3] ;
+  }
+  for ( ; i < N; i++ ) { S0 += A[i]*B[i] ; }
+
+  return( (S0+S1) + (S2+S3) ) ;
+
+} // end of dot_SALT2_BATCH
+
+
+// **********************************************
+void init_FLUXTABLE_SALT2(void) {
+
+  // Created Oct 2026
+  // If INPUTS_SEDMODEL.SALT2_FLUXTABLE_PRECISION > 0, prepare table
+  // of filter integrals on a grid of log10(z) and SALT2 table days,
+  // so that genmag_SALT2 can interpolate instead of integrating.
+  // Redshift range is from REDSHIFT_SEDMODEL (init_redshift_SEDMODEL).
+  //
+  // If SALT2_FLUXTABLE_PATH is set, the table is read from (or written
+  // to) a binary cache file whose name includes a checksum of the
+  // filter transmissions (i.e., the kcor file), SED surfaces,
+  // color law, MW color law and binning. Changing any of these
+  // results in a new cache file.
+
+  double PRECISION = INPUTS_SEDMODEL.SALT2_FLUXTABLE_PRECISION ;
+  char  *PATH      = INPUTS_SEDMODEL.SALT2_FLUXTABLE_PATH ;
+  SALT2_FLUXTABLE_HEAD_DEF *HEAD = &SALT2_FLUXTABLE.HEAD ;
+
+  int    NZ, ifilt, ised, NLAM, NTMP, MEMG ;
+  double LOGZMIN, LOGZMAX, XMEM ;
+  unsigned long long CKSUM ;
+  char   fileName[400] ;
+  char   fnam[] = "init_FLUXTABLE_SALT2" ;
+
+  // ------------ BEGIN -------------
+
+  SALT2_FLUXTABLE.INIT_DONE = 1 ;
+  SALT2_FLUXTABLE.USE       = 0 ;
+  SALT2_FLUXTABLE.NCALL     = SALT2_FLUXTABLE.NFALLBACK = 0 ;
+
+  if ( PRECISION <= 0.0 ) { return ; }
+
+  if ( REDSHIFT_SEDMODEL.NZBIN <= 0 || REDSHIFT_SEDMODEL.ZMIN <= 0.0 ) {
+    printf("\n %s: no redshift range -> cannot use SALT2 flux table.\n",
+	   fnam);
+    fflush(stdout);
+    return ;
+  }
+
+  // include one extra bin on each side for cubic interpolation
+  LOGZMIN = log10(REDSHIFT_SEDMODEL.ZMIN) - DLOGZ_FLUXTABLE_SALT2 ;
+  LOGZMAX = log10(REDSHIFT_SEDMODEL.ZMAX) + DLOGZ_FLUXTABLE_SALT2 ;
+  NZ      = (int)((LOGZMAX-LOGZMIN)/DLOGZ_FLUXTABLE_SALT2) + 2 ;
+  if ( NZ < 4 ) { NZ = 4 ; }
+
+  memset(HEAD, 0, sizeof(SALT2_FLUXTABLE_HEAD_DEF) );
+  HEAD->VERSION      = VERSION_FLUXTABLE_SALT2 ;
+  HEAD->NFILT        = NFILT_SEDMODEL ;
+  HEAD->NZ           = NZ ;
+  HEAD->NDAY         = SALT2_TABLE.NDAY ;
+  HEAD->NCMOM        = NCMOM_FLUXTABLE_SALT2 ;
+  HEAD->LOGZMIN      = LOGZMIN ;
+  HEAD->LOGZBIN      = DLOGZ_FLUXTABLE_SALT2 ;
+  HEAD->RV           = MWXT_SEDMODEL.RV ;
+  HEAD->OPT_COLORLAW = MWXT_SEDMODEL.OPT_COLORLAW ;
+
+  // checksum of everything that goes into the table
+  CKSUM = CKSUM_INIT_FNV1A ;
+  cksum_FNV1a(HEAD, sizeof(SALT2_FLUXTABLE_HEAD_DEF), &CKSUM);
+  for(ifilt=1; ifilt <= NFILT_SEDMODEL; ifilt++ ) {
+    NLAM = FILTER_SEDMODEL[ifilt].NLAM ;
+    cksum_FNV1a(FILTER_SEDMODEL[ifilt].name, 
+		strlen(FILTER_SEDMODEL[ifilt].name), &CKSUM);
+    cksum_FNV1a(FILTER_SEDMODEL[ifilt].lam,     NLAM*sizeof(double), &CKSUM);
+    cksum_FNV1a(FILTER_SEDMODEL[ifilt].transSN, NLAM*sizeof(double), &CKSUM);
+  }
+  NTMP = SALT2_TABLE.NDAY * SALT2_TABLE.NLAMSED ;
+  for(ised=0; ised<=1; ised++ ) {
+    cksum_FNV1a(SALT2_TABLE.SEDFLUX_BLOCK[ised], NTMP*sizeof(double), 
+		&CKSUM);
+  }
+  cksum_FNV1a(SALT2_TABLE.DAY,    SALT2_TABLE.NDAY*sizeof(double), &CKSUM);
+  cksum_FNV1a(SALT2_TABLE.LAMSED, SALT2_TABLE.NLAMSED*sizeof(double),&CKSUM);
+  cksum_FNV1a(&INPUT_SALT2_INFO.COLORLAW_VERSION, sizeof(int), &CKSUM);
+  cksum_FNV1a(INPUT_SALT2_INFO.COLORLAW_PARAMS,
+	      INPUT_SALT2_INFO.NCOLORLAW_PARAMS*sizeof(double), &CKSUM);
+  cksum_FNV1a(&INPUT_SALT2_INFO.COLOR_OFFSET, sizeof(double), &CKSUM);
+  HEAD->CKSUM = CKSUM ;
+
+  // allocate table
+  SALT2_FLUXTABLE.NMOMENT = 
+    (long long)NFILT_SEDMODEL * (long long)NZ * (long long)HEAD->NDAY 
+    * 4LL * (long long)NCMOM_FLUXTABLE_SALT2 ;
+  MEMG = NFILT_SEDMODEL * NZ * sizeof(double);
+  SALT2_FLUXTABLE.MOMENT = 
+    (float*)malloc(SALT2_FLUXTABLE.NMOMENT*sizeof(float));
+  SALT2_FLUXTABLE.GMAX   = (double*)malloc(MEMG);
+  SALT2_FLUXTABLE.HRANGE = (double*)malloc(MEMG);
+  XMEM = 1.0E-6 * (double)(SALT2_FLUXTABLE.NMOMENT*sizeof(float)) ;
+
+  printf("\n %s: NFILT=%d  NZ=%d (%.4f<z<%.4f)  NDAY=%d  (%.1f MB)\n",
+	 fnam, NFILT_SEDMODEL, NZ, 
+	 pow(TEN,LOGZMIN), pow(TEN,LOGZMIN+(NZ-1)*DLOGZ_FLUXTABLE_SALT2),
+	 HEAD->NDAY, XMEM );
+  fflush(stdout);
+
+  // check binary cache
+  fileName[0] = 0 ;
+  if ( strlen(PATH) > 0 && IGNOREFILE(PATH) == 0 ) {
+    sprintf(fileName,"%s/SALT2_FLUXTABLE_%s-%s_%16.16llx.BINARY",
+	    PATH, SALT2_VERSION, FILTLIST_SEDMODEL, CKSUM );
+  }
+
+  if ( fileName[0] != 0 && read_FLUXTABLE_SALT2(fileName) ) {
+    printf("\t Read SALT2 flux table from %s\n", fileName);
+  }
+  else {
+    fill_FLUXTABLE_SALT2();
+    if ( fileName[0] != 0 ) { write_FLUXTABLE_SALT2(fileName); }
+  }
+
+  printf("\t Use SALT2 flux table if mag precision < %.4f \n", PRECISION);
+  fflush(stdout);
+
+  SALT2_FLUXTABLE.USE = 1 ;
+
+} // end of init_FLUXTABLE_SALT2
+
+
+// **********************************************
+void fill_FLUXTABLE_SALT2(void) {
+
+  // Created Oct 2026
+  // For each filter and redshift, fold lambda-dependent weights onto
+  // SED lambda grid (as in INTEG_zSED_SALT2_BATCH), and store
+  //   MOMENT[imw][k] = Integral SED * LAMSED * TRANS * g^k * h^imw
+  // for each SED surface and table day. g = ln(colorCor)/c is the
+  // color law and h = ln(MWXT_FRAC)/mwebv is the Galactic extinction.
+  // Bins are skipped exactly as in INTEG_zSED_SALT2.
+
+#define MWEBV_REF_FLUXTABLE 0.1  // reference E(B-V) to evaluate h
+
+  SALT2_FLUXTABLE_HEAD_DEF *HEAD = &SALT2_FLUXTABLE.HEAD ;
+  int    NZ = HEAD->NZ, NDAY = HEAD->NDAY, NCMOM = HEAD->NCMOM ;
+  double RV = HEAD->RV ;
+  int    ifilt, iz, NLAMFILT, ilamobs, ilamsed, ibin, NBIN, j, k, imw ;
+  int    iday, ised, ILAMMIN, ILAMMAX, NLAMSUM, jzf ;
+  long long INDEX ;
+  double z, z1, LAMOBS, LAMSED, LAMDIF, TRANS, FRAC, G, W, HMIN, HMAX ;
+  double XT, GMAX, *SUMWGT ;
+  double H[MXBIN_LAMFILT_SEDMODEL], GBIN[MXBIN_LAMFILT_SEDMODEL] ;
+  double WBIN[MXBIN_LAMFILT_SEDMODEL] ;
+  double cc1 = INPUT_SALT2_INFO.COLOR_OFFSET + 1.0 ;
+
+  // ------------ BEGIN -------------
+
+  if ( SALT2_BATCH.MXLAM == 0 ) { init_SALT2_BATCH(0); }
+  SUMWGT = SALT2_BATCH.SUMWGT_FLUX ;
+
+  for(ifilt=1; ifilt <= HEAD->NFILT; ifilt++ ) {
+
+    NLAMFILT = FILTER_SEDMODEL[ifilt].NLAM ;
+    for ( ilamobs=0; ilamobs < NLAMFILT; ilamobs++ ) {
+      LAMOBS     = FILTER_SEDMODEL[ifilt].lam[ilamobs] ;
+      XT         = GALextinct(RV, RV*MWEBV_REF_FLUXTABLE, LAMOBS, 
+			      HEAD->OPT_COLORLAW);
+      H[ilamobs] = -0.4*LNTEN*XT/MWEBV_REF_FLUXTABLE ;
+    }
+
+    for(iz=0; iz < NZ; iz++ ) {
+      z   = pow(TEN, HEAD->LOGZMIN + HEAD->LOGZBIN*(double)iz) ;
+      z1  = 1.0 + z ;
+      jzf = (ifilt-1)*NZ + iz ;
+
+      NBIN = 0 ; ILAMMIN = 999999 ;  ILAMMAX = -9 ;
+      GMAX = 0.0 ;  HMIN = 1.0E9 ;  HMAX = -1.0E9 ;
+      for ( ilamobs=0; ilamobs < NLAMFILT; ilamobs++ ) {
+	TRANS  = FILTER_SEDMODEL[ifilt].transSN[ilamobs] ;
+	if ( TRANS < 1.0E-12 ) { continue ; } 
+	LAMOBS = FILTER_SEDMODEL[ifilt].lam[ilamobs] ;
+	LAMSED = LAMOBS / z1 ;
+	if ( LAMSED <= SALT2_TABLE.LAMMIN ) { continue ; }
+	if ( LAMSED >= SALT2_TABLE.LAMMAX ) { continue ; } 
+
+	LAMDIF  = LAMSED - SALT2_TABLE.LAMMIN ;
+	ilamsed = (int)(LAMDIF/SALT2_TABLE.LAMSTEP);
+	LAMDIF  = LAMSED - SALT2_TABLE.LAMSED[ilamsed] ;
+	G       = log(SALT2colorCor(LAMSED,cc1)) ;
+
+	SALT2_BATCH.ILAMOBS[NBIN]     = ilamobs ;
+	SALT2_BATCH.ILAMSED[NBIN]     = ilamsed ;
+	SALT2_BATCH.FRAC_LAMSED[NBIN] = LAMDIF / SALT2_TABLE.LAMSTEP ;
+	GBIN[NBIN] = G ;
+	if ( fabs(G) > GMAX ) { GMAX = fabs(G); }
+	if ( H[ilamobs] < HMIN ) { HMIN = H[ilamobs]; }
+	if ( H[ilamobs] > HMAX ) { HMAX = H[ilamobs]; }
+	if ( ilamsed < ILAMMIN ) { ILAMMIN = ilamsed ; }
+	if ( ilamsed > ILAMMAX ) { ILAMMAX = ilamsed ; }
+	NBIN++ ;
+      }
+
+      SALT2_FLUXTABLE.GMAX[jzf]   = GMAX ;
+      SALT2_FLUXTABLE.HRANGE[jzf] = ( NBIN > 0 ? HMAX-HMIN : 0.0 ) ;
+      NLAMSUM = ILAMMAX - ILAMMIN + 2 ;
+
+      for(imw=0; imw <= 1; imw++ ) {
+
+	// start with k=0 weights
+	for(ibin=0; ibin < NBIN; ibin++ ) {
+	  ilamobs    = SALT2_BATCH.ILAMOBS[ibin] ;
+	  LAMSED     = FILTER_SEDMODEL[ifilt].lam[ilamobs] / z1 ;
+	  WBIN[ibin] = LAMSED * FILTER_SEDMODEL[ifilt].transSN[ilamobs] ;
+	  if ( imw == 1 ) { WBIN[ibin] *= H[ilamobs] ; }
+	}
+
+	for(k=0; k < NCMOM; k++ ) {
+
+	  for(j=0; j < NLAMSUM; j++ ) { SUMWGT[j] = 0.0 ; }
+	  for(ibin=0; ibin < NBIN; ibin++ ) {
+	    j    = SALT2_BATCH.ILAMSED[ibin] - ILAMMIN ;
+	    FRAC = SALT2_BATCH.FRAC_LAMSED[ibin] ;
+	    W    = WBIN[ibin] ;
+	    SUMWGT[j]   += W * (1.0-FRAC) ;
+	    SUMWGT[j+1] += W * FRAC ;
+	    WBIN[ibin]  *= GBIN[ibin] ;  // next power of g
+	  }
+
+	  for(iday=0; iday < NDAY; iday++ ) {
+	    for(ised=0; ised <= 1; ised++ ) {
+	      INDEX = INDEX_FLUXTABLE_SALT2(ifilt,iz,iday,ised) 
+		+ imw*NCMOM + k ;
+	      if ( NBIN == 0 ) 
+		{ SALT2_FLUXTABLE.MOMENT[INDEX] = 0.0 ; continue ; }
+	      SALT2_FLUXTABLE.MOMENT[INDEX] = (float)
+		dot_SALT2_BATCH(NLAMSUM, SUMWGT, 
+				&SALT2_TABLE.SEDFLUX[ised][iday][ILAMMIN] );
+	    }
+	  }
+	} // end k
+      } // end imw
+    } // end iz
+  } // end ifilt
+
+} // end of fill_FLUXTABLE_SALT2
+
+
+// **********************************************
+long long INDEX_FLUXTABLE_SALT2(int ifilt, int iz, int iday, int ised) {
+
+  // Created Oct 2026
+  // Return index of first moment [imw=0][k=0] for sparse filter
+  // index ifilt (1-NFILT), redshift bin, day bin and SED surface.
+  SALT2_FLUXTABLE_HEAD_DEF *HEAD = &SALT2_FLUXTABLE.HEAD ;
+  long long INDEX ;
+  INDEX = ( (long long)(ifilt-1) * HEAD->NZ + iz ) * HEAD->NDAY + iday ;
+  INDEX = ( INDEX*2 + ised ) * 2 * HEAD->NCMOM ;
+  return(INDEX);
+
+} // end of INDEX_FLUXTABLE_SALT2
+
+
+// **********************************************
+int interp_FLUXTABLE_SALT2(int ifilt_obs, double z, double Tobs, 
+			   double x0, double x1, double c, double mwebv,
+			   double *Finteg, double *Fratio) {
+
+  // Created Oct 2026
+  // Return Finteg and Fratio (same definition as INTEG_zSED_SALT2)
+  // from SALT2_FLUXTABLE; cubic interpolation in log10(z) and linear 
+  // interpolation in Trest (SEDs are linear between table days).
+  // Function returns 1 on success, or 0 if the table cannot be used
+  // because z or Trest is outside the table, or because the estimated
+  // truncation error of the color or MW-extinction expansion exceeds
+  // INPUTS_SEDMODEL.SALT2_FLUXTABLE_PRECISION (mag).
+
+  SALT2_FLUXTABLE_HEAD_DEF *HEAD = &SALT2_FLUXTABLE.HEAD ;
+  int    NCMOM = HEAD->NCMOM ;
+  int    ifilt, iz0, izn, jzf, IDAY, j4, d, ised, imw, k ;
+  double logz, t, u, wz[4], wd[2], z1, Trest, FRAC_DAY, cc, w, sum ;
+  double P[NCMOM_FLUXTABLE_SALT2], S[2][2], xg, xh, fact, ERR_C, ERR_MW ;
+  double Ftot, hbar, MODELNORM ;
+  float  *MOM ;
+
+  // ------------ BEGIN -------------
+
+  *Finteg = *Fratio = 0.0 ;
+  SALT2_FLUXTABLE.NCALL++ ;
+  if ( z <= 0.0 ) { goto FALLBACK ; }
+
+  ifilt = IFILTMAP_SEDMODEL[ifilt_obs] ;
+  logz  = log10(z);
+  t     = (logz - HEAD->LOGZMIN) / HEAD->LOGZBIN ;
+  iz0   = (int)floor(t) - 1 ;
+  if ( iz0 < 0 || iz0+3 > HEAD->NZ-1 ) { goto FALLBACK ; }
+  u     = t - (double)iz0 ;  // 1 <= u < 2
+
+  // check precision using nearest z bin
+  cc   = c - INPUT_SALT2_INFO.COLOR_OFFSET ;
+  izn  = iz0 + (int)(u+0.5) ;
+  jzf  = (ifilt-1)*HEAD->NZ + izn ;
+  xg   = fabs(cc) * SALT2_FLUXTABLE.GMAX[jzf] ;
+  for(k=1, fact=1.0; k <= NCMOM; k++ ) { fact *= (double)k ; }
+  ERR_C  = pow(xg,(double)NCMOM) / fact * exp(xg) ;
+  xh     = 0.5 * mwebv * SALT2_FLUXTABLE.HRANGE[jzf] ;
+  ERR_MW = 0.5 * xh * xh ;
+  if ( 1.086*(ERR_C+ERR_MW) > INPUTS_SEDMODEL.SALT2_FLUXTABLE_PRECISION ) 
+    { goto FALLBACK ; }
+
+  z1    = 1.0 + z ;
+  Trest = Tobs / z1 ;
+  IDAY  = (int)((Trest - SALT2_TABLE.DAY[0])/SALT2_TABLE.DAYSTEP);
+  if ( IDAY < 0 || IDAY > HEAD->NDAY-2 ) { goto FALLBACK ; }
+  FRAC_DAY = (Trest - SALT2_TABLE.DAY[IDAY])/SALT2_TABLE.DAYSTEP ;
+  wd[0] = 1.0 - FRAC_DAY ;  wd[1] = FRAC_DAY ;
+
+  // Lagrange weights for nodes iz0 .. iz0+3
+  wz[0] = -(u-1.0)*(u-2.0)*(u-3.0)/6.0 ;
+  wz[1] =  u*(u-2.0)*(u-3.0)/2.0 ;
+  wz[2] = -u*(u-1.0)*(u-3.0)/2.0 ;
+  wz[3] =  u*(u-1.0)*(u-2.0)/6.0 ;
+
+  P[0] = 1.0 ;
+  for(k=1; k < NCMOM; k++ ) { P[k] = P[k-1] * cc / (double)k ; }
+
+  S[0][0] = S[0][1] = S[1][0] = S[1][1] = 0.0 ;
+  for(j4=0; j4 < 4; j4++ ) {
+    for(d=0; d <= 1; d++ ) {
+      w = wz[j4] * wd[d] ;
+      for(ised=0; ised <= 1; ised++ ) {
+	MOM = &SALT2_FLUXTABLE.MOMENT
+	  [INDEX_FLUXTABLE_SALT2(ifilt,iz0+j4,IDAY+d,ised)] ;
+	for(imw=0; imw <= 1; imw++ ) {
+	  sum = 0.0 ;
+	  for(k=0; k < NCMOM; k++ ) { sum += P[k] * (double)MOM[imw*NCMOM+k];}
+	  S[ised][imw] += w * sum ;
+	}
+      }
+    }
+  }
+
+  MODELNORM = FILTER_SEDMODEL[ifilt].lamstep * SEDMODEL.FLUXSCALE/(double)hc;
+  Ftot      = S[0][0] + x1*S[1][0] ;
+  hbar      = 0.0 ;
+  if ( Ftot != 0.0 ) { hbar = (S[0][1] + x1*S[1][1]) / Ftot ; }
+
+  *Finteg = x0 * Ftot * exp(mwebv*hbar) * MODELNORM ;
+  if ( S[0][0] != 0.0 ) { *Fratio = S[1][0] / S[0][0] ; }
+
+  return(1);
+
+ FALLBACK:
+  SALT2_FLUXTABLE.NFALLBACK++ ;
+  return(0);
+
+} // end of interp_FLUXTABLE_SALT2
+
+
+// **********************************************
+int read_FLUXTABLE_SALT2(char *fileName) {
+
+  // Created Oct 2026
+  // Read SALT2_FLUXTABLE from binary cache. Returns 1 if the header
+  // (including checksum) matches the current table; else returns 0.
+
+  SALT2_FLUXTABLE_HEAD_DEF HEAD_READ ;
+  int  NZF = SALT2_FLUXTABLE.HEAD.NFILT * SALT2_FLUXTABLE.HEAD.NZ ;
+  int  OK  = 0 ;
+  FILE *fp ;
+
+  // ------------ BEGIN -------------
+
+  if ( (fp = fopen(fileName,"rb")) == NULL ) { return(0); }
+
+  if ( fread(&HEAD_READ, sizeof(HEAD_READ), 1, fp) == 1 &&
+       memcmp(&HEAD_READ, &SALT2_FLUXTABLE.HEAD, sizeof(HEAD_READ)) == 0 ) {
+    OK = 
+      fread(SALT2_FLUXTABLE.GMAX,   sizeof(double), NZF, fp) == NZF &&
+      fread(SALT2_FLUXTABLE.HRANGE, sizeof(double), NZF, fp) == NZF &&
+      fread(SALT2_FLUXTABLE.MOMENT, sizeof(float), SALT2_FLUXTABLE.NMOMENT,
+	    fp) == (size_t)SALT2_FLUXTABLE.NMOMENT ;
+  }
+  fclose(fp);
+
+  if ( !OK ) 
+    { printf("\t Ignore invalid SALT2 flux-table cache %s\n", fileName); }
+
+  return(OK);
+
+} // end of read_FLUXTABLE_SALT2
+
+
+// **********************************************
+void write_FLUXTABLE_SALT2(char *fileName) {
+
+  // Created Oct 2026
+  // Write SALT2_FLUXTABLE to binary cache. Write to temp file and
+  // rename at the end so that parallel jobs never read a partial file.
+  // Failure to write is not fatal; the table is simply not cached.
+
+  int  NZF = SALT2_FLUXTABLE.HEAD.NFILT * SALT2_FLUXTABLE.HEAD.NZ ;
+  char tmpFile[420] ;
+  FILE *fp ;
+
+  // ------------ BEGIN -------------
+
+  if ( (fp = open_TEMPFILE(fileName,tmpFile)) == NULL ) {
+    printf("\t WARNING: cannot write SALT2 flux-table cache %s\n", tmpFile);
+    fflush(stdout);
+    return ;
+  }
+
+  fwrite(&SALT2_FLUXTABLE.HEAD, sizeof(SALT2_FLUXTABLE_HEAD_DEF), 1, fp);
+  fwrite(SALT2_FLUXTABLE.GMAX,   sizeof(double), NZF, fp);
+  fwrite(SALT2_FLUXTABLE.HRANGE, sizeof(double), NZF, fp);
+  fwrite(SALT2_FLUXTABLE.MOMENT, sizeof(float), SALT2_FLUXTABLE.NMOMENT, fp);
+
+  // check write (e.g., disk full) and rename before announcing cache
+  if ( close_TEMPFILE(fp, 0, tmpFile, fileName) != SUCCESS ) {
+    printf("\t WARNING: failed to write SALT2 flux-table cache %s\n", 
+	   fileName);
+    fflush(stdout);
+    return ;
+  }
+
+  printf("\t Wrote SALT2 flux table to %s\n", fileName);
+  fflush(stdout);
+
+} // end of write_FLUXTABLE_SALT2
+
+
 // ==============================================================
 void get_fluxRest_SALT2(double LAMREST_MIN, double LAMREST_MAX,
 			double *fluxRest) {
@@ -2452,127 +3331,115 @@ int gencovar_SALT2(int MATSIZE, int *ifiltobsList, double *epobsList,
   //  ARRRRRRRRRGH !!!
   //
   //  July 2016: add new inputs args RV_host & AV_host
+  //
+  // Oct 2026: 
+  //   refactor to avoid MATSIZE^2 loop over all elements.
+  //   Epochs are grouped by filter; for each filter, cDisp is computed
+  //   once and the flux ratios for the diagonal errors are computed
+  //   with one call to INTEG_zSED_SALT2_BATCH. Only same-filter blocks
+  //   are non-zero, and each off-diagonal element is computed once and
+  //   mirrored. Work arrays are sized by MATSIZE (no epoch limit).
 
   int 
-    icovar, irow, icol, ifilt_obs, ifilt_row, ifilt_col, ifilt 
-    ,ISDIAG, LDMP
+    ifilt_obs, ifilt, irow, icol, i0, ia, ib, N, NSUM
+    ,NFILT_OBS[MXFILTINDX], IOBS_START[MXFILTINDX]
+    ,*IROW_SORT
     ;
 
   double 
-    COV_TMP,  COV_DIAG
-    ,meanlam_obs, meanlam_rest, invZ1
-    ,cDisp[MXFILT_SEDMODEL]
-    ,Finteg, Fratio, FspecDum[10], magerr
-    ,Tobs, Trest, Trest_tmp
-    ,Trest_row, Trest_col
+    COV_OFF, meanlam_obs, meanlam_rest, invZ1, cDisp, magerr
+    ,Trest, *Trest_sort, *Tobs_sort, *Finteg_sort, *Fratio_sort
     ,FAC = 1.17882   //  [ 2.5/ln(10) ]^2
     ;
 
-    char *cfilt, cdum0[40], cdum1[40];
+  long long MATSQ = (long long)MATSIZE * (long long)MATSIZE ;
+  int  MEMD = (MATSIZE+1) * sizeof(double) ;
+  int  MEMI = (MATSIZE+1) * sizeof(int) ;
+  char fnam[] = "gencovar_SALT2" ;
 
   // -------------- BEGIN -----------------
   
   invZ1 = 1.0/(1.+z);
-  icovar = 0 ;
-
-  // init  cDisp to -9 in each filter
-  for(ifilt=1; ifilt <= NFILT_SEDMODEL; ifilt++) {
-    ifilt_obs = FILTER_SEDMODEL[ifilt].ifilt_obs ;
-    cDisp[ifilt_obs] = -9.0 ;
-  }
 
+  memset(covar, 0, MATSQ*sizeof(double) );
+  if ( MATSIZE <= 0 ) { return SUCCESS ; }
 
+  // counting-sort epochs by filter
+  for(ifilt_obs=0; ifilt_obs < MXFILTINDX; ifilt_obs++ ) 
+    { NFILT_OBS[ifilt_obs] = 0 ; }
   for ( irow=0; irow < MATSIZE; irow++ ) {
-    for ( icol=0; icol < MATSIZE; icol++ ) {
-
-      Tobs  = *(epobsList+irow) ;  Trest_row  = Tobs * invZ1 ;
-      Tobs  = *(epobsList+icol) ;  Trest_col  = Tobs * invZ1 ;
-      ISDIAG = ( irow == icol ) ;
-
-      meanlam_rest  = -9.0 ;
-      ifilt_row     = *(ifiltobsList+irow);
-      ifilt_col     = *(ifiltobsList+icol);
-      COV_TMP       = 0.0 ; 
-      COV_DIAG      = 0.0 ;
-
-      // get cDisp for this filter; avoid repeating SALT2colorDisp calls
-      if ( cDisp[ifilt_row] < -1.0 ) {
-	ifilt         = IFILTMAP_SEDMODEL[ifilt_row] ;
-	meanlam_obs   = FILTER_SEDMODEL[ifilt].mean ;  // mean lambda
-	meanlam_rest  = meanlam_obs * invZ1 ; 
-	cDisp[ifilt_row] = SALT2colorDisp(meanlam_rest);    
-      }
-
-      // set covariances only for same passband.
-      if ( ifilt_col == ifilt_row ) 
-	{ COV_TMP = FAC * pow(cDisp[ifilt_row],2.0);  }
-
-
-      // check for local dump option
-      LDMP  = (COV_TMP != 0.0 || ISDIAG) && 
-	(fabs(Trest_row) < -1.0 && fabs(Trest_col) < -1.0); 
-
-      if ( LDMP ) 
-	{ printf(" xxx ############ COV_MODEL DUMP ############### \n"); }
-
-      // diagonal-only term
-      if ( ISDIAG ) {
-	Tobs          = *(epobsList+irow) ;  
-	Trest         = Tobs * invZ1 ;
-	ifilt         = IFILTMAP_SEDMODEL[ifilt_row] ;
-	cfilt         = FILTER_SEDMODEL[ifilt].name ;
-	meanlam_obs   = FILTER_SEDMODEL[ifilt].mean ;  // mean lambda
-	meanlam_rest  = meanlam_obs * invZ1 ; 
-
-
-	// make sure that Trest is within the map range
-	if ( Trest > SALT2_ERRMAP[0].MAXDAY ) 
-	  { Trest_tmp = SALT2_ERRMAP[0].MAXDAY ; }
-	else if ( Trest < SALT2_ERRMAP[0].MINDAY ) 
-	  { Trest_tmp = SALT2_ERRMAP[0].MINDAY ; }
-	else
-	  { Trest_tmp = Trest ; }
-
-	Trest = Trest_tmp ;
-	Tobs  = Trest * ( 1. + z );
-
-	INTEG_zSED_SALT2(0,ifilt_row,z,Tobs, x0, x1, c,    // input
-			 RV_host, AV_host,               // input
-			 &Finteg, &Fratio, FspecDum);    // returned
-	
-	magerr = SALT2magerr(Trest, meanlam_rest, z, x1, Fratio, LDMP );
-	COV_DIAG = magerr*magerr ;
-	COV_TMP = COV_DIAG ;
-      }
-      
-      covar[icovar] = COV_TMP ;  // load output array  
-      icovar++ ;                   // increment local pointer
+    ifilt_obs = ifiltobsList[irow] ;
+    if ( ifilt_obs < 0 || ifilt_obs >= MXFILTINDX ) {
+      sprintf(c1err,"Invalid ifilt_obs=%d for irow=%d", ifilt_obs, irow);
+      sprintf(c2err,"Valid range is 0 to %d", MXFILTINDX-1);
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    }
+    NFILT_OBS[ifilt_obs]++ ;
+  }
 
-      if ( LDMP && COV_TMP != 0.0  ) {
+  NSUM = 0 ;
+  for(ifilt_obs=0; ifilt_obs < MXFILTINDX; ifilt_obs++ ) {
+    IOBS_START[ifilt_obs] = NSUM ;  
+    NSUM += NFILT_OBS[ifilt_obs] ;  
+    NFILT_OBS[ifilt_obs] = 0 ;
+  }
 
-	ifilt         = IFILTMAP_SEDMODEL[ifilt_row] ;
-	cfilt         = FILTER_SEDMODEL[ifilt].name ;
-	sprintf(cdum0,"%s:Tobs=%7.3f", cfilt, Tobs);
+  IROW_SORT   = (int   *)malloc(MEMI);
+  Trest_sort  = (double*)malloc(MEMD);
+  Tobs_sort   = (double*)malloc(MEMD);
+  Finteg_sort = (double*)malloc(MEMD);
+  Fratio_sort = (double*)malloc(MEMD);
 
-	ifilt         = IFILTMAP_SEDMODEL[ifilt_col] ;
-	cfilt         = FILTER_SEDMODEL[ifilt].name ;
-	sprintf(cdum1,"%s:Tobs=%7.3f", cfilt, Tobs);
- 
-	printf(" xxx COV_MAGERR[ %s , %s ] = %le \n", cdum0,cdum1, COV_TMP );
-
-	if ( ISDIAG ) {
-	  printf(" xxx ----------------- \n");
-	  printf(" xxx COV_DIAGON[ %s , %s ] = %le \n", cdum0,cdum1, COV_DIAG);
-	  printf(" xxx meanlam_rest = %f  z=%f  x1=%f  Fratio=%f \n",
-		 meanlam_rest, z, x1, Fratio );
-	  printf(" xxx ----------------- \n");
-	}
+  for ( irow=0; irow < MATSIZE; irow++ ) {
+    ifilt_obs = ifiltobsList[irow] ;
+    ia        = IOBS_START[ifilt_obs] + NFILT_OBS[ifilt_obs] ;
+
+    // make sure that Trest is within the map range
+    Trest = epobsList[irow] * invZ1 ;
+    if ( Trest > SALT2_ERRMAP[0].MAXDAY ) 
+      { Trest = SALT2_ERRMAP[0].MAXDAY ; }
+    else if ( Trest < SALT2_ERRMAP[0].MINDAY ) 
+      { Trest = SALT2_ERRMAP[0].MINDAY ; }
+
+    IROW_SORT[ia]  = irow ;
+    Trest_sort[ia] = Trest ;
+    Tobs_sort[ia]  = Trest * ( 1. + z );
+    NFILT_OBS[ifilt_obs]++ ;
+  }
 
-	fflush(stdout);
+  // fill same-filter block for each filter
+  for(ifilt_obs=0; ifilt_obs < MXFILTINDX; ifilt_obs++ ) {
+
+    N  = NFILT_OBS[ifilt_obs] ;
+    if ( N == 0 ) { continue ; }
+    i0 = IOBS_START[ifilt_obs] ;
+
+    ifilt         = IFILTMAP_SEDMODEL[ifilt_obs] ;
+    meanlam_obs   = FILTER_SEDMODEL[ifilt].mean ;  // mean lambda
+    meanlam_rest  = meanlam_obs * invZ1 ; 
+    cDisp         = SALT2colorDisp(meanlam_rest);    
+    COV_OFF       = FAC * cDisp * cDisp ;
+
+    INTEG_zSED_SALT2_BATCH(ifilt_obs, z, N, &Tobs_sort[i0], x0, x1, c,
+			   RV_host, AV_host,                     // input
+			   &Finteg_sort[i0], &Fratio_sort[i0] ); // returned
+
+    for(ia=i0; ia < i0+N; ia++ ) {
+      irow   = IROW_SORT[ia] ;
+      magerr = SALT2magerr(Trest_sort[ia], meanlam_rest, z, x1, 
+			   Fratio_sort[ia], 0 );
+      covar[(long long)irow*MATSIZE + irow] = magerr*magerr ;
+
+      for(ib=ia+1; ib < i0+N; ib++ ) {
+	icol = IROW_SORT[ib] ;
+	covar[(long long)irow*MATSIZE + icol] = COV_OFF ;
+	covar[(long long)icol*MATSIZE + irow] = COV_OFF ;
       }
+    }
+  } // end ifilt_obs
 
-    } // icol
-  } //  irow
+  free(IROW_SORT);  free(Trest_sort);  free(Tobs_sort);
+  free(Finteg_sort);  free(Fratio_sort);
 
   return SUCCESS ; 
 
@@ -141,6 +141,7 @@ struct SALT2_TALBE {
   double **COLORLAW   ;   // color law table [color][lambda]
   double **XTMW_FRAC  ;   // XTMW table [ifilt][lambda]
   double **SEDFLUX[2] ;   // SED flux vs. Trest and lambda [iday][ilam]
+  double  *SEDFLUX_BLOCK[2]; // contiguous storage for SEDFLUX rows (Oct 2026)
 
   // parameters (binning) of SEDFLUX table
   int    NDAY, NLAMSED  ;   // Number of DAY and LAM bins for SEDs
@@ -160,6 +161,48 @@ struct SALT2_TALBE {
 } SALT2_TABLE ;
 
 
+// Oct 2026: work space for INTEG_zSED_SALT2_BATCH.
+// Filter-bin weights (color law, extinction, lambda*trans) are folded
+// onto the rest-frame SED lambda grid so that each epoch needs only
+// contiguous dot products with the SEDFLUX rows.
+struct {
+  int     MXLAM ;         // allocated size of arrays below
+  int     NBIN ;          // number of used filter bins
+  int     ILAMSED_MIN, NLAMSED ; // SED lambda range covered by filter
+  int    *ILAMOBS, *ILAMSED ;    // [ibin]
+  double *FRAC_LAMSED, *WGT_FLUX, *WGT_ERR ;  // [ibin]
+  double *SUMWGT_FLUX, *SUMWGT_ERR ;         // [ilamsed-ILAMSED_MIN]
+} SALT2_BATCH ;
+
+
+// Oct 2026: optional table of filter integrals vs. (ifilt, log z, Trest)
+// for each SED surface. Color dependence is stored as moments of the
+// color law g(lam) = ln(colorCor)/c, and Galactic extinction as first
+// moment of h(lam) = ln(MWXT_FRAC)/mwebv, so that
+//   Flux = sum_k c^k/k! * MOM[k] * exp(mwebv*<h>)
+// See init_FLUXTABLE_SALT2 and interp_FLUXTABLE_SALT2.
+#define NCMOM_FLUXTABLE_SALT2    8    // number of color moments
+#define DLOGZ_FLUXTABLE_SALT2  0.01   // log10(z) bin size
+#define VERSION_FLUXTABLE_SALT2  1    // version of binary cache
+
+typedef struct {
+  int    VERSION ;
+  int    NFILT, NZ, NDAY, NCMOM ;
+  double LOGZMIN, LOGZBIN, RV ;
+  int    OPT_COLORLAW ;
+  unsigned long long CKSUM ;   // filters, SEDs, color law, binning
+} SALT2_FLUXTABLE_HEAD_DEF ;
+
+struct {
+  int    INIT_DONE, USE ;
+  SALT2_FLUXTABLE_HEAD_DEF HEAD ;
+  long long NMOMENT ;
+  float  *MOMENT ;        // [ifilt-1][iz][iday][ised][imw][icmom]
+  double *GMAX, *HRANGE ; // max|g| and range of h : [ifilt-1][iz]
+  int    NCALL, NFALLBACK ;
+} SALT2_FLUXTABLE ;
+
+
 
 // define structure for storing SALT2 spectrum and storing in table.
 
@@ -179,6 +222,22 @@ void genmag_SALT2(int OPTMASK, int ifilt, double x0,
 		  int nobs, double *Tobs_list, 
 		  double *magobs_list, double *magerr_list );
 
+void genmag_SALT2_EVENT(int OPTMASK, int NOBS, int *ifilt_obs_list,
+			double *Tobs_list, double x0, double x1, 
+			double x1_forErr, double c, double mwebv,
+			double RV_host, double AV_host, 
+			double z, double z_forErr, double *magobs_list, 
+			double *magerr_list, double *Fratio_list );
+
+void genmag_SALT2_BAND(int OPTMASK, int ifilt, double x0, 
+		       double x1, double x1_forErr,
+		       double c, double mwebv, 
+		       double RV_host, double AV_host,
+		       double z, double z_forErr,
+		       int nobs, double *Tobs_list, 
+		       double *magobs_list, double *magerr_list,
+		       double *Fratio_list );
+
 void init_extrap_latetime_SALT2(void);
 double genmag_extrap_latetime_SALT2(double mag_daymin, double day, double lam);
 double FLUXFUN_EXTRAP_LATETIME(double t, double tau1, double tau2, 
@@ -226,6 +285,22 @@ void INTEG_zSED_SALT2(int OPT_SPEC, int ifilt_obs, double z, double Tobs,
 		      double RV_host, double AV_host,
 		      double *Finteg, double *Fratio, double *Fspec );
 
+// obs-frame integration for many epochs of one filter (Oct 2026)
+void INTEG_zSED_SALT2_BATCH(int ifilt_obs, double z, int NEP, 
+			    double *Tobs_list, double x0, double x1, double c,
+			    double RV_host, double AV_host,
+			    double *Finteg_list, double *Fratio_list );
+void   init_SALT2_BATCH(int MXLAM);
+void   init_FLUXTABLE_SALT2(void);
+void   fill_FLUXTABLE_SALT2(void);
+int    read_FLUXTABLE_SALT2(char *fileName);
+void   write_FLUXTABLE_SALT2(char *fileName);
+long long INDEX_FLUXTABLE_SALT2(int ifilt, int iz, int iday, int ised);
+int    interp_FLUXTABLE_SALT2(int ifilt_obs, double z, double Tobs, 
+			      double x0, double x1, double c, double mwebv,
+			      double *Finteg, double *Fratio);
+double dot_SALT2_BATCH(int N, double *A, double *B);
+
 void get_fluxRest_SALT2(double lamRest_min, double lamRest_max,
 			double *fluxRest );
 
@@ -79,6 +79,11 @@
   Jul 20, 2018: 
     + new function get_flux_SEDMODEL() to call interp_flux_SEDMODEL
       and take care of extrapolating Trest outside model range.
+
+  Oct 2026: 
+    + optional precomputed interpolation coefficients for
+      interp_flux_SEDMODEL (INPUTS_SEDMODEL.OPT_INTERP_COEFF);
+      see init_interpCoeff_SEDMODEL().
    
 ********************************************/
 
@@ -494,6 +499,8 @@ void malloc_FLUXTABLE_SEDMODEL( int NFILT, int NZBIN, int NLAMPOW,
 
   // Nov 24, 2008: allocate flux-integral memory for NSED & NZBIN
   // Jan 30, 2010: switch from fancy 5-dim pointer to 1d pointer
+  // Oct 2026: if MMAP_SEDMODEL_FLUXTABLE is set, only set binning;
+  //           table memory is mapped from a shared binary file.
 
   int isize;
   char fnam[] = "malloc_FLUXTABLE_SEDMODEL" ;
@@ -563,10 +570,13 @@ void malloc_FLUXTABLE_SEDMODEL( int NFILT, int NZBIN, int NLAMPOW,
   NBTOT_SEDMODEL_FLUXTABLE = N1DBINOFF_SEDMODEL_FLUXTABLE[0] ;
   ISIZE_SEDMODEL_FLUXTABLE = NBTOT_SEDMODEL_FLUXTABLE * isize ;
 
-  PTR_SEDMODEL_FLUXTABLE =  (float*)malloc(ISIZE_SEDMODEL_FLUXTABLE);
-
-  printf("  %s : allocate %6.2f Mb of memory for integral-flux tables. \n", 
-	 fnam, 1.E-6*(double)ISIZE_SEDMODEL_FLUXTABLE );
+  if ( MMAP_SEDMODEL_FLUXTABLE ) 
+    { printf("  %s : use memory-mapped integral-flux tables. \n", fnam); }
+  else {
+    PTR_SEDMODEL_FLUXTABLE =  (float*)malloc(ISIZE_SEDMODEL_FLUXTABLE);
+    printf("  %s : allocate %6.2f Mb of memory for integral-flux tables.\n",
+	   fnam, 1.E-6*(double)ISIZE_SEDMODEL_FLUXTABLE );
+  }
 
   //  printf("\t\t Tables include lambda powers up to %d .\n",  NLAMPOW );
   printf("\t Table bins include %3d DAYs. \n",    NDAY);
@@ -587,7 +597,7 @@ void malloc_FLUXTABLE_SEDMODEL( int NFILT, int NZBIN, int NLAMPOW,
   }
 
 
-  zero_flux_SEDMODEL();
+  if ( !MMAP_SEDMODEL_FLUXTABLE ) { zero_flux_SEDMODEL(); }
 
   // - - - - - - - 
  
@@ -1003,6 +1013,10 @@ void init_flux_SEDMODEL(int ifilt_obs, int ised) {
   } // end of iz loop
 
 
+  // Oct 2026: check option to precompute interpolation coefficients
+  if ( INPUTS_SEDMODEL.OPT_INTERP_COEFF > 0 ) 
+    { init_interpCoeff_SEDMODEL(ifilt_obs,ised); }
+
   if ( ised == -9 ) {
     iep   = 20; iz=0 ;
     day   = TEMP_SEDMODEL.DAY[iep]; 
@@ -1426,8 +1440,13 @@ double interp_flux_SEDMODEL(
   //   + replace quadInterp with linear interp to avoid pathological
   //     parabolic interp that can result in negative flux
   //             
+  // Oct 2026:
+  //   + if INTERPCOEFF_SEDMODEL.USE is set, evaluate the same
+  //     interpolation from precomputed coefficients.
+  //
   int 
     ifilt, NDAY, EPMAX, index, LDMP, NZBIN, IZLO, EPLO, ep, iz, NZTMP
+    ,EPLO_BIN
     ,NBIN_SPLINE = 3
     ,NZBIN_SPLINE, NEPBIN_SPLINE
     ;
@@ -1439,7 +1458,7 @@ double interp_flux_SEDMODEL(
     logz
     ,DAYMIN, DAYSTEP, DAYMAX
     ,DAYLIST_INTERP[4]
-    ,LOGZMIN, LOGZMAX, LOGZBIN, FRAC, LOGZ_TMP
+    ,LOGZMIN, LOGZMAX, LOGZBIN, FRAC, FRAC_DAY, LOGZ_TMP
     ,S2DTMP[10][10]  // [iz][iday]
     ,SZTMP[10], S, LAMOBS_MIN, LAMOBS_MAX
     ,*ptr_EP, *ptr_LOGZ    
@@ -1502,6 +1521,7 @@ double interp_flux_SEDMODEL(
 
 
   get_DAYBIN_SEDMODEL(ISED, Trest, &EPLO, &FRAC); // return EPLO & FRAC
+  EPLO_BIN = EPLO ;  FRAC_DAY = FRAC ;             // bin containing Trest
   if ( EPLO > 0 && FRAC < 0.5      ) { EPLO-- ; }
   if ( EPLO > NDAY - NEPBIN_SPLINE ) { EPLO = NDAY - NEPBIN_SPLINE ; }
 
@@ -1555,6 +1575,14 @@ double interp_flux_SEDMODEL(
 
 
 
+  // Oct 2026: check for precomputed interp coefficients
+  if ( INTERPCOEFF_SEDMODEL.USE && IZLO > 0 && NDAY > 2 && 
+       NZBIN_SPLINE == 3 ) {
+    S = eval_interpCoeff_SEDMODEL(ifilt, IZLO, ilampow, EPLO_BIN, ISED,
+				  logz, FRAC_DAY);
+    return(S);
+  }
+
   ptr_EP   = DAYLIST_INTERP ;
   ptr_LOGZ = &REDSHIFT_SEDMODEL.LOGZTABLE[IZLO] ;
 
@@ -1615,6 +1643,118 @@ double interp_flux_SEDMODEL(
 } // end of interp_flux_SEDMODEL
 
 
+// ***************************************
+void init_interpCoeff_SEDMODEL(int ifilt_obs, int ised) {
+
+  // Created Oct 2026
+  // For input filter and SED, fill INTERPCOEFF_SEDMODEL.COEFF from
+  // the flux-integral table so that interp_flux_SEDMODEL can evaluate
+  // its quad-in-log10(z) x linear-in-day interpolation with a 6-term
+  // dot product instead of building a local S2DTMP grid on each call.
+  // Coefficient memory is allocated on first call; 
+  // must be called after the flux table is filled for (ifilt,ised).
+  //
+  // Cell (iz,iep) stores, with u = [logz - LOGZTABLE[iz]]/DLOGZ,
+  //   C[0] + C[1]*u + C[2]*u^2  at day iep
+  //   C[3] + C[4]*u + C[5]*u^2  at day iep+1
+  // where the quadratic passes through table nodes iz, iz+1, iz+2.
+
+  int  NZBIN   = REDSHIFT_SEDMODEL.NZBIN ;
+  int  NDAY    = SEDMODEL.NDAY[ised] ;
+  int  ifilt, iz, ilampow, iep, b, k ;
+  long int index, NCELL, MEM ;
+  float  *C ;
+  double F0, F1, F2, A2 ;
+  char fnam[] = "init_interpCoeff_SEDMODEL" ;
+
+  // ----------- BEGIN -----------
+
+  // need at least 3 z-bins for quadratic interp
+  if ( NZBIN < 3 ) { INTERPCOEFF_SEDMODEL.USE = 0 ; return ; }
+
+  NCELL = N1DBINOFF_SEDMODEL_FLUXTABLE[0] ;
+  if ( INTERPCOEFF_SEDMODEL.NCELL != NCELL ) {
+    if ( INTERPCOEFF_SEDMODEL.NCELL > 0 ) 
+      { free(INTERPCOEFF_SEDMODEL.COEFF); }
+    MEM = NCELL * NCOEFF_INTERP_SEDMODEL * sizeof(float) ;
+    INTERPCOEFF_SEDMODEL.COEFF = (float*)malloc(MEM);
+    if ( INTERPCOEFF_SEDMODEL.COEFF == NULL ) {
+      sprintf(c1err,"Could not allocate %.1f MB for interp coeff.", 
+	      1.0E-6*(double)MEM );
+      sprintf(c2err,"Try without OPT_INTERP_COEFF option.");
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    }
+    INTERPCOEFF_SEDMODEL.NCELL = NCELL ;
+    INTERPCOEFF_SEDMODEL.DLOGZ = 
+      REDSHIFT_SEDMODEL.LOGZTABLE[2] - REDSHIFT_SEDMODEL.LOGZTABLE[1];
+    printf("  %s : allocate %6.2f Mb of memory for interp coeff. \n", 
+	   fnam, 1.E-6*(double)MEM );
+    fflush(stdout);
+  }
+
+  INTERPCOEFF_SEDMODEL.USE = 1 ;
+  if ( ifilt_obs <= 0 ) { return ; }
+  ifilt = IFILTMAP_SEDMODEL[ifilt_obs] ;
+
+  // interp_flux_SEDMODEL uses IZLO = 1 to NZBIN-2 and IDAY <= NDAY-2
+  for ( iz=1; iz <= NZBIN-2; iz++ ) {
+    for ( ilampow=0; ilampow <= NLAMPOW_SEDMODEL; ilampow++ ) {
+      for ( iep=0; iep <= NDAY-2; iep++ ) {
+	index = INDEX_SEDMODEL_FLUXTABLE(ifilt,iz,ilampow,iep,ised);
+	C     = &INTERPCOEFF_SEDMODEL.COEFF[NCOEFF_INTERP_SEDMODEL*index];
+	for ( b=0; b < 2; b++ ) {
+	  F0 = PTR_SEDMODEL_FLUXTABLE
+	    [INDEX_SEDMODEL_FLUXTABLE(ifilt,iz+0,ilampow,iep+b,ised)] ;
+	  F1 = PTR_SEDMODEL_FLUXTABLE
+	    [INDEX_SEDMODEL_FLUXTABLE(ifilt,iz+1,ilampow,iep+b,ised)] ;
+	  F2 = PTR_SEDMODEL_FLUXTABLE
+	    [INDEX_SEDMODEL_FLUXTABLE(ifilt,iz+2,ilampow,iep+b,ised)] ;
+	  A2 = 0.5*(F0 - 2.0*F1 + F2) ;
+	  k  = 3*b ;
+	  C[k+0] = (float)F0 ;
+	  C[k+1] = (float)(F1 - F0 - A2) ;
+	  C[k+2] = (float)A2 ;
+	}
+      } // iep
+    } // ilampow
+  } // iz
+
+} // end of init_interpCoeff_SEDMODEL
+
+
+// ***************************************
+double eval_interpCoeff_SEDMODEL(int ifilt, int IZ, int ilampow, int IDAY,
+				 int ISED, double logz, double FRAC_DAY) {
+
+  // Created Oct 2026
+  // Evaluate flux integral from coefficients computed in
+  // init_interpCoeff_SEDMODEL. Inputs IZ and IDAY are the z-node
+  // and day-bin chosen by interp_flux_SEDMODEL; FRAC_DAY is the
+  // fractional position of Trest inside IDAY bin.
+
+  int   NDAY = SEDMODEL.NDAY[ISED] ;
+  long  int index ;
+  float *C ;
+  double u, F_lo, F_hi ;
+
+  // ----------- BEGIN -----------
+
+  if ( IDAY > NDAY-2 ) { IDAY = NDAY-2 ;  FRAC_DAY = 1.0 ; }
+
+  index = INDEX_SEDMODEL_FLUXTABLE(ifilt,IZ,ilampow,IDAY,ISED);
+  C     = &INTERPCOEFF_SEDMODEL.COEFF[NCOEFF_INTERP_SEDMODEL*index] ;
+  u     = (logz - REDSHIFT_SEDMODEL.LOGZTABLE[IZ]) / 
+    INTERPCOEFF_SEDMODEL.DLOGZ ;
+
+  F_lo  = C[0] + u*(C[1] + u*C[2]) ;
+  F_hi  = C[3] + u*(C[4] + u*C[5]) ;
+
+  return( F_lo + FRAC_DAY*(F_hi - F_lo) ) ;
+
+} // end of eval_interpCoeff_SEDMODEL
+
+
+
 
 // *******************************************
 long int INDEX_SEDMODEL_FLUXTABLE(int ifilt, int iz, 
@@ -1623,11 +1763,17 @@ long int INDEX_SEDMODEL_FLUXTABLE(int ifilt, int iz,
   // Created Jan 30, 2010 by R.Kessler
   // Return 1D index corresponding to the five indices
   // of the FLXUTABLE. 
+  //
+  // Oct 2026: if ISLOT_SEDMODEL_FLUXTABLE is set (lazy SIMSED loading),
+  //           SED dimension is a slot in a smaller table.
 
   long int INDEX;
 
   // ------- BEGIN --------
 
+  if ( ISLOT_SEDMODEL_FLUXTABLE != NULL ) 
+    { ised = ISLOT_SEDMODEL_FLUXTABLE[ised] ; }
+
   INDEX = 0;
 
   INDEX += N1DBINOFF_SEDMODEL_FLUXTABLE[1] * ifilt ;
@@ -258,6 +258,8 @@ float SEDBINARY[MXBIN_SED_SEDMODEL];
 #define IDIM_SEDMODEL_SED      5
 
 float    *PTR_SEDMODEL_FLUXTABLE ;  // pointer array
+int       MMAP_SEDMODEL_FLUXTABLE ;  // 1 -> table is mmap'ed (Oct 2026)
+int      *ISLOT_SEDMODEL_FLUXTABLE ; // optional ised -> table slot (Oct 2026)
 long int  ISIZE_SEDMODEL_FLUXTABLE;  // total size
 long int  NBTOT_SEDMODEL_FLUXTABLE;  // total number of fluxtable bins
 int       NBIN_SEDMODEL_FLUXTABLE[NDIM_SEDMODEL_FLUXTABLE+1];
@@ -282,8 +284,23 @@ struct {
   int    OPTMASK_T0SHIFT_EXPLODE; // option to define T=0 at explosion
   double UVLAM_EXTRAPFLUX;       // extrapolate SED down to UV region
   double MINSLOPE_EXTRAPMAG_LATE;   // min mag/day slope for extrapolation
+  double SALT2_FLUXTABLE_PRECISION; // mag tolerance for SALT2 table (Oct 2026)
+  char   SALT2_FLUXTABLE_PATH[200]; // dir for SALT2 table binary cache
+  int    OPT_INTERP_COEFF;   // 1 -> precompute interp coeff (Oct 2026)
 } INPUTS_SEDMODEL;
 
+// Oct 2026: optional interpolation coefficients for interp_flux_SEDMODEL.
+// For each flux-table cell (ifilt,iz,ilampow,iep,ised), store the
+// quadratic-in-log10(z) coefficients through iz,iz+1,iz+2 at days iep
+// and iep+1, so that each lookup is a 6-term dot product.
+#define NCOEFF_INTERP_SEDMODEL 6
+struct {
+  int      USE ;
+  long int NCELL ;   // = N1DBINOFF_SEDMODEL_FLUXTABLE[0] at malloc
+  double   DLOGZ ;   // log10(z) spacing of LOGZTABLE (iz>=1)
+  float   *COEFF ;   // [NCOEFF_INTERP_SEDMODEL * INDEX_SEDMODEL_FLUXTABLE]
+} INTERPCOEFF_SEDMODEL ;
+
 // ==============================================
 // function declarations
 
@@ -319,6 +336,9 @@ void zero_flux_SEDMODEL(void);
 
 double interp_flux_SEDMODEL(int ISED, int ilampower, int ifilt_obs, 
 			    double z, double Trest );
+void   init_interpCoeff_SEDMODEL(int ifilt_obs, int ised);
+double eval_interpCoeff_SEDMODEL(int ifilt, int IZ, int ilampow, int IDAY,
+				 int ISED, double logz, double FRAC_DAY);
 double get_flux_SEDMODEL(int ISED, int ilampow, int ifilt_obs,
 			 double z, double Trest) ;
 
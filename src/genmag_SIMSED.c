@@ -46,12 +46,23 @@
                --> affects value of T0shiftPeak, bolometric flux,
                    and memory used to read.
 
+  Oct 2026: OPTMASK_SIMSED_MMAP option to memory-map flux-table binary
+            (versioned, page-aligned layout) so that all jobs on a node
+            share one copy; SED files are not read when map exists.
+
+  Oct 2026: optional lazy loading (SIMSED_LAZY.NSLOT_MAX > 0);
+            each SED is read and integrated on first use, and at most
+            NSLOT SEDs are kept in memory (LRU).
+
 *************************************/
 
 #include  <stdio.h> 
 #include  <math.h>     
 #include  <stdlib.h>   
 #include  <sys/stat.h>
+#include  <sys/mman.h>
+#include  <fcntl.h>
+#include  <unistd.h>
 
 #include  "sntools.h"           // SNANA community tools
 #include  "genmag_SEDtools.h"
@@ -132,15 +143,18 @@ int init_genmag_SIMSED(char *VERSION      // SIMSED version
 
   // OPTMASK +=  1 --> create binary file
   // OPTMASK += 64 --> test mode only, no binary, no time-stamp checks
+  // OPTMASK +=128 --> with binary, use memory-mapped flux table
 
   int 
-    OPT_BINARY, OPT_TESTMODE, NZBIN, IZSIZE
+    OPT_BINARY, OPT_TESTMODE, OPT_MMAP, NZBIN, IZSIZE
     ,ifilt, ifilt_obs, ised, istat
     ,retval = SUCCESS
     ,WRFLAG_SEDBINARY  // for global SEDs
     ,RDFLAG_SEDBINARY 
     ,WRFLAG_TABBINARY  // for local flux table
     ,RDFLAG_TABBINARY    
+    ,WRFLAG_MMAP       // for memory-mapped flux table
+    ,RDFLAG_MMAP
     ;
 
   char
@@ -166,6 +180,7 @@ int init_genmag_SIMSED(char *VERSION      // SIMSED version
   // get local logicals for bit-mask  options
   OPT_BINARY   = ( OPTMASK &  OPTMASK_SIMSED_BINARY   ) ;
   OPT_TESTMODE = ( OPTMASK &  OPTMASK_SIMSED_TESTMODE ) ;
+  OPT_MMAP     = ( OPTMASK &  OPTMASK_SIMSED_MMAP     ) ;
 
   if ( NFILT_SEDMODEL == 0  && OPT_TESTMODE==0 ) {
     sprintf(c1err,"No filters defined ?!?!?!? " );
@@ -235,6 +250,8 @@ int init_genmag_SIMSED(char *VERSION      // SIMSED version
 
   WRFLAG_SEDBINARY = RDFLAG_SEDBINARY = 0 ;
   WRFLAG_TABBINARY = RDFLAG_TABBINARY = 0 ;
+  WRFLAG_MMAP      = RDFLAG_MMAP      = 0 ;
+  MMAP_SEDMODEL_FLUXTABLE = 0 ;
 
   if ( OPT_BINARY ) {
 
@@ -250,11 +267,30 @@ int init_genmag_SIMSED(char *VERSION      // SIMSED version
     }
 
     sprintf(bin1File, "%s/SED.BINARY", SIMSED_PATHMODEL );
-    sprintf(bin2File,"%s/%s_%s-%s.BINARY", 
-	    PATH_BINARY, version, SURVEY, FILTLIST_SEDMODEL );
-
     open_SEDBINARY(bin1File, &fpbin1, &RDFLAG_SEDBINARY, &WRFLAG_SEDBINARY);
-    open_TABBINARY(bin2File, &fpbin2, &RDFLAG_TABBINARY, &WRFLAG_TABBINARY);
+
+    // lazy loading needs random access to existing SED.BINARY
+    SIMSED_LAZY.USE = ( SIMSED_LAZY.NSLOT_MAX > 0 && RDFLAG_SEDBINARY );
+    if ( SIMSED_LAZY.NSLOT_MAX > 0 && !RDFLAG_SEDBINARY ) 
+      { printf("  Lazy SED loading is disabled until SED.BINARY exists.\n"); }
+
+    if ( SIMSED_LAZY.USE ) {
+      // no flux-table binary; table holds only SEDs that are used
+    }
+    else if ( OPT_MMAP ) {
+      sprintf(bin2File,"%s/%s_%s-%s.MMAP", 
+	      PATH_BINARY, version, SURVEY, FILTLIST_SEDMODEL );
+      checkBinary_SIMSED(bin2File); // remove obsolete binary
+      if ( access(bin2File,R_OK) == 0 ) 
+	{ RDFLAG_MMAP = MMAP_SEDMODEL_FLUXTABLE = 1 ; }
+      else
+	{ WRFLAG_MMAP = 1 ; }
+    }
+    else {
+      sprintf(bin2File,"%s/%s_%s-%s.BINARY", 
+	      PATH_BINARY, version, SURVEY, FILTLIST_SEDMODEL );
+      open_TABBINARY(bin2File, &fpbin2, &RDFLAG_TABBINARY, &WRFLAG_TABBINARY);
+    }
   }
 
   // -------------------------------------- 
@@ -281,14 +317,34 @@ int init_genmag_SIMSED(char *VERSION      // SIMSED version
   // allocate memory for storing flux-integral tables
   NZBIN  = REDSHIFT_SEDMODEL.NZBIN ;
   NLAMPOW_SEDMODEL = 0 ;
-  malloc_FLUXTABLE_SEDMODEL ( NFILT_SEDMODEL, NZBIN, NLAMPOW_SEDMODEL, 
-			      SEDMODEL.MXDAY, SEDMODEL.NSURFACE );
+  if ( SIMSED_LAZY.USE ) 
+    { init_LAZY_SIMSED(fpbin1); }        // SED headers only
+  else if ( RDFLAG_MMAP ) 
+    { mmap_SIMSED_TABBINARY(bin2File); } // map table; no malloc
+  else {
+    malloc_FLUXTABLE_SEDMODEL ( NFILT_SEDMODEL, NZBIN, NLAMPOW_SEDMODEL, 
+				SEDMODEL.MXDAY, SEDMODEL.NSURFACE );
+  }
+  if ( WRFLAG_MMAP ) {
+    SIMSED_MMAP.NINFO   = NINFO0_SIMSED_MMAP + SEDMODEL.MXDAY ;
+    SIMSED_MMAP.SEDINFO = (double*)calloc( (SEDMODEL.NSURFACE+1) * 
+					   SIMSED_MMAP.NINFO, sizeof(double));
+  }
   fflush(stdout);
 
   // ------- Now read the spectral templates -----------
 
   for ( ised = 1 ; ised <= SEDMODEL.NSURFACE ; ised++ ) {
+
+    if ( SIMSED_LAZY.USE ) { break ; } // SEDs are loaded on first use
     
+    // with mapped table, fetch SED binning from map instead of SED files
+    if ( RDFLAG_MMAP && WRFLAG_SEDBINARY == 0 ) {
+      fetch_SEDINFO_MMAP(ised);
+      init_flux_SEDMODEL(0,ised);
+      continue ;
+    }
+
     sprintf(tmpFile, "%s/%s", SIMSED_PATHMODEL, SEDMODEL.FILENAME[ised] );
     sprintf(sedcomment,"(ised=%d/%d)", ised, SEDMODEL.NSURFACE );
 
@@ -346,7 +402,9 @@ int init_genmag_SIMSED(char *VERSION      // SIMSED version
     }
 
 
-    if ( RDFLAG_TABBINARY == 0 ) {
+    if ( WRFLAG_MMAP ) { store_SEDINFO_MMAP(ised); }
+
+    if ( RDFLAG_TABBINARY == 0 && RDFLAG_MMAP == 0 ) {
 
       // make fine lambda bins for faster integration
       init_FINEBIN_SEDMODEL(ised); 
@@ -384,7 +442,8 @@ int init_genmag_SIMSED(char *VERSION      // SIMSED version
 
   fflush(stdout);
 
-  if ( WRFLAG_SEDBINARY || RDFLAG_SEDBINARY ) {  fclose(fpbin1);  }
+  if ( (WRFLAG_SEDBINARY || RDFLAG_SEDBINARY) && !SIMSED_LAZY.USE ) 
+    {  fclose(fpbin1);  }
 
 
   // write binary integral-flux table to current directory;
@@ -409,6 +468,21 @@ int init_genmag_SIMSED(char *VERSION      // SIMSED version
     read_SIMSED_TABBINARY(fpbin2,bin2File);
     fclose(fpbin2);
   }
+  else if ( WRFLAG_MMAP ) {
+    write_SIMSED_MMAP(bin2File);
+  }
+
+  if ( RDFLAG_TABBINARY || RDFLAG_MMAP ) {
+    // Oct 2026: interp coeff from table that was read
+    if ( INPUTS_SEDMODEL.OPT_INTERP_COEFF > 0 ) {
+      for ( ised = 1 ; ised <= SEDMODEL.NSURFACE ; ised++ ) {
+	for(ifilt=1; ifilt <= NFILT_SEDMODEL; ifilt++) {
+	  ifilt_obs = FILTER_SEDMODEL[ifilt].ifilt_obs ;
+	  init_interpCoeff_SEDMODEL(ifilt_obs,ised); 
+	}
+      }
+    }
+  }
 
 
   // ===========================================
@@ -666,6 +740,474 @@ void read_SIMSED_TABBINARY(FILE *fp, char *binFile) {
 } // end of read_SIMSED_TABBINARY
 
 
+// ****************************************************************
+void mmap_SIMSED_TABBINARY(char *binFile) {
+
+  // Created Oct 2026
+  // Memory-map flux-integral table written by write_SIMSED_MMAP.
+  // The map is read-only and shared, so all jobs on a node use
+  // one page-cache copy and there is no read or malloc of the table.
+  // If the table has a wider redshift range than requested,
+  // use the table binning (as in read_SIMSED_TABBINARY) without
+  // re-allocating memory.
+
+  int    fd, idim, LZOK, NERR = 0 ;
+  int    NBIN_REQ[NDIM_SEDMODEL_FLUXTABLE+1];
+  char  *ADDR ;
+  struct stat statbuf ;
+  SIMSED_MMAP_HEAD_DEF *HEAD ;
+  struct REDSHIFT_SEDMODEL_TYPE *ZTAB ;
+  char fnam[] = "mmap_SIMSED_TABBINARY" ;
+
+  // ------------ BEGIN ----------
+
+  printf("\n  Map filter-integral flux-table from binary file: \n");
+  printf("\t %s \n\n", binFile);
+  fflush(stdout);
+
+  fd = open(binFile, O_RDONLY);
+  if ( fd < 0 || fstat(fd,&statbuf) != 0 ) {
+    sprintf(c1err,"Cannot open binary file");
+    sprintf(c2err,"%s", binFile );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+  }
+  if ( statbuf.st_size < (off_t)sizeof(SIMSED_MMAP_HEAD_DEF) ) {
+    sprintf(c1err,"Binary file size (%lld bytes) is too small.", 
+	    (long long)statbuf.st_size );
+    sprintf(c2err,"Must remove %s", binFile );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+  }
+
+  ADDR = (char*)mmap(NULL, statbuf.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if ( ADDR == MAP_FAILED ) {
+    sprintf(c1err,"mmap failed for binary file");
+    sprintf(c2err,"%s", binFile );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+  }
+
+  HEAD = (SIMSED_MMAP_HEAD_DEF*)ADDR ;
+  ZTAB = &HEAD->REDSHIFT ;
+
+  // check version and layout of this build
+  if ( strcmp(HEAD->MAGIC,MAGIC_SIMSED_MMAP) != 0      ||
+       HEAD->IVERSION != IVERSION_SIMSED_MMAP          ||
+       HEAD->HEADSIZE != sizeof(SIMSED_MMAP_HEAD_DEF)  ||
+       HEAD->IZSIZE   != sizeof(REDSHIFT_SEDMODEL)     ||
+       HEAD->FILESIZE != (long long)statbuf.st_size       ) {
+    printf("\n PRE-ABORT DUMP: \n");
+    printf("\t IVERSION(file,expect) = %d, %d \n", 
+	   HEAD->IVERSION, IVERSION_SIMSED_MMAP);
+    printf("\t HEADSIZE(file,expect) = %d, %d \n", 
+	   HEAD->HEADSIZE, (int)sizeof(SIMSED_MMAP_HEAD_DEF) );
+    printf("\t FILESIZE(file,expect) = %lld, %lld \n", 
+	   (long long)statbuf.st_size, HEAD->FILESIZE );
+    sprintf(c1err,"Invalid or obsolete memory-map binary.");
+    sprintf(c2err,"Must remove %s", binFile );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+  }
+
+  if ( BINARYFLAG_KCORFILENAME && 
+       strcmp(SIMSED_KCORFILE,HEAD->KCORFILE) != 0 ) {
+    sprintf(c1err,"Binary file KCOR_FILE: '%s' ", HEAD->KCORFILE);
+    sprintf(c2err,"but current KCOR_FILE: '%s' ", SIMSED_KCORFILE);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+  }
+
+  // table redshift range must contain requested range
+  LZOK   = ( ZTAB->ZMIN  <= REDSHIFT_SEDMODEL.ZMIN &&
+	     ZTAB->ZMAX  >= REDSHIFT_SEDMODEL.ZMAX &&
+	     ZTAB->NZBIN >= REDSHIFT_SEDMODEL.NZBIN );
+  if ( !LZOK ) {
+    printf(" WARNING: NZBIN(request,table) = %d , %d \n", 
+	   REDSHIFT_SEDMODEL.NZBIN,  ZTAB->NZBIN );
+    printf(" WARNING: ZMIN(request,table) = %6.4f , %6.4f \n", 
+	   REDSHIFT_SEDMODEL.ZMIN,  ZTAB->ZMIN );
+    printf(" WARNING: ZMAX(request,table) = %6.4f , %6.4f \n", 
+	   REDSHIFT_SEDMODEL.ZMAX,  ZTAB->ZMAX );
+    sprintf(c1err,"Redshift range does not match binary table range.");
+    sprintf(c2err,"Must remove %s", binFile );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+  }
+
+  // use table redshift binning; set index offsets (no malloc)
+  REDSHIFT_SEDMODEL = *ZTAB ;
+  malloc_FLUXTABLE_SEDMODEL ( NFILT_SEDMODEL, REDSHIFT_SEDMODEL.NZBIN, 
+			      NLAMPOW_SEDMODEL, SEDMODEL.MXDAY, 
+			      SEDMODEL.NSURFACE );
+
+  for ( idim=1; idim <= NDIM_SEDMODEL_FLUXTABLE; idim++ ) 
+    { NBIN_REQ[idim] = NBIN_SEDMODEL_FLUXTABLE[idim] ; }
+
+  for ( idim=1; idim <= NDIM_SEDMODEL_FLUXTABLE; idim++ ) {
+    if  ( HEAD->NBIN[idim] != NBIN_REQ[idim] ) {
+      printf(" WARNING: NBIN(%s)=%d from binary table, but request is %d \n"
+	     , VARNAME_SEDMODEL_FLUXTABLE[idim]
+	     , HEAD->NBIN[idim], NBIN_REQ[idim] );
+      NERR++ ;
+    }
+  }
+  if ( HEAD->NBTOT != (long long)NBTOT_SEDMODEL_FLUXTABLE ) { NERR++ ; }
+  if ( NERR > 0 ) {
+    sprintf(c1err,"Binary table mis-match => " ) ;
+    sprintf(c2err,"Try deleting %s", binFile );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+  }
+
+  PTR_SEDMODEL_FLUXTABLE = (float *)(ADDR + HEAD->OFFSET_TABLE) ;
+  SIMSED_MMAP.NINFO      = HEAD->NINFO ;
+  SIMSED_MMAP.SEDINFO    = (double*)(ADDR + HEAD->OFFSET_SEDINFO) ;
+  SIMSED_MMAP.ADDR       = (void*)ADDR ;
+  SIMSED_MMAP.SIZE       = statbuf.st_size ;
+
+  printf("\t Mapped %.2f MB flux table. \n", 
+	 1.0E-6*(double)HEAD->NBTOT*sizeof(float) );
+  fflush(stdout);
+
+  return ;
+
+} // end of mmap_SIMSED_TABBINARY
+
+
+// ****************************************************************
+void write_SIMSED_MMAP(char *binFile) {
+
+  // Created Oct 2026
+  // Write flux-integral table and SED binning info with the
+  // page-aligned layout read by mmap_SIMSED_TABBINARY.
+  // Write to temp file, then rename, so that concurrent jobs
+  // never map a partially written file.
+
+  int   NSED  = SEDMODEL.NSURFACE ;
+  int   idim ;
+  long long ALIGN = ALIGN_SIMSED_MMAP ;
+  long long NBYTE_HEAD, NBYTE_INFO, NBYTE_TABLE ;
+  char  tmpFile[MXPATHLEN+20], *PAD ;
+  SIMSED_MMAP_HEAD_DEF HEAD ;
+  FILE *fp ;
+  char fnam[] = "write_SIMSED_MMAP" ;
+
+  // ------------ BEGIN ----------
+
+  NBYTE_HEAD  = sizeof(SIMSED_MMAP_HEAD_DEF) ;
+  NBYTE_INFO  = (long long)(NSED+1) * SIMSED_MMAP.NINFO * sizeof(double);
+  NBYTE_TABLE = (long long)NBTOT_SEDMODEL_FLUXTABLE * sizeof(float);
+
+  memset(&HEAD, 0, NBYTE_HEAD);
+  sprintf(HEAD.MAGIC, "%s", MAGIC_SIMSED_MMAP);
+  HEAD.IVERSION = IVERSION_SIMSED_MMAP ;
+  HEAD.HEADSIZE = NBYTE_HEAD ;
+  HEAD.IZSIZE   = sizeof(REDSHIFT_SEDMODEL);
+  for ( idim=1; idim <= NDIM_SEDMODEL_FLUXTABLE; idim++ ) 
+    { HEAD.NBIN[idim] = NBIN_SEDMODEL_FLUXTABLE[idim] ; }
+  HEAD.NSED     = NSED ;
+  HEAD.MXDAY    = SEDMODEL.MXDAY ;
+  HEAD.NINFO    = SIMSED_MMAP.NINFO ;
+  HEAD.NBTOT    = NBTOT_SEDMODEL_FLUXTABLE ;
+  HEAD.OFFSET_SEDINFO = ( (NBYTE_HEAD + ALIGN-1) / ALIGN ) * ALIGN ;
+  HEAD.OFFSET_TABLE   = 
+    ( (HEAD.OFFSET_SEDINFO + NBYTE_INFO + ALIGN-1) / ALIGN ) * ALIGN ;
+  HEAD.FILESIZE = HEAD.OFFSET_TABLE + NBYTE_TABLE ;
+  HEAD.REDSHIFT = REDSHIFT_SEDMODEL ;
+  sprintf(HEAD.KCORFILE, "%s", SIMSED_KCORFILE);
+
+  fp = open_TEMPFILE(binFile, tmpFile);
+  if ( !fp ) {
+    sprintf(c1err,"Cannot open temp binary file");
+    sprintf(c2err,"%s", tmpFile );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+  }
+
+  PAD = (char*)calloc(ALIGN, 1);
+  fwrite(&HEAD, NBYTE_HEAD, 1, fp);
+  fwrite(PAD, 1, HEAD.OFFSET_SEDINFO - NBYTE_HEAD, fp);
+  fwrite(SIMSED_MMAP.SEDINFO, 1, NBYTE_INFO, fp);
+  fwrite(PAD, 1, HEAD.OFFSET_TABLE - HEAD.OFFSET_SEDINFO - NBYTE_INFO, fp);
+  fwrite(PTR_SEDMODEL_FLUXTABLE, 1, NBYTE_TABLE, fp);
+  free(PAD);
+
+  if ( close_TEMPFILE(fp, 0, tmpFile, binFile) != SUCCESS ) {
+    sprintf(c1err,"Cannot write binary file (disk full?)");
+    sprintf(c2err,"%s", binFile );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+  }
+
+  printf("\n  Write memory-map flux-table (%.2f MB) to binary file: \n",
+	 1.0E-6*(double)HEAD.FILESIZE );
+  printf("\t %s \n\n", binFile);
+  fflush(stdout);
+
+  return ;
+
+} // end of write_SIMSED_MMAP
+
+
+// ****************************************************************
+void store_SEDINFO_MMAP(int ised) {
+
+  // Created Oct 2026
+  // Store SED binning from TEMP_SEDMODEL for memory-map binary.
+
+  double *INFO = &SIMSED_MMAP.SEDINFO[ised*SIMSED_MMAP.NINFO] ;
+  int NDAY = TEMP_SEDMODEL.NDAY ;
+  int NLAM = TEMP_SEDMODEL.NLAM ;
+  int iday ;
+
+  INFO[0] = (double)NDAY ;
+  INFO[1] = (double)NLAM ;
+  INFO[2] = TEMP_SEDMODEL.DAYSTEP ;
+  INFO[3] = TEMP_SEDMODEL.LAMSTEP ;
+  INFO[4] = TEMP_SEDMODEL.LAM[0] ;
+  INFO[5] = TEMP_SEDMODEL.LAM[NLAM-1] ;
+  for ( iday=0; iday < NDAY; iday++ ) 
+    { INFO[NINFO0_SIMSED_MMAP+iday] = TEMP_SEDMODEL.DAY[iday] ; }
+
+} // end of store_SEDINFO_MMAP
+
+
+// ****************************************************************
+void fetch_SEDINFO_MMAP(int ised) {
+
+  // Created Oct 2026
+  // Load SED binning from mapped binary into TEMP_SEDMODEL
+  // so that init_flux_SEDMODEL(0,ised) can be called
+  // without reading the SED fluxes.
+
+  double *INFO = &SIMSED_MMAP.SEDINFO[ised*SIMSED_MMAP.NINFO] ;
+  int NDAY = (int)INFO[0] ;
+  int NLAM = (int)INFO[1] ;
+  int iday ;
+
+  TEMP_SEDMODEL.NDAY      = NDAY ;
+  TEMP_SEDMODEL.NLAM      = NLAM ;
+  TEMP_SEDMODEL.DAYSTEP   = INFO[2] ;
+  TEMP_SEDMODEL.LAMSTEP   = INFO[3] ;
+  TEMP_SEDMODEL.LAM[0]      = TEMP_SEDMODEL.MINLAM = INFO[4] ;
+  TEMP_SEDMODEL.LAM[NLAM-1] = TEMP_SEDMODEL.MAXLAM = INFO[5] ;
+  for ( iday=0; iday < NDAY; iday++ ) 
+    { TEMP_SEDMODEL.DAY[iday] = INFO[NINFO0_SIMSED_MMAP+iday] ; }
+
+} // end of fetch_SEDINFO_MMAP
+
+
+// ****************************************************************
+void init_LAZY_SIMSED(FILE *fp) {
+
+  // Created Oct 2026
+  // Init lazy SED loading from SED.BINARY (fp is positioned after
+  // the MXDAY header word). For each SED, store the file location
+  // of its SEDBINARY words, and read only the DAY & LAMBDA binning
+  // so that SEDMODEL per-SED and global ranges are set as for the
+  // full init. Fluxes and flux integrals are computed later by
+  // load_LAZY_SIMSED, in a table with NSLOT SEDs instead of NSED.
+  // All reads use pread at explicit offsets (pread_LAZY_SIMSED), 
+  // because forked NTHREAD_GEN workers share the file offset of fp.
+
+  int  NSED   = SEDMODEL.NSURFACE ;
+  int  NPAR   = SEDMODEL.NPAR ;
+  int  NSLOT, NSLOT_MIN, NHEAD, ised, NDAY, NLAM, j ;
+  off_t OFF ;
+  float LAMWORD[2];
+  char tmpFile[MXPATHLEN], sedFile[MXPATHLEN] ;
+  char fnam[] = "init_LAZY_SIMSED" ;
+
+  // ------------ BEGIN ----------
+
+  // pool must hold all corners of one interpolation
+  if ( NPAR > INTERP_SIMSED_MAX_DIM ) { NPAR = INTERP_SIMSED_MAX_DIM ; }
+  NSLOT_MIN = (1 << NPAR) + 1 ;
+  NSLOT     = SIMSED_LAZY.NSLOT_MAX ;
+  if ( NSLOT < NSLOT_MIN ) { NSLOT = NSLOT_MIN ; }
+  if ( NSLOT > NSED      ) { NSLOT = NSED ; }
+
+  SIMSED_LAZY.FP         = fp ;
+  SIMSED_LAZY.FD         = fileno(fp) ;
+  SIMSED_LAZY.NSLOT      = NSLOT ;
+  SIMSED_LAZY.NSLOT_USED = 0 ;
+  SIMSED_LAZY.CLOCK      = 0 ;
+  SIMSED_LAZY.NLOAD      = SIMSED_LAZY.NEVICT = 0 ;
+  SIMSED_LAZY.ISED_SLOT  = (int      *)calloc(NSLOT+1, sizeof(int) );
+  SIMSED_LAZY.LASTUSE    = (long long*)calloc(NSLOT+1, sizeof(long long));
+  SIMSED_LAZY.OFFSET     = (long int *)calloc(NSED+1,  sizeof(long int));
+  SIMSED_LAZY.NWORD      = (int      *)calloc(NSED+1,  sizeof(int) );
+  ISLOT_SEDMODEL_FLUXTABLE = (int    *)calloc(NSED+1,  sizeof(int) );
+
+  printf("\n  Lazy SED loading: keep up to %d of %d SEDs in memory.\n",
+	 NSLOT, NSED);
+  malloc_FLUXTABLE_SEDMODEL ( NFILT_SEDMODEL, REDSHIFT_SEDMODEL.NZBIN, 
+			      NLAMPOW_SEDMODEL, SEDMODEL.MXDAY, NSLOT );
+
+  // see pack_SEDBINARY for word layout
+  OFF = ftello(fp);
+  for ( ised = 1 ; ised <= NSED ; ised++ ) {
+    sprintf(tmpFile, "%s/%s", SIMSED_PATHMODEL, SEDMODEL.FILENAME[ised] );
+    pread_LAZY_SIMSED(sedFile, sizeof(sedFile), OFF, "SED file name");
+    OFF += sizeof(sedFile);
+    if ( strcmp(tmpFile,sedFile) != 0 ) {
+      printf("\n\n");
+      printf("BINARY   SED File: '%s' \n", sedFile );
+      printf("EXPECTED SED File: '%s' \n", tmpFile );
+      sprintf(c1err,"binary SED file does not match expected file.");
+      sprintf(c2err,"Try deleting SED.BINARY file.");
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+    }
+
+    pread_LAZY_SIMSED(&NSEDBINARY, sizeof(int), OFF, "NSEDBINARY");
+    OFF += sizeof(int);
+    SIMSED_LAZY.OFFSET[ised] = (long int)OFF ;
+    SIMSED_LAZY.NWORD[ised]  = NSEDBINARY ;
+
+    NHEAD = 8 + SEDMODEL.MXDAY ;
+    if ( NHEAD > NSEDBINARY ) { NHEAD = NSEDBINARY ; }
+    pread_LAZY_SIMSED(SEDBINARY, NHEAD*sizeof(float), OFF, "SED header");
+    NDAY = (int)SEDBINARY[2] ;
+    NLAM = (int)SEDBINARY[6+NDAY] ;
+
+    pread_LAZY_SIMSED(&LAMWORD[0], sizeof(float), 
+		      OFF + (8+NDAY)*sizeof(float), "min LAM");
+    pread_LAZY_SIMSED(&LAMWORD[1], sizeof(float), 
+		      OFF + (7+NDAY+NLAM)*sizeof(float), "max LAM");
+    OFF += NSEDBINARY*sizeof(float);  // next SED
+
+    TEMP_SEDMODEL.NDAY    = NDAY ;
+    TEMP_SEDMODEL.DAYSTEP = (double)SEDBINARY[3] ;
+    for ( j=0; j < NDAY; j++ ) 
+      { TEMP_SEDMODEL.DAY[j] = SEDBINARY[6+j] ; }
+    TEMP_SEDMODEL.NLAM        = NLAM ;
+    TEMP_SEDMODEL.LAMSTEP     = (double)SEDBINARY[7+NDAY] ;
+    TEMP_SEDMODEL.LAM[0]      = LAMWORD[0] ;
+    TEMP_SEDMODEL.LAM[NLAM-1] = LAMWORD[1] ;
+
+    init_flux_SEDMODEL(0,ised);  // set binning, then skip integrals
+  }
+
+  fflush(stdout);
+  return ;
+
+} // end of init_LAZY_SIMSED
+
+
+// ****************************************************************
+void load_LAZY_SIMSED(int ised) {
+
+  // Created Oct 2026
+  // Make sure that flux integrals for ised are in the table.
+  // If not, read SED from SED.BINARY into least-recently-used slot
+  // and compute its integrals for all filters.
+
+  int  slot, s, ifilt, ifilt_obs, iz, ilampow, iep ;
+  int  *ISLOT = ISLOT_SEDMODEL_FLUXTABLE ;
+  long int index ;
+  double MINLAM_ALL, MAXLAM_ALL ;
+
+  // ------------ BEGIN ----------
+
+  slot = ISLOT[ised] ;
+  if ( slot > 0 ) 
+    { SIMSED_LAZY.LASTUSE[slot] = ++SIMSED_LAZY.CLOCK ;  return ; }
+
+  if ( SIMSED_LAZY.NSLOT_USED < SIMSED_LAZY.NSLOT ) 
+    { slot = ++SIMSED_LAZY.NSLOT_USED ; }
+  else {
+    slot = 1 ;
+    for ( s=2; s <= SIMSED_LAZY.NSLOT; s++ ) {
+      if ( SIMSED_LAZY.LASTUSE[s] < SIMSED_LAZY.LASTUSE[slot] ) 
+	{ slot = s ; }
+    }
+    ISLOT[SIMSED_LAZY.ISED_SLOT[slot]] = 0 ;
+    SIMSED_LAZY.NEVICT++ ;
+  }
+
+  ISLOT[ised]                 = slot ;
+  SIMSED_LAZY.ISED_SLOT[slot] = ised ;
+  SIMSED_LAZY.LASTUSE[slot]   = ++SIMSED_LAZY.CLOCK ;
+  SIMSED_LAZY.NLOAD++ ;
+
+  // zero slot since init_flux_SEDMODEL sums into table
+  for ( ifilt=0; ifilt <= NBIN_SEDMODEL_FLUXTABLE[IDIM_SEDMODEL_FILTER];
+	ifilt++ ) {
+    for ( iz=0; iz <= NBIN_SEDMODEL_FLUXTABLE[IDIM_SEDMODEL_REDSHIFT]; 
+	  iz++ ) {
+      for ( ilampow=0; ilampow <= NLAMPOW_SEDMODEL; ilampow++ ) {
+	for ( iep=0; iep <= SEDMODEL.MXDAY; iep++ ) {
+	  index = INDEX_SEDMODEL_FLUXTABLE(ifilt,iz,ilampow,iep,ised);
+	  PTR_SEDMODEL_FLUXTABLE[index] = 0.0 ;
+	}
+      }
+    }
+  }
+
+  // read SED and compute integrals as in init_genmag_SIMSED
+  NSEDBINARY = SIMSED_LAZY.NWORD[ised] ;
+  pread_LAZY_SIMSED(SEDBINARY, NSEDBINARY*sizeof(float), 
+		    (off_t)SIMSED_LAZY.OFFSET[ised], "SED fluxes");
+  pack_SEDBINARY(-1);
+
+  // protect global lambda range that is reset for ised=1
+  MINLAM_ALL = SEDMODEL.MINLAM_ALL ;
+  MAXLAM_ALL = SEDMODEL.MAXLAM_ALL ;
+
+  init_FINEBIN_SEDMODEL(ised); 
+  for(ifilt=1; ifilt <= NFILT_SEDMODEL; ifilt++) {
+    ifilt_obs = FILTER_SEDMODEL[ifilt].ifilt_obs ;
+    init_flux_SEDMODEL(ifilt_obs,ised); 
+  }
+  init_FINEBIN_SEDMODEL(-1);
+
+  SEDMODEL.MINLAM_ALL = MINLAM_ALL ;
+  SEDMODEL.MAXLAM_ALL = MAXLAM_ALL ;
+
+  return ;
+
+} // end of load_LAZY_SIMSED
+
+
+// ****************************************************************
+void pread_LAZY_SIMSED(void *ptr, size_t NBYTE, off_t OFF, char *what) {
+
+  // Created Oct 2026
+  // Read NBYTE at offset OFF of SED.BINARY; abort on short read.
+  // pread does not use or move the file offset, which is shared
+  // with forked NTHREAD_GEN workers.
+
+  char    *P = (char*)ptr ;
+  ssize_t  N ;
+  size_t   NRD = 0 ;
+  char fnam[] = "pread_LAZY_SIMSED" ;
+
+  // ------------ BEGIN ----------
+
+  while ( NRD < NBYTE ) {
+    N = pread(SIMSED_LAZY.FD, P+NRD, NBYTE-NRD, OFF+(off_t)NRD);
+    if ( N <= 0 ) {
+      sprintf(c1err,"Read %d of %d bytes for %s", 
+	      (int)NRD, (int)NBYTE, what );
+      sprintf(c2err,"at offset %lld of SED.BINARY; try deleting it.",
+	      (long long)OFF );
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+    }
+    NRD += (size_t)N ;
+  }
+
+} // end of pread_LAZY_SIMSED
+
+
+// ****************************************************************
+double get_flux_SIMSED(int ISED, int ilampow, int ifilt_obs,
+		       double z, double Trest) {
+
+  // Created Oct 2026
+  // Shell for get_flux_SEDMODEL; for lazy loading,
+  // first make sure that ISED is in memory.
+
+  if ( SIMSED_LAZY.USE ) { load_LAZY_SIMSED(ISED); }
+  return( get_flux_SEDMODEL(ISED, ilampow, ifilt_obs, z, Trest) );
+
+} // end of get_flux_SIMSED
+
+
+
+
 
 // ****************************************************************
 int read_SIMSED_INFO(char *PATHMODEL) {
@@ -1337,7 +1879,7 @@ double nextgrid_flux_SIMSED (
   }
 
 
-  Sinterp = get_flux_SEDMODEL( ISED, 0, ifilt_obs, z, Trest);
+  Sinterp = get_flux_SIMSED( ISED, 0, ifilt_obs, z, Trest);
 
   ISED_SEDMODEL = ISED; // set globa, Mar 6 2017
 
@@ -1428,7 +1970,7 @@ double interp_flux_SIMSED(
   if ( SEDMODEL.NSURFACE == 1 ) {
     ISED = 1;
     ISED_SEDMODEL = ISED; // set globa, Mar 6 2017
-    Sinterp = get_flux_SEDMODEL( ISED, 0, ifilt_obs, z, Trest);
+    Sinterp = get_flux_SIMSED( ISED, 0, ifilt_obs, z, Trest);
 
     // load *lumipar array
     for ( ipar=0; ipar < SEDMODEL.NPAR ; ipar++ ) 
@@ -1494,7 +2036,7 @@ double interp_flux_SIMSED(
 	if ( fabs(diff) < 0.0001 ) { NMATCH++ ; }
       }
       if ( NMATCH == NGRIDONLY ) { 
-	Sinterp = get_flux_SEDMODEL(ISED, 0, ifilt_obs, z, Trest);	
+	Sinterp = get_flux_SIMSED(ISED, 0, ifilt_obs, z, Trest);	
 	ISED_SEDMODEL = ISED; // set globa, Mar 6 2017
 
 	// load *lumipar array
@@ -1746,7 +2288,7 @@ double interp_flux_SIMSED(
        * multiply term by distance weightings for each
        * dimension.
        */
-      term = get_flux_SEDMODEL(corners[i] + 1, 0, ifilt_obs, z, Trest);
+      term = get_flux_SIMSED(corners[i] + 1, 0, ifilt_obs, z, Trest);
       ISED_SEDMODEL = corners[0]+1;
       
       for(k = 0; k < num_pars_baggage; k++)
@@ -1859,8 +2401,8 @@ double interp1D_flux_SIMSED(
 
   ilampow = 0;
 
-  S0int = get_flux_SEDMODEL(I0SED, ilampow, ifilt_obs, z, Trest );
-  S1int = get_flux_SEDMODEL(I1SED, ilampow, ifilt_obs, z, Trest );
+  S0int = get_flux_SIMSED(I0SED, ilampow, ifilt_obs, z, Trest );
+  S1int = get_flux_SIMSED(I1SED, ilampow, ifilt_obs, z, Trest );
   
   Sinterp  = S0int + (S1int-S0int)*frac;
 
@@ -21,12 +21,58 @@ char INFO_SIMSED_FILENAME_FULL[MXPATHLEN] ;
 // define OPTMASK bits for init_genmag_SIMSED (LSB=0)
 #define OPTMASK_SIMSED_BINARY    1  // --> make binary file
 #define OPTMASK_SIMSED_TESTMODE  64 // used by SIMSED_check program
+#define OPTMASK_SIMSED_MMAP     128 // memory-mapped flux-table binary
 
 #define WRVERSION_SIMSED_BINARY  2  // July 30 2017:
 int     IVERSION_SIMSED_BINARY ;     // actual version
 
 #define LOGZBIN_SIMSED_DEFAULT 0.02
 
+// Oct 2026: memory-mapped flux-table binary, shared by all processes
+// on a node via the page cache. Layout is
+//   SIMSED_MMAP_HEAD_DEF (padded to HEADSIZE)
+//   SEDINFO  : NSED+1 records of NINFO doubles at OFFSET_SEDINFO
+//   FLUXTABLE: NBTOT floats at page-aligned OFFSET_TABLE
+#define MAGIC_SIMSED_MMAP     "SIMSED_MMAP"
+#define IVERSION_SIMSED_MMAP  1
+#define ALIGN_SIMSED_MMAP     4096
+#define NINFO0_SIMSED_MMAP    6  // NDAY,NLAM,DAYSTEP,LAMSTEP,MINLAM,MAXLAM
+
+typedef struct {
+  char      MAGIC[16];
+  int       IVERSION, HEADSIZE, IZSIZE ;
+  int       NBIN[NDIM_SEDMODEL_FLUXTABLE+1] ;
+  int       NSED, MXDAY, NINFO ;
+  long long NBTOT ;           // number of floats in flux table
+  long long OFFSET_SEDINFO ;  // byte offsets from start of file
+  long long OFFSET_TABLE ;
+  long long FILESIZE ;
+  struct REDSHIFT_SEDMODEL_TYPE REDSHIFT ;
+  char      KCORFILE[MXPATHLEN];
+} SIMSED_MMAP_HEAD_DEF ;
+
+struct {
+  int     NINFO ;
+  double *SEDINFO ;   // [ised*NINFO + i]; DAY list starts at i=NINFO0
+  void   *ADDR ;      // start of mapped file
+  size_t  SIZE ;
+} SIMSED_MMAP ;
+
+// Oct 2026: lazy SED loading. SEDs are read from SED.BINARY and
+// integrated only when first used, into an LRU pool of NSLOT SEDs.
+struct {
+  int        NSLOT_MAX ;   // user input; 0 -> load all SEDs at init
+  int        USE ;
+  int        NSLOT, NSLOT_USED ;
+  int       *ISED_SLOT ;   // [slot] -> ised
+  long long *LASTUSE, CLOCK ;
+  long int  *OFFSET ;      // [ised] -> file offset of SEDBINARY words
+  int       *NWORD ;       // [ised] -> number of SEDBINARY words
+  FILE      *FP ;          // SED.BINARY, kept open
+  int        FD ;          // fileno(FP) for pread (no shared offset)
+  int        NLOAD, NEVICT ;
+} SIMSED_LAZY ;
+
 double Trange_SIMSED[2] ; // used for rd_sedflux
 double Lrange_SIMSED[2] ;
 
@@ -61,6 +107,16 @@ void open_SEDBINARY(char *fileName, FILE **fpbin, int *RDFLAG, int *WRFLAG);
 void open_TABBINARY(char *fileName, FILE **fpbin, int *RDFLAG, int *WRFLAG);
 
 void read_SIMSED_TABBINARY(FILE *fp, char *binFile);
+void mmap_SIMSED_TABBINARY(char *binFile);
+void write_SIMSED_MMAP(char *binFile);
+void store_SEDINFO_MMAP(int ised);
+void fetch_SEDINFO_MMAP(int ised);
+
+void   init_LAZY_SIMSED(FILE *fp);
+void   load_LAZY_SIMSED(int ised);
+void   pread_LAZY_SIMSED(void *ptr, size_t NBYTE, off_t OFF, char *what);
+double get_flux_SIMSED(int ISED, int ilampow, int ifilt_obs,
+		       double z, double Trest);
 
 void genmag_SIMSED(int OPTMASK, int ifilt, double x0, 
 		   int NLUMIPAR, int *iflagpar, int *iparmap, double *lumipar,
@@ -130,6 +130,12 @@
 
  Apr 28 2019:
    + new debug input SN_SED_POWERLAW -> flux(SN) = (lam/5000)^POWERLAW.
+
+ Oct 2026:
+   + new input NTHREAD: (or command-line NTHREAD <n>) to split
+     K-cor grid among threads. Output is identical for any NTHREAD.
+   + filter trans is pre-computed on SN lambda grid, and SN flux &
+     MW extinction are computed once per grid point for all K-cors.
     
 ****************************************************/
 
@@ -140,6 +146,7 @@
 #include <fcntl.h>   
 #include <errno.h>   
 #include <math.h>       // need this for log10 function 
+#include <pthread.h>
 
 #include "fitsio.h"
 
@@ -336,6 +343,7 @@ int rd_input(void) {
   INPUTS.TREF_EXPLODE = -19.0 ;
 
   INPUTS.NLAMBIN_FT = 0;
+  INPUTS.NTHREAD    = 1;
 
   for ( ifilt=0; ifilt < MXFILTDEF; ifilt++ ) {
     FILTER[ifilt].MASKFRAME   = 0;
@@ -397,6 +405,10 @@ int rd_input(void) {
       readint ( fp_input, 1, &INPUTS.NLAMBIN_FT );
     }  
 
+    if ( strcmp(c_get,"NTHREAD:")==0 )  {
+      readint ( fp_input, 1, &INPUTS.NTHREAD );
+    }  
+
     if ( strcmp(c_get,"SN_TYPE:")==0 )  {
       readchar ( fp_input, INPUTS.SN_TYPE );
     }  
@@ -1173,6 +1185,10 @@ void kcor_input_override(int OPT) {
       i++ ; sscanf(ARGV_LIST[i] , "%d", &INPUTS.NLAMBIN_FT ); 
     }
 
+    if ( strcmp( ARGV_LIST[i], "NTHREAD" ) == 0 ) {
+      i++ ; sscanf(ARGV_LIST[i] , "%d", &INPUTS.NTHREAD ); 
+    }
+
     if ( strcmp( ARGV_LIST[i], "SN_TYPE" ) == 0 ) {
       i++ ; sscanf(ARGV_LIST[i] , "%s", INPUTS.SN_TYPE ); 
     }
@@ -2872,148 +2888,304 @@ int kcor_grid (void) {
   // Nov 12, 2010: loop over NKCOR+KCOR_EXTRA to get synthetic
   //               'magobs' for the rest-frame filters that are
   //               needed by snana.
+  //
+  // Oct 2026: grid is split by epoch among INPUTS.NTHREAD threads;
+  //           see kcor_grid_thread. Each thread loops over all
+  //           K-cors at each grid point, in the same order as before,
+  //           so that output is identical for any NTHREAD.
   // -------------------------------------------------
 
    char ctmp[20]
      ,  fnam[] = "kcor_grid"
      ;
 
-   int  ikcor, OPT, ifilt_rest, ifilt_obs ;
-   int  i_epoch, i_z, i_av, i_ebv, FLAG_MAGOBS, NZBIN ;
-   
-   double 
-     z, epoch, av, dum, kcor, kcormin, kcormax
-     ,err, ovp, magobs[MXMWEBV+2], magtmp, dxt, debv
-     ; 
+   int  ikcor, ithread, NTHREAD ;
+   double kcormin, kcormax ;
+   KCOR_WORK_DEF *WORK ;
+   pthread_t     *THREAD ;
 
    /* -------------------- BEGIN ------------------ */
 
-   OPT = 0;
-
    printf("\n  ***** START LOOPING for KCOR GRID ***** \n" );
 
+   NTHREAD = INPUTS.NTHREAD ;
+   if ( NTHREAD < 1 ) { NTHREAD = 1 ; }
+   if ( NTHREAD > SNSED.NEPOCH ) { NTHREAD = SNSED.NEPOCH ; }
+   INPUTS.NTHREAD = NTHREAD ;
+
+   init_kcor_SNGRID();
 
    for ( ikcor=1; ikcor <= NKCOR + NKCOR_EXTRA ; ikcor++ ) {
-       
-     // check which filter indices
+     if ( ikcor <= NKCOR ) 
+       { ctmp[0]=0; }
+     else
+       { sprintf(ctmp, "%s", "EXTRA"); }
 
-      ifilt_rest  = -1;
-      ifilt_obs   = -1;
+     printf("  Compute %s %s for '%s' (rest) => '%s' (obs) \n",
+	    ctmp, KCORSYM[ikcor], KCORLIST[ikcor][0], KCORLIST[ikcor][1] );
+   }
 
-      index_filter ( ikcor, &ifilt_rest, &ifilt_obs );
+   printf("\t Process %d epochs x %d AV x %d z bins with %d thread(s)\n",
+	  SNSED.NEPOCH, INPUTS.NBIN_AV, INPUTS.NBIN_REDSHIFT, NTHREAD);
+   fflush(stdout);
 
-      if ( ikcor <= NKCOR ) {
-	NZBIN  = INPUTS.NBIN_REDSHIFT;
-	ctmp[0]=0;
-      }
-      else {
-	NZBIN = 1;
-	sprintf(ctmp, "%s", "EXTRA");
-      }
+   WORK   = (KCOR_WORK_DEF*)malloc( NTHREAD * sizeof(KCOR_WORK_DEF) );
+   THREAD = (pthread_t    *)malloc( NTHREAD * sizeof(pthread_t) );
+   for ( ithread=0; ithread < NTHREAD; ithread++ ) 
+     { WORK[ithread].ITHREAD = ithread ; }
 
-      printf("  Compute %s %s for '%s' (rest) => '%s' (obs) \n",
-	     ctmp, KCORSYM[ikcor], KCORLIST[ikcor][0], KCORLIST[ikcor][1] );
-      kcormin = 999999. ;
-      kcormax = -99999. ;
+   if ( NTHREAD == 1 ) 
+     { kcor_grid_thread(&WORK[0]); }
+   else {
+     for ( ithread=0; ithread < NTHREAD; ithread++ ) {
+       pthread_create(&THREAD[ithread], NULL, 
+		      kcor_grid_thread, &WORK[ithread]);
+     }
+     for ( ithread=0; ithread < NTHREAD; ithread++ ) 
+       { pthread_join(THREAD[ithread], NULL); }
+   }
 
-      printf("\t AV = ");
+   // abort on first thread with nan
+   for ( ithread=0; ithread < NTHREAD; ithread++ ) {
+     if ( WORK[ithread].NERR == 0 ) { continue ; }
+     sprintf(c1err, "%s", WORK[ithread].ERRMSG[0] );
+     sprintf(c2err, "%s", WORK[ithread].ERRMSG[1] );
+     errmsg(SEV_FATAL, 0, fnam, c1err, c2err);  
+   }
 
+   for ( ikcor=1; ikcor <= NKCOR + NKCOR_EXTRA ; ikcor++ ) {
+     kcormin = 999999. ;
+     kcormax = -99999. ;
+     for ( ithread=0; ithread < NTHREAD; ithread++ ) {
+       if ( WORK[ithread].KCORMAX[ikcor] > kcormax ) 
+	 { kcormax = WORK[ithread].KCORMAX[ikcor] ; }
+       if ( WORK[ithread].KCORMIN[ikcor] < kcormin ) 
+	 { kcormin = WORK[ithread].KCORMIN[ikcor] ; }
+     }
+     printf("\t %s min/max = %6.3f/%6.3f \n", 
+	    KCORSYM[ikcor], kcormin, kcormax);
+   }     // end of ikcor loop 
+     
+   free(WORK);  free(THREAD);
 
-      // now loop over redshift and epoch 
+   return SUCCESS;
 
-      for ( i_av=1;  i_av<=INPUTS.NBIN_AV;   i_av++ ) {
 
-	  dum    = (double)(i_av-1) ;
-	  av     = INPUTS.AV_MIN + dum * INPUTS.AV_BINSIZE;
+} // end of kcor_grid
 
-          printf("%4.2f ", av);
-	  fflush(stdout);
 
-	for ( i_z=1;   i_z <= NZBIN ; i_z++ ) {
+// *************************************************
+void init_kcor_SNGRID(void) {
 
-	  dum   = (double)(i_z-1) ;
-	  z     = INPUTS.REDSHIFT_MIN + dum * INPUTS.REDSHIFT_BINSIZE;
+  // Created Oct 2026
+  // For each filter, store transmission on the SN lambda grid
+  // (epoch=1 binning used by kcor_eval) and the range of SN lambda
+  // bins inside the filter, so that kcor_eval does not interpolate
+  // filter transmission at every grid point.
+  // Also store rest/obs filter indices for each K-cor.
 
-	  for ( i_epoch=1; i_epoch<= SNSED.NEPOCH; i_epoch++ ) {
+  int NBIN = SNSED.NBIN_LAMBDA ;
+  int ifilt, ilam, ikcor, MEM ;
+  double LAM, LAMMIN, LAMMAX ;
 
-	    epoch = SNSED.EPOCH[i_epoch];  
+  // ------------- BEGIN --------------
 
-	    R4KCOR_GRID.REDSHIFT[ikcor][i_av][i_z][i_epoch]  = (float)z ;
-	    R4KCOR_GRID.EPOCH[ikcor][i_av][i_z][i_epoch]     = (float)epoch ;
+  MEM = (NBIN+1) * sizeof(double) ;
 
-	    // check if these obs mags have already been computed
-	    if ( SNSED.R4MAG_OBS[0][ifilt_obs][i_av][i_z][i_epoch] == NULLVAL )
-	      { FLAG_MAGOBS = 1 ; }
-	    else
-	      { FLAG_MAGOBS = 0; }
+  for ( ifilt=1; ifilt <= NFILTDEF; ifilt++ ) {
+    LAMMIN = FILTER[ifilt].LAMBDA_MIN ;
+    LAMMAX = FILTER[ifilt].LAMBDA_MAX ;
+    KCOR_SNGRID.TRANS[ifilt]         = (double*)malloc(MEM);
+    KCOR_SNGRID.ILAM_RANGE[ifilt][0] = NBIN+1 ;
+    KCOR_SNGRID.ILAM_RANGE[ifilt][1] = 0 ;
+
+    for ( ilam=1; ilam <= NBIN; ilam++ ) {
+      LAM = SNSED.LAMBDA[1][ilam];
+      KCOR_SNGRID.TRANS[ifilt][ilam] = 0.0 ;
+      if ( LAM < LAMMIN || LAM > LAMMAX ) { continue ; }
+
+      KCOR_SNGRID.TRANS[ifilt][ilam] = filter_trans8 ( LAM, ifilt, 0 );
+      if ( ilam < KCOR_SNGRID.ILAM_RANGE[ifilt][0] ) 
+	{ KCOR_SNGRID.ILAM_RANGE[ifilt][0] = ilam ; }
+      KCOR_SNGRID.ILAM_RANGE[ifilt][1] = ilam ;
+    }
+  }
 
-            kcor_eval( OPT
-		       ,av, z, epoch
-		       ,ifilt_rest, ifilt_obs 
-		       ,FLAG_MAGOBS
-		       ,&kcor, &err, &ovp, magobs        // return values
-		       );
+  for ( ikcor=1; ikcor <= NKCOR + NKCOR_EXTRA ; ikcor++ ) {
+    KCOR_SNGRID.IFILT_REST[ikcor] = -1 ;
+    KCOR_SNGRID.IFILT_OBS[ikcor]  = -1 ;
+    index_filter ( ikcor, &KCOR_SNGRID.IFILT_REST[ikcor], 
+		   &KCOR_SNGRID.IFILT_OBS[ikcor] );
+  }
 
-	    if ( kcor > kcormax ) kcormax = kcor ;
-	    if ( kcor < kcormin ) kcormin = kcor ;
-
-	    // if kcor is outside valid range, then set it to really
-	    // crazy NULLVAL so that sim & fitter know to ignore it
-	    if ( kcor > KCORMAX_VALID ) kcor = NULLVAL ;
-	    if ( kcor < KCORMIN_VALID ) kcor = NULLVAL ;
-
-	    // 6/08/2009: check for nan 
-	    if ( isnan(kcor) ) {
-	      sprintf(c1err,"kcor=%f  for z=%6.3f T=%6.3f  av=%6.3f",
-		      kcor, z, epoch, av);
-	      sprintf(c2err,"ifilt_[rest,obs]=%d,%d (%s,%s) FLAG_MAGOBS=%d"
-		      ,ifilt_rest, ifilt_obs
-		      ,FILTER[ifilt_rest].name
-		      ,FILTER[ifilt_obs].name
-		      ,FLAG_MAGOBS);
-	      errmsg(SEV_FATAL, 0, fnam, c1err, c2err);  
-	    }
+} // end of init_kcor_SNGRID
 
-	    R4KCOR_GRID.VALUE[ikcor][i_av][i_z][i_epoch]    = (float)kcor ;
 
-	    // Feb 2007: store observer mags with array of MW E(B-V)
-	    if ( FLAG_MAGOBS > 0 ) {
-	      for ( i_ebv = 0; i_ebv <= MXMWEBV; i_ebv++ ) {
-		magtmp = *(magobs + i_ebv);
-		if ( isnan(magtmp) ) {
-		  sprintf(c1err,"magobs=%f for i_ebv=%d z=%6.3f T=%6.2f",
-			  magtmp, i_ebv, z, epoch );
-		  sprintf(c2err,"ifilt_[rest,obs]=%d,%d", 
-			  ifilt_rest, ifilt_obs);
-		  errmsg(SEV_FATAL, 0, fnam, c1err, c2err);  
+// *************************************************
+void *kcor_grid_thread(void *arg) {
+
+  // Created Oct 2026
+  // Evaluate K-cors and observer mags for epochs
+  // i_epoch = 1+ITHREAD, 1+ITHREAD+NTHREAD, ...
+  // For each epoch, the MW extinction and mag weights are computed
+  // once per lambda bin; for each AV (and z), the SN flux is computed
+  // once per lambda bin and shared by all K-cors.
+  // Each grid point is processed by one thread, so that the
+  // R4MAG_OBS check for already-computed mags is the same as for
+  // serial processing. Errors are stored in WORK->ERRMSG and
+  // reported by kcor_grid after all threads are done.
+
+  KCOR_WORK_DEF *WORK = (KCOR_WORK_DEF*)arg ;
+  int NBIN    = SNSED.NBIN_LAMBDA ;
+  int NTHREAD = INPUTS.NTHREAD ;
+  int NZBIN_MAX, NZBIN, MEM ;
+  int ikcor, ifilt_rest, ifilt_obs, ilam, iepoch ;
+  int i_epoch, i_z, i_av, i_ebv, FLAG_MAGOBS, OPT = 0 ;
+  double z, epoch, av, dum, kcor, err, ovp, magobs[MXMWEBV+2];
+  double magtmp, dxt, debv, LAM, lam, ftmp, wfilt, mwav, tmp ;
+  double RV = INPUTS.RV_MWCOLORLAW ;
 
-		}
+  // ------------- BEGIN --------------
 
-		SNSED.R4MAG_OBS[i_ebv][ifilt_obs][i_av][i_z][i_epoch] = 
-		  (float)magtmp;
+  MEM = (NBIN+1) * sizeof(double) ;
+  WORK->FLUX_REST = (double*)malloc(MEM);
+  WORK->FLUX_OBS  = (double*)malloc(MEM);
+  WORK->WFLUX     = (double*)malloc(MEM);
+  for ( i_ebv = 0; i_ebv <= MXMWEBV; i_ebv++ ) 
+    { WORK->MWXT[i_ebv] = (double*)malloc(MEM); }
+
+  WORK->NERR = 0 ;
+  for ( ikcor=1; ikcor <= NKCOR + NKCOR_EXTRA ; ikcor++ ) {
+    WORK->KCORMIN[ikcor] = 999999. ;
+    WORK->KCORMAX[ikcor] = -99999. ;
+  }
+
+  NZBIN_MAX = INPUTS.NBIN_REDSHIFT ;
+  if ( NKCOR == 0 ) { NZBIN_MAX = 1 ; }
+
+  for ( i_epoch = 1+WORK->ITHREAD; i_epoch <= SNSED.NEPOCH; 
+	i_epoch += NTHREAD ) {
+
+    epoch  = SNSED.EPOCH[i_epoch];  
+    iepoch = index_epoch ( epoch ) ;  
+
+    // mag weight (filter independent) and MW extinction vs. lambda
+    for ( ilam=1; ilam <= NBIN; ilam++ ) {
+      magflux_info( 1, 1, ilam, iepoch, 
+		    &lam, &ftmp, &WORK->WFLUX[ilam], &wfilt ) ;
+      for ( i_ebv=0; i_ebv <= MXMWEBV; i_ebv++ ) {
+	mwav = INPUTS.RV_MWCOLORLAW * MWEBV_LIST[i_ebv] ;
+	tmp  = 0.4 * GALextinct ( RV, mwav, lam, INPUTS.OPT_MWCOLORLAW );
+	WORK->MWXT[i_ebv][ilam] = 1./pow(TEN,tmp) ;
+      }
+    }
+
+    for ( i_av=1;  i_av<=INPUTS.NBIN_AV;   i_av++ ) {
+
+      dum    = (double)(i_av-1) ;
+      av     = INPUTS.AV_MIN + dum * INPUTS.AV_BINSIZE;
+
+      for ( ilam=1; ilam <= NBIN; ilam++ ) {
+	LAM = SNSED.LAMBDA[1][ilam];
+	WORK->FLUX_REST[ilam] = snflux8 ( epoch, LAM, 0.0, av ); 
+      }
+
+      for ( i_z=1;   i_z <= NZBIN_MAX ; i_z++ ) {
+
+	dum   = (double)(i_z-1) ;
+	z     = INPUTS.REDSHIFT_MIN + dum * INPUTS.REDSHIFT_BINSIZE;
+
+	for ( ilam=1; ilam <= NBIN; ilam++ ) {
+	  LAM = SNSED.LAMBDA[1][ilam];
+	  WORK->FLUX_OBS[ilam] = snflux8 ( epoch, LAM, z, av ); 
+	}
+
+	for ( ikcor=1; ikcor <= NKCOR + NKCOR_EXTRA ; ikcor++ ) {
+
+	  if ( ikcor <= NKCOR ) 
+	    { NZBIN = INPUTS.NBIN_REDSHIFT; }
+	  else
+	    { NZBIN = 1; }
+	  if ( i_z > NZBIN ) { continue ; }
+
+	  ifilt_rest = KCOR_SNGRID.IFILT_REST[ikcor] ;
+	  ifilt_obs  = KCOR_SNGRID.IFILT_OBS[ikcor] ;
+
+	  R4KCOR_GRID.REDSHIFT[ikcor][i_av][i_z][i_epoch]  = (float)z ;
+	  R4KCOR_GRID.EPOCH[ikcor][i_av][i_z][i_epoch]     = (float)epoch ;
+
+	  // check if these obs mags have already been computed
+	  if ( SNSED.R4MAG_OBS[0][ifilt_obs][i_av][i_z][i_epoch] == NULLVAL )
+	    { FLAG_MAGOBS = 1 ; }
+	  else
+	    { FLAG_MAGOBS = 0; }
+
+	  kcor_eval( OPT
+		     ,av, z, epoch
+		     ,ifilt_rest, ifilt_obs 
+		     ,FLAG_MAGOBS
+		     ,WORK
+		     ,&kcor, &err, &ovp, magobs        // return values
+		     );
+
+	  if ( kcor > WORK->KCORMAX[ikcor] ) WORK->KCORMAX[ikcor] = kcor ;
+	  if ( kcor < WORK->KCORMIN[ikcor] ) WORK->KCORMIN[ikcor] = kcor ;
+
+	  // if kcor is outside valid range, then set it to really
+	  // crazy NULLVAL so that sim & fitter know to ignore it
+	  if ( kcor > KCORMAX_VALID ) kcor = NULLVAL ;
+	  if ( kcor < KCORMIN_VALID ) kcor = NULLVAL ;
+
+	  // 6/08/2009: check for nan 
+	  if ( isnan(kcor) ) {
+	    sprintf(WORK->ERRMSG[0],"kcor=%f  for z=%6.3f T=%6.3f  av=%6.3f",
+		    kcor, z, epoch, av);
+	    sprintf(WORK->ERRMSG[1],
+		    "ifilt_[rest,obs]=%d,%d (%s,%s) FLAG_MAGOBS=%d"
+		    ,ifilt_rest, ifilt_obs
+		    ,FILTER[ifilt_rest].name
+		    ,FILTER[ifilt_obs].name
+		    ,FLAG_MAGOBS);
+	    WORK->NERR++ ;  return(NULL);
+	  }
+
+	  R4KCOR_GRID.VALUE[ikcor][i_av][i_z][i_epoch]    = (float)kcor ;
+
+	  // Feb 2007: store observer mags with array of MW E(B-V)
+	  if ( FLAG_MAGOBS > 0 ) {
+	    for ( i_ebv = 0; i_ebv <= MXMWEBV; i_ebv++ ) {
+	      magtmp = *(magobs + i_ebv);
+	      if ( isnan(magtmp) ) {
+		sprintf(WORK->ERRMSG[0],
+			"magobs=%f for i_ebv=%d z=%6.3f T=%6.2f",
+			magtmp, i_ebv, z, epoch );
+		sprintf(WORK->ERRMSG[1],"ifilt_[rest,obs]=%d,%d", 
+			ifilt_rest, ifilt_obs);
+		WORK->NERR++ ;  return(NULL);
 	      }
-	      // store d(mag)/d(xtmw) based on first two bins
-	      dxt   = *(magobs + 1) - *(magobs + 0) ;
-	      debv = MWEBV_LIST[1] -  MWEBV_LIST[0]  ;
-	      SNSED.MW_dXT_dEBV[ifilt_obs][i_av][i_z][i_epoch] = 
-		(dxt/debv);
+
+	      SNSED.R4MAG_OBS[i_ebv][ifilt_obs][i_av][i_z][i_epoch] = 
+		(float)magtmp;
 	    }
-	    
+	    // store d(mag)/d(xtmw) based on first two bins
+	    dxt   = *(magobs + 1) - *(magobs + 0) ;
+	    debv = MWEBV_LIST[1] -  MWEBV_LIST[0]  ;
+	    SNSED.MW_dXT_dEBV[ifilt_obs][i_av][i_z][i_epoch] = 
+	      (dxt/debv);
+	  }
 
-	  } // end of i_epoch loop 
-	}  // end of i_z loop 
-      }   // end if i_av loop
+	} // end of ikcor loop
+      }  // end of i_z loop 
+    }   // end if i_av loop
+  }  // end of i_epoch loop 
 
-      printf(" \n\t %s min/max = %6.3f/%6.3f \n", 
-	     KCORSYM[ikcor], kcormin, kcormax);
+  free(WORK->FLUX_REST);  free(WORK->FLUX_OBS);  free(WORK->WFLUX);
+  for ( i_ebv = 0; i_ebv <= MXMWEBV; i_ebv++ ) { free(WORK->MWXT[i_ebv]); }
 
-   }     // end of ikcor loop 
-     
-
-   return SUCCESS;
+  return(NULL);
 
+} // end of kcor_grid_thread
 
-} // end of kcor_grid
 
 
 
@@ -3025,6 +3197,7 @@ void kcor_eval(int opt                // (I) K cor option ("E" or "N")
 	       ,int ifilt_rest        // (I) rest filter index
 	       ,int ifilt_obs         // (I) observer filter index
 	       ,int FLAG_MAGOBS       // (I) non-zer => compute *mag_obs
+	       ,KCOR_WORK_DEF *WORK   // (I) SN flux & MW ext on lambda grid
 	       ,double *kcor_value   // (O) K correction value
 	       ,double *kcor_error   // (O) error on above
 	       ,double *overlap      // (O) rest-observer flux overlap
@@ -3059,20 +3232,22 @@ void kcor_eval(int opt                // (I) K cor option ("E" or "N")
 
   Jun 9, 2009: all floats -> double
 
+  Oct 2026: use SN flux, MW extinction and mag weights pre-computed
+            on the SN lambda grid (WORK), and filter transmission from
+            KCOR_SNGRID. Only filter_trans8 for the redshifted overlap
+            is still interpolated here. Thread safe.
+
  ***/
 
   int   
     ilam_sn
-    ,NBIN
-    ,iepoch
+    ,ILAM0, ILAM1
     ,iebv
     ;
 
    double 
      LAM
-     , LAMMIN_FILT
-     , LAMMAX_FILT
-     , lam              // lambda (A)
+     , *TRANS_REST, *TRANS_OBS
      , flux_sn_rest   // SN flux, rest
      , flux_sn_obs    // SN flux in redshifted frame
      , trans_rest     // filter transmission, rest frame filter 
@@ -3092,14 +3267,11 @@ void kcor_eval(int opt                // (I) K cor option ("E" or "N")
      , tmp, arg
      , flux
      , flux_obs[MXMWEBV+1]
-     , ftmp, fcount
-     , wflux, wfilt
-     , mwav, mwxt
+     , fcount
+     , wflux, mwxt
      , kcortmp
      , LAMZ
-     , RV
      , zero = 0.0
-     , ten = 10.0
      ;
 
    /* ------------------ BEGIN ------------------- */
@@ -3117,12 +3289,8 @@ void kcor_eval(int opt                // (I) K cor option ("E" or "N")
 
    if ( INPUTS.FASTDEBUG ) { return ; }
 
-   RV = INPUTS.RV_MWCOLORLAW ;
    oneplusz   = ( 1.0 + redshift ) ;
 
-   // get integer epoch index from "epoch" in days.
-   iepoch  =  index_epoch ( epoch ) ;  
-
    // retrieve integrals of Filter-response
 
    filtsum_rest = FILTER[ifilt_rest].SSUM_SN ;
@@ -3135,27 +3303,23 @@ void kcor_eval(int opt                // (I) K cor option ("E" or "N")
    zp_obs  = FILTER[ifilt_obs].MAGFILTER_ZP +
              FILTER[ifilt_obs].MAGSYSTEM_OFFSET ; 
 
-   NBIN    =  SNSED.NBIN_LAMBDA; // number of lambda bins
-
    /************************************************
          compute SNSED * FILTER(rest) * LAMBDA
    ************************************************/ 
 
-   LAMMIN_FILT = FILTER[ifilt_rest].LAMBDA_MIN ;
-   LAMMAX_FILT = FILTER[ifilt_rest].LAMBDA_MAX ;
+   ILAM0      = KCOR_SNGRID.ILAM_RANGE[ifilt_rest][0] ;
+   ILAM1      = KCOR_SNGRID.ILAM_RANGE[ifilt_rest][1] ;
+   TRANS_REST = KCOR_SNGRID.TRANS[ifilt_rest] ;
    conv_sn_rest   = 0.0 ;
    conv_sn_ovp    = 0.0 ;
 
-   for ( ilam_sn=1; ilam_sn <= NBIN; ilam_sn++ ) {
+   for ( ilam_sn=ILAM0; ilam_sn <= ILAM1; ilam_sn++ ) {
 
      LAM    = SNSED.LAMBDA[1][ilam_sn]; // get lambda from epoch=1
-
-     if ( LAM >= LAMMIN_FILT && LAM <= LAMMAX_FILT ) {
-
-       trans_rest  = filter_trans8 ( LAM, ifilt_rest, 0 );
+     trans_rest  = TRANS_REST[ilam_sn] ;
      
 	if ( trans_rest > 0.0 ) {
-	  flux_sn_rest  = snflux8 ( epoch, LAM, zero, av );   // flux at z=0 
+	  flux_sn_rest  = WORK->FLUX_REST[ilam_sn] ;   // flux at z=0 
 	  conv_sn_rest += flux_sn_rest * trans_rest * LAM ;
 
 	  // June 6, 2008 compute overlap function
@@ -3171,7 +3335,6 @@ void kcor_eval(int opt                // (I) K cor option ("E" or "N")
 
 	}  // end positive trans if-block
 
-     }    // LAMMIN,MAX if-check
    }   // end of ilam loop
 
 
@@ -3183,23 +3346,21 @@ void kcor_eval(int opt                // (I) K cor option ("E" or "N")
 
    **********************************************************/ 
 
-   LAMMIN_FILT  =  FILTER[ifilt_obs].LAMBDA_MIN ;
-   LAMMAX_FILT  =  FILTER[ifilt_obs].LAMBDA_MAX ;
+   ILAM0      = KCOR_SNGRID.ILAM_RANGE[ifilt_obs][0] ;
+   ILAM1      = KCOR_SNGRID.ILAM_RANGE[ifilt_obs][1] ;
+   TRANS_OBS  = KCOR_SNGRID.TRANS[ifilt_obs] ;
    conv_sn_obs = 0.0 ;
 
 
-   for ( ilam_sn=1; ilam_sn <= NBIN; ilam_sn++ ) {
+   for ( ilam_sn=ILAM0; ilam_sn <= ILAM1; ilam_sn++ ) {
 
      LAM        = SNSED.LAMBDA[1][ilam_sn];
-
-     if ( LAM >= LAMMIN_FILT && LAM <= LAMMAX_FILT ) {
-
-       trans_obs   = filter_trans8 ( LAM, ifilt_obs, 0 ); // filter trans
+     trans_obs  = TRANS_OBS[ilam_sn] ; // filter trans
 
        if ( trans_obs > 0.0 ) {
 
 	 // get redshifted flux needed for K-cor
-	 flux_sn_obs  = snflux8 ( epoch, LAM, redshift, av ); 
+	 flux_sn_obs  = WORK->FLUX_OBS[ilam_sn] ; 
 	 conv_sn_obs += flux_sn_obs * trans_obs * LAM ;
 
 	 if ( flux_sn_obs == NULLVAL ) { return ; }
@@ -3211,22 +3372,17 @@ void kcor_eval(int opt                // (I) K cor option ("E" or "N")
 	 // get observed "flux"
 	 flux_converter( LAM, flux_sn_obs, &flux, &fcount ); 
 
-	 // get integration weight "wflux" for this filter
-	 magflux_info( 1, ifilt_obs, ilam_sn, iepoch, 
-		       &lam, &ftmp, &wflux, &wfilt ) ;
+	 // get integration weight "wflux" for this epoch
+	 wflux = WORK->WFLUX[ilam_sn] ;
 
 	 for ( iebv=0; iebv <= MXMWEBV; iebv++ ) {
-	   mwav = INPUTS.RV_MWCOLORLAW * MWEBV_LIST[iebv] ;
-	   tmp  = 0.4 * GALextinct ( RV, mwav, lam, INPUTS.OPT_MWCOLORLAW );
-	   mwxt = 1./pow(ten,tmp) ;
+	   mwxt = WORK->MWXT[iebv][ilam_sn] ;
 	   flux_obs[iebv]  += mwxt * wflux * flux * trans_obs  ; 
 	   flux_obs[iebv]  += 0.1E-8;
 	 }
 
        }
 
-     }  // end of LAM if-block
-
    } // end of ilam_sn loop 
 
 
@@ -130,6 +130,8 @@ struct INPUTS {
 
   int NLAMBIN_FT; // Number of Fourier Transform bins (must be power of 2)
 
+  int NTHREAD ;   // number of threads for K-cor grid (Oct 2026)
+
 } INPUTS ;
 
 
@@ -325,6 +327,25 @@ struct R4KCOR_GRID {
 } R4KCOR_GRID ;
 
 
+// Oct 2026: filter trans on SN lambda grid, and per-thread work space
+struct KCOR_SNGRID {
+  double *TRANS[MXFILTDEF];          // filter trans at SNSED.LAMBDA[1][ilam]
+  int     ILAM_RANGE[MXFILTDEF][2];  // SN lambda-bin range inside filter
+  int     IFILT_REST[MXKCOR], IFILT_OBS[MXKCOR]; // filters for each ikcor
+} KCOR_SNGRID ;
+
+typedef struct {
+  int     ITHREAD ;
+  double *FLUX_REST ;          // SN flux at z=0 vs. ilam
+  double *FLUX_OBS ;           // SN flux at z vs. ilam
+  double *WFLUX ;              // mag weight vs. ilam (see magflux_info)
+  double *MWXT[MXMWEBV+1] ;    // MW transmission vs. ilam
+  double  KCORMIN[MXKCOR], KCORMAX[MXKCOR] ;
+  int     NERR ;
+  char    ERRMSG[2][200] ;
+} KCOR_WORK_DEF ;
+
+
 // K cor list applies to the grid and to the lightcurve list
 int  NKCOR;                    // (I) No. K correction matrices to make 
 char KCORLIST[MXKCOR][2][40];  // list of K cor filters (40 char/filter) 
@@ -416,11 +437,14 @@ double primaryflux8 ( int iprim, double lambda );
 void kcor_eval ( int iopt
 		 ,double av, double redshift, double epoch
 		 ,int ifilt_rest, int ifilt_obs
-		 ,int FLAG_MAGOBS
+		 ,int FLAG_MAGOBS, KCOR_WORK_DEF *WORK
 		 ,double *kcor_value, double *kcor_error
 		 ,double *overlap, double *flux_obs
                         ) ;
 
+void  init_kcor_SNGRID(void);
+void *kcor_grid_thread(void *arg);
+
 // convert  epoch (days) to integer index
 int  index_epoch ( double epoch );
 
@@ -459,6 +459,13 @@ int main(int argc,char* argv[])
   
   npoints = npt;
   if(debug>=1) printf("Read in %6i data points %6.3f < z < %6.3f \n",npoints,zlim_mn,zlim_mx);
+
+  // Oct 2026: size DLTAB z-grid (see cosmodl) for the selected data
+  double zmax_tab = 0.0 ;
+  for (i=0;i<npoints;++i) { if (zdata[i]>zmax_tab) zmax_tab = zdata[i]; }
+  zmax_tab += 0.1 ;
+  if ( zmax_tab > ZMAX_SNANA ) zmax_tab = ZMAX_SNANA ;
+  init_DLTAB(zmax_tab, ZBIN_DLTAB);
   if (debug>=1 && use_lowz_sn) printf("First data point is lowz pseudo-data.\n");
   
   // initialise cmb distance prior ...
@@ -1881,7 +1888,12 @@ double cosmodl(double z)
   if(fabs(omega_k)<tol) omega_k = 0.0;
   omega_m = 1.0 - omega_l - omega_k;
   //comoving distance to redshift
-  dflat = rombint(inc,0.0,z,tol);
+  // Oct 2026: use tabulated integral (sntools DLTAB) shared by all SN
+  if ( DLTAB.INIT_FLAG == 0 ) { init_DLTAB(ZMAX_SNANA, ZBIN_DLTAB); }
+  if ( z < DLTAB.ZMAX ) 
+    { dflat = chi_DLTAB(get_DLTAB(omega_m,omega_l,wde,wa), z); }
+  else
+    { dflat = rombint(inc,0.0,z,tol); }
   //  printf("z %f dflat %f \n",z,dflat);
 
   if(omega_k==0.0) dist = cvel*(1.0/H0)*dflat;
@@ -40,6 +40,11 @@
 #include <gsl/gsl_sort.h>
 
 #include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <errno.h>
 
 #include "fitsio.h"
 #include "sntools.h"
@@ -72,7 +77,7 @@
 // ******************************************
 int main(int argc, char **argv) {
 
-  int ilc, istat, i, isp, ifilt ;
+  int ilc, istat, i, isp, ifilt, ILC_MIN, ILC_MAX ;
 
   // define local structures
   SIMFILE_AUX_DEF  SIMFILE_AUX ;
@@ -113,6 +118,9 @@ int main(int argc, char **argv) {
   // check for random CID option (after randoms are inited above)
   init_CIDRAN();
 
+  // independent randoms for each --shard job (after CIDRAN list)
+  init_SIMSHARD_randoms();
+
   // init based on GENSOURCE
   if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENRANDOM ) {
     init_RANDOMsource();
@@ -189,6 +197,9 @@ int main(int argc, char **argv) {
     init_SEARCHEFF(GENLC.SURVEY_NAME,INPUTS.APPLY_SEARCHEFF_OPT); 
   } 
  
+  // optional in-memory SIMLIB cache (after init_kcor & init_genSpec)
+  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENRANDOM ) { init_SIMLIB_CACHE(); }
+
   // create/init output sim-files
   init_simFiles(&SIMFILE_AUX);
 
@@ -208,12 +219,24 @@ int main(int argc, char **argv) {
   if ( INPUTS.INIT_ONLY ==2 ) { debugexit("main: QUIT AFTER FULL INIT"); }
 
   // =================================================
-  // start main loop over "ilc"
+  // start main loop over "ilc" (or --shard range)
+
+  get_SIMSHARD_ILCRANGE(&ILC_MIN, &ILC_MAX);
+
+  // check option to fork NTHREAD_GEN workers that share the init above;
+  // parent writes the events from the workers in ilc order.
+  if ( INPUTS.NTHREAD_GEN > 1 ) {
+    if ( fork_SIMTHREAD() == 0 ) 
+      { write_SIMTHREAD(&SIMFILE_AUX);  goto ENDLOOP ; }
+  }
 
+  init_SIMTIME();
 
-  for ( ilc = 1; ilc <= INPUTS.NGEN ; ilc++ ) {
+  for ( ilc = ILC_MIN; ilc <= ILC_MAX ; ilc++ ) {
 
     NGENLC_TOT++;
+    set_SIMTHREAD_OWNER(ilc);
+    start_SIMTIME_event();
 
     if ( INPUTS.TRACE_MAIN  ) { dmp_trace_main("01", ilc) ; }
 
@@ -223,10 +246,14 @@ int main(int argc, char **argv) {
 
     if ( INPUTS.TRACE_MAIN  ) { dmp_trace_main("02", ilc) ; }
 
-    if ( GENLC.IFLAG_GENSOURCE != IFLAG_GENGRID ) 
-      { init_RANLIST(); }      // init list of random numbers for each SN    
+    if ( GENLC.IFLAG_GENSOURCE != IFLAG_GENGRID ) { 
+      init_RANLIST();      // init list of random numbers for each SN    
+      if ( INPUTS.RANDOM_COUNTER ) { set_simRandoms_key(ilc); }
+    }
 
+    start_SIMTIME_stage(ISTAGE_SIMTIME_EVENT);
     gen_event_driver(ilc);   
+    end_SIMTIME_stage(ISTAGE_SIMTIME_EVENT);
 
     if ( GENLC.NEPOCH < INPUTS.CUTWIN_NEPOCH[0] ) {   // avoid NEPOCH=0
       gen_event_reject(&ilc, &SIMFILE_AUX, "NEPOCH");
@@ -251,7 +278,7 @@ int main(int argc, char **argv) {
     // Quit if we get negative LIBID;
     // mainly to stop reading fakes at end of file.
 
-    if ( GENLC.SIMLIB_ID < 0 ) { continue ; }
+    if ( GENLC.SIMLIB_ID < 0 ) { end_SIMTHREAD_ilc(ilc);  continue ; }
 
     if ( INPUTS.TRACE_MAIN ) { dmp_trace_main("05", ilc) ;  }
 
@@ -261,6 +288,9 @@ int main(int argc, char **argv) {
       goto GENEFF;
     }
 
+    // NTHREAD_GEN worker generates the rest only for its own ilc
+    if ( !SIMTHREAD.OWNER ) { goto GENEFF; }
+
     if ( INPUTS.TRACE_MAIN ) { dmp_trace_main("06", ilc) ; }
 
   GETMAGS:
@@ -279,7 +309,9 @@ int main(int argc, char **argv) {
 
 
     if ( INPUTS.TRACE_MAIN ) { dmp_trace_main("07", ilc) ; }
+    start_SIMTIME_stage(ISTAGE_SIMTIME_GENMAG);
     GENMAG_DRIVER();   // July 2016
+    end_SIMTIME_stage(ISTAGE_SIMTIME_GENMAG);
 
     if ( GENMAG_CUT() == 0  ) {
       gen_event_reject(&ilc, &SIMFILE_AUX, "GENMAG");
@@ -291,13 +323,17 @@ int main(int argc, char **argv) {
     // generate spectra before broadband fluxes in case TEXPOSE
     // is computed from requested SNR; TEXPOSE is then used for
     // synthetic bands.
+    start_SIMTIME_stage(ISTAGE_SIMTIME_GENSPEC);
     GENSPEC_DRIVER(); 
+    end_SIMTIME_stage(ISTAGE_SIMTIME_GENSPEC);
 
 
     if ( INPUTS.TRACE_MAIN ) { dmp_trace_main("09", ilc) ; }
 
     // convert generated mags into observed fluxes
+    start_SIMTIME_stage(ISTAGE_SIMTIME_GENFLUX);
     GENFLUX_DRIVER();  // July 2016
+    end_SIMTIME_stage(ISTAGE_SIMTIME_GENFLUX);
 
     if ( INPUTS.TRACE_MAIN ) { dmp_trace_main("10", ilc) ; }
 
@@ -314,12 +350,14 @@ int main(int argc, char **argv) {
     // check if search finds this SN:
     GENLC.SEARCHEFF_MASK = 3 ;
     if ( GENLC.IFLAG_GENSOURCE != IFLAG_GENGRID  ) {
+      start_SIMTIME_stage(ISTAGE_SIMTIME_SEARCHEFF);
       LOAD_SEARCHEFF_DATA();
       GENLC.SEARCHEFF_MASK = 
 	gen_SEARCHEFF(GENLC.CID                 // (I) ID for dump/abort
 		      ,&GENLC.SEARCHEFF_SPEC     // (O)
 		      ,&GENLC.SEARCHEFF_zHOST    // (O) Mar 2018
 		      ,&GENLC.MJD_TRIGGER ) ;    // (O)
+      end_SIMTIME_stage(ISTAGE_SIMTIME_SEARCHEFF);
     }
 
     for ( i=1; i<=NLIST_RAN; i++ )  { RANLAST[i] = FlatRan1(i); }
@@ -359,9 +397,12 @@ int main(int argc, char **argv) {
     if ( INPUTS.TRACE_MAIN ) { dmp_trace_main("13", ilc) ; }
 
     // update SNDATA files & auxiliary files
+    start_SIMTIME_stage(ISTAGE_SIMTIME_WRITE);
     update_simFiles(&SIMFILE_AUX);
+    end_SIMTIME_stage(ISTAGE_SIMTIME_WRITE);
 
     GENLC.ACCEPTFLAG = 1 ;  // Added Dec 2015
+    end_SIMTIME_event("ACCEPT");
 
     if ( INPUTS.TRACE_MAIN ) { dmp_trace_main("14", ilc) ; }
 
@@ -370,6 +411,7 @@ int main(int argc, char **argv) {
     if ( INPUTS.NGENTOT_LC > 0 ) { screen_update(); }
 
     GENLC.STOPGEN_FLAG = geneff_calc();  // calc generation effic & error  
+    end_SIMTHREAD_ilc(ilc);
     if ( GENLC.STOPGEN_FLAG == 1 )  { goto ENDLOOP; }
     
     fflush(stdout);
@@ -379,6 +421,9 @@ int main(int argc, char **argv) {
 
  ENDLOOP:
 
+  // NTHREAD_GEN worker sends summary to parent and exits
+  if ( SIMTHREAD.ITHREAD > 0 ) { end_SIMTHREAD_worker(); }
+
   t_end = time(NULL);
 
   // print final statistics on generated lightcurves.
@@ -405,6 +450,9 @@ void parse_commandLine_simargs(int argc, char **argv) {
 
   printf("   Full command: ");
 
+  SIMSHARD.ISHARD = SIMSHARD.NSHARD = 0 ;
+  SIMSHARD.SUFFIX[0] = 0 ;
+
   if ( argc >= 2 ) {
     sprintf(inFile, "%s", argv[1] );
     NARGV_LIST = argc ;
@@ -416,6 +464,11 @@ void parse_commandLine_simargs(int argc, char **argv) {
     }
     USE_ARGV_LIST[0] = 1;  // program name
     USE_ARGV_LIST[1] = 1;  // input file
+
+    // Oct 2026: check for --shard ISHARD/NSHARD
+    for ( i = 2; i < NARGV_LIST ; i++ ) {
+      if ( strcmp(ARGV_LIST[i],"--shard") == 0 ) { parse_SIMSHARD_arg(i); }
+    }
   }
   else
     { sprintf(inFile, "snlc_sim.input" ); } // default name
@@ -454,6 +507,10 @@ void simEnd(SIMFILE_AUX_DEF *SIMFILE_AUX) {
 
   end_simFiles(SIMFILE_AUX);
 
+  // per-stage timing (Oct 2026)
+  print_SIMTIME();
+  wr_SIMTIME_TABLE(SIMFILE_AUX->TIMING);
+
   //end_skewNormal();  // Sep 2016
 
   if ( NAVWARP_OVERFLOW[0] > 0 ) 
@@ -625,6 +682,7 @@ void set_user_defaults(void) {
 
   INPUTS.ISEED      = 1 ;
   INPUTS.RANLIST_START_GENSMEAR = 1 ;
+  INPUTS.RANDOM_COUNTER = 0 ;
 
   INPUTS.NGEN_SCALE         =  1.0 ;
   INPUTS.NGEN_SCALE_NON1A   =  1.0 ;
@@ -640,6 +698,13 @@ void set_user_defaults(void) {
   INPUTS.CIDRAN_MIN = 0 ;
   INPUTS.JOBID      = 0;         // for batch only
   INPUTS.NJOBTOT    = 0;         // for batch only
+  INPUTS.NTHREAD_GEN = 1 ;       // 1 => no forked workers
+  INPUTS.USE_SIMTIME = 1 ;       // time each stage of generation loop
+
+  SIMTHREAD.NTHREAD   = 1 ;
+  SIMTHREAD.ITHREAD   = 0 ;
+  SIMTHREAD.OWNER     = 1 ;
+  SIMTHREAD.REPLAY    = 0 ;
   INPUTS.NSUBSAMPLE_MARK = 0 ;
 
   INPUTS.OMEGA_MATTER  =  0.3 ;
@@ -681,6 +746,9 @@ void set_user_defaults(void) {
   INPUTS_SEDMODEL.OPTMASK_T0SHIFT_EXPLODE  = -9   ;
   INPUTS_SEDMODEL.UVLAM_EXTRAPFLUX         = -9.0 ;
   INPUTS_SEDMODEL.MINSLOPE_EXTRAPMAG_LATE  = 0.0 ;
+  INPUTS_SEDMODEL.SALT2_FLUXTABLE_PRECISION = 0.0 ; // 0 -> no table
+  sprintf(INPUTS_SEDMODEL.SALT2_FLUXTABLE_PATH, "NONE" );
+  INPUTS_SEDMODEL.OPT_INTERP_COEFF = 0 ; 
   
   INPUTS.OPT_SETPKMJD      = OPTMASK_SETPKMJD_FLUXMAX2; // May 2019
   INPUTS.MJDWIN_SETPKMJD   = 60.0;  // for default Fmax-clump method
@@ -764,6 +832,7 @@ void set_user_defaults(void) {
   INPUTS.NPAR_SIMSED_MODEL    = 0;
 
   INPUTS.USE_BINARY_SIMSED   = 1; // default is to use binary files
+  INPUTS.NSED_LAZY_SIMSED    = 0; // default is to load all SEDs at init
   sprintf(INPUTS.PATH_BINARY_SIMSED,"%s", ".");
 
   INPUTS.IPAR_SIMSED_SHAPE = -9 ;
@@ -926,6 +995,8 @@ void set_user_defaults(void) {
   INPUTS.SIMLIB_IDLOCK   = -9 ;
   INPUTS.SIMLIB_MINOBS   =  1 ; 
   INPUTS.SIMLIB_DUMP     = -9 ;
+  INPUTS.SIMLIB_MKBIN[0] = 0 ;
+  INPUTS.SIMLIB_CACHE    = 0.0 ;
   INPUTS.SIMLIB_NSKIPMJD =  0 ;
   INPUTS.SIMLIB_NREPEAT  =  1 ;
   INPUTS.NSKIP_SIMLIB    =  0 ;
@@ -944,6 +1015,7 @@ void set_user_defaults(void) {
 
   sprintf(INPUTS.HOSTLIB_FILE,          "NONE" );  // input library
   sprintf(INPUTS.HOSTLIB_WGTMAP_FILE,   "NONE" );  // optional wgtmap
+  sprintf(INPUTS.HOSTLIB_CACHE_DIR,     "NONE" );  // optional binary cache
   sprintf(INPUTS.HOSTLIB_ZPHOTEFF_FILE, "NONE" );  // optional zphot-eff
   INPUTS.HOSTLIB_STOREPAR_LIST[0] = 0 ; // optional vars -> outfile
 
@@ -1311,6 +1383,9 @@ int read_input(char *input_file) {
 
     if ( uniqueMatch(c_get,"HOSTLIB_WGTMAP_FILE:")  )
       {  readchar ( fp, INPUTS.HOSTLIB_WGTMAP_FILE ); continue ; }
+
+    if ( uniqueMatch(c_get,"HOSTLIB_CACHE_DIR:")  )
+      {  readchar ( fp, INPUTS.HOSTLIB_CACHE_DIR ); continue ; }
     
 
     if ( uniqueMatch(c_get,"HOSTLIB_ZPHOTEFF_FILE:")  )
@@ -1499,6 +1574,12 @@ int read_input(char *input_file) {
     
     if ( uniqueMatch(c_get,"SIMLIB_DUMP:")  ) 
       { readint ( fp, 1, &INPUTS.SIMLIB_DUMP ); continue ; }
+
+    if ( uniqueMatch(c_get,"SIMLIB_MKBIN:")  ) 
+      { readchar ( fp, INPUTS.SIMLIB_MKBIN ); continue ; }
+
+    if ( uniqueMatch(c_get,"SIMLIB_CACHE:")  ) 
+      { readdouble ( fp, 1, &INPUTS.SIMLIB_CACHE ); continue ; }
     
     if ( uniqueMatch(c_get,"SIMLIB_NREPEAT:")  ) 
       { readint ( fp, 1, &INPUTS.SIMLIB_NREPEAT );  continue ; }
@@ -1569,6 +1650,12 @@ int read_input(char *input_file) {
     if ( uniqueMatch(c_get,"CIDRAN_MIN:")  ) 
       { readint ( fp, 1, &INPUTS.CIDRAN_MIN ); continue ; }    
 
+    if ( uniqueMatch(c_get,"NTHREAD_GEN:")  ) 
+      { readint ( fp, 1, &INPUTS.NTHREAD_GEN ); continue ; }
+
+    if ( uniqueMatch(c_get,"SIMTIME:")  ) 
+      { readint ( fp, 1, &INPUTS.USE_SIMTIME ); continue ; }
+
     if ( uniqueMatch(c_get,"FORMAT_MASK:")  ) 
       { readint ( fp, 1, &INPUTS.FORMAT_MASK ); continue ; }
     
@@ -1771,6 +1858,19 @@ int read_input(char *input_file) {
       readdouble(fp, 1, &INPUTS_SEDMODEL.MINSLOPE_EXTRAPMAG_LATE); 
       continue ; 
     }
+
+    if ( uniqueMatch(c_get,"SALT2_FLUXTABLE_PRECISION:")  )  {
+      readdouble(fp, 1, &INPUTS_SEDMODEL.SALT2_FLUXTABLE_PRECISION); 
+      continue ; 
+    }
+    if ( uniqueMatch(c_get,"SALT2_FLUXTABLE_PATH:")  )  {
+      readchar(fp, INPUTS_SEDMODEL.SALT2_FLUXTABLE_PATH); 
+      continue ; 
+    }
+    if ( uniqueMatch(c_get,"SEDMODEL_OPT_INTERP_COEFF:")  )  {
+      readint(fp, 1, &INPUTS_SEDMODEL.OPT_INTERP_COEFF); 
+      continue ; 
+    }
     
     if ( uniqueMatch(c_get,"RANSEED:")  ) { 
       readint ( fp, 1, &ITMP ); // read regular int
@@ -1787,6 +1887,9 @@ int read_input(char *input_file) {
     if ( uniqueMatch(c_get,"RANLIST_START_GENSMEAR:") )
       { readint(fp, 1, &INPUTS.RANLIST_START_GENSMEAR ); continue ; }    
 
+    if ( uniqueMatch(c_get,"RANDOM_COUNTER:") )
+      { readint(fp, 1, &INPUTS.RANDOM_COUNTER ); continue ; }    
+
     if ( uniqueMatch(c_get,"GENRANGE_RA:")  ) 
       { readfloat ( fp, 2, INPUTS.GENRANGE_RA ); continue ; }
     
@@ -3652,6 +3755,9 @@ void read_input_SIMSED(FILE *fp, char *KEY) {
   if ( strcmp(KEY,"SIMSED_USE_BINARY:" ) == 0 )
     { readint ( fp, 1, &INPUTS.USE_BINARY_SIMSED ); return; }
 
+  if ( strcmp(KEY,"SIMSED_LAZY_NSED:" ) == 0 )
+    { readint ( fp, 1, &INPUTS.NSED_LAZY_SIMSED ); return; }
+
   if ( strcmp(KEY,"SIMSED_PATH_BINARY:" ) == 0 )
     { readchar ( fp, INPUTS.PATH_BINARY_SIMSED );  return; }
 
@@ -4262,6 +4368,9 @@ void sim_input_override(void) {
     if ( strcmp( ARGV_LIST[i], "HOSTLIB_WGTMAP_FILE" ) == 0 ) {
       i++ ; sscanf(ARGV_LIST[i] , "%s", INPUTS.HOSTLIB_WGTMAP_FILE ); 
     }
+    if ( strcmp( ARGV_LIST[i], "HOSTLIB_CACHE_DIR" ) == 0 ) {
+      i++ ; sscanf(ARGV_LIST[i] , "%s", INPUTS.HOSTLIB_CACHE_DIR ); 
+    }
     if ( strcmp( ARGV_LIST[i], "HOSTLIB_ZPHOTEFF_FILE" ) == 0 ) {
       i++ ; sscanf(ARGV_LIST[i] , "%s", INPUTS.HOSTLIB_ZPHOTEFF_FILE ); 
     }
@@ -4410,6 +4519,12 @@ void sim_input_override(void) {
     if ( strcmp( ARGV_LIST[i], "SIMLIB_DUMP" ) == 0 ) {
       i++ ; sscanf(ARGV_LIST[i] , "%d", &INPUTS.SIMLIB_DUMP ); 
     }
+    if ( strcmp( ARGV_LIST[i], "SIMLIB_MKBIN" ) == 0 ) {
+      i++ ; sscanf(ARGV_LIST[i] , "%s", INPUTS.SIMLIB_MKBIN ); 
+    }
+    if ( strcmp( ARGV_LIST[i], "SIMLIB_CACHE" ) == 0 ) {
+      i++ ; sscanf(ARGV_LIST[i] , "%le", &INPUTS.SIMLIB_CACHE ); 
+    }
     if ( strcmp( ARGV_LIST[i], "SIMLIB_CADENCEFOM_ANGSEP" ) == 0 ) {
       i++ ; sscanf(ARGV_LIST[i] , "%f", 
 		   &INPUTS.SIMLIB_CADENCEFOM_ANGSEP ); 
@@ -4552,6 +4667,15 @@ void sim_input_override(void) {
       goto INCREMENT_COUNTER; 
     }
 
+    if ( strcmp( ARGV_LIST[i], "NTHREAD_GEN" ) == 0 ) {
+      i++ ; sscanf(ARGV_LIST[i] , "%d", &INPUTS.NTHREAD_GEN ); 
+      goto INCREMENT_COUNTER; 
+    }
+    if ( strcmp( ARGV_LIST[i], "SIMTIME" ) == 0 ) {
+      i++ ; sscanf(ARGV_LIST[i] , "%d", &INPUTS.USE_SIMTIME ); 
+      goto INCREMENT_COUNTER; 
+    }
+
     if ( strcmp( ARGV_LIST[i], "GENVERSION" ) == 0 ) {
       i++ ; sscanf(ARGV_LIST[i] , "%s", INPUTS.GENVERSION ); 
       sprintf(INPUTS.GENPREFIX,"%s", INPUTS.GENVERSION);
@@ -4665,6 +4789,21 @@ void sim_input_override(void) {
 		   &INPUTS_SEDMODEL.MINSLOPE_EXTRAPMAG_LATE );
       goto INCREMENT_COUNTER; 
     }
+    if ( strcmp( ARGV_LIST[i], "SALT2_FLUXTABLE_PRECISION" ) == 0 ) {
+      i++ ; sscanf(ARGV_LIST[i] , "%le",
+		   &INPUTS_SEDMODEL.SALT2_FLUXTABLE_PRECISION );
+      goto INCREMENT_COUNTER; 
+    }
+    if ( strcmp( ARGV_LIST[i], "SALT2_FLUXTABLE_PATH" ) == 0 ) {
+      i++ ; sscanf(ARGV_LIST[i] , "%s", 
+		   INPUTS_SEDMODEL.SALT2_FLUXTABLE_PATH );
+      goto INCREMENT_COUNTER; 
+    }
+    if ( strcmp( ARGV_LIST[i], "SEDMODEL_OPT_INTERP_COEFF" ) == 0 ) {
+      i++ ; sscanf(ARGV_LIST[i] , "%d", 
+		   &INPUTS_SEDMODEL.OPT_INTERP_COEFF );
+      goto INCREMENT_COUNTER; 
+    }
 
     if ( strcmp( ARGV_LIST[i], "RANSEED" ) == 0 )  { 
       i++ ; sscanf(ARGV_LIST[i] , "%d", &INPUTS.ISEED );  
@@ -4675,6 +4814,10 @@ void sim_input_override(void) {
       i++ ; sscanf(ARGV_LIST[i] , "%d", &INPUTS.RANLIST_START_GENSMEAR ); 
       goto INCREMENT_COUNTER; 
     }
+    if ( strcmp( ARGV_LIST[i], "RANDOM_COUNTER" ) == 0 ) {
+      i++ ; sscanf(ARGV_LIST[i] , "%d", &INPUTS.RANDOM_COUNTER ); 
+      goto INCREMENT_COUNTER; 
+    }
 
     if ( strcmp( ARGV_LIST[i], "GENRANGE_RA" ) == 0 ) {
       i++ ; sscanf(ARGV_LIST[i] , "%f", &INPUTS.GENRANGE_RA[0] ); 
@@ -5366,6 +5509,10 @@ void sim_input_override(void) {
       i++ ; sscanf(ARGV_LIST[i] , "%d", &INPUTS.USE_BINARY_SIMSED );
     }
 
+    if ( strcmp( ARGV_LIST[i], "SIMSED_LAZY_NSED" ) == 0 ) {
+      i++ ; sscanf(ARGV_LIST[i] , "%d", &INPUTS.NSED_LAZY_SIMSED );
+    }
+
     if ( strcmp( ARGV_LIST[i], "SIMSED_PATH_BINARY" ) == 0 ) {
       i++ ; sscanf(ARGV_LIST[i] , "%s", INPUTS.PATH_BINARY_SIMSED );
     }
@@ -5466,8 +5613,12 @@ void prep_user_input(void) {
   // Feb 2015: replace ENV names in inputs
   ENVreplace(INPUTS.KCOR_FILE,fnam,1);  
   ENVreplace(INPUTS.SIMLIB_FILE,fnam,1);
+  if ( strlen(INPUTS.SIMLIB_MKBIN) > 0 ) 
+    { ENVreplace(INPUTS.SIMLIB_MKBIN,fnam,1); }
   ENVreplace(INPUTS.HOSTLIB_FILE,fnam,1);
   ENVreplace(INPUTS.HOSTLIB_WGTMAP_FILE,fnam,1);
+  ENVreplace(INPUTS.HOSTLIB_CACHE_DIR,fnam,1);
+  ENVreplace(INPUTS_SEDMODEL.SALT2_FLUXTABLE_PATH,fnam,1);
   ENVreplace(INPUTS.HOSTLIB_ZPHOTEFF_FILE,fnam,1);
   ENVreplace(INPUTS.FLUXERRMODEL_FILE,fnam,1 );
   ENVreplace(INPUTS.HOSTNOISE_FILE,fnam,1 );
@@ -6164,6 +6315,9 @@ void prep_user_input(void) {
     }
   }
 
+  // check --shard and NTHREAD_GEN options
+  prep_SIMSHARD();
+  prep_SIMTHREAD();
   
   printf("\n");
 
@@ -7526,6 +7680,8 @@ void init_simRandoms(void) {
 
   // Create Sep 2016 by R.Kessler & E.Jennings
   // Move init stuff from main, and check for skewNormal.
+  //
+  // Oct 2026: check RANDOM_COUNTER option
 
   int i;
   int ISEED = INPUTS.ISEED ;
@@ -7533,6 +7689,10 @@ void init_simRandoms(void) {
 
   // ----------- BEGIN ----------------
   srandom(ISEED);
+  if ( INPUTS.RANDOM_COUNTER ) { 
+    init_RANCOUNTER(ISEED); 
+    GENLC.ILC_RANKEY = GENLC.NTRY_RANKEY = 0 ;
+  }
   init_RANLIST(); 
   for ( i=1; i <= NLIST_RAN; i++ )  
     { RANFIRST[i] = FlatRan1(i); }
@@ -7543,6 +7703,25 @@ void init_simRandoms(void) {
 
 } // end init_simRandoms
 
+// ************************************
+void set_simRandoms_key(int ilc) {
+
+  // Created Oct 2026
+  // For RANDOM_COUNTER option, set per-event key for FlatRan1.
+  // Key is ilc plus number of previous tries with the same ilc
+  // (ilc is re-used after a rejected event when NGEN_LC is set),
+  // so that every generated event has a unique key which does
+  // not depend on previous events or on NTHREAD_GEN.
+
+  if ( ilc == GENLC.ILC_RANKEY ) 
+    { GENLC.NTRY_RANKEY++ ; }
+  else 
+    { GENLC.ILC_RANKEY = ilc;  GENLC.NTRY_RANKEY = 0; }
+
+  set_RANCOUNTER_KEY(GENLC.ILC_RANKEY, GENLC.NTRY_RANKEY);
+
+} // end set_simRandoms_key
+
 // ************************************
 void  init_GENLC(void) {
 
@@ -9697,6 +9876,9 @@ void gen_event_reject(int *ILC, SIMFILE_AUX_DEF *SIMFILE_AUX,
   // * do stuff based on REJECT_STAGE
   //
   // Mar 18 2018: add separate category for NEPOCH 
+  // Oct 16 2026: accumulate time of rejected event (SIMTIME)
+  // Oct 16 2026: for NTHREAD_GEN worker that does not own this ilc,
+  //              only keep ilc in sync; owner does the rest.
 
   int ilc_orig, ilc;
   char fnam[] = "gen_event_reject" ;
@@ -9704,7 +9886,14 @@ void gen_event_reject(int *ILC, SIMFILE_AUX_DEF *SIMFILE_AUX,
   // ----------- BEGIN --------------
 
   ilc = ilc_orig = *ILC ;
+
+  if ( !SIMTHREAD.OWNER ) {
+    if ( strcmp(REJECT_STAGE,"GENRANGE") == 0 ) { *ILC = ilc-1 ; }
+    return ;
+  }
+
   FREEHOST_GALID(SNHOSTGAL.IGAL);
+  end_SIMTIME_event(REJECT_STAGE);
 
   if ( strcmp(REJECT_STAGE,"GENRANGE") == 0 ) {
     ilc-- ;
@@ -10834,18 +11023,16 @@ void wr_SIMGEN_DUMP(int OPT_DUMP, SIMFILE_AUX_DEF *SIMFILE_AUX) {
 
   May 14 2019: free(SIMFILE_AUX->OUTLINE)
 
+  Oct 2026: move OUTLINE construction to fill_SIMGEN_DUMP_LINE.
+            NTHREAD_GEN worker sends OUTLINE to parent, which
+            applies the prescale and writes in CID order.
+
   ****/
 
   int   NVAR, ivar, IDSPEC, imjd, index, FIRST ; 
-
-  long long i8, ir8 ;
-  int    i4 ;
-  float  r4 ; 
-  double r8 ;
-  char  *ptrFile, *pvar, *str  ;
+  char  *ptrFile, *pvar ;
 
   FILE *fp ;
-  char cval[40] ;
   char fnam[] = "wr_SIMGEN_DUMP" ;
 
   // --------------- BEGIN ----------
@@ -10874,8 +11061,10 @@ void wr_SIMGEN_DUMP(int OPT_DUMP, SIMFILE_AUX_DEF *SIMFILE_AUX) {
     NVAR = INPUTS.NVAR_SIMGEN_DUMP ; // update NVAR
 
     // allocate memory to hold one line of output
-    // (for faster writing)
-    SIMFILE_AUX->OUTLINE = (char *) malloc( 50 + sizeof(char)*NVAR*20 );
+    // (for faster writing), plus TAKE_SPECTRUM indices that
+    // NTHREAD_GEN worker sends in front of the line.
+    SIMFILE_AUX->OUTLINE = (char *) malloc( 50 + sizeof(char)*NVAR*20 +
+					    sizeof(int)*MXSPEC );
     // open file and write header
     if ( (SIMFILE_AUX->FP_DUMP = fopen(ptrFile, "wt")) == NULL ) {       
       sprintf ( c1err, "Cannot open SIMGEN dump file :" );
@@ -10936,6 +11125,18 @@ void wr_SIMGEN_DUMP(int OPT_DUMP, SIMFILE_AUX_DEF *SIMFILE_AUX) {
 
   if ( OPT_DUMP == 2 ) {
 
+    if ( SIMTHREAD.ITHREAD > 0 ) {
+      // NTHREAD_GEN worker: send TAKE_SPECTRUM indices & line to parent
+      int NSPEC = NPEREVT_TAKE_SPECTRUM ;
+      int LEN   = NSPEC*sizeof(int) ;
+      char *BUF = SIMFILE_AUX->OUTLINE ;
+      memcpy(BUF, GENSPEC.INDEX_TAKE_SPECTRUM, LEN );
+      fill_SIMGEN_DUMP_LINE(&BUF[LEN]);
+      LEN += strlen(&BUF[LEN]) + 1 ;
+      send_SIMTHREAD_packet(ITYPE_SIMTHREAD_DUMP, LEN, BUF);
+      return ;
+    }
+
     FIRST = (NEVT_SIMGEN_DUMP==0 ) ; // used for SPECTROGRAPH info
     NEVT_SIMGEN_DUMP++ ;  XN=(double)NEVT_SIMGEN_DUMP ;
 
@@ -10961,60 +11162,8 @@ void wr_SIMGEN_DUMP(int OPT_DUMP, SIMFILE_AUX_DEF *SIMFILE_AUX) {
     }
 
 
-    sprintf(SIMFILE_AUX->OUTLINE, "SN: " );
-
-    NVAR = INPUTS.NVAR_SIMGEN_DUMP ; // update NVAR
-    for ( ivar=0; ivar < NVAR; ivar++ ) {
-
-      pvar  = INPUTS.VARNAME_SIMGEN_DUMP[ivar] ;
-      index = INDEX_SIMGEN_DUMP[ivar] ;
-
-      if ( index < 0 || index > NVAR_SIMGEN_DUMP ) {
-	sprintf(c1err,"invalid index=%d for var='%s' ivar=%d", 
-		index, pvar, ivar );
-	errmsg(SEV_FATAL, 0, fnam, c1err, "" ); 
-      }
-
-      r4   = *SIMGEN_DUMP[index].PTRVAL4 ;
-      r8   = *SIMGEN_DUMP[index].PTRVAL8 ;
-      i4   = *SIMGEN_DUMP[index].PTRINT4 ;
-      i8   = *SIMGEN_DUMP[index].PTRINT8 ;
-      str  =  SIMGEN_DUMP[index].PTRCHAR ;  // 7.30.2014
-      
-      if ( r4 != SIMGEN_DUMMY.VAL4 )  
-	{ sprintf(cval," %.5le",  r4 ); }
-
-      else if ( r8 != SIMGEN_DUMMY.VAL8 )  { 
-	ir8 = (long long)r8 ;
-
-	if ( strstr(pvar,"MJD") != NULL ) 
-	  {  sprintf(cval," %.3f", r8 ); }
-	else if ( strstr(pvar,"RA") != NULL ) 
-	  {  sprintf(cval," %.6f", r8 ); }
-	else if ( strstr(pvar,"DEC") != NULL ) 
-	  {  sprintf(cval," %.6f", r8 ); }
-	else if ( (r8 - ir8) == 0.0 ) // it's really an integer
-	  {  sprintf(cval," %lld", ir8 ); }
-	else
-	  { sprintf(cval," %.5le", r8 );  }
-      }
-      else if ( i4 != SIMGEN_DUMMY.IVAL4 )  
-	{  sprintf(cval," %d",  i4 ); }
-
-      else if ( i8 != SIMGEN_DUMMY.IVAL8 )  
-	{  sprintf(cval," %lld",  i8 ); }
-
-      else if ( strcmp(str,SIMGEN_DUMMY.CVAL) != 0 )
-	{  sprintf(cval," %s",  str ); }   // 7.30.2014
-
-      else {
-	sprintf(c1err,"no value for variable %d (%s)", ivar, pvar);
-	errmsg(SEV_FATAL, 0, fnam, c1err, "" ); 
-      }
-
-      strcat(SIMFILE_AUX->OUTLINE,cval);
-
-    } // end of ivar loop
+    // REPLAY => parent already has OUTLINE from worker
+    if ( !SIMTHREAD.REPLAY ) { fill_SIMGEN_DUMP_LINE(SIMFILE_AUX->OUTLINE); }
 
     fprintf(fp, "%s\n", SIMFILE_AUX->OUTLINE );
     fflush(fp);
@@ -11033,6 +11182,80 @@ void wr_SIMGEN_DUMP(int OPT_DUMP, SIMFILE_AUX_DEF *SIMFILE_AUX) {
 } // end of wr_SIMGEN_DUMP
 
 
+// ******************************************
+void fill_SIMGEN_DUMP_LINE(char *OUTLINE) {
+
+  // Oct 2026: moved from wr_SIMGEN_DUMP.
+  // Fill one SIMGEN_DUMP line for current event.
+
+  int   NVAR, ivar, index ;
+  long long i8, ir8 ;
+  int    i4 ;
+  float  r4 ; 
+  double r8 ;
+  char  *pvar, *str, cval[40] ;
+  char fnam[] = "fill_SIMGEN_DUMP_LINE" ;
+
+  // --------------- BEGIN ----------
+
+  sprintf(OUTLINE, "SN: " );
+
+  NVAR = INPUTS.NVAR_SIMGEN_DUMP ; // update NVAR
+  for ( ivar=0; ivar < NVAR; ivar++ ) {
+
+    pvar  = INPUTS.VARNAME_SIMGEN_DUMP[ivar] ;
+    index = INDEX_SIMGEN_DUMP[ivar] ;
+
+    if ( index < 0 || index > NVAR_SIMGEN_DUMP ) {
+      sprintf(c1err,"invalid index=%d for var='%s' ivar=%d", 
+	      index, pvar, ivar );
+      errmsg(SEV_FATAL, 0, fnam, c1err, "" ); 
+    }
+
+    r4   = *SIMGEN_DUMP[index].PTRVAL4 ;
+    r8   = *SIMGEN_DUMP[index].PTRVAL8 ;
+    i4   = *SIMGEN_DUMP[index].PTRINT4 ;
+    i8   = *SIMGEN_DUMP[index].PTRINT8 ;
+    str  =  SIMGEN_DUMP[index].PTRCHAR ;  // 7.30.2014
+    
+    if ( r4 != SIMGEN_DUMMY.VAL4 )  
+      { sprintf(cval," %.5le",  r4 ); }
+
+    else if ( r8 != SIMGEN_DUMMY.VAL8 )  { 
+      ir8 = (long long)r8 ;
+
+      if ( strstr(pvar,"MJD") != NULL ) 
+        {  sprintf(cval," %.3f", r8 ); }
+      else if ( strstr(pvar,"RA") != NULL ) 
+        {  sprintf(cval," %.6f", r8 ); }
+      else if ( strstr(pvar,"DEC") != NULL ) 
+        {  sprintf(cval," %.6f", r8 ); }
+      else if ( (r8 - ir8) == 0.0 ) // it's really an integer
+        {  sprintf(cval," %lld", ir8 ); }
+      else
+        { sprintf(cval," %.5le", r8 );  }
+    }
+    else if ( i4 != SIMGEN_DUMMY.IVAL4 )  
+      {  sprintf(cval," %d",  i4 ); }
+
+    else if ( i8 != SIMGEN_DUMMY.IVAL8 )  
+      {  sprintf(cval," %lld",  i8 ); }
+
+    else if ( strcmp(str,SIMGEN_DUMMY.CVAL) != 0 )
+      {  sprintf(cval," %s",  str ); }   // 7.30.2014
+
+    else {
+      sprintf(c1err,"no value for variable %d (%s)", ivar, pvar);
+      errmsg(SEV_FATAL, 0, fnam, c1err, "" ); 
+    }
+
+    strcat(OUTLINE,cval);
+
+  } // end of ivar loop
+
+} // end fill_SIMGEN_DUMP_LINE
+
+
 // ******************************************
 int MATCH_INDEX_SIMGEN_DUMP(char *varName ) {
 
@@ -13208,6 +13431,16 @@ void SIMLIB_INIT_DRIVER(void) {
 
   SIMLIB_readGlobalHeader_TEXT();   // open and read global header
 
+  // check option to convert TEXT SIMLIB into binary, then quit
+  if ( strlen(INPUTS.SIMLIB_MKBIN) > 0 ) {
+    SIMLIB_mkBinary(INPUTS.SIMLIB_OPENFILE, INPUTS.SIMLIB_MKBIN);
+    happyend();
+  }
+
+  // binary SIMLIB knows the exact number of LIBIDs
+  if ( SIMLIB_BIN.USE ) 
+    { SIMLIB_GLOBAL_HEADER.NLIBID = SIMLIB_BIN.HEAD->NLIBID ; }
+
   SIMLIB_prepGlobalHeader();        
 
   //  SIMLIB_openLegacy(); // xxx mark delete 
@@ -13272,6 +13505,9 @@ void SIMLIB_readGlobalHeader_TEXT(void) {
   // Re-factored Aug 2017
   // Open SIMLIB file and read global header into
   // SIMLIB_GLOBAL_HEADER structure.
+  //
+  // Oct 2026: for binary SIMLIB, fp_SIMLIB reads global-header
+  //           text from the memory-mapped file.
 
   char PATH_DEFAULT[MXPATHLEN];
   char *OPENFILE = INPUTS.SIMLIB_OPENFILE;
@@ -13284,8 +13520,18 @@ void SIMLIB_readGlobalHeader_TEXT(void) {
   print_banner(fnam);
 
   sprintf(PATH_DEFAULT, "%s/simlib",  PATH_SNDATA_ROOT );
-  fp_SIMLIB = snana_openTextFile(1,PATH_DEFAULT, INPUTS.SIMLIB_FILE, 
-				 OPENFILE, &INPUTS.SIMLIB_GZIPFLAG );
+  SIMLIB_BIN.USE = ISBIN_SIMLIB(INPUTS.SIMLIB_FILE) ;
+  if ( SIMLIB_BIN.USE ) {
+    sprintf(OPENFILE, "%s", INPUTS.SIMLIB_FILE);
+    if ( strchr(OPENFILE,'/') == NULL && access(OPENFILE,F_OK) != 0 ) 
+      { sprintf(OPENFILE, "%s/%s", PATH_DEFAULT, INPUTS.SIMLIB_FILE); }
+    INPUTS.SIMLIB_GZIPFLAG = 0 ;
+    SIMLIB_openBinary(OPENFILE); // sets fp_SIMLIB to global header
+  }
+  else {
+    fp_SIMLIB = snana_openTextFile(1,PATH_DEFAULT, INPUTS.SIMLIB_FILE, 
+				   OPENFILE, &INPUTS.SIMLIB_GZIPFLAG );
+  }
   
   if ( fp_SIMLIB == NULL ) {
     sprintf ( c1err, "Cannot open file SIMLIB_FILE" );
@@ -13762,6 +14008,10 @@ void SIMLIB_findStart(void) {
   if ( IDLOCK      > 0 ) { NOPT++ ; }
   if ( NSKIP_LIBID > 0 ) { NOPT++ ; }
 
+  // remember where SIMLIB_CACHE starts (to convert NSKIP for workers)
+  if ( SIMLIB_CACHE.USE == 0 ) 
+    { SIMLIB_CACHE.NSKIP_START = ( NSKIP_LIBID > 0 ? NSKIP_LIBID : 0 ) ; }
+
   if ( NOPT   == 0 ) { return ; } // do nothing ==> start at first LIBID
 
   if ( NOPT > 1 ) {
@@ -13782,14 +14032,24 @@ void SIMLIB_findStart(void) {
   fflush(stdout);
 
   
-  // skip fixed number of LIBIDs
+  // skip fixed number of LIBIDs; binary SIMLIB and cache jump directly
+  if ( SIMLIB_CACHE.USE ) {
+    SIMLIB_CACHE.ILIBID_NEXT = SIMLIB_findStart_CACHE(NSKIP_LIBID,IDSEEK);
+    NREAD = NSKIP_LIBID ;  IDSEEK = -9 ;
+  }
+  else if ( SIMLIB_BIN.USE && NSKIP_LIBID > 0 ) {
+    SIMLIB_openLIBID_BIN( NSKIP_LIBID % SIMLIB_BIN.HEAD->NLIBID );
+    NREAD = NSKIP_LIBID ;
+  }
   while ( NREAD < NSKIP_LIBID ) {
     fgets(LINE, 40, fp_SIMLIB) ;
     if ( strstr(LINE,"END_LIBID:") != NULL ) { NREAD++; }
   }
   
 
-  // search for specific LIBID
+  // search for specific LIBID; binary SIMLIB uses index to jump
+  if ( SIMLIB_BIN.USE && IDSEEK > 0 ) 
+    { SIMLIB_openLIBID_BIN( SIMLIB_findLIBID_BIN(IDSEEK) ); }
   while ( IDSEEK > SIMLIB_HEADER.LIBID ) {   
     SIMLIB_READ_DRIVER();
     if ( SIMLIB_HEADER.NWRAP > 0 ) {
@@ -14092,7 +14352,12 @@ void SIMLIB_READ_DRIVER(void) {
   GENLC.NGEN_SIMLIB_ID++ ;
   REPEAT = USE_SAME_SIMLIB_ID(2);
 
-  if ( REPEAT == 0 ) {  // process next cadence
+  if ( REPEAT == 0 && SIMLIB_CACHE.USE ) {
+    // restore next cadence that is already sorted and season-split
+    SIMLIB_readNextCadence_CACHE();
+    REPEAT = 2 ;
+  }
+  else if ( REPEAT == 0 ) {  // process next cadence
 
     // read next cadence from SIMLIB/Cadence file (any format)
     SIMLIB_readNextCadence_TEXT(); 
@@ -14138,13 +14403,16 @@ void  SIMLIB_readNextCadence_TEXT(void) {
   //  fix to work properly when LCLIB NREPEAT=0; see NOBS_FOUND_ALL
   //    
   // Jan 3 2018: use parse_SIMLIB_IDplusNEXPOSE() to read IDEXPT & NEXPOSE
+  //
+  // Oct 2026: read tokens with SIMLIB_nextToken, and for binary
+  //           SIMLIB copy S: values from fixed-width records.
 
   int ID, NOBS_EXPECT, NOBS_FOUND, NOBS_FOUND_ALL, ISTORE, ifilt_obs, ifilt;
   int APPEND_PHOTFLAG;
   int NTRY, USEFLAG_LIBID, USEFLAG_MJD, OPTLINE, NWD, NTMP ;
   int   NOBS_SKIP, SKIP_FIELD, SKIP_APPEND, OPTLINE_REJECT  ;
   double PIXSIZE, TEXPOSE_S, MJD ;
-  char c_get[80], ctmp[80], *BAND, *UNIT, cline[200] ;
+  char c_get[80], ctmp[80], *BAND, cline[200] ;
   char *FIELD = SIMLIB_HEADER.FIELD;
   char *TEL   = SIMLIB_HEADER.TELESCOPE ;
   char fnam[] = "SIMLIB_readNextCadence_TEXT" ;
@@ -14176,7 +14444,7 @@ void  SIMLIB_readNextCadence_TEXT(void) {
 
   // - - - - - - - start reading SIMLIB - - - - - - - - - 
 
-  while( (fscanf(fp_SIMLIB, "%s", c_get)) != EOF) {
+  while( SIMLIB_nextToken(c_get) != EOF) {
 
     if ( strcmp(c_get,"END_OF_SIMLIB:") == 0 ) {
 
@@ -14184,8 +14452,11 @@ void  SIMLIB_readNextCadence_TEXT(void) {
       if ( SIMLIB_HEADER.NWRAP >= 5 )  { ENDSIMLIB_check(); }
       
       if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENRANDOM ) {
-	snana_rewind(fp_SIMLIB, INPUTS.SIMLIB_OPENFILE,
-		     INPUTS.SIMLIB_GZIPFLAG);
+	// binary SIMLIB is already back at first LIBID
+	if ( !SIMLIB_BIN.USE ) {
+	  snana_rewind(fp_SIMLIB, INPUTS.SIMLIB_OPENFILE,
+		       INPUTS.SIMLIB_GZIPFLAG);
+	}
 	SIMLIB_HEADER.NWRAP++ ; 
 	SIMLIB_HEADER.LIBID = SIMLIB_ID_REWIND ; 
 	NOBS_FOUND = NOBS_FOUND_ALL = USEFLAG_LIBID = USEFLAG_MJD = 0 ;
@@ -14282,6 +14553,7 @@ void  SIMLIB_readNextCadence_TEXT(void) {
     if ( strcmp(c_get,"S:") == 0 ) {
       NOBS_FOUND_ALL++ ;
       if ( USEFLAG_LIBID == ACCEPT_FLAG ) { OPTLINE = OPTLINE_SIMLIB_S;  }
+      if ( SIMLIB_BIN.USE ) { SIMLIB_BIN.IREC_CUR = SIMLIB_BIN.IREC_NEXT++; }
     }
 
     if ( strcmp(c_get,"SPECTROGRAPH:") == 0 && USEFLAG_LIBID==ACCEPT_FLAG )
@@ -14299,23 +14571,28 @@ void  SIMLIB_readNextCadence_TEXT(void) {
     else if ( OPTLINE == OPTLINE_SIMLIB_S )  { 
       ISTORE = NOBS_FOUND ;
       SIMLIB_OBS_RAW.OPTLINE[ISTORE] = OPTLINE ;
-      readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.MJD[ISTORE] );
-
-      readchar( fp_SIMLIB, ctmp );
-      parse_SIMLIB_IDplusNEXPOSE(ctmp,
-				 &SIMLIB_OBS_RAW.IDEXPT[ISTORE],
-				 &SIMLIB_OBS_RAW.NEXPOSE[ISTORE] );
-
-      readchar   ( fp_SIMLIB,     SIMLIB_OBS_RAW.BAND[ISTORE]     );
-      readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.CCDGAIN[ISTORE]  );
-      readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.READNOISE[ISTORE]);
-      readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.SKYSIG[ISTORE]   );
-      readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.PSFSIG1[ISTORE]  );
-      readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.PSFSIG2[ISTORE]  );
-      readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.PSFRATIO[ISTORE] );
-      readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.ZPTADU[ISTORE]   );  
-      readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.ZPTSIG[ISTORE]   );  
-      readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.MAG[ISTORE]      );
+
+      if ( SIMLIB_BIN.USE ) 
+	{ SIMLIB_copyObs_BIN(ISTORE); }
+      else {
+	readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.MJD[ISTORE] );
+
+	readchar( fp_SIMLIB, ctmp );
+	parse_SIMLIB_IDplusNEXPOSE(ctmp,
+				   &SIMLIB_OBS_RAW.IDEXPT[ISTORE],
+				   &SIMLIB_OBS_RAW.NEXPOSE[ISTORE] );
+
+	readchar   ( fp_SIMLIB,     SIMLIB_OBS_RAW.BAND[ISTORE]     );
+	readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.CCDGAIN[ISTORE]  );
+	readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.READNOISE[ISTORE]);
+	readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.SKYSIG[ISTORE]   );
+	readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.PSFSIG1[ISTORE]  );
+	readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.PSFSIG2[ISTORE]  );
+	readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.PSFRATIO[ISTORE] );
+	readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.ZPTADU[ISTORE]   );  
+	readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.ZPTSIG[ISTORE]   );  
+	readdouble ( fp_SIMLIB, 1, &SIMLIB_OBS_RAW.MAG[ISTORE]      );
+      }
 
       // convert filter-char to integer		   
       BAND      = SIMLIB_OBS_RAW.BAND[ISTORE] ;
@@ -14371,9 +14648,13 @@ void  SIMLIB_readNextCadence_TEXT(void) {
     // after first OBS is found we are done with header.
     // -> check for random RA,DEC shift
     // -> apply header cuts on ID, redshift, etc...
+    // SIMLIB_CACHE keeps every LIBID; cuts are applied for each event.
     if ( NOBS_FOUND_ALL == 1 ) { 
       SIMLIB_randomize_skyCoords();
-      USEFLAG_LIBID = keep_SIMLIB_HEADER(); 
+      if ( SIMLIB_CACHE.LOADING ) 
+	{ USEFLAG_LIBID = ACCEPT_FLAG ; }
+      else
+	{ USEFLAG_LIBID = keep_SIMLIB_HEADER(); }
     }
 
     // stop reading when we reach the end of this LIBID
@@ -14416,1009 +14697,1790 @@ void  SIMLIB_readNextCadence_TEXT(void) {
 
 
 // ==============================================
-void SIMLIB_randomize_skyCoords(void) {
+int ISBIN_SIMLIB(char *fileName) {
+  // Oct 2026: return 1 if SIMLIB fileName has binary suffix (.BIN)
+  int LEN  = strlen(fileName);
+  int LSUF = strlen(SUFFIX_SIMLIB_BIN);
+  if ( LEN <= LSUF ) { return 0; }
+  return ( strcmp(&fileName[LEN-LSUF],SUFFIX_SIMLIB_BIN) == 0 ) ;
+} // end ISBIN_SIMLIB
 
-  // Created Aug 24 2018
-  //
-  // Check option to randomly shift 
-  //   SIMLIB_HEADER.RA 
-  //   SIMLIB_HEADER.DEC
-  // To avoid fixed set of RA,DEC from SIMLIB.
-  //
-  // Initial function is just a do-nothing shell;
-  // waiting to get C function that picks randonly
-  // within healPix area.
 
-  char fnam[] = "SIMLIB_randomize_skyCoords" ;
+// ==============================================
+void SIMLIB_mkBinary(char *textFile, char *binFile) {
+
+  // Created Oct 2026
+  // Convert TEXT SIMLIB (may be gzipped) into binary SIMLIB;
+  // see SIMLIB_BIN_xxx structs in snlc_sim.h for the format.
+  // Each line is processed as follows:
+  //  + global header up to BEGIN -> global text
+  //  + S: line -> fixed-width record, and bare 'S:' token in text
+  //  + any other line is copied to the text of the current LIBID
+  // Text for each LIBID includes everything after the previous
+  // END_LIBID, so that the TEXT reader sees the same tokens.
+  // Abort if LIBIDs are not increasing; see SIMLIB_findLIBID_BIN.
+
+#define MXCHAR_LINE_MKBIN 1000
+
+  SIMLIB_BIN_FILEHEAD_DEF HEAD ;
+  SIMLIB_BIN_INDEX_DEF    *INDEX ;
+  SIMLIB_BIN_REC_DEF      REC ;
+  FILE *fp_txt, *fp_bin, *fp_tmp ;
+  int  gzipFlag, NITEM, NLIBID=0, MXLIBID=10000, IN_GLOBAL=1, IN_LIBID=0 ;
+  int  MXGLOBAL = 100000, LEN, NRD ;
+  long long BLOCK_START = 0, TEXTPOS = 0, NPAD ;
+  char LINE[MXCHAR_LINE_MKBIN], KEY[80], ctmp[80], *GLOBAL, BUF[8192] ;
+  char PAD[8] = { 0, 0, 0, 0, 0, 0, 0, 0 } ;
+  char fnam[] = "SIMLIB_mkBinary" ;
 
-  // --------------- BEGIN -------------
+  // ------------ BEGIN -------------
 
-  return ;
+  sprintf(BANNER,"%s: convert %s", fnam, textFile);
+  print_banner(BANNER);
 
-} // end SIMLIB_randomize_skyCoords
+  fp_txt = open_TEXTgz(textFile, "rt", &gzipFlag);
+  fp_bin = fopen(binFile, "wb");
+  fp_tmp = tmpfile();
+  if ( fp_txt == NULL || fp_bin == NULL || fp_tmp == NULL ) {
+    sprintf(c1err,"Cannot open SIMLIB text, binary or temp file:");
+    sprintf(c2err,"%s -> %s", textFile, binFile);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
+  }
 
+  memset(&HEAD, 0, sizeof(SIMLIB_BIN_FILEHEAD_DEF) );
+  memcpy(HEAD.MAGIC, MAGIC_SIMLIB_BIN, 16);
+  HEAD.VERSION    = VERSION_SIMLIB_BIN ;
+  HEAD.OFFSET_REC = sizeof(SIMLIB_BIN_FILEHEAD_DEF);
+  fwrite(&HEAD, sizeof(SIMLIB_BIN_FILEHEAD_DEF), 1, fp_bin); // placeholder
 
-// ==============================================
-int keep_SIMLIB_HEADER(void) {
+  INDEX  = (SIMLIB_BIN_INDEX_DEF*)malloc(MXLIBID*sizeof(SIMLIB_BIN_INDEX_DEF));
+  GLOBAL = (char*)malloc(MXGLOBAL*sizeof(char));  GLOBAL[0] = 0 ;
 
-  // Created Aug 2017
-  // Return ACCEPT_FLAG if SIMLIB_HEADER values pass cuts.
-  // Return REJECT_FLAG if SIMLIB_HEADER fails cuts, or REWIND flag is set
-  //
+  while ( fgets(LINE, MXCHAR_LINE_MKBIN, fp_txt) != NULL ) {
 
-  int  ID      = SIMLIB_HEADER.LIBID ;
-  int  NOBS    = SIMLIB_HEADER.NOBS ;
-  int  IDLOCK  = GENLC.SIMLIB_IDLOCK ;
-  int  NSKIP   = INPUTS.NSKIP_SIMLIB ;
-  int  NWRAP   = SIMLIB_HEADER.NWRAP ;
-  double  zCMB = GENLC.REDSHIFT_CMB ;
-  int  iskip, icheck ;
-  double *ptrGen ;
-  char fnam[] = "keep_SIMLIB_HEADER" ;
-  int LTRACE = 0 ;
+    KEY[0] = 0 ;  sscanf(LINE, "%79s", KEY);
 
-  // ----------- BEGIN ---------------
+    if ( IN_GLOBAL ) {
+      LEN = strlen(GLOBAL) + strlen(LINE) ;
+      if ( LEN >= MXGLOBAL ) {
+	MXGLOBAL = 2*LEN ;
+	GLOBAL   = (char*)realloc(GLOBAL, MXGLOBAL*sizeof(char) );
+      }
+      strcat(GLOBAL, LINE);
+      if ( strcmp(KEY,"BEGIN") == 0 ) { IN_GLOBAL = 0 ; }
+      continue ;
+    }
 
-  if(LTRACE) {
-    printf(" xxx %s: ----------- ID=%d ------------ \n", 
-	   fnam, GENLC.SIMLIB_ID );
-  }
+    if ( strcmp(KEY,"END_OF_SIMLIB:") == 0 ) { break ; }
 
-  if(LTRACE) {printf(" xxx %s: 0  IDLOCK=%d \n", fnam, IDLOCK);}
-  if ( IDLOCK >= 0 && IDLOCK != ID ) 
-    { return(REJECT_FLAG); }
+    if ( strcmp(KEY,"LIBID:") == 0 ) {
+      if ( IN_LIBID ) {
+	sprintf(c1err,"Found LIBID before END_LIBID after LIBID=%d",
+		INDEX[NLIBID].LIBID);
+	sprintf(c2err,"Check %s", textFile);
+	errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
+      }
+      if ( NLIBID == MXLIBID ) {
+	MXLIBID *= 2 ;
+	INDEX = (SIMLIB_BIN_INDEX_DEF*)
+	  realloc(INDEX, MXLIBID*sizeof(SIMLIB_BIN_INDEX_DEF));
+      }
+      IN_LIBID = 1 ;
+      sscanf(LINE, "%79s %d", KEY, &INDEX[NLIBID].LIBID );
+      if ( NLIBID > 0 && INDEX[NLIBID].LIBID <= INDEX[NLIBID-1].LIBID ) {
+	sprintf(c1err,"LIBID=%d follows LIBID=%d, but binary SIMLIB",
+		INDEX[NLIBID].LIBID, INDEX[NLIBID-1].LIBID );
+	sprintf(c2err,"requires increasing LIBIDs; sort %s", textFile);
+	errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
+      }
+      INDEX[NLIBID].NREC  = 0 ;
+      INDEX[NLIBID].IREC0 = HEAD.NREC ;
+      INDEX[NLIBID].OFFSET_TEXT = BLOCK_START ;
+    }
+
+    if ( strcmp(KEY,"S:") == 0 && IN_LIBID ) {
+      memset(&REC, 0, sizeof(SIMLIB_BIN_REC_DEF) );
+      NITEM = sscanf(LINE, "%79s %le %79s %3s "
+		     "%le %le %le %le %le %le %le %le %le",
+		     KEY, &REC.MJD, ctmp, REC.BAND, 
+		     &REC.CCDGAIN, &REC.READNOISE, &REC.SKYSIG,
+		     &REC.PSFSIG1, &REC.PSFSIG2, &REC.PSFRATIO,
+		     &REC.ZPTADU, &REC.ZPTSIG, &REC.MAG );
+      if ( NITEM != 13 ) {
+	sprintf(c1err,"Read %d of 13 items for S: line in LIBID=%d", 
+		NITEM, INDEX[NLIBID].LIBID);
+	sprintf(c2err,"%s", LINE);
+	errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
+      }
+      parse_SIMLIB_IDplusNEXPOSE(ctmp, &REC.IDEXPT, &REC.NEXPOSE);
+      fwrite(&REC, sizeof(SIMLIB_BIN_REC_DEF), 1, fp_bin);
+      HEAD.NREC++ ;  INDEX[NLIBID].NREC++ ;
+      sprintf(LINE,"S:\n");
+    }
 
-  if(LTRACE) {printf(" xxx %s: 1  NSKIP=%d \n", fnam, NSKIP );}
-  for ( iskip=0; iskip < NSKIP; iskip++ ) {
-    if ( ID == INPUTS.SIMLIB_IDSKIP[iskip] ) 
-      { return(REJECT_FLAG); }
+    fputs(LINE, fp_tmp);  TEXTPOS += strlen(LINE);
+
+    if ( strcmp(KEY,"END_LIBID:") == 0 && IN_LIBID ) {
+      INDEX[NLIBID].LEN_TEXT = TEXTPOS - BLOCK_START ;
+      BLOCK_START = TEXTPOS ;
+      IN_LIBID = 0 ;  NLIBID++ ;
+    }
+  } // end fgets loop
+
+  if ( gzipFlag ) { pclose(fp_txt); } else { fclose(fp_txt); }
+
+  if ( IN_GLOBAL || NLIBID == 0 ) {
+    sprintf(c1err,"Found no BEGIN key or no LIBID (NLIBID=%d)", NLIBID);
+    sprintf(c2err,"Check %s", textFile);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
   }
 
-  if(LTRACE) {printf(" xxx %s: 2  NWRAP=%d \n", fnam, NWRAP );}
-  if ( NWRAP > 0 && (SIMLIB_HEADER.LIBID == SIMLIB_ID_REWIND) )
-    { return(REJECT_FLAG); }
+  // append LIBID text, 8-byte aligned index, and global header
+  HEAD.NLIBID      = NLIBID ;
+  HEAD.OFFSET_TEXT = (long long)ftell(fp_bin);
+  rewind(fp_tmp);
+  while ( (NRD = fread(BUF, 1, sizeof(BUF), fp_tmp)) > 0 ) 
+    { fwrite(BUF, 1, NRD, fp_bin); }
+  fclose(fp_tmp);
 
-  if(LTRACE) {printf(" xxx %s: 3  NOBS=%d \n", fnam, NOBS );}
-  if ( NOBS < INPUTS.SIMLIB_MINOBS ) 
-    { return(REJECT_FLAG); }
+  NPAD = (8 - (HEAD.OFFSET_TEXT + TEXTPOS)%8 ) % 8 ;
+  fwrite(PAD, 1, NPAD, fp_bin);
 
-  // check SIMLIB GENRANGES and user-input ranges
-  if(LTRACE) {printf(" xxx %s: 4  RA=%f\n", fnam, SIMLIB_HEADER.RA );}
-  if( SIMLIB_HEADER.RA < INPUTS.GENRANGE_RA[0] ) { return(REJECT_FLAG) ; }
-  if( SIMLIB_HEADER.RA > INPUTS.GENRANGE_RA[1] ) { return(REJECT_FLAG) ; }
-  SIMLIB_HEADER.NFOUND_RA++ ;    
+  HEAD.OFFSET_INDEX  = (long long)ftell(fp_bin);
+  fwrite(INDEX, sizeof(SIMLIB_BIN_INDEX_DEF), NLIBID, fp_bin);
 
-  if(LTRACE) {printf(" xxx %s: 5  DEC=%f\n", fnam, SIMLIB_HEADER.DEC );}
-  if( SIMLIB_HEADER.DEC < INPUTS.GENRANGE_DEC[0] ) { return(REJECT_FLAG) ; }
-  if( SIMLIB_HEADER.DEC > INPUTS.GENRANGE_DEC[1] ) { return(REJECT_FLAG) ; }
-  SIMLIB_HEADER.NFOUND_DEC++ ;    
+  HEAD.OFFSET_GLOBAL = (long long)ftell(fp_bin);
+  HEAD.LEN_GLOBAL    = strlen(GLOBAL);
+  fwrite(GLOBAL, 1, HEAD.LEN_GLOBAL, fp_bin);
 
+  rewind(fp_bin);
+  fwrite(&HEAD, sizeof(SIMLIB_BIN_FILEHEAD_DEF), 1, fp_bin);
+  fclose(fp_bin);
 
-  // Check optional CUTWIN_REDSHIFT so that each LIBID
-  // can have its own z-range (originally for WFIRST study)
-  // Note that this is a cut, not a range to generate.
-  if(LTRACE) {printf(" xxx %s: 6  zCMB=%f\n", fnam, zCMB );}
-  if ( zCMB < SIMLIB_HEADER.CUTWIN_REDSHIFT[0] )  { return(REJECT_FLAG); }
-  if ( zCMB > SIMLIB_HEADER.CUTWIN_REDSHIFT[1] )  { return(REJECT_FLAG); }
+  printf("\t Wrote %d LIBIDs and %lld S: records to \n\t %s \n",
+	 NLIBID, HEAD.NREC, binFile );
+  fflush(stdout);
 
+  free(INDEX);  free(GLOBAL);
 
-  // check redshift window
-  if(LTRACE) {printf(" xxx %s: 8\n", fnam );}
-  ptrGen = SIMLIB_HEADER.GENRANGE_REDSHIFT ;
-  if ( ptrGen[0] > 0.0 ) {
-    icheck = check_SIMLIB_GENRANGE(INPUTS.GENRANGE_REDSHIFT, ptrGen);
-    if ( icheck < 0 ) { return(REJECT_FLAG); }
-    if ( ptrGen[1] > ptrGen[0] ) { SIMLIB_HEADER.REGEN_FLAG = 1; }
-  }
+} // end SIMLIB_mkBinary
 
-  // check PEAKMJD
-  ptrGen = SIMLIB_HEADER.GENGAUSS_PEAKMJD.RANGE ;
-  if(LTRACE) 
-    {printf(" xxx %s: 9 PEAKMJD.RANGE=%.3f,%.3f\n", fnam,ptrGen[0],ptrGen[1]);}
-  if ( ptrGen[0] > 1000. ) {
-    icheck = check_SIMLIB_GENRANGE(INPUTS.GENRANGE_PEAKMJD, ptrGen);
-    if ( icheck < 0 ) { return(REJECT_FLAG); }    
-    if ( ptrGen[1] > ptrGen[0] ) 
-      { SIMLIB_HEADER.REGEN_FLAG = 1; }
-    else { 
-      GENLC.PEAKMJD         = ptrGen[0]; 
-      GENLC.ISOURCE_PEAKMJD = ISOURCE_PEAKMJD_SIMLIB; 
-    }
-  }
 
+// ==============================================
+void SIMLIB_openBinary(char *binFile) {
 
-  // check SALT2c
-  if(LTRACE) {printf(" xxx %s: 10 check SALT2c \n", fnam );}
-  ptrGen = SIMLIB_HEADER.GENGAUSS_SALT2c.RANGE ;
-  if ( fabs(ptrGen[0]) < 90.0 ) {
-    icheck = check_SIMLIB_GENRANGE(INPUTS.GENGAUSS_SALT2c.RANGE, ptrGen);
-    if ( icheck < 0 ) { return(REJECT_FLAG); }    
-    SIMLIB_HEADER.REGEN_FLAG = 1; 
-  }
+  // Created Oct 2026
+  // Memory-map binary SIMLIB, set pointers to index, records and 
+  // text, and open fp_SIMLIB on the global-header text so that
+  // SIMLIB_readGlobalHeader_TEXT reads it as usual.
 
-  // check SALT2x1
-  if(LTRACE) {printf(" xxx %s: 11 check SALT2x1\n", fnam );}
-  ptrGen = SIMLIB_HEADER.GENGAUSS_SALT2x1.RANGE ;
-  if ( fabs(ptrGen[0]) < 90.0 ) {
-    icheck = check_SIMLIB_GENRANGE(INPUTS.GENGAUSS_SALT2x1.RANGE, ptrGen);
-    if ( icheck < 0 ) { return(REJECT_FLAG); }    
-    SIMLIB_HEADER.REGEN_FLAG = 1; 
-  }
+  struct stat statbuf ;
+  int    fd ;
+  char   *MAP ;
+  char fnam[] = "SIMLIB_openBinary" ;
 
+  // ------------ BEGIN -------------
 
-  // Nov 26 2017: check NREPEAT for LCLIB
-  if(LTRACE) {printf(" xxx %s: 12\n", fnam );}
-  //  printf(" 1. xxx %s: HEADER.NREPEAT=%d   INPUTS.NREPEAT=%d\n", 
-  //	 fnam, SIMLIB_HEADER.NREPEAT, INPUTS.SIMLIB_NREPEAT );
-  set_SIMLIB_NREPEAT();
-  if ( INPUTS.SIMLIB_NREPEAT == 0 ) { return(REJECT_FLAG); }
-  
+  fd = open(binFile, O_RDONLY);
+  if ( fd < 0 || fstat(fd,&statbuf) != 0 ) {
+    sprintf(c1err,"Cannot open binary SIMLIB_FILE");
+    sprintf(c2err,"'%s'", binFile);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
+  }
 
-  if(LTRACE) {printf(" xxx %s: 99 END\n", fnam ); debugexit(fnam); }
-  
-  // if we get here, keep this ID
-  return(ACCEPT_FLAG) ;
+  SIMLIB_BIN.SIZE_MAP = (size_t)statbuf.st_size ;
+  MAP = (char*)mmap(NULL, SIMLIB_BIN.SIZE_MAP, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if ( MAP == MAP_FAILED ) {
+    sprintf(c1err,"mmap failed for binary SIMLIB_FILE");
+    sprintf(c2err,"'%s'", binFile);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
+  }
 
-} // end keep_SIMLIB_HEADER
+  SIMLIB_BIN.MAP  = MAP ;
+  SIMLIB_BIN.HEAD = (SIMLIB_BIN_FILEHEAD_DEF*)MAP ;
+  if ( memcmp(SIMLIB_BIN.HEAD->MAGIC, MAGIC_SIMLIB_BIN, 16) != 0 ||
+       SIMLIB_BIN.HEAD->VERSION != VERSION_SIMLIB_BIN ) {
+    sprintf(c1err,"Invalid binary SIMLIB (expect %s version %d)", 
+	    MAGIC_SIMLIB_BIN, VERSION_SIMLIB_BIN );
+    sprintf(c2err,"Re-make '%s' with SIMLIB_MKBIN key", binFile);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
+  }
 
+  SIMLIB_BIN.INDEX = (SIMLIB_BIN_INDEX_DEF*)(MAP+SIMLIB_BIN.HEAD->OFFSET_INDEX);
+  SIMLIB_BIN.REC   = (SIMLIB_BIN_REC_DEF*)  (MAP+SIMLIB_BIN.HEAD->OFFSET_REC);
+  SIMLIB_BIN.TEXT  = MAP + SIMLIB_BIN.HEAD->OFFSET_TEXT ;
+  SIMLIB_BIN.ILIBID_NEXT = 0 ;
+  SIMLIB_BIN.IREC_NEXT   = SIMLIB_BIN.IREC_CUR = 0 ;
 
-// =======================================================
-void SIMLIB_addCadence_SPECTROGRAPH(void) {
+  fp_SIMLIB = fmemopen(MAP + SIMLIB_BIN.HEAD->OFFSET_GLOBAL,
+		       SIMLIB_BIN.HEAD->LEN_GLOBAL, "r");
 
-  // Created Aug 23 2017
-  // For each SPECTROGRAPH key in the SIMLIB, which specifies
-  // MJD and TEXPOSE, add additional SIMLIB_OBS_RAW observation
-  // for each synthetic band as if that band had been included
-  // in the SIMLIB file.
-  // The original SPECTROGRAPH entry is masked out by setting
-  // its OPTLINE = -9, but then appended to the end of the 
-  // SIMLIB_OBS_RAW list along with each synthetic band.
-  //
-  // 9.18/2017: set PIXSIZE
+  printf("   Opened binary SIMLIB: %d LIBIDs, %lld S: records (%.1f MB)\n",
+	 SIMLIB_BIN.HEAD->NLIBID, SIMLIB_BIN.HEAD->NREC,
+	 (double)SIMLIB_BIN.SIZE_MAP/1.0E6 );
+  fflush(stdout);
 
-  int NOBS       = SIMLIB_OBS_RAW.NOBS ;
-  int NOBS_SPEC  = SIMLIB_OBS_RAW.NOBS_SPECTROGRAPH ;
-  int NFILT_SPEC = GENLC.NFILTDEF_SPECTROGRAPH  ; // Numb of synthetic filters
-  int ifilt, ispec, OBSRAW, ISTORE, NOBS_ADD, APP ;
-  double MJD, TEXPOSE, PIXSIZE ;
-  char *FIELD, *TEL ;
-  char fnam[] = "SIMLIB_addCadence_SPECTROGRAPH" ;
+} // end SIMLIB_openBinary
 
-  // --------------- BEGIN --------------
 
-  // always mask off original SPECTROGRAPH def in case we bail below.
-  for ( ispec=0; ispec < NOBS_SPEC; ispec++ ) {
-    OBSRAW = SIMLIB_OBS_RAW.OBSLIST_SPECTROGRAPH[ispec];
-    SIMLIB_OBS_RAW.OPTLINE[OBSRAW] = -9 ;
-  }
+// ==============================================
+void SIMLIB_openLIBID_BIN(int ILIBID) {
 
-  // if SPCTROGRAPH is to be ignored, then bail.
-  if ( SPECTROGRAPH_USEFLAG == 0 ) { return ; }
-  if ( NOBS_SPEC == 0 )            { return ; }
+  // Created Oct 2026
+  // Point fp_SIMLIB to the text of LIBID index ILIBID 
+  // (0 to NLIBID-1) and set first S: record.
 
+  SIMLIB_BIN_INDEX_DEF *INDEX = &SIMLIB_BIN.INDEX[ILIBID] ;
 
-  if ( NFILT_SPEC == 0 ) { NFILT_SPEC=1; }   // at least the spectrum
-  ISTORE = NOBS;  NOBS_ADD=0;
+  if ( fp_SIMLIB != NULL ) { fclose(fp_SIMLIB); }
+  fp_SIMLIB = fmemopen(SIMLIB_BIN.TEXT + INDEX->OFFSET_TEXT,
+		       INDEX->LEN_TEXT, "r");
+  SIMLIB_BIN.IREC_NEXT   = INDEX->IREC0 ;
+  SIMLIB_BIN.ILIBID_NEXT = ILIBID + 1 ;
 
-  for ( ispec=0; ispec < NOBS_SPEC; ispec++ ) {
+} // end SIMLIB_openLIBID_BIN
 
-    // get MJD and epxosure time 
-    OBSRAW  = SIMLIB_OBS_RAW.OBSLIST_SPECTROGRAPH[ispec];
-    MJD     = SIMLIB_OBS_RAW.MJD[OBSRAW] ;
-    TEXPOSE = SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[OBSRAW] ;
-    FIELD   = SIMLIB_OBS_RAW.FIELDNAME[OBSRAW] ;
-    APP     = SIMLIB_OBS_RAW.APPEND_PHOTFLAG[OBSRAW] ;
-    TEL     = INPUTS_SPECTRO.INSTRUMENT_NAME ;
-    PIXSIZE = SIMLIB_HEADER.PIXSIZE ;
 
-    // add each synthetic filter to SIMLIB OBS_RAW as if it
-    // were defined in the SIMLIB file.
+// ==============================================
+int SIMLIB_findLIBID_BIN(int IDSEEK) {
 
-    for(ifilt=0 ; ifilt < NFILT_SPEC; ifilt++ ) {
-      
-      SIMLIB_OBS_RAW.INDX_TAKE_SPECTRUM[ISTORE]   = ispec ;
-      SIMLIB_OBS_RAW.IFILT_SPECTROGRAPH[ISTORE]   = ifilt ; 
-      SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[ISTORE] = TEXPOSE ;      
-      SIMLIB_OBS_RAW.OPTLINE[ISTORE]    = OPTLINE_SIMLIB_SPECTROGRAPH ;
-      SIMLIB_OBS_RAW.MJD[ISTORE]        = MJD ;
-      SIMLIB_OBS_RAW.PIXSIZE[ISTORE]    = PIXSIZE ;
-      
-      SIMLIB_OBS_RAW.BAND[ISTORE][0] = 0 ;
-      sprintf(SIMLIB_OBS_RAW.FIELDNAME[ISTORE], "%s", FIELD );
-      sprintf(SIMLIB_OBS_RAW.TELESCOPE[ISTORE], "%s", TEL);
+  // Created Oct 2026
+  // Return index (0 to NLIBID-1) of first LIBID >= IDSEEK, using 
+  // a binary search over the index (LIBIDs are increasing; see
+  // SIMLIB_mkBinary). If all LIBIDs are < IDSEEK, return last index
+  // so that SIMLIB_findStart wraps around and aborts.
 
-      if ( APP > 0 ) { SIMLIB_HEADER.NOBS_APPEND++ ; }
-      SIMLIB_OBS_RAW.APPEND_PHOTFLAG[ISTORE] = APP ;
+  int ILO = 0, IHI = SIMLIB_BIN.HEAD->NLIBID - 1, IMID ;
 
-      // the quantities below will be evaluated later in 
-      // store_SIMLIB_SPECTROGRAPH (as part of 'prepCadence')
-      SIMLIB_OBS_RAW.IDEXPT[ISTORE]     = -9 ;
-      SIMLIB_OBS_RAW.NEXPOSE[ISTORE]    =  0 ;
-      SIMLIB_OBS_RAW.CCDGAIN[ISTORE]    = -9.0 ;
-      SIMLIB_OBS_RAW.READNOISE[ISTORE]  = -9.0 ;
-      SIMLIB_OBS_RAW.SKYSIG[ISTORE]     = -9.0 ;
-      SIMLIB_OBS_RAW.PSFSIG1[ISTORE]    = -9.0 ;
-      SIMLIB_OBS_RAW.PSFSIG2[ISTORE]    = -9.0 ;
-      SIMLIB_OBS_RAW.PSFRATIO[ISTORE]   = -9.0 ;
-      SIMLIB_OBS_RAW.ZPTADU[ISTORE]     = -9.0 ;
-      SIMLIB_OBS_RAW.ZPTSIG[ISTORE]     = -9.0 ;
-      SIMLIB_OBS_RAW.MAG[ISTORE]        = 99.0 ;
-      ISTORE++ ;  NOBS_ADD++ ;
+  while ( ILO < IHI ) {
+    IMID = (ILO + IHI) / 2 ;
+    if ( SIMLIB_BIN.INDEX[IMID].LIBID < IDSEEK ) 
+      { ILO = IMID + 1 ; }
+    else
+      { IHI = IMID ; }
+  }
+  return(ILO);
 
-    } // end ifilt loop
-  } // end i Loop over SPECTROGRAPH keys
+} // end SIMLIB_findLIBID_BIN
 
-  
-  // -------------------------
-  // update NOBS
-  SIMLIB_OBS_RAW.NOBS_SPECTROGRAPH = NOBS_ADD;
 
-  // make sure that NOBS is deterministic in case we neeed
-  // to recompute this later.
-  SIMLIB_OBS_RAW.NOBS = 
-    SIMLIB_OBS_RAW.NOBS_READ + SIMLIB_OBS_RAW.NOBS_SPECTROGRAPH ;
+// ==============================================
+int SIMLIB_nextToken(char *c_get) {
 
-  SIMLIB_HEADER.NOBS = SIMLIB_OBS_RAW.NOBS ;
+  // Created Oct 2026
+  // Read next SIMLIB token into c_get, and return EOF at end.
+  // For binary SIMLIB, open the next LIBID when the current one
+  // is exhausted, and return END_OF_SIMLIB: after the last LIBID
+  // (then wrap around for GENSOURCE=RANDOM, or EOF otherwise).
 
-  return ;
+  int NLIBID, istat ;
 
-} // end SIMLIB_addCadence_SPECTROGRAPH 
+  while ( (istat=fscanf(fp_SIMLIB, "%s", c_get)) == EOF && SIMLIB_BIN.USE ) {
 
+    NLIBID = SIMLIB_BIN.HEAD->NLIBID ;
+    if ( SIMLIB_BIN.ILIBID_NEXT > NLIBID ) { return(EOF); }
 
-// ==============================================
-void  SIMLIB_TAKE_SPECTRUM(void) {
-  
-  // add spectrograph entries w.r.t peakMJD
-  // These OBS are not in the SIMLIB, so here we add
-  // them as if they were in the SIMLIB.
-  //
-  // Aug 23 2017: remove NLINE_MJD argument for refactor
-  // Mar 02 2019: remove LEGACY flag, and fix bug setting VAL_STORE 
-  //              when NFILT==0.
+    if ( SIMLIB_BIN.ILIBID_NEXT == NLIBID ) {
+      if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENRANDOM ) 
+	{ SIMLIB_BIN.ILIBID_NEXT = 0 ; }
+      else
+	{ SIMLIB_BIN.ILIBID_NEXT = NLIBID + 1 ; }
+      sprintf(c_get, "END_OF_SIMLIB:");
+      return(1);
+    }
 
-  int i, OPT, ifilt, ifilt_obs, OBSRAW, NOBS_ADD ;
-  int NSPEC = NPEREVT_TAKE_SPECTRUM ;
-  int NFILT = GENLC.NFILTDEF_SPECTROGRAPH ;  // all spectroscopic filters
-  double EPOCH[2], MJD, MJD_REF;
-  double z, z1, TOBS, TREST, TOBS_REF ;
-  double TEXPOSE, VAL_STORE[8] ;
-  char *FIELD ;
-  char fnam[] = "SIMLIB_TAKE_SPECTRUM" ;
+    SIMLIB_openLIBID_BIN(SIMLIB_BIN.ILIBID_NEXT);
+  }
 
+  return(istat);
 
-  // -------------- BEGIN -------------
+} // end SIMLIB_nextToken
 
-  if ( NSPEC == 0 ) { return ; }
 
-  // in case of repeated cadence, reset NOBS to leave out 
-  // previous TAKE_SPECTRUM obs.
-  SIMLIB_OBS_RAW.NOBS = SIMLIB_HEADER.NOBS =
-    SIMLIB_OBS_RAW.NOBS_READ + SIMLIB_OBS_RAW.NOBS_SPECTROGRAPH ;
-  
+// ==============================================
+void SIMLIB_copyObs_BIN(int ISTORE) {
 
-  OBSRAW = SIMLIB_OBS_RAW.NOBS ;  NOBS_ADD=0;
- 
-  z = GENLC.REDSHIFT_CMB ;
-  for(i=0; i < NSPEC; i++ ) {  
+  // Created Oct 2026
+  // Copy current S: record from binary SIMLIB into SIMLIB_OBS_RAW.
 
-    EPOCH[0] = INPUTS.TAKE_SPECTRUM[i].EPOCH_RANGE[0] ;
-    EPOCH[1] = INPUTS.TAKE_SPECTRUM[i].EPOCH_RANGE[1] ;
+  SIMLIB_BIN_REC_DEF *REC = &SIMLIB_BIN.REC[SIMLIB_BIN.IREC_CUR] ;
 
-    MJD_REF =  GENSPEC_PICKMJD( 0, i, z, &TOBS, &TREST) ; // for MJD sorting
-    //    MJD     =  GENSPEC_PICKMJD( 1, i, z, &TOBS, &TREST) ;
+  SIMLIB_OBS_RAW.MJD[ISTORE]       = REC->MJD ;
+  SIMLIB_OBS_RAW.IDEXPT[ISTORE]    = REC->IDEXPT ;
+  SIMLIB_OBS_RAW.NEXPOSE[ISTORE]   = REC->NEXPOSE ;
+  sprintf(SIMLIB_OBS_RAW.BAND[ISTORE], "%s", REC->BAND);
+  SIMLIB_OBS_RAW.CCDGAIN[ISTORE]   = REC->CCDGAIN ;
+  SIMLIB_OBS_RAW.READNOISE[ISTORE] = REC->READNOISE ;
+  SIMLIB_OBS_RAW.SKYSIG[ISTORE]    = REC->SKYSIG ;
+  SIMLIB_OBS_RAW.PSFSIG1[ISTORE]   = REC->PSFSIG1 ;
+  SIMLIB_OBS_RAW.PSFSIG2[ISTORE]   = REC->PSFSIG2 ;
+  SIMLIB_OBS_RAW.PSFRATIO[ISTORE]  = REC->PSFRATIO ;
+  SIMLIB_OBS_RAW.ZPTADU[ISTORE]    = REC->ZPTADU ;
+  SIMLIB_OBS_RAW.ZPTSIG[ISTORE]    = REC->ZPTSIG ;
+  SIMLIB_OBS_RAW.MAG[ISTORE]       = REC->MAG ;
 
-    // make sure that TREST is within valid range
-    float *ptrTcut = INPUTS.GENRANGE_TREST ;
-    if ( TREST <= ptrTcut[0] ||	 TREST >= ptrTcut[1]  ) {
-      sprintf(c1err,"Invalid TREST=%.2f in TAKE_SPECTRUM key.",TREST);
-      sprintf(c2err,"User set 'GENRANGE_TREST:  %.2f  %.2f' ", 
-	      ptrTcut[0], ptrTcut[1] );
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ) ; 
-    }
+} // end SIMLIB_copyObs_BIN
 
-    // Now get exposure time
-    OPT  = INPUTS.TAKE_SPECTRUM[i].OPT_TEXPOSE ;
-    if ( OPT == 1 ) {
-      GENPOLY_DEF *GENZPOLY = &INPUTS.TAKE_SPECTRUM[i].GENZPOLY_TEXPOSE;
-      TEXPOSE = eval_GENPOLY(z,GENZPOLY,fnam);
-    }
-    else if ( OPT == 2 ) {
-      // use max TEXPOSE for now; later correct for user SNR
-      TEXPOSE = INPUTS_SPECTRO.TEXPOSE_MAX ;
-    }
-    else {
-      sprintf(c1err,"Invalid OPT_TEXPOSE[%d] = %d", i, OPT);
-      sprintf(c2err,"Should be 1(TEXPOSE) or 2(SNR)" );
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ) ; 
-    }
 
-    /*
-    printf(" xxx i=%d : load MJD=%.3f  TEXPOSE=%.0f  EP=%.2f  z=%.3f \n",
-	   i, MJD, TEXPOSE, EPOCH_RAN, z ); fflush(stdout);
-    */
+// ==============================================
+void init_SIMLIB_CACHE(void) {
+
+  // Created Oct 2026
+  // If SIMLIB_CACHE > 0, read every cadence once, starting where
+  // SIMLIB_findStart left the SIMLIB, and store each cadence in
+  // SIMLIB_CACHE after SPECTROGRAPH expansion, unit conversions,
+  // MJD-sorting and seasons. Reading stops after wrapping back to 
+  // the first cached LIBID, or when the memory budget 
+  // (SIMLIB_CACHE, in MB) is used; in the latter case only the
+  // cached subset of LIBIDs is used to generate events.
+  //
+  // Called after init_kcor (SPECTROGRAPH filters), and before 
+  // fork_SIMTHREAD so that workers share the cache.
+
+  double MXMEM = INPUTS.SIMLIB_CACHE * 1.0E6 ;
+  int    NWRAP_TOT = 0, NOBS_TOT = 0, NOBS_HEADER_READ, LIBID0 = -9 ;
+  int    FULL ;
+  time_t t0, t1 ;
+  char fnam[] = "init_SIMLIB_CACHE" ;
 
+  // ------------ BEGIN -------------
 
-    if ( NFILT==0 ) {  // no synthetic filters; just spectra
-      VAL_STORE[0] = MJD_REF   ; // same MJD_REF each event for MJD-sorting
-      VAL_STORE[1] = TEXPOSE ;
-      VAL_STORE[2] = (double)i ;   
-      store_GENSPEC(VAL_STORE) ; 
-    }
+  SIMLIB_CACHE.USE = SIMLIB_CACHE.LOADING = 0 ;
+  if ( INPUTS.SIMLIB_CACHE <= 0.0 ) { return ; }
 
-    for(ifilt=0; ifilt < NFILT; ifilt++ ) {  
+  sprintf(BANNER,"%s: read SIMLIB into memory (max %.0f MB)", 
+	  fnam, INPUTS.SIMLIB_CACHE );
+  print_banner(BANNER);
 
-      SIMLIB_OBS_RAW.OPTLINE[OBSRAW]  = OPTLINE_SIMLIB_SPECTROGRAPH ; 
-      SIMLIB_OBS_RAW.MJD[OBSRAW]      = MJD_REF ;
-      SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[OBSRAW]  = TEXPOSE ;
-      SIMLIB_OBS_RAW.IFILT_SPECTROGRAPH[OBSRAW]    = ifilt;
-      SIMLIB_OBS_RAW.INDX_TAKE_SPECTRUM[OBSRAW]    = i ;
-      SIMLIB_OBS_RAW.PIXSIZE[OBSRAW] = SIMLIB_HEADER.PIXSIZE ;
+  // TAKE_SPECTRUM adds PEAKMJD-dependent obs to the cadence
+  if ( NPEREVT_TAKE_SPECTRUM > 0 ) {
+    printf("   SIMLIB_CACHE disabled because TAKE_SPECTRUM changes "
+	   "each cadence.\n");
+    fflush(stdout);
+    return ;
+  }
 
-      // For field, give survey name (since we don;t know)
-      // TO DO: determine FIELD based on MJD range
-      sprintf(SIMLIB_OBS_RAW.FIELDNAME[OBSRAW],"%s", 
-	      SIMLIB_GLOBAL_HEADER.SURVEY_NAME );
-      
-      sprintf(SIMLIB_OBS_RAW.TELESCOPE[OBSRAW], "%s", 
-	      INPUTS_SPECTRO.INSTRUMENT_NAME );
-      
-      OBSRAW++ ;   NOBS_ADD++ ;	
+  t0 = time(NULL);
 
-    } // end ifilt
+  SIMLIB_CACHE.NLIBID      = 0 ;
+  SIMLIB_CACHE.MXLIBID     = 1000 ;
+  SIMLIB_CACHE.ILIBID_NEXT = 0 ;
+  SIMLIB_CACHE.LIBID  = (SIMLIB_CACHE_LIBID_DEF*)
+    malloc(SIMLIB_CACHE.MXLIBID * sizeof(SIMLIB_CACHE_LIBID_DEF) );
+  SIMLIB_CACHE.NSTR   = 0 ;
+  SIMLIB_CACHE.MXSTR  = 100 ;
+  SIMLIB_CACHE.STRLIST = (char**)malloc(SIMLIB_CACHE.MXSTR*sizeof(char*));
+  SIMLIB_CACHE.MEMORY  = 
+    (double)(SIMLIB_CACHE.MXLIBID * sizeof(SIMLIB_CACHE_LIBID_DEF)) +
+    (double)(SIMLIB_CACHE.MXSTR   * sizeof(char*)) ;
 
-  } // end i-loop over TAKE_SPECTRUM
+  SIMLIB_CACHE.LOADING = 1 ;
+  SIMLIB_HEADER.NWRAP  = 0 ;
+  FULL = 0 ;
 
+  while ( 1 ) {
 
-  SIMLIB_OBS_RAW.NOBS += NOBS_ADD ;
-  SIMLIB_HEADER.NOBS  += NOBS_ADD ;
+    if ( SIMLIB_CACHE.MEMORY > MXMEM ) { FULL = 1;  break ; }
 
+    SIMLIB_readNextCadence_TEXT();
+    NWRAP_TOT += SIMLIB_HEADER.NWRAP ;
+    if ( NWRAP_TOT > 0 && SIMLIB_HEADER.LIBID == LIBID0 ) { break; }
+    if ( LIBID0 < 0 ) { LIBID0 = SIMLIB_HEADER.LIBID ; }
 
-  return;
+    NOBS_HEADER_READ = SIMLIB_HEADER.NOBS ;
+    SIMLIB_addCadence_SPECTROGRAPH(); 
+    SIMLIB_prepCadence_RAW();
+    store_SIMLIB_SEASONS();
+    SIMLIB_storeCadence_CACHE(NOBS_HEADER_READ);
+    NOBS_TOT += SIMLIB_OBS_RAW.NOBS ;
+  }
 
-} // end  SIMLIB_TAKE_SPECTRUM
+  SIMLIB_CACHE.LOADING = 0 ;
+  SIMLIB_CACHE.USE     = 1 ;
+  SIMLIB_HEADER.NWRAP  = 0 ;
+  t1 = time(NULL);
 
+  printf("   Cached %d LIBIDs with %d observations and %d FIELD/TELESCOPE "
+	 "names\n", SIMLIB_CACHE.NLIBID, NOBS_TOT, SIMLIB_CACHE.NSTR );
+  printf("   SIMLIB_CACHE memory footprint: %.2f MB  (%d seconds to read)\n",
+	 SIMLIB_CACHE.MEMORY/1.0E6, (int)(t1-t0) );
+  if ( FULL ) {
+    printf("   WARNING: SIMLIB_CACHE=%.0f MB is full; generate with "
+	   "this subset of LIBIDs.\n", INPUTS.SIMLIB_CACHE );
+  }
+  fflush(stdout);
 
-// ===================================
-void  SIMLIB_prepCadence(int REPEAT_CADENCE) {
+  if ( SIMLIB_CACHE.NLIBID == 0 ) {
+    sprintf(c1err,"No LIBID stored in SIMLIB_CACHE.");
+    sprintf(c2err,"Check SIMLIB_FILE, or increase SIMLIB_CACHE (MB)");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
+  }
 
-  // Created Aug 2017
-  //
-  // After calling SIMLIB_readNext,
-  // apply selection and MJD-sorting on SIMLIB_OBS_RAW entries 
-  // and fill SIMLIB_OBS_GEN to use for generation.
-  // Also set some GENLC arrays for current LIBID/Cadence.
-  //
-  // REPEAT_CADENCE=0 --> this is a new cadence
-  // REPEAT_CADENCE=1 --> same cadence as before, but new event
-  //
-  // Mar 11 2018: fix PIXSIZE for FWHM_ARCSEC units
-  // Mar 15 2018: MAG -> MAG_UNDEFINED
-  // Jul 11 2018: fix bug by setting PIXSIZE outside UNIT if-block
+} // end init_SIMLIB_CACHE
 
-  int NEW_CADENCE = (REPEAT_CADENCE == 0 ) ;
-  int ORDER_SORT, ISTORE,  OPTLINE, OBSRAW ;
-  double zcmb, RA, DEC, vpec, MJDrange[2], PIXSIZE, DUM, PSF_ORIG ;
-  double SNR, SNRMAX=-9.0 ;
 
-  int NOBS_APPEND = SIMLIB_HEADER.NOBS_APPEND ;
-  int NOBS_RAW    = SIMLIB_HEADER.NOBS ;
+// ==============================================
+int get_SIMLIB_CACHE_ISTR(char *STRING) {
 
-  char *UNIT, *BAND ;
-  char fnam[] = "SIMLIB_prepCadence" ;
+  // Created Oct 2026
+  // Return index of STRING in SIMLIB_CACHE.STRLIST; add STRING to
+  // the list if it is not there yet.
 
-  // --------------- BEGIN ----------------
+  int i, NSTR = SIMLIB_CACHE.NSTR ;
 
-  GENLC.NEPOCH = 0 ; // Mar 17 2015: needed for LIBID repeats
+  for(i=0; i < NSTR; i++ ) 
+    { if ( strcmp(SIMLIB_CACHE.STRLIST[i],STRING) == 0 ) { return(i); } }
 
-  // Apr 13, 2016: 
-  // check if anything needs to be re-generated based on header info
-  if ( regen_SIMLIB_GENRANGES() < 0 ) { return ; }
+  if ( NSTR == SIMLIB_CACHE.MXSTR ) {
+    SIMLIB_CACHE.MXSTR  *= 2 ;
+    SIMLIB_CACHE.STRLIST = (char**)
+      realloc(SIMLIB_CACHE.STRLIST, SIMLIB_CACHE.MXSTR*sizeof(char*) );
+    SIMLIB_CACHE.MEMORY += (double)(NSTR*sizeof(char*)) ;
+  }
 
-  // transfer some SIMLIB_HEADER info to GENLC struct
-  GENLC.RA         = SIMLIB_HEADER.RA ;
-  GENLC.DEC        = SIMLIB_HEADER.DEC ;
+  SIMLIB_CACHE.STRLIST[NSTR] = (char*)malloc( strlen(STRING)+1 );
+  sprintf(SIMLIB_CACHE.STRLIST[NSTR], "%s", STRING);
+  SIMLIB_CACHE.MEMORY += (double)(strlen(STRING)+1) ;
+  SIMLIB_CACHE.NSTR++ ;
 
-  if ( INPUTS.OPT_MWEBV == OPT_MWEBV_FILE ) 
-    { GENLC.MWEBV = SIMLIB_HEADER.MWEBV ; }
-  GENLC.SIMLIB_ID  = SIMLIB_HEADER.LIBID ;
-  sprintf(GENLC.FIELDNAME[0], "%s", SIMLIB_HEADER.FIELD);
-  sprintf(GENLC.TELESCOPE[0], "%s", SIMLIB_HEADER.TELESCOPE);
+  return(NSTR);
 
-  // --------------------------------------------------------------
-  // do a few things for a NEW cadence, 
-  // but not for a repeated/re-used cadence
-  //   1) prepare duplicate MJDs for sorting
-  //   2) sanity checks on values
-  //   3) check change of units for PSF and SKYSIG
+} // end get_SIMLIB_CACHE_ISTR
 
-  if ( NEW_CADENCE ) { 
 
-    for(ISTORE=0; ISTORE < NOBS_RAW ; ISTORE++ ) {
+// ==============================================
+void SIMLIB_storeCadence_CACHE(int NOBS_HEADER_READ) {
 
-      // 1a. prep duplicate MJDs
-      SIMLIB_prepMJD_forSORT(ISTORE);
+  // Created Oct 2026
+  // Append current cadence (SIMLIB_HEADER, SIMLIB_OBS_RAW, 
+  // SIMLIB_LIST_forSORT and SIMLIB_TEMPLATE) to SIMLIB_CACHE.
+  // NOBS_HEADER_READ is the NOBS read from the LIBID header,
+  // needed to re-apply keep_SIMLIB_HEADER for each event.
 
-      OPTLINE  = SIMLIB_OBS_RAW.OPTLINE[ISTORE] ;
-      if ( OPTLINE != OPTLINE_SIMLIB_S ) { continue ; }
+  int ILIBID = SIMLIB_CACHE.NLIBID ;
+  int NOBS   = SIMLIB_OBS_RAW.NOBS ;
+  int obs, NFIELD, MEMF, MEMN ;
+  SIMLIB_CACHE_LIBID_DEF *CACHE ;
+  SIMLIB_CACHE_OBS_DEF   *OBS ;
+  char fnam[] = "SIMLIB_storeCadence_CACHE" ;
 
-      // 2. sanity checks to catch crazy [nan] values. Second arg is NVAL=1
-      checkval_D("ZPTAVG", 1, &SIMLIB_OBS_RAW.ZPTADU[ISTORE],  6.0, 50.0) ;
-      checkval_D("ZPTSIG", 1, &SIMLIB_OBS_RAW.ZPTSIG[ISTORE],  0.0, 5.0 ) ;
-      checkval_D("PSF1",   1, &SIMLIB_OBS_RAW.PSFSIG1[ISTORE], 0.0, 9.9 );
-      checkval_D("PSF2",   1, &SIMLIB_OBS_RAW.PSFSIG2[ISTORE], 0.0, 9.9 );
-      checkval_D("PSFrat", 1, &SIMLIB_OBS_RAW.PSFRATIO[ISTORE],0.0, 1.0 );
-      checkval_D("SKYSIG", 1, &SIMLIB_OBS_RAW.SKYSIG[ISTORE],  0.0, 1.0E5 );
+  // ------------ BEGIN -------------
 
-      PIXSIZE = SIMLIB_OBS_RAW.PIXSIZE[ISTORE] ; 
+  if ( SIMLIB_LIST_forSORT.NMJD != NOBS ) {
+    sprintf(c1err,"NMJD(sort)=%d != NOBS=%d for LIBID=%d", 
+	    SIMLIB_LIST_forSORT.NMJD, NOBS, SIMLIB_HEADER.LIBID );
+    sprintf(c2err,"Cannot store this cadence in SIMLIB_CACHE.");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
+  }
+
+  if ( ILIBID == SIMLIB_CACHE.MXLIBID ) {
+    SIMLIB_CACHE.MXLIBID *= 2 ;
+    SIMLIB_CACHE.LIBID = (SIMLIB_CACHE_LIBID_DEF*)
+      realloc(SIMLIB_CACHE.LIBID, 
+	      SIMLIB_CACHE.MXLIBID * sizeof(SIMLIB_CACHE_LIBID_DEF) );
+    SIMLIB_CACHE.MEMORY += (double)(ILIBID*sizeof(SIMLIB_CACHE_LIBID_DEF));
+  }
+
+  CACHE = &SIMLIB_CACHE.LIBID[ILIBID] ;
+  CACHE->HEADER            = SIMLIB_HEADER ;
+  CACHE->NOBS_HEADER_READ  = NOBS_HEADER_READ ;
+  CACHE->NOBS              = NOBS ;
+  CACHE->NOBS_READ         = SIMLIB_OBS_RAW.NOBS_READ ;
+  CACHE->NOBS_SPECTROGRAPH = SIMLIB_OBS_RAW.NOBS_SPECTROGRAPH ;
+  CACHE->NMJD              = SIMLIB_LIST_forSORT.NMJD ;
+
+  CACHE->OBS = (SIMLIB_CACHE_OBS_DEF*)
+    malloc( NOBS * sizeof(SIMLIB_CACHE_OBS_DEF) );
+  SIMLIB_CACHE.MEMORY += (double)(NOBS * sizeof(SIMLIB_CACHE_OBS_DEF)) ;
+
+  for(obs=0; obs < NOBS; obs++ ) {
+    OBS = &CACHE->OBS[obs] ;
+    OBS->MJD                  = SIMLIB_OBS_RAW.MJD[obs] ;
+    OBS->CCDGAIN              = SIMLIB_OBS_RAW.CCDGAIN[obs] ;
+    OBS->READNOISE            = SIMLIB_OBS_RAW.READNOISE[obs] ;
+    OBS->SKYSIG               = SIMLIB_OBS_RAW.SKYSIG[obs] ;
+    OBS->PSFSIG1              = SIMLIB_OBS_RAW.PSFSIG1[obs] ;
+    OBS->PSFSIG2              = SIMLIB_OBS_RAW.PSFSIG2[obs] ;
+    OBS->PSFRATIO             = SIMLIB_OBS_RAW.PSFRATIO[obs] ;
+    OBS->ZPTADU               = SIMLIB_OBS_RAW.ZPTADU[obs] ;
+    OBS->ZPTSIG               = SIMLIB_OBS_RAW.ZPTSIG[obs] ;
+    OBS->MAG                  = SIMLIB_OBS_RAW.MAG[obs] ;
+    OBS->PIXSIZE              = SIMLIB_OBS_RAW.PIXSIZE[obs] ;
+    OBS->TEXPOSE_SPECTROGRAPH = SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[obs] ;
+    OBS->TEMPLATE_SKYSIG      = SIMLIB_OBS_RAW.TEMPLATE_SKYSIG[obs] ;
+    OBS->TEMPLATE_READNOISE   = SIMLIB_OBS_RAW.TEMPLATE_READNOISE[obs] ;
+    OBS->TEMPLATE_ZPT         = SIMLIB_OBS_RAW.TEMPLATE_ZPT[obs] ;
+    OBS->OPTLINE              = SIMLIB_OBS_RAW.OPTLINE[obs] ;
+    OBS->IFILT_OBS            = SIMLIB_OBS_RAW.IFILT_OBS[obs] ;
+    OBS->IDEXPT               = SIMLIB_OBS_RAW.IDEXPT[obs] ;
+    OBS->NEXPOSE              = SIMLIB_OBS_RAW.NEXPOSE[obs] ;
+    OBS->APPEND_PHOTFLAG      = SIMLIB_OBS_RAW.APPEND_PHOTFLAG[obs] ;
+    OBS->ISEASON              = SIMLIB_OBS_RAW.ISEASON[obs] ;
+    OBS->IFILT_SPECTROGRAPH   = SIMLIB_OBS_RAW.IFILT_SPECTROGRAPH[obs] ;
+    OBS->INDX_TAKE_SPECTRUM   = SIMLIB_OBS_RAW.INDX_TAKE_SPECTRUM[obs] ;
+    OBS->INDEX_SORT           = SIMLIB_LIST_forSORT.INDEX_SORT[obs] ;
+    OBS->ISTR_FIELD = get_SIMLIB_CACHE_ISTR(SIMLIB_OBS_RAW.FIELDNAME[obs]);
+    OBS->ISTR_TEL   = get_SIMLIB_CACHE_ISTR(SIMLIB_OBS_RAW.TELESCOPE[obs]);
+    sprintf(OBS->BAND, "%s", SIMLIB_OBS_RAW.BAND[obs] );
+  }
+
+  // correlated template noise for each overlapping field
+  CACHE->USEFLAG_TEMPLATE   = SIMLIB_TEMPLATE.USEFLAG ;
+  CACHE->NFIELD_OVP         = SIMLIB_TEMPLATE.NFIELD_OVP ;
+  CACHE->TEXPOSE_SPECTROGRAPH_TEMPLATE = SIMLIB_TEMPLATE.TEXPOSE_SPECTROGRAPH;
+  CACHE->TEMPLATE_FIELDNAME = NULL ;
+  CACHE->TEMPLATE_NOISE     = NULL ;
+  if ( SIMLIB_TEMPLATE.USEFLAG & 1 ) {
+    NFIELD = SIMLIB_TEMPLATE.NFIELD_OVP + 1 ;
+    MEMF   = NFIELD * MXCHAR_FIELDNAME ;
+    MEMN   = NFIELD * 3 * MXFILTINDX * sizeof(double) ;
+    CACHE->TEMPLATE_FIELDNAME = malloc(MEMF);
+    CACHE->TEMPLATE_NOISE     = (double*)malloc(MEMN);
+    SIMLIB_CACHE.MEMORY += (double)(MEMF + MEMN);
+    memcpy(CACHE->TEMPLATE_FIELDNAME, SIMLIB_TEMPLATE.FIELDNAME, MEMF);
+    for(obs=0; obs < NFIELD; obs++ ) {
+      memcpy(&CACHE->TEMPLATE_NOISE[(3*obs+0)*MXFILTINDX],
+	     SIMLIB_TEMPLATE.SKYSIG[obs],    MXFILTINDX*sizeof(double) );
+      memcpy(&CACHE->TEMPLATE_NOISE[(3*obs+1)*MXFILTINDX],
+	     SIMLIB_TEMPLATE.READNOISE[obs], MXFILTINDX*sizeof(double) );
+      memcpy(&CACHE->TEMPLATE_NOISE[(3*obs+2)*MXFILTINDX],
+	     SIMLIB_TEMPLATE.ZPT[obs],       MXFILTINDX*sizeof(double) );
+    }
+  }
+
+  SIMLIB_CACHE.NLIBID++ ;
+
+} // end SIMLIB_storeCadence_CACHE
 
-      // 3a. unit check for optional units of PSF and SKYSIG
-      UNIT = SIMLIB_GLOBAL_HEADER.PSF_UNIT ;
-      if ( strcmp(UNIT,SIMLIB_PSF_ASECFWHM ) == 0 ) {
-	PSF_ORIG = SIMLIB_OBS_RAW.PSFSIG1[ISTORE] ;
-	// convert FWHM(arcsec) back to Sigma(pixels)
-	SIMLIB_OBS_RAW.PSFSIG1[ISTORE] /= (PIXSIZE * FWHM_SIGMA_RATIO);
-	SIMLIB_OBS_RAW.PSFSIG2[ISTORE] /= (PIXSIZE * FWHM_SIGMA_RATIO);
-      }
-      
-      // 3b. check for optional units of SKYSIG
-      UNIT = SIMLIB_GLOBAL_HEADER.SKYSIG_UNIT ;
-      if ( strcmp(UNIT,SIMLIB_SKYSIG_SQASEC ) == 0 ) {
-	// convert SKYSIG per sqrt(asec^2) back into pixel
-	SIMLIB_OBS_RAW.SKYSIG[ISTORE] *= PIXSIZE ;
-      }
-      
-    } // end ISTORE loop over everything read from cadence
 
-    // -------------------------------------------
-    // 1b. sort MJDs for new LIBID only 
+// ==============================================
+void SIMLIB_readNextCadence_CACHE(void) {
 
-    SIMLIB_sortbyMJD();
+  // Created Oct 2026
+  // Restore next cadence from SIMLIB_CACHE that passes 
+  // keep_SIMLIB_HEADER cuts; the restored cadence is already 
+  // SPECTROGRAPH-expanded, MJD-sorted and season-split.
+  // Global counters in SIMLIB_HEADER are not restored.
 
-  } // end NEW_CADENCE 
+  struct SIMLIB_HEADER HEADER_LAST ;
+  SIMLIB_CACHE_LIBID_DEF *CACHE ;
+  SIMLIB_CACHE_OBS_DEF   *OBS ;
+  int ILIBID, obs, NOBS, NFIELD ;
 
-  // - - - - - - - - - - - - - - - - - - - 
-  // chop MJD range into seasons to allow user options
-  store_SIMLIB_SEASONS();
-
-  // - - - - - - -
-  int isort, ifilt, IFILT_OBS, NEXPOSE, KEEP, NEP, NEP_NEWMJD ;
-  int  IFLAG_SYNFILT, IFLAG_TEMPLATE, IFIELD, APP ;
-  double MJD, CCDGAIN, RDNOISE, SKYSIG, PSF[3], ZPT[2], MAG ;
-  double SKYSIG_T, RDNOISE_T, ZPT_T ;
-  double SHIFT_ZPT, SCALE_SKYSIG, SCALE_RDNOISE, SCALE_PSF ;
-  double MJD_DIF, MJD_LAST_KEEP, DT, DUMMY_STORE[3] ;
-  char   *TEL, *FIELD, cfilt[2];
-
-  // init stuff before loop over MJDs
-  NEP=NEP_NEWMJD=0;  MJD_LAST_KEEP=-9.0;  
-
-  // transfer OBS_RAW to OBS_GEN; latter has cuts and is sorted by MJD
-
-  for ( isort = 0; isort < NOBS_RAW; isort++ ) {
+  // ------------ BEGIN -------------
 
-    OBSRAW   = SIMLIB_LIST_forSORT.INDEX_SORT[isort]; 
-    OPTLINE  = SIMLIB_OBS_RAW.OPTLINE[OBSRAW] ;
+  SIMLIB_HEADER.NWRAP = 0 ;
 
-    if ( OPTLINE < 0 ) { continue; }
+  while ( 1 ) {
 
-    if ( OPTLINE == OPTLINE_SIMLIB_SPECTROGRAPH ) {
-      ifilt = SIMLIB_OBS_RAW.IFILT_SPECTROGRAPH[OBSRAW]; //sparse synth index
-      DUMMY_STORE[0] = DUMMY_STORE[1] = -9.0 ;
-      store_SIMLIB_SPECTROGRAPH(ifilt, DUMMY_STORE, OBSRAW) ;
+    if ( SIMLIB_CACHE.ILIBID_NEXT >= SIMLIB_CACHE.NLIBID ) {
+      SIMLIB_CACHE.ILIBID_NEXT = 0 ;
+      SIMLIB_HEADER.NWRAP++ ;
+      // check SIMLIB after 5 passes to avoid infinite loop
+      if ( SIMLIB_HEADER.NWRAP >= 5 )  { ENDSIMLIB_check(); }
     }
 
-    // strip off SIMLIB variables for this sorted MJD
-    MJD        = SIMLIB_OBS_RAW.MJD[OBSRAW] ;
-    CCDGAIN    = SIMLIB_OBS_RAW.CCDGAIN[OBSRAW] ;
-    RDNOISE    = SIMLIB_OBS_RAW.READNOISE[OBSRAW] ;
-    SKYSIG     = SIMLIB_OBS_RAW.SKYSIG[OBSRAW] ;
-    PSF[0]     = SIMLIB_OBS_RAW.PSFSIG1[OBSRAW] ;
-    PSF[1]     = SIMLIB_OBS_RAW.PSFSIG2[OBSRAW] ;
-    PSF[2]     = SIMLIB_OBS_RAW.PSFRATIO[OBSRAW] ;
-    ZPT[0]     = SIMLIB_OBS_RAW.ZPTADU[OBSRAW] ;
-    ZPT[1]     = SIMLIB_OBS_RAW.ZPTSIG[OBSRAW] ;
-    PIXSIZE    = SIMLIB_OBS_RAW.PIXSIZE[OBSRAW];
-    MAG        = SIMLIB_OBS_RAW.MAG[OBSRAW] ;
-    IFILT_OBS  = SIMLIB_OBS_RAW.IFILT_OBS[OBSRAW] ;
-    NEXPOSE    = SIMLIB_OBS_RAW.NEXPOSE[OBSRAW] ;
-    BAND       = SIMLIB_OBS_RAW.BAND[OBSRAW];
-    FIELD      = SIMLIB_OBS_RAW.FIELDNAME[OBSRAW];
-    TEL        = SIMLIB_OBS_RAW.TELESCOPE[OBSRAW];   
-    APP        = SIMLIB_OBS_RAW.APPEND_PHOTFLAG[OBSRAW];   
+    ILIBID = SIMLIB_CACHE.ILIBID_NEXT++ ;
+    CACHE  = &SIMLIB_CACHE.LIBID[ILIBID] ;
+
+    HEADER_LAST   = SIMLIB_HEADER ;
+    SIMLIB_HEADER = CACHE->HEADER ;
+    SIMLIB_HEADER.NWRAP        = HEADER_LAST.NWRAP ;
+    SIMLIB_HEADER.NREPEAT      = HEADER_LAST.NREPEAT ;
+    SIMLIB_HEADER.NFOUND_TOT   = HEADER_LAST.NFOUND_TOT ;
+    SIMLIB_HEADER.NFOUND_MJD   = HEADER_LAST.NFOUND_MJD ;
+    SIMLIB_HEADER.NFOUND_RA    = HEADER_LAST.NFOUND_RA ;
+    SIMLIB_HEADER.NFOUND_DEC   = HEADER_LAST.NFOUND_DEC ;
+    SIMLIB_HEADER.NFOUND_FIELD = HEADER_LAST.NFOUND_FIELD ;
+    SIMLIB_HEADER.NOBS         = CACHE->NOBS_HEADER_READ ;
+
+    SIMLIB_randomize_skyCoords();
+    if ( keep_SIMLIB_HEADER() == ACCEPT_FLAG ) { break ; }
+  }
+
+  SIMLIB_HEADER.NOBS = NOBS = CACHE->NOBS ;
+  SIMLIB_OBS_RAW.NOBS              = NOBS ;
+  SIMLIB_OBS_RAW.NOBS_READ         = CACHE->NOBS_READ ;
+  SIMLIB_OBS_RAW.NOBS_SPECTROGRAPH = CACHE->NOBS_SPECTROGRAPH ;
+  SIMLIB_LIST_forSORT.NMJD         = CACHE->NMJD ;
+
+  for(obs=0; obs < NOBS; obs++ ) {
+    OBS = &CACHE->OBS[obs] ;
+    SIMLIB_OBS_RAW.MJD[obs]                  = OBS->MJD ;
+    SIMLIB_OBS_RAW.CCDGAIN[obs]              = OBS->CCDGAIN ;
+    SIMLIB_OBS_RAW.READNOISE[obs]            = OBS->READNOISE ;
+    SIMLIB_OBS_RAW.SKYSIG[obs]               = OBS->SKYSIG ;
+    SIMLIB_OBS_RAW.PSFSIG1[obs]              = OBS->PSFSIG1 ;
+    SIMLIB_OBS_RAW.PSFSIG2[obs]              = OBS->PSFSIG2 ;
+    SIMLIB_OBS_RAW.PSFRATIO[obs]             = OBS->PSFRATIO ;
+    SIMLIB_OBS_RAW.ZPTADU[obs]               = OBS->ZPTADU ;
+    SIMLIB_OBS_RAW.ZPTSIG[obs]               = OBS->ZPTSIG ;
+    SIMLIB_OBS_RAW.MAG[obs]                  = OBS->MAG ;
+    SIMLIB_OBS_RAW.PIXSIZE[obs]              = OBS->PIXSIZE ;
+    SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[obs] = OBS->TEXPOSE_SPECTROGRAPH ;
+    SIMLIB_OBS_RAW.TEMPLATE_SKYSIG[obs]      = OBS->TEMPLATE_SKYSIG ;
+    SIMLIB_OBS_RAW.TEMPLATE_READNOISE[obs]   = OBS->TEMPLATE_READNOISE ;
+    SIMLIB_OBS_RAW.TEMPLATE_ZPT[obs]         = OBS->TEMPLATE_ZPT ;
+    SIMLIB_OBS_RAW.OPTLINE[obs]              = OBS->OPTLINE ;
+    SIMLIB_OBS_RAW.IFILT_OBS[obs]            = OBS->IFILT_OBS ;
+    SIMLIB_OBS_RAW.IDEXPT[obs]               = OBS->IDEXPT ;
+    SIMLIB_OBS_RAW.NEXPOSE[obs]              = OBS->NEXPOSE ;
+    SIMLIB_OBS_RAW.APPEND_PHOTFLAG[obs]      = OBS->APPEND_PHOTFLAG ;
+    SIMLIB_OBS_RAW.ISEASON[obs]              = OBS->ISEASON ;
+    SIMLIB_OBS_RAW.IFILT_SPECTROGRAPH[obs]   = OBS->IFILT_SPECTROGRAPH ;
+    SIMLIB_OBS_RAW.INDX_TAKE_SPECTRUM[obs]   = OBS->INDX_TAKE_SPECTRUM ;
+    SIMLIB_LIST_forSORT.INDEX_SORT[obs]      = OBS->INDEX_SORT ;
+    sprintf(SIMLIB_OBS_RAW.FIELDNAME[obs], "%s", 
+	    SIMLIB_CACHE.STRLIST[OBS->ISTR_FIELD] );
+    sprintf(SIMLIB_OBS_RAW.TELESCOPE[obs], "%s", 
+	    SIMLIB_CACHE.STRLIST[OBS->ISTR_TEL] );
+    sprintf(SIMLIB_OBS_RAW.BAND[obs], "%s", OBS->BAND );
+  }
+
+  // restore correlated template noise
+  SIMLIB_TEMPLATE.USEFLAG   |= CACHE->USEFLAG_TEMPLATE ;
+  SIMLIB_TEMPLATE.NFIELD_OVP = CACHE->NFIELD_OVP ;
+  SIMLIB_TEMPLATE.TEXPOSE_SPECTROGRAPH = CACHE->TEXPOSE_SPECTROGRAPH_TEMPLATE;
+  if ( CACHE->TEMPLATE_NOISE != NULL ) {
+    NFIELD = CACHE->NFIELD_OVP + 1 ;
+    memcpy(SIMLIB_TEMPLATE.FIELDNAME, CACHE->TEMPLATE_FIELDNAME,
+	   NFIELD * MXCHAR_FIELDNAME );
+    for(obs=0; obs < NFIELD; obs++ ) {
+      memcpy(SIMLIB_TEMPLATE.SKYSIG[obs], 
+	     &CACHE->TEMPLATE_NOISE[(3*obs+0)*MXFILTINDX],
+	     MXFILTINDX*sizeof(double) );
+      memcpy(SIMLIB_TEMPLATE.READNOISE[obs], 
+	     &CACHE->TEMPLATE_NOISE[(3*obs+1)*MXFILTINDX],
+	     MXFILTINDX*sizeof(double) );
+      memcpy(SIMLIB_TEMPLATE.ZPT[obs], 
+	     &CACHE->TEMPLATE_NOISE[(3*obs+2)*MXFILTINDX],
+	     MXFILTINDX*sizeof(double) );
+    }
+  }
+
+} // end SIMLIB_readNextCadence_CACHE
 
-    RDNOISE_T  = SIMLIB_OBS_RAW.TEMPLATE_READNOISE[OBSRAW] ;
-    SKYSIG_T   = SIMLIB_OBS_RAW.TEMPLATE_SKYSIG[OBSRAW] ;
-    ZPT_T      = SIMLIB_OBS_RAW.TEMPLATE_ZPT[OBSRAW] ;
 
-    // compute a few things from OBS_RAW
-    if ( INPUTS.SMEARFLAG_ZEROPT == 0 ) { ZPT[1] = 0.0 ; }
-    if ( MAG < 5.0 || MAG > 50 ) { MAG = MAG_UNDEFINED ; }
-    sprintf(cfilt,  "%c", FILTERSTRING[IFILT_OBS] ) ;
+// ==============================================
+int SIMLIB_findStart_CACHE(int NSKIP_LIBID, int IDSEEK) {
 
-    ifilt     = GENLC.IFILTINVMAP_SIMLIB[IFILT_OBS] ;
-    if ( ifilt < 0 || ifilt >= GENLC.NFILTDEF_SIMLIB ) 
-      {  ABORT_SIMLIB_FILTER(isort);  }
-    //      {  ABORT_SIMLIB_FILTER(OPTLINE,MJD,cfilt);  }
+  // Created Oct 2026
+  // Return SIMLIB_CACHE index to start reading; 
+  // IDSEEK > 0 -> first cached LIBID >= IDSEEK,
+  // else skip NSKIP_LIBID LIBIDs from the start of the SIMLIB,
+  // noting that the cache starts after NSKIP_START LIBIDs.
 
-    // check if this MJD is kept.
-    KEEP = keep_SIMLIB_OBS(isort,REPEAT_CADENCE);
+  int NLIBID = SIMLIB_CACHE.NLIBID ;
+  int ILIBID, NSKIP ;
+  char fnam[] = "SIMLIB_findStart_CACHE" ;
 
-    if ( GENLC.SIMLIB_ID < -99 ) {
-      printf(" xxx isort=%3d OBSRAW=%3d  IFILT_OBS=%2d(%s) "
-	     "MJD=%.3f  KEEP=%d\n",
-	     isort, OBSRAW, IFILT_OBS, BAND, MJD, KEEP ); // xxxxxx
-      fflush(stdout);
-    }
+  // ------------ BEGIN -------------
 
-    if ( KEEP == 0 ) { continue ; }
+  if ( IDSEEK > 0 ) {
+    for(ILIBID=0; ILIBID < NLIBID; ILIBID++ ) {
+      if ( SIMLIB_CACHE.LIBID[ILIBID].HEADER.LIBID >= IDSEEK ) 
+	{ return(ILIBID); }
+    }
+    sprintf(c1err,"Could not find LIBID >= %d in SIMLIB_CACHE", IDSEEK);
+    sprintf(c2err,"Check SIMLIB_IDSTART/SIMLIB_IDLOCK and SIMLIB_CACHE");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
+  }
 
-    // mark this filter as 'used'
-    GENLC.SIMLIB_USEFILT_ENTRY[IFILT_OBS] = 1;
+  NSKIP = 0 ;
+  if ( NSKIP_LIBID > 0 ) { NSKIP = NSKIP_LIBID ; }
+  NSKIP -= SIMLIB_CACHE.NSKIP_START ;
+  ILIBID = NSKIP % NLIBID ;
+  if ( ILIBID < 0 ) { ILIBID += NLIBID ; }
 
-    // get optional fudge scales
-    get_SIMLIB_SCALES(IFILT_OBS, &SHIFT_ZPT, &SCALE_SKYSIG, &SCALE_RDNOISE);
-    SCALE_PSF = INPUTS.FUDGESCALE_PSF ;
+  return(ILIBID);
 
-    NEP++; 
-    GENLC.NEPOCH = NEP ;
+} // end SIMLIB_findStart_CACHE
 
-    if ( NEP >= MXEPSIM ) {
-      sprintf(c1err, "NEPOCH = %d exceeds array bound at LIBID=%d", 
-	      NEP, GENLC.SIMLIB_ID );
-      sprintf(c2err, "Either increase MXEPSIM or reduce library size.");
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
-    }
 
-    // determine epoch for trigger; either new epoch, or same as before.
-    MJD_DIF = MJD - MJD_LAST_KEEP ;
-    if ( fabs(MJD_DIF) > INPUTS.NEWMJD_DIF ) {
-      NEP_NEWMJD++; 
-      GENLC.NEWMJD = NEP_NEWMJD ;
-      GENLC.EPOCH_RANGE_NEWMJD[NEP_NEWMJD][0] = NEP ;
-    }
-    GENLC.EPOCH_RANGE_NEWMJD[NEP_NEWMJD][1] = NEP ;
+// ==============================================
+void get_SIMLIB_CACHE_ISORT_RANGE(int *ISORT_MIN, int *ISORT_MAX) {
 
-    
-    // store a few things in GENLC struct
-    GENLC.IFILT_OBS[NEP]     = IFILT_OBS;
-    GENLC.genmag8_obs[NEP]   = MAG ;
-    GENLC.MJD[NEP]           = MJD ;
-    sprintf( GENLC.FIELDNAME[NEP], "%s", FIELD );
-    sprintf( GENLC.TELESCOPE[NEP], "%s", TEL   );
+  // Created Oct 2026
+  // For MJD-sorted cadence from SIMLIB_CACHE, return range of 
+  // sort indices that can pass the MJD window in keep_SIMLIB_OBS.
+  // Range is padded so that duplicate-MJD offsets from sorting 
+  // cannot remove any MJD; keep_SIMLIB_OBS still applies exact cut.
+  // Full range is returned for unsorted APPEND or SPECTROGRAPH obs.
 
-    // store SIMLIB_GEN quanties vs. NEP that include fudges                  
-    SIMLIB_OBS_GEN.MJD[NEP]         = MJD ;
-    SIMLIB_OBS_GEN.IFILT_OBS[NEP]   = IFILT_OBS ;
-    SIMLIB_OBS_GEN.PIXSIZE[NEP]     = PIXSIZE ;
-    SIMLIB_OBS_GEN.CCDGAIN[NEP]     = CCDGAIN ;
-    SIMLIB_OBS_GEN.READNOISE[NEP]   = RDNOISE * SCALE_RDNOISE ;
-    SIMLIB_OBS_GEN.SKYSIG[NEP]      = SKYSIG * SCALE_SKYSIG ;
-    SIMLIB_OBS_GEN.PSFSIG1[NEP]     = PSF[0] * SCALE_PSF ;
-    SIMLIB_OBS_GEN.PSFSIG2[NEP]     = PSF[1] * SCALE_PSF ;
-    SIMLIB_OBS_GEN.PSFRATIO[NEP]    = PSF[2] ;  // ratio                      
-    SIMLIB_OBS_GEN.ZPTADU[NEP]      = ZPT[0] + SHIFT_ZPT ;
-    SIMLIB_OBS_GEN.ZPTSIG[NEP]      = ZPT[1] ;
-    SIMLIB_OBS_GEN.MAG[NEP]         = MAG ;
-    SIMLIB_OBS_GEN.NEXPOSE[NEP]     = NEXPOSE ;
-    SIMLIB_OBS_GEN.ISTORE_RAW[NEP]  = OBSRAW ;
-    SIMLIB_OBS_GEN.APPEND_PHOTFLAG[NEP] = APP ;
-    sprintf(SIMLIB_OBS_GEN.TELESCOPE[NEP], "%s", TEL   );
-    sprintf(SIMLIB_OBS_GEN.FIELDNAME[NEP], "%s", FIELD );
+  int    NMJD  = SIMLIB_LIST_forSORT.NMJD ;
+  int    *SORT = SIMLIB_LIST_forSORT.INDEX_SORT ;
+  double DTPAD = 0.01 ;
+  double MJDrange[2] ;
+  int    LO, HI, MID ;
 
-    SIMLIB_OBS_GEN.TEXPOSE_SPECTROGRAPH[NEP] =
-      SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[OBSRAW] ;
-    SIMLIB_OBS_GEN.INDX_TAKE_SPECTRUM[NEP] =
-      SIMLIB_OBS_RAW.INDX_TAKE_SPECTRUM[OBSRAW] ;
+  // ------------ BEGIN -------------
 
-    // - --  store correlated template info ... - - - -                       
-    IFLAG_SYNFILT  = GENLC.IFLAG_SYNFILT_SPECTROGRAPH[IFILT_OBS] ;
-    IFLAG_TEMPLATE = SIMLIB_TEMPLATE.USEFLAG ;
+  *ISORT_MIN = 0 ;  *ISORT_MAX = NMJD ;
 
-    // check template noise for synthetic filters from spectrograph           
-    if ( (IFLAG_TEMPLATE & 2)>0 && IFLAG_SYNFILT==1 ) {
-      SIMLIB_OBS_GEN.TEMPLATE_SKYSIG[NEP]    = SKYSIG_T ;
-      SIMLIB_OBS_GEN.TEMPLATE_READNOISE[NEP] = RDNOISE_T ;
-      SIMLIB_OBS_GEN.TEMPLATE_ZPT[NEP]       = ZPT_T ;
-    }
+  if ( SIMLIB_HEADER.NOBS_APPEND > 0 )        { return ; }
+  if ( SIMLIB_OBS_RAW.NOBS_SPECTROGRAPH > 0 ) { return ; }
 
+  set_SIMLIB_MJDrange(2,MJDrange);
+  if ( MJDrange[1] < 0.0 ) { return ; } // let keep_SIMLIB_OBS reject all
 
-    // check template noise for normal filters                                
-    if ( (IFLAG_TEMPLATE & 1)>0 && IFLAG_SYNFILT == 0 ) {
+  // first isort with MJD >= MJDrange[0]-DTPAD
+  LO = 0;  HI = NMJD ;
+  while ( LO < HI ) {
+    MID = (LO+HI)/2 ;
+    if ( SIMLIB_OBS_RAW.MJD[SORT[MID]] < MJDrange[0]-DTPAD ) 
+      { LO = MID+1 ; }    
+    else
+      { HI = MID ; }
+  }
+  *ISORT_MIN = LO ;
 
-      IFIELD = IFIELD_OVP_SIMLIB(1,FIELD);
-      if ( IFIELD < 0 || IFIELD >= MXFIELD_OVP_SIMLIB ) {
-	sprintf(c1err,"Invalid IFIELD=%d for template FIELD=%s",IFIELD,FIELD);
-	sprintf(c2err, "Check LIBID=%d  %s-band", GENLC.SIMLIB_ID,cfilt );
-	errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ;
-      }  
+  // first isort with MJD > MJDrange[1]+DTPAD
+  HI = NMJD ;
+  while ( LO < HI ) {
+    MID = (LO+HI)/2 ;
+    if ( SIMLIB_OBS_RAW.MJD[SORT[MID]] <= MJDrange[1]+DTPAD ) 
+      { LO = MID+1 ; }    
+    else
+      { HI = MID ; }
+  }
+  *ISORT_MAX = LO ;
 
-      SKYSIG_T = SIMLIB_TEMPLATE.SKYSIG[IFIELD][IFILT_OBS] * SCALE_SKYSIG ;
-      SIMLIB_OBS_GEN.TEMPLATE_SKYSIG[NEP]    = SKYSIG_T ;	
-      SIMLIB_OBS_RAW.TEMPLATE_SKYSIG[OBSRAW] = SKYSIG_T ;
-      
-      RDNOISE_T = SIMLIB_TEMPLATE.READNOISE[IFIELD][IFILT_OBS]*SCALE_RDNOISE ;
-      SIMLIB_OBS_GEN.TEMPLATE_READNOISE[NEP]    = RDNOISE_T ;	
-      SIMLIB_OBS_RAW.TEMPLATE_READNOISE[OBSRAW] = RDNOISE_T ;
+} // end get_SIMLIB_CACHE_ISORT_RANGE
 
-      ZPT_T = SIMLIB_TEMPLATE.ZPT[IFIELD][IFILT_OBS] + SHIFT_ZPT ;
-      SIMLIB_OBS_GEN.TEMPLATE_ZPT[NEP]    = ZPT_T ;	
-      SIMLIB_OBS_RAW.TEMPLATE_ZPT[OBSRAW] = ZPT_T ;
 
-    } // end template 
+// ==============================================
+void SIMLIB_randomize_skyCoords(void) {
 
-    MJD_LAST_KEEP = MJD ;
-  
-    // keep track of MJD nearest peak
-    DT = MJD - GENLC.PEAKMJD ; 
-    if ( fabs(DT) < fabs(GENLC.DTPEAK_MIN) ) 
-      { GENLC.IEPOCH_NEARPEAK = NEP ; GENLC.DTPEAK_MIN   = DT ;  }
+  // Created Aug 24 2018
+  //
+  // Check option to randomly shift 
+  //   SIMLIB_HEADER.RA 
+  //   SIMLIB_HEADER.DEC
+  // To avoid fixed set of RA,DEC from SIMLIB.
+  //
+  // Initial function is just a do-nothing shell;
+  // waiting to get C function that picks randonly
+  // within healPix area.
 
+  char fnam[] = "SIMLIB_randomize_skyCoords" ;
 
-  } // end isort loop (REFACTOR)
+  // --------------- BEGIN -------------
 
   return ;
 
-} // end SIMLIB_prepCadence
+} // end SIMLIB_randomize_skyCoords
 
 
-// ====================================================	
-void store_SIMLIB_SPECTROGRAPH(int ifilt, double *VAL_STORE, int ISTORE) {
+// ==============================================
+int keep_SIMLIB_HEADER(void) {
 
-  // Read info following SPECTROGRAPH key in SIMLIB,
-  // and store in SIMLIB_OBS_RAW struct.
-  //
-  // Inputs:
-  //  ifilt     --> sparse spectrograph-filter index
-  //  VAL_STORE --> MJD,TEXPOSE,INDX_TAKE_SPECTRUM  if MJD > 0
-  //  ISTORE    --> storage index for SIMLIB_OBS_RAW
-  //
-  // When ifilt=0, read rest of SIMLIB line
-  //
-  //
-  // Aug 22 2017: remove *fp argument and use fp_SIMLIB for LEGACY only.
-  //              Change is made to work with refactored SIMLIB routines.
-  //
-  //
-  // Aug 23 2017: as part of refactor move lots of local code 
-  //              into new functino get_SPECTROGRAPH_ZPTPSFSKY
+  // Created Aug 2017
+  // Return ACCEPT_FLAG if SIMLIB_HEADER values pass cuts.
+  // Return REJECT_FLAG if SIMLIB_HEADER fails cuts, or REWIND flag is set
   //
 
-  int    LDMP = ( ifilt < 0 ) ;
-  int    ifilt_obs, IFLAG_TEMPLATE, LCUT;
-  int    INDX_TAKE_SPECTRUM ;
-  double MJD, TEXPOSE_S, TEXPOSE_T ;
-  double ZPT, SKYSIG_S,  SKYSIG_T, PSFSIG  ;
-
-  double TSCALE = INPUTS.SPECTROGRAPH_OPTIONS.SCALE_TEXPOSE ;
+  int  ID      = SIMLIB_HEADER.LIBID ;
+  int  NOBS    = SIMLIB_HEADER.NOBS ;
+  int  IDLOCK  = GENLC.SIMLIB_IDLOCK ;
+  int  NSKIP   = INPUTS.NSKIP_SIMLIB ;
+  int  NWRAP   = SIMLIB_HEADER.NWRAP ;
+  double  zCMB = GENLC.REDSHIFT_CMB ;
+  int  iskip, icheck ;
+  double *ptrGen ;
+  char fnam[] = "keep_SIMLIB_HEADER" ;
+  int LTRACE = 0 ;
 
-  char   cfilt[2] ;
-  char   fnam[] = "store_SIMLIB_SPECTROGRAPH" ;
+  // ----------- BEGIN ---------------
 
-  // --------------- BEGIN ---------------
+  if(LTRACE) {
+    printf(" xxx %s: ----------- ID=%d ------------ \n", 
+	   fnam, GENLC.SIMLIB_ID );
+  }
 
-  // strip off MJD and TEXPOSE from 1st time these
-  // quantites were read (i.e., for ISTORE at ifilt=0)
-  if ( ifilt == 0 ) {
+  if(LTRACE) {printf(" xxx %s: 0  IDLOCK=%d \n", fnam, IDLOCK);}
+  if ( IDLOCK >= 0 && IDLOCK != ID ) 
+    { return(REJECT_FLAG); }
 
-    if ( VAL_STORE[0] < 0.0 ) {
+  if(LTRACE) {printf(" xxx %s: 1  NSKIP=%d \n", fnam, NSKIP );}
+  for ( iskip=0; iskip < NSKIP; iskip++ ) {
+    if ( ID == INPUTS.SIMLIB_IDSKIP[iskip] ) 
+      { return(REJECT_FLAG); }
+  }
 
-      MJD       = SIMLIB_OBS_RAW.MJD[ISTORE] ;
-      TEXPOSE_S = SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[ISTORE] ;
-      INDX_TAKE_SPECTRUM  = SIMLIB_OBS_RAW.INDX_TAKE_SPECTRUM[ISTORE];
+  if(LTRACE) {printf(" xxx %s: 2  NWRAP=%d \n", fnam, NWRAP );}
+  if ( NWRAP > 0 && (SIMLIB_HEADER.LIBID == SIMLIB_ID_REWIND) )
+    { return(REJECT_FLAG); }
 
-      VAL_STORE[0] = MJD ;
-      VAL_STORE[1] = TEXPOSE_S ;
-      VAL_STORE[2] = (double)INDX_TAKE_SPECTRUM ;
-    }
-    else {
-      // use passed arguments from TAKE_SPECTRUM
-      MJD                     = VAL_STORE[0] ;
-      TEXPOSE_S               = VAL_STORE[1] ;
-      INDX_TAKE_SPECTRUM      = (int)VAL_STORE[2] ;
-    }
-
-    SIMLIB_OBS_RAW.MJD[ISTORE]                  = MJD ;
-    SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[ISTORE] = TEXPOSE_S * TSCALE ;
-    SIMLIB_OBS_RAW.INDX_TAKE_SPECTRUM[ISTORE]   = INDX_TAKE_SPECTRUM ; 
-
-    store_GENSPEC(VAL_STORE) ; // Mar 20 2017
-
-    SIMLIB_OBS_RAW.MJD[ISTORE]  = VAL_STORE[0]; // in case MJD changes
+  if(LTRACE) {printf(" xxx %s: 3  NOBS=%d \n", fnam, NOBS );}
+  if ( NOBS < INPUTS.SIMLIB_MINOBS ) 
+    { return(REJECT_FLAG); }
 
+  // check SIMLIB GENRANGES and user-input ranges
+  if(LTRACE) {printf(" xxx %s: 4  RA=%f\n", fnam, SIMLIB_HEADER.RA );}
+  if( SIMLIB_HEADER.RA < INPUTS.GENRANGE_RA[0] ) { return(REJECT_FLAG) ; }
+  if( SIMLIB_HEADER.RA > INPUTS.GENRANGE_RA[1] ) { return(REJECT_FLAG) ; }
+  SIMLIB_HEADER.NFOUND_RA++ ;    
 
-  } // end ifilt=0
+  if(LTRACE) {printf(" xxx %s: 5  DEC=%f\n", fnam, SIMLIB_HEADER.DEC );}
+  if( SIMLIB_HEADER.DEC < INPUTS.GENRANGE_DEC[0] ) { return(REJECT_FLAG) ; }
+  if( SIMLIB_HEADER.DEC > INPUTS.GENRANGE_DEC[1] ) { return(REJECT_FLAG) ; }
+  SIMLIB_HEADER.NFOUND_DEC++ ;    
 
-  
-  // note that ISTORE-ifilt is the SPECTROGRAPH index with ifilt=0
-  MJD       = SIMLIB_OBS_RAW.MJD[ISTORE-ifilt] ;
-  TEXPOSE_S = SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[ISTORE-ifilt] ; // search
-  INDX_TAKE_SPECTRUM = SIMLIB_OBS_RAW.INDX_TAKE_SPECTRUM[ISTORE-ifilt] ;
 
-  TEXPOSE_T = SIMLIB_TEMPLATE.TEXPOSE_SPECTROGRAPH ;          // template
-  IFLAG_TEMPLATE = ( TEXPOSE_T > 0.01 ) ;
+  // Check optional CUTWIN_REDSHIFT so that each LIBID
+  // can have its own z-range (originally for WFIRST study)
+  // Note that this is a cut, not a range to generate.
+  if(LTRACE) {printf(" xxx %s: 6  zCMB=%f\n", fnam, zCMB );}
+  if ( zCMB < SIMLIB_HEADER.CUTWIN_REDSHIFT[0] )  { return(REJECT_FLAG); }
+  if ( zCMB > SIMLIB_HEADER.CUTWIN_REDSHIFT[1] )  { return(REJECT_FLAG); }
 
-  LCUT = 
-    ( TEXPOSE_T > INPUTS_SPECTRO.TEXPOSE_MIN ) && 
-    ( TEXPOSE_T < INPUTS_SPECTRO.TEXPOSE_MAX ) ;
 
-  if ( IFLAG_TEMPLATE && LCUT==0 ) {
-    sprintf(c1err,
-	    "\n\t Invalid TEMPLATE_TEXPOSE_SPECTROGRAPH = %.1f in SIMLIB",
-            TEXPOSE_T);
-    sprintf(c2err,"Valid range is %.2f to %.2f sec",
-            INPUTS_SPECTRO.TEXPOSE_MIN, INPUTS_SPECTRO.TEXPOSE_MAX);
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ) ;
+  // check redshift window
+  if(LTRACE) {printf(" xxx %s: 8\n", fnam );}
+  ptrGen = SIMLIB_HEADER.GENRANGE_REDSHIFT ;
+  if ( ptrGen[0] > 0.0 ) {
+    icheck = check_SIMLIB_GENRANGE(INPUTS.GENRANGE_REDSHIFT, ptrGen);
+    if ( icheck < 0 ) { return(REJECT_FLAG); }
+    if ( ptrGen[1] > ptrGen[0] ) { SIMLIB_HEADER.REGEN_FLAG = 1; }
   }
 
+  // check PEAKMJD
+  ptrGen = SIMLIB_HEADER.GENGAUSS_PEAKMJD.RANGE ;
+  if(LTRACE) 
+    {printf(" xxx %s: 9 PEAKMJD.RANGE=%.3f,%.3f\n", fnam,ptrGen[0],ptrGen[1]);}
+  if ( ptrGen[0] > 1000. ) {
+    icheck = check_SIMLIB_GENRANGE(INPUTS.GENRANGE_PEAKMJD, ptrGen);
+    if ( icheck < 0 ) { return(REJECT_FLAG); }    
+    if ( ptrGen[1] > ptrGen[0] ) 
+      { SIMLIB_HEADER.REGEN_FLAG = 1; }
+    else { 
+      GENLC.PEAKMJD         = ptrGen[0]; 
+      GENLC.ISOURCE_PEAKMJD = ISOURCE_PEAKMJD_SIMLIB; 
+    }
+  }
 
-  // load successive filters 
-  SIMLIB_OBS_RAW.MJD[ISTORE]                  = MJD ;
-  SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[ISTORE] = TEXPOSE_S ;
-  SIMLIB_OBS_RAW.INDX_TAKE_SPECTRUM[ISTORE]   = INDX_TAKE_SPECTRUM ;
 
-  if ( LDMP) {
-    printf(" xxx ------------- %s DUMP ------------------- \n", fnam); 
-    printf(" xxx ifilt=%d  ISTORE=%d  MJD=%.3f\n", 
-	   ifilt, ISTORE, MJD ); 
-    fflush(stdout);
+  // check SALT2c
+  if(LTRACE) {printf(" xxx %s: 10 check SALT2c \n", fnam );}
+  ptrGen = SIMLIB_HEADER.GENGAUSS_SALT2c.RANGE ;
+  if ( fabs(ptrGen[0]) < 90.0 ) {
+    icheck = check_SIMLIB_GENRANGE(INPUTS.GENGAUSS_SALT2c.RANGE, ptrGen);
+    if ( icheck < 0 ) { return(REJECT_FLAG); }    
+    SIMLIB_HEADER.REGEN_FLAG = 1; 
   }
 
-  if ( GENLC.NFILTDEF_SPECTROGRAPH == 0 ) 
-    { ifilt_obs=0 ; goto  STORE_SIMLIB_RAW ; }
-
-  ifilt_obs = GENLC.IFILTDEF_SPECTROGRAPH[ifilt] ;
-  sprintf(cfilt,  "%c", FILTERSTRING[ifilt_obs] ) ;
+  // check SALT2x1
+  if(LTRACE) {printf(" xxx %s: 11 check SALT2x1\n", fnam );}
+  ptrGen = SIMLIB_HEADER.GENGAUSS_SALT2x1.RANGE ;
+  if ( fabs(ptrGen[0]) < 90.0 ) {
+    icheck = check_SIMLIB_GENRANGE(INPUTS.GENGAUSS_SALT2x1.RANGE, ptrGen);
+    if ( icheck < 0 ) { return(REJECT_FLAG); }    
+    SIMLIB_HEADER.REGEN_FLAG = 1; 
+  }
 
 
-  /* xxxxxxxxx mark delete xxxxxxxx
-  printf(" xxx %s: ISTORE=%d  MJD=%.3f   ifilt=%d  ifilt_obs=%d \n",
-	 fnam, ISTORE, MJD, TEXPOSE_S, ifilt, ifilt_obs ); 
-  fflush(stdout);
-  xxxxxxxxxxxxxxxxx */
+  // Nov 26 2017: check NREPEAT for LCLIB
+  if(LTRACE) {printf(" xxx %s: 12\n", fnam );}
+  //  printf(" 1. xxx %s: HEADER.NREPEAT=%d   INPUTS.NREPEAT=%d\n", 
+  //	 fnam, SIMLIB_HEADER.NREPEAT, INPUTS.SIMLIB_NREPEAT );
+  set_SIMLIB_NREPEAT();
+  if ( INPUTS.SIMLIB_NREPEAT == 0 ) { return(REJECT_FLAG); }
+  
 
+  if(LTRACE) {printf(" xxx %s: 99 END\n", fnam ); debugexit(fnam); }
+  
+  // if we get here, keep this ID
+  return(ACCEPT_FLAG) ;
 
-  if ( GENLC.IFLAG_SYNFILT_SPECTROGRAPH[ifilt_obs] == 0 ) {
-    sprintf(c1err,"Invalid %s-filter is not a SYN-FILTER ?", cfilt );  
-    sprintf(c2err,"Check SYN-FILTERs in kcor input file.");
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ) ; 
-  }
+} // end keep_SIMLIB_HEADER
 
-  get_SPECTROGRAPH_ZPTPSFSKY(ISTORE, ifilt, TEXPOSE_S, TEXPOSE_T,   // inputs
-			     &ZPT, &PSFSIG, &SKYSIG_S, &SKYSIG_T ); // returned
 
+// =======================================================
+void SIMLIB_addCadence_SPECTROGRAPH(void) {
 
- STORE_SIMLIB_RAW:
+  // Created Aug 23 2017
+  // For each SPECTROGRAPH key in the SIMLIB, which specifies
+  // MJD and TEXPOSE, add additional SIMLIB_OBS_RAW observation
+  // for each synthetic band as if that band had been included
+  // in the SIMLIB file.
+  // The original SPECTROGRAPH entry is masked out by setting
+  // its OPTLINE = -9, but then appended to the end of the 
+  // SIMLIB_OBS_RAW list along with each synthetic band.
+  //
+  // 9.18/2017: set PIXSIZE
 
-  SIMLIB_OBS_RAW.IFILT_OBS[ISTORE]  = ifilt_obs ;
-  sprintf(SIMLIB_OBS_RAW.BAND[ISTORE],"%s", cfilt );
+  int NOBS       = SIMLIB_OBS_RAW.NOBS ;
+  int NOBS_SPEC  = SIMLIB_OBS_RAW.NOBS_SPECTROGRAPH ;
+  int NFILT_SPEC = GENLC.NFILTDEF_SPECTROGRAPH  ; // Numb of synthetic filters
+  int ifilt, ispec, OBSRAW, ISTORE, NOBS_ADD, APP ;
+  double MJD, TEXPOSE, PIXSIZE ;
+  char *FIELD, *TEL ;
+  char fnam[] = "SIMLIB_addCadence_SPECTROGRAPH" ;
 
-  SIMLIB_OBS_RAW.CCDGAIN[ISTORE]    = 1.0 ; // unity GAIN 
-  SIMLIB_OBS_RAW.READNOISE[ISTORE]  = 0.0 ;
-  SIMLIB_OBS_RAW.SKYSIG[ISTORE]     = SKYSIG_S ; // noise per pixel or arcsec^2
-  SIMLIB_OBS_RAW.PSFSIG1[ISTORE]    = PSFSIG ;   // sigma1
-  SIMLIB_OBS_RAW.PSFSIG2[ISTORE]    = 0.0 ;  // sigma2
-  SIMLIB_OBS_RAW.PSFRATIO[ISTORE]   = 0.0 ;  // ratio of two Gaussians
-  SIMLIB_OBS_RAW.ZPTADU[ISTORE]     = ZPT ;  // TEXPOSE zero point (pe)
-  SIMLIB_OBS_RAW.ZPTSIG[ISTORE]     = 0.0 ;  // no error; included in SKYSIG
-  SIMLIB_OBS_RAW.MAG[ISTORE]        = 99.0; 
+  // --------------- BEGIN --------------
 
-  // set optional template noise for passbands made from spectrograph
-  if ( IFLAG_TEMPLATE ) {
-    SIMLIB_TEMPLATE.USEFLAG |= 2;
-    SIMLIB_OBS_RAW.TEMPLATE_SKYSIG[ISTORE]    = SKYSIG_T ; 
-    SIMLIB_OBS_RAW.TEMPLATE_READNOISE[ISTORE] = 0.0 ;
-    SIMLIB_OBS_RAW.TEMPLATE_ZPT[ISTORE]       = ZPT ;
-    
-    /*
-    printf(" xxx ifilt_obs=%2d : SKYSIG(S/T) = %.2f/%.2f = %.3f "
-	   "TEXPOSE(S,T)=%.1f,%.1f \n", 
-	   ifilt_obs, SKYSIG_S, SKYSIG_T, SKYSIG_S/SKYSIG_T,
-	   TEXPOSE_S, TEXPOSE_T );    */
+  // always mask off original SPECTROGRAPH def in case we bail below.
+  for ( ispec=0; ispec < NOBS_SPEC; ispec++ ) {
+    OBSRAW = SIMLIB_OBS_RAW.OBSLIST_SPECTROGRAPH[ispec];
+    SIMLIB_OBS_RAW.OPTLINE[OBSRAW] = -9 ;
   }
 
-  return ;
-
-} // end store_SIMLIB_SPECTROGRAPH
+  // if SPCTROGRAPH is to be ignored, then bail.
+  if ( SPECTROGRAPH_USEFLAG == 0 ) { return ; }
+  if ( NOBS_SPEC == 0 )            { return ; }
 
-// =================================================
-void get_SPECTROGRAPH_ZPTPSFSKY(int OBSRAW, int ifilt,
-				double TEXPOSE_S, double TEXPOSE_T,
-				double *ZPT, double *PSFSIG, 
-				double *SKYSIG_S, double *SKYSIG_T) {
 
-  // Created Aug 12 2017
-  // For input exposure times (TEXPOSE_S,TEXPOSE_T), 
-  // compute and return
-  //  + ZPT       (zero point for search)
-  //  + PSFSIG    (sigma of PSF)
-  //  + SKYSIG_S  (search SKY sigma)
-  //  + SKYSIG_T  (template SKY sigma)
-  //
-  // Mar 11 2018: fix PIXSIZE to depend on OBSRAW
+  if ( NFILT_SPEC == 0 ) { NFILT_SPEC=1; }   // at least the spectrum
+  ISTORE = NOBS;  NOBS_ADD=0;
 
-  // get min/max wavelentgh of syn filter
-  double LAMMIN  = INPUTS_SPECTRO.SYN_FILTERLIST_LAMMIN[ifilt] ;
-  double LAMMAX  = INPUTS_SPECTRO.SYN_FILTERLIST_LAMMAX[ifilt] ;
-  double MJD     = SIMLIB_OBS_RAW.MJD[OBSRAW]; // for debug
-  double PIXSIZE = SIMLIB_OBS_RAW.PIXSIZE[OBSRAW]; 
-  int ifilt_obs  = GENLC.IFILTDEF_SPECTROGRAPH[ifilt] ;
-  int NBT        = INPUTS_SPECTRO.NBIN_TEXPOSE ;
-  int IFLAG_TEMPLATE = ( TEXPOSE_T > 0.01 ) ;
-  int UNIT_IS_ARCSEC = 
-    ( strcmp(SIMLIB_GLOBAL_HEADER.SKYSIG_UNIT,SIMLIB_SKYSIG_SQASEC )==0) ;
+  for ( ispec=0; ispec < NOBS_SPEC; ispec++ ) {
 
-  int l,  NBLAM ;
-  int OPT_INTERP = 1; // linear
-  int LDMP = 0 ;
-  double LCEN, LBINMIN, LBINMAX, ZSUM, ZPLAM ;
-  double SQSKY_S, SQSKY_T, SQSUM_S, SQSUM_T ;
-  double PSFSIG_PIXEL, PSFSIG_ARCSEC, PSF_ARCSECFWHM, NEA ;
+    // get MJD and epxosure time 
+    OBSRAW  = SIMLIB_OBS_RAW.OBSLIST_SPECTROGRAPH[ispec];
+    MJD     = SIMLIB_OBS_RAW.MJD[OBSRAW] ;
+    TEXPOSE = SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[OBSRAW] ;
+    FIELD   = SIMLIB_OBS_RAW.FIELDNAME[OBSRAW] ;
+    APP     = SIMLIB_OBS_RAW.APPEND_PHOTFLAG[OBSRAW] ;
+    TEL     = INPUTS_SPECTRO.INSTRUMENT_NAME ;
+    PIXSIZE = SIMLIB_HEADER.PIXSIZE ;
 
-  char fnam[] = "get_SPECTROGRAPH_ZPTPSFSKY" ;
-  char STR_ZPLAM[]   = "get_ZPTPSFSKY(ZPLAM)";
-  char STR_SQSIG_S[] = "get_ZPTPSFSKY(SQSIG_S)";
-  char STR_SQSIG_T[] = "get_ZPTPSFSKY(SQSIG_T)";
+    // add each synthetic filter to SIMLIB OBS_RAW as if it
+    // were defined in the SIMLIB file.
 
-  // ---------------- BEGIN -------------
+    for(ifilt=0 ; ifilt < NFILT_SPEC; ifilt++ ) {
+      
+      SIMLIB_OBS_RAW.INDX_TAKE_SPECTRUM[ISTORE]   = ispec ;
+      SIMLIB_OBS_RAW.IFILT_SPECTROGRAPH[ISTORE]   = ifilt ; 
+      SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[ISTORE] = TEXPOSE ;      
+      SIMLIB_OBS_RAW.OPTLINE[ISTORE]    = OPTLINE_SIMLIB_SPECTROGRAPH ;
+      SIMLIB_OBS_RAW.MJD[ISTORE]        = MJD ;
+      SIMLIB_OBS_RAW.PIXSIZE[ISTORE]    = PIXSIZE ;
+      
+      SIMLIB_OBS_RAW.BAND[ISTORE][0] = 0 ;
+      sprintf(SIMLIB_OBS_RAW.FIELDNAME[ISTORE], "%s", FIELD );
+      sprintf(SIMLIB_OBS_RAW.TELESCOPE[ISTORE], "%s", TEL);
 
-  // init output args
-  *ZPT = *SKYSIG_S = *SKYSIG_T = *PSFSIG = 0.0 ;
+      if ( APP > 0 ) { SIMLIB_HEADER.NOBS_APPEND++ ; }
+      SIMLIB_OBS_RAW.APPEND_PHOTFLAG[ISTORE] = APP ;
 
-  // bail if filter is not requested by user.
+      // the quantities below will be evaluated later in 
+      // store_SIMLIB_SPECTROGRAPH (as part of 'prepCadence')
+      SIMLIB_OBS_RAW.IDEXPT[ISTORE]     = -9 ;
+      SIMLIB_OBS_RAW.NEXPOSE[ISTORE]    =  0 ;
+      SIMLIB_OBS_RAW.CCDGAIN[ISTORE]    = -9.0 ;
+      SIMLIB_OBS_RAW.READNOISE[ISTORE]  = -9.0 ;
+      SIMLIB_OBS_RAW.SKYSIG[ISTORE]     = -9.0 ;
+      SIMLIB_OBS_RAW.PSFSIG1[ISTORE]    = -9.0 ;
+      SIMLIB_OBS_RAW.PSFSIG2[ISTORE]    = -9.0 ;
+      SIMLIB_OBS_RAW.PSFRATIO[ISTORE]   = -9.0 ;
+      SIMLIB_OBS_RAW.ZPTADU[ISTORE]     = -9.0 ;
+      SIMLIB_OBS_RAW.ZPTSIG[ISTORE]     = -9.0 ;
+      SIMLIB_OBS_RAW.MAG[ISTORE]        = 99.0 ;
+      ISTORE++ ;  NOBS_ADD++ ;
 
-  if ( GENLC.IFILTINVMAP_OBS[ifilt_obs] < 0 ) { return ; }
+    } // end ifilt loop
+  } // end i Loop over SPECTROGRAPH keys
 
+  
+  // -------------------------
+  // update NOBS
+  SIMLIB_OBS_RAW.NOBS_SPECTROGRAPH = NOBS_ADD;
 
-  ZSUM = SQSUM_S = SQSUM_T = 0.0 ;   NBLAM=0 ;
-  for(l=0; l < INPUTS_SPECTRO.NBIN_LAM; l++ ) {
+  // make sure that NOBS is deterministic in case we neeed
+  // to recompute this later.
+  SIMLIB_OBS_RAW.NOBS = 
+    SIMLIB_OBS_RAW.NOBS_READ + SIMLIB_OBS_RAW.NOBS_SPECTROGRAPH ;
 
-    LBINMIN = INPUTS_SPECTRO.LAMMIN_LIST[l] ;  // of spectral bin
-    LBINMAX = INPUTS_SPECTRO.LAMMAX_LIST[l] ;    
-    LCEN    = 0.5 * (LBINMIN + LBINMAX) ; // bin center
+  SIMLIB_HEADER.NOBS = SIMLIB_OBS_RAW.NOBS ;
 
-    // keep bin if its center is withing the user-defined
-    // wavelength range in the kcor-input file.
-    if ( LCEN < LAMMIN ) { continue ; }
-    if ( LCEN > LAMMAX ) { continue ; }
+  return ;
 
-    // interpolate ZPLAM(pe) for this exposure time, at this lambda
-    ZPLAM = interp_1DFUN(OPT_INTERP, TEXPOSE_S, NBT,
-			 INPUTS_SPECTRO.TEXPOSE_LIST, 
-			 INPUTS_SPECTRO.ZP[l], STR_ZPLAM);
-    ZSUM    += pow(TEN, 0.4*ZPLAM) ;
+} // end SIMLIB_addCadence_SPECTROGRAPH 
 
-    // interpolate SQSIGSKY
-    SQSKY_S = interp_1DFUN(OPT_INTERP, TEXPOSE_S, NBT,
-			   INPUTS_SPECTRO.TEXPOSE_LIST, 
-			   INPUTS_SPECTRO.SQSIGSKY[l], STR_SQSIG_S);
-    SQSUM_S += SQSKY_S ; 
 
-    if ( IFLAG_TEMPLATE ) {
-      SQSKY_T = interp_1DFUN(OPT_INTERP, TEXPOSE_T, NBT,
-			     INPUTS_SPECTRO.TEXPOSE_LIST, 
-			     INPUTS_SPECTRO.SQSIGSKY[l], STR_SQSIG_T);
-      SQSUM_T += SQSKY_T ; 
+// ==============================================
+void  SIMLIB_TAKE_SPECTRUM(void) {
+  
+  // add spectrograph entries w.r.t peakMJD
+  // These OBS are not in the SIMLIB, so here we add
+  // them as if they were in the SIMLIB.
+  //
+  // Aug 23 2017: remove NLINE_MJD argument for refactor
+  // Mar 02 2019: remove LEGACY flag, and fix bug setting VAL_STORE 
+  //              when NFILT==0.
+
+  int i, OPT, ifilt, ifilt_obs, OBSRAW, NOBS_ADD ;
+  int NSPEC = NPEREVT_TAKE_SPECTRUM ;
+  int NFILT = GENLC.NFILTDEF_SPECTROGRAPH ;  // all spectroscopic filters
+  double EPOCH[2], MJD, MJD_REF;
+  double z, z1, TOBS, TREST, TOBS_REF ;
+  double TEXPOSE, VAL_STORE[8] ;
+  char *FIELD ;
+  char fnam[] = "SIMLIB_TAKE_SPECTRUM" ;
+
+
+  // -------------- BEGIN -------------
+
+  if ( NSPEC == 0 ) { return ; }
+
+  // in case of repeated cadence, reset NOBS to leave out 
+  // previous TAKE_SPECTRUM obs.
+  SIMLIB_OBS_RAW.NOBS = SIMLIB_HEADER.NOBS =
+    SIMLIB_OBS_RAW.NOBS_READ + SIMLIB_OBS_RAW.NOBS_SPECTROGRAPH ;
+  
+
+  OBSRAW = SIMLIB_OBS_RAW.NOBS ;  NOBS_ADD=0;
+ 
+  z = GENLC.REDSHIFT_CMB ;
+  for(i=0; i < NSPEC; i++ ) {  
+
+    EPOCH[0] = INPUTS.TAKE_SPECTRUM[i].EPOCH_RANGE[0] ;
+    EPOCH[1] = INPUTS.TAKE_SPECTRUM[i].EPOCH_RANGE[1] ;
+
+    MJD_REF =  GENSPEC_PICKMJD( 0, i, z, &TOBS, &TREST) ; // for MJD sorting
+    //    MJD     =  GENSPEC_PICKMJD( 1, i, z, &TOBS, &TREST) ;
+
+    // make sure that TREST is within valid range
+    float *ptrTcut = INPUTS.GENRANGE_TREST ;
+    if ( TREST <= ptrTcut[0] ||	 TREST >= ptrTcut[1]  ) {
+      sprintf(c1err,"Invalid TREST=%.2f in TAKE_SPECTRUM key.",TREST);
+      sprintf(c2err,"User set 'GENRANGE_TREST:  %.2f  %.2f' ", 
+	      ptrTcut[0], ptrTcut[1] );
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ) ; 
     }
 
-    NBLAM++ ; 
+    // Now get exposure time
+    OPT  = INPUTS.TAKE_SPECTRUM[i].OPT_TEXPOSE ;
+    if ( OPT == 1 ) {
+      GENPOLY_DEF *GENZPOLY = &INPUTS.TAKE_SPECTRUM[i].GENZPOLY_TEXPOSE;
+      TEXPOSE = eval_GENPOLY(z,GENZPOLY,fnam);
+    }
+    else if ( OPT == 2 ) {
+      // use max TEXPOSE for now; later correct for user SNR
+      TEXPOSE = INPUTS_SPECTRO.TEXPOSE_MAX ;
+    }
+    else {
+      sprintf(c1err,"Invalid OPT_TEXPOSE[%d] = %d", i, OPT);
+      sprintf(c2err,"Should be 1(TEXPOSE) or 2(SNR)" );
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ) ; 
+    }
 
-    if ( LDMP ==5 ) { 
-      double L0 = INPUTS.LAMMIN_OBS[ifilt_obs];
-      double L1 = INPUTS.LAMMAX_OBS[ifilt_obs];
-      printf(" xxx LCEN=%.1f (%.1f:%.1f) ZPLAM=%.3f \n", 
-	     LCEN, L0, L1, ZPLAM );
+    /*
+    printf(" xxx i=%d : load MJD=%.3f  TEXPOSE=%.0f  EP=%.2f  z=%.3f \n",
+	   i, MJD, TEXPOSE, EPOCH_RAN, z ); fflush(stdout);
+    */
+
+
+    if ( NFILT==0 ) {  // no synthetic filters; just spectra
+      VAL_STORE[0] = MJD_REF   ; // same MJD_REF each event for MJD-sorting
+      VAL_STORE[1] = TEXPOSE ;
+      VAL_STORE[2] = (double)i ;   
+      store_GENSPEC(VAL_STORE) ; 
     }
-  }  // end l loop over lambda bins
 
+    for(ifilt=0; ifilt < NFILT; ifilt++ ) {  
 
-  if ( ZSUM == 0.0 ) {
-    printf("\n PRE-ABORT DUMP \n");
-    printf("   for SYN_FILTER='%c' (ifilt_obs=%d)\n",
-	   FILTERSTRING[ifilt_obs], ifilt_obs ) ; 
-    printf("   LAMRANGE = %.1f to %.1f  at  MJD=%.3f \n",
-	    INPUTS.LAMMIN_OBS[ifilt_obs], 
-	    INPUTS.LAMMAX_OBS[ifilt_obs], MJD );
+      SIMLIB_OBS_RAW.OPTLINE[OBSRAW]  = OPTLINE_SIMLIB_SPECTROGRAPH ; 
+      SIMLIB_OBS_RAW.MJD[OBSRAW]      = MJD_REF ;
+      SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[OBSRAW]  = TEXPOSE ;
+      SIMLIB_OBS_RAW.IFILT_SPECTROGRAPH[OBSRAW]    = ifilt;
+      SIMLIB_OBS_RAW.INDX_TAKE_SPECTRUM[OBSRAW]    = i ;
+      SIMLIB_OBS_RAW.PIXSIZE[OBSRAW] = SIMLIB_HEADER.PIXSIZE ;
 
-    sprintf(c1err,"No spectro-bin center overlaps SYN_FILTER='%c'",
-	    FILTERSTRING[ifilt_obs] );
-    sprintf(c2err,"--> FLUX=0.  Try wider SYN_FILTER.");
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ) ; 
-  }
+      // For field, give survey name (since we don;t know)
+      // TO DO: determine FIELD based on MJD range
+      sprintf(SIMLIB_OBS_RAW.FIELDNAME[OBSRAW],"%s", 
+	      SIMLIB_GLOBAL_HEADER.SURVEY_NAME );
+      
+      sprintf(SIMLIB_OBS_RAW.TELESCOPE[OBSRAW], "%s", 
+	      INPUTS_SPECTRO.INSTRUMENT_NAME );
+      
+      OBSRAW++ ;   NOBS_ADD++ ;	
 
-  // get ZPT of all spectrograph slices summed into one band
-  *ZPT = 2.5*log10(ZSUM) ;
- 
-  // define artificial PSF to get sky noise per pixel 
-  PSF_ARCSECFWHM = 1.0 ; // 1'' FWHM   
-  PSFSIG_ARCSEC  = PSF_ARCSECFWHM / 2.355 ;
-  PSFSIG_PIXEL   = PSFSIG_ARCSEC / PIXSIZE ;
-  if ( UNIT_IS_ARCSEC )  { 
-    *PSFSIG = PSF_ARCSECFWHM ;   // later gets converted back to SIGMA
-    NEA    = 2.0 * TWOPI * (PSFSIG_ARCSEC * PSFSIG_ARCSEC ) ;
-  } 
-  else  { 
-    *PSFSIG = PSFSIG_PIXEL ; 
-     NEA    = 2.0 * TWOPI * (PSFSIG_PIXEL  * PSFSIG_PIXEL ) ;
-  }
+    } // end ifilt
 
+  } // end i-loop over TAKE_SPECTRUM
 
-  // get skyNoise per pixel (or per sqArcSec)
-  *SKYSIG_S = sqrt(SQSUM_S/NEA) ; // noise per pixel or arcsec^2
-  if ( IFLAG_TEMPLATE )  { 
-    *SKYSIG_T  = sqrt(SQSUM_T/NEA);  // template sky noise
-    *SKYSIG_T *= ( TEXPOSE_S/TEXPOSE_T ); // scale template to search image
-  }
 
-  if ( LDMP ) {
-    printf(" xxx -------------------------------------- \n");
-    printf(" xxx synBand %c : TEXPOSE[S,T] = %.1f , %.1f \n",
-	   FILTERSTRING[ifilt_obs], TEXPOSE_S, TEXPOSE_T );
-    printf(" xxx synBand %c : %.0f-%.0f  "
-	   "MJD=%.3f ZPT=%.3f  PSF=%.2f  SKYSIG=%.2f,%.2f\n",
-	   FILTERSTRING[ifilt_obs], 
-	   INPUTS.LAMMIN_OBS[ifilt_obs],
-	   INPUTS.LAMMAX_OBS[ifilt_obs],
-	   MJD, *ZPT, *PSFSIG, *SKYSIG_S, *SKYSIG_T ); fflush(stdout);
-  }
-  
-  return ;
+  SIMLIB_OBS_RAW.NOBS += NOBS_ADD ;
+  SIMLIB_HEADER.NOBS  += NOBS_ADD ;
 
-} // end get_SPECTROGRAPH_ZPTPSFSKY
 
+  return;
 
-// =================================================
-int keep_SIMLIB_OBS(int isort, int REPEAT) {
+} // end  SIMLIB_TAKE_SPECTRUM
+
+
+// ===================================
+void  SIMLIB_prepCadence(int REPEAT_CADENCE) {
 
   // Created Aug 2017
-  // Return 1 of this raw-OBS is kept.
-  // Return 0 to reject this OBS.
   //
-  // Inputs:
-  //   OBS      = MJD-sort index; needed to get absolute OBS index
-  //   REPEAT   = 1 if this cadence is repeated
+  // After calling SIMLIB_readNext,
+  // apply selection and MJD-sorting on SIMLIB_OBS_RAW entries 
+  // and fill SIMLIB_OBS_GEN to use for generation.
+  // Also set some GENLC arrays for current LIBID/Cadence.
   //
-  // Sep 24 2017: check field.
+  // REPEAT_CADENCE=0 --> this is a new cadence
+  // REPEAT_CADENCE=1 --> same cadence as before, but new event
+  // REPEAT_CADENCE=2 --> cadence restored from SIMLIB_CACHE
+  //
+  // Mar 11 2018: fix PIXSIZE for FWHM_ARCSEC units
+  // Mar 15 2018: MAG -> MAG_UNDEFINED
+  // Jul 11 2018: fix bug by setting PIXSIZE outside UNIT if-block
+  // Oct 2026: move NEW_CADENCE block to SIMLIB_prepCadence_RAW, and
+  //           skip seasons and far-away MJDs for SIMLIB_CACHE.
 
-  int  KEEP=1, NOKEEP=0; 
-  int  ifilt, ifilt_obs, OBS ;
-  int  LTRACE=0; 
-  double  MJD, MJDrange[2];
-  char *FIELD ;
-  char fnam[] = "keep_SIMLIB_OBS" ;
+  int NEW_CADENCE = (REPEAT_CADENCE == 0 ) ;
+  int ORDER_SORT, OPTLINE, OBSRAW ;
+  double zcmb, RA, DEC, vpec, MJDrange[2], PIXSIZE, DUM ;
+  double SNR, SNRMAX=-9.0 ;
 
-  // ------------ BEGIN --------------
+  int NOBS_APPEND = SIMLIB_HEADER.NOBS_APPEND ;
+  int NOBS_RAW    = SIMLIB_HEADER.NOBS ;
 
-  
-  if (LTRACE) {
-    printf(" xxx ---------------------------- \n");
-    printf(" xxx 0 isort=%d REPEAT=%d \n",isort,REPEAT); 
-  }
-  OBS  = SIMLIB_LIST_forSORT.INDEX_SORT[isort] ; // absolute OBS_RAW index
+  char *BAND ;
+  char fnam[] = "SIMLIB_prepCadence" ;
 
+  // --------------- BEGIN ----------------
 
-  FIELD = SIMLIB_OBS_RAW.FIELDNAME[OBS] ;
-  MJD   = SIMLIB_OBS_RAW.MJD[OBS] ;
+  GENLC.NEPOCH = 0 ; // Mar 17 2015: needed for LIBID repeats
 
-  // compute & store SEASON info; return MJDrange to keep SIMLIB entries
-  set_SIMLIB_MJDrange(REPEAT,MJDrange);
+  // Apr 13, 2016: 
+  // check if anything needs to be re-generated based on header info
+  if ( regen_SIMLIB_GENRANGES() < 0 ) { return ; }
 
-  if ( MJD < MJDrange[0] ) { return(NOKEEP); }
-  if ( MJD > MJDrange[1] ) { return(NOKEEP); }
+  // transfer some SIMLIB_HEADER info to GENLC struct
+  GENLC.RA         = SIMLIB_HEADER.RA ;
+  GENLC.DEC        = SIMLIB_HEADER.DEC ;
 
-  if (LTRACE) {printf(" xxx 1 \n"); fflush(stdout); }
-  // check option to skip MJDs
-  if ( INPUTS.SIMLIB_NSKIPMJD > 0 ) {
-    float xskip = (float)(INPUTS.SIMLIB_NSKIPMJD+1) ;
-    float xline = (float)isort ;
-    float xmod  = fmodf(xline,xskip);
-    if ( xmod > 0.0 ) { return(NOKEEP); }
-  }
+  if ( INPUTS.OPT_MWEBV == OPT_MWEBV_FILE ) 
+    { GENLC.MWEBV = SIMLIB_HEADER.MWEBV ; }
+  GENLC.SIMLIB_ID  = SIMLIB_HEADER.LIBID ;
+  sprintf(GENLC.FIELDNAME[0], "%s", SIMLIB_HEADER.FIELD);
+  sprintf(GENLC.TELESCOPE[0], "%s", SIMLIB_HEADER.TELESCOPE);
 
+  // --------------------------------------------------------------
+  // do a few things for a NEW cadence, 
+  // but not for a repeated/re-used cadence
+  //   1) prepare duplicate MJDs for sorting
+  //   2) sanity checks on values
+  //   3) check change of units for PSF and SKYSIG
 
-  // check option to skip field 
-  if ( SKIP_SIMLIB_FIELD(FIELD) ) { return(NOKEEP); }
+  if ( NEW_CADENCE ) { SIMLIB_prepCadence_RAW(); }
 
-  // apply PEAKMJD cut-window for SIMLIB_DUMP option (Feb 2013)
+  // - - - - - - - - - - - - - - - - - - - 
+  // chop MJD range into seasons to allow user options;
+  // SIMLIB_CACHE (REPEAT_CADENCE=2) already has seasons.
+  if ( REPEAT_CADENCE != 2 ) { store_SIMLIB_SEASONS(); }
+
+  // - - - - - - -
+  int isort, ifilt, IFILT_OBS, NEXPOSE, KEEP, NEP, NEP_NEWMJD ;
+  int  IFLAG_SYNFILT, IFLAG_TEMPLATE, IFIELD, APP ;
+  double MJD, CCDGAIN, RDNOISE, SKYSIG, PSF[3], ZPT[2], MAG ;
+  double SKYSIG_T, RDNOISE_T, ZPT_T ;
+  double SHIFT_ZPT, SCALE_SKYSIG, SCALE_RDNOISE, SCALE_PSF ;
+  double MJD_DIF, MJD_LAST_KEEP, DT, DUMMY_STORE[3] ;
+  char   *TEL, *FIELD, cfilt[2];
+
+  // init stuff before loop over MJDs
+  NEP=NEP_NEWMJD=0;  MJD_LAST_KEEP=-9.0;  
+
+  // transfer OBS_RAW to OBS_GEN; latter has cuts and is sorted by MJD.
+  // For SIMLIB_CACHE, skip sorted MJDs that are far outside MJD window.
+  int ISORT_MIN = 0, ISORT_MAX = NOBS_RAW ;
+  if ( REPEAT_CADENCE == 2 ) 
+    { get_SIMLIB_CACHE_ISORT_RANGE(&ISORT_MIN, &ISORT_MAX); }
+
+  for ( isort = ISORT_MIN; isort < ISORT_MAX; isort++ ) {
+
+    OBSRAW   = SIMLIB_LIST_forSORT.INDEX_SORT[isort]; 
+    OPTLINE  = SIMLIB_OBS_RAW.OPTLINE[OBSRAW] ;
+
+    if ( OPTLINE < 0 ) { continue; }
+
+    if ( OPTLINE == OPTLINE_SIMLIB_SPECTROGRAPH ) {
+      ifilt = SIMLIB_OBS_RAW.IFILT_SPECTROGRAPH[OBSRAW]; //sparse synth index
+      DUMMY_STORE[0] = DUMMY_STORE[1] = -9.0 ;
+      store_SIMLIB_SPECTROGRAPH(ifilt, DUMMY_STORE, OBSRAW) ;
+    }
+
+    // strip off SIMLIB variables for this sorted MJD
+    MJD        = SIMLIB_OBS_RAW.MJD[OBSRAW] ;
+    CCDGAIN    = SIMLIB_OBS_RAW.CCDGAIN[OBSRAW] ;
+    RDNOISE    = SIMLIB_OBS_RAW.READNOISE[OBSRAW] ;
+    SKYSIG     = SIMLIB_OBS_RAW.SKYSIG[OBSRAW] ;
+    PSF[0]     = SIMLIB_OBS_RAW.PSFSIG1[OBSRAW] ;
+    PSF[1]     = SIMLIB_OBS_RAW.PSFSIG2[OBSRAW] ;
+    PSF[2]     = SIMLIB_OBS_RAW.PSFRATIO[OBSRAW] ;
+    ZPT[0]     = SIMLIB_OBS_RAW.ZPTADU[OBSRAW] ;
+    ZPT[1]     = SIMLIB_OBS_RAW.ZPTSIG[OBSRAW] ;
+    PIXSIZE    = SIMLIB_OBS_RAW.PIXSIZE[OBSRAW];
+    MAG        = SIMLIB_OBS_RAW.MAG[OBSRAW] ;
+    IFILT_OBS  = SIMLIB_OBS_RAW.IFILT_OBS[OBSRAW] ;
+    NEXPOSE    = SIMLIB_OBS_RAW.NEXPOSE[OBSRAW] ;
+    BAND       = SIMLIB_OBS_RAW.BAND[OBSRAW];
+    FIELD      = SIMLIB_OBS_RAW.FIELDNAME[OBSRAW];
+    TEL        = SIMLIB_OBS_RAW.TELESCOPE[OBSRAW];   
+    APP        = SIMLIB_OBS_RAW.APPEND_PHOTFLAG[OBSRAW];   
+
+    RDNOISE_T  = SIMLIB_OBS_RAW.TEMPLATE_READNOISE[OBSRAW] ;
+    SKYSIG_T   = SIMLIB_OBS_RAW.TEMPLATE_SKYSIG[OBSRAW] ;
+    ZPT_T      = SIMLIB_OBS_RAW.TEMPLATE_ZPT[OBSRAW] ;
+
+    // compute a few things from OBS_RAW
+    if ( INPUTS.SMEARFLAG_ZEROPT == 0 ) { ZPT[1] = 0.0 ; }
+    if ( MAG < 5.0 || MAG > 50 ) { MAG = MAG_UNDEFINED ; }
+    sprintf(cfilt,  "%c", FILTERSTRING[IFILT_OBS] ) ;
+
+    ifilt     = GENLC.IFILTINVMAP_SIMLIB[IFILT_OBS] ;
+    if ( ifilt < 0 || ifilt >= GENLC.NFILTDEF_SIMLIB ) 
+      {  ABORT_SIMLIB_FILTER(isort);  }
+    //      {  ABORT_SIMLIB_FILTER(OPTLINE,MJD,cfilt);  }
+
+    // check if this MJD is kept.
+    KEEP = keep_SIMLIB_OBS(isort,REPEAT_CADENCE);
+
+    if ( GENLC.SIMLIB_ID < -99 ) {
+      printf(" xxx isort=%3d OBSRAW=%3d  IFILT_OBS=%2d(%s) "
+	     "MJD=%.3f  KEEP=%d\n",
+	     isort, OBSRAW, IFILT_OBS, BAND, MJD, KEEP ); // xxxxxx
+      fflush(stdout);
+    }
+
+    if ( KEEP == 0 ) { continue ; }
+
+    // mark this filter as 'used'
+    GENLC.SIMLIB_USEFILT_ENTRY[IFILT_OBS] = 1;
+
+    // get optional fudge scales
+    get_SIMLIB_SCALES(IFILT_OBS, &SHIFT_ZPT, &SCALE_SKYSIG, &SCALE_RDNOISE);
+    SCALE_PSF = INPUTS.FUDGESCALE_PSF ;
+
+    NEP++; 
+    GENLC.NEPOCH = NEP ;
+
+    if ( NEP >= MXEPSIM ) {
+      sprintf(c1err, "NEPOCH = %d exceeds array bound at LIBID=%d", 
+	      NEP, GENLC.SIMLIB_ID );
+      sprintf(c2err, "Either increase MXEPSIM or reduce library size.");
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
+    }
+
+    // determine epoch for trigger; either new epoch, or same as before.
+    MJD_DIF = MJD - MJD_LAST_KEEP ;
+    if ( fabs(MJD_DIF) > INPUTS.NEWMJD_DIF ) {
+      NEP_NEWMJD++; 
+      GENLC.NEWMJD = NEP_NEWMJD ;
+      GENLC.EPOCH_RANGE_NEWMJD[NEP_NEWMJD][0] = NEP ;
+    }
+    GENLC.EPOCH_RANGE_NEWMJD[NEP_NEWMJD][1] = NEP ;
+
+    
+    // store a few things in GENLC struct
+    GENLC.IFILT_OBS[NEP]     = IFILT_OBS;
+    GENLC.genmag8_obs[NEP]   = MAG ;
+    GENLC.MJD[NEP]           = MJD ;
+    sprintf( GENLC.FIELDNAME[NEP], "%s", FIELD );
+    sprintf( GENLC.TELESCOPE[NEP], "%s", TEL   );
+
+    // store SIMLIB_GEN quanties vs. NEP that include fudges                  
+    SIMLIB_OBS_GEN.MJD[NEP]         = MJD ;
+    SIMLIB_OBS_GEN.IFILT_OBS[NEP]   = IFILT_OBS ;
+    SIMLIB_OBS_GEN.PIXSIZE[NEP]     = PIXSIZE ;
+    SIMLIB_OBS_GEN.CCDGAIN[NEP]     = CCDGAIN ;
+    SIMLIB_OBS_GEN.READNOISE[NEP]   = RDNOISE * SCALE_RDNOISE ;
+    SIMLIB_OBS_GEN.SKYSIG[NEP]      = SKYSIG * SCALE_SKYSIG ;
+    SIMLIB_OBS_GEN.PSFSIG1[NEP]     = PSF[0] * SCALE_PSF ;
+    SIMLIB_OBS_GEN.PSFSIG2[NEP]     = PSF[1] * SCALE_PSF ;
+    SIMLIB_OBS_GEN.PSFRATIO[NEP]    = PSF[2] ;  // ratio                      
+    SIMLIB_OBS_GEN.ZPTADU[NEP]      = ZPT[0] + SHIFT_ZPT ;
+    SIMLIB_OBS_GEN.ZPTSIG[NEP]      = ZPT[1] ;
+    SIMLIB_OBS_GEN.MAG[NEP]         = MAG ;
+    SIMLIB_OBS_GEN.NEXPOSE[NEP]     = NEXPOSE ;
+    SIMLIB_OBS_GEN.ISTORE_RAW[NEP]  = OBSRAW ;
+    SIMLIB_OBS_GEN.APPEND_PHOTFLAG[NEP] = APP ;
+    sprintf(SIMLIB_OBS_GEN.TELESCOPE[NEP], "%s", TEL   );
+    sprintf(SIMLIB_OBS_GEN.FIELDNAME[NEP], "%s", FIELD );
+
+    SIMLIB_OBS_GEN.TEXPOSE_SPECTROGRAPH[NEP] =
+      SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[OBSRAW] ;
+    SIMLIB_OBS_GEN.INDX_TAKE_SPECTRUM[NEP] =
+      SIMLIB_OBS_RAW.INDX_TAKE_SPECTRUM[OBSRAW] ;
+
+    // - --  store correlated template info ... - - - -                       
+    IFLAG_SYNFILT  = GENLC.IFLAG_SYNFILT_SPECTROGRAPH[IFILT_OBS] ;
+    IFLAG_TEMPLATE = SIMLIB_TEMPLATE.USEFLAG ;
+
+    // check template noise for synthetic filters from spectrograph           
+    if ( (IFLAG_TEMPLATE & 2)>0 && IFLAG_SYNFILT==1 ) {
+      SIMLIB_OBS_GEN.TEMPLATE_SKYSIG[NEP]    = SKYSIG_T ;
+      SIMLIB_OBS_GEN.TEMPLATE_READNOISE[NEP] = RDNOISE_T ;
+      SIMLIB_OBS_GEN.TEMPLATE_ZPT[NEP]       = ZPT_T ;
+    }
+
+
+    // check template noise for normal filters                                
+    if ( (IFLAG_TEMPLATE & 1)>0 && IFLAG_SYNFILT == 0 ) {
+
+      IFIELD = IFIELD_OVP_SIMLIB(1,FIELD);
+      if ( IFIELD < 0 || IFIELD >= MXFIELD_OVP_SIMLIB ) {
+	sprintf(c1err,"Invalid IFIELD=%d for template FIELD=%s",IFIELD,FIELD);
+	sprintf(c2err, "Check LIBID=%d  %s-band", GENLC.SIMLIB_ID,cfilt );
+	errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ;
+      }  
+
+      SKYSIG_T = SIMLIB_TEMPLATE.SKYSIG[IFIELD][IFILT_OBS] * SCALE_SKYSIG ;
+      SIMLIB_OBS_GEN.TEMPLATE_SKYSIG[NEP]    = SKYSIG_T ;	
+      SIMLIB_OBS_RAW.TEMPLATE_SKYSIG[OBSRAW] = SKYSIG_T ;
+      
+      RDNOISE_T = SIMLIB_TEMPLATE.READNOISE[IFIELD][IFILT_OBS]*SCALE_RDNOISE ;
+      SIMLIB_OBS_GEN.TEMPLATE_READNOISE[NEP]    = RDNOISE_T ;	
+      SIMLIB_OBS_RAW.TEMPLATE_READNOISE[OBSRAW] = RDNOISE_T ;
+
+      ZPT_T = SIMLIB_TEMPLATE.ZPT[IFIELD][IFILT_OBS] + SHIFT_ZPT ;
+      SIMLIB_OBS_GEN.TEMPLATE_ZPT[NEP]    = ZPT_T ;	
+      SIMLIB_OBS_RAW.TEMPLATE_ZPT[OBSRAW] = ZPT_T ;
+
+    } // end template 
+
+    MJD_LAST_KEEP = MJD ;
+  
+    // keep track of MJD nearest peak
+    DT = MJD - GENLC.PEAKMJD ; 
+    if ( fabs(DT) < fabs(GENLC.DTPEAK_MIN) ) 
+      { GENLC.IEPOCH_NEARPEAK = NEP ; GENLC.DTPEAK_MIN   = DT ;  }
+
+
+  } // end isort loop (REFACTOR)
+
+  return ;
+
+} // end SIMLIB_prepCadence
+
+
+// ==============================================
+void SIMLIB_prepCadence_RAW(void) {
+
+  // Oct 2026: moved from SIMLIB_prepCadence so that it can also be 
+  //           used to fill SIMLIB_CACHE.
+  // For new cadence in SIMLIB_OBS_RAW,
+  //   1) prepare duplicate MJDs for sorting, and sort MJDs
+  //   2) sanity checks on values
+  //   3) check change of units for PSF and SKYSIG
+
+  int NOBS_RAW = SIMLIB_HEADER.NOBS ;
+  int ISTORE, OPTLINE ;
+  double PIXSIZE, PSF_ORIG ;
+  char *UNIT ;
+
+  // --------------- BEGIN ----------------
+
+  for(ISTORE=0; ISTORE < NOBS_RAW ; ISTORE++ ) {
+
+    // 1a. prep duplicate MJDs
+    SIMLIB_prepMJD_forSORT(ISTORE);
+
+    OPTLINE  = SIMLIB_OBS_RAW.OPTLINE[ISTORE] ;
+    if ( OPTLINE != OPTLINE_SIMLIB_S ) { continue ; }
+
+    // 2. sanity checks to catch crazy [nan] values. Second arg is NVAL=1
+    checkval_D("ZPTAVG", 1, &SIMLIB_OBS_RAW.ZPTADU[ISTORE],  6.0, 50.0) ;
+    checkval_D("ZPTSIG", 1, &SIMLIB_OBS_RAW.ZPTSIG[ISTORE],  0.0, 5.0 ) ;
+    checkval_D("PSF1",   1, &SIMLIB_OBS_RAW.PSFSIG1[ISTORE], 0.0, 9.9 );
+    checkval_D("PSF2",   1, &SIMLIB_OBS_RAW.PSFSIG2[ISTORE], 0.0, 9.9 );
+    checkval_D("PSFrat", 1, &SIMLIB_OBS_RAW.PSFRATIO[ISTORE],0.0, 1.0 );
+    checkval_D("SKYSIG", 1, &SIMLIB_OBS_RAW.SKYSIG[ISTORE],  0.0, 1.0E5 );
+
+    PIXSIZE = SIMLIB_OBS_RAW.PIXSIZE[ISTORE] ; 
+
+    // 3a. unit check for optional units of PSF and SKYSIG
+    UNIT = SIMLIB_GLOBAL_HEADER.PSF_UNIT ;
+    if ( strcmp(UNIT,SIMLIB_PSF_ASECFWHM ) == 0 ) {
+      PSF_ORIG = SIMLIB_OBS_RAW.PSFSIG1[ISTORE] ;
+      // convert FWHM(arcsec) back to Sigma(pixels)
+      SIMLIB_OBS_RAW.PSFSIG1[ISTORE] /= (PIXSIZE * FWHM_SIGMA_RATIO);
+      SIMLIB_OBS_RAW.PSFSIG2[ISTORE] /= (PIXSIZE * FWHM_SIGMA_RATIO);
+    }
+    
+    // 3b. check for optional units of SKYSIG
+    UNIT = SIMLIB_GLOBAL_HEADER.SKYSIG_UNIT ;
+    if ( strcmp(UNIT,SIMLIB_SKYSIG_SQASEC ) == 0 ) {
+      // convert SKYSIG per sqrt(asec^2) back into pixel
+      SIMLIB_OBS_RAW.SKYSIG[ISTORE] *= PIXSIZE ;
+    }
+    
+  } // end ISTORE loop over everything read from cadence
+
+  // -------------------------------------------
+  // 1b. sort MJDs for new LIBID only 
+
+  SIMLIB_sortbyMJD();
+
+  return ;
+
+} // end SIMLIB_prepCadence_RAW
+
+
+// ====================================================	
+void store_SIMLIB_SPECTROGRAPH(int ifilt, double *VAL_STORE, int ISTORE) {
+
+  // Read info following SPECTROGRAPH key in SIMLIB,
+  // and store in SIMLIB_OBS_RAW struct.
+  //
+  // Inputs:
+  //  ifilt     --> sparse spectrograph-filter index
+  //  VAL_STORE --> MJD,TEXPOSE,INDX_TAKE_SPECTRUM  if MJD > 0
+  //  ISTORE    --> storage index for SIMLIB_OBS_RAW
+  //
+  // When ifilt=0, read rest of SIMLIB line
+  //
+  //
+  // Aug 22 2017: remove *fp argument and use fp_SIMLIB for LEGACY only.
+  //              Change is made to work with refactored SIMLIB routines.
+  //
+  //
+  // Aug 23 2017: as part of refactor move lots of local code 
+  //              into new functino get_SPECTROGRAPH_ZPTPSFSKY
+  //
+
+  int    LDMP = ( ifilt < 0 ) ;
+  int    ifilt_obs, IFLAG_TEMPLATE, LCUT;
+  int    INDX_TAKE_SPECTRUM ;
+  double MJD, TEXPOSE_S, TEXPOSE_T ;
+  double ZPT, SKYSIG_S,  SKYSIG_T, PSFSIG  ;
+
+  double TSCALE = INPUTS.SPECTROGRAPH_OPTIONS.SCALE_TEXPOSE ;
+
+  char   cfilt[2] ;
+  char   fnam[] = "store_SIMLIB_SPECTROGRAPH" ;
+
+  // --------------- BEGIN ---------------
+
+  // strip off MJD and TEXPOSE from 1st time these
+  // quantites were read (i.e., for ISTORE at ifilt=0)
+  if ( ifilt == 0 ) {
+
+    if ( VAL_STORE[0] < 0.0 ) {
+
+      MJD       = SIMLIB_OBS_RAW.MJD[ISTORE] ;
+      TEXPOSE_S = SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[ISTORE] ;
+      INDX_TAKE_SPECTRUM  = SIMLIB_OBS_RAW.INDX_TAKE_SPECTRUM[ISTORE];
+
+      VAL_STORE[0] = MJD ;
+      VAL_STORE[1] = TEXPOSE_S ;
+      VAL_STORE[2] = (double)INDX_TAKE_SPECTRUM ;
+    }
+    else {
+      // use passed arguments from TAKE_SPECTRUM
+      MJD                     = VAL_STORE[0] ;
+      TEXPOSE_S               = VAL_STORE[1] ;
+      INDX_TAKE_SPECTRUM      = (int)VAL_STORE[2] ;
+    }
+
+    SIMLIB_OBS_RAW.MJD[ISTORE]                  = MJD ;
+    SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[ISTORE] = TEXPOSE_S * TSCALE ;
+    SIMLIB_OBS_RAW.INDX_TAKE_SPECTRUM[ISTORE]   = INDX_TAKE_SPECTRUM ; 
+
+    store_GENSPEC(VAL_STORE) ; // Mar 20 2017
+
+    SIMLIB_OBS_RAW.MJD[ISTORE]  = VAL_STORE[0]; // in case MJD changes
+
+
+  } // end ifilt=0
+
+  
+  // note that ISTORE-ifilt is the SPECTROGRAPH index with ifilt=0
+  MJD       = SIMLIB_OBS_RAW.MJD[ISTORE-ifilt] ;
+  TEXPOSE_S = SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[ISTORE-ifilt] ; // search
+  INDX_TAKE_SPECTRUM = SIMLIB_OBS_RAW.INDX_TAKE_SPECTRUM[ISTORE-ifilt] ;
+
+  TEXPOSE_T = SIMLIB_TEMPLATE.TEXPOSE_SPECTROGRAPH ;          // template
+  IFLAG_TEMPLATE = ( TEXPOSE_T > 0.01 ) ;
+
+  LCUT = 
+    ( TEXPOSE_T > INPUTS_SPECTRO.TEXPOSE_MIN ) && 
+    ( TEXPOSE_T < INPUTS_SPECTRO.TEXPOSE_MAX ) ;
+
+  if ( IFLAG_TEMPLATE && LCUT==0 ) {
+    sprintf(c1err,
+	    "\n\t Invalid TEMPLATE_TEXPOSE_SPECTROGRAPH = %.1f in SIMLIB",
+            TEXPOSE_T);
+    sprintf(c2err,"Valid range is %.2f to %.2f sec",
+            INPUTS_SPECTRO.TEXPOSE_MIN, INPUTS_SPECTRO.TEXPOSE_MAX);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ) ;
+  }
+
+
+  // load successive filters 
+  SIMLIB_OBS_RAW.MJD[ISTORE]                  = MJD ;
+  SIMLIB_OBS_RAW.TEXPOSE_SPECTROGRAPH[ISTORE] = TEXPOSE_S ;
+  SIMLIB_OBS_RAW.INDX_TAKE_SPECTRUM[ISTORE]   = INDX_TAKE_SPECTRUM ;
+
+  if ( LDMP) {
+    printf(" xxx ------------- %s DUMP ------------------- \n", fnam); 
+    printf(" xxx ifilt=%d  ISTORE=%d  MJD=%.3f\n", 
+	   ifilt, ISTORE, MJD ); 
+    fflush(stdout);
+  }
+
+  if ( GENLC.NFILTDEF_SPECTROGRAPH == 0 ) 
+    { ifilt_obs=0 ; goto  STORE_SIMLIB_RAW ; }
+
+  ifilt_obs = GENLC.IFILTDEF_SPECTROGRAPH[ifilt] ;
+  sprintf(cfilt,  "%c", FILTERSTRING[ifilt_obs] ) ;
+
+
+  /* xxxxxxxxx mark delete xxxxxxxx
+  printf(" xxx %s: ISTORE=%d  MJD=%.3f   ifilt=%d  ifilt_obs=%d \n",
+	 fnam, ISTORE, MJD, TEXPOSE_S, ifilt, ifilt_obs ); 
+  fflush(stdout);
+  xxxxxxxxxxxxxxxxx */
+
+
+  if ( GENLC.IFLAG_SYNFILT_SPECTROGRAPH[ifilt_obs] == 0 ) {
+    sprintf(c1err,"Invalid %s-filter is not a SYN-FILTER ?", cfilt );  
+    sprintf(c2err,"Check SYN-FILTERs in kcor input file.");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ) ; 
+  }
+
+  get_SPECTROGRAPH_ZPTPSFSKY(ISTORE, ifilt, TEXPOSE_S, TEXPOSE_T,   // inputs
+			     &ZPT, &PSFSIG, &SKYSIG_S, &SKYSIG_T ); // returned
+
+
+ STORE_SIMLIB_RAW:
+
+  SIMLIB_OBS_RAW.IFILT_OBS[ISTORE]  = ifilt_obs ;
+  sprintf(SIMLIB_OBS_RAW.BAND[ISTORE],"%s", cfilt );
+
+  SIMLIB_OBS_RAW.CCDGAIN[ISTORE]    = 1.0 ; // unity GAIN 
+  SIMLIB_OBS_RAW.READNOISE[ISTORE]  = 0.0 ;
+  SIMLIB_OBS_RAW.SKYSIG[ISTORE]     = SKYSIG_S ; // noise per pixel or arcsec^2
+  SIMLIB_OBS_RAW.PSFSIG1[ISTORE]    = PSFSIG ;   // sigma1
+  SIMLIB_OBS_RAW.PSFSIG2[ISTORE]    = 0.0 ;  // sigma2
+  SIMLIB_OBS_RAW.PSFRATIO[ISTORE]   = 0.0 ;  // ratio of two Gaussians
+  SIMLIB_OBS_RAW.ZPTADU[ISTORE]     = ZPT ;  // TEXPOSE zero point (pe)
+  SIMLIB_OBS_RAW.ZPTSIG[ISTORE]     = 0.0 ;  // no error; included in SKYSIG
+  SIMLIB_OBS_RAW.MAG[ISTORE]        = 99.0; 
+
+  // set optional template noise for passbands made from spectrograph
+  if ( IFLAG_TEMPLATE ) {
+    SIMLIB_TEMPLATE.USEFLAG |= 2;
+    SIMLIB_OBS_RAW.TEMPLATE_SKYSIG[ISTORE]    = SKYSIG_T ; 
+    SIMLIB_OBS_RAW.TEMPLATE_READNOISE[ISTORE] = 0.0 ;
+    SIMLIB_OBS_RAW.TEMPLATE_ZPT[ISTORE]       = ZPT ;
+    
+    /*
+    printf(" xxx ifilt_obs=%2d : SKYSIG(S/T) = %.2f/%.2f = %.3f "
+	   "TEXPOSE(S,T)=%.1f,%.1f \n", 
+	   ifilt_obs, SKYSIG_S, SKYSIG_T, SKYSIG_S/SKYSIG_T,
+	   TEXPOSE_S, TEXPOSE_T );    */
+  }
+
+  return ;
+
+} // end store_SIMLIB_SPECTROGRAPH
+
+// =================================================
+void get_SPECTROGRAPH_ZPTPSFSKY(int OBSRAW, int ifilt,
+				double TEXPOSE_S, double TEXPOSE_T,
+				double *ZPT, double *PSFSIG, 
+				double *SKYSIG_S, double *SKYSIG_T) {
+
+  // Created Aug 12 2017
+  // For input exposure times (TEXPOSE_S,TEXPOSE_T), 
+  // compute and return
+  //  + ZPT       (zero point for search)
+  //  + PSFSIG    (sigma of PSF)
+  //  + SKYSIG_S  (search SKY sigma)
+  //  + SKYSIG_T  (template SKY sigma)
+  //
+  // Mar 11 2018: fix PIXSIZE to depend on OBSRAW
+
+  // get min/max wavelentgh of syn filter
+  double LAMMIN  = INPUTS_SPECTRO.SYN_FILTERLIST_LAMMIN[ifilt] ;
+  double LAMMAX  = INPUTS_SPECTRO.SYN_FILTERLIST_LAMMAX[ifilt] ;
+  double MJD     = SIMLIB_OBS_RAW.MJD[OBSRAW]; // for debug
+  double PIXSIZE = SIMLIB_OBS_RAW.PIXSIZE[OBSRAW]; 
+  int ifilt_obs  = GENLC.IFILTDEF_SPECTROGRAPH[ifilt] ;
+  int NBT        = INPUTS_SPECTRO.NBIN_TEXPOSE ;
+  int IFLAG_TEMPLATE = ( TEXPOSE_T > 0.01 ) ;
+  int UNIT_IS_ARCSEC = 
+    ( strcmp(SIMLIB_GLOBAL_HEADER.SKYSIG_UNIT,SIMLIB_SKYSIG_SQASEC )==0) ;
+
+  int l,  NBLAM ;
+  int OPT_INTERP = 1; // linear
+  int LDMP = 0 ;
+  double LCEN, LBINMIN, LBINMAX, ZSUM, ZPLAM ;
+  double SQSKY_S, SQSKY_T, SQSUM_S, SQSUM_T ;
+  double PSFSIG_PIXEL, PSFSIG_ARCSEC, PSF_ARCSECFWHM, NEA ;
+
+  char fnam[] = "get_SPECTROGRAPH_ZPTPSFSKY" ;
+  char STR_ZPLAM[]   = "get_ZPTPSFSKY(ZPLAM)";
+  char STR_SQSIG_S[] = "get_ZPTPSFSKY(SQSIG_S)";
+  char STR_SQSIG_T[] = "get_ZPTPSFSKY(SQSIG_T)";
+
+  // ---------------- BEGIN -------------
+
+  // init output args
+  *ZPT = *SKYSIG_S = *SKYSIG_T = *PSFSIG = 0.0 ;
+
+  // bail if filter is not requested by user.
+
+  if ( GENLC.IFILTINVMAP_OBS[ifilt_obs] < 0 ) { return ; }
+
+
+  ZSUM = SQSUM_S = SQSUM_T = 0.0 ;   NBLAM=0 ;
+  for(l=0; l < INPUTS_SPECTRO.NBIN_LAM; l++ ) {
+
+    LBINMIN = INPUTS_SPECTRO.LAMMIN_LIST[l] ;  // of spectral bin
+    LBINMAX = INPUTS_SPECTRO.LAMMAX_LIST[l] ;    
+    LCEN    = 0.5 * (LBINMIN + LBINMAX) ; // bin center
+
+    // keep bin if its center is withing the user-defined
+    // wavelength range in the kcor-input file.
+    if ( LCEN < LAMMIN ) { continue ; }
+    if ( LCEN > LAMMAX ) { continue ; }
+
+    // interpolate ZPLAM(pe) for this exposure time, at this lambda
+    ZPLAM = interp_1DFUN(OPT_INTERP, TEXPOSE_S, NBT,
+			 INPUTS_SPECTRO.TEXPOSE_LIST, 
+			 INPUTS_SPECTRO.ZP[l], STR_ZPLAM);
+    ZSUM    += pow(TEN, 0.4*ZPLAM) ;
+
+    // interpolate SQSIGSKY
+    SQSKY_S = interp_1DFUN(OPT_INTERP, TEXPOSE_S, NBT,
+			   INPUTS_SPECTRO.TEXPOSE_LIST, 
+			   INPUTS_SPECTRO.SQSIGSKY[l], STR_SQSIG_S);
+    SQSUM_S += SQSKY_S ; 
+
+    if ( IFLAG_TEMPLATE ) {
+      SQSKY_T = interp_1DFUN(OPT_INTERP, TEXPOSE_T, NBT,
+			     INPUTS_SPECTRO.TEXPOSE_LIST, 
+			     INPUTS_SPECTRO.SQSIGSKY[l], STR_SQSIG_T);
+      SQSUM_T += SQSKY_T ; 
+    }
+
+    NBLAM++ ; 
+
+    if ( LDMP ==5 ) { 
+      double L0 = INPUTS.LAMMIN_OBS[ifilt_obs];
+      double L1 = INPUTS.LAMMAX_OBS[ifilt_obs];
+      printf(" xxx LCEN=%.1f (%.1f:%.1f) ZPLAM=%.3f \n", 
+	     LCEN, L0, L1, ZPLAM );
+    }
+  }  // end l loop over lambda bins
+
+
+  if ( ZSUM == 0.0 ) {
+    printf("\n PRE-ABORT DUMP \n");
+    printf("   for SYN_FILTER='%c' (ifilt_obs=%d)\n",
+	   FILTERSTRING[ifilt_obs], ifilt_obs ) ; 
+    printf("   LAMRANGE = %.1f to %.1f  at  MJD=%.3f \n",
+	    INPUTS.LAMMIN_OBS[ifilt_obs], 
+	    INPUTS.LAMMAX_OBS[ifilt_obs], MJD );
+
+    sprintf(c1err,"No spectro-bin center overlaps SYN_FILTER='%c'",
+	    FILTERSTRING[ifilt_obs] );
+    sprintf(c2err,"--> FLUX=0.  Try wider SYN_FILTER.");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ) ; 
+  }
+
+  // get ZPT of all spectrograph slices summed into one band
+  *ZPT = 2.5*log10(ZSUM) ;
+ 
+  // define artificial PSF to get sky noise per pixel 
+  PSF_ARCSECFWHM = 1.0 ; // 1'' FWHM   
+  PSFSIG_ARCSEC  = PSF_ARCSECFWHM / 2.355 ;
+  PSFSIG_PIXEL   = PSFSIG_ARCSEC / PIXSIZE ;
+  if ( UNIT_IS_ARCSEC )  { 
+    *PSFSIG = PSF_ARCSECFWHM ;   // later gets converted back to SIGMA
+    NEA    = 2.0 * TWOPI * (PSFSIG_ARCSEC * PSFSIG_ARCSEC ) ;
+  } 
+  else  { 
+    *PSFSIG = PSFSIG_PIXEL ; 
+     NEA    = 2.0 * TWOPI * (PSFSIG_PIXEL  * PSFSIG_PIXEL ) ;
+  }
+
+
+  // get skyNoise per pixel (or per sqArcSec)
+  *SKYSIG_S = sqrt(SQSUM_S/NEA) ; // noise per pixel or arcsec^2
+  if ( IFLAG_TEMPLATE )  { 
+    *SKYSIG_T  = sqrt(SQSUM_T/NEA);  // template sky noise
+    *SKYSIG_T *= ( TEXPOSE_S/TEXPOSE_T ); // scale template to search image
+  }
+
+  if ( LDMP ) {
+    printf(" xxx -------------------------------------- \n");
+    printf(" xxx synBand %c : TEXPOSE[S,T] = %.1f , %.1f \n",
+	   FILTERSTRING[ifilt_obs], TEXPOSE_S, TEXPOSE_T );
+    printf(" xxx synBand %c : %.0f-%.0f  "
+	   "MJD=%.3f ZPT=%.3f  PSF=%.2f  SKYSIG=%.2f,%.2f\n",
+	   FILTERSTRING[ifilt_obs], 
+	   INPUTS.LAMMIN_OBS[ifilt_obs],
+	   INPUTS.LAMMAX_OBS[ifilt_obs],
+	   MJD, *ZPT, *PSFSIG, *SKYSIG_S, *SKYSIG_T ); fflush(stdout);
+  }
+  
+  return ;
+
+} // end get_SPECTROGRAPH_ZPTPSFSKY
+
+
+// =================================================
+int keep_SIMLIB_OBS(int isort, int REPEAT) {
+
+  // Created Aug 2017
+  // Return 1 of this raw-OBS is kept.
+  // Return 0 to reject this OBS.
+  //
+  // Inputs:
+  //   OBS      = MJD-sort index; needed to get absolute OBS index
+  //   REPEAT   = 1 if this cadence is repeated
+  //
+  // Sep 24 2017: check field.
+
+  int  KEEP=1, NOKEEP=0; 
+  int  ifilt, ifilt_obs, OBS ;
+  int  LTRACE=0; 
+  double  MJD, MJDrange[2];
+  char *FIELD ;
+  char fnam[] = "keep_SIMLIB_OBS" ;
+
+  // ------------ BEGIN --------------
+
+  
+  if (LTRACE) {
+    printf(" xxx ---------------------------- \n");
+    printf(" xxx 0 isort=%d REPEAT=%d \n",isort,REPEAT); 
+  }
+  OBS  = SIMLIB_LIST_forSORT.INDEX_SORT[isort] ; // absolute OBS_RAW index
+
+
+  FIELD = SIMLIB_OBS_RAW.FIELDNAME[OBS] ;
+  MJD   = SIMLIB_OBS_RAW.MJD[OBS] ;
+
+  // compute & store SEASON info; return MJDrange to keep SIMLIB entries
+  set_SIMLIB_MJDrange(REPEAT,MJDrange);
+
+  if ( MJD < MJDrange[0] ) { return(NOKEEP); }
+  if ( MJD > MJDrange[1] ) { return(NOKEEP); }
+
+  if (LTRACE) {printf(" xxx 1 \n"); fflush(stdout); }
+  // check option to skip MJDs
+  if ( INPUTS.SIMLIB_NSKIPMJD > 0 ) {
+    float xskip = (float)(INPUTS.SIMLIB_NSKIPMJD+1) ;
+    float xline = (float)isort ;
+    float xmod  = fmodf(xline,xskip);
+    if ( xmod > 0.0 ) { return(NOKEEP); }
+  }
+
+
+  // check option to skip field 
+  if ( SKIP_SIMLIB_FIELD(FIELD) ) { return(NOKEEP); }
+
+  // apply PEAKMJD cut-window for SIMLIB_DUMP option (Feb 2013)
   // Skip this check for nominal use because OBS before/after
   // PEAKMJD can be used.
   if (LTRACE) {
@@ -15426,9597 +16488,10825 @@ int keep_SIMLIB_OBS(int isort, int REPEAT) {
 	   MJD, INPUTS.GENRANGE_PEAKMJD[0],INPUTS.GENRANGE_PEAKMJD[1] );
     fflush(stdout);
   }
-  if ( INPUTS.SIMLIB_DUMP >= 0 ) {      
-    if ( MJD < INPUTS.GENRANGE_PEAKMJD[0] ) { return(NOKEEP); }
-    if ( MJD > INPUTS.GENRANGE_PEAKMJD[1] ) { return(NOKEEP); }
+  if ( INPUTS.SIMLIB_DUMP >= 0 ) {      
+    if ( MJD < INPUTS.GENRANGE_PEAKMJD[0] ) { return(NOKEEP); }
+    if ( MJD > INPUTS.GENRANGE_PEAKMJD[1] ) { return(NOKEEP); }
+  }
+
+  // always apply MJD cut on MJD window (Aug 2017)
+  if (LTRACE) {
+    printf(" xxx 3 MJD=%f (CUTWIN_MJD: %.1f to %.1f) \n",
+	   MJD, INPUTS.GENRANGE_MJD[0], INPUTS.GENRANGE_MJD[1] );
+    fflush(stdout);
+  }
+  if ( MJD < INPUTS.GENRANGE_MJD[0] )  { return(NOKEEP); }
+  if ( MJD > INPUTS.GENRANGE_MJD[1] )  { return(NOKEEP); }
+  
+
+  // bail if this filter is not requested by user
+  ifilt_obs = SIMLIB_OBS_RAW.IFILT_OBS[OBS] ;
+  ifilt     = GENLC.IFILTINVMAP_OBS[ifilt_obs]; 
+  // xxx mark delete   ifilt     = GENLC.IFILTINVMAP_SIMLIB[ifilt_obs] ; 
+  if (LTRACE) {
+    printf(" xxx 4 ifilt=%d of %d\n",ifilt, GENLC.NFILTDEF_OBS ); 
+    fflush(stdout); 
+  }
+  if ( ifilt < 0                   ) { return(NOKEEP); }
+  if ( ifilt >= GENLC.NFILTDEF_OBS ) { return(NOKEEP); }
+
+  // if we get here, KEEP epoch
+  return(KEEP);
+
+} // end keep_SIMLIB_OBS
+
+// ==============================================
+void set_SIMLIB_MJDrange(int sameFlag, double *MJDrange) {
+
+  // 
+  // Return MJDrange
+  //
+  // Input: sameFlag=T if LIBID has not changed.
+  //    (sameFlag not used; obsolete)
+  //
+  // Output:  MJDrange[0:1] = range of MJD to keep SIMLIB entries
+  //
+  // Jan  6 2018: zHEL -> zCMB
+  // Mar 18 2018:
+  //  + NLINE starts at 0 (not 1) to fix bug that was removing
+  //    first epoch in season for ENTIRE_SEASON option.
+  //
+  // Mar 27 2018: check ENTIRE_SEASON & ENTIRE_SURVEY options
+  // Aug 06 2018: refactor by moving SEASON computation elsewhere
+  //
+
+  int    KEEP_ENTIRE_SEASON = 
+    (INPUTS.SIMLIB_MSKOPT & SIMLIB_MSKOPT_ENTIRE_SEASON );
+  int    KEEP_ENTIRE_SURVEY = 
+    (INPUTS.SIMLIB_MSKOPT & SIMLIB_MSKOPT_ENTIRE_SURVEY );
+
+  double PEAKMJD = GENLC.PEAKMJD ;
+  double z       = GENLC.REDSHIFT_CMB ;
+  double z1      = 1. + z ;
+  double Tpad = 0.1 ;
+  double Tmin = PEAKMJD + (z1* INPUTS.GENRANGE_TREST[0] ) - Tpad ;
+  double Tmax = PEAKMJD + (z1* INPUTS.GENRANGE_TREST[1] ) + Tpad ;
+  double TMPmin, TMPmax;
+  int    ISEASON; 
+  char fnam[] = "set_SIMLIB_MJDrange" ;
+
+  // -------------- BEGIN ------------
+
+  MJDrange[0] = -9.0 ;
+  MJDrange[1] = -9.0 ;
+
+  if ( KEEP_ENTIRE_SEASON && KEEP_ENTIRE_SURVEY ) {
+    sprintf(c1err,"Cannot specify ENTIRE_SEASON (%d) and ENTIRE_SURVEY(%d)",
+	    SIMLIB_MSKOPT_ENTIRE_SEASON, SIMLIB_MSKOPT_ENTIRE_SURVEY) ;
+    sprintf(c2err,"Pick one or neither in SIMLIB_MSKOPT key.");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ) ; 
+  }
+
+  if ( INPUTS.SIMLIB_DUMP >= 0 ) {
+    MJDrange[0] = INPUTS.GENRANGE_PEAKMJD[0] ;
+    MJDrange[1] = INPUTS.GENRANGE_PEAKMJD[1] ;
+    return ;
+  }
+
+
+  if ( KEEP_ENTIRE_SEASON ) {
+    // option: keep all MJDs in season if Trest range overlaps
+    // any part of season. e.g. useful for blind analysis challenge.
+    for(ISEASON=0; ISEASON < SIMLIB_HEADER.NSEASON; ISEASON++ ) {
+      TMPmin = SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][0] ;
+      TMPmax = SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][1] ;
+      if ( Tmax > TMPmin ) 
+	{ MJDrange[1] = TMPmax; }
+
+      if ( Tmin < TMPmax && MJDrange[0] < 0.0 ) 
+	{ MJDrange[0] = TMPmin; MJDrange[1] = TMPmax; }
+    } // end ISEASON loop
+    
+  }
+  else if ( KEEP_ENTIRE_SURVEY ) {
+    // keep every MJD in the entire survey (Mar 27 2018)
+    MJDrange[0] = SIMLIB_HEADER.MJDRANGE_SURVEY[0] ;
+    MJDrange[1] = SIMLIB_HEADER.MJDRANGE_SURVEY[1] ;
+  }
+  else {
+    // default: keep MJDs only within user-defined TREST range
+    MJDrange[0] = Tmin;
+    MJDrange[1] = Tmax;
+  }
+
+  // if user Tmin/Tmax range is completely outside SIMLIB MJD-range,
+  // return with MJDrange=-9,-9.
+  if ( Tmax < SIMLIB_HEADER.MJDRANGE_SURVEY[0]+Tpad ||
+       Tmin > SIMLIB_HEADER.MJDRANGE_SURVEY[1]-Tpad ) 
+    { 
+      MJDrange[0] = MJDrange[1] = -9.0 ;
+      return ; 
+    }
+
+  
+  // sanity tests
+  int ERRFLAG = ( MJDrange[0] < 0.0 || 
+		  MJDrange[1] < 0.0 || 
+		  MJDrange[0] > MJDrange[1] 
+		  );
+
+  // ------------ check dump option ---------------
+  int LDMP = 0 ;
+  if ( LDMP || ERRFLAG ) {
+    printf("\n xxx --------- SEASON DUMP for LIBID=%d --------------- \n",
+	   GENLC.SIMLIB_ID );
+    
+    for(ISEASON=0; ISEASON < SIMLIB_HEADER.NSEASON; ISEASON++ ) {
+      if ( ISEASON < MXSEASON_SIMLIB ) {
+	printf(" xxx ISEASON=%2d : MJDrange = %.3f to %.3f \n",
+	       ISEASON, 
+	       SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][0],
+	       SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][1]  );
+      }
+    }
+    printf(" xxx user Tmin, Tmax = %.1f to %.1f \n", Tmin, Tmax);
+
+    printf(" xxx MJDRANGE_SURVEY = %.3f to %.3f \n",
+	   SIMLIB_HEADER.MJDRANGE_SURVEY[0],
+	   SIMLIB_HEADER.MJDRANGE_SURVEY[1] );
+       
+    printf(" xxx KEEP_ENTIRE_[SEASON,SURVEY] = %d, %d \n",
+	   KEEP_ENTIRE_SEASON, KEEP_ENTIRE_SURVEY);
+
+    printf(" xxx PEAKMJD=%.3f  z=%.3f \n", PEAKMJD, z);
+    printf(" xxx MJDrange(keep) = %.3f to %.3f  (%d days)\n", 
+	   MJDrange[0], MJDrange[1], (int)(MJDrange[1]-MJDrange[0]) );
+    fflush(stdout);
+  } // end LDMP
+
+  if ( ERRFLAG ) {
+    sprintf(c1err,"Invalid MJDrange = %.3f to %.3f",
+	    MJDrange[0], MJDrange[1] );
+    sprintf(c2err,"Check SIMLIB and SEASON logic");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ) ; 
+  }
+
+  return ;
+
+} // end set_SIMLIB_MJDrange
+
+
+// ==============================================
+void store_SIMLIB_SEASONS(void) {
+
+  // Compute and store SIMLIB_HEADER.[seasonInfo]
+  //
+ 
+  double MJD, MJD_LAST;
+  int    isort, NLINE_MJD, NLINE, ISEASON, ISGAP, FIRST ;  
+  char fnam[] = "store_SIMLIB_SEASONS" ;
+
+  // -------------- BEGIN ------------
+
+  SIMLIB_HEADER.NSEASON = 1;
+  MJD_LAST = -9.0 ;
+  NLINE_MJD = SIMLIB_LIST_forSORT.NMJD;
+
+  for ( isort = 0; isort < NLINE_MJD; isort++ ) {
+
+    NLINE = SIMLIB_LIST_forSORT.INDEX_SORT[isort] ;
+
+    // strip off  MJD
+    MJD   = SIMLIB_OBS_RAW.MJD[NLINE] ;
+
+    // check first MJD in SIMLIB
+    FIRST = ( MJD_LAST < 0.0 ) ;
+
+    if ( FIRST )  { 
+      ISEASON=0; 
+      SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][0]  = MJD; 
+      SIMLIB_HEADER.MJDRANGE_SURVEY[0]           = MJD; 
+    }
+    SIMLIB_HEADER.MJDRANGE_SURVEY[1]             = MJD; 
+
+    // check for large time-gap which defines new season
+    ISGAP = ( MJD - MJD_LAST > TGAP_SEASON_SIMLIB ) ;
+    
+    if ( FIRST==0 && ISGAP ) { 
+      SIMLIB_HEADER.NSEASON++ ; 
+      ISEASON = SIMLIB_HEADER.NSEASON-1 ;
+      if ( ISEASON < MXSEASON_SIMLIB ) 
+	{ SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][0] = MJD; } // MJDmin
+    }
+    ISEASON = SIMLIB_HEADER.NSEASON-1 ;
+    if ( ISEASON < MXSEASON_SIMLIB ) 
+      { SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][1] = MJD; } // MJDmax
+    SIMLIB_OBS_RAW.ISEASON[NLINE] = ISEASON ;
+    MJD_LAST = MJD ;
+    
+  } // end isort loop
+
+
+  // compute season lengths
+  for(ISEASON=0; ISEASON < SIMLIB_HEADER.NSEASON; ISEASON++ ) {
+    SIMLIB_HEADER.TLEN_SEASON[ISEASON] =
+      SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][1] -
+      SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][0] ;
+  }
+
+  if ( SIMLIB_HEADER.NSEASON >= MXSEASON_SIMLIB ) {
+    sprintf(c1err,"Invalid NSEASON=%d  exceeds bound of %d",
+	    SIMLIB_HEADER.NSEASON, MXSEASON_SIMLIB ) ;
+    sprintf(c2err,"LIBID=%d ", GENLC.SIMLIB_ID );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ) ; 
+  }
+
+  // Aug 2018: check for minimum  Season length requirement 
+  remove_short_SIMLIB_SEASON();
+
+
+  // ------------ check dump option ---------------
+  int LDMP = 0 ;
+  if ( LDMP ) {
+    printf("\n xxx --------- SEASON DUMP for LIBID=%d --------------- \n",
+	   GENLC.SIMLIB_ID );
+    
+    for(ISEASON=0; ISEASON < SIMLIB_HEADER.NSEASON; ISEASON++ ) {
+      if ( ISEASON < MXSEASON_SIMLIB ) {
+	printf(" xxx ISEASON=%2d : MJDrange = %.3f to %.3f \n",
+	       ISEASON, 
+	       SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][0],
+	       SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][1]  );
+      }
+    }
+  } // end LDMP
+
+
+  return ;
+
+} // end store_SIMLIB_SEASONS
+
+// =========================================
+void remove_short_SIMLIB_SEASON(void) {
+
+  // Aug 2018
+  // If 1st or last season length is < INPUTS.SIMLIB_MINSEASON,
+  // remove short SEASON as if it didn't exist.
+  //
+  // Oct 15 2018
+  //  + Fix bug with   SIMLIB_HEADER.NSEASON = NSEASON ;
+  //
+
+  int    NSEASON   = SIMLIB_HEADER.NSEASON ;
+  double MINSEASON = INPUTS.SIMLIB_MINSEASON ;
+  char fnam[] = "remove_short_SIMLIB_SEASON" ;
+  int  LDMP=0;
+  int  iseason, FLAG_REMOVE[MXSEASON_SIMLIB] ;
+
+  double TLEN ;
+
+  int NSEASON_ORIG = NSEASON ;
+  double MJDRANGE_SEASON_ORIG[MXSEASON_SIMLIB][2];
+  double TLEN_SEASON_ORIG[MXSEASON_SIMLIB];
+
+  // ---------------- BEGIN -------------
+
+  if ( MINSEASON < 0.001 ) { return ; }
+
+  for(iseason=0; iseason < NSEASON; iseason++ )  { 
+    FLAG_REMOVE[iseason] = 0;
+    TLEN = SIMLIB_HEADER.TLEN_SEASON[iseason] ;
+    if ( TLEN < MINSEASON )  { FLAG_REMOVE[iseason] = 1; }
+  }
+
+
+  // store original seasons in separate array
+  for(iseason=0; iseason < NSEASON_ORIG; iseason++ ) {
+     MJDRANGE_SEASON_ORIG[iseason][0] = 
+       SIMLIB_HEADER.MJDRANGE_SEASON[iseason][0] ;
+     MJDRANGE_SEASON_ORIG[iseason][1] = 
+       SIMLIB_HEADER.MJDRANGE_SEASON[iseason][1] ;
+
+     TLEN_SEASON_ORIG[iseason] =
+       SIMLIB_HEADER.TLEN_SEASON[iseason] ;
+  }
+
+  // over-write SIMLIB_HEADER.[seasonInfo]
+  NSEASON=0 ;
+  for(iseason=0; iseason < NSEASON_ORIG; iseason++ ) {
+    if ( FLAG_REMOVE[iseason] ) { continue ; }
+
+    SIMLIB_HEADER.MJDRANGE_SEASON[NSEASON][0] = 
+      MJDRANGE_SEASON_ORIG[iseason][0];
+    SIMLIB_HEADER.MJDRANGE_SEASON[NSEASON][1] = 
+      MJDRANGE_SEASON_ORIG[iseason][1];
+
+    SIMLIB_HEADER.TLEN_SEASON[NSEASON] = TLEN_SEASON_ORIG[iseason] ;
+    NSEASON++ ;
+  }
+
+  if ( NSEASON > 0 ) {
+    SIMLIB_HEADER.MJDRANGE_SURVEY[0] = 
+      SIMLIB_HEADER.MJDRANGE_SEASON[0][0] - 0.1;
+    SIMLIB_HEADER.MJDRANGE_SURVEY[1] = 
+      SIMLIB_HEADER.MJDRANGE_SEASON[NSEASON-1][1] + 0.1;
+  }
+  else {
+    SIMLIB_HEADER.MJDRANGE_SURVEY[0] = -9.0 ;
+    SIMLIB_HEADER.MJDRANGE_SURVEY[1] = -9.0 ;
+  }
+
+  // -------------------------------------
+  if ( LDMP ) {
+    char cstatus[12];
+    printf("\n xxx ================================== \n");
+    printf(" xxx DUMP  %s  for  LIBID=%d  CID=%d\n", 
+	   fnam, SIMLIB_HEADER.LIBID, GENLC.CID );
+    for(iseason=0; iseason < NSEASON_ORIG; iseason++ ) {
+      if( FLAG_REMOVE[iseason] )
+	{ sprintf(cstatus,"Removed"); }
+      else
+	{ sprintf(cstatus,"Kept"); }
+      printf(" xxx Original SEASON %d: %.1f to %.1f (%.1f days)  %s \n"
+	     ,iseason
+	     ,MJDRANGE_SEASON_ORIG[iseason][0]
+	     ,MJDRANGE_SEASON_ORIG[iseason][1]
+	     ,TLEN_SEASON_ORIG[iseason]
+	     ,cstatus );
+    } // end iseason
+
+    printf(" xxx NSEASON(final)=%d  (%.3f to %.3f) \n",
+	   NSEASON, 
+	   SIMLIB_HEADER.MJDRANGE_SURVEY[0],
+	   SIMLIB_HEADER.MJDRANGE_SURVEY[1] );
+    
+    fflush(stdout);
+  }
+
+  SIMLIB_HEADER.NSEASON = NSEASON ; 
+
+  return ;
+
+} // end  remove_short_SIMLIB_SEASON
+
+
+// ==============================================
+void SIMLIB_prepMJD_forSORT(int ISTORE) {
+
+  // Created Aug 21 2017
+  // Increment SIMLIB_LIST_forSORT to use later for
+  // sorting MJD. This routing does NOT do the actual
+  // MJD sorting, but prepares for duplicate MJDs to
+  // preserve SIMLIB-order and avoid random re-order.
+  // For each duplicate MJD, add 0.000001 so that 
+  // sorting will preserve order.
+
+  double MJD, MJD_DIF, MJD_LAST;
+  char fnam[] = "SIMLIB_prepMJD_forSORT" ;
+
+  // --------------BEGIN --------------
+
+  MJD      = SIMLIB_OBS_RAW.MJD[ISTORE] ;
+  MJD_LAST = SIMLIB_LIST_forSORT.MJD_LAST ;
+  MJD_DIF  = MJD - MJD_LAST ;
+  SIMLIB_LIST_forSORT.MJD[ISTORE] = MJD; 
+  if ( fabs(MJD_DIF) < 0.0001 ) {
+    SIMLIB_LIST_forSORT.MJD[ISTORE] = 
+      SIMLIB_LIST_forSORT.MJD[ISTORE-1] + 0.00001 ;  // about 1 second
+  }
+  SIMLIB_LIST_forSORT.MJD_LAST    = MJD ;
+
+  return ;
+
+} // end  SIMLIB_prepMJD_forSORT
+
+
+// ============================
+void SIMLIB_sortbyMJD(void) {
+
+  // Created Jan 17 2018
+  // Sort SIMLIB MJDs. Tricky part is that entries with
+  // APPEND_PHOTFLAG>0 are NOT to be sorted, but left at
+  // the end of the list. The unsorted MJDs allow re-generating
+  // the exact same light curves for sorted MJDs, and then 
+  // appending new Light curve data. This can happen when
+  // observations are used to define new sets of observations.
+  // Initial use: WFIRST-imaging triggers IFC(spectra),
+  // which overlaps more imaging that appends observations.
+
+  int NOBS_RAW    = SIMLIB_HEADER.NOBS ;
+  int NOBS_APPEND = SIMLIB_HEADER.NOBS_APPEND ;
+  int NOBS_SORT   = NOBS_RAW - NOBS_APPEND ;
+  int  ORDER_SORT = +1 ; // increasing order
+  int  isort;
+  char fnam[] = "SIMLIB_sortbyMJD" ;
+
+  // ------------- BEGIN --------------
+
+  if ( NOBS_SORT < 1 ) {
+    sprintf(c1err,"Invalid NOBS_SORT=%d for LIBID=%d CID=%d", 
+	    NOBS_SORT, SIMLIB_HEADER.LIBID, GENLC.CID );
+    sprintf(c2err,"NOBS_RAW=%d  NOBS_APPEND=%d", 
+	    NOBS_RAW, NOBS_APPEND);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
+  }
+
+  sortDouble( NOBS_SORT, SIMLIB_LIST_forSORT.MJD, ORDER_SORT, 
+	      SIMLIB_LIST_forSORT.INDEX_SORT ) ;  // return array
+  
+  // if there are unsorted MJDs, add them to the back fo the sort-list
+  if ( NOBS_SORT < NOBS_RAW ) {
+    for ( isort = NOBS_SORT-1; isort < NOBS_RAW; isort++ ) {
+      SIMLIB_LIST_forSORT.INDEX_SORT[isort] = isort ; 
+    }
+  }
+
+  SIMLIB_LIST_forSORT.NMJD = NOBS_RAW ;
+  return ;
+
+} // end of  SIMLIB_sortbyMJD(
+
+// ====================================================
+void store_GENSPEC(double *VAL_STORE) {
+
+  // load GENSPEC array
+  // Input VAL_STORE :
+  //  MJD
+  //  TEXPOSE
+  //  INDX_TAKE_SPECTRUM  if MJD > 0
+  //
+  // Aug 23 2017: set VAL_STORE[0] = MJD in case MJD changes
+  // Mar 01 2019: remove LEGACY flag option
+
+  double MJD     = VAL_STORE[0];
+  double TEXPOSE = VAL_STORE[1];
+  int    INDX    = (int)VAL_STORE[2];  // for TAKE_SPECTRUM 
+  double z       = GENLC.REDSHIFT_CMB;
+  double z1      = 1.0 + z;
+
+  double TOBS, TREST ;
+  int OPT_TEXPOSE, imjd ;
+  char fnam[] = "store_GENSPEC" ;
+
+  // -------------- BEGIN ---------------
+
+  imjd        = INDX ;
+
+  if ( NPEREVT_TAKE_SPECTRUM > 0 ) 
+    {  OPT_TEXPOSE = INPUTS.TAKE_SPECTRUM[INDX].OPT_TEXPOSE ; }
+  else
+    { OPT_TEXPOSE = 0 ; }
+
+
+  if ( OPT_TEXPOSE == 0 )  { 
+    TOBS = MJD - GENLC.PEAKMJD ;  TREST = TOBS/z1;
+    GENSPEC.INDEX_TAKE_SPECTRUM[imjd]   = -9 ; 
+    GENSPEC.INV_TAKE_SPECTRUM[INDX]     = -9 ;
+  }
+  else if ( OPT_TEXPOSE > 0 ) {
+    MJD = GENSPEC_PICKMJD(1,INDX,z, &TOBS, &TREST) ; // return random MJD
+    GENSPEC.INDEX_TAKE_SPECTRUM[imjd] = INDX ;
+    GENSPEC.INV_TAKE_SPECTRUM[INDX]   = imjd;
+    GENSPEC_LAMOBS_RANGE(INDX,GENSPEC.LAMOBS_SNR_LIST[imjd] ); 
+  }
+
+  // adjust input MJD in case MJD changes. (Aug 23, 2017)
+  VAL_STORE[0] = MJD; 
+
+  GENSPEC.MJD_LIST[imjd]          = MJD ;
+  GENSPEC.TOBS_LIST[imjd]         = TOBS ;
+  GENSPEC.TREST_LIST[imjd]        = TREST; 
+  GENSPEC.TEXPOSE_LIST[imjd]      = TEXPOSE ;      
+  GENSPEC.OPT_TEXPOSE_LIST[imjd]  = OPT_TEXPOSE ;
+
+  GENSPEC.NMJD_TOT++ ;
+
+  /*
+  printf(" xxx %s: NMJD_TOT=%d  MJD=%.3f  TOBS=%.1f  (INDX=%d,OPT=%d)\n",
+	 fnam, GENSPEC.NMJD_TOT, MJD, TOBS, INDX,OPT_TEXPOSE ); fflush(stdout);
+  */
+
+  return ;
+
+} // end store_GENSPEC
+
+// ====================================================
+void init_SIMLIB_HEADER(void) {
+
+  // Created Apr 2016 to initialize SIMLIB_HEADER struct.
+  // Called for each event.
+
+  int i;
+  char fnam[] = "init_SIMLIB_HEADER" ;
+  // ------------ BEGIN ------------
+
+  SIMLIB_HEADER.REGEN_FLAG  = 0 ;
+  SIMLIB_HEADER.NOBS        = NULLINT ;
+  SIMLIB_HEADER.NOBS_APPEND = 0 ;
+  SIMLIB_HEADER.RA          = 9999. ;
+  SIMLIB_HEADER.DEC         = 9999. ;
+  SIMLIB_HEADER.FAKEID      = NULLINT ;
+  SIMLIB_HEADER.GALID       = NULLINT ;
+
+  SIMLIB_HEADER.GENRANGE_REDSHIFT[0] = -9.0 ;
+  SIMLIB_HEADER.GENRANGE_REDSHIFT[1] = -9.0 ;
+
+  SIMLIB_HEADER.CUTWIN_REDSHIFT[0] = -9.0 ; // wide open
+  SIMLIB_HEADER.CUTWIN_REDSHIFT[1] = 99.0 ;
+
+  init_GENGAUSS_ASYM( &SIMLIB_HEADER.GENGAUSS_PEAKMJD, (double)999. ) ;
+  init_GENGAUSS_ASYM( &SIMLIB_HEADER.GENGAUSS_SALT2x1, (double)999. ) ;
+  init_GENGAUSS_ASYM( &SIMLIB_HEADER.GENGAUSS_SALT2c,  (double)999. ) ;
+
+  sprintf(SIMLIB_HEADER.FIELD,"NULL");
+  SIMLIB_HEADER.SUBSURVEY_NAME[0] = 0 ;
+  // doesn't work  sprintf(SIMLIB_HEADER.SUBSURVEY_NAME, "NULL" );
+
+  SIMLIB_HEADER.NSEASON = 1 ;
+  for(i=0; i < MXSEASON_SIMLIB; i++ ) { SIMLIB_HEADER.USE_SEASON[i] = 0;}
+
+
+  sprintf(SIMLIB_HEADER.TELESCOPE,  "%s", SIMLIB_GLOBAL_HEADER.TELESCOPE) ;
+  SIMLIB_HEADER.PIXSIZE  = SIMLIB_GLOBAL_HEADER.PIXSIZE ;
+
+
+  return ;
+
+} // end init_SIMLIB_HEADER
+
+
+// ================================================
+void parse_SIMLIB_IDplusNEXPOSE(char *inString, int *IDEXPT, int *NEXPOSE) {
+
+  // Created Jan 3 2018
+  // If inString has no *   -->  IDEXPT = inString and NEXPOSE=1
+  // If inString = ID*NEXP  -->  IDEXPT = ID and NEXPOSE=NEXP
+
+  int  IDTMP, NTMP, NRD;
+  char star[] = "*" ;
+  char WDLIST[2][20], *ptrWDLIST[2];
+  char fnam[] = "parse_SIMLIB_IDplusNEXPOSE" ;
+
+  // ----------- BEGIN ------------
+
+  NTMP = 1;  // default
+
+  if ( strchr(inString,'*') == NULL ) {
+    // no star, just read IDEXPT
+    sscanf(inString , "%d", &IDTMP ); 
+  }
+  else {
+    // found star, read both ID and NEXPOSE
+    ptrWDLIST[0] = WDLIST[0] ;
+    ptrWDLIST[1] = WDLIST[1] ;
+    splitString(inString, star, 3,  &NRD, ptrWDLIST ); 
+    sscanf( WDLIST[0] , "%d", &IDTMP ); 
+    sscanf( WDLIST[1] , "%d", &NTMP ); 
+  }
+
+  // load output arguments
+  *IDEXPT  = IDTMP ;
+  *NEXPOSE = NTMP ;
+
+  /*
+  printf(" xxx %s: inString='%s'  NRD=%d   ID=%d  NEXPOSE=%d \n",
+	 fnam, inString, NRD, IDTMP, NTMP);
+  debugexit(fnam);
+  */
+
+  return ;
+
+} // end parse_SIMLIB_IDplusNEXPOSE
+
+// ================================================
+void parse_SIMLIB_GENRANGES(FILE *fp_SIMLIB, char *KEY) {
+
+  // Created Aug 2017
+  // Read optional GENRANGE_XXX keys.
+  //
+  // Inputs:
+  //   fp_SIMLIB : file pointer to SIMLIB file
+  //   KEY       : current simlib string to check
+  //
+  // Jan 4 2018: read optional DISTANCE key, and convert to zCMB
+
+  double RA  = SIMLIB_HEADER.RA ;
+  double DEC = SIMLIB_HEADER.DEC ;
+  double TMPVAL, TMPRANGE[2], dist, MU, zHel;
+  int    LTMP ;
+
+  char fnam[] = "parse_SIMLIB_GENRANGES" ;
+
+  // ------------ BEGIN ----------------
+
+
+  // Nov 2015: check optional CUTWIN_REDSHIFT so that each LIBID
+  //           can have its own z-range (originally for WFIRST study)
+  //    Note that this is a cut, not a range to generate.
+  if (  strcmp(KEY,"CUTWIN_REDSHIFT:") == 0  ||
+	strcmp(KEY,"REDSHIFT_RANGE:" ) == 0  ) 
+    { readdouble( fp_SIMLIB, 2, SIMLIB_HEADER.CUTWIN_REDSHIFT );   }
+  
+  // -------------------------------------------------
+  // ------------ READ GENRANGEs ---------------------
+  // -------------------------------------------------
+
+  // check for redshift value or range 
+  LTMP = 0 ;
+  if ( strcmp(KEY,"REDSHIFT:")==0 && INPUTS.USE_SIMLIB_REDSHIFT ) {
+    readdouble ( fp_SIMLIB, 1, &TMPVAL );
+    TMPRANGE[0] = TMPRANGE[1] = TMPVAL;  LTMP=1;
+  }
+  if ( strcmp(KEY,"DISTANCE:")==0 && INPUTS.USE_SIMLIB_DISTANCE ) {
+    readdouble ( fp_SIMLIB, 1, &dist );  // Lumi-distance (D_L), Mpc (Jan 2018)
+    MU = 5.0*log10(dist/1.0E-5);  // 10pc = 1.0E-5 Mpc
+    double H0 = INPUTS.H0 / ( 1.0E6 * PC_km) ;
+    double OM = INPUTS.OMEGA_MATTER;
+    double OL = INPUTS.OMEGA_LAMBDA;
+    double w0 = INPUTS.W0_LAMBDA ;
+    TMPVAL = zcmb_dLmag_invert(H0, OM, OL, w0, MU); // returns zCMB
+    TMPRANGE[0] = TMPRANGE[1] = TMPVAL;  LTMP=1;
+  }
+  if ( strcmp(KEY,"GENRANGE_REDSHIFT:")==0 ) {
+    readdouble ( fp_SIMLIB, 2, TMPRANGE );  LTMP=1;
+  }
+  if ( LTMP ) {
+    SIMLIB_HEADER.GENRANGE_REDSHIFT[0] = TMPRANGE[0] ;
+    SIMLIB_HEADER.GENRANGE_REDSHIFT[1] = TMPRANGE[1] ;
+    SIMLIB_HEADER.REGEN_FLAG = 1;
+  }
+
+  // check for optional PEAKMJD value or range in SIMLIB; 
+  LTMP=0;
+  if ( strcmp(KEY,"PEAKMJD:")==0  && INPUTS.USE_SIMLIB_PEAKMJD )  { 
+    readdouble ( fp_SIMLIB, 1, &TMPVAL ); 
+    TMPRANGE[0] = TMPRANGE[1] = TMPVAL;  LTMP=1;
+  }
+  if ( strcmp(KEY,"GENRANGE_PEAKMJD:") == 0   || 
+       strcmp(KEY,"GENRANGE_PKMJD:")   == 0  ) {
+    readdouble ( fp_SIMLIB, 2, TMPRANGE ) ;  LTMP=1 ;
+  }
+  if ( LTMP ) {
+    SIMLIB_HEADER.GENGAUSS_PEAKMJD.PEAK     = 0.5*(TMPRANGE[0]+TMPRANGE[1]);
+    SIMLIB_HEADER.GENGAUSS_PEAKMJD.RANGE[0] = TMPRANGE[0] ;
+    SIMLIB_HEADER.GENGAUSS_PEAKMJD.RANGE[1] = TMPRANGE[1] ;
+    SIMLIB_HEADER.REGEN_FLAG = 1;
+  }
+
+  // check for PEAKMJD sigma
+  if ( strcmp(KEY,"GENSIGMA_PEAKMJD:")==0  ) {
+    readdouble ( fp_SIMLIB, 1, &TMPVAL ); 
+    SIMLIB_HEADER.GENGAUSS_PEAKMJD.SIGMA[0] = TMPVAL ;
+    SIMLIB_HEADER.GENGAUSS_PEAKMJD.SIGMA[1] = TMPVAL ;
+  }
+
+
+  // check for SALT2c range & sigma
+  if ( strcmp(KEY,"GENRANGE_SALT2c:") == 0 ) {
+    readdouble ( fp_SIMLIB, 2, TMPRANGE );
+    SIMLIB_HEADER.GENGAUSS_SALT2c.PEAK     = 0.5*(TMPRANGE[0]+TMPRANGE[1]);
+    SIMLIB_HEADER.GENGAUSS_SALT2c.RANGE[0] = TMPRANGE[0] ;
+    SIMLIB_HEADER.GENGAUSS_SALT2c.RANGE[1] = TMPRANGE[1] ;
+    SIMLIB_HEADER.REGEN_FLAG = 1;
+  }
+  if ( strcmp(KEY,"GENSIGMA_SALT2c:") == 0 ) {
+    readdouble ( fp_SIMLIB, 1, &TMPVAL ); 
+    SIMLIB_HEADER.GENGAUSS_SALT2c.SIGMA[0] = TMPVAL ;
+    SIMLIB_HEADER.GENGAUSS_SALT2c.SIGMA[1] = TMPVAL ;
+  } 
+
+  // check for SALT2x1 range & sigma
+  if ( strcmp(KEY,"GENRANGE_SALT2x1:")==0 ) {
+    readdouble ( fp_SIMLIB, 2, TMPRANGE );   
+    SIMLIB_HEADER.GENGAUSS_SALT2x1.PEAK     = 0.5*(TMPRANGE[0]+TMPRANGE[1]);
+    SIMLIB_HEADER.GENGAUSS_SALT2x1.RANGE[0] = TMPRANGE[0] ;
+    SIMLIB_HEADER.GENGAUSS_SALT2x1.RANGE[1] = TMPRANGE[1] ;
+    SIMLIB_HEADER.REGEN_FLAG = 1;
+  }
+  if ( strcmp(KEY,"GENSIGMA_SALT2x1:") == 0 ) {
+    readdouble ( fp_SIMLIB, 1, &TMPVAL ); 
+    SIMLIB_HEADER.GENGAUSS_SALT2x1.SIGMA[0] = TMPVAL ;
+    SIMLIB_HEADER.GENGAUSS_SALT2x1.SIGMA[1] = TMPVAL ;
+  } 
+
+  return ;
+
+} // end parse_SIMLIB_GENRANGES
+
+
+int check_SIMLIB_GENRANGE(double *GENRANGE_ORIG, double *GENRANGE_NEW) {
+
+  // If GENRANGE_NEW has no overlap with GENRANGE_ORIG, return REJECT;
+  // otherwise return ACCEPT.
+  // If any part of GENRANGE_NEW is outisde GENRANGE_ORIG,
+  // modify GENRANGE_NEW so that it is contained inside GENRANGE_ORIG.
+  // Note that GENRANGE_NEW can change, but not GENRANGE_ORIG.
+
+  int REJECT = REJECT_FLAG ;
+
+  // --------------- BEGIN ------------
+
+  if ( GENRANGE_NEW[0] >= GENRANGE_ORIG[1] ) { return(REJECT); }
+  if ( GENRANGE_NEW[1] <= GENRANGE_ORIG[0] ) { return(REJECT); }
+  
+  // now make sure that GENRANGE_NEW is contained inside GENRANGE_ORIG
+  if ( GENRANGE_NEW[0] < GENRANGE_ORIG[0] ) 
+    { GENRANGE_NEW[0] = GENRANGE_ORIG[0];  }
+
+  if ( GENRANGE_NEW[1] > GENRANGE_ORIG[1] ) 
+    { GENRANGE_NEW[1] = GENRANGE_ORIG[1];  }
+
+  return(ACCEPT_FLAG);
+
+} // end check_SIMLIB_GENRANGE
+
+
+int regen_SIMLIB_GENRANGES(void) {
+
+  // Created Apr 13 2016 by R.Kessler
+  // called after reading each LIBID header,
+  // to check if anything needs to be re-generated.
+  //
+  // Functions returns +1 to keep event, -1 to reject.
+  //
+  // Initial motivation is to re-select PEAKMJD, redshift, 
+  // color and stretch for ABC method. 
+  //
+  // Jan 26 2018: fix bug and require HEADER-PEAKMJD>1000 to use it.
+
+  double tmpVal ;
+  int LTRACE = 0 ; 
+  int REJECT = REJECT_FLAG ;
+  double t0_old, z_old, x1_old, c_old ;
+  double t0_new, z_new, x1_new, c_new ;
+  char fnam[] = "regen_SIMLIB_GENRANGES" ;
+
+  // ------------ BEGIN -------------
+
+  if(LTRACE) {
+    printf(" xxx -----------CID=%d LIBID=%d -------------- \n",
+	   GENLC.CID, GENLC.SIMLIB_ID ) ;
+    printf(" xxx %s: 0 \n", fnam); 
+  }
+
+  // check if there is anything to regenerate
+  if ( SIMLIB_HEADER.REGEN_FLAG == 0 ) { return(ACCEPT_FLAG); }
+
+  if ( SIMLIB_HEADER.FAKEID > 0 ) 
+    { GENLC.CID = SIMLIB_HEADER.FAKEID ; }
+
+
+  if ( LTRACE ) {
+    t0_old = GENLC.PEAKMJD ;
+    z_old  = GENLC.REDSHIFT_CMB ; 
+    x1_old = GENLC.SALT2x1 ;  
+    c_old  = GENLC.SALT2c ;
+  }
+
+  //check redshift update 
+  double *ZWIN = SIMLIB_HEADER.GENRANGE_REDSHIFT ;
+  if(LTRACE) {printf(" xxx %s: 1 ZWIN=%f,%f\n", fnam,ZWIN[0],ZWIN[1] ); }
+  if ( ZWIN[0] > 1.0E-5 ) {
+    tmpVal = genz_hubble( ZWIN[0], ZWIN[1], &INPUTS.RATEPAR );
+    if(LTRACE) {printf(" xxx %s: 1b ZGEN=%f\n", fnam,tmpVal ); }
+    if ( tmpVal < INPUTS.GENRANGE_REDSHIFT[0] ) { return(REJECT); }
+    if ( tmpVal > INPUTS.GENRANGE_REDSHIFT[1] ) { return(REJECT); }
+    GENLC.REDSHIFT_CMB     = tmpVal ;
+    gen_distanceMag(GENLC.REDSHIFT_CMB, GENLC.REDSHIFT_CMB, // to fix later
+		    &GENLC.DLMU, &GENLC.LENSDMU);
+  }
+
+  // check PEAKMJD update
+  if(LTRACE) {printf(" xxx %s: 2 PEAKMJD=%f\n", fnam,GENLC.PEAKMJD ); }
+  if ( SIMLIB_HEADER.GENGAUSS_PEAKMJD.PEAK > 1000.0 ) {
+    tmpVal         = exec_GENGAUSS_ASYM(&SIMLIB_HEADER.GENGAUSS_PEAKMJD) ;
+    GENLC.PEAKMJD  = tmpVal ;  
+    if ( tmpVal < INPUTS.GENRANGE_PEAKMJD[0] ) { return(REJECT); }
+    if ( tmpVal > INPUTS.GENRANGE_PEAKMJD[1] ) { return(REJECT); }
+  }
+
+
+  if(LTRACE) {printf(" xxx %s: 3 SALT2x1=%f\n", fnam,GENLC.SALT2x1 ); }
+  if ( fabs(SIMLIB_HEADER.GENGAUSS_SALT2x1.PEAK) < 90. ) {
+    tmpVal         = exec_GENGAUSS_ASYM(&SIMLIB_HEADER.GENGAUSS_SALT2x1);
+    GENLC.SALT2x1  = tmpVal ;
+    if ( tmpVal < INPUTS.GENGAUSS_SALT2x1.RANGE[0] ) { return(REJECT); }
+    if ( tmpVal > INPUTS.GENGAUSS_SALT2x1.RANGE[1] ) { return(REJECT); }
   }
 
-  // always apply MJD cut on MJD window (Aug 2017)
-  if (LTRACE) {
-    printf(" xxx 3 MJD=%f (CUTWIN_MJD: %.1f to %.1f) \n",
-	   MJD, INPUTS.GENRANGE_MJD[0], INPUTS.GENRANGE_MJD[1] );
-    fflush(stdout);
+  if(LTRACE) {printf(" xxx %s: 4 SALT2c=%f\n", fnam,GENLC.SALT2c ); }
+  if ( fabs(SIMLIB_HEADER.GENGAUSS_SALT2c.PEAK) < 90. ) {
+    tmpVal        = exec_GENGAUSS_ASYM(&SIMLIB_HEADER.GENGAUSS_SALT2c) ;
+    GENLC.SALT2c  = tmpVal ;
+    if ( tmpVal < INPUTS.GENGAUSS_SALT2c.RANGE[0] ) { return(REJECT); }
+    if ( tmpVal > INPUTS.GENGAUSS_SALT2c.RANGE[1] ) { return(REJECT); }
   }
-  if ( MJD < INPUTS.GENRANGE_MJD[0] )  { return(NOKEEP); }
-  if ( MJD > INPUTS.GENRANGE_MJD[1] )  { return(NOKEEP); }
-  
 
-  // bail if this filter is not requested by user
-  ifilt_obs = SIMLIB_OBS_RAW.IFILT_OBS[OBS] ;
-  ifilt     = GENLC.IFILTINVMAP_OBS[ifilt_obs]; 
-  // xxx mark delete   ifilt     = GENLC.IFILTINVMAP_SIMLIB[ifilt_obs] ; 
-  if (LTRACE) {
-    printf(" xxx 4 ifilt=%d of %d\n",ifilt, GENLC.NFILTDEF_OBS ); 
-    fflush(stdout); 
+
+  // re-compute x0 and mB for SALT2 model
+  if ( INDEX_GENMODEL == MODEL_SALT2 ) {
+    GENLC.SALT2x0 = SALT2x0calc(GENLC.SALT2alpha, GENLC.SALT2beta, 
+				GENLC.SALT2x1, GENLC.SALT2c, GENLC.DLMU ) ;
+    GENLC.SALT2mB = SALT2mBcalc(GENLC.SALT2x0) ;
   }
-  if ( ifilt < 0                   ) { return(NOKEEP); }
-  if ( ifilt >= GENLC.NFILTDEF_OBS ) { return(NOKEEP); }
 
-  // if we get here, KEEP epoch
-  return(KEEP);
+  
+  if ( LTRACE ) {
+    t0_new = GENLC.PEAKMJD ;
+    z_new  = GENLC.REDSHIFT_CMB ; 
+    x1_new = GENLC.SALT2x1 ;  
+    c_new  = GENLC.SALT2c ;
 
-} // end keep_SIMLIB_OBS
+    printf(" xxx t0 = %.2f --> %.2f (%.1f to %.1f)\n", t0_old, t0_new, 
+	   SIMLIB_HEADER.GENGAUSS_PEAKMJD.RANGE[0], 
+	   SIMLIB_HEADER.GENGAUSS_PEAKMJD.RANGE[1] );
+    printf(" xxx z  = %7.4f --> %7.4f \n", z_old,  z_new );
+    printf(" xxx x1 = %7.4f --> %7.4f \n", x1_old, x1_new );
+    printf(" xxx c  = %7.4f --> %7.4f \n", c_old,  c_new );
+    fflush(stdout);
+  }
 
-// ==============================================
-void set_SIMLIB_MJDrange(int sameFlag, double *MJDrange) {
+  return(ACCEPT_FLAG);
 
-  // 
-  // Return MJDrange
-  //
-  // Input: sameFlag=T if LIBID has not changed.
-  //    (sameFlag not used; obsolete)
-  //
-  // Output:  MJDrange[0:1] = range of MJD to keep SIMLIB entries
-  //
-  // Jan  6 2018: zHEL -> zCMB
-  // Mar 18 2018:
-  //  + NLINE starts at 0 (not 1) to fix bug that was removing
-  //    first epoch in season for ENTIRE_SEASON option.
-  //
-  // Mar 27 2018: check ENTIRE_SEASON & ENTIRE_SURVEY options
-  // Aug 06 2018: refactor by moving SEASON computation elsewhere
-  //
+} //  end regen_SIMLIB_GENRANGES
 
-  int    KEEP_ENTIRE_SEASON = 
-    (INPUTS.SIMLIB_MSKOPT & SIMLIB_MSKOPT_ENTIRE_SEASON );
-  int    KEEP_ENTIRE_SURVEY = 
-    (INPUTS.SIMLIB_MSKOPT & SIMLIB_MSKOPT_ENTIRE_SURVEY );
 
-  double PEAKMJD = GENLC.PEAKMJD ;
-  double z       = GENLC.REDSHIFT_CMB ;
-  double z1      = 1. + z ;
-  double Tpad = 0.1 ;
-  double Tmin = PEAKMJD + (z1* INPUTS.GENRANGE_TREST[0] ) - Tpad ;
-  double Tmax = PEAKMJD + (z1* INPUTS.GENRANGE_TREST[1] ) + Tpad ;
-  double TMPmin, TMPmax;
-  int    ISEASON; 
-  char fnam[] = "set_SIMLIB_MJDrange" ;
+// ========================
+void  ABORT_SIMLIB_FILTER(int isort) {
 
-  // -------------- BEGIN ------------
+  // Created Feb 2017
+  // Missing filter in SIMLIB, so here give proper abort message
+  // depending on regular filter or SPECTROGRAPH filter.
 
-  MJDrange[0] = -9.0 ;
-  MJDrange[1] = -9.0 ;
+  int NOBS_RAW = SIMLIB_HEADER.NOBS ;
+  int OBSRAW   = SIMLIB_LIST_forSORT.INDEX_SORT[isort]; 
+  int OPTLINE  = SIMLIB_OBS_RAW.OPTLINE[OBSRAW] ;
+  int IFILT_OBS= SIMLIB_OBS_RAW.IFILT_OBS[OBSRAW] ;
+  double MJD   = SIMLIB_OBS_RAW.MJD[OBSRAW] ;
+  char cfilt[2];
+  char fnam[]  = "ABORT_SIMLIB_FILTER" ;
 
-  if ( KEEP_ENTIRE_SEASON && KEEP_ENTIRE_SURVEY ) {
-    sprintf(c1err,"Cannot specify ENTIRE_SEASON (%d) and ENTIRE_SURVEY(%d)",
-	    SIMLIB_MSKOPT_ENTIRE_SEASON, SIMLIB_MSKOPT_ENTIRE_SURVEY) ;
-    sprintf(c2err,"Pick one or neither in SIMLIB_MSKOPT key.");
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ) ; 
-  }
+  // ----------- BEGIN ------------
 
-  if ( INPUTS.SIMLIB_DUMP >= 0 ) {
-    MJDrange[0] = INPUTS.GENRANGE_PEAKMJD[0] ;
-    MJDrange[1] = INPUTS.GENRANGE_PEAKMJD[1] ;
-    return ;
-  }
 
+  sprintf(cfilt,  "%c", FILTERSTRING[IFILT_OBS] ) ;
 
-  if ( KEEP_ENTIRE_SEASON ) {
-    // option: keep all MJDs in season if Trest range overlaps
-    // any part of season. e.g. useful for blind analysis challenge.
-    for(ISEASON=0; ISEASON < SIMLIB_HEADER.NSEASON; ISEASON++ ) {
-      TMPmin = SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][0] ;
-      TMPmax = SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][1] ;
-      if ( Tmax > TMPmin ) 
-	{ MJDrange[1] = TMPmax; }
+  printf("\n PRE-ABORT DUMP: \n" );
+  printf("   isort=%d  OBSRAW= %d of %d \n", isort, OBSRAW, NOBS_RAW );
+  printf("   LIBID=%d  MJD=%9.3f  OPTLINE=%d\n", 
+	 GENLC.SIMLIB_ID, MJD, OPTLINE ) ;
 
-      if ( Tmin < TMPmax && MJDrange[0] < 0.0 ) 
-	{ MJDrange[0] = TMPmin; MJDrange[1] = TMPmax; }
-    } // end ISEASON loop
-    
-  }
-  else if ( KEEP_ENTIRE_SURVEY ) {
-    // keep every MJD in the entire survey (Mar 27 2018)
-    MJDrange[0] = SIMLIB_HEADER.MJDRANGE_SURVEY[0] ;
-    MJDrange[1] = SIMLIB_HEADER.MJDRANGE_SURVEY[1] ;
+
+  if ( OPTLINE == OPTLINE_SIMLIB_SPECTROGRAPH ) {
+    printf("   SPECTROGRAPH FILTERS: %s \n",
+	   INPUTS_SPECTRO.SYN_FILTERLIST_BAND );
+    sprintf(c1err, "missing Spectrograph filter='%s' ",  cfilt );
+    sprintf(c2err, "after 'FILTERS:'  key in SIMLIB header.");
   }
   else {
-    // default: keep MJDs only within user-defined TREST range
-    MJDrange[0] = Tmin;
-    MJDrange[1] = Tmax;
+    sprintf(c1err, "Unknown SIMLIB filter='%s' ",  cfilt );
+    sprintf(c2err, "Expecting filter from : '%s'", 
+	    SIMLIB_GLOBAL_HEADER.FILTERS );
   }
+  
+  errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
 
-  // if user Tmin/Tmax range is completely outside SIMLIB MJD-range,
-  // return with MJDrange=-9,-9.
-  if ( Tmax < SIMLIB_HEADER.MJDRANGE_SURVEY[0]+Tpad ||
-       Tmin > SIMLIB_HEADER.MJDRANGE_SURVEY[1]-Tpad ) 
-    { 
-      MJDrange[0] = MJDrange[1] = -9.0 ;
-      return ; 
-    }
 
+} // end ABORT_SIMLIB_FILTER
+
+// ================================================
+int USE_SAME_SIMLIB_ID(int IFLAG) {
+
+  // Dec 16 2015: 
+  // Return 1 to re-use the same SIMLIB_ID as last event.
+  // Return 0 otherwise to read another LIBID.
+  //
+  // IFLAG used for debug:
+  // IFLAG=1 if called from init_GENLC
+  // IFLAG=2 if called from SIMLIB_READ_DRIVER
+  //
+  // Apr 17 2017: fmodf -> fmod and XNTOT, XNUPD -> double
+  //             (to handle very large NGENTOT_LC)
+  //
+
+  int IDLOCK = GENLC.SIMLIB_IDLOCK ;
+  int OVP, OLD_SAMEFLAG=0, NEW_SAMEFLAG=0 ;
+  int LDMP = 0 ; // (GENLC.SIMLIB_ID >= 0 && IFLAG>0 );
+  char fnam[] = "USE_SAME_SIMLIB_ID" ;
+
+  // -------------- BEGIN --------------
+
+  if ( IFLAG==1 ) { SIMLIB_HEADER.NREPEAT++ ; }
+
+  // cannot repeast on 1st reading
+  if ( SIMLIB_HEADER.NREPEAT<=1 ) { return(0); }
   
-  // sanity tests
-  int ERRFLAG = ( MJDrange[0] < 0.0 || 
-		  MJDrange[1] < 0.0 || 
-		  MJDrange[0] > MJDrange[1] 
-		  );
+  // check option to keep using same LIBID
+  if ( IDLOCK > 1 && GENLC.SIMLIB_ID > 0 ) { return 1; }
 
-  // ------------ check dump option ---------------
-  int LDMP = 0 ;
-  if ( LDMP || ERRFLAG ) {
-    printf("\n xxx --------- SEASON DUMP for LIBID=%d --------------- \n",
-	   GENLC.SIMLIB_ID );
-    
-    for(ISEASON=0; ISEASON < SIMLIB_HEADER.NSEASON; ISEASON++ ) {
-      if ( ISEASON < MXSEASON_SIMLIB ) {
-	printf(" xxx ISEASON=%2d : MJDrange = %.3f to %.3f \n",
-	       ISEASON, 
-	       SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][0],
-	       SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][1]  );
-      }
-    }
-    printf(" xxx user Tmin, Tmax = %.1f to %.1f \n", Tmin, Tmax);
 
-    printf(" xxx MJDRANGE_SURVEY = %.3f to %.3f \n",
-	   SIMLIB_HEADER.MJDRANGE_SURVEY[0],
-	   SIMLIB_HEADER.MJDRANGE_SURVEY[1] );
-       
-    printf(" xxx KEEP_ENTIRE_[SEASON,SURVEY] = %d, %d \n",
-	   KEEP_ENTIRE_SEASON, KEEP_ENTIRE_SURVEY);
+  if ( SIMLIB_HEADER.NREPEAT <= INPUTS.SIMLIB_NREPEAT ) { 
+    NEW_SAMEFLAG=1; 
+  }
+  else if ( IFLAG == 2 ) { 
+    SIMLIB_HEADER.NREPEAT=1 ;    // reset
+  }
 
-    printf(" xxx PEAKMJD=%.3f  z=%.3f \n", PEAKMJD, z);
-    printf(" xxx MJDrange(keep) = %.3f to %.3f  (%d days)\n", 
-	   MJDrange[0], MJDrange[1], (int)(MJDrange[1]-MJDrange[0]) );
+  if ( LDMP ) {
+    printf(" xxx ------------------------------------ \n");
+    printf(" xxx IFLAG=%d CID=%6d  LIBID=%3d  NREPEAT=%d  NGENLC_TOT=%d \n",
+	   IFLAG, GENLC.CID, GENLC.SIMLIB_ID,
+	   SIMLIB_HEADER.NREPEAT, NGENLC_TOT );
+    printf(" xxx --> SAMEFLAG[OLD,NEW] = %d, %d \n",
+	   OLD_SAMEFLAG, NEW_SAMEFLAG );    
     fflush(stdout);
-  } // end LDMP
-
-  if ( ERRFLAG ) {
-    sprintf(c1err,"Invalid MJDrange = %.3f to %.3f",
-	    MJDrange[0], MJDrange[1] );
-    sprintf(c2err,"Check SIMLIB and SEASON logic");
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ) ; 
   }
 
-  return ;
+  if ( NEW_SAMEFLAG ) { return 1; }
+
+  // - - - - - - - - - - - - - - - - 
+  // check option to re-use same LIBID until an event is accepted
+  // (for ABC sims)
+  OVP = (INPUTS.SIMLIB_MSKOPT & SIMLIB_MSKOPT_REPEAT_UNTIL_ACCEPT );
+  if ( OVP > 0  &&  GENLC.ACCEPTFLAG_LAST == 0 ) 
+    { return(1); }
+  // - - - - - - - - - - - - - - - - 
+
+  // if we get here, read next LIBID
+  return 0 ;
 
-} // end set_SIMLIB_MJDrange
+} // end USE_SAME_SIMLIB_ID
 
 
 // ==============================================
-void store_SIMLIB_SEASONS(void) {
+void set_SIMLIB_NREPEAT(void) {
 
-  // Compute and store SIMLIB_HEADER.[seasonInfo]
+  // Nov 2017
+  // set SIMLIB_NREPEAT for LCLIB model, using b-dependent rate.
+  // Do nothing for other models.
   //
- 
-  double MJD, MJD_LAST;
-  int    isort, NLINE_MJD, NLINE, ISEASON, ISGAP, FIRST ;  
-  char fnam[] = "store_SIMLIB_SEASONS" ;
-
-  // -------------- BEGIN ------------
-
-  SIMLIB_HEADER.NSEASON = 1;
-  MJD_LAST = -9.0 ;
-  NLINE_MJD = SIMLIB_LIST_forSORT.NMJD;
-
-  for ( isort = 0; isort < NLINE_MJD; isort++ ) {
+  // Jun 28 2018: for SIMLIB_DUMP, set NREPEAT=1
 
-    NLINE = SIMLIB_LIST_forSORT.INDEX_SORT[isort] ;
+  int    NREPEAT_LO, NREPEAT ;
+  double relRate, XNREPEAT, XDIF, RA, DEC ;
+  char fnam[] = "set_SIMLIB_NREPEAT" ;
 
-    // strip off  MJD
-    MJD   = SIMLIB_OBS_RAW.MJD[NLINE] ;
+  // ----------------- BEGIN -----------------
 
-    // check first MJD in SIMLIB
-    FIRST = ( MJD_LAST < 0.0 ) ;
+  if ( INDEX_GENMODEL != MODEL_LCLIB   ) { return ; }
 
-    if ( FIRST )  { 
-      ISEASON=0; 
-      SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][0]  = MJD; 
-      SIMLIB_HEADER.MJDRANGE_SURVEY[0]           = MJD; 
-    }
-    SIMLIB_HEADER.MJDRANGE_SURVEY[1]             = MJD; 
+  RA  = SIMLIB_HEADER.RA ;
+  DEC = SIMLIB_HEADER.DEC ;
+  slaEqgal (RA, DEC,                    // input
+	    &GENLC.GLON, &GENLC.GLAT ); // output
 
-    // check for large time-gap which defines new season
-    ISGAP = ( MJD - MJD_LAST > TGAP_SEASON_SIMLIB ) ;
-    
-    if ( FIRST==0 && ISGAP ) { 
-      SIMLIB_HEADER.NSEASON++ ; 
-      ISEASON = SIMLIB_HEADER.NSEASON-1 ;
-      if ( ISEASON < MXSEASON_SIMLIB ) 
-	{ SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][0] = MJD; } // MJDmin
-    }
-    ISEASON = SIMLIB_HEADER.NSEASON-1 ;
-    if ( ISEASON < MXSEASON_SIMLIB ) 
-      { SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][1] = MJD; } // MJDmax
-    SIMLIB_OBS_RAW.ISEASON[NLINE] = ISEASON ;
-    MJD_LAST = MJD ;
-    
-  } // end isort loop
+  if ( INPUTS.SIMLIB_DUMP >= 0 ) 
+    { SIMLIB_HEADER.NREPEAT = 1; return ; }
 
+  if ( SIMLIB_HEADER.NREPEAT != 1 )  
+    { return ; }
 
-  // compute season lengths
-  for(ISEASON=0; ISEASON < SIMLIB_HEADER.NSEASON; ISEASON++ ) {
-    SIMLIB_HEADER.TLEN_SEASON[ISEASON] =
-      SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][1] -
-      SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][0] ;
-  }
 
-  if ( SIMLIB_HEADER.NSEASON >= MXSEASON_SIMLIB ) {
-    sprintf(c1err,"Invalid NSEASON=%d  exceeds bound of %d",
-	    SIMLIB_HEADER.NSEASON, MXSEASON_SIMLIB ) ;
-    sprintf(c2err,"LIBID=%d ", GENLC.SIMLIB_ID );
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ) ; 
-  }
+  relRate  = GALrate_model(GENLC.GLON, GENLC.GLAT, &INPUTS.RATEPAR);
+  relRate /= INPUTS.RATEPAR.RATEMAX ;
+  XNREPEAT = (double)INPUTS.SIMLIB_MXREPEAT * relRate;
+  
+  // use random number to pick the low or high integer of XNREPEAT.
+  NREPEAT_LO = (int)XNREPEAT ;
+  XDIF       = XNREPEAT - (double)NREPEAT_LO ;
 
-  // Aug 2018: check for minimum  Season length requirement 
-  remove_short_SIMLIB_SEASON();
+  if ( XDIF < FlatRan1(1) ) 
+    { NREPEAT = NREPEAT_LO ; }
+  else
+    { NREPEAT = NREPEAT_LO+1 ; }
 
 
-  // ------------ check dump option ---------------
   int LDMP = 0 ;
+
   if ( LDMP ) {
-    printf("\n xxx --------- SEASON DUMP for LIBID=%d --------------- \n",
-	   GENLC.SIMLIB_ID );
-    
-    for(ISEASON=0; ISEASON < SIMLIB_HEADER.NSEASON; ISEASON++ ) {
-      if ( ISEASON < MXSEASON_SIMLIB ) {
-	printf(" xxx ISEASON=%2d : MJDrange = %.3f to %.3f \n",
-	       ISEASON, 
-	       SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][0],
-	       SIMLIB_HEADER.MJDRANGE_SEASON[ISEASON][1]  );
-      }
-    }
-  } // end LDMP
+    printf(" xxx ------------------------------------------ \n");
+    printf(" xxx CID=%d    RA=%f   DEC=%f   RATEMAX=%le\n",	
+	   GENLC.CID, RA, DEC, INPUTS.RATEPAR.RATEMAX ) ;
+    printf(" xxx b=%f  relRate=%.3f   XNREPEAT=%.3f  (XDIF=%.3f) NREPEAT=%d\n",
+	   GENLC.GLAT, relRate, XNREPEAT, XDIF, NREPEAT );
+  }
 
+  INPUTS.SIMLIB_NREPEAT = NREPEAT ;
 
   return ;
 
-} // end store_SIMLIB_SEASONS
+} // end set_SIMLIB_NREPEAT
 
-// =========================================
-void remove_short_SIMLIB_SEASON(void) {
+// ================================================
+int SKIP_SIMLIB_FIELD(char *field) {
 
-  // Aug 2018
-  // If 1st or last season length is < INPUTS.SIMLIB_MINSEASON,
-  // remove short SEASON as if it didn't exist.
-  //
-  // Oct 15 2018
-  //  + Fix bug with   SIMLIB_HEADER.NSEASON = NSEASON ;
+  // Created Mar 2015.
+  // Returns 1 if this field should be skipped.
+  // Returns 0 if this field should be kept.
   //
 
-  int    NSEASON   = SIMLIB_HEADER.NSEASON ;
-  double MINSEASON = INPUTS.SIMLIB_MINSEASON ;
-  char fnam[] = "remove_short_SIMLIB_SEASON" ;
-  int  LDMP=0;
-  int  iseason, FLAG_REMOVE[MXSEASON_SIMLIB] ;
+  if ( strcmp(INPUTS.SIMLIB_FIELDLIST,"ALL") == 0 ) 
+    { return 0 ; }
 
-  double TLEN ;
+  if ( strstr(INPUTS.SIMLIB_FIELDLIST,field) == NULL ) 
+    { return 1; }
+  else 
+    { return 0; }
 
-  int NSEASON_ORIG = NSEASON ;
-  double MJDRANGE_SEASON_ORIG[MXSEASON_SIMLIB][2];
-  double TLEN_SEASON_ORIG[MXSEASON_SIMLIB];
+} // end of SKIP_SIMLIB_FIELD
 
-  // ---------------- BEGIN -------------
+// ================================================
+int  parse_SIMLIB_ZPT(char *cZPT, double *ZPT, 
+		      char *cfiltList, int *ifiltList) {
 
-  if ( MINSEASON < 0.001 ) { return ; }
+  // Created Dec 2011
+  // Parse string *cZPT to return either float ZPT
+  // or list of filters to sum and *ZPT = -9.0;
+  // Examples:
+  //  cZPT = 28.654   => *ZPT = 28.654 and cfiltList = unchanged 
+  //  cZPT = +28.654  => *ZPT = 28.654 and cfiltList = unchanged 
+  //  cZPT = 2+3+4+5  => *ZPT = -9     and cfiltList = 2345  
+  //
+  // Returned function value is strlen(cfiltList)
+  //
+  // Mar 1 2014: float *ZPT -> double
 
-  for(iseason=0; iseason < NSEASON; iseason++ )  { 
-    FLAG_REMOVE[iseason] = 0;
-    TLEN = SIMLIB_HEADER.TLEN_SEASON[iseason] ;
-    if ( TLEN < MINSEASON )  { FLAG_REMOVE[iseason] = 1; }
-  }
+  int NFILT, jplus, LEN, I, i, ifilt, ifilt_obs;
+  char *ptrPlus, cfilt[4], ctmp[4] ;
 
+  char fnam[] = "parse_SIMLIB_ZPT";
 
-  // store original seasons in separate array
-  for(iseason=0; iseason < NSEASON_ORIG; iseason++ ) {
-     MJDRANGE_SEASON_ORIG[iseason][0] = 
-       SIMLIB_HEADER.MJDRANGE_SEASON[iseason][0] ;
-     MJDRANGE_SEASON_ORIG[iseason][1] = 
-       SIMLIB_HEADER.MJDRANGE_SEASON[iseason][1] ;
+  // -------------- BEGIN -------------
 
-     TLEN_SEASON_ORIG[iseason] =
-       SIMLIB_HEADER.TLEN_SEASON[iseason] ;
+  // init output args
+  NFILT = 0;
+  *ZPT = -999.0;
+
+  // check if there is a '+' sign in the cZPT string.
+  ptrPlus  = strstr(cZPT,"+");
+  jplus    = ptrPlus - cZPT ;  // = 1 few if '+' in there
+      
+  if ( jplus < 1 || jplus > 100 ) {
+    *ZPT = atof(cZPT);
+    sprintf(ctmp,"%s ", cfiltList );
+    ifiltList[0] = filtindx_( ctmp, strlen(ctmp) ); 
   }
+  else  { 
 
-  // over-write SIMLIB_HEADER.[seasonInfo]
-  NSEASON=0 ;
-  for(iseason=0; iseason < NSEASON_ORIG; iseason++ ) {
-    if ( FLAG_REMOVE[iseason] ) { continue ; }
+    *ZPT = 19.999 ; // 19.999
+    cfiltList[0] = 0 ;  // reset input value
+    // strip off the filter chars between the plus signs
+    LEN = strlen(cZPT);
+    i   = -1 ;
 
-    SIMLIB_HEADER.MJDRANGE_SEASON[NSEASON][0] = 
-      MJDRANGE_SEASON_ORIG[iseason][0];
-    SIMLIB_HEADER.MJDRANGE_SEASON[NSEASON][1] = 
-      MJDRANGE_SEASON_ORIG[iseason][1];
+    for ( I = 0 ; I < LEN; I++ ) {
 
-    SIMLIB_HEADER.TLEN_SEASON[NSEASON] = TLEN_SEASON_ORIG[iseason] ;
-    NSEASON++ ;
-  }
+      sprintf(cfilt, "%c", cZPT[I] );
+      if ( strcmp(cfilt,"+") == 0 ) { continue; }
 
-  if ( NSEASON > 0 ) {
-    SIMLIB_HEADER.MJDRANGE_SURVEY[0] = 
-      SIMLIB_HEADER.MJDRANGE_SEASON[0][0] - 0.1;
-    SIMLIB_HEADER.MJDRANGE_SURVEY[1] = 
-      SIMLIB_HEADER.MJDRANGE_SEASON[NSEASON-1][1] + 0.1;
-  }
-  else {
-    SIMLIB_HEADER.MJDRANGE_SURVEY[0] = -9.0 ;
-    SIMLIB_HEADER.MJDRANGE_SURVEY[1] = -9.0 ;
-  }
+      strcat(cfiltList, cfilt); // append filter list
+      i++ ;
 
-  // -------------------------------------
-  if ( LDMP ) {
-    char cstatus[12];
-    printf("\n xxx ================================== \n");
-    printf(" xxx DUMP  %s  for  LIBID=%d  CID=%d\n", 
-	   fnam, SIMLIB_HEADER.LIBID, GENLC.CID );
-    for(iseason=0; iseason < NSEASON_ORIG; iseason++ ) {
-      if( FLAG_REMOVE[iseason] )
-	{ sprintf(cstatus,"Removed"); }
-      else
-	{ sprintf(cstatus,"Kept"); }
-      printf(" xxx Original SEASON %d: %.1f to %.1f (%.1f days)  %s \n"
-	     ,iseason
-	     ,MJDRANGE_SEASON_ORIG[iseason][0]
-	     ,MJDRANGE_SEASON_ORIG[iseason][1]
-	     ,TLEN_SEASON_ORIG[iseason]
-	     ,cstatus );
-    } // end iseason
+      // check that this is a valid filter.
+      // Note that we need a stupid blank space for filtindx_ function
+      sprintf(ctmp,"%s ", cfilt);
+      ifilt_obs    = filtindx_( ctmp, strlen(ctmp) ); 
+      ifiltList[i] = ifilt_obs ;
+      ifilt        = GENLC.IFILTINVMAP_OBS[ifilt_obs];
+      if ( ifilt < 0 || ifilt >= GENLC.NFILTDEF_OBS ) {
+	sprintf(c1err,"Invalid filter='%s'(%d) in cZPT='%s' ", 
+		cfilt, ifilt_obs, cZPT );
+	sprintf(c2err,"Check simlib file %s", INPUTS.SIMLIB_FILE );
+	errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
+      }
 
-    printf(" xxx NSEASON(final)=%d  (%.3f to %.3f) \n",
-	   NSEASON, 
-	   SIMLIB_HEADER.MJDRANGE_SURVEY[0],
-	   SIMLIB_HEADER.MJDRANGE_SURVEY[1] );
-    
-    fflush(stdout);
+      
+    } // end loop over LEN
   }
+      
+  // get number of filters in list for return function arg.
+  NFILT = strlen(cfiltList);
 
-  SIMLIB_HEADER.NSEASON = NSEASON ; 
+  /*
+  printf(" ZZZZZ cZPT(%s) = '%s'  ZPT=%f   NFILT=%d  jplus=%d\n", 
+	 cfiltList, cZPT, *ZPT, NFILT, jplus );
+  */
 
-  return ;
+  return NFILT ;
 
-} // end  remove_short_SIMLIB_SEASON
+} // end of parse_SIMLIB_ZPT
 
 
-// ==============================================
-void SIMLIB_prepMJD_forSORT(int ISTORE) {
+// ====================================
+void get_SIMLIB_SCALES( int ifilt_obs
+		       ,double *SHIFT_ZPT
+		       ,double *SCALE_SKYSIG
+		       ,double *SCALE_READNOISE
+		       ) {
 
-  // Created Aug 21 2017
-  // Increment SIMLIB_LIST_forSORT to use later for
-  // sorting MJD. This routing does NOT do the actual
-  // MJD sorting, but prepares for duplicate MJDs to
-  // preserve SIMLIB-order and avoid random re-order.
-  // For each duplicate MJD, add 0.000001 so that 
-  // sorting will preserve order.
+  // Apr 26, 2011
+  // return SIMLIB scales based on MSKOPT
+  //
+  // Feb 2012: init to INPUTS.FUDGESCALE_XXX
+  // May 2013: READNOISE is scaled separately from SKYNOISE
+  //
+  // init to fudged values
+  //
+  // Jun 19 2017: use filter-dependent ZPT shift.
+  //
+  // --------- BEGIN ----------
+  
+  *SCALE_SKYSIG    = (double)INPUTS.FUDGESCALE_SKYNOISE ;
+  *SCALE_READNOISE = (double)INPUTS.FUDGESCALE_READNOISE ;
+  *SHIFT_ZPT       = (double)INPUTS.FUDGESHIFT_ZPT_FILTER[ifilt_obs] ;
 
-  double MJD, MJD_DIF, MJD_LAST;
-  char fnam[] = "SIMLIB_prepMJD_forSORT" ;
 
-  // --------------BEGIN --------------
+  if ( INPUTS.EXPOSURE_TIME_MSKOPT  & (1 << 0) )
+    { *SHIFT_ZPT  += GENLC.SHIFT_ZPTSIMLIB[ifilt_obs]; }
 
-  MJD      = SIMLIB_OBS_RAW.MJD[ISTORE] ;
-  MJD_LAST = SIMLIB_LIST_forSORT.MJD_LAST ;
-  MJD_DIF  = MJD - MJD_LAST ;
-  SIMLIB_LIST_forSORT.MJD[ISTORE] = MJD; 
-  if ( fabs(MJD_DIF) < 0.0001 ) {
-    SIMLIB_LIST_forSORT.MJD[ISTORE] = 
-      SIMLIB_LIST_forSORT.MJD[ISTORE-1] + 0.00001 ;  // about 1 second
-  }
-  SIMLIB_LIST_forSORT.MJD_LAST    = MJD ;
 
-  return ;
+  if ( INPUTS.EXPOSURE_TIME_MSKOPT  & (1 << 1) )
+    { *SCALE_SKYSIG  *= GENLC.SCALE_NOISE[ifilt_obs] ; }
 
-} // end  SIMLIB_prepMJD_forSORT
 
+  if ( INPUTS.EXPOSURE_TIME_MSKOPT  & (1 << 2) )
+    { *SCALE_READNOISE  *= GENLC.SCALE_NOISE[ifilt_obs] ; }
 
-// ============================
-void SIMLIB_sortbyMJD(void) {
 
-  // Created Jan 17 2018
-  // Sort SIMLIB MJDs. Tricky part is that entries with
-  // APPEND_PHOTFLAG>0 are NOT to be sorted, but left at
-  // the end of the list. The unsorted MJDs allow re-generating
-  // the exact same light curves for sorted MJDs, and then 
-  // appending new Light curve data. This can happen when
-  // observations are used to define new sets of observations.
-  // Initial use: WFIRST-imaging triggers IFC(spectra),
-  // which overlaps more imaging that appends observations.
+} // end of get_SIMLIB_SCALES
 
-  int NOBS_RAW    = SIMLIB_HEADER.NOBS ;
-  int NOBS_APPEND = SIMLIB_HEADER.NOBS_APPEND ;
-  int NOBS_SORT   = NOBS_RAW - NOBS_APPEND ;
-  int  ORDER_SORT = +1 ; // increasing order
-  int  isort;
-  char fnam[] = "SIMLIB_sortbyMJD" ;
+// ***********************************
+void ENDSIMLIB_check(void) {
 
-  // ------------- BEGIN --------------
+  // Created Apr 29, 2009 by R.Kessler
+  // called after reading entire simlib to check
+  // if anything passes MJD, RA and DECL cuts.
+  // If not, abort with message instead of wrapping
+  // around in an infinite loop.
 
-  if ( NOBS_SORT < 1 ) {
-    sprintf(c1err,"Invalid NOBS_SORT=%d for LIBID=%d CID=%d", 
-	    NOBS_SORT, SIMLIB_HEADER.LIBID, GENLC.CID );
-    sprintf(c2err,"NOBS_RAW=%d  NOBS_APPEND=%d", 
-	    NOBS_RAW, NOBS_APPEND);
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
+  char fnam[] = "ENDSIMLIB_check";
+
+  // ------- BEGIN ---------
+
+  if ( INPUTS.SIMLIB_DUMP >= 0 ) return ;
+
+  if ( SIMLIB_HEADER.NFOUND_RA == 0 ) {
+    sprintf(c1err,"Could not find SIMLIB RA within");
+    sprintf(c2err,"GENRANGE_RA : %f - %f  deg" ,
+	    INPUTS.GENRANGE_RA[0], INPUTS.GENRANGE_RA[1]  );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
   }
 
-  sortDouble( NOBS_SORT, SIMLIB_LIST_forSORT.MJD, ORDER_SORT, 
-	      SIMLIB_LIST_forSORT.INDEX_SORT ) ;  // return array
-  
-  // if there are unsorted MJDs, add them to the back fo the sort-list
-  if ( NOBS_SORT < NOBS_RAW ) {
-    for ( isort = NOBS_SORT-1; isort < NOBS_RAW; isort++ ) {
-      SIMLIB_LIST_forSORT.INDEX_SORT[isort] = isort ; 
+  if ( SIMLIB_HEADER.NFOUND_DEC == 0 ) {
+    sprintf(c1err,"Could not find SIMLIB DEC within");
+    sprintf(c2err,"GENRANGE_DEC : %f - %f  deg" ,
+	    INPUTS.GENRANGE_DEC[0], INPUTS.GENRANGE_DEC[1] );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+  }
+
+  if ( strcmp(INPUTS.SIMLIB_FIELDLIST,"ALL") != 0 ) {
+    if ( SIMLIB_HEADER.NFOUND_FIELD == 0 ) {
+      sprintf(c1err,"Could not find SIMLIB FIELD '%s' ", 
+	      INPUTS.SIMLIB_FIELDLIST );
+      sprintf(c2err,"Check sim-input file and SIMLIB file.");
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
     }
   }
 
-  SIMLIB_LIST_forSORT.NMJD = NOBS_RAW ;
-  return ;
 
-} // end of  SIMLIB_sortbyMJD(
+} // end of ENDSIMLIB_check
 
-// ====================================================
-void store_GENSPEC(double *VAL_STORE) {
 
-  // load GENSPEC array
-  // Input VAL_STORE :
-  //  MJD
-  //  TEXPOSE
-  //  INDX_TAKE_SPECTRUM  if MJD > 0
+// *********************************
+void init_zvariation(void) {
+
+  // Created May 11, 2009 by R.Kessler
   //
-  // Aug 23 2017: set VAL_STORE[0] = MJD in case MJD changes
-  // Mar 01 2019: remove LEGACY flag option
+  // Read/parse ZVARIATION_FILE and load ZVARIATION struct.
+  // To allow another z-dependent parameter,
+  //   * increment MXPAR_ZVAR in snlc_sim.h
+  //   * udpate PARDEF_ZVAR array in snlc_sim.h
+  //   * apply get_zvariation() call at appropriate place in snlc_sim.c
+  //
+  // Feb 22 2013: move hard-wired PARDEF_ZVAR list from snlc_sim.h to here.
+  //
+  // Mar 12 2014: if ZPOLY keys have already been read from sim-input file,
+  //              skip reading separate ZVAR file.
+  //
+  // Mar 16, 2014: major overhaul to define z-dependence on any
+  //               population param; see PREFIX_GENGAUSS.
+  //
+  // Mar 24, 2014: Fixed auxilliary ZPAR file 
+  //     INPUT_ZVARIATION[i].FLAG bug (JLM)
+  //
+  // Apr 23 2015: allow 'END:' key in ZVAR-file.
+  // Oct 27 2017: add SKEWNORMAL[0,1,2]
+  //
+  // Apr 20 2017:
+  //  +  always allow host AV & RV (not just for mlcs)
+  //  + add "EXPSIG","EXPTAU" to list of GEN[prefixes]
+  //
+  // Jun 2 2017: add 2nd-peak params to PREFIX_GENGAUSS
+  // Jul 19 2017: add GENMAG_OFF_GLOBAL to update list
+  // Jul 24 2017: update error reporting of NZBIN exceeding boung.
 
-  double MJD     = VAL_STORE[0];
-  double TEXPOSE = VAL_STORE[1];
-  int    INDX    = (int)VAL_STORE[2];  // for TAKE_SPECTRUM 
-  double z       = GENLC.REDSHIFT_CMB;
-  double z1      = 1.0 + z;
+  char *ptrZfile, *ptrparname, *ptrPar;
+  char GENPREFIX[60], c_get[60], method[20], parName[60], cpoly[60] ;
 
-  double TOBS, TREST ;
-  int OPT_TEXPOSE, imjd ;
-  char fnam[] = "store_GENSPEC" ;
+#define NPREFIX_GENGAUSS 15
+  char PREFIX_GENGAUSS[NPREFIX_GENGAUSS][20] 
+    = 
+    { "PEAK", "MEAN", "SKEW[0]", "SKEW[1]", "SIGMA[0]", "SIGMA[1]",
+      "SKEWNORMAL[0]", "SKEWNORMAL[1]", "SKEWNORMAL[2]",
+      "PROB2", "PEAK2", "SIGMA2[0]", "SIGMA2[1]" ,
+      "EXPSIG", "EXPTAU"
+    } ;
 
-  // -------------- BEGIN ---------------
+  double *ptrpoly, *ptrzval, *ptrzshift, ZTMP, ZMIN, ZMAX, ZGEN[2], shift ;
+  int i, i2, NZ, MATCH, NTMP, FLAG, ipar, IPAR_USR;
+  int IZVAR_DEJA, IZVAR_FILE ;
+  FILE *fpz;
+  char    fnam[] = "init_zvariation" ;
 
-  imjd        = INDX ;
+  // -------------- BEGIN ----------------
 
-  if ( NPEREVT_TAKE_SPECTRUM > 0 ) 
-    {  OPT_TEXPOSE = INPUTS.TAKE_SPECTRUM[INDX].OPT_TEXPOSE ; }
-  else
-    { OPT_TEXPOSE = 0 ; }
+  IZVAR_DEJA = ( NPAR_ZVAR_USR > 0 ) ; // already read from sim-input file
+  IZVAR_FILE = USE_ZVAR_FILE ;
+  ptrZfile   = INPUT_ZVARIATION_FILE ;
+  ptrparname = fnam; // avoid compile warning
+  FLAG       = -9 ;
 
+  if ( IZVAR_DEJA == 0 && IZVAR_FILE == 0 ) { return ; }
 
-  if ( OPT_TEXPOSE == 0 )  { 
-    TOBS = MJD - GENLC.PEAKMJD ;  TREST = TOBS/z1;
-    GENSPEC.INDEX_TAKE_SPECTRUM[imjd]   = -9 ; 
-    GENSPEC.INV_TAKE_SPECTRUM[INDX]     = -9 ;
-  }
-  else if ( OPT_TEXPOSE > 0 ) {
-    MJD = GENSPEC_PICKMJD(1,INDX,z, &TOBS, &TREST) ; // return random MJD
-    GENSPEC.INDEX_TAKE_SPECTRUM[imjd] = INDX ;
-    GENSPEC.INV_TAKE_SPECTRUM[INDX]   = imjd;
-    GENSPEC_LAMOBS_RANGE(INDX,GENSPEC.LAMOBS_SNR_LIST[imjd] ); 
+  // allow only one input option
+  if ( IZVAR_DEJA && IZVAR_FILE ) {
+    sprintf ( c1err,"Cannot specify ZVARIATION_FILE and ZPOLY keys");
+    sprintf ( c2err,"in sim-input file. Pick one or the other." );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ;
   }
 
-  // adjust input MJD in case MJD changes. (Aug 23, 2017)
-  VAL_STORE[0] = MJD; 
+  // -------------------------------------------
+  // hard-wire list of valid parameter names
 
-  GENSPEC.MJD_LIST[imjd]          = MJD ;
-  GENSPEC.TOBS_LIST[imjd]         = TOBS ;
-  GENSPEC.TREST_LIST[imjd]        = TREST; 
-  GENSPEC.TEXPOSE_LIST[imjd]      = TEXPOSE ;      
-  GENSPEC.OPT_TEXPOSE_LIST[imjd]  = OPT_TEXPOSE ;
+  NPAR_ZVAR_TOT = 0 ;
 
-  GENSPEC.NMJD_TOT++ ;
 
-  /*
-  printf(" xxx %s: NMJD_TOT=%d  MJD=%.3f  TOBS=%.1f  (INDX=%d,OPT=%d)\n",
-	 fnam, GENSPEC.NMJD_TOT, MJD, TOBS, INDX,OPT_TEXPOSE ); fflush(stdout);
-  */
+  // allow any GENPREFIX to modify population params.
 
-  return ;
+  for (i=0; i < NPREFIX_GENGAUSS; i++ ) {
 
-} // end store_GENSPEC
+    sprintf(GENPREFIX,"GEN%s", PREFIX_GENGAUSS[i] );
+
+    // always allow host AV & RV
+    sprintf(parName,"%s_RV", GENPREFIX );
+    update_PARDEF_ZVAR( parName );
+    
+    sprintf(parName,"%s_AV", GENPREFIX );
+    update_PARDEF_ZVAR( parName );
+    
+    if ( INPUTS.NPAR_SIMSED > 0 ) { 
+      for ( ipar=0; ipar < INPUTS.NPAR_SIMSED; ipar++ ) {
+	ptrPar = INPUTS.PARNAME_SIMSED[ipar] ;
+	sprintf(parName,"%s_%s", GENPREFIX, ptrPar);      
+	update_PARDEF_ZVAR( parName );
+      }
+    } 
+    else if ( INDEX_GENMODEL == MODEL_SALT2 ) { 
 
-// ====================================================
-void init_SIMLIB_HEADER(void) {
+      sprintf(parName,"%s_SALT2x1", GENPREFIX );
+      update_PARDEF_ZVAR( parName );
 
-  // Created Apr 2016 to initialize SIMLIB_HEADER struct.
-  // Called for each event.
+      sprintf(parName,"%s_SALT2c", GENPREFIX );
+      update_PARDEF_ZVAR( parName );
 
-  int i;
-  char fnam[] = "init_SIMLIB_HEADER" ;
-  // ------------ BEGIN ------------
+      sprintf(parName,"%s_SALT2ALPHA", GENPREFIX );
+      update_PARDEF_ZVAR( parName );
 
-  SIMLIB_HEADER.REGEN_FLAG  = 0 ;
-  SIMLIB_HEADER.NOBS        = NULLINT ;
-  SIMLIB_HEADER.NOBS_APPEND = 0 ;
-  SIMLIB_HEADER.RA          = 9999. ;
-  SIMLIB_HEADER.DEC         = 9999. ;
-  SIMLIB_HEADER.FAKEID      = NULLINT ;
-  SIMLIB_HEADER.GALID       = NULLINT ;
+      sprintf(parName,"%s_SALT2BETA", GENPREFIX );
+      update_PARDEF_ZVAR( parName );
+    }
+    else {
 
-  SIMLIB_HEADER.GENRANGE_REDSHIFT[0] = -9.0 ;
-  SIMLIB_HEADER.GENRANGE_REDSHIFT[1] = -9.0 ;
+      sprintf(parName,"%s_DELTA", GENPREFIX );
+      update_PARDEF_ZVAR( parName );
 
-  SIMLIB_HEADER.CUTWIN_REDSHIFT[0] = -9.0 ; // wide open
-  SIMLIB_HEADER.CUTWIN_REDSHIFT[1] = 99.0 ;
+      sprintf(parName,"%s_DM15", GENPREFIX );
+      update_PARDEF_ZVAR( parName );
 
-  init_GENGAUSS_ASYM( &SIMLIB_HEADER.GENGAUSS_PEAKMJD, (double)999. ) ;
-  init_GENGAUSS_ASYM( &SIMLIB_HEADER.GENGAUSS_SALT2x1, (double)999. ) ;
-  init_GENGAUSS_ASYM( &SIMLIB_HEADER.GENGAUSS_SALT2c,  (double)999. ) ;
+      sprintf(parName,"%s_STRETCH", GENPREFIX );
+      update_PARDEF_ZVAR( parName );
+    }
+    
+  } // end i loop over PREFIX_GENGAUSS
 
-  sprintf(SIMLIB_HEADER.FIELD,"NULL");
-  SIMLIB_HEADER.SUBSURVEY_NAME[0] = 0 ;
-  // doesn't work  sprintf(SIMLIB_HEADER.SUBSURVEY_NAME, "NULL" );
 
-  SIMLIB_HEADER.NSEASON = 1 ;
-  for(i=0; i < MXSEASON_SIMLIB; i++ ) { SIMLIB_HEADER.USE_SEASON[i] = 0;}
+  // add a few miscellaneous variables.
+  if ( INPUTS.NPAR_SIMSED == 0 ) { 
+    update_PARDEF_ZVAR( "GENEXPTAU_AV"       );  // Mar 2013
+    update_PARDEF_ZVAR( "GENGAUSIG_AV"       );
+    update_PARDEF_ZVAR( "GENGAUPEAK_AV"      );
+    update_PARDEF_ZVAR( "GENRATIO_AV0"       );
+    update_PARDEF_ZVAR( "VSI"                ); // Si velocity for VCR model
+    update_PARDEF_ZVAR( "GENMAG_OFF_GLOBAL"  ); // added July 2017
+  }
 
+  // ---------------------------------
+  // check for PARDEF-dump option
+  if ( strcmp(ptrZfile,"0") == 0 ) {
+    printf("\n\n");
+    print_banner("Valid parameters to simulate Z-dependence:");
+    for ( i=0; i < MXPAR_ZVAR; i++ )  { printf(" %s", PARDEF_ZVAR[i] ); }
+    printf("\n");    happyend();
+  }
 
-  sprintf(SIMLIB_HEADER.TELESCOPE,  "%s", SIMLIB_GLOBAL_HEADER.TELESCOPE) ;
-  SIMLIB_HEADER.PIXSIZE  = SIMLIB_GLOBAL_HEADER.PIXSIZE ;
 
+  // if ZPOLY keys have already been read from sim-input file,
+  // skip reading separate ZVAR file.
+  if ( IZVAR_DEJA ) { goto ZVAR_SUMMARY ; }
 
-  return ;
 
-} // end init_SIMLIB_HEADER
+  // -------------------------------------------
+  // open file
+  if ( (fpz = fopen(ptrZfile, "rt"))==NULL ) {   
+    sprintf ( c1err, "Cannot open ZVARIATION_FILE " );
+    sprintf ( c2err," '%s' ", ptrZfile );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  }
 
+  print_banner(" Read Z-DEPENDENCE for SIM PARAMETERS ");
 
-// ================================================
-void parse_SIMLIB_IDplusNEXPOSE(char *inString, int *IDEXPT, int *NEXPOSE) {
+  while( (fscanf(fpz, "%s", c_get)) != EOF) {
 
-  // Created Jan 3 2018
-  // If inString has no *   -->  IDEXPT = inString and NEXPOSE=1
-  // If inString = ID*NEXP  -->  IDEXPT = ID and NEXPOSE=NEXP
+    // allow END key to ignore anything after
+    if ( strcmp(c_get,"END:") == 0 ) { fclose(fpz) ;  goto ZVAR_SUMMARY ; }
+    
+    if ( strcmp(c_get,"PARAMETER:") == 0 ) {
+      IPAR_USR = NPAR_ZVAR_USR;
+      ptrparname = INPUT_ZVARIATION[IPAR_USR].PARNAME ;
+      readchar(fpz, ptrparname);
+      FLAG = INPUT_ZVARIATION[IPAR_USR].FLAG ;
+      NPAR_ZVAR_USR++ ;
+    }
 
-  int  IDTMP, NTMP, NRD;
-  char star[] = "*" ;
-  char WDLIST[2][20], *ptrWDLIST[2];
-  char fnam[] = "parse_SIMLIB_IDplusNEXPOSE" ;
+    if ( strcmp(c_get,"ZPOLY:") == 0 ) {
+      if ( FLAG > 0 ) {
+	sprintf(c1err, "Found ZPOLY but ZVARIATION[%d].FLAG=%d already set", 
+		IPAR_USR, FLAG);
+	sprintf(c2err,"for %s . Check file: %s", ptrparname, ptrZfile );
+	errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+      }
+      readchar(fpz,cpoly);
+      if ( strstr(cpoly,",") == NULL ) {
+	sprintf(c1err,"Must use comma-separate poly coefficients");
+	sprintf(c2err,"for ZPOLY option with param = '%s'", ptrparname);
+	errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+      }
+      parse_GENPOLY(cpoly,&INPUT_ZVARIATION[IPAR_USR].POLY, fnam);
+    }
 
-  // ----------- BEGIN ------------
+    if ( strcmp(c_get,"ZBIN:") == 0 ) {
+      INPUT_ZVARIATION[IPAR_USR].FLAG = FLAG_ZBINS_ZVAR ; //JLM
+      NZ = INPUT_ZVARIATION[IPAR_USR].NZBIN;
+      INPUT_ZVARIATION[IPAR_USR].NZBIN++ ;  
 
-  NTMP = 1;  // default
+      if ( NZ < MXZBIN_ZVAR ) {
+	ptrzval   = &INPUT_ZVARIATION[IPAR_USR].ZBIN_VALUE[NZ];
+	ptrzshift = &INPUT_ZVARIATION[IPAR_USR].ZBIN_PARSHIFT[NZ];
+	readdouble(fpz, 1, ptrzval );
+	readdouble(fpz, 1, ptrzshift );
+	
+	ZMIN   = INPUT_ZVARIATION[IPAR_USR].ZBIN_VALUE[0];
+	ZMAX   = INPUT_ZVARIATION[IPAR_USR].ZBIN_VALUE[NZ];
+      }
+    }
 
-  if ( strchr(inString,'*') == NULL ) {
-    // no star, just read IDEXPT
-    sscanf(inString , "%d", &IDTMP ); 
-  }
-  else {
-    // found star, read both ID and NEXPOSE
-    ptrWDLIST[0] = WDLIST[0] ;
-    ptrWDLIST[1] = WDLIST[1] ;
-    splitString(inString, star, 3,  &NRD, ptrWDLIST ); 
-    sscanf( WDLIST[0] , "%d", &IDTMP ); 
-    sscanf( WDLIST[1] , "%d", &NTMP ); 
-  }
+  } // end of read loop
 
-  // load output arguments
-  *IDEXPT  = IDTMP ;
-  *NEXPOSE = NTMP ;
+  // - - - - -
 
-  /*
-  printf(" xxx %s: inString='%s'  NRD=%d   ID=%d  NEXPOSE=%d \n",
-	 fnam, inString, NRD, IDTMP, NTMP);
-  debugexit(fnam);
-  */
+  NZ = INPUT_ZVARIATION[NPAR_ZVAR_USR-1].NZBIN;
+  if ( NZ >= MXZBIN_ZVAR ) {
+    sprintf(c1err,"NZBIN=%d for %s exceeds bound MXZBIN_ZVAR=%d", 
+	    NZ,ptrparname, MXZBIN_ZVAR );
+    sprintf ( c2err,"Check file: '%s' ", ptrZfile );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+  }
 
-  return ;
+  fclose(fpz) ;
 
-} // end parse_SIMLIB_IDplusNEXPOSE
+  // -------------------
 
-// ================================================
-void parse_SIMLIB_GENRANGES(FILE *fp_SIMLIB, char *KEY) {
+ ZVAR_SUMMARY:
 
-  // Created Aug 2017
-  // Read optional GENRANGE_XXX keys.
-  //
-  // Inputs:
-  //   fp_SIMLIB : file pointer to SIMLIB file
-  //   KEY       : current simlib string to check
-  //
-  // Jan 4 2018: read optional DISTANCE key, and convert to zCMB
+  // print summary, and make sure that GEN-Z range is covered
+  // by ZBIN option
 
-  double RA  = SIMLIB_HEADER.RA ;
-  double DEC = SIMLIB_HEADER.DEC ;
-  double TMPVAL, TMPRANGE[2], dist, MU, zHel;
-  int    LTMP ;
+  for ( i=0; i < NPAR_ZVAR_USR; i++ ) {
+    ptrparname = INPUT_ZVARIATION[i].PARNAME;
+    FLAG       = INPUT_ZVARIATION[i].FLAG ;
+    NZ         = INPUT_ZVARIATION[i].NZBIN;
+    ZMIN       = INPUT_ZVARIATION[i].ZBIN_VALUE[0];
+    ZMAX       = INPUT_ZVARIATION[i].ZBIN_VALUE[NZ-1];
 
-  char fnam[] = "parse_SIMLIB_GENRANGES" ;
+    // set method comment based on flag
 
-  // ------------ BEGIN ----------------
+    if ( FLAG == FLAG_ZPOLY_ZVAR ) 
+      { sprintf(method,"ZPOLY"); }
+    else if ( FLAG == FLAG_ZBINS_ZVAR ) {
+      { sprintf(method,"ZBINS"); }
+    }
+    else {
+      sprintf(c1err,"Invalid FLAG=%d for %s", FLAG, ptrparname );
+      errmsg(SEV_FATAL, 0, fnam, c1err, "" ); 
+    }
 
+    printf("\t Init Z-variation (zvar) for '%s' (method = %s)\n", 
+	   ptrparname, method );
 
-  // Nov 2015: check optional CUTWIN_REDSHIFT so that each LIBID
-  //           can have its own z-range (originally for WFIRST study)
-  //    Note that this is a cut, not a range to generate.
-  if (  strcmp(KEY,"CUTWIN_REDSHIFT:") == 0  ||
-	strcmp(KEY,"REDSHIFT_RANGE:" ) == 0  ) 
-    { readdouble( fp_SIMLIB, 2, SIMLIB_HEADER.CUTWIN_REDSHIFT );   }
-  
-  // -------------------------------------------------
-  // ------------ READ GENRANGEs ---------------------
-  // -------------------------------------------------
+    // ========== IDIOT CHECKS ===============
 
-  // check for redshift value or range 
-  LTMP = 0 ;
-  if ( strcmp(KEY,"REDSHIFT:")==0 && INPUTS.USE_SIMLIB_REDSHIFT ) {
-    readdouble ( fp_SIMLIB, 1, &TMPVAL );
-    TMPRANGE[0] = TMPRANGE[1] = TMPVAL;  LTMP=1;
-  }
-  if ( strcmp(KEY,"DISTANCE:")==0 && INPUTS.USE_SIMLIB_DISTANCE ) {
-    readdouble ( fp_SIMLIB, 1, &dist );  // Lumi-distance (D_L), Mpc (Jan 2018)
-    MU = 5.0*log10(dist/1.0E-5);  // 10pc = 1.0E-5 Mpc
-    double H0 = INPUTS.H0 / ( 1.0E6 * PC_km) ;
-    double OM = INPUTS.OMEGA_MATTER;
-    double OL = INPUTS.OMEGA_LAMBDA;
-    double w0 = INPUTS.W0_LAMBDA ;
-    TMPVAL = zcmb_dLmag_invert(H0, OM, OL, w0, MU); // returns zCMB
-    TMPRANGE[0] = TMPRANGE[1] = TMPVAL;  LTMP=1;
-  }
-  if ( strcmp(KEY,"GENRANGE_REDSHIFT:")==0 ) {
-    readdouble ( fp_SIMLIB, 2, TMPRANGE );  LTMP=1;
-  }
-  if ( LTMP ) {
-    SIMLIB_HEADER.GENRANGE_REDSHIFT[0] = TMPRANGE[0] ;
-    SIMLIB_HEADER.GENRANGE_REDSHIFT[1] = TMPRANGE[1] ;
-    SIMLIB_HEADER.REGEN_FLAG = 1;
-  }
+    // make sure that this parameter is valid
+    MATCH = 0;
+    for ( i2=0; i2 < MXPAR_ZVAR; i2++ ) 
+      { if ( strcmp(ptrparname,PARDEF_ZVAR[i2]) == 0 ) MATCH=1; }
 
-  // check for optional PEAKMJD value or range in SIMLIB; 
-  LTMP=0;
-  if ( strcmp(KEY,"PEAKMJD:")==0  && INPUTS.USE_SIMLIB_PEAKMJD )  { 
-    readdouble ( fp_SIMLIB, 1, &TMPVAL ); 
-    TMPRANGE[0] = TMPRANGE[1] = TMPVAL;  LTMP=1;
-  }
-  if ( strcmp(KEY,"GENRANGE_PEAKMJD:") == 0   || 
-       strcmp(KEY,"GENRANGE_PKMJD:")   == 0  ) {
-    readdouble ( fp_SIMLIB, 2, TMPRANGE ) ;  LTMP=1 ;
-  }
-  if ( LTMP ) {
-    SIMLIB_HEADER.GENGAUSS_PEAKMJD.PEAK     = 0.5*(TMPRANGE[0]+TMPRANGE[1]);
-    SIMLIB_HEADER.GENGAUSS_PEAKMJD.RANGE[0] = TMPRANGE[0] ;
-    SIMLIB_HEADER.GENGAUSS_PEAKMJD.RANGE[1] = TMPRANGE[1] ;
-    SIMLIB_HEADER.REGEN_FLAG = 1;
-  }
+    if ( MATCH == 0 ) {
+      sprintf(c1err,"Unrecognized SIM-parameter '%s'", ptrparname );
+      sprintf(c2err,"Cannot apply Z-dependence.");
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    }
 
-  // check for PEAKMJD sigma
-  if ( strcmp(KEY,"GENSIGMA_PEAKMJD:")==0  ) {
-    readdouble ( fp_SIMLIB, 1, &TMPVAL ); 
-    SIMLIB_HEADER.GENGAUSS_PEAKMJD.SIGMA[0] = TMPVAL ;
-    SIMLIB_HEADER.GENGAUSS_PEAKMJD.SIGMA[1] = TMPVAL ;
-  }
+    // do NOT allow extrapolation past ZBIN range
 
+    if ( FLAG == FLAG_ZBINS_ZVAR ) {
+      ZGEN[0] = INPUTS.GENRANGE_REDSHIFT[0];
+      ZGEN[1] = INPUTS.GENRANGE_REDSHIFT[1];
+      if ( ZMIN > ZGEN[0] ||  ZMAX < ZGEN[1] ) {
+	sprintf(c1err," ZBIN range %5.3f - %5.3f for %s",
+		ZMIN, ZMAX, ptrparname );
+	sprintf(c2err,"does not cover ZGEN-range %5.3f - %5.3f", 
+		ZGEN[0], ZGEN[1] );
+	errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+      }
+    }
 
-  // check for SALT2c range & sigma
-  if ( strcmp(KEY,"GENRANGE_SALT2c:") == 0 ) {
-    readdouble ( fp_SIMLIB, 2, TMPRANGE );
-    SIMLIB_HEADER.GENGAUSS_SALT2c.PEAK     = 0.5*(TMPRANGE[0]+TMPRANGE[1]);
-    SIMLIB_HEADER.GENGAUSS_SALT2c.RANGE[0] = TMPRANGE[0] ;
-    SIMLIB_HEADER.GENGAUSS_SALT2c.RANGE[1] = TMPRANGE[1] ;
-    SIMLIB_HEADER.REGEN_FLAG = 1;
-  }
-  if ( strcmp(KEY,"GENSIGMA_SALT2c:") == 0 ) {
-    readdouble ( fp_SIMLIB, 1, &TMPVAL ); 
-    SIMLIB_HEADER.GENGAUSS_SALT2c.SIGMA[0] = TMPVAL ;
-    SIMLIB_HEADER.GENGAUSS_SALT2c.SIGMA[1] = TMPVAL ;
-  } 
+    // make sure ZVARIATION is zero at z=0
+    ZTMP  = 0.0 ;
+    shift = get_zvariation(ZTMP,ptrparname);
+    if ( shift != 0.0 ) {
+      sprintf(c1err,"%s-shift = %f at z=0", ptrparname, shift);
+      sprintf(c2err,"but shift(z=0) must be zero");
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    }
 
-  // check for SALT2x1 range & sigma
-  if ( strcmp(KEY,"GENRANGE_SALT2x1:")==0 ) {
-    readdouble ( fp_SIMLIB, 2, TMPRANGE );   
-    SIMLIB_HEADER.GENGAUSS_SALT2x1.PEAK     = 0.5*(TMPRANGE[0]+TMPRANGE[1]);
-    SIMLIB_HEADER.GENGAUSS_SALT2x1.RANGE[0] = TMPRANGE[0] ;
-    SIMLIB_HEADER.GENGAUSS_SALT2x1.RANGE[1] = TMPRANGE[1] ;
-    SIMLIB_HEADER.REGEN_FLAG = 1;
-  }
-  if ( strcmp(KEY,"GENSIGMA_SALT2x1:") == 0 ) {
-    readdouble ( fp_SIMLIB, 1, &TMPVAL ); 
-    SIMLIB_HEADER.GENGAUSS_SALT2x1.SIGMA[0] = TMPVAL ;
-    SIMLIB_HEADER.GENGAUSS_SALT2x1.SIGMA[1] = TMPVAL ;
-  } 
+  }  // end if i-loop over NPAR_ZVAR_USR
 
   return ;
 
-} // end parse_SIMLIB_GENRANGES
+} // end of init_zvariation
 
 
-int check_SIMLIB_GENRANGE(double *GENRANGE_ORIG, double *GENRANGE_NEW) {
+// *********************************
+void update_PARDEF_ZVAR(char *parName) {
 
-  // If GENRANGE_NEW has no overlap with GENRANGE_ORIG, return REJECT;
-  // otherwise return ACCEPT.
-  // If any part of GENRANGE_NEW is outisde GENRANGE_ORIG,
-  // modify GENRANGE_NEW so that it is contained inside GENRANGE_ORIG.
-  // Note that GENRANGE_NEW can change, but not GENRANGE_ORIG.
 
-  int REJECT = REJECT_FLAG ;
+  char fnam[] = "update_PARDEF_ZVAR" ;
 
-  // --------------- BEGIN ------------
+  // --------------- BEGIN -------------
 
-  if ( GENRANGE_NEW[0] >= GENRANGE_ORIG[1] ) { return(REJECT); }
-  if ( GENRANGE_NEW[1] <= GENRANGE_ORIG[0] ) { return(REJECT); }
-  
-  // now make sure that GENRANGE_NEW is contained inside GENRANGE_ORIG
-  if ( GENRANGE_NEW[0] < GENRANGE_ORIG[0] ) 
-    { GENRANGE_NEW[0] = GENRANGE_ORIG[0];  }
+  NPAR_ZVAR_TOT++ ;
 
-  if ( GENRANGE_NEW[1] > GENRANGE_ORIG[1] ) 
-    { GENRANGE_NEW[1] = GENRANGE_ORIG[1];  }
+  if ( NPAR_ZVAR_TOT >= MXPAR_ZVAR ) {
 
-  return(ACCEPT_FLAG);
+    int ipar ;
+    printf("\n PRE-ABORT DUMP: \n") ;
+    for(ipar=1; ipar < NPAR_ZVAR_TOT; ipar++ ) {
+      printf("\t ZVARIATION param %2d: '%s' \n", 
+	     ipar, PARDEF_ZVAR[ipar] );
+      fflush(stdout);
+    }
 
-} // end check_SIMLIB_GENRANGE
+    sprintf(c1err,"NPAR_ZVAR_TOT = %d exceeds bound of ", NPAR_ZVAR_TOT);
+    sprintf(c2err,"MXPAR_ZVAR = %d", MXPAR_ZVAR );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  }
 
 
-int regen_SIMLIB_GENRANGES(void) {
+  sprintf(PARDEF_ZVAR[NPAR_ZVAR_TOT], "%s", parName );
 
-  // Created Apr 13 2016 by R.Kessler
-  // called after reading each LIBID header,
-  // to check if anything needs to be re-generated.
-  //
-  // Functions returns +1 to keep event, -1 to reject.
-  //
-  // Initial motivation is to re-select PEAKMJD, redshift, 
-  // color and stretch for ABC method. 
-  //
-  // Jan 26 2018: fix bug and require HEADER-PEAKMJD>1000 to use it.
+  return ;
 
-  double tmpVal ;
-  int LTRACE = 0 ; 
-  int REJECT = REJECT_FLAG ;
-  double t0_old, z_old, x1_old, c_old ;
-  double t0_new, z_new, x1_new, c_new ;
-  char fnam[] = "regen_SIMLIB_GENRANGES" ;
+} // end of  update_PARDEF_ZVAR
 
-  // ------------ BEGIN -------------
 
-  if(LTRACE) {
-    printf(" xxx -----------CID=%d LIBID=%d -------------- \n",
-	   GENLC.CID, GENLC.SIMLIB_ID ) ;
-    printf(" xxx %s: 0 \n", fnam); 
-  }
+// *********************************
+void cp_zvariation(char *outFile_zvar) {
 
-  // check if there is anything to regenerate
-  if ( SIMLIB_HEADER.REGEN_FLAG == 0 ) { return(ACCEPT_FLAG); }
+  // read & copy Zvariation file to SIM/[VERSION] area
+  // Aug 19 2014: pass outFile_zvar
 
-  if ( SIMLIB_HEADER.FAKEID > 0 ) 
-    { GENLC.CID = SIMLIB_HEADER.FAKEID ; }
+  FILE *fpz, *fpz2 ;
+  char *ptrZfile, *ptrZfile2,  cline[84] ;
+  char fnam[] = "cp_zvariation" ;
 
+  // ------------ BEGIN ---------------
 
-  if ( LTRACE ) {
-    t0_old = GENLC.PEAKMJD ;
-    z_old  = GENLC.REDSHIFT_CMB ; 
-    x1_old = GENLC.SALT2x1 ;  
-    c_old  = GENLC.SALT2c ;
-  }
+  if ( USE_ZVAR_FILE == 0 ) { return ; }
 
-  //check redshift update 
-  double *ZWIN = SIMLIB_HEADER.GENRANGE_REDSHIFT ;
-  if(LTRACE) {printf(" xxx %s: 1 ZWIN=%f,%f\n", fnam,ZWIN[0],ZWIN[1] ); }
-  if ( ZWIN[0] > 1.0E-5 ) {
-    tmpVal = genz_hubble( ZWIN[0], ZWIN[1], &INPUTS.RATEPAR );
-    if(LTRACE) {printf(" xxx %s: 1b ZGEN=%f\n", fnam,tmpVal ); }
-    if ( tmpVal < INPUTS.GENRANGE_REDSHIFT[0] ) { return(REJECT); }
-    if ( tmpVal > INPUTS.GENRANGE_REDSHIFT[1] ) { return(REJECT); }
-    GENLC.REDSHIFT_CMB     = tmpVal ;
-    gen_distanceMag(GENLC.REDSHIFT_CMB, GENLC.REDSHIFT_CMB, // to fix later
-		    &GENLC.DLMU, &GENLC.LENSDMU);
-  }
+  ptrZfile  = INPUT_ZVARIATION_FILE;
+  ptrZfile2 = outFile_zvar ;  // target file for copy
 
-  // check PEAKMJD update
-  if(LTRACE) {printf(" xxx %s: 2 PEAKMJD=%f\n", fnam,GENLC.PEAKMJD ); }
-  if ( SIMLIB_HEADER.GENGAUSS_PEAKMJD.PEAK > 1000.0 ) {
-    tmpVal         = exec_GENGAUSS_ASYM(&SIMLIB_HEADER.GENGAUSS_PEAKMJD) ;
-    GENLC.PEAKMJD  = tmpVal ;  
-    if ( tmpVal < INPUTS.GENRANGE_PEAKMJD[0] ) { return(REJECT); }
-    if ( tmpVal > INPUTS.GENRANGE_PEAKMJD[1] ) { return(REJECT); }
+  // open files
+
+  if ( (fpz = fopen(ptrZfile, "rt"))==NULL ) {   
+    sprintf ( c1err, "Cannot open ZVARIATION_FILE (NPAR_ZVAR_USR=%d)",
+	      NPAR_ZVAR_USR );
+    sprintf ( c2err," '%s' ", ptrZfile );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  }
+  if ( (fpz2 = fopen(ptrZfile2, "wt"))==NULL ) {   
+    sprintf ( c1err, "Cannot open target ZVARIATION_FILE " );
+    sprintf ( c2err," '%s' ", ptrZfile2 );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
   }
 
+  while( fgets(cline, 80, fpz)  != NULL ) 
+    { fprintf(fpz2, "%s", cline); }
+  
+  fclose(fpz);
+  fclose(fpz2);
 
-  if(LTRACE) {printf(" xxx %s: 3 SALT2x1=%f\n", fnam,GENLC.SALT2x1 ); }
-  if ( fabs(SIMLIB_HEADER.GENGAUSS_SALT2x1.PEAK) < 90. ) {
-    tmpVal         = exec_GENGAUSS_ASYM(&SIMLIB_HEADER.GENGAUSS_SALT2x1);
-    GENLC.SALT2x1  = tmpVal ;
-    if ( tmpVal < INPUTS.GENGAUSS_SALT2x1.RANGE[0] ) { return(REJECT); }
-    if ( tmpVal > INPUTS.GENGAUSS_SALT2x1.RANGE[1] ) { return(REJECT); }
-  }
+  return ;
 
-  if(LTRACE) {printf(" xxx %s: 4 SALT2c=%f\n", fnam,GENLC.SALT2c ); }
-  if ( fabs(SIMLIB_HEADER.GENGAUSS_SALT2c.PEAK) < 90. ) {
-    tmpVal        = exec_GENGAUSS_ASYM(&SIMLIB_HEADER.GENGAUSS_SALT2c) ;
-    GENLC.SALT2c  = tmpVal ;
-    if ( tmpVal < INPUTS.GENGAUSS_SALT2c.RANGE[0] ) { return(REJECT); }
-    if ( tmpVal > INPUTS.GENGAUSS_SALT2c.RANGE[1] ) { return(REJECT); }
-  }
+} // end of cp_zvariation
+
+// *********************************
+double get_zvariation(double z, char *parname) {
 
+  // Created May 11, 2009 by R.Kessler
+  // Determine additive z-dependent shift for parname.
+  // Note that init_zvariation() must be called first.
+  //
+  // Sep 23, 2011: float -> double
 
-  // re-compute x0 and mB for SALT2 model
-  if ( INDEX_GENMODEL == MODEL_SALT2 ) {
-    GENLC.SALT2x0 = SALT2x0calc(GENLC.SALT2alpha, GENLC.SALT2beta, 
-				GENLC.SALT2x1, GENLC.SALT2c, GENLC.DLMU ) ;
-    GENLC.SALT2mB = SALT2mBcalc(GENLC.SALT2x0) ;
-  }
+  double shift, tmp, ZMIN, ZMAX, ZTMP, zpow, FMIN, FMAX  ;
+  int  ipar, ipar_match, MATCH, FLAG, i, NZ, iz, izmin, izmax ;
+  char fnam[] = "get_zvariation" ;
 
-  
-  if ( LTRACE ) {
-    t0_new = GENLC.PEAKMJD ;
-    z_new  = GENLC.REDSHIFT_CMB ; 
-    x1_new = GENLC.SALT2x1 ;  
-    c_new  = GENLC.SALT2c ;
+  // ------------ BEGIN -------------
 
-    printf(" xxx t0 = %.2f --> %.2f (%.1f to %.1f)\n", t0_old, t0_new, 
-	   SIMLIB_HEADER.GENGAUSS_PEAKMJD.RANGE[0], 
-	   SIMLIB_HEADER.GENGAUSS_PEAKMJD.RANGE[1] );
-    printf(" xxx z  = %7.4f --> %7.4f \n", z_old,  z_new );
-    printf(" xxx x1 = %7.4f --> %7.4f \n", x1_old, x1_new );
-    printf(" xxx c  = %7.4f --> %7.4f \n", c_old,  c_new );
-    fflush(stdout);
-  }
+  shift = 0.0 ;
 
-  return(ACCEPT_FLAG);
+  if ( NPAR_ZVAR_USR == 0 ) { return(shift);  }
 
-} //  end regen_SIMLIB_GENRANGES
+  // for first few events, check  that parnmae is on the
+  // PARDEF list, even if it's not on the user-list;
+  // this is to catch cases where a parname is passed that
+  // would never get used.
 
+  MATCH = 0;
+  if ( NGENLC_WRITE < 3 ) {
+    for ( ipar=0; ipar < MXPAR_ZVAR; ipar++ ) 
+      { if ( strcmp(parname,PARDEF_ZVAR[ipar]) == 0 ) MATCH=1; }
 
-// ========================
-void  ABORT_SIMLIB_FILTER(int isort) {
+    if ( MATCH == 0 ) {
+      sprintf(c1err,"Undefined parname = '%s' at Z=%f", parname, z );
+      sprintf(c2err,"Check file: '%s'", INPUT_ZVARIATION_FILE );
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    }
+  }
 
-  // Created Feb 2017
-  // Missing filter in SIMLIB, so here give proper abort message
-  // depending on regular filter or SPECTROGRAPH filter.
 
-  int NOBS_RAW = SIMLIB_HEADER.NOBS ;
-  int OBSRAW   = SIMLIB_LIST_forSORT.INDEX_SORT[isort]; 
-  int OPTLINE  = SIMLIB_OBS_RAW.OPTLINE[OBSRAW] ;
-  int IFILT_OBS= SIMLIB_OBS_RAW.IFILT_OBS[OBSRAW] ;
-  double MJD   = SIMLIB_OBS_RAW.MJD[OBSRAW] ;
-  char cfilt[2];
-  char fnam[]  = "ABORT_SIMLIB_FILTER" ;
+  // look for index that matches this IPAR
+  ipar_match = -9 ;
+  for ( ipar=0; ipar < NPAR_ZVAR_USR; ipar++ ) {
+    if ( strcmp(parname,INPUT_ZVARIATION[ipar].PARNAME) == 0  ) 
+      { ipar_match = ipar; }
+  }
 
-  // ----------- BEGIN ------------
+  if ( ipar_match < 0 ) { return(shift) ; }
 
+  // --- Now we have a match; compute z-dependent shift
 
-  sprintf(cfilt,  "%c", FILTERSTRING[IFILT_OBS] ) ;
+  ipar = ipar_match ;
+  FLAG = INPUT_ZVARIATION[ipar].FLAG;
 
-  printf("\n PRE-ABORT DUMP: \n" );
-  printf("   isort=%d  OBSRAW= %d of %d \n", isort, OBSRAW, NOBS_RAW );
-  printf("   LIBID=%d  MJD=%9.3f  OPTLINE=%d\n", 
-	 GENLC.SIMLIB_ID, MJD, OPTLINE ) ;
+  if ( FLAG == FLAG_ZPOLY_ZVAR ) {
+    shift = eval_GENPOLY(z,&INPUT_ZVARIATION[ipar].POLY,fnam);
+
+    /************* mark delete Apr 10 2019 xxxxxxxxxx
+    zpow = 1.0 ;
+    for ( i=0; i <= POLYORDER_ZVAR ; i++ ) {  // polynomial function
+      tmp = INPUT_ZVARIATION[ipar].ZPOLY[i] ;
+      shift += (tmp * zpow) ;
+      zpow *= z ; // avoid using slow pow function for powers of z    
+    }
+    xxxxxxxx end mark xxxxxxxxxxxxx*/
 
+  }
+  else if ( FLAG == FLAG_ZBINS_ZVAR ) {  // linear interpolate ZBINS
 
-  if ( OPTLINE == OPTLINE_SIMLIB_SPECTROGRAPH ) {
-    printf("   SPECTROGRAPH FILTERS: %s \n",
-	   INPUTS_SPECTRO.SYN_FILTERLIST_BAND );
-    sprintf(c1err, "missing Spectrograph filter='%s' ",  cfilt );
-    sprintf(c2err, "after 'FILTERS:'  key in SIMLIB header.");
+    // find zinbs that bound input redshift
+    NZ = INPUT_ZVARIATION[ipar].NZBIN;
+    izmin = 0 ;
+    for ( iz=0; iz < NZ; iz++ ) {
+      ZTMP = INPUT_ZVARIATION[ipar].ZBIN_VALUE[iz];
+      if ( ZTMP <= z ) izmin = iz ;
+    }
+    if ( izmin <= 0 ) {
+      sprintf(c1err,"izmin=0 for %s and z=%5.3f", parname, z );
+      errmsg(SEV_FATAL, 0, fnam, c1err, ""); 
+    }
+
+    izmax = izmin + 1;
+    ZMIN = INPUT_ZVARIATION[ipar].ZBIN_VALUE[izmin];
+    ZMAX = INPUT_ZVARIATION[ipar].ZBIN_VALUE[izmax];
+    FMIN = INPUT_ZVARIATION[ipar].ZBIN_PARSHIFT[izmin];
+    FMAX = INPUT_ZVARIATION[ipar].ZBIN_PARSHIFT[izmax];
+    shift = FMIN + (FMAX-FMIN)*(z-ZMIN)/(ZMAX-ZMIN) ;
   }
   else {
-    sprintf(c1err, "Unknown SIMLIB filter='%s' ",  cfilt );
-    sprintf(c2err, "Expecting filter from : '%s'", 
-	    SIMLIB_GLOBAL_HEADER.FILTERS );
+    sprintf(c1err,"Invalid FLAG=%d  for  %s", FLAG, parname);
+    errmsg(SEV_FATAL, 0, fnam, c1err, "" ); 
   }
-  
-  errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
 
+  return(shift) ;
 
-} // end ABORT_SIMLIB_FILTER
+} // end of get_zvariation
 
-// ================================================
-int USE_SAME_SIMLIB_ID(int IFLAG) {
 
-  // Dec 16 2015: 
-  // Return 1 to re-use the same SIMLIB_ID as last event.
-  // Return 0 otherwise to read another LIBID.
-  //
-  // IFLAG used for debug:
-  // IFLAG=1 if called from init_GENLC
-  // IFLAG=2 if called from SIMLIB_READ_DRIVER
+// *****************************************
+GENGAUSS_ASYM_DEF get_zvariation_GENGAUSS(double z, char *parName, 
+					  GENGAUSS_ASYM_DEF *GENGAUSS_INP) {
+
+  // Mar 2014
+  // Return GENGAUSS structure with z-variation.
+  // This allows applying z-variation to the population parameters
+  // instead of simply the generated parameters.
   //
-  // Apr 17 2017: fmodf -> fmod and XNTOT, XNUPD -> double
-  //             (to handle very large NGENTOT_LC)
+  // Inputs:
+  //  * z = redshift
+  //  * parName: name of parameter described by asymmetric Gaussian
+  //  * GENGAUSS_INP = struct with PEAK, SIGMA, RANGE, SKEW
   //
+  // Aug 30 2016: use copy_ASYMMGAUSS 
+  // Sep 01 2016: add SKEWNORMAL, and reFactor with for loops
+  // Jun 02 2017: check for 2nd Gaussian peak
 
-  int IDLOCK = GENLC.SIMLIB_IDLOCK ;
-  int OVP, OLD_SAMEFLAG=0, NEW_SAMEFLAG=0 ;
-  int LDMP = 0 ; // (GENLC.SIMLIB_ID >= 0 && IFLAG>0 );
-  char fnam[] = "USE_SAME_SIMLIB_ID" ;
+  int i;
+  char PARNAME[60];
+  GENGAUSS_ASYM_DEF GENGAUSS_OUT ;
 
-  // -------------- BEGIN --------------
+  char fnam[] = "get_zvariation_GENGAUSS" ;
 
-  if ( IFLAG==1 ) { SIMLIB_HEADER.NREPEAT++ ; }
+  // ---------- BEGIN ---------
 
-  // cannot repeast on 1st reading
-  if ( SIMLIB_HEADER.NREPEAT<=1 ) { return(0); }
-  
-  // check option to keep using same LIBID
-  if ( IDLOCK > 1 && GENLC.SIMLIB_ID > 0 ) { return 1; }
+  copy_GENGAUSS_ASYM(GENGAUSS_INP, &GENGAUSS_OUT) ;
+
+  // check for z-variation in the peak
+  sprintf(PARNAME, "GENMEAN_%s", parName );
+  GENGAUSS_OUT.PEAK += get_zvariation(z,PARNAME) ;
 
+  sprintf(PARNAME, "GENPEAK_%s", parName );
+  GENGAUSS_OUT.PEAK += get_zvariation(z,PARNAME) ;
 
-  if ( SIMLIB_HEADER.NREPEAT <= INPUTS.SIMLIB_NREPEAT ) { 
-    NEW_SAMEFLAG=1; 
+  // check for variation in the skew
+  for(i=0; i < 2; i++ ) {
+    sprintf(PARNAME, "GENSKEW[%d]_%s", i, parName );
+    GENGAUSS_OUT.SKEW[i] += get_zvariation(z,PARNAME) ;
   }
-  else if ( IFLAG == 2 ) { 
-    SIMLIB_HEADER.NREPEAT=1 ;    // reset
+
+
+  // check for variation in skewNormal (Sep 2016)
+  for(i=0; i < 3; i++ ) {
+    sprintf(PARNAME, "GENSKEWNORMAL[%d]_%s", i, parName );
+    GENGAUSS_OUT.SKEWNORMAL[i] += get_zvariation(z,PARNAME) ;
   }
 
-  if ( LDMP ) {
-    printf(" xxx ------------------------------------ \n");
-    printf(" xxx IFLAG=%d CID=%6d  LIBID=%3d  NREPEAT=%d  NGENLC_TOT=%d \n",
-	   IFLAG, GENLC.CID, GENLC.SIMLIB_ID,
-	   SIMLIB_HEADER.NREPEAT, NGENLC_TOT );
-    printf(" xxx --> SAMEFLAG[OLD,NEW] = %d, %d \n",
-	   OLD_SAMEFLAG, NEW_SAMEFLAG );    
-    fflush(stdout);
+  // check for variation in the SIGMAs
+  for(i=0; i < 2; i++ ) {
+    sprintf(PARNAME, "GENSIGMA[%d]_%s", i, parName );
+    GENGAUSS_OUT.SIGMA[i] += get_zvariation(z,PARNAME) ;
   }
 
-  if ( NEW_SAMEFLAG ) { return 1; }
 
-  // - - - - - - - - - - - - - - - - 
-  // check option to re-use same LIBID until an event is accepted
-  // (for ABC sims)
-  OVP = (INPUTS.SIMLIB_MSKOPT & SIMLIB_MSKOPT_REPEAT_UNTIL_ACCEPT );
-  if ( OVP > 0  &&  GENLC.ACCEPTFLAG_LAST == 0 ) 
-    { return(1); }
-  // - - - - - - - - - - - - - - - - 
+  // idiot checks 
+  sprintf(PARNAME, "GENSIGMA_%s", parName );
+  checkVal_GENGAUSS(PARNAME, &GENGAUSS_OUT.SIGMA[0], fnam );
 
-  // if we get here, read next LIBID
-  return 0 ;
+  sprintf(PARNAME, "GENRANGE_%s", parName );
+  checkVal_GENGAUSS(PARNAME, &GENGAUSS_OUT.RANGE[0], fnam );
 
-} // end USE_SAME_SIMLIB_ID
+  // -------------------------------------------
+  // check for 2nd peak (Jun 2017)
 
+  sprintf(PARNAME, "GENPROB2_%s", parName );
+  GENGAUSS_OUT.PROB2 += get_zvariation(z,PARNAME) ;
 
-// ==============================================
-void set_SIMLIB_NREPEAT(void) {
+  sprintf(PARNAME, "GENPEAK2_%s", parName );
+  GENGAUSS_OUT.PEAK2 += get_zvariation(z,PARNAME) ;
 
-  // Nov 2017
-  // set SIMLIB_NREPEAT for LCLIB model, using b-dependent rate.
-  // Do nothing for other models.
-  //
-  // Jun 28 2018: for SIMLIB_DUMP, set NREPEAT=1
+  // check for variation in the SIGMAs
+  for(i=0; i < 2; i++ ) {
+    sprintf(PARNAME, "GENSIGMA2[%d]_%s", i, parName );
+    GENGAUSS_OUT.SIGMA2[i] += get_zvariation(z,PARNAME) ;
+  }
 
-  int    NREPEAT_LO, NREPEAT ;
-  double relRate, XNREPEAT, XDIF, RA, DEC ;
-  char fnam[] = "set_SIMLIB_NREPEAT" ;
 
-  // ----------------- BEGIN -----------------
+  return GENGAUSS_OUT ;
 
-  if ( INDEX_GENMODEL != MODEL_LCLIB   ) { return ; }
+} // end of  get_zvariation_GENGAUSS" ;
 
-  RA  = SIMLIB_HEADER.RA ;
-  DEC = SIMLIB_HEADER.DEC ;
-  slaEqgal (RA, DEC,                    // input
-	    &GENLC.GLON, &GENLC.GLAT ); // output
 
-  if ( INPUTS.SIMLIB_DUMP >= 0 ) 
-    { SIMLIB_HEADER.NREPEAT = 1; return ; }
+// ***********************************
+void init_CIDRAN(void) {
 
-  if ( SIMLIB_HEADER.NREPEAT != 1 )  
-    { return ; }
+  // Oct 21, 2009 : init random CID option.
+  //
+  // CIDOFF is the offset to select from list
+  // so that different samples (with different CIDOFF)
+  // are guaranteed to have different CIDs.
+  //
+  // Jan 9, 2011: Declare logical USED array to quickly
+  //              check which CIDs have already been used.
+  //              Saves lots of init time for large jobs.
+  //
+  // Sep 09, 2012: replace local USED[] array with global *USEDCID
+  //               and free memory when finished.
+  //
+  // Dec 4, 2012: allocate memory for CIDRAN_LIST
+  //
+  // Apr 6 2017: replace USEDCID array with exec_cidmask function
+  //             that burns 1 bit per CID instead of 2 bytes per CID.
+  //
+  // Apr 10 2017: new algorithm to pick CID closest to CIDRAN to 
+  //              avoid abort when there are too few CIDRANs 
+  //              remaining.
+  //
+  // Aug 11 2017: after generating CID list, re-init randoms with NEWSEED
+  //
+  // Jul 22 2018: check minimum CID from user input (see MNCID)
 
+  int NPICKRAN_ABORT ; // abort after this many tries
+  int i, i2, j, NPICKRAN, NSTORE_ALL, NSTORE, CIDRAN, CIDTMP, CIDADD;
+  int CIDMAX, CIDMIN, USED, NTRY, NCID_MALLOC, NCALL_random=0, LDMP=0 ;
+  int L_STDOUT;
 
-  relRate  = GALrate_model(GENLC.GLON, GENLC.GLAT, &INPUTS.RATEPAR);
-  relRate /= INPUTS.RATEPAR.RATEMAX ;
-  XNREPEAT = (double)INPUTS.SIMLIB_MXREPEAT * relRate;
-  
-  // use random number to pick the low or high integer of XNREPEAT.
-  NREPEAT_LO = (int)XNREPEAT ;
-  XDIF       = XNREPEAT - (double)NREPEAT_LO ;
+  double r8, XN8, XNUPD8;
 
-  if ( XDIF < FlatRan1(1) ) 
-    { NREPEAT = NREPEAT_LO ; }
-  else
-    { NREPEAT = NREPEAT_LO+1 ; }
+  char fnam[] = "init_CIDRAN";
 
+  // ------------ BEGIN ------------
 
-  int LDMP = 0 ;
+  fflush(stdout);
+  if ( WRFLAG_CIDRAN  <= 0 ) { return ; }
 
-  if ( LDMP ) {
-    printf(" xxx ------------------------------------------ \n");
-    printf(" xxx CID=%d    RA=%f   DEC=%f   RATEMAX=%le\n",	
-	   GENLC.CID, RA, DEC, INPUTS.RATEPAR.RATEMAX ) ;
-    printf(" xxx b=%f  relRate=%.3f   XNREPEAT=%.3f  (XDIF=%.3f) NREPEAT=%d\n",
-	   GENLC.GLAT, relRate, XNREPEAT, XDIF, NREPEAT );
+  CIDMAX     = INPUTS.CIDRAN_MAX ; // -> local var      
+  CIDMIN     = INPUTS.CIDRAN_MIN ; 
+  NSTORE_ALL = INPUTS.CIDOFF + INPUTS.NGEN_LC + INPUTS.NGENTOT_LC ;
+  NSTORE     = INPUTS.NGEN_LC + INPUTS.NGENTOT_LC ; // for this sim-job
+
+  sprintf(BANNER,"init_CIDRAN: initialize %d RANDOM CIDs (CIDOFF=%d)",
+	  NSTORE_ALL, INPUTS.CIDOFF );
+
+  print_banner( BANNER );
+  printf("  ");
+
+  // --------------------------------------
+  // error checking on bounds.
+
+  if ( CIDMAX > MXCID_SIM ) {
+    sprintf(c1err, "CIDRAN_MAX=%d exceeds limit of MXCID_SIM=%d",
+	    CIDMAX, MXCID_SIM );
+    sprintf(c2err, "Reduce CIDRAN_MAX to be <= %d", MXCID_SIM );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
   }
 
-  INPUTS.SIMLIB_NREPEAT = NREPEAT ;
-
-  return ;
-
-} // end set_SIMLIB_NREPEAT
+  if ( NSTORE_ALL >= CIDMAX ) {
+    sprintf(c1err,"NSTORE_ALL=%d exceeds bound of CIDRAN_MAX = %d", 
+	    NSTORE_ALL, CIDMAX );
+    sprintf(c2err,"NSTORE_ALL= %d(CIDOFF) + %d(NGEN_LC) + %d(NGENTOT_LC)",
+	    INPUTS.CIDOFF, INPUTS.NGEN_LC, INPUTS.NGENTOT_LC );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  }
 
-// ================================================
-int SKIP_SIMLIB_FIELD(char *field) {
+  exec_cidmask(0,CIDMAX); // allocate bit-mask memory to store all CIDs
 
-  // Created Mar 2015.
-  // Returns 1 if this field should be skipped.
-  // Returns 0 if this field should be kept.
-  //
+  // allocate memory for big CIDRAN_LIST and print mem usage
+  // Beware that allocation could be as much as 400 MB,
+  // more than the static size of snlc_sim.exe.
+  float XMEM = (float)(NSTORE+2) * (4.0 / 1.0E6) ;
+  printf("\t CIDRAN_MIN/MAX = %d/%d   CIDOFF=%d   NSTORE_JOB=%d\n", 
+	 CIDMIN, CIDMAX, INPUTS.CIDOFF, NSTORE );
+  printf("\t CIDRAN_LIST memory allocation: %6.3f MB \n", XMEM);
+  fflush(stdout);
 
-  if ( strcmp(INPUTS.SIMLIB_FIELDLIST,"ALL") == 0 ) 
-    { return 0 ; }
+  INPUTS.CIDRAN_LIST = (int*)malloc( (NSTORE+2)*sizeof(int) );
 
-  if ( strstr(INPUTS.SIMLIB_FIELDLIST,field) == NULL ) 
-    { return 1; }
-  else 
-    { return 0; }
+  // start main loop
 
-} // end of SKIP_SIMLIB_FIELD
+  if ( NSTORE_ALL < 200000 ) 
+    { XNUPD8 = 1.0E4; }     // screen update
+  else if ( NSTORE_ALL < 2000000 )   // 2 million
+    { XNUPD8 = 1.0E5 ; }
+  else if ( NSTORE_ALL < 20000000 )  // 20 million
+    { XNUPD8 = 1.0E6 ; }
+  else
+    { XNUPD8 = 5.0E6 ; }
 
-// ================================================
-int  parse_SIMLIB_ZPT(char *cZPT, double *ZPT, 
-		      char *cfiltList, int *ifiltList) {
+  // set abort to 5% of NSTORE (Apr 10 1017)
+  NPICKRAN_ABORT = (NSTORE_ALL/20);
+  if ( NPICKRAN_ABORT < 100 ) { NPICKRAN_ABORT = 100; }
 
-  // Created Dec 2011
-  // Parse string *cZPT to return either float ZPT
-  // or list of filters to sum and *ZPT = -9.0;
-  // Examples:
-  //  cZPT = 28.654   => *ZPT = 28.654 and cfiltList = unchanged 
-  //  cZPT = +28.654  => *ZPT = 28.654 and cfiltList = unchanged 
-  //  cZPT = 2+3+4+5  => *ZPT = -9     and cfiltList = 2345  
-  //
-  // Returned function value is strlen(cfiltList)
-  //
-  // Mar 1 2014: float *ZPT -> double
+  // - - - - - - - - - - - - - - - - - - 
 
-  int NFILT, jplus, LEN, I, i, ifilt, ifilt_obs;
-  char *ptrPlus, cfilt[4], ctmp[4] ;
+  for( i = 0; i <= NSTORE_ALL ; i++ ) {
 
-  char fnam[] = "parse_SIMLIB_ZPT";
+    // LDMP = ( fmod( (double)i, 4200000.0 ) == 0 && i>130000000 ) ;
 
-  // -------------- BEGIN -------------
+    NPICKRAN = 0 ;
+    
+  PICKRAN:
+    NPICKRAN++ ;
 
-  // init output args
-  NFILT = 0;
-  *ZPT = -999.0;
+    if ( NPICKRAN >= NPICKRAN_ABORT ) {
+      sprintf(c1err,"Could not find unused random CID after %d tries.",
+	      NPICKRAN);
+      sprintf(c2err,"Something is wrong at istore=%d of %d ", 
+	      i, NSTORE_ALL) ;
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    }
 
-  // check if there is a '+' sign in the cZPT string.
-  ptrPlus  = strstr(cZPT,"+");
-  jplus    = ptrPlus - cZPT ;  // = 1 few if '+' in there
-      
-  if ( jplus < 1 || jplus > 100 ) {
-    *ZPT = atof(cZPT);
-    sprintf(ctmp,"%s ", cfiltList );
-    ifiltList[0] = filtindx_( ctmp, strlen(ctmp) ); 
-  }
-  else  { 
+    // use unix 'random' instead of snana 'rangen()'.
+    // because rangen() uses a finite list of randoms.
+    r8 = unix_random();   
+    NCALL_random++ ;
+    CIDRAN = CIDMIN + (int)( r8 * (double)(CIDMAX-CIDMIN) ) ;
 
-    *ZPT = 19.999 ; // 19.999
-    cfiltList[0] = 0 ;  // reset input value
-    // strip off the filter chars between the plus signs
-    LEN = strlen(cZPT);
-    i   = -1 ;
+    if ( CIDRAN >= CIDMAX  )       { goto PICKRAN ; }
+    if ( CIDRAN <= CIDMIN  )       { goto PICKRAN ; }
 
-    for ( I = 0 ; I < LEN; I++ ) {
+    // Find closest unused CID to CIDRAN
+    USED=1; i2 = 0 ; CIDADD = -9 ;
+    while ( USED ) {
 
-      sprintf(cfilt, "%c", cZPT[I] );
-      if ( strcmp(cfilt,"+") == 0 ) { continue; }
+      // loop over +- 1 to try both directions from CIDRAN
+      NTRY = 0 ;
+      for(j=-1; j <= +1; j+=2 ) {
+	CIDTMP = CIDRAN + (j*i2) ;
+	if ( CIDTMP < CIDMAX  &&  CIDTMP > CIDMIN ) {
+	  NTRY++ ;
+	  if ( exec_cidmask(2,CIDTMP)==0 && CIDADD<0 ) { CIDADD = CIDTMP; } 
+	}
+      }
 
-      strcat(cfiltList, cfilt); // append filter list
-      i++ ;
+      if ( NTRY == 0 ) {
+	
+	for(j=1; j <= CIDMAX; j++ ) {
+	  if ( j < 100 || (CIDMAX-j)<100 ) {
+	    printf("  xxx CID= %3d --> cidmask=%d \n",
+		   j, exec_cidmask(2,j) );
+	  }
+	}
+	printf(" xxx global MXCIDMASK = %d   NCIDMASK_LIST=%d\n", 
+	       MXCIDMASK, NCIDMASK_LIST );
+	printf(" xxx global CIDMASK_LIST = %d, %d, %d \n",
+	       CIDMASK_LIST[0], CIDMASK_LIST[1], CIDMASK_LIST[2] ) ;
 
-      // check that this is a valid filter.
-      // Note that we need a stupid blank space for filtindx_ function
-      sprintf(ctmp,"%s ", cfilt);
-      ifilt_obs    = filtindx_( ctmp, strlen(ctmp) ); 
-      ifiltList[i] = ifilt_obs ;
-      ifilt        = GENLC.IFILTINVMAP_OBS[ifilt_obs];
-      if ( ifilt < 0 || ifilt >= GENLC.NFILTDEF_OBS ) {
-	sprintf(c1err,"Invalid filter='%s'(%d) in cZPT='%s' ", 
-		cfilt, ifilt_obs, cZPT );
-	sprintf(c2err,"Check simlib file %s", INPUTS.SIMLIB_FILE );
-	errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
+	sprintf(c1err,"Unable to try CIDTMP = %d or %d  (CIDRAN=%d)",
+		CIDRAN-i2, CIDRAN+i2, CIDRAN );
+	sprintf(c2err,"CIDMAX=%d  NPICKRAN=%d  i=%d of %d  CID=%d", 
+		CIDMAX, NPICKRAN, i, NSTORE_ALL, GENLC.CID );
+	errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
       }
 
-      
-    } // end loop over LEN
-  }
-      
-  // get number of filters in list for return function arg.
-  NFILT = strlen(cfiltList);
+      i2++ ;
+      if ( CIDADD > 0 ) {
+	exec_cidmask(1,CIDADD); // set "USED" bit
+	if ( i >= INPUTS.CIDOFF ) 
+	  { INPUTS.CIDRAN_LIST[i-INPUTS.CIDOFF] = CIDADD ; }
+	USED = 0 ;
+      }
 
-  /*
-  printf(" ZZZZZ cZPT(%s) = '%s'  ZPT=%f   NFILT=%d  jplus=%d\n", 
-	 cfiltList, cZPT, *ZPT, NFILT, jplus );
-  */
+    } // end USED block
 
-  return NFILT ;
+    // check for screen update 
+    XN8    = (double)i ;
+    L_STDOUT = ( fmod(XN8,XNUPD8) == 0 && i > 0 );
+    if ( L_STDOUT ) {
+      if ( XNUPD8 < 0.999E6 )  {  printf("%6d ", i);         }
+      else          	       {  printf("%dM ", i/1000000); }
+      fflush(stdout);
+    }
 
-} // end of parse_SIMLIB_ZPT
+    if ( LDMP ) {
+      printf("\n xxx i=%d  i2=%d  CIDRAN=%d CIDADD=%d \n",
+	     i, i2, CIDRAN, CIDADD);
+    }
 
+    //    printf(" xxx CIDRAN[%6.6d] = %6d \n", i, CIDRAN ) ;
 
-// ====================================
-void get_SIMLIB_SCALES( int ifilt_obs
-		       ,double *SHIFT_ZPT
-		       ,double *SCALE_SKYSIG
-		       ,double *SCALE_READNOISE
-		       ) {
+  } // end i-loop
 
-  // Apr 26, 2011
-  // return SIMLIB scales based on MSKOPT
-  //
-  // Feb 2012: init to INPUTS.FUDGESCALE_XXX
-  // May 2013: READNOISE is scaled separately from SKYNOISE
-  //
-  // init to fudged values
-  //
-  // Jun 19 2017: use filter-dependent ZPT shift.
-  //
-  // --------- BEGIN ----------
-  
-  *SCALE_SKYSIG    = (double)INPUTS.FUDGESCALE_SKYNOISE ;
-  *SCALE_READNOISE = (double)INPUTS.FUDGESCALE_READNOISE ;
-  *SHIFT_ZPT       = (double)INPUTS.FUDGESHIFT_ZPT_FILTER[ifilt_obs] ;
+  printf("\n\t Done allocating %d random CIDs: %d for current sim-job \n", 
+	 NSTORE_ALL, NSTORE); fflush(stdout);
+  printf("\t Called random() function %d times.\n", NCALL_random );
 
+  // Aug 2017: re-init randoms with new SEED that is different
+  //           for each sim_SNmix job
+  int NEWSEED = INPUTS.ISEED + INPUTS.CIDOFF ;
+  srandom(NEWSEED);
 
-  if ( INPUTS.EXPOSURE_TIME_MSKOPT  & (1 << 0) )
-    { *SHIFT_ZPT  += GENLC.SHIFT_ZPTSIMLIB[ifilt_obs]; }
+  return ;
 
+} // end of init_CIDRAN
 
-  if ( INPUTS.EXPOSURE_TIME_MSKOPT  & (1 << 1) )
-    { *SCALE_SKYSIG  *= GENLC.SCALE_NOISE[ifilt_obs] ; }
 
 
-  if ( INPUTS.EXPOSURE_TIME_MSKOPT  & (1 << 2) )
-    { *SCALE_READNOISE  *= GENLC.SCALE_NOISE[ifilt_obs] ; }
+// **************************
+void sort_CIDRAN(void) {
 
+  // Created Nov 30, 2011 by R.Kessler
+  // sort random CIDs so that they will be generated in 
+  // monotonically increasing order. This is needed to simplify
+  // the merging of [FITS] samples with random CIDs.
+  // Make sure to order only the randoms after CIDOFF,
+  // INPUTS.CIDRAN_LIST[CIDOFF+1 ...]
+  //
+  // Jun 9 2013: do NOT sort for NON1a, otherwise the NON1A CIDs
+  //             are ordered.
+  //
+  // ---------------- BEGIN --------------
 
-} // end of get_SIMLIB_SCALES
+  int
+    NCID, CIDOFF
+    ,ORDER_SORT   
+    ,*INDEX_SORT
+    ,*CIDRAN_TMPLIST
+    ,isort, i
+    ;
 
-// ***********************************
-void ENDSIMLIB_check(void) {
+  if ( INDEX_GENMODEL == MODEL_NON1ASED  ) { return ; }
+  if ( INDEX_GENMODEL == MODEL_NON1AGRID ) { return ; } // Apr 3 2016 
 
-  // Created Apr 29, 2009 by R.Kessler
-  // called after reading entire simlib to check
-  // if anything passes MJD, RA and DECL cuts.
-  // If not, abort with message instead of wrapping
-  // around in an infinite loop.
+  CIDOFF = INPUTS.CIDOFF ;
+  NCID   = INPUTS.NGEN_LC + INPUTS.NGENTOT_LC ;
 
-  char fnam[] = "ENDSIMLIB_check";
+  // allocate temp array to store sorted indices
+  CIDRAN_TMPLIST = (int*)malloc( (NCID+1) * sizeof(int));
+  INDEX_SORT     = (int*)malloc( (NCID+1) * sizeof(int));
 
-  // ------- BEGIN ---------
+  // transfer random CIDs to temporary list
+  for ( i=1; i <= NCID; i++ ) 
+    { CIDRAN_TMPLIST[i] = INPUTS.CIDRAN_LIST[i] ;  }
 
-  if ( INPUTS.SIMLIB_DUMP >= 0 ) return ;
+  ORDER_SORT = +1 ; // increasing order
+  sortInt(NCID, &CIDRAN_TMPLIST[1], ORDER_SORT, &INDEX_SORT[1] );
 
-  if ( SIMLIB_HEADER.NFOUND_RA == 0 ) {
-    sprintf(c1err,"Could not find SIMLIB RA within");
-    sprintf(c2err,"GENRANGE_RA : %f - %f  deg" ,
-	    INPUTS.GENRANGE_RA[0], INPUTS.GENRANGE_RA[1]  );
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
-  }
 
-  if ( SIMLIB_HEADER.NFOUND_DEC == 0 ) {
-    sprintf(c1err,"Could not find SIMLIB DEC within");
-    sprintf(c2err,"GENRANGE_DEC : %f - %f  deg" ,
-	    INPUTS.GENRANGE_DEC[0], INPUTS.GENRANGE_DEC[1] );
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+  //  re-create CIDRAN_LIST with sorted CIDs 
+  for ( i=1; i <= NCID; i++ ) {
+    isort = INDEX_SORT[i] + 1 ; // fortran-like index
+    INPUTS.CIDRAN_LIST[i] = CIDRAN_TMPLIST[isort] ;
   }
 
-  if ( strcmp(INPUTS.SIMLIB_FIELDLIST,"ALL") != 0 ) {
-    if ( SIMLIB_HEADER.NFOUND_FIELD == 0 ) {
-      sprintf(c1err,"Could not find SIMLIB FIELD '%s' ", 
-	      INPUTS.SIMLIB_FIELDLIST );
-      sprintf(c2err,"Check sim-input file and SIMLIB file.");
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
-    }
-  }
+  free(CIDRAN_TMPLIST);
+  free(INDEX_SORT);
 
+} // end of sort_CIDRAN
 
-} // end of ENDSIMLIB_check
 
 
-// *********************************
-void init_zvariation(void) {
+// *****************************************
+void checkpar_SIMSED(void) {
 
-  // Created May 11, 2009 by R.Kessler
-  //
-  // Read/parse ZVARIATION_FILE and load ZVARIATION struct.
-  // To allow another z-dependent parameter,
-  //   * increment MXPAR_ZVAR in snlc_sim.h
-  //   * udpate PARDEF_ZVAR array in snlc_sim.h
-  //   * apply get_zvariation() call at appropriate place in snlc_sim.c
-  //
-  // Feb 22 2013: move hard-wired PARDEF_ZVAR list from snlc_sim.h to here.
+  // Dec 20, 2009:
+  // make sanity checks, mainly that user sim-input
+  // SIMSED-parameters match those of the model.
+  // Also make sure that generation PEAK, RANGE and SIGMA 
+  // are specified for each SIMSED parameter.
   //
-  // Mar 12 2014: if ZPOLY keys have already been read from sim-input file,
-  //              skip reading separate ZVAR file.
+  // If no baggage params are specified, then add them all to list.
+  // If SIMGEN_DUMP is used, add all SIMSED params to SIMGEN_DUMP list.
   //
-  // Mar 16, 2014: major overhaul to define z-dependence on any
-  //               population param; see PREFIX_GENGAUSS.
   //
-  // Mar 24, 2014: Fixed auxilliary ZPAR file 
-  //     INPUT_ZVARIATION[i].FLAG bug (JLM)
+  // Jun 15, 2013: for SIMSED model, do NOT check for MEAN and SIGMA
   //
-  // Apr 23 2015: allow 'END:' key in ZVAR-file.
-  // Oct 27 2017: add SKEWNORMAL[0,1,2]
+  // July 28 2017:
+  //  For GRIDONLY and FLAT distribution, fix the range to be 
+  //  MIN-0.5*BIN to MAX+0.5*BIN so that each bin is equally
+  //  populated.
   //
-  // Apr 20 2017:
-  //  +  always allow host AV & RV (not just for mlcs)
-  //  + add "EXPSIG","EXPTAU" to list of GEN[prefixes]
+  // Feb 19 2018:
+  //  Fix bug from last July. Use ipar_model instead of ipar_user
+  //  for SIMSED lookups.
   //
-  // Jun 2 2017: add 2nd-peak params to PREFIX_GENGAUSS
-  // Jul 19 2017: add GENMAG_OFF_GLOBAL to update list
-  // Jul 24 2017: update error reporting of NZBIN exceeding boung.
-
-  char *ptrZfile, *ptrparname, *ptrPar;
-  char GENPREFIX[60], c_get[60], method[20], parName[60], cpoly[60] ;
-
-#define NPREFIX_GENGAUSS 15
-  char PREFIX_GENGAUSS[NPREFIX_GENGAUSS][20] 
-    = 
-    { "PEAK", "MEAN", "SKEW[0]", "SKEW[1]", "SIGMA[0]", "SIGMA[1]",
-      "SKEWNORMAL[0]", "SKEWNORMAL[1]", "SKEWNORMAL[2]",
-      "PROB2", "PEAK2", "SIGMA2[0]", "SIGMA2[1]" ,
-      "EXPSIG", "EXPTAU"
-    } ;
-
-  double *ptrpoly, *ptrzval, *ptrzshift, ZTMP, ZMIN, ZMAX, ZGEN[2], shift ;
-  int i, i2, NZ, MATCH, NTMP, FLAG, ipar, IPAR_USR;
-  int IZVAR_DEJA, IZVAR_FILE ;
-  FILE *fpz;
-  char    fnam[] = "init_zvariation" ;
-
-  // -------------- BEGIN ----------------
 
-  IZVAR_DEJA = ( NPAR_ZVAR_USR > 0 ) ; // already read from sim-input file
-  IZVAR_FILE = USE_ZVAR_FILE ;
-  ptrZfile   = INPUT_ZVARIATION_FILE ;
-  ptrparname = fnam; // avoid compile warning
-  FLAG       = -9 ;
+  int  GENFLAG, ipar, ipar_model, ipar_user, ipar_tmp
+    ,IPAR_MODEL_USED[MXPAR_SIMSED]
+    ,NBPAR, NTMP, N, NPAR_MODEL, idump, ISGRIDONLY, ISFLAT
+    ;
 
-  if ( IZVAR_DEJA == 0 && IZVAR_FILE == 0 ) { return ; }
+  double  tmpdif, range_model[2], range_user[2], bin_user, SIGMA[2] ;
 
-  // allow only one input option
-  if ( IZVAR_DEJA && IZVAR_FILE ) {
-    sprintf ( c1err,"Cannot specify ZVARIATION_FILE and ZPOLY keys");
-    sprintf ( c2err,"in sim-input file. Pick one or the other." );
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ;
-  }
+  char
+    fnam[] = "checkpar_SIMSED"
+    ,parname_model[40]  // defined in modes/SIMSED
+    ,parname_user[40]   // defined in sim-input file
+    ,*ptrDumpVar
+    ,*ptrSIMSEDVar
+    ;
 
-  // -------------------------------------------
-  // hard-wire list of valid parameter names
+  // -------------- BEGIN ---------------
 
-  NPAR_ZVAR_TOT = 0 ;
+  // get total number of parameters in this SIMSED model
+  INPUTS.NPAR_SIMSED_MODEL = NPAR_SEDMODEL();
+  NPAR_MODEL               = INPUTS.NPAR_SIMSED_MODEL;
 
+  for ( ipar_tmp = 0; ipar_tmp < INPUTS.NPAR_SIMSED_MODEL; ipar_tmp++ )
+    { IPAR_MODEL_USED[ipar_tmp] = 0; }
 
-  // allow any GENPREFIX to modify population params.
+  for ( ipar_user = 0; ipar_user < INPUTS.NPAR_SIMSED; ipar_user++ ) {
 
-  for (i=0; i < NPREFIX_GENGAUSS; i++ ) {
+    sprintf(parname_user,"%s", INPUTS.PARNAME_SIMSED[ipar_user] );
+    GENFLAG  = INPUTS.GENFLAG_SIMSED[ipar_user];   
+    SIGMA[0] = INPUTS.GENGAUSS_SIMSED[ipar_user].SIGMA[0] ;
+    SIGMA[1] = INPUTS.GENGAUSS_SIMSED[ipar_user].SIGMA[1] ;
 
-    sprintf(GENPREFIX,"GEN%s", PREFIX_GENGAUSS[i] );
+    // find which model parameter matches user parameter
+    ipar_model = -9 ;
+    for ( ipar_tmp = 0; ipar_tmp < NPAR_MODEL; ipar_tmp++ ) {
+      fetch_parInfo_SEDMODEL(ipar_tmp, parname_model, &NBPAR, range_model );
 
-    // always allow host AV & RV
-    sprintf(parName,"%s_RV", GENPREFIX );
-    update_PARDEF_ZVAR( parName );
-    
-    sprintf(parName,"%s_AV", GENPREFIX );
-    update_PARDEF_ZVAR( parName );
-    
-    if ( INPUTS.NPAR_SIMSED > 0 ) { 
-      for ( ipar=0; ipar < INPUTS.NPAR_SIMSED; ipar++ ) {
-	ptrPar = INPUTS.PARNAME_SIMSED[ipar] ;
-	sprintf(parName,"%s_%s", GENPREFIX, ptrPar);      
-	update_PARDEF_ZVAR( parName );
+      if ( strcmp(parname_user,parname_model) == 0 ) {
+	ipar_model = ipar_tmp ;
+	IPAR_MODEL_USED[ipar_model] = 1;
       }
-    } 
-    else if ( INDEX_GENMODEL == MODEL_SALT2 ) { 
-
-      sprintf(parName,"%s_SALT2x1", GENPREFIX );
-      update_PARDEF_ZVAR( parName );
-
-      sprintf(parName,"%s_SALT2c", GENPREFIX );
-      update_PARDEF_ZVAR( parName );
-
-      sprintf(parName,"%s_SALT2ALPHA", GENPREFIX );
-      update_PARDEF_ZVAR( parName );
-
-      sprintf(parName,"%s_SALT2BETA", GENPREFIX );
-      update_PARDEF_ZVAR( parName );
     }
-    else {
-
-      sprintf(parName,"%s_DELTA", GENPREFIX );
-      update_PARDEF_ZVAR( parName );
-
-      sprintf(parName,"%s_DM15", GENPREFIX );
-      update_PARDEF_ZVAR( parName );
 
-      sprintf(parName,"%s_STRETCH", GENPREFIX );
-      update_PARDEF_ZVAR( parName );
+    if ( ipar_model < 0 ) {
+      sprintf(c1err,"invalid user SIMSED param: '%s'", parname_user);
+      sprintf(c2err,"Check sim-input file and SED.INFO file." );
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
     }
-    
-  } // end i loop over PREFIX_GENGAUSS
 
 
-  // add a few miscellaneous variables.
-  if ( INPUTS.NPAR_SIMSED == 0 ) { 
-    update_PARDEF_ZVAR( "GENEXPTAU_AV"       );  // Mar 2013
-    update_PARDEF_ZVAR( "GENGAUSIG_AV"       );
-    update_PARDEF_ZVAR( "GENGAUPEAK_AV"      );
-    update_PARDEF_ZVAR( "GENRATIO_AV0"       );
-    update_PARDEF_ZVAR( "VSI"                ); // Si velocity for VCR model
-    update_PARDEF_ZVAR( "GENMAG_OFF_GLOBAL"  ); // added July 2017
-  }
+    GENLC.SIMSED_IPARMAP[ipar_user] = ipar_model ; // Nov 18, 2011
 
-  // ---------------------------------
-  // check for PARDEF-dump option
-  if ( strcmp(ptrZfile,"0") == 0 ) {
-    printf("\n\n");
-    print_banner("Valid parameters to simulate Z-dependence:");
-    for ( i=0; i < MXPAR_ZVAR; i++ )  { printf(" %s", PARDEF_ZVAR[i] ); }
-    printf("\n");    happyend();
-  }
+    fetch_parInfo_SEDMODEL(ipar_model, parname_model, &NBPAR, range_model );
 
+    // July 28 2017
+    // if GRIDONLY option and flat distribution, set range to
+    // min-0.5*bin to max+0.5*bin so that each bin is sample
+    // with equal prob
+    ISGRIDONLY = (GENFLAG & OPTMASK_SIMSED_GRIDONLY);
+    ISFLAT     = (SIGMA[0] > 1.0E7 );
+    if ( ISGRIDONLY && ISFLAT ) {
 
-  // if ZPOLY keys have already been read from sim-input file,
-  // skip reading separate ZVAR file.
-  if ( IZVAR_DEJA ) { goto ZVAR_SUMMARY ; }
+      bin_user      = SEDMODEL.PARVAL_BIN[ipar_model] ;
+      range_user[0] = SEDMODEL.PARVAL_MIN[ipar_model] - 0.5*bin_user ;
+      range_user[1] = SEDMODEL.PARVAL_MAX[ipar_model] + 0.5*bin_user;
 
+      INPUTS.GENGAUSS_SIMSED[ipar_user].RANGE[0] = range_user[0] ;
+      INPUTS.GENGAUSS_SIMSED[ipar_user].RANGE[1] = range_user[1] ;
+    }
 
-  // -------------------------------------------
-  // open file
-  if ( (fpz = fopen(ptrZfile, "rt"))==NULL ) {   
-    sprintf ( c1err, "Cannot open ZVARIATION_FILE " );
-    sprintf ( c2err," '%s' ", ptrZfile );
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
-  }
+    // skip the tests below for baggage or GRIDONLY parameters
+    if ( GENFLAG != OPTMASK_SIMSED_PARAM    ) { continue ; }
 
-  print_banner(" Read Z-DEPENDENCE for SIM PARAMETERS ");
+    // continue here only for continuous distribution
+    range_user[0] = INPUTS.GENGAUSS_SIMSED[ipar_user].RANGE[0] ;
+    range_user[1] = INPUTS.GENGAUSS_SIMSED[ipar_user].RANGE[1] ;
 
-  while( (fscanf(fpz, "%s", c_get)) != EOF) {
+    // extend range by epsilon to allow boundary values.
+    // Note this doesn't help for delta-function range.
+    tmpdif = range_model[1] - range_model[0];
+    range_model[0] -= (tmpdif * 1.E-8) ;
+    range_model[1] += (tmpdif * 1.E-8) ;
 
-    // allow END key to ignore anything after
-    if ( strcmp(c_get,"END:") == 0 ) { fclose(fpz) ;  goto ZVAR_SUMMARY ; }
-    
-    if ( strcmp(c_get,"PARAMETER:") == 0 ) {
-      IPAR_USR = NPAR_ZVAR_USR;
-      ptrparname = INPUT_ZVARIATION[IPAR_USR].PARNAME ;
-      readchar(fpz, ptrparname);
-      FLAG = INPUT_ZVARIATION[IPAR_USR].FLAG ;
-      NPAR_ZVAR_USR++ ;
+    sprintf(c2err,"Check sim-input keyword GENRANGE_%s  (ipar_user=%d)", 
+	    parname_model, ipar_user );
+
+    // make sure that user-range does not exceed defined range of model.
+    if ( range_user[0] < range_model[0] ) {
+      sprintf(c1err,"User %s-min = %6.3f < model min-range=%6.3f", 
+	      parname_model, range_user[0], range_model[0] );
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+    }
+
+    if ( range_user[1] > range_model[1] ) {
+      sprintf(c1err,"User %s-max = %6.3f > model max-range=%6.3f", 
+	      parname_model, range_user[1], range_model[1] );
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
     }
 
-    if ( strcmp(c_get,"ZPOLY:") == 0 ) {
-      if ( FLAG > 0 ) {
-	sprintf(c1err, "Found ZPOLY but ZVARIATION[%d].FLAG=%d already set", 
-		IPAR_USR, FLAG);
-	sprintf(c2err,"for %s . Check file: %s", ptrparname, ptrZfile );
-	errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
-      }
-      readchar(fpz,cpoly);
-      if ( strstr(cpoly,",") == NULL ) {
-	sprintf(c1err,"Must use comma-separate poly coefficients");
-	sprintf(c2err,"for ZPOLY option with param = '%s'", ptrparname);
-	errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+
+    // make sure that all information is specified.
+    sprintf(c2err,"Check sim-input file.");
+
+    if ( INDEX_GENMODEL != MODEL_SIMSED ) {
+      if ( INPUTS.GENGAUSS_SIMSED[ipar_user].PEAK == -999. ) {
+	sprintf(c1err,"GENMEAN_%s not specified", parname_model );
+	errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
       }
-      parse_GENPOLY(cpoly,&INPUT_ZVARIATION[IPAR_USR].POLY, fnam);
     }
 
-    if ( strcmp(c_get,"ZBIN:") == 0 ) {
-      INPUT_ZVARIATION[IPAR_USR].FLAG = FLAG_ZBINS_ZVAR ; //JLM
-      NZ = INPUT_ZVARIATION[IPAR_USR].NZBIN;
-      INPUT_ZVARIATION[IPAR_USR].NZBIN++ ;  
+    if ( INPUTS.GENGAUSS_SIMSED[ipar_user].RANGE[0] == -999. ) {
+      sprintf(c1err,"GENRANGE_%s not specified", parname_model );
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+    }
+    if ( INPUTS.GENGAUSS_SIMSED[ipar_user].RANGE[1] == -999. ) {
+      sprintf(c1err,"GENRANGE_%s not specified", parname_model );
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+    }
 
-      if ( NZ < MXZBIN_ZVAR ) {
-	ptrzval   = &INPUT_ZVARIATION[IPAR_USR].ZBIN_VALUE[NZ];
-	ptrzshift = &INPUT_ZVARIATION[IPAR_USR].ZBIN_PARSHIFT[NZ];
-	readdouble(fpz, 1, ptrzval );
-	readdouble(fpz, 1, ptrzshift );
-	
-	ZMIN   = INPUT_ZVARIATION[IPAR_USR].ZBIN_VALUE[0];
-	ZMAX   = INPUT_ZVARIATION[IPAR_USR].ZBIN_VALUE[NZ];
+    if ( INDEX_GENMODEL != MODEL_SIMSED ) {
+      if ( INPUTS.GENGAUSS_SIMSED[ipar_user].SIGMA[0] == -999. ) {
+	sprintf(c1err,"GENSIGMA_%s not specified", parname_model );
+	errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+      }
+      if ( INPUTS.GENGAUSS_SIMSED[ipar_user].SIGMA[1] == -999. ) {
+	sprintf(c1err,"GENSIGMA_%s not specified", parname_model );
+	errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
       }
     }
 
-  } // end of read loop
+  } // end ipar loop
 
-  // - - - - -
 
-  NZ = INPUT_ZVARIATION[NPAR_ZVAR_USR-1].NZBIN;
-  if ( NZ >= MXZBIN_ZVAR ) {
-    sprintf(c1err,"NZBIN=%d for %s exceeds bound MXZBIN_ZVAR=%d", 
-	    NZ,ptrparname, MXZBIN_ZVAR );
-    sprintf ( c2err,"Check file: '%s' ", ptrZfile );
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
-  }
+  // Set un-used MODEL parameters as baggage params.
 
-  fclose(fpz) ;
+  NTMP = INPUTS.NPAR_SIMSED_param;
+  if ( NTMP == 0 ) {
 
-  // -------------------
+    for ( ipar_model = 0; ipar_model < NPAR_MODEL; ipar_model++ ) {
+      if ( IPAR_MODEL_USED[ipar_model] == 0 ) {     
 
- ZVAR_SUMMARY:
+	N = INPUTS.NPAR_SIMSED ;
+	INPUTS.GENFLAG_SIMSED[N] = OPTMASK_SIMSED_param ;
+	sprintf(INPUTS.KEYWORD_SIMSED[N],"SIMSED_param");
+	fetch_parInfo_SEDMODEL(ipar_model, INPUTS.PARNAME_SIMSED[N],
+			  &NBPAR, range_model );
 
-  // print summary, and make sure that GEN-Z range is covered
-  // by ZBIN option
+	GENLC.SIMSED_IPARMAP[N] = ipar_model ; // Nov 18, 2011
 
-  for ( i=0; i < NPAR_ZVAR_USR; i++ ) {
-    ptrparname = INPUT_ZVARIATION[i].PARNAME;
-    FLAG       = INPUT_ZVARIATION[i].FLAG ;
-    NZ         = INPUT_ZVARIATION[i].NZBIN;
-    ZMIN       = INPUT_ZVARIATION[i].ZBIN_VALUE[0];
-    ZMAX       = INPUT_ZVARIATION[i].ZBIN_VALUE[NZ-1];
+	printf("\t Load baggage parameter '%s' \n",
+	       INPUTS.PARNAME_SIMSED[N] );
 
-    // set method comment based on flag
+	INPUTS.NPAR_SIMSED++ ;
+	INPUTS.NPAR_SIMSED_param++ ;
+	if ( INPUTS.NPAR_SIMSED >= MXPAR_SIMSED ) {
+	  sprintf(c1err,"NPAR_SIMSED=%d exceeds MXPAR_SIMSED=%d",
+		  INPUTS.NPAR_SIMSED, MXPAR_SIMSED ) ;
+	  sprintf(c2err,"Need to increase MXPAR_SIMSED");
+	  errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
+	}
 
-    if ( FLAG == FLAG_ZPOLY_ZVAR ) 
-      { sprintf(method,"ZPOLY"); }
-    else if ( FLAG == FLAG_ZBINS_ZVAR ) {
-      { sprintf(method,"ZBINS"); }
-    }
-    else {
-      sprintf(c1err,"Invalid FLAG=%d for %s", FLAG, ptrparname );
-      errmsg(SEV_FATAL, 0, fnam, c1err, "" ); 
+      }
     }
 
-    printf("\t Init Z-variation (zvar) for '%s' (method = %s)\n", 
-	   ptrparname, method );
-
-    // ========== IDIOT CHECKS ===============
+  } // NTMP=0
 
-    // make sure that this parameter is valid
-    MATCH = 0;
-    for ( i2=0; i2 < MXPAR_ZVAR; i2++ ) 
-      { if ( strcmp(ptrparname,PARDEF_ZVAR[i2]) == 0 ) MATCH=1; }
 
-    if ( MATCH == 0 ) {
-      sprintf(c1err,"Unrecognized SIM-parameter '%s'", ptrparname );
-      sprintf(c2err,"Cannot apply Z-dependence.");
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
-    }
+  // Add the SIMSED parameters to the SIMGEN_DUMP list
+  // if the list is specified.
 
-    // do NOT allow extrapolation past ZBIN range
+  NTMP = INPUTS.NVAR_SIMGEN_DUMP ;
+  if ( NTMP > 0  && INPUTS.WRFLAG_MODELPAR ) {
 
-    if ( FLAG == FLAG_ZBINS_ZVAR ) {
-      ZGEN[0] = INPUTS.GENRANGE_REDSHIFT[0];
-      ZGEN[1] = INPUTS.GENRANGE_REDSHIFT[1];
-      if ( ZMIN > ZGEN[0] ||  ZMAX < ZGEN[1] ) {
-	sprintf(c1err," ZBIN range %5.3f - %5.3f for %s",
-		ZMIN, ZMAX, ptrparname );
-	sprintf(c2err,"does not cover ZGEN-range %5.3f - %5.3f", 
-		ZGEN[0], ZGEN[1] );
-	errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
-      }
-    }
+    // first check that no SIMSED PARAM/param is specified ... 
+    // otherwise abort.
+    for ( idump=0; idump < INPUTS.NVAR_SIMGEN_DUMP; idump++ ) {
+      for ( ipar = 0; ipar < INPUTS.NPAR_SIMSED; ipar++ ) {
+	ptrDumpVar    = INPUTS.VARNAME_SIMGEN_DUMP[idump] ;
+	ptrSIMSEDVar  = INPUTS.PARNAME_SIMSED[ipar] ;
+	if ( strcmp(ptrDumpVar,ptrSIMSEDVar) == 0 ) {
+	  sprintf(c1err,"SIMSED Param '%s' cannot be in SIMGEN_DUMP list",
+		  ptrDumpVar);
+	  sprintf(c2err,"because SIMSED Params are added automatically.");
+	  errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
+	}
 
-    // make sure ZVARIATION is zero at z=0
-    ZTMP  = 0.0 ;
-    shift = get_zvariation(ZTMP,ptrparname);
-    if ( shift != 0.0 ) {
-      sprintf(c1err,"%s-shift = %f at z=0", ptrparname, shift);
-      sprintf(c2err,"but shift(z=0) must be zero");
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
-    }
+      } // ipar
+    } // idump
 
-  }  // end if i-loop over NPAR_ZVAR_USR
+    // Now load all SIMSED params onto SIMGEN_DUMP list
+    for ( ipar = 0; ipar < INPUTS.NPAR_SIMSED; ipar++ ) {
+      idump = INPUTS.NVAR_SIMGEN_DUMP ;
+      ptrDumpVar    = INPUTS.VARNAME_SIMGEN_DUMP[idump] ;
+      ptrSIMSEDVar  = INPUTS.PARNAME_SIMSED[ipar] ;
+      sprintf(ptrDumpVar,"%s", ptrSIMSEDVar );     
+      INPUTS.NVAR_SIMGEN_DUMP++ ;
+    }    
+  }
 
-  return ;
 
-} // end of init_zvariation
+  // -----------------------------------
+  // For the "SIMSED_GRIDONLY: SEQUENTIAL" option, 
+  // set NGEN_LC equal to the number of SEDs so that 
+  // each SED is processed once.
+  if ( INPUTS.OPTMASK_SIMSED == OPTMASK_SIMSED_GRIDONLY ) {
+    N = NSED_SEDMODEL();
+    INPUTS.NGEN = N ;
+    INPUTS.NGENTOT_LC = N;
+    INPUTS.NGEN_LC    = 0;
 
+    set_screen_update(N);
+    /*
+    if ( INPUTS.NGEN_LC    > 0 ) { INPUTS.NGEN_LC    = N; }
+    if ( INPUTS.NGENTOT_LC > 0 ) { INPUTS.NGENTOT_LC = N; }
+    */
+  }
 
-// *********************************
-void update_PARDEF_ZVAR(char *parName) {
 
+  //  debugexit("add baggage params");
+  
+} // end of checkpar_SIMSED
 
-  char fnam[] = "update_PARDEF_ZVAR" ;
 
-  // --------------- BEGIN -------------
+// **********************************
+int GENRANGE_CUT(void) {
 
-  NPAR_ZVAR_TOT++ ;
+  // Cut on user-specified GEN-ranges.
+  // returns 1 if generated quantities pass cuts; 0 otherwise
+  // Note that these cuts do not effect the rate calculation
+  //
+  // Aug 24 2015: if using HOSTLIB, require value ZTRUE.
+  //              Abort if too many hosts aren't found.
+  //
+  // Aug 22 2018: skip REDSHIFT cut for LCLIB model.
 
-  if ( NPAR_ZVAR_TOT >= MXPAR_ZVAR ) {
+  int LTRACE=0;
+  int istat ;
+  char fnam[] = "GENRANGE_CUT" ;
 
-    int ipar ;
-    printf("\n PRE-ABORT DUMP: \n") ;
-    for(ipar=1; ipar < NPAR_ZVAR_TOT; ipar++ ) {
-      printf("\t ZVARIATION param %2d: '%s' \n", 
-	     ipar, PARDEF_ZVAR[ipar] );
-      fflush(stdout);
-    }
+  // ----------- BEGIN ------------
 
-    sprintf(c1err,"NPAR_ZVAR_TOT = %d exceeds bound of ", NPAR_ZVAR_TOT);
-    sprintf(c2err,"MXPAR_ZVAR = %d", MXPAR_ZVAR );
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID  ) {
+    istat = 1 ; return istat ;
   }
 
+  istat = 0 ;
 
-  sprintf(PARDEF_ZVAR[NPAR_ZVAR_TOT], "%s", parName );
+  if(LTRACE) { printf(" xxx %s: 0 check RA=%f \n", fnam, GENLC.RA); }
+  if ( GENLC.RA < INPUTS.GENRANGE_RA[0] ) { return istat; }
+  if ( GENLC.RA > INPUTS.GENRANGE_RA[1] ) { return istat; }
 
-  return ;
+  if(LTRACE) { printf(" xxx %s: 1 check RA=%f \n", fnam, GENLC.DEC); }
+  if ( GENLC.DEC < INPUTS.GENRANGE_DEC[0] )  { return istat; }
+  if ( GENLC.DEC > INPUTS.GENRANGE_DEC[1] )  { return istat; }
 
-} // end of  update_PARDEF_ZVAR
+  if ( INDEX_GENMODEL != MODEL_LCLIB ) {
+    if(LTRACE) {printf(" xxx %s: 2 check zCMB=%f \n",fnam,GENLC.REDSHIFT_CMB);}
+    if ( GENLC.REDSHIFT_CMB < INPUTS.GENRANGE_REDSHIFT[0] ) { return istat; }
+    if ( GENLC.REDSHIFT_CMB > INPUTS.GENRANGE_REDSHIFT[1] ) { return istat; }
+  }
 
+  if(LTRACE) { printf(" xxx %s: 3 check PEAKMJD=%f \n", fnam, GENLC.PEAKMJD); }
+  if ( GENLC.PEAKMJD < INPUTS.GENRANGE_PEAKMJD[0] )  { return istat; }
+  if ( GENLC.PEAKMJD > INPUTS.GENRANGE_PEAKMJD[1] )  { return istat; }
 
-// *********************************
-void cp_zvariation(char *outFile_zvar) {
+  if ( INPUTS.HOSTLIB_USE && SNHOSTGAL.ZTRUE < 0.0 )  {  
+    // if number of missing host-gals exceeds NGEN, then abort
+    // to avoid infinite loop (NTHREAD_GEN: count only for owner)
+    NGEN_REJECT.HOSTLIB += SIMTHREAD.OWNER ;
+    int BIGRATIO = ( NGEN_REJECT.HOSTLIB > 2*NGENLC_WRITE );
+    if ( BIGRATIO && NGENLC_WRITE > 10 ) {
+      float x = (float)NGEN_REJECT.HOSTLIB / (float)NGENLC_WRITE ;
+      sprintf(c1err,"%d events rejected because HOST cannot be found:",
+	      NGEN_REJECT.HOSTLIB );
+      sprintf(c2err,"NREJECT/NGENLC_WRITE=%d/%d = %.1f --> "
+	      "need bigger HOSTLIB",
+	      NGEN_REJECT.HOSTLIB, NGENLC_WRITE, x );
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
+    }
+    return istat; 
+  }
+
+
+  istat = 1 ;
+  return istat ;
+ 
+} // end of GENRANGE_CUT
 
-  // read & copy Zvariation file to SIM/[VERSION] area
-  // Aug 19 2014: pass outFile_zvar
 
-  FILE *fpz, *fpz2 ;
-  char *ptrZfile, *ptrZfile2,  cline[84] ;
-  char fnam[] = "cp_zvariation" ;
+// **********************************
+int GENMAG_CUT(void) {
 
-  // ------------ BEGIN ---------------
+  // Created Mar 16 2016
+  // Cut on PEAKMAG here after generation but before
+  // the light curve is digitized.
+  // Returns 1 if passing cut
+  // Returns 0 if failing cut
 
-  if ( USE_ZVAR_FILE == 0 ) { return ; }
+  int ifilt_obs, ifilt, PASS ;
+  double PEAKMAG;
+  //  char fnam[] = "GENMAG_CUT";
 
-  ptrZfile  = INPUT_ZVARIATION_FILE;
-  ptrZfile2 = outFile_zvar ;  // target file for copy
+  // --------------- BEGIN ----------------
 
-  // open files
+  PASS = 0 ;
 
-  if ( (fpz = fopen(ptrZfile, "rt"))==NULL ) {   
-    sprintf ( c1err, "Cannot open ZVARIATION_FILE (NPAR_ZVAR_USR=%d)",
-	      NPAR_ZVAR_USR );
-    sprintf ( c2err," '%s' ", ptrZfile );
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
+    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];    
+    PEAKMAG = GENLC.peakmag8_obs[ifilt_obs] ;
+    if ( PEAKMAG < INPUTS.GENRANGE_PEAKMAG[0] ) { continue; }
+    if ( PEAKMAG > INPUTS.GENRANGE_PEAKMAG[1] ) { continue; }
+    PASS = 1;
   }
-  if ( (fpz2 = fopen(ptrZfile2, "wt"))==NULL ) {   
-    sprintf ( c1err, "Cannot open target ZVARIATION_FILE " );
-    sprintf ( c2err," '%s' ", ptrZfile2 );
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+
+  /*
+  if ( PASS == 0 ) {
+    printf(" xxx fail PEAKMAG=%f for z=%f \n",
+	   PEAKMAG, GENLC.REDSHIFT_CMB );
   }
+  */
 
-  while( fgets(cline, 80, fpz)  != NULL ) 
-    { fprintf(fpz2, "%s", cline); }
-  
-  fclose(fpz);
-  fclose(fpz2);
+  return(PASS);
 
-  return ;
+} // end GENMAG_CUT
 
-} // end of cp_zvariation
 
-// *********************************
-double get_zvariation(double z, char *parname) {
+// ***************************************
+int geneff_calc(void) {
 
-  // Created May 11, 2009 by R.Kessler
-  // Determine additive z-dependent shift for parname.
-  // Note that init_zvariation() must be called first.
+  // Feb 9, 2008: compute generation efficiency & error.
+  //              Mainly useful for generating efficiency maps.
   //
-  // Sep 23, 2011: float -> double
+  // Jul 17, 2009: return 0 for normal status; return 1 to STOP because
+  //               effic-error is below user-allowed limit
+  // 
+  // Dec 22 2015: modify STOPGEN logic to be more robust. 
+  //              Min allowed EFFERR -> EFFERR_STOPGEN * sqrt(1000/NGEN_LC)
+  //
+  float XN1, XN0, EFF, EFF_ERR, SQERR ;
+  int ISTOP;
 
-  double shift, tmp, ZMIN, ZMAX, ZTMP, zpow, FMIN, FMAX  ;
-  int  ipar, ipar_match, MATCH, FLAG, i, NZ, iz, izmin, izmax ;
-  char fnam[] = "get_zvariation" ;
+  char fnam[] = "geneff_calc" ;
 
-  // ------------ BEGIN -------------
+  // -------- BEGIN ------
 
-  shift = 0.0 ;
+  ISTOP = 0;
 
-  if ( NPAR_ZVAR_USR == 0 ) { return(shift);  }
+  XN1 = (float)NGENLC_WRITE ;
 
-  // for first few events, check  that parnmae is on the
-  // PARDEF list, even if it's not on the user-list;
-  // this is to catch cases where a parname is passed that
-  // would never get used.
+  // normalization (XN0) include generated light curves that were
+  // rejected by the search & by CUTWIN-cuts, but EXCLUDEs those
+  // rejected by generation-ranges.
 
-  MATCH = 0;
-  if ( NGENLC_WRITE < 3 ) {
-    for ( ipar=0; ipar < MXPAR_ZVAR; ipar++ ) 
-      { if ( strcmp(parname,PARDEF_ZVAR[ipar]) == 0 ) MATCH=1; }
+  XN0 = (float)(NGENLC_TOT - NGEN_REJECT.GENRANGE );
 
-    if ( MATCH == 0 ) {
-      sprintf(c1err,"Undefined parname = '%s' at Z=%f", parname, z );
-      sprintf(c2err,"Check file: '%s'", INPUT_ZVARIATION_FILE );
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
-    }
-  }
+  if ( XN0 > 0.0 ) {
+    EFF     = XN1 / XN0 ;
+    SQERR   = XN1 * (XN0-XN1) / ( XN0*XN0*XN0 ) ;
+    EFF_ERR = sqrtf( SQERR ) ;
 
+    // effic error cannot be zero ...
+    if ( EFF_ERR == 0.0 ) 
+      EFF_ERR = 1.0 / XN0 ;
 
-  // look for index that matches this IPAR
-  ipar_match = -9 ;
-  for ( ipar=0; ipar < NPAR_ZVAR_USR; ipar++ ) {
-    if ( strcmp(parname,INPUT_ZVARIATION[ipar].PARNAME) == 0  ) 
-      { ipar_match = ipar; }
   }
+  else {
+    EFF     = 0.0 ; 
+    EFF_ERR = 1.0 ;  // set large error to avoid STOPGEN
 
-  if ( ipar_match < 0 ) { return(shift) ; }
-
-  // --- Now we have a match; compute z-dependent shift
-
-  ipar = ipar_match ;
-  FLAG = INPUT_ZVARIATION[ipar].FLAG;
-
-  if ( FLAG == FLAG_ZPOLY_ZVAR ) {
-    shift = eval_GENPOLY(z,&INPUT_ZVARIATION[ipar].POLY,fnam);
+    // if NGEN_REJECT.GENRANGE is 1000, and we still have
+    // not accepted anything abort with error message.
 
-    /************* mark delete Apr 10 2019 xxxxxxxxxx
-    zpow = 1.0 ;
-    for ( i=0; i <= POLYORDER_ZVAR ; i++ ) {  // polynomial function
-      tmp = INPUT_ZVARIATION[ipar].ZPOLY[i] ;
-      shift += (tmp * zpow) ;
-      zpow *= z ; // avoid using slow pow function for powers of z    
+    if ( NGEN_REJECT.GENRANGE >= 1000 ) {
+      sprintf(c1err,"Generated %d light curves, but NONE pass GENRANGEs",
+	      NGEN_REJECT.GENRANGE );
+      sprintf(c2err,"Check GENRANGEs for RA, DECL, REDSHIFT, PEAKMJD") ;
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
     }
-    xxxxxxxx end mark xxxxxxxxxxxxx*/
-
   }
-  else if ( FLAG == FLAG_ZBINS_ZVAR ) {  // linear interpolate ZBINS
-
-    // find zinbs that bound input redshift
-    NZ = INPUT_ZVARIATION[ipar].NZBIN;
-    izmin = 0 ;
-    for ( iz=0; iz < NZ; iz++ ) {
-      ZTMP = INPUT_ZVARIATION[ipar].ZBIN_VALUE[iz];
-      if ( ZTMP <= z ) izmin = iz ;
-    }
-    if ( izmin <= 0 ) {
-      sprintf(c1err,"izmin=0 for %s and z=%5.3f", parname, z );
-      errmsg(SEV_FATAL, 0, fnam, c1err, ""); 
-    }
 
-    izmax = izmin + 1;
-    ZMIN = INPUT_ZVARIATION[ipar].ZBIN_VALUE[izmin];
-    ZMAX = INPUT_ZVARIATION[ipar].ZBIN_VALUE[izmax];
-    FMIN = INPUT_ZVARIATION[ipar].ZBIN_PARSHIFT[izmin];
-    FMAX = INPUT_ZVARIATION[ipar].ZBIN_PARSHIFT[izmax];
-    shift = FMIN + (FMAX-FMIN)*(z-ZMIN)/(ZMAX-ZMIN) ;
-  }
-  else {
-    sprintf(c1err,"Invalid FLAG=%d  for  %s", FLAG, parname);
-    errmsg(SEV_FATAL, 0, fnam, c1err, "" ); 
-  }
+  GENLC.GENEFF    = EFF ;
+  GENLC.GENEFFERR = EFF_ERR ;
 
-  return(shift) ;
 
-} // end of get_zvariation
+  return ISTOP ;
 
+} // end of geneff_calc
 
-// *****************************************
-GENGAUSS_ASYM_DEF get_zvariation_GENGAUSS(double z, char *parName, 
-					  GENGAUSS_ASYM_DEF *GENGAUSS_INP) {
+// ***************************************
+int gen_cutwin(void) {
 
-  // Mar 2014
-  // Return GENGAUSS structure with z-variation.
-  // This allows applying z-variation to the population parameters
-  // instead of simply the generated parameters.
+  // apply cut-windows; returns SUCCESS or ERROR.
+  // ERROR just means that this SN fails cuts.
   //
-  // Inputs:
-  //  * z = redshift
-  //  * parName: name of parameter described by asymmetric Gaussian
-  //  * GENGAUSS_INP = struct with PEAK, SIGMA, RANGE, SKEW
+  // Jan 12, 2013: replace CERNLIB sortzv with sortFloat wrapper
   //
-  // Aug 30 2016: use copy_ASYMMGAUSS 
-  // Sep 01 2016: add SKEWNORMAL, and reFactor with for loops
-  // Jun 02 2017: check for 2nd Gaussian peak
-
-  int i;
-  char PARNAME[60];
-  GENGAUSS_ASYM_DEF GENGAUSS_OUT ;
+  // Jan 31, 2014: abort on any undefined filter in CUTWIN_SNRMAX.
+  //
+  // Mar 1, 2014: for SNRMAX, use flux_errstat instead flux_errtot
+  //              since flux_errstat is written to data file.
+  //
+  //
+  // May 11 2015: fill GENLC.SNRMAX_TRUE[ifilt_obs]
+  //
+  // Aug 10 2017: malloc and free TLIST and INDEX_SORT
+  //
+  // Sep 25 2017: check CUTWIN_EPOCHS_xxx to select fast transients.
+  //
+  // May 2018: check SATURATION  cuts
+  // Jun 22 2018: fux bug initializing SNRMAX_FILT[icut][ifilt]
+  // Aug 19 2018: apply HOST_ZPHOT cut
 
-  char fnam[] = "get_zvariation_GENGAUSS" ;
+  int 
+    NEP, ep, i, icut, ifilt, ifilt_obs 
+    ,LTMP, LSNR, NTMP, NFCUT, IFILTOBS_LIST[MXFILTINDX]
+    ,NTLIST, USE_TGAP, USE_T0GAP, LDMP, opt_frame, MEM
+    ;
 
-  // ---------- BEGIN ---------
+  float 
+    SNR, trueSNR
+    ,SNRMAX_FILT[MXCUTWIN_SNRMAX][MXFILTINDX] 
+    ,SNRMAX_TMP[MXFILTINDX] 
+    ,lamrest[MXFILTINDX] 
+    ,Trest, Tlast, TGAP, T0GAPOVP[2], flux, fluxerr, peakmag
+    ,lamobs, lamrms, lammin, lammax, z1, zhel
+    ,*TLIST    
+    ;
 
-  copy_GENGAUSS_ASYM(GENGAUSS_INP, &GENGAUSS_OUT) ;
+  double MJD, MJD_last, MJDDIF, GAIN, MJD_SNRMIN_FIRST, MJD_SNRMIN_LAST;
 
-  // check for z-variation in the peak
-  sprintf(PARNAME, "GENMEAN_%s", parName );
-  GENGAUSS_OUT.PEAK += get_zvariation(z,PARNAME) ;
+  // TLIST sorting variables
+  int   DOCUTS, ORDER_SORT, isort ;
+  int  *INDEX_SORT ;
 
-  sprintf(PARNAME, "GENPEAK_%s", parName );
-  GENGAUSS_OUT.PEAK += get_zvariation(z,PARNAME) ;
+  char cfilt[2];
+  char fnam[] = "gen_cutwin" ;
 
-  // check for variation in the skew
-  for(i=0; i < 2; i++ ) {
-    sprintf(PARNAME, "GENSKEW[%d]_%s", i, parName );
-    GENGAUSS_OUT.SKEW[i] += get_zvariation(z,PARNAME) ;
-  }
+  // ------------ BEGIN -------------
 
+  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID  ) { return SUCCESS; }
 
-  // check for variation in skewNormal (Sep 2016)
-  for(i=0; i < 3; i++ ) {
-    sprintf(PARNAME, "GENSKEWNORMAL[%d]_%s", i, parName );
-    GENGAUSS_OUT.SKEWNORMAL[i] += get_zvariation(z,PARNAME) ;
-  }
+  // bail if no cuts and no dump are specified:
 
-  // check for variation in the SIGMAs
-  for(i=0; i < 2; i++ ) {
-    sprintf(PARNAME, "GENSIGMA[%d]_%s", i, parName );
-    GENGAUSS_OUT.SIGMA[i] += get_zvariation(z,PARNAME) ;
-  }
+  if ( INPUTS.APPLY_CUTWIN_OPT > 0  || 
+       INPUTS.NVAR_SIMGEN_DUMP > 0  ||
+       INPUTS.OPT_FUDGE_SNRMAX > 0    )  
+    { DOCUTS = 1; }
+  else 
+    { DOCUTS = 0 ;    return SUCCESS ;  }
 
+  // if we get here, calcualte CUT-WINDOW variables.
+  
+  LDMP = ( GENLC.CID < -5555 ) ;
 
-  // idiot checks 
-  sprintf(PARNAME, "GENSIGMA_%s", parName );
-  checkVal_GENGAUSS(PARNAME, &GENGAUSS_OUT.SIGMA[0], fnam );
+  if ( LDMP ) {
+    printf("\n xxx ----------------------------------------------- \n");
+    printf(" xxx START gen_cutwin() dump for CID=%d  LIBID=%d\n", 
+	   GENLC.CID, GENLC.SIMLIB_ID );
+    printf(" xxx NEP=%d  zHel=%.4f  PEAKMJD=%.3f  MWEBV=%.3f\n",   
+	   GENLC.NEPOCH, GENLC.REDSHIFT_HELIO, 
+	   GENLC.PEAKMJD, GENLC.MWEBV );
+    fflush(stdout);
+  }
 
-  sprintf(PARNAME, "GENRANGE_%s", parName );
-  checkVal_GENGAUSS(PARNAME, &GENGAUSS_OUT.RANGE[0], fnam );
+  zhel  = GENLC.REDSHIFT_HELIO ;
+  z1 = ( 1. + zhel );
 
-  // -------------------------------------------
-  // check for 2nd peak (Jun 2017)
+  NEP = GENLC.NEPOCH;
 
-  sprintf(PARNAME, "GENPROB2_%s", parName );
-  GENGAUSS_OUT.PROB2 += get_zvariation(z,PARNAME) ;
+  // INDEX_SORT is used for epochs and also for filters,
+  // so make sure the MEM size can handle all filters.
+  MEM=NEP; if (NEP < MXFILTINDX) { MEM=MXFILTINDX+1; }
 
-  sprintf(PARNAME, "GENPEAK2_%s", parName );
-  GENGAUSS_OUT.PEAK2 += get_zvariation(z,PARNAME) ;
+  TLIST      = malloc( MEM * sizeof(float) ) ;
+  INDEX_SORT = malloc( MEM * sizeof(int)   ) ;
 
-  // check for variation in the SIGMAs
-  for(i=0; i < 2; i++ ) {
-    sprintf(PARNAME, "GENSIGMA2[%d]_%s", i, parName );
-    GENGAUSS_OUT.SIGMA2[i] += get_zvariation(z,PARNAME) ;
+  for ( ifilt_obs=0; ifilt_obs < MXFILTINDX; ifilt_obs++ ) {
+    SNRMAX_TMP[ifilt_obs]           = -9.0 ;
+    GENLC.SNRMAX_FILT[ifilt_obs]    = -9.0 ;  
+    GENLC.SNRMAX_SORTED[ifilt_obs]  = -9.0 ;  
+    GENLC.SNRMAX_TRUE[ifilt_obs]    = -9.0 ;  
+    for ( icut=0; icut <= MXCUTWIN_SNRMAX; icut++ )
+      { SNRMAX_FILT[icut][ifilt_obs] = -9.0 ; }
   }
+  GENLC.TIME_ABOVE_SNRMIN = 0.0 ;
 
+  // get lamrest for each observer filter
+  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
+    opt_frame = GENFRAME_OBS;
+    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];    
+    get_filtlam__(&opt_frame, &ifilt_obs,  &lamobs,&lamrms,&lammin,&lammax);
+    lamrest[ifilt_obs] = lamobs / z1 ;
+  }
 
-  return GENGAUSS_OUT ;
-
-} // end of  get_zvariation_GENGAUSS" ;
+  // make redshift cut on true and/or final(measured) 
+  int LZTRUE=0, LZFINAL=0, LZPHOT=0 ;
+  double ZTRUE, ZFINAL, ZPHOT ;
+  ZTRUE  = GENLC.REDSHIFT_CMB;
+  ZFINAL = GENLC.REDSHIFT_CMB_SMEAR ;
+  ZPHOT  = SNHOSTGAL.ZPHOT ; 
 
+  LZTRUE = ( ZTRUE >= INPUTS.CUTWIN_REDSHIFT_TRUE[0] && 
+	     ZTRUE <= INPUTS.CUTWIN_REDSHIFT_TRUE[1] ) ;
+  LZFINAL = ( ZFINAL >= INPUTS.CUTWIN_REDSHIFT_FINAL[0] && 
+	      ZFINAL <= INPUTS.CUTWIN_REDSHIFT_FINAL[1] ) ;
+  LZPHOT  = ( ZPHOT >= INPUTS.CUTWIN_HOST_ZPHOT[0] && 
+	      ZPHOT <= INPUTS.CUTWIN_HOST_ZPHOT[1] ) ;
 
-// ***********************************
-void init_CIDRAN(void) {
+  if ( LZTRUE && LZFINAL && LZPHOT ) 
+    { GENLC.CUTBIT_MASK |= (1 << CUTBIT_REDSHIFT); }
 
-  // Oct 21, 2009 : init random CID option.
-  //
-  // CIDOFF is the offset to select from list
-  // so that different samples (with different CIDOFF)
-  // are guaranteed to have different CIDs.
-  //
-  // Jan 9, 2011: Declare logical USED array to quickly
-  //              check which CIDs have already been used.
-  //              Saves lots of init time for large jobs.
-  //
-  // Sep 09, 2012: replace local USED[] array with global *USEDCID
-  //               and free memory when finished.
-  //
-  // Dec 4, 2012: allocate memory for CIDRAN_LIST
-  //
-  // Apr 6 2017: replace USEDCID array with exec_cidmask function
-  //             that burns 1 bit per CID instead of 2 bytes per CID.
-  //
-  // Apr 10 2017: new algorithm to pick CID closest to CIDRAN to 
-  //              avoid abort when there are too few CIDRANs 
-  //              remaining.
-  //
-  // Aug 11 2017: after generating CID list, re-init randoms with NEWSEED
-  //
-  // Jul 22 2018: check minimum CID from user input (see MNCID)
+  // start loop over epochs
+  NTLIST    = 0 ;
+  MJD_last  = -99999. ;
+  MJD_SNRMIN_FIRST = MJD_SNRMIN_LAST = 0.0 ;
 
-  int NPICKRAN_ABORT ; // abort after this many tries
-  int i, i2, j, NPICKRAN, NSTORE_ALL, NSTORE, CIDRAN, CIDTMP, CIDADD;
-  int CIDMAX, CIDMIN, USED, NTRY, NCID_MALLOC, NCALL_random=0, LDMP=0 ;
-  int L_STDOUT;
+  for ( ep = 1; ep <= NEP ; ep++ ) {
 
-  double r8, XN8, XNUPD8;
+    Trest  = (float)GENLC.epoch8_rest[ep] ;
+    MJD    = GENLC.MJD[ep];
+    MJDDIF = MJD - MJD_last ;
 
-  char fnam[] = "init_CIDRAN";
+    // require valid epoch to continue
 
-  // ------------ BEGIN ------------
+    if ( GENLC.USE_EPOCH[ep] == 0 ) { continue ; }
+    
+    if ( Trest < INPUTS.CUTWIN_TRESTMIN[0] ) { continue ; }
+    if ( Trest > INPUTS.CUTWIN_TRESTMAX[1] ) { continue ; }
 
-  fflush(stdout);
-  if ( WRFLAG_CIDRAN  <= 0 ) { return ; }
+    ifilt_obs = GENLC.IFILT_OBS[ep] ;
+    sprintf(cfilt, "%c", FILTERSTRING[ifilt_obs] );
 
-  CIDMAX     = INPUTS.CIDRAN_MAX ; // -> local var      
-  CIDMIN     = INPUTS.CIDRAN_MIN ; 
-  NSTORE_ALL = INPUTS.CIDOFF + INPUTS.NGEN_LC + INPUTS.NGENTOT_LC ;
-  NSTORE     = INPUTS.NGEN_LC + INPUTS.NGENTOT_LC ; // for this sim-job
+    // keep track of the true/generated SNR
+    trueSNR     = GENLC.trueSNR[ep] ;
+    if ( trueSNR > GENLC.SNRMAX_TRUE[ifilt_obs] ) {
+      GENLC.SNRMAX_TRUE[ifilt_obs] = trueSNR ;
+    }
 
-  sprintf(BANNER,"init_CIDRAN: initialize %d RANDOM CIDs (CIDOFF=%d)",
-	  NSTORE_ALL, INPUTS.CIDOFF );
+    if ( LDMP ) {
+      printf(" xxx ep=%d   MJD(%s)= %f   Trest=%f  \n", 
+	     ep, cfilt, MJD, Trest );   
+      fflush(stdout); 
+    }
 
-  print_banner( BANNER );
-  printf("  ");
+    // apply rest-frame lambda cut to all epochs 
+    // used in TREST & SNRMAX cuts
+    if ( lamrest[ifilt_obs] < INPUTS.EPCUTWIN_LAMREST[0] ) continue ;
+    if ( lamrest[ifilt_obs] > INPUTS.EPCUTWIN_LAMREST[1] ) continue ;
 
-  // --------------------------------------
-  // error checking on bounds.
+    // apply SNRMIN_EP cut to all epochs
+    flux    = GENLC.flux[ep] ;
+    fluxerr = GENLC.flux_errstat[ep] ;
+    SNR     = flux / fluxerr ;
 
-  if ( CIDMAX > MXCID_SIM ) {
-    sprintf(c1err, "CIDRAN_MAX=%d exceeds limit of MXCID_SIM=%d",
-	    CIDMAX, MXCID_SIM );
-    sprintf(c2err, "Reduce CIDRAN_MAX to be <= %d", MXCID_SIM );
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
-  }
+    if ( SNR < INPUTS.EPCUTWIN_SNRMIN[0] ) continue ;
 
-  if ( NSTORE_ALL >= CIDMAX ) {
-    sprintf(c1err,"NSTORE_ALL=%d exceeds bound of CIDRAN_MAX = %d", 
-	    NSTORE_ALL, CIDMAX );
-    sprintf(c2err,"NSTORE_ALL= %d(CIDOFF) + %d(NGEN_LC) + %d(NGENTOT_LC)",
-	    INPUTS.CIDOFF, INPUTS.NGEN_LC, INPUTS.NGENTOT_LC );
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
-  }
+    NTLIST++;
+    TLIST[NTLIST] = Trest; // used later for sorting
 
-  exec_cidmask(0,CIDMAX); // allocate bit-mask memory to store all CIDs
+    if ( Trest < GENLC.TRESTMIN ) { GENLC.TRESTMIN = Trest ; }
+    if ( Trest > GENLC.TRESTMAX ) { GENLC.TRESTMAX = Trest ; }
 
-  // allocate memory for big CIDRAN_LIST and print mem usage
-  // Beware that allocation could be as much as 400 MB,
-  // more than the static size of snlc_sim.exe.
-  float XMEM = (float)(NSTORE+2) * (4.0 / 1.0E6) ;
-  printf("\t CIDRAN_MIN/MAX = %d/%d   CIDOFF=%d   NSTORE_JOB=%d\n", 
-	 CIDMIN, CIDMAX, INPUTS.CIDOFF, NSTORE );
-  printf("\t CIDRAN_LIST memory allocation: %6.3f MB \n", XMEM);
-  fflush(stdout);
+    if ( Trest >= INPUTS.CUTWIN_TRESTMIN[0] &&
+	 Trest <= INPUTS.CUTWIN_TRESTMIN[1] )
+      { GENLC.CUTBIT_MASK |= (1 << CUTBIT_TRESTMIN) ; }
 
-  INPUTS.CIDRAN_LIST = (int*)malloc( (NSTORE+2)*sizeof(int) );
+    if ( Trest >= INPUTS.CUTWIN_TRESTMAX[0] &&
+	 Trest <= INPUTS.CUTWIN_TRESTMAX[1] )
+      { GENLC.CUTBIT_MASK  |= (1 << CUTBIT_TRESTMAX) ; }
 
-  // start main loop
+    // check epochs above special SNR cut (not the global EPCUTWIN_SNRMIN)
+    if ( SNR >= INPUTS.CUTWIN_NEPOCH[1] ) { GENLC.NOBS_SNR++; }
 
-  if ( NSTORE_ALL < 200000 ) 
-    { XNUPD8 = 1.0E4; }     // screen update
-  else if ( NSTORE_ALL < 2000000 )   // 2 million
-    { XNUPD8 = 1.0E5 ; }
-  else if ( NSTORE_ALL < 20000000 )  // 20 million
-    { XNUPD8 = 1.0E6 ; }
-  else
-    { XNUPD8 = 5.0E6 ; }
+    // evaluate SNRMAX for each Trest window & filter
 
-  // set abort to 5% of NSTORE (Apr 10 1017)
-  NPICKRAN_ABORT = (NSTORE_ALL/20);
-  if ( NPICKRAN_ABORT < 100 ) { NPICKRAN_ABORT = 100; }
+    for ( icut=0; icut <= INPUTS.NCUTWIN_SNRMAX; icut++ ) {
 
-  // - - - - - - - - - - - - - - - - - - 
+      LTMP = ( Trest >= INPUTS.CUTWIN_SNRMAX_TREST[icut][0])
+	&&   ( Trest <= INPUTS.CUTWIN_SNRMAX_TREST[icut][1]) ;
 
-  for( i = 0; i <= NSTORE_ALL ; i++ ) {
+      LSNR = SNR  >  SNRMAX_FILT[icut][ifilt_obs] ;
 
-    // LDMP = ( fmod( (double)i, 4200000.0 ) == 0 && i>130000000 ) ;
+      if (  LSNR   && LTMP ) {
+	SNRMAX_FILT[icut][ifilt_obs] = SNR ; 
+	if ( icut == 0 ) {
+	  GAIN = SIMLIB_OBS_GEN.CCDGAIN[ep] ;
+	  GENLC.FLUXADU_at_SNRMAX[ifilt_obs] = flux ; 
+	  GENLC.FLUXpe_at_SNRMAX[ifilt_obs]  = flux * GAIN ;
+	}
+      }
+    } // icut
 
-    NPICKRAN = 0 ;
-    
-  PICKRAN:
-    NPICKRAN++ ;
+    // count NOBS with at least MJDDIF time separation
+    if ( MJDDIF >= INPUTS.CUTWIN_MJDDIF[0] ) 
+      { GENLC.NOBS_MJDDIF++ ; }
 
-    if ( NPICKRAN >= NPICKRAN_ABORT ) {
-      sprintf(c1err,"Could not find unused random CID after %d tries.",
-	      NPICKRAN);
-      sprintf(c2err,"Something is wrong at istore=%d of %d ", 
-	      i, NSTORE_ALL) ;
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    // count time above SNRMIN
+    if ( SNR > INPUTS.CUTWIN_EPOCHS_SNRMIN &&
+	 strstr(INPUTS.CUTWIN_EPOCHS_FILTERS,cfilt)!=NULL  ) {
+      if ( MJD_SNRMIN_FIRST < 0.01 ) { MJD_SNRMIN_FIRST = MJD; }
+      MJD_SNRMIN_LAST = MJD ;
     }
 
-    // use unix 'random' instead of snana 'rangen()'.
-    // because rangen() uses a finite list of randoms.
-    r8 = unix_random();   
-    NCALL_random++ ;
-    CIDRAN = CIDMIN + (int)( r8 * (double)(CIDMAX-CIDMIN) ) ;
+    MJD_last = MJD;
 
-    if ( CIDRAN >= CIDMAX  )       { goto PICKRAN ; }
-    if ( CIDRAN <= CIDMIN  )       { goto PICKRAN ; }
+  } // end of ep loop
 
-    // Find closest unused CID to CIDRAN
-    USED=1; i2 = 0 ; CIDADD = -9 ;
-    while ( USED ) {
+  // - - - - - - - - - - - - - - - - - - - - - - - - - -
 
-      // loop over +- 1 to try both directions from CIDRAN
-      NTRY = 0 ;
-      for(j=-1; j <= +1; j+=2 ) {
-	CIDTMP = CIDRAN + (j*i2) ;
-	if ( CIDTMP < CIDMAX  &&  CIDTMP > CIDMIN ) {
-	  NTRY++ ;
-	  if ( exec_cidmask(2,CIDTMP)==0 && CIDADD<0 ) { CIDADD = CIDTMP; } 
-	}
-      }
+  if ( GENLC.NOBS_SNR >= INPUTS.CUTWIN_NEPOCH[0] ) 
+    { GENLC.CUTBIT_MASK |= (1<<CUTBIT_NOBS_SNR) ; }
 
-      if ( NTRY == 0 ) {
-	
-	for(j=1; j <= CIDMAX; j++ ) {
-	  if ( j < 100 || (CIDMAX-j)<100 ) {
-	    printf("  xxx CID= %3d --> cidmask=%d \n",
-		   j, exec_cidmask(2,j) );
-	  }
-	}
-	printf(" xxx global MXCIDMASK = %d   NCIDMASK_LIST=%d\n", 
-	       MXCIDMASK, NCIDMASK_LIST );
-	printf(" xxx global CIDMASK_LIST = %d, %d, %d \n",
-	       CIDMASK_LIST[0], CIDMASK_LIST[1], CIDMASK_LIST[2] ) ;
+  if ( GENLC.NOBS_MJDDIF >= INPUTS.CUTWIN_NOBSDIF[0] ) 
+    { GENLC.CUTBIT_MASK |= (1<<CUTBIT_NOBS_MJDDIF) ; }
 
-	sprintf(c1err,"Unable to try CIDTMP = %d or %d  (CIDRAN=%d)",
-		CIDRAN-i2, CIDRAN+i2, CIDRAN );
-	sprintf(c2err,"CIDMAX=%d  NPICKRAN=%d  i=%d of %d  CID=%d", 
-		CIDMAX, NPICKRAN, i, NSTORE_ALL, GENLC.CID );
-	errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
-      }
+  GENLC.TIME_ABOVE_SNRMIN = (float)(MJD_SNRMIN_LAST - MJD_SNRMIN_FIRST);
+  if ( GENLC.TIME_ABOVE_SNRMIN < INPUTS.CUTWIN_EPOCHS_TRANGE[1] ) 
+    { GENLC.CUTBIT_MASK |= (1<<CUTBIT_TIME_ABOVE) ; }
 
-      i2++ ;
-      if ( CIDADD > 0 ) {
-	exec_cidmask(1,CIDADD); // set "USED" bit
-	if ( i >= INPUTS.CIDOFF ) 
-	  { INPUTS.CIDRAN_LIST[i-INPUTS.CIDOFF] = CIDADD ; }
-	USED = 0 ;
-      }
 
-    } // end USED block
+  // now sort SNRMAX for each filter and store in GENLC.SNRMAX_SORTED
+  // First get SNRMAX-list sorted by filter.
+  // These are computed just for the SIMGEN_DUMP option,
+  // and are NOT used for any of the CUTWIN tests.
 
-    // check for screen update 
-    XN8    = (double)i ;
-    L_STDOUT = ( fmod(XN8,XNUPD8) == 0 && i > 0 );
-    if ( L_STDOUT ) {
-      if ( XNUPD8 < 0.999E6 )  {  printf("%6d ", i);         }
-      else          	       {  printf("%dM ", i/1000000); }
-      fflush(stdout);
-    }
+  icut = 0 ;
+  NTMP = GENLC.NFILTDEF_OBS;
+  for ( ifilt=0; ifilt < NTMP ; ifilt++ ) {
+    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
+    sprintf(cfilt, "%c", FILTERSTRING[ifilt_obs] );
+
+    SNRMAX_TMP[ifilt+1]          = SNRMAX_FILT[icut][ifilt_obs] ;
+    GENLC.SNRMAX_FILT[ifilt_obs] = SNRMAX_FILT[icut][ifilt_obs] ;
 
     if ( LDMP ) {
-      printf("\n xxx i=%d  i2=%d  CIDRAN=%d CIDADD=%d \n",
-	     i, i2, CIDRAN, CIDADD);
+      printf(" xxx CID=%d  SNRMAX[%s] = %6.2f \n", 
+	     GENLC.CID, cfilt, SNRMAX_FILT[icut][ifilt_obs] );
+      fflush(stdout);
     }
+  }
 
-    //    printf(" xxx CIDRAN[%6.6d] = %6d \n", i, CIDRAN ) ;
 
-  } // end i-loop
+  ORDER_SORT = -1; // decreasing order
+  sortFloat( NTMP, &SNRMAX_TMP[1], ORDER_SORT, &INDEX_SORT[1] );
 
-  printf("\n\t Done allocating %d random CIDs: %d for current sim-job \n", 
-	 NSTORE_ALL, NSTORE); fflush(stdout);
-  printf("\t Called random() function %d times.\n", NCALL_random );
+  for ( ifilt = 1; ifilt <= NTMP ; ifilt++ ) {
+    isort = INDEX_SORT[ifilt] + 1 ; // fortran-line index
+    SNR   = SNRMAX_TMP[isort] ;
+    GENLC.SNRMAX_SORTED[ifilt] = SNR ;
+  }
 
-  // Aug 2017: re-init randoms with new SEED that is different
-  //           for each sim_SNmix job
-  int NEWSEED = INPUTS.ISEED + INPUTS.CIDOFF ;
-  srandom(NEWSEED);
 
-  return ;
+  // -------------
+  // Check if SNRMAX passes cut in each passband for each test
+  // Set default LSNR=TRUE; then set false if any SNRMAX cut fails. 
 
-} // end of init_CIDRAN
+    LSNR = 1;
 
+    for ( icut=1; icut <= INPUTS.NCUTWIN_SNRMAX; icut++ ) {
 
+      // get filter-range to test for this cut
+      NFCUT = PARSE_FILTLIST( INPUTS.CUTWIN_SNRMAX_FILTERS[icut], 
+			      IFILTOBS_LIST ); // <== returned
 
-// **************************
-void sort_CIDRAN(void) {
+      NTMP = 0;
+      for ( i=0; i < NFCUT; i++ ) {
 
-  // Created Nov 30, 2011 by R.Kessler
-  // sort random CIDs so that they will be generated in 
-  // monotonically increasing order. This is needed to simplify
-  // the merging of [FITS] samples with random CIDs.
-  // Make sure to order only the randoms after CIDOFF,
-  // INPUTS.CIDRAN_LIST[CIDOFF+1 ...]
-  //
-  // Jun 9 2013: do NOT sort for NON1a, otherwise the NON1A CIDs
-  //             are ordered.
-  //
-  // ---------------- BEGIN --------------
+	ifilt_obs = IFILTOBS_LIST[i] ;
 
-  int
-    NCID, CIDOFF
-    ,ORDER_SORT   
-    ,*INDEX_SORT
-    ,*CIDRAN_TMPLIST
-    ,isort, i
-    ;
+	// abort if ifilt_obs is undefined
+	ifilt = GENLC.IFILTINVMAP_OBS[ifilt_obs]; 
+	if ( ifilt < 0 ) {
+	  sprintf(c1err,"Invalid filter '%c' in", FILTERSTRING[ifilt_obs]);
+	  sprintf(c2err,"CUTWIN_SNRMAX: %.1f  %s   etc ...",
+		  INPUTS.CUTWIN_SNRMAX[icut][0],
+		  INPUTS.CUTWIN_SNRMAX_FILTERS[icut] );
+	  errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
+	}
 
-  if ( INDEX_GENMODEL == MODEL_NON1ASED  ) { return ; }
-  if ( INDEX_GENMODEL == MODEL_NON1AGRID ) { return ; } // Apr 3 2016 
+	SNR = SNRMAX_FILT[icut][ifilt_obs] ;
+	if ( SNR > INPUTS.CUTWIN_SNRMAX[icut][0] )  { NTMP++ ; }
 
-  CIDOFF = INPUTS.CIDOFF ;
-  NCID   = INPUTS.NGEN_LC + INPUTS.NGENTOT_LC ;
+      } // end of ifilt_obs loop
 
-  // allocate temp array to store sorted indices
-  CIDRAN_TMPLIST = (int*)malloc( (NCID+1) * sizeof(int));
-  INDEX_SORT     = (int*)malloc( (NCID+1) * sizeof(int));
 
-  // transfer random CIDs to temporary list
-  for ( i=1; i <= NCID; i++ ) 
-    { CIDRAN_TMPLIST[i] = INPUTS.CIDRAN_LIST[i] ;  }
+      if ( NTMP < INPUTS.CUTWIN_SNRMAX_NFILT[icut] ) { LSNR = 0 ; }
 
-  ORDER_SORT = +1 ; // increasing order
-  sortInt(NCID, &CIDRAN_TMPLIST[1], ORDER_SORT, &INDEX_SORT[1] );
 
+    } // end of icut loop
 
-  //  re-create CIDRAN_LIST with sorted CIDs 
-  for ( i=1; i <= NCID; i++ ) {
-    isort = INDEX_SORT[i] + 1 ; // fortran-like index
-    INPUTS.CIDRAN_LIST[i] = CIDRAN_TMPLIST[isort] ;
-  }
 
-  free(CIDRAN_TMPLIST);
-  free(INDEX_SORT);
+    if ( LSNR == 1 ) 
+      { GENLC.CUTBIT_MASK  |= (1<<CUTBIT_SNRMAX) ; }
 
-} // end of sort_CIDRAN
+    // ========================
+    // To get max gap, need sort TLIST
+    // INDEX_SORT is returned from CERNLIB function sortzv_
 
+    ORDER_SORT = +1; // increasing order
+    sortFloat(NTLIST, &TLIST[1], ORDER_SORT, &INDEX_SORT[1] );
 
+    Tlast = -999999. ;
 
-// *****************************************
-void checkpar_SIMSED(void) {
 
-  // Dec 20, 2009:
-  // make sanity checks, mainly that user sim-input
-  // SIMSED-parameters match those of the model.
-  // Also make sure that generation PEAK, RANGE and SIGMA 
-  // are specified for each SIMSED parameter.
-  //
-  // If no baggage params are specified, then add them all to list.
-  // If SIMGEN_DUMP is used, add all SIMSED params to SIMGEN_DUMP list.
-  //
-  //
-  // Jun 15, 2013: for SIMSED model, do NOT check for MEAN and SIGMA
-  //
-  // July 28 2017:
-  //  For GRIDONLY and FLAT distribution, fix the range to be 
-  //  MIN-0.5*BIN to MAX+0.5*BIN so that each bin is equally
-  //  populated.
-  //
-  // Feb 19 2018:
-  //  Fix bug from last July. Use ipar_model instead of ipar_user
-  //  for SIMSED lookups.
-  //
+    for ( i=1; i<= NTLIST; i++ ) {
 
-  int  GENFLAG, ipar, ipar_model, ipar_user, ipar_tmp
-    ,IPAR_MODEL_USED[MXPAR_SIMSED]
-    ,NBPAR, NTMP, N, NPAR_MODEL, idump, ISGRIDONLY, ISFLAT
-    ;
+      isort = INDEX_SORT[i] + 1; // fortran-like index
+      Trest = TLIST[isort];
 
-  double  tmpdif, range_model[2], range_user[2], bin_user, SIGMA[2] ;
+      // valid TGAP requires both Trest & Tlast to be within usable 
+      // light curve defined by TRESTMIN & TRESTMAX cuts
 
-  char
-    fnam[] = "checkpar_SIMSED"
-    ,parname_model[40]  // defined in modes/SIMSED
-    ,parname_user[40]   // defined in sim-input file
-    ,*ptrDumpVar
-    ,*ptrSIMSEDVar
-    ;
+      if ( Trest < INPUTS.CUTWIN_TRESTMIN[0] ) goto SKIPGAP;
+      if ( Trest > INPUTS.CUTWIN_TRESTMAX[1] ) goto SKIPGAP;
+      if ( Tlast < INPUTS.CUTWIN_TRESTMIN[0] ) goto SKIPGAP;
+      if ( Tlast > INPUTS.CUTWIN_TRESTMAX[1] ) goto SKIPGAP;
 
-  // -------------- BEGIN ---------------
+      TGAP = Trest - Tlast; 
+      USE_TGAP = USE_T0GAP = 0;
 
-  // get total number of parameters in this SIMSED model
-  INPUTS.NPAR_SIMSED_MODEL = NPAR_SEDMODEL();
-  NPAR_MODEL               = INPUTS.NPAR_SIMSED_MODEL;
+      // use T0-gap only of it covers the lower range of TRESTMAX-window,
+      // or the upper range of the TRESTMIN-window.
 
-  for ( ipar_tmp = 0; ipar_tmp < INPUTS.NPAR_SIMSED_MODEL; ipar_tmp++ )
-    { IPAR_MODEL_USED[ipar_tmp] = 0; }
+      T0GAPOVP[0] = INPUTS.CUTWIN_TRESTMIN[1] ; // max TRESTMIN window 
+      T0GAPOVP[1] = INPUTS.CUTWIN_TRESTMAX[0] ; // min TRESTMAX window
+      if ( Trest >= T0GAPOVP[0] && Trest <= T0GAPOVP[1] ) USE_T0GAP = 1 ;
+      if ( Tlast >= T0GAPOVP[0] && Tlast <= T0GAPOVP[1] ) USE_T0GAP = 1 ;
+      if ( Trest >= T0GAPOVP[1] && Tlast <= T0GAPOVP[0] ) USE_T0GAP = 1 ;
 
-  for ( ipar_user = 0; ipar_user < INPUTS.NPAR_SIMSED; ipar_user++ ) {
+      // use T-gap anywhere along light curve
+      USE_TGAP = 1 ;
 
-    sprintf(parname_user,"%s", INPUTS.PARNAME_SIMSED[ipar_user] );
-    GENFLAG  = INPUTS.GENFLAG_SIMSED[ipar_user];   
-    SIGMA[0] = INPUTS.GENGAUSS_SIMSED[ipar_user].SIGMA[0] ;
-    SIGMA[1] = INPUTS.GENGAUSS_SIMSED[ipar_user].SIGMA[1] ;
+      if ( USE_T0GAP == 1 && TGAP > GENLC.T0GAPMAX )  
+	GENLC.T0GAPMAX = TGAP ;
 
-    // find which model parameter matches user parameter
-    ipar_model = -9 ;
-    for ( ipar_tmp = 0; ipar_tmp < NPAR_MODEL; ipar_tmp++ ) {
-      fetch_parInfo_SEDMODEL(ipar_tmp, parname_model, &NBPAR, range_model );
+      if ( USE_TGAP == 1 && TGAP > GENLC.TGAPMAX )  
+	GENLC.TGAPMAX = TGAP ;
 
-      if ( strcmp(parname_user,parname_model) == 0 ) {
-	ipar_model = ipar_tmp ;
-	IPAR_MODEL_USED[ipar_model] = 1;
+      /*
+      if ( LDMP > 0 ) {
+	printf(" xxx sorted Trest(%2d) = %7.3f  TGAP=%6.3f ", 
+	       i, Trest, TGAP );
+	printf(" USE_T0GAP=%d USE_TGAP=%d\n", USE_T0GAP, USE_TGAP );
       }
-    }
+      */
 
-    if ( ipar_model < 0 ) {
-      sprintf(c1err,"invalid user SIMSED param: '%s'", parname_user);
-      sprintf(c2err,"Check sim-input file and SED.INFO file." );
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    SKIPGAP:
+      Tlast = Trest;
+    } // end i-loop over TLIST
+
+
+
+
+    if ( LDMP > 0 ) {
+      printf(" xxx CID=%d : TGAPMAX= %6.2f   T0GAPMAX=%6.2f\n", 
+	     GENLC.CID, GENLC.TGAPMAX, GENLC.T0GAPMAX );
+      printf(" xxx CID=%d : TRESTMIN=%f TRESTMAX=%f \n",
+	     GENLC.CID, GENLC.TRESTMIN, GENLC.TRESTMAX );
+      fflush(stdout);
     }
 
+    // set TGAP cutbits
+
+    if ( GENLC.TGAPMAX <= INPUTS.CUTWIN_TGAPMAX[1] && 
+	 GENLC.TGAPMAX >= INPUTS.CUTWIN_TGAPMAX[0]  ) 
+      { GENLC.CUTBIT_MASK  |= (1<<CUTBIT_TGAPMAX) ; }
 
-    GENLC.SIMSED_IPARMAP[ipar_user] = ipar_model ; // Nov 18, 2011
+    if ( GENLC.T0GAPMAX <= INPUTS.CUTWIN_T0GAPMAX[1] && 
+	 GENLC.T0GAPMAX >= INPUTS.CUTWIN_T0GAPMAX[0]  ) 
+      { GENLC.CUTBIT_MASK  |= (1<<CUTBIT_T0GAPMAX) ; }
 
-    fetch_parInfo_SEDMODEL(ipar_model, parname_model, &NBPAR, range_model );
+    // Set MWEBV cutbit
 
-    // July 28 2017
-    // if GRIDONLY option and flat distribution, set range to
-    // min-0.5*bin to max+0.5*bin so that each bin is sample
-    // with equal prob
-    ISGRIDONLY = (GENFLAG & OPTMASK_SIMSED_GRIDONLY);
-    ISFLAT     = (SIGMA[0] > 1.0E7 );
-    if ( ISGRIDONLY && ISFLAT ) {
+    if ( GENLC.MWEBV <= INPUTS.CUTWIN_MWEBV[1] && 
+	 GENLC.MWEBV >= INPUTS.CUTWIN_MWEBV[0]  ) 
+      { GENLC.CUTBIT_MASK  |= (1<<CUTBIT_MWEBV) ; }
 
-      bin_user      = SEDMODEL.PARVAL_BIN[ipar_model] ;
-      range_user[0] = SEDMODEL.PARVAL_MIN[ipar_model] - 0.5*bin_user ;
-      range_user[1] = SEDMODEL.PARVAL_MAX[ipar_model] + 0.5*bin_user;
+    // Set PEAKMAG cutbit if any filter satisfies (Sep 2012)
+    int NPASS_PEAKMAG=0, NFAIL_PEAKMAG_ALL=0;
+    for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {      
+      ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];    
+      if ( gen_cutwin_PEAKMAG(1,ifilt_obs) == SUCCESS ) // OR logic
+	{ NPASS_PEAKMAG++; } 
+      if ( gen_cutwin_PEAKMAG(2,ifilt_obs) != SUCCESS )  // AND logic
+	{ NFAIL_PEAKMAG_ALL++; } 
 
-      INPUTS.GENGAUSS_SIMSED[ipar_user].RANGE[0] = range_user[0] ;
-      INPUTS.GENGAUSS_SIMSED[ipar_user].RANGE[1] = range_user[1] ;
     }
+    if ( NPASS_PEAKMAG > 0 && NFAIL_PEAKMAG_ALL == 0 ) 
+      {  GENLC.CUTBIT_MASK  |= (1<<CUTBIT_PEAKMAG) ; }
 
-    // skip the tests below for baggage or GRIDONLY parameters
-    if ( GENFLAG != OPTMASK_SIMSED_PARAM    ) { continue ; }
-
-    // continue here only for continuous distribution
-    range_user[0] = INPUTS.GENGAUSS_SIMSED[ipar_user].RANGE[0] ;
-    range_user[1] = INPUTS.GENGAUSS_SIMSED[ipar_user].RANGE[1] ;
+    // May 2018: check SATURATION  cuts 
+    int MINOBS, MAXOBS, NOBS_TOT, NOBS, IPASS=1 ;
+    for(icut=0; icut < INPUTS.NCUTWIN_SATURATE; icut++ ) {
+      MINOBS = INPUTS.CUTWIN_SATURATE_NOBS[icut][0] ;
+      MAXOBS = INPUTS.CUTWIN_SATURATE_NOBS[icut][1] ;
+      NFCUT = PARSE_FILTLIST( INPUTS.CUTWIN_SATURATE_FILTERS[icut], 
+			      IFILTOBS_LIST ); // <== returned   
+      for ( i=0; i < NFCUT; i++ ) {
+	ifilt_obs = IFILTOBS_LIST[i] ;
+	NOBS   = GENLC.NOBS_SATURATE_FILTER[1][ifilt_obs];
+	if ( NOBS < MINOBS || NOBS > MAXOBS ) { IPASS=0; }
+      }
+    } // end icut loop
 
-    // extend range by epsilon to allow boundary values.
-    // Note this doesn't help for delta-function range.
-    tmpdif = range_model[1] - range_model[0];
-    range_model[0] -= (tmpdif * 1.E-8) ;
-    range_model[1] += (tmpdif * 1.E-8) ;
 
-    sprintf(c2err,"Check sim-input keyword GENRANGE_%s  (ipar_user=%d)", 
-	    parname_model, ipar_user );
+    // repeat for NOBS_NOSATURATE
+    for(icut=0; icut < INPUTS.NCUTWIN_NOSATURATE; icut++ ) {
+      MINOBS = INPUTS.CUTWIN_NOSATURATE_NOBS[icut][0] ;
+      MAXOBS = INPUTS.CUTWIN_NOSATURATE_NOBS[icut][1] ;
+      NFCUT = PARSE_FILTLIST( INPUTS.CUTWIN_NOSATURATE_FILTERS[icut], 
+			      IFILTOBS_LIST ); // <== returned      
+      for ( i=0; i < NFCUT; i++ ) {
+	ifilt_obs = IFILTOBS_LIST[i] ;
+	NOBS_TOT  = GENLC.NOBS_FILTER[ifilt_obs] ;
 
-    // make sure that user-range does not exceed defined range of model.
-    if ( range_user[0] < range_model[0] ) {
-      sprintf(c1err,"User %s-min = %6.3f < model min-range=%6.3f", 
-	      parname_model, range_user[0], range_model[0] );
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
-    }
+	// require enough NOBS_TOT in this band in case
+	// the model is undefined and we have NOBS_TOT=0.
+	if ( NOBS_TOT > MINOBS ) {
+	  NOBS      = GENLC.NOBS_SATURATE_FILTER[0][ifilt_obs];
+	  if ( NOBS < MINOBS || NOBS > MAXOBS ) { IPASS=0; }
+	}
+	  /* 
+	printf(" xxx ifilt_obs=%d  NOBS=%d (%d-%d)  IPASS=%d\n", 
+	ifilt_obs, NOBS, MINOBS, MAXOBS, IPASS ); */
+      }
 
-    if ( range_user[1] > range_model[1] ) {
-      sprintf(c1err,"User %s-max = %6.3f > model max-range=%6.3f", 
-	      parname_model, range_user[1], range_model[1] );
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
-    }
+    } // end icut loop
 
+    //    printf(" xxx IPASS(NOSATURATE) = %d \n", IPASS);
+    if ( IPASS ) { GENLC.CUTBIT_MASK  |= (1<<CUTBIT_SATURATE) ; }
 
-    // make sure that all information is specified.
-    sprintf(c2err,"Check sim-input file.");
+    // -------------------------------------------
 
-    if ( INDEX_GENMODEL != MODEL_SIMSED ) {
-      if ( INPUTS.GENGAUSS_SIMSED[ipar_user].PEAK == -999. ) {
-	sprintf(c1err,"GENMEAN_%s not specified", parname_model );
-	errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
-      }
+    if ( LDMP  ) {
+      printf(" xxxxx CID=%d  CUTBIT_MASK = %d  (requires %d) \n",
+	     GENLC.CID, GENLC.CUTBIT_MASK, ALLBIT_CUTMASK );
+      for ( ifilt_obs  = IFILTOBS_LIST[0]; 
+	    ifilt_obs <= IFILTOBS_LIST[1]; ifilt_obs++ ) {
+	SNR = SNRMAX_FILT[1][ifilt_obs] ;
+	printf(" xxxx CID = %d, ifilt_obs = %d, SNRMAX(cut1) = %f \n", 
+	       GENLC.CID, ifilt_obs, SNR);
+	SNR = SNRMAX_FILT[2][ifilt_obs] ;
+	printf(" xxxx CID = %d, ifilt_obs = %d, SNRMAX(cut2) = %f \n", 
+	       GENLC.CID, ifilt_obs, SNR);
+	fflush(stdout);
+      } // end of ifilt_obs loop
     }
 
-    if ( INPUTS.GENGAUSS_SIMSED[ipar_user].RANGE[0] == -999. ) {
-      sprintf(c1err,"GENRANGE_%s not specified", parname_model );
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
-    }
-    if ( INPUTS.GENGAUSS_SIMSED[ipar_user].RANGE[1] == -999. ) {
-      sprintf(c1err,"GENRANGE_%s not specified", parname_model );
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
-    }
+    // free memory
+    free(TLIST);  free(INDEX_SORT);
 
-    if ( INDEX_GENMODEL != MODEL_SIMSED ) {
-      if ( INPUTS.GENGAUSS_SIMSED[ipar_user].SIGMA[0] == -999. ) {
-	sprintf(c1err,"GENSIGMA_%s not specified", parname_model );
-	errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
-      }
-      if ( INPUTS.GENGAUSS_SIMSED[ipar_user].SIGMA[1] == -999. ) {
-	sprintf(c1err,"GENSIGMA_%s not specified", parname_model );
-	errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
-      }
+    if ( LDMP ) {
+      printf(" xxx END OF gen_cutwin() dump for CID=%d \n\n", GENLC.CID );
     }
 
-  } // end ipar loop
-
+    // fail event if SNRMAX-fudge is requested, but exposure time is normal
+    // Next time around with adjusted EXPOSURE_TIME, the event of processed
+    if ( GENLC.FUDGE_SNRMAX_FLAG == 1 ) 
+      { return ERROR; }
 
-  // Set un-used MODEL parameters as baggage params.
+    if ( INPUTS.APPLY_CUTWIN_OPT == 0 )   
+      { return SUCCESS ; }
 
-  NTMP = INPUTS.NPAR_SIMSED_param;
-  if ( NTMP == 0 ) {
 
-    for ( ipar_model = 0; ipar_model < NPAR_MODEL; ipar_model++ ) {
-      if ( IPAR_MODEL_USED[ipar_model] == 0 ) {     
+    // if we get here, apply cuts.
 
-	N = INPUTS.NPAR_SIMSED ;
-	INPUTS.GENFLAG_SIMSED[N] = OPTMASK_SIMSED_param ;
-	sprintf(INPUTS.KEYWORD_SIMSED[N],"SIMSED_param");
-	fetch_parInfo_SEDMODEL(ipar_model, INPUTS.PARNAME_SIMSED[N],
-			  &NBPAR, range_model );
+    if ( GENLC.CUTBIT_MASK == ALLBIT_CUTMASK ) 
+      {  return SUCCESS ;  }
+    else
+      { return ERROR ; }
 
-	GENLC.SIMSED_IPARMAP[N] = ipar_model ; // Nov 18, 2011
 
-	printf("\t Load baggage parameter '%s' \n",
-	       INPUTS.PARNAME_SIMSED[N] );
+} // end of gen_cutwin
 
-	INPUTS.NPAR_SIMSED++ ;
-	INPUTS.NPAR_SIMSED_param++ ;
-	if ( INPUTS.NPAR_SIMSED >= MXPAR_SIMSED ) {
-	  sprintf(c1err,"NPAR_SIMSED=%d exceeds MXPAR_SIMSED=%d",
-		  INPUTS.NPAR_SIMSED, MXPAR_SIMSED ) ;
-	  sprintf(c2err,"Need to increase MXPAR_SIMSED");
-	  errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
-	}
 
-      }
-    }
+// ******************************************
+int gen_cutwin_PEAKMAG(int OPT, int ifilt_obs) {
 
-  } // NTMP=0
+  // Created Sep 2015
+  // Apply user-specified PEAKMAG cut(s);
+  // return SUCCESS or ERROR.
+  //
+  // OPT=1 --> test with CUTWIN_PEAKMAG
+  // OPT=2 --> test with CUTWIN_PEAKMAG_ALL
+  //
+  // First apply global CUTWIN_PEAKMAG cut.
+  // Then check field-dependent CUTWIN_PEAKMAG_BYFIELD cuts
+  // to apply stricter cut.
+  //
+  // Aug 31 2018: for LCLIB, apply same cut to template mag.
 
+  int PASS = 1;
+  float MLO, MHI ;
+  double MCOR_TRUE_MW  = GENLC.MAGCOR_MWEBV_TRUE[ifilt_obs]; 
+  float  peakmag       = (float)GENLC.peakmag8_obs[ifilt_obs] ;
+  float  mag_T         = (float)GENLC.genmag8_obs_template[ifilt_obs];
 
-  // Add the SIMSED parameters to the SIMGEN_DUMP list
-  // if the list is specified.
+// ------------- BEGIN ---------------
 
-  NTMP = INPUTS.NVAR_SIMGEN_DUMP ;
-  if ( NTMP > 0  && INPUTS.WRFLAG_MODELPAR ) {
+  // correct MWCOR if option is set. Default MCOR is 0
+  peakmag -=  (float)MCOR_TRUE_MW ;
+  mag_T   -=  (float)MCOR_TRUE_MW ;
 
-    // first check that no SIMSED PARAM/param is specified ... 
-    // otherwise abort.
-    for ( idump=0; idump < INPUTS.NVAR_SIMGEN_DUMP; idump++ ) {
-      for ( ipar = 0; ipar < INPUTS.NPAR_SIMSED; ipar++ ) {
-	ptrDumpVar    = INPUTS.VARNAME_SIMGEN_DUMP[idump] ;
-	ptrSIMSEDVar  = INPUTS.PARNAME_SIMSED[ipar] ;
-	if ( strcmp(ptrDumpVar,ptrSIMSEDVar) == 0 ) {
-	  sprintf(c1err,"SIMSED Param '%s' cannot be in SIMGEN_DUMP list",
-		  ptrDumpVar);
-	  sprintf(c2err,"because SIMSED Params are added automatically.");
-	  errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
-	}
+  if ( OPT == 1 ) {
+    // OR logic; only 1 filter must pass cut
+     MLO     = INPUTS.CUTWIN_PEAKMAG[0] ; 
+     MHI     = INPUTS.CUTWIN_PEAKMAG[1] ; 
+  }
+  else {
+    // AND logic; all filters must pass cut
+     MLO     = INPUTS.CUTWIN_PEAKMAG_ALL[0] ; 
+     MHI     = INPUTS.CUTWIN_PEAKMAG_ALL[1] ; 
+  }
 
-      } // ipar
-    } // idump
+  if ( peakmag < MLO ) { PASS = 0 ; }
+  if ( peakmag > MHI ) { PASS = 0 ; }
 
-    // Now load all SIMSED params onto SIMGEN_DUMP list
-    for ( ipar = 0; ipar < INPUTS.NPAR_SIMSED; ipar++ ) {
-      idump = INPUTS.NVAR_SIMGEN_DUMP ;
-      ptrDumpVar    = INPUTS.VARNAME_SIMGEN_DUMP[idump] ;
-      ptrSIMSEDVar  = INPUTS.PARNAME_SIMSED[ipar] ;
-      sprintf(ptrDumpVar,"%s", ptrSIMSEDVar );     
-      INPUTS.NVAR_SIMGEN_DUMP++ ;
-    }    
+  // for LCLIB model, check template mags too
+  if ( INDEX_GENMODEL == MODEL_LCLIB ) {
+    if ( mag_T < MLO ) { PASS = 0 ; }
+    if ( mag_T > MHI ) { PASS = 0 ; }
   }
 
+  // skip FIELD-dependent cuts for AND logic
+  if ( OPT !=1 ) { goto DONE; }
 
-  // -----------------------------------
-  // For the "SIMSED_GRIDONLY: SEQUENTIAL" option, 
-  // set NGEN_LC equal to the number of SEDs so that 
-  // each SED is processed once.
-  if ( INPUTS.OPTMASK_SIMSED == OPTMASK_SIMSED_GRIDONLY ) {
-    N = NSED_SEDMODEL();
-    INPUTS.NGEN = N ;
-    INPUTS.NGENTOT_LC = N;
-    INPUTS.NGEN_LC    = 0;
+  // now check field-dependent PEAKMAG cut(s)
+  int  i, N;
+  char *field, *fieldList;
+  N      = INPUTS.NCUTWIN_PEAKMAG_BYFIELD;
+  field  = GENLC.FIELDNAME[0]; // get field from header/1st epoch
+
+  for(i=1; i<=N; i++ ) {
+    fieldList = INPUTS.CUTWIN_BYFIELDLIST[i];
+    if ( strstr(fieldList,field) != NULL ) {
+      if ( peakmag < INPUTS.CUTWIN_PEAKMAG_BYFIELD[i][0] ) { PASS = 0 ; }
+      if ( peakmag > INPUTS.CUTWIN_PEAKMAG_BYFIELD[i][1] ) { PASS = 0 ; }
 
-    set_screen_update(N);
-    /*
-    if ( INPUTS.NGEN_LC    > 0 ) { INPUTS.NGEN_LC    = N; }
-    if ( INPUTS.NGENTOT_LC > 0 ) { INPUTS.NGENTOT_LC = N; }
-    */
+      /*
+      printf(" xxx compare '%s' to '%s' (PASS=%d)\n", 
+      field, fieldList, PASS );  */
+    }
   }
 
+  // return appropriate function code
+ DONE:
 
-  //  debugexit("add baggage params");
-  
-} // end of checkpar_SIMSED
+  if( PASS ) 
+    { return SUCCESS; }
+  else
+    { return ERROR; }
 
 
-// **********************************
-int GENRANGE_CUT(void) {
+} // end  gen_cutwin_PEAKMAG
 
-  // Cut on user-specified GEN-ranges.
-  // returns 1 if generated quantities pass cuts; 0 otherwise
-  // Note that these cuts do not effect the rate calculation
+// ******************************************
+void  LOAD_SEARCHEFF_DATA(void) {
+
+  // Created Jan , 2014
+  // Load structures
+  //   - SEARCHEFF_DATA 
+  //   - SEARCHEFF_RANDOMS
+  // to be used by  SEARCHEFF_xxx functions to evaluate
+  // pipeline and SPEC efficiencies.
   //
-  // Aug 24 2015: if using HOSTLIB, require value ZTRUE.
-  //              Abort if too many hosts aren't found.
+  // Aug 24 2014: 
+  //   major fix, use SNR_CALC instead of measured SNR.
+  //   But for SDSS, keep using measured SNR so that spec-effic is OK.
   //
-  // Aug 22 2018: skip REDSHIFT cut for LCLIB model.
+  // Jun 23 2016: load HOSTMAG and HOSTSB
+  // Jan 03 2018: load NPE_SAT
+  // Jan 15 2018: load GENLC.FIELDNAME[0], not FIELDNAME[1]
+  // Jun 18 2018: load SNRMAX
 
-  int LTRACE=0;
-  int istat ;
-  char fnam[] = "GENRANGE_CUT" ;
+  int imjd, EPMIN, EPMAX, ep, NOBS;
+  double flux, flux_err, SNR_CALC, SNR_MEAS, SNR, oldRan, tmpRan ;
 
-  // ----------- BEGIN ------------
+  // --------------- BEGIN ----------------
 
-  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID  ) {
-    istat = 1 ; return istat ;
-  }
+  SEARCHEFF_DATA.CID        = GENLC.CID ;
+  SEARCHEFF_DATA.REDSHIFT   = GENLC.REDSHIFT_HELIO ;
+  SEARCHEFF_DATA.PEAKMJD    = GENLC.PEAKMJD ;
+  SEARCHEFF_DATA.DTPEAK_MIN = GENLC.DTPEAK_MIN ; // closest T-Tpeak
+  SEARCHEFF_DATA.SALT2mB    = GENLC.SALT2mB ;
+  SEARCHEFF_DATA.SNRMAX     = GENLC.SNRMAX_GLOBAL ;
 
-  istat = 0 ;
 
-  if(LTRACE) { printf(" xxx %s: 0 check RA=%f \n", fnam, GENLC.RA); }
-  if ( GENLC.RA < INPUTS.GENRANGE_RA[0] ) { return istat; }
-  if ( GENLC.RA > INPUTS.GENRANGE_RA[1] ) { return istat; }
+  sprintf(SEARCHEFF_DATA.FIELDNAME, "%s", GENLC.FIELDNAME[0] );
 
-  if(LTRACE) { printf(" xxx %s: 1 check RA=%f \n", fnam, GENLC.DEC); }
-  if ( GENLC.DEC < INPUTS.GENRANGE_DEC[0] )  { return istat; }
-  if ( GENLC.DEC > INPUTS.GENRANGE_DEC[1] )  { return istat; }
+  NOBS = 0 ;
 
-  if ( INDEX_GENMODEL != MODEL_LCLIB ) {
-    if(LTRACE) {printf(" xxx %s: 2 check zCMB=%f \n",fnam,GENLC.REDSHIFT_CMB);}
-    if ( GENLC.REDSHIFT_CMB < INPUTS.GENRANGE_REDSHIFT[0] ) { return istat; }
-    if ( GENLC.REDSHIFT_CMB > INPUTS.GENRANGE_REDSHIFT[1] ) { return istat; }
-  }
+  for ( imjd = 1; imjd <= GENLC.NEWMJD ; imjd++ ) {
 
-  if(LTRACE) { printf(" xxx %s: 3 check PEAKMJD=%f \n", fnam, GENLC.PEAKMJD); }
-  if ( GENLC.PEAKMJD < INPUTS.GENRANGE_PEAKMJD[0] )  { return istat; }
-  if ( GENLC.PEAKMJD > INPUTS.GENRANGE_PEAKMJD[1] )  { return istat; }
+    EPMIN = GENLC.EPOCH_RANGE_NEWMJD[imjd][0] ;
+    EPMAX = GENLC.EPOCH_RANGE_NEWMJD[imjd][1] ;
 
-  if ( INPUTS.HOSTLIB_USE && SNHOSTGAL.ZTRUE < 0.0 )  {  
-    // if number of missing host-gals exceeds NGEN, then abort
-    // to avoid infinite loop
-    NGEN_REJECT.HOSTLIB++ ;
-    int BIGRATIO = ( NGEN_REJECT.HOSTLIB > 2*NGENLC_WRITE );
-    if ( BIGRATIO && NGENLC_WRITE > 10 ) {
-      float x = (float)NGEN_REJECT.HOSTLIB / (float)NGENLC_WRITE ;
-      sprintf(c1err,"%d events rejected because HOST cannot be found:",
-	      NGEN_REJECT.HOSTLIB );
-      sprintf(c2err,"NREJECT/NGENLC_WRITE=%d/%d = %.1f --> "
-	      "need bigger HOSTLIB",
-	      NGEN_REJECT.HOSTLIB, NGENLC_WRITE, x );
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
-    }
-    return istat; 
-  }
+    for ( ep=EPMIN; ep <= EPMAX; ep++ ) {
 
+      if ( GENLC.ISPEAK[ep]     ) { continue ; } // Sep 24 2017
+      if ( GENLC.ISTEMPLATE[ep] ) { continue ; }
 
-  istat = 1 ;
-  return istat ;
- 
-} // end of GENRANGE_CUT
+      SNR_CALC = GENLC.SNR_CALC[ep] ; // Aug 24, 2014
 
+      flux      = GENLC.flux[ep] ;
+      flux_err  = GENLC.flux_errstat[ep] ;
+      SNR_MEAS  = -9.0 ;
+      if ( flux_err > 0.0 ) { SNR_MEAS = flux / flux_err ; }
+   
+      SNR = SNR_CALC ;
+      
+      // for SDSS, continue using wrong SNR based on measured flux
+      // so that the spec-efficiency function is still correct.
+      if ( strcmp(GENLC.SURVEY_NAME,"SDSS") == 0 ) { SNR = SNR_MEAS; }
 
-// **********************************
-int GENMAG_CUT(void) {
+      SEARCHEFF_DATA.IFILTOBS[NOBS]  = GENLC.IFILT_OBS[ep] ;     
+      SEARCHEFF_DATA.MJD[NOBS]       = GENLC.MJD[ep] ;
+      SEARCHEFF_DATA.MAG[NOBS]       = GENLC.genmag8_obs[ep] ; 
+      SEARCHEFF_DATA.SNR[NOBS]       = SNR ;
+      SEARCHEFF_DATA.NPE_SAT[NOBS]   = GENLC.npe_above_sat[ep];
 
-  // Created Mar 16 2016
-  // Cut on PEAKMAG here after generation but before
-  // the light curve is digitized.
-  // Returns 1 if passing cut
-  // Returns 0 if failing cut
+      oldRan = SEARCHEFF_RANDOMS.PIPELINE[NOBS] ;
+      if ( oldRan < -0.001 ) 
+	{ SEARCHEFF_RANDOMS.PIPELINE[NOBS] = FlatRan1(1);  }
 
-  int ifilt_obs, ifilt, PASS ;
-  double PEAKMAG;
-  //  char fnam[] = "GENMAG_CUT";
+      oldRan = SEARCHEFF_RANDOMS.PHOTPROB[NOBS] ;
+      if ( oldRan < -998.0 && INPUTS_SEARCHEFF.NMAP_PHOTPROB >0 )  { 
+	if ( INPUTS_SEARCHEFF.NREDUCED_CORR_PHOTPROB == 0 ) 
+	  { tmpRan = FlatRan1(1); } // flat randoms [0,1] for uncorrelated
+	else
+	  { tmpRan = GaussRan(1); } // need Gauss-randoms for correlation
+	SEARCHEFF_RANDOMS.PHOTPROB[NOBS] = tmpRan ;
+      }
+      
+      NOBS++ ;
+    }
+  }
+  SEARCHEFF_DATA.NOBS =  NOBS ;
 
-  // --------------- BEGIN ----------------
 
-  PASS = 0 ;
+  // load SPEC-EFF randoms and filter-dependent quantities
 
-  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
-    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];    
-    PEAKMAG = GENLC.peakmag8_obs[ifilt_obs] ;
-    if ( PEAKMAG < INPUTS.GENRANGE_PEAKMAG[0] ) { continue; }
-    if ( PEAKMAG > INPUTS.GENRANGE_PEAKMAG[1] ) { continue; }
-    PASS = 1;
-  }
+  int ifilt, ifilt_obs ;
 
-  /*
-  if ( PASS == 0 ) {
-    printf(" xxx fail PEAKMAG=%f for z=%f \n",
-	   PEAKMAG, GENLC.REDSHIFT_CMB );
+  for ( ifilt=0; ifilt <= MXFILTINDX; ifilt++ ) {
+
+    if ( SEARCHEFF_RANDOMS.SPEC[ifilt] < -0.01 ) 
+      { SEARCHEFF_RANDOMS.SPEC[ifilt]  = FlatRan1(1); }
+
+    if ( ifilt == MXFILTINDX ) { continue ; } // avoid array overwrite
+    SEARCHEFF_DATA.PEAKMAG[ifilt] = MAG_UNDEFINED ;
+    SEARCHEFF_DATA.HOSTMAG[ifilt] = MAG_UNDEFINED ;
+    SEARCHEFF_DATA.SBMAG[ifilt]   = MAG_UNDEFINED ;
+    
   }
-  */
 
-  return(PASS);
 
-} // end GENMAG_CUT
+  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
+      ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
+      /*
+      printf(" xxx ifilt_obs=%d: MAG[PEAK,HOST,SB] = %.3f, %.3f, %.3f \n",
+	     ifilt_obs, GENLC.peakmag8_obs[ifilt_obs],
+	     SNHOSTGAL.GALMAG[ifilt_obs][0], SNHOSTGAL.SB_MAG[ifilt_obs] );
+      */
+      SEARCHEFF_DATA.PEAKMAG[ifilt_obs] =  GENLC.peakmag8_obs[ifilt_obs] ;
+      SEARCHEFF_DATA.HOSTMAG[ifilt_obs] =  SNHOSTGAL.GALMAG[ifilt_obs][0] ;
+      SEARCHEFF_DATA.SBMAG[ifilt_obs] =    SNHOSTGAL.SB_MAG[ifilt_obs];
+  }  // ifilt
 
+  return ;
 
-// ***************************************
-int geneff_calc(void) {
+} // end of LOAD_SEARCHEFF_DATA
 
-  // Feb 9, 2008: compute generation efficiency & error.
-  //              Mainly useful for generating efficiency maps.
+// ******************************************
+void gen_spectype(void) {
+
+  // Created July 2011
+  // Major modif. Mar 2013
+  // Set GENLC.SNTYPE based on spec vs. phot typing.
   //
-  // Jul 17, 2009: return 0 for normal status; return 1 to STOP because
-  //               effic-error is below user-allowed limit
-  // 
-  // Dec 22 2015: modify STOPGEN logic to be more robust. 
-  //              Min allowed EFFERR -> EFFERR_STOPGEN * sqrt(1000/NGEN_LC)
+  // Jun 7, 2013: 
+  //  - for photoid, add OFFSET_TYPE_PHOT to SNTYPE.
+  //  - set GENLC.SNTYPE for CC as well as for Ia
   //
-  float XN1, XN0, EFF, EFF_ERR, SQERR ;
-  int ISTOP;
+  //
+  // Jun 2 2018: if IFLAG_SPEC_EFFZERO, then set PHOTID flag
 
-  char fnam[] = "geneff_calc" ;
+  int L_PHOTID, ispgen ;
+  char fnam[] = "gen_spectype" ;
 
-  // -------- BEGIN ------
+  // ---------- BEGIN --------------
 
-  ISTOP = 0;
+  // if SPECTYPE has not been specified, then
+  // leave GENLC.SNTYPE as-is => 100% spec-typing.
+  // However, for SPECTYPE_SEARCH_FLAG, then use search 
+  // eff for spec-typing.
 
-  XN1 = (float)NGENLC_WRITE ;
 
-  // normalization (XN0) include generated light curves that were
-  // rejected by the search & by CUTWIN-cuts, but EXCLUDEs those
-  // rejected by generation-ranges.
+  L_PHOTID =  ( INPUTS_SEARCHEFF.NMAP_SPEC > 0  &&
+		GENLC.SEARCHEFF_MASK  != 3  ) ;
 
-  XN0 = (float)(NGENLC_TOT - NGEN_REJECT.GENRANGE );
+  // un 2018: if user forces EFF_SPEC=0 without a map, then we have PHOTID
+  if ( INPUTS_SEARCHEFF.IFLAG_SPEC_EFFZERO ) { L_PHOTID = 1; }
 
-  if ( XN0 > 0.0 ) {
-    EFF     = XN1 / XN0 ;
-    SQERR   = XN1 * (XN0-XN1) / ( XN0*XN0*XN0 ) ;
-    EFF_ERR = sqrtf( SQERR ) ;
+  ispgen = GENLC.NON1ASED.ISPARSE ;
+  
 
-    // effic error cannot be zero ...
-    if ( EFF_ERR == 0.0 ) 
-      EFF_ERR = 1.0 / XN0 ;
+  // set SNTYPE 
 
+  if ( INDEX_GENMODEL == MODEL_FIXMAG ) {
+    GENLC.SNTYPE   = MODEL_FIXMAG ;
+    // xxx mark delete    GENLC.SNTYPE   = (int)INPUTS.FIXMAG[0] ;
   }
-  else {
-    EFF     = 0.0 ; 
-    EFF_ERR = 1.0 ;  // set large error to avoid STOPGEN
+  else if ( LGEN_SNIA )  { 
+    GENLC.SNTYPE   = INPUTS.SNTYPE_Ia_SPEC ; 
+  }
+  else if ( ispgen >=0 ) {
+    GENLC.SNTYPE = INPUTS.NON1ASED.SNTAG[ispgen];
+  }
+
+  // user-defined GENTYPE over-rides any other type (Apr 11 2017)
+  if ( INPUTS.GENTYPE_SPEC > 0 ) {
+    GENLC.SNTYPE = INPUTS.GENTYPE_SPEC ; 
+  }
+
+ 
+  if ( L_PHOTID ) {
+    // photometric candidate
+    GENLC.METHOD_TYPE = METHOD_TYPE_PHOT ;
+    GENLC.NTYPE_PHOT++ ; 
+    if ( LGEN_SNIA )  
+      { GENLC.SNTYPE = INPUTS.SNTYPE_Ia_PHOT ; }
+    else
+      { GENLC.SNTYPE += OFFSET_TYPE_PHOT ; }
 
-    // if NGEN_REJECT.GENRANGE is 1000, and we still have
-    // not accepted anything abort with error message.
+    // check over-ride from GENTYPE (Apr 11 2017)
+    if ( INPUTS.GENTYPE_PHOT > 0 ) 
+      { GENLC.SNTYPE = INPUTS.GENTYPE_PHOT ; }
 
-    if ( NGEN_REJECT.GENRANGE >= 1000 ) {
-      sprintf(c1err,"Generated %d light curves, but NONE pass GENRANGEs",
-	      NGEN_REJECT.GENRANGE );
-      sprintf(c2err,"Check GENRANGEs for RA, DECL, REDSHIFT, PEAKMJD") ;
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
-    }
+    setz_unconfirmed();
+  }
+  else { 
+    // spec-confirmed
+    GENLC.REDSHIFT_FLAG = REDSHIFT_FLAG_SNSPEC ; 
+    GENLC.METHOD_TYPE   = METHOD_TYPE_SPEC ;
+    GENLC.NTYPE_SPEC++ ; 
   }
-
-  GENLC.GENEFF    = EFF ;
-  GENLC.GENEFFERR = EFF_ERR ;
 
 
-  return ISTOP ;
+} // end gen_spectype
 
-} // end of geneff_calc
 
 // ***************************************
-int gen_cutwin(void) {
+void  setz_unconfirmed(void) {
 
-  // apply cut-windows; returns SUCCESS or ERROR.
-  // ERROR just means that this SN fails cuts.
-  //
-  // Jan 12, 2013: replace CERNLIB sortzv with sortFloat wrapper
-  //
-  // Jan 31, 2014: abort on any undefined filter in CUTWIN_SNRMAX.
-  //
-  // Mar 1, 2014: for SNRMAX, use flux_errstat instead flux_errtot
-  //              since flux_errstat is written to data file.
+  // Use GENLC.SEARCHEFF_MASK (see sntoolc_trigger.c) 
+  // to determine if this UNCONFIRMED SN has a host-galaxy 
+  // redshift ... and if so, apply optional WRONGHOST model.
+  // If there is no zHOST then set measured redshift and
+  // its error to HOST PHOTOZ, or to -9.
   //
   //
-  // May 11 2015: fill GENLC.SNRMAX_TRUE[ifilt_obs]
+  // July 26 2017: 
+  //  Fix bug when there is no zSPEC(SN or host), but there is
+  //  zPhotHost (SNHOSTGAL.ZPHOT).
   //
-  // Aug 10 2017: malloc and free TLIST and INDEX_SORT
+  // Mar 17 2018: z -> HOST_PHOTOZ if no host-zSPEC
   //
-  // Sep 25 2017: check CUTWIN_EPOCHS_xxx to select fast transients.
+  // May 30 2018: 
+  //  + GENLC.REDSHIFT_CMB[HELIO] -> -9 of ZHOST < 0
+  //    This doesn't fix any bug, but avoids wierd small-negative 
+  //    ZCMB & ZHELIO that look like a bug.
   //
-  // May 2018: check SATURATION  cuts
-  // Jun 22 2018: fux bug initializing SNRMAX_FILT[icut][ifilt]
-  // Aug 19 2018: apply HOST_ZPHOT cut
-
-  int 
-    NEP, ep, i, icut, ifilt, ifilt_obs 
-    ,LTMP, LSNR, NTMP, NFCUT, IFILTOBS_LIST[MXFILTINDX]
-    ,NTLIST, USE_TGAP, USE_T0GAP, LDMP, opt_frame, MEM
-    ;
-
-  float 
-    SNR, trueSNR
-    ,SNRMAX_FILT[MXCUTWIN_SNRMAX][MXFILTINDX] 
-    ,SNRMAX_TMP[MXFILTINDX] 
-    ,lamrest[MXFILTINDX] 
-    ,Trest, Tlast, TGAP, T0GAPOVP[2], flux, fluxerr, peakmag
-    ,lamobs, lamrms, lammin, lammax, z1, zhel
-    ,*TLIST    
-    ;
-
-  double MJD, MJD_last, MJDDIF, GAIN, MJD_SNRMIN_FIRST, MJD_SNRMIN_LAST;
-
-  // TLIST sorting variables
-  int   DOCUTS, ORDER_SORT, isort ;
-  int  *INDEX_SORT ;
-
-  char cfilt[2];
-  char fnam[] = "gen_cutwin" ;
 
-  // ------------ BEGIN -------------
+  double RA        = GENLC.RA ;
+  double DEC       = GENLC.DEC ;
+  double ZPHOT     = SNHOSTGAL.ZPHOT ;
+  double ZPHOT_ERR = SNHOSTGAL.ZPHOT_ERR ;
+  double ZCMB_ORIG = GENLC.REDSHIFT_CMB_SMEAR ;
+  int    FOUND_zHOST ;
+  int LDMP = 0 ;
+  char eq[]   = "eq" ;
+  char fnam[] = "setz_unconfirmed" ;
 
-  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID  ) { return SUCCESS; }
+  // ---------- BEGIN -------------
+  
+  FOUND_zHOST = ( (GENLC.SEARCHEFF_MASK & APPLYMASK_SEARCHEFF_zHOST) > 0 ) ;
+  
+  if ( LDMP ) {
+    printf(" xxx -------------------------- \n");
+    printf(" xxx %s: CID=%d  Found_zHOST=%d   CORRECT_HOSTMATCH=%d \n",
+	   fnam, GENLC.CID, FOUND_zHOST, GENLC.CORRECT_HOSTMATCH );
+  }
 
-  // bail if no cuts and no dump are specified:
+  if ( FOUND_zHOST ) {
 
-  if ( INPUTS.APPLY_CUTWIN_OPT > 0  || 
-       INPUTS.NVAR_SIMGEN_DUMP > 0  ||
-       INPUTS.OPT_FUDGE_SNRMAX > 0    )  
-    { DOCUTS = 1; }
-  else 
-    { DOCUTS = 0 ;    return SUCCESS ;  }
+    GENLC.REDSHIFT_FLAG = REDSHIFT_FLAG_HOSTSPEC ; 
 
-  // if we get here, calcualte CUT-WINDOW variables.
-  
-  LDMP = ( GENLC.CID < -5555 ) ;
+    // update only if we have the wrong host
+    if ( !GENLC.CORRECT_HOSTMATCH  ) {
+      GENLC.REDSHIFT_FLAG        = REDSHIFT_FLAG_WRONGHOST ; 
+      GENLC.REDSHIFT_HELIO_SMEAR = SNHOSTGAL.ZSPEC ;  
+      GENLC.REDSHIFT_CMB_SMEAR =  
+	zhelio_zcmb_translator(SNHOSTGAL.ZSPEC, RA,DEC,eq, +1);
 
-  if ( LDMP ) {
-    printf("\n xxx ----------------------------------------------- \n");
-    printf(" xxx START gen_cutwin() dump for CID=%d  LIBID=%d\n", 
-	   GENLC.CID, GENLC.SIMLIB_ID );
-    printf(" xxx NEP=%d  zHel=%.4f  PEAKMJD=%.3f  MWEBV=%.3f\n",   
-	   GENLC.NEPOCH, GENLC.REDSHIFT_HELIO, 
-	   GENLC.PEAKMJD, GENLC.MWEBV );
-    fflush(stdout);
+      if ( LDMP ) {
+	printf(" xxx zcmb = %.3f(SN) -> %.3f(WRONGHOST) \n", 
+	       ZCMB_ORIG, GENLC.REDSHIFT_CMB_SMEAR); fflush(stdout);
+      }
+    }
+    
   }
+  else {
+    // no host galaxy redshift (and no SN redshift)
+    SNHOSTGAL.ZSPEC            = -9.0 ;
+    SNHOSTGAL.ZSPEC_ERR        = -9.0 ;
 
-  zhel  = GENLC.REDSHIFT_HELIO ;
-  z1 = ( 1. + zhel );
+    if ( ZPHOT < 0.0 ) { // if no host photoz ...
+      GENLC.REDSHIFT_FLAG        = REDSHIFT_FLAG_NONE ; 
+      GENLC.REDSHIFT_CMB_SMEAR   = -9.0 ; 
+      GENLC.REDSHIFT_HELIO_SMEAR = -9.0 ; 
+      GENLC.REDSHIFT_SMEAR_ERR   = -9.0 ;
+    } 
+    else {
+      // use zPHOT  here if it is defined
+      GENLC.REDSHIFT_FLAG        = REDSHIFT_FLAG_HOSTPHOT ; 
+      GENLC.REDSHIFT_HELIO_SMEAR = ZPHOT ;
+      GENLC.REDSHIFT_SMEAR_ERR   = ZPHOT_ERR ;
+      GENLC.REDSHIFT_CMB_SMEAR = zhelio_zcmb_translator(ZPHOT,RA,DEC,eq, +1);
+    }
+  }
 
-  NEP = GENLC.NEPOCH;
+  return ;
 
-  // INDEX_SORT is used for epochs and also for filters,
-  // so make sure the MEM size can handle all filters.
-  MEM=NEP; if (NEP < MXFILTINDX) { MEM=MXFILTINDX+1; }
+} // end of  setz_unconfirmed
 
-  TLIST      = malloc( MEM * sizeof(float) ) ;
-  INDEX_SORT = malloc( MEM * sizeof(int)   ) ;
 
-  for ( ifilt_obs=0; ifilt_obs < MXFILTINDX; ifilt_obs++ ) {
-    SNRMAX_TMP[ifilt_obs]           = -9.0 ;
-    GENLC.SNRMAX_FILT[ifilt_obs]    = -9.0 ;  
-    GENLC.SNRMAX_SORTED[ifilt_obs]  = -9.0 ;  
-    GENLC.SNRMAX_TRUE[ifilt_obs]    = -9.0 ;  
-    for ( icut=0; icut <= MXCUTWIN_SNRMAX; icut++ )
-      { SNRMAX_FILT[icut][ifilt_obs] = -9.0 ; }
-  }
-  GENLC.TIME_ABOVE_SNRMIN = 0.0 ;
+// ***************************************
+int gen_smearFlux ( int epoch, int VBOSE ) {
 
-  // get lamrest for each observer filter
-  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
-    opt_frame = GENFRAME_OBS;
-    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];    
-    get_filtlam__(&opt_frame, &ifilt_obs,  &lamobs,&lamrms,&lammin,&lammax);
-    lamrest[ifilt_obs] = lamobs / z1 ;
-  }
 
-  // make redshift cut on true and/or final(measured) 
-  int LZTRUE=0, LZFINAL=0, LZPHOT=0 ;
-  double ZTRUE, ZFINAL, ZPHOT ;
-  ZTRUE  = GENLC.REDSHIFT_CMB;
-  ZFINAL = GENLC.REDSHIFT_CMB_SMEAR ;
-  ZPHOT  = SNHOSTGAL.ZPHOT ; 
+  /**********
 
-  LZTRUE = ( ZTRUE >= INPUTS.CUTWIN_REDSHIFT_TRUE[0] && 
-	     ZTRUE <= INPUTS.CUTWIN_REDSHIFT_TRUE[1] ) ;
-  LZFINAL = ( ZFINAL >= INPUTS.CUTWIN_REDSHIFT_FINAL[0] && 
-	      ZFINAL <= INPUTS.CUTWIN_REDSHIFT_FINAL[1] ) ;
-  LZPHOT  = ( ZPHOT >= INPUTS.CUTWIN_HOST_ZPHOT[0] && 
-	      ZPHOT <= INPUTS.CUTWIN_HOST_ZPHOT[1] ) ;
+   Convert generated  "genmag" into observed flux that
+   includes Poisson fluctuations.
 
-  if ( LZTRUE && LZFINAL && LZPHOT ) 
-    { GENLC.CUTBIT_MASK |= (1 << CUTBIT_REDSHIFT); }
+   Each genmag is converted into flux in ADU and then into 
+   photo-electrons. Error is computed from photo-statistics 
+   of signal, sky, readnoise. An effective aperture of 4*pi*PSF^2 
+   is used fpr sky- and read-noise.
 
-  // start loop over epochs
-  NTLIST    = 0 ;
-  MJD_last  = -99999. ;
-  MJD_SNRMIN_FIRST = MJD_SNRMIN_LAST = 0.0 ;
+   The flux is smeared based on fluxcal_err which combines
+   photostat error and mag-zeropt error. However, the 
+   calculated flux error "flux_err" includes only the
+   photostat error and not the mag-zeropt error.
 
-  for ( ep = 1; ep <= NEP ; ep++ ) {
 
-    Trest  = (float)GENLC.epoch8_rest[ep] ;
-    MJD    = GENLC.MJD[ep];
-    MJDDIF = MJD - MJD_last ;
+ Mar 1, 2014:
+    - Add coherent template noise from SKY and CCD.
+    - Use pre-computed randoms from
+         GAURAN_Search   = GENLC.RANGauss_NOISE_SEARCH[epoch] ; 
+         GAURAN_Template = GENLC.RANGauss_NOISE_TEMPLATE[ifilt_obs] ;
+      The simlib 'T: ' option is now ignored -> abort in SIMLIB_READ_DRIVER
 
-    // require valid epoch to continue
+    - Use new SIMLIB_GEN array to get SIMLIB conditions 
 
-    if ( GENLC.USE_EPOCH[ep] == 0 ) { continue ; }
-    
-    if ( Trest < INPUTS.CUTWIN_TRESTMIN[0] ) { continue ; }
-    if ( Trest > INPUTS.CUTWIN_TRESTMAX[1] ) { continue ; }
+    - cleanup and variable name changes; remove 'srun' and 'trun' suffix.
 
-    ifilt_obs = GENLC.IFILT_OBS[ep] ;
-    sprintf(cfilt, "%c", FILTERSTRING[ifilt_obs] );
+ 
+  Aug 21 2014: compute anomalous host-subtraction noise "sqhostNoise_pe".
+               See sim-input key HOSTNOISE_FILE.
 
-    // keep track of the true/generated SNR
-    trueSNR     = GENLC.trueSNR[ep] ;
-    if ( trueSNR > GENLC.SNRMAX_TRUE[ifilt_obs] ) {
-      GENLC.SNRMAX_TRUE[ifilt_obs] = trueSNR ;
-    }
+  Mar 3 2015: pass SBmag to GEN_NOISEMODEL_HOST().
 
-    if ( LDMP ) {
-      printf(" xxx ep=%d   MJD(%s)= %f   Trest=%f  \n", 
-	     ep, cfilt, MJD, Trest );   
-      fflush(stdout); 
-    }
+  Sep 2017: for LCLIB model, subtract template flux. Note that 
+            Search-flux can be negative !
 
-    // apply rest-frame lambda cut to all epochs 
-    // used in TREST & SNRMAX cuts
-    if ( lamrest[ifilt_obs] < INPUTS.EPCUTWIN_LAMREST[0] ) continue ;
-    if ( lamrest[ifilt_obs] > INPUTS.EPCUTWIN_LAMREST[1] ) continue ;
+  Oct 6 2017: update SNR_CALC after subtracting optional template flux
 
-    // apply SNRMIN_EP cut to all epochs
-    flux    = GENLC.flux[ep] ;
-    fluxerr = GENLC.flux_errstat[ep] ;
-    SNR     = flux / fluxerr ;
+  Oct 31 2017: if sqsum < 0, set sqsum = small positive number
+              (prevents abort)
 
-    if ( SNR < INPUTS.EPCUTWIN_SNRMIN[0] ) continue ;
+  Feb 14 2018: minor refactor/cleanup to prepare for FLUXERRMODEL.
+               "errtot" is used along with errstat.
 
-    NTLIST++;
-    TLIST[NTLIST] = Trest; // used later for sorting
+  Feb 28 2018: 
+   For LCLIB model and SMEARFLAG_ZEROPT, fix bug by subtracting
+   flux_T before taking relErr. Also note that flux_T is computed
+   earlier than before. Bug found by Gautham.
 
-    if ( Trest < GENLC.TRESTMIN ) { GENLC.TRESTMIN = Trest ; }
-    if ( Trest > GENLC.TRESTMAX ) { GENLC.TRESTMAX = Trest ; }
+ Mar 03 2018: GENLC.NOISE_XXX -> FLUXCAL units instead of p.e.
 
-    if ( Trest >= INPUTS.CUTWIN_TRESTMIN[0] &&
-	 Trest <= INPUTS.CUTWIN_TRESTMIN[1] )
-      { GENLC.CUTBIT_MASK |= (1 << CUTBIT_TRESTMIN) ; }
+ Mar 05 2018: check option to ignore source & galaxy in reported
+              errors (INPUTS.SMEARFLAG_FLUX & 2) 
 
-    if ( Trest >= INPUTS.CUTWIN_TRESTMAX[0] &&
-	 Trest <= INPUTS.CUTWIN_TRESTMAX[1] )
-      { GENLC.CUTBIT_MASK  |= (1 << CUTBIT_TRESTMAX) ; }
+ Mar 18 2018: compute GENLC.SNR_MON for mag = INPUTS.MAGMONITOR_SNR
 
-    // check epochs above special SNR cut (not the global EPCUTWIN_SNRMIN)
-    if ( SNR >= INPUTS.CUTWIN_NEPOCH[1] ) { GENLC.NOBS_SNR++; }
+  **********************************/
 
-    // evaluate SNRMAX for each Trest window & filter
+  // define args stripped from GENLC structure
 
-    for ( icut=0; icut <= INPUTS.NCUTWIN_SNRMAX; icut++ ) {
+  int ifilt_obs, ifilt, ifield, LDMP=0, GALID, OVP ;
 
-      LTMP = ( Trest >= INPUTS.CUTWIN_SNRMAX_TREST[icut][0])
-	&&   ( Trest <= INPUTS.CUTWIN_SNRMAX_TREST[icut][1]) ;
+  double 
+    genmag, genmag_T
+    ,ccdgain, readnoise, skysig, psfsig1, psfsig2, psfratio, zpt, zptsig  
+    ,ZPTDIF_pe, Npe_over_FLUXCAL, ZPTDIF_ADU, NADU_over_FLUXCAL, NADU_over_Npe
+    ,template_readnoise, template_skysig, template_zpt
+    ,zsn, psfsig_arcsec, psfFWHM_arcsec, galmag, GALMAG, SBmag
+    ;
 
-      LSNR = SNR  >  SNRMAX_FILT[icut][ifilt_obs] ;
+  // Note three types of errors:
+  //   errS   = search error only  (source+sky+host)
+  //   errSZ  = search error + ZPsmear
+  //   errSZT = search error + ZPsmear + template error
+  
+  // local variables   
+  double 
+    arg, mjd, fluxObs_adu
+    ,fluxsn_pe,  fluxsn_pe_err, fluxgal_pe, fluxmon_pe
+    ,fluxsn_adu, fluxsn_adu_errS, fluxsn_adu_errSZ, fluxsn_adu_errSZT
+    ,fluxsn_adu_errST, fluxsn_adu_errZ, flux_T 
+    ,sqskyerr_pe, template_sqskyerr_pe, template_sqerr_pe
+    ,sqccderr_pe, template_sqccderr_pe
+    ,sqImageNoise_pe, fluxsn_adu_errData
+    ,template_pe_err, template_adu_err, fluxsn_adu_errReal
+    ,sqadderr_pe, area_bg
+    ,mag_smear, magerr_tmp, fluxErr_tmp, sqerr_tmp, skysig_tmp_pe
+    ,sqsum, sqerr, sqerr1, sqerr2, sqerr_ran
+    ,err1, err2, relerr, errtmp, errtot, errstat, pixsize
+    ,xt, zptfac, crazyflux, Trest, Tobs
+    ,fluxerrCor, SNR_CALC, SNR_MON, SNR
+    ,GAURAN_Search, GAURAN_ZP, GAURAN_Template
+    ,snsep, HOSTNOISE_FLUXCAL, HOSTNOISE_ERRSCALE, HOSTNOISE_pe
+    ,noisePar[10]
+    ;
 
-      if (  LSNR   && LTMP ) {
-	SNRMAX_FILT[icut][ifilt_obs] = SNR ; 
-	if ( icut == 0 ) {
-	  GAIN = SIMLIB_OBS_GEN.CCDGAIN[ep] ;
-	  GENLC.FLUXADU_at_SNRMAX[ifilt_obs] = flux ; 
-	  GENLC.FLUXpe_at_SNRMAX[ifilt_obs]  = flux * GAIN ;
-	}
-      }
-    } // icut
+  double scale_fluxErr = 1.0 ;
+  char field[MXCHAR_FIELDNAME], band[4];
+  char fnam[] = "gen_smearFlux" ;
 
-    // count NOBS with at least MJDDIF time separation
-    if ( MJDDIF >= INPUTS.CUTWIN_MJDDIF[0] ) 
-      { GENLC.NOBS_MJDDIF++ ; }
+  // ----------------- BEGIN --------------
 
-    // count time above SNRMIN
-    if ( SNR > INPUTS.CUTWIN_EPOCHS_SNRMIN &&
-	 strstr(INPUTS.CUTWIN_EPOCHS_FILTERS,cfilt)!=NULL  ) {
-      if ( MJD_SNRMIN_FIRST < 0.01 ) { MJD_SNRMIN_FIRST = MJD; }
-      MJD_SNRMIN_LAST = MJD ;
-    }
+  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID  ) { return SUCCESS; }
 
-    MJD_last = MJD;
+  // strip GENLC info into local variables.
 
-  } // end of ep loop
+  ifilt_obs      = GENLC.IFILT_OBS[epoch] ;
+  ifilt = GENLC.IFILTINVMAP_OBS[ifilt_obs] ; // sparse index
+  sprintf(band, "%c", FILTERSTRING[ifilt_obs] );
 
-  // - - - - - - - - - - - - - - - - - - - - - - - - - -
+  genmag         = GENLC.genmag8_obs[epoch];
+  mag_smear      = GENLC.magsmear8[epoch];
+  zsn            = GENLC.REDSHIFT_HELIO ;
+  sprintf(field,"%s", GENLC.FIELDNAME[epoch] );
+  ifield         = IFIELD_OVP_SIMLIB(1,field);
+  if ( ifield < 0 ) { ifield=0; } // Nov 2016: needed for GAURAN_TEMPLATE
 
-  if ( GENLC.NOBS_SNR >= INPUTS.CUTWIN_NEPOCH[0] ) 
-    { GENLC.CUTBIT_MASK |= (1<<CUTBIT_NOBS_SNR) ; }
+  mjd        = SIMLIB_OBS_GEN.MJD[epoch] ;
+  pixsize    = SIMLIB_OBS_GEN.PIXSIZE[epoch] ;
+  ccdgain    = SIMLIB_OBS_GEN.CCDGAIN[epoch] ;
+  skysig     = SIMLIB_OBS_GEN.SKYSIG[epoch] ;
+  readnoise  = SIMLIB_OBS_GEN.READNOISE[epoch] ;
+  psfsig1    = SIMLIB_OBS_GEN.PSFSIG1[epoch] ; // pixels
+  psfsig2    = SIMLIB_OBS_GEN.PSFSIG2[epoch] ;
+  psfratio   = SIMLIB_OBS_GEN.PSFRATIO[epoch] ;
+  zpt        = SIMLIB_OBS_GEN.ZPTADU[epoch] ;
+  zptsig     = SIMLIB_OBS_GEN.ZPTSIG[epoch] ;
+  
+  GALID   = SNHOSTGAL.GALID ;
+  GALMAG  = SNHOSTGAL.GALMAG[ifilt_obs][0] ; // full galaxy mag
+  SBmag   = SNHOSTGAL.SB_MAG[ifilt_obs]  ;   // in 1 sq arcsec
+  if ( SBmag > 32.0 ) { SBmag = 32.0; }      // to limit fluxerrmap size
+  snsep   = SNHOSTGAL.SNSEP ;                // SN-host sep, arcsec
 
-  if ( GENLC.NOBS_MJDDIF >= INPUTS.CUTWIN_NOBSDIF[0] ) 
-    { GENLC.CUTBIT_MASK |= (1<<CUTBIT_NOBS_MJDDIF) ; }
+  template_skysig     = SIMLIB_OBS_GEN.TEMPLATE_SKYSIG[epoch] ; 
+  template_readnoise  = SIMLIB_OBS_GEN.TEMPLATE_READNOISE[epoch] ; 
+  template_zpt        = SIMLIB_OBS_GEN.TEMPLATE_ZPT[epoch] ;
 
-  GENLC.TIME_ABOVE_SNRMIN = (float)(MJD_SNRMIN_LAST - MJD_SNRMIN_FIRST);
-  if ( GENLC.TIME_ABOVE_SNRMIN < INPUTS.CUTWIN_EPOCHS_TRANGE[1] ) 
-    { GENLC.CUTBIT_MASK |= (1<<CUTBIT_TIME_ABOVE) ; }
+  genmag_T = GENLC.genmag8_obs_template[ifilt_obs]; // Sep 2017/LCLIB
+  flux_T   = 0.0 ;
+  if ( genmag_T < 90.0 ) {
+    arg     = 0.4 * ( zpt - genmag_T );
+    flux_T  = pow(10.0,arg);        // flux in ADUs    
+  }
 
+  xt = INPUTS.EXPOSURE_TIME_FILTER[ifilt_obs] ; // for error check only
+  if ( xt < 1.0 ) { xt = 1.0 ; }
 
-  // now sort SNRMAX for each filter and store in GENLC.SNRMAX_SORTED
-  // First get SNRMAX-list sorted by filter.
-  // These are computed just for the SIMGEN_DUMP option,
-  // and are NOT used for any of the CUTWIN tests.
+  // compute zp in photo-electrons in case we need to 
+  // convert a FLUXCAL quantity back into pe.
+  ZPTDIF_ADU = zpt - ZEROPOINT_FLUXCAL_DEFAULT ;
+  NADU_over_FLUXCAL = pow( TEN , 0.4*ZPTDIF_ADU) ;
+  Npe_over_FLUXCAL  = NADU_over_FLUXCAL * ccdgain;
+  NADU_over_Npe     = NADU_over_FLUXCAL/Npe_over_FLUXCAL ;  
 
-  icut = 0 ;
-  NTMP = GENLC.NFILTDEF_OBS;
-  for ( ifilt=0; ifilt < NTMP ; ifilt++ ) {
-    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
-    sprintf(cfilt, "%c", FILTERSTRING[ifilt_obs] );
+  // init output
+  GENLC.flux[epoch]         = NULLFLOAT ; 
+  GENLC.flux_errstat[epoch] = NULLFLOAT ;     
+  GENLC.flux_errtot[epoch]  = NULLFLOAT ;     
 
-    SNRMAX_TMP[ifilt+1]          = SNRMAX_FILT[icut][ifilt_obs] ;
-    GENLC.SNRMAX_FILT[ifilt_obs] = SNRMAX_FILT[icut][ifilt_obs] ;
+  // bail on bad input or non-existant peak epoch
+  int SKIPIT = 0;
+  if ( GENLC.ISPEAK[epoch]      )  { SKIPIT = 1 ; }
+  if ( GENLC.ISTEMPLATE[epoch]  )  { SKIPIT = 1 ; }
+  if ( zpt     < 10.0   )          { SKIPIT = 1 ; }
+  if ( psfsig1 < 0.0001 )          { SKIPIT = 1 ; }
+  if ( skysig  < 0.0001 )          { SKIPIT = 1 ; }
+  if ( SKIPIT ) {    return ERROR ;  }
 
-    if ( LDMP ) {
-      printf(" xxx CID=%d  SNRMAX[%s] = %6.2f \n", 
-	     GENLC.CID, cfilt, SNRMAX_FILT[icut][ifilt_obs] );
-      fflush(stdout);
-    }
+
+  // use search-run zero-point to convert mag -> flux.
+  arg           = 0.4 * ( zpt - genmag );
+  fluxsn_adu    = pow(10.0,arg);         // flux in ADUs
+  fluxsn_pe     = fluxsn_adu * ccdgain ; // flux in pe
+  
+  // compute optional signal for monitor mag
+  if ( INPUTS.MAGMONITOR_SNR > 10 ) {
+    double magmon = (double)INPUTS.MAGMONITOR_SNR ;
+    arg           = 0.4 * ( zpt - magmon );
+    fluxmon_pe    = ccdgain * pow(10.0,arg); 
   }
 
+  // ################ GET FLUX STAT-ERROR ##################
 
-  ORDER_SORT = -1; // decreasing order
-  sortFloat( NTMP, &SNRMAX_TMP[1], ORDER_SORT, &INDEX_SORT[1] );
+  // get effective aperture  area (pixels)
+  area_bg = NoiseEquivAperture(psfsig1, psfsig2, psfratio );
+  psfsig_arcsec = pixsize * sqrt(area_bg/(2.0*TWOPI))  ; 
+  psfFWHM_arcsec = 2.3548 * psfsig_arcsec ;
 
-  for ( ifilt = 1; ifilt <= NTMP ; ifilt++ ) {
-    isort = INDEX_SORT[ifilt] + 1 ; // fortran-line index
-    SNR   = SNRMAX_TMP[isort] ;
-    GENLC.SNRMAX_SORTED[ifilt] = SNR ;
-  }
+  // get total sky noise for search run; includes sky & CCD noise
+  skysig_tmp_pe = skysig * ccdgain ;  // convert ADU -> pe
+  sqskyerr_pe = area_bg * (skysig_tmp_pe*skysig_tmp_pe);
+  sqccderr_pe = area_bg * (readnoise*readnoise) ;  // in Npe
 
 
-  // -------------
-  // Check if SNRMAX passes cut in each passband for each test
-  // Set default LSNR=TRUE; then set false if any SNRMAX cut fails. 
+  // Apri 26 2016: optional non-linearity bias to signal (NONLINEARITY_FILE)
+  double scale_nonLin = GET_NONLIN(band, fluxsn_pe, sqskyerr_pe, genmag);
+  if ( fabs(scale_nonLin-1.0) > 1.0E-7 ) {
+    fluxsn_pe   *= scale_nonLin ;
+    fluxsn_adu  *= scale_nonLin ;
+    sqskyerr_pe *= scale_nonLin ;
+    sqccderr_pe *= scale_nonLin ;
+  }
 
-    LSNR = 1;
+  // add sky-noise from template, integrated over effective aperture 
+  template_pe_err = template_sqskyerr_pe = template_sqccderr_pe = 0.0 ;
+  template_sqerr_pe = 0.0 ;
 
-    for ( icut=1; icut <= INPUTS.NCUTWIN_SNRMAX; icut++ ) {
+  if ( SIMLIB_TEMPLATE.USEFLAG && template_skysig > 0.0 ) {
+    if ( template_zpt < 10.0 ) {
+      sprintf(c1err,"Invalid template_zpt(%c)=%f for  LIBID=%d at MJD=%.3f", 
+	      FILTERSTRING[ifilt_obs], template_zpt, GENLC.SIMLIB_ID, mjd );
+      sprintf(c2err,"Need TEMPLATE_ZPT to scale template noise.");
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
+    }
 
-      // get filter-range to test for this cut
-      NFCUT = PARSE_FILTLIST( INPUTS.CUTWIN_SNRMAX_FILTERS[icut], 
-			      IFILTOBS_LIST ); // <== returned
+    skysig_tmp_pe = template_skysig * ccdgain ;  // convert sigma in ADU -> pe.
+    template_sqskyerr_pe = area_bg * (skysig_tmp_pe*skysig_tmp_pe) ;
+    template_sqccderr_pe = area_bg * (template_readnoise*template_readnoise);
 
-      NTMP = 0;
-      for ( i=0; i < NFCUT; i++ ) {
+    // scale template noise to the search image
+    double zparg, zfac;
+    zparg = 0.8*(zpt - template_zpt); // Feb 2 2017 bug fix
+    zfac  = pow(TEN, zparg);
+    template_sqskyerr_pe *= zfac ;
+    template_sqccderr_pe *= zfac ;
 
-	ifilt_obs = IFILTOBS_LIST[i] ;
+    template_sqerr_pe = template_sqccderr_pe + template_sqskyerr_pe ;
+    template_pe_err   = sqrt(template_sqerr_pe) ;
+  }
 
-	// abort if ifilt_obs is undefined
-	ifilt = GENLC.IFILTINVMAP_OBS[ifilt_obs]; 
-	if ( ifilt < 0 ) {
-	  sprintf(c1err,"Invalid filter '%c' in", FILTERSTRING[ifilt_obs]);
-	  sprintf(c2err,"CUTWIN_SNRMAX: %.1f  %s   etc ...",
-		  INPUTS.CUTWIN_SNRMAX[icut][0],
-		  INPUTS.CUTWIN_SNRMAX_FILTERS[icut] );
-	  errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
-	}
 
-	SNR = SNRMAX_FILT[icut][ifilt_obs] ;
-	if ( SNR > INPUTS.CUTWIN_SNRMAX[icut][0] )  { NTMP++ ; }
+  // @@@@@@@@@@@@ LEGACY ERRFDUGE @@@@@@@@@@@@@@
+  // Feb 2012: add FLUXERR_ADD in quadrature
+  // Jan 2014: require EXPOSURE_TIME=1 to implement; avoid crazy error
+  double  ERR_CAL, ERR_pe, XT ;
+  ERR_CAL  = GENLC.SIMLIB_FLUXERR_ADDPAR[ifilt_obs];
+  XT       = INPUTS.EXPOSURE_TIME_FILTER[ifilt_obs] ; // Jan 2014
+  sqadderr_pe = 0.0 ;
+  if ( SIMLIB_FLUXERR_COR.USE  && ERR_CAL >1.E-6  &&   XT == 1.0 ) {
+    // translate ERR_CAL from FLUXCAL back to p.e.
+    ERR_pe      = ERR_CAL * Npe_over_FLUXCAL ;
+    sqadderr_pe = (ERR_pe * ERR_pe) ;
+  }
+  // @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
 
-      } // end of ifilt_obs loop
 
+  // -------------------------------------------
+  // galaxy noise from photo-stats
+  fluxgal_pe = 0.0;
 
-      if ( NTMP < INPUTS.CUTWIN_SNRMAX_NFILT[icut] ) { LSNR = 0 ; }
+  OVP = INPUTS.SMEARFLAG_HOSTGAL & SMEARMASK_HOSTGAL_PHOT ;
+  if ( OVP > 0 ) {
+    // get galmag and SN-host sep:  4*PI*PSF^2 = area
+    galmag        = interp_GALMAG_HOSTLIB(ifilt_obs, psfsig_arcsec );
+    arg           = 0.4 * ( zpt - galmag );
+    fluxgal_pe    = ccdgain * pow(10.0,arg);   // effec-aper flux in pe.
+  }
 
+  // @@@@@@@@@@@@@@@@@ LEGACY ERRFUDGE @@@@@@@@@@@@@@@@@@@@@@@@@
+  // Aug 2014: anomolous host-subtraction noise (HOSTNOISE_FILE)
+  //           Note the dependence on both band and field.
+  OVP = INPUTS.SMEARFLAG_HOSTGAL & SMEARMASK_HOSTGAL_IMAGE ;
+  sqImageNoise_pe = 0.0 ;
+  HOSTNOISE_pe    = HOSTNOISE_FLUXCAL = 0.0 ;
+  if ( OVP ) {    
+    GEN_NOISEMODEL_HOST_LEGACY(band,field,GALID,GALMAG,SBmag,snsep, 
+			       noisePar);  // <== return this array
 
-    } // end of icut loop
+    HOSTNOISE_FLUXCAL  = noisePar[0] ; // add this noise, per pixel
+    HOSTNOISE_ERRSCALE = noisePar[1] ; // scale on added sky noise
 
+    // convert extra noise in FLUXCAL unit to Npe (per pixel)
+    HOSTNOISE_pe    = HOSTNOISE_FLUXCAL * Npe_over_FLUXCAL ;
 
-    if ( LSNR == 1 ) 
-      { GENLC.CUTBIT_MASK  |= (1<<CUTBIT_SNRMAX) ; }
+    double SQ0 = HOSTNOISE_pe * HOSTNOISE_pe ;
+    double SQ1 = HOSTNOISE_ERRSCALE * HOSTNOISE_ERRSCALE ;
 
-    // ========================
-    // To get max gap, need sort TLIST
-    // INDEX_SORT is returned from CERNLIB function sortzv_
+    sqImageNoise_pe  = 
+      (area_bg * SQ0)  +                       // quadrature model
+      (sqskyerr_pe+fluxgal_pe)*(SQ1-1.0)  ;    // err-scale;
+  }
+  // @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 
-    ORDER_SORT = +1; // increasing order
-    sortFloat(NTLIST, &TLIST[1], ORDER_SORT, &INDEX_SORT[1] );
+  // --------------------
+  // add up SN flux error (photo-electrons^2) in quadrature
+  // Do not include correlated template noise here.
+  sqsum 
+    = fluxsn_pe        // signal stat-error
+    + sqskyerr_pe      // sky-err from search run
+    + sqccderr_pe      // CCD read noise (added Dec 13, 2010)
+    + sqadderr_pe      // from FLUXERR_ADD key in simlib
+    + fluxgal_pe       // square of host galaxy stat-error
+    ;
 
-    Tlast = -999999. ;
+  // net search stat error in photoelectrons (no template)
+  fluxsn_pe_err = sqrt ( sqsum ) ;  
 
+  // -------------------------------------------
+  // compute calculated SNR to use in lookup maps;
+  // include coh template noise, but ignore anomalous image noise.
+  SNR_CALC      = fluxsn_pe / sqrt(sqsum + template_sqskyerr_pe );
+ 
+  if ( INPUTS.MAGMONITOR_SNR > 10 ) {
+    double sqsum_mon = sqsum - fluxsn_pe + fluxmon_pe ;
+    SNR_MON = fluxmon_pe / sqrt(sqsum_mon + template_sqskyerr_pe );
+  }
+  else
+    { SNR_MON = 0.0 ; }
 
-    for ( i=1; i<= NTLIST; i++ ) {
+  // @@@@@@@@@@@@@@@@@ LEGACY ERRFUDGE @@@@@@@@@@@@@@@@@@@@@@@@@
+  // check optional correction from simlib map
+  fluxerrCor     = get_SIMLIB_fluxerrScale_LEGACY(ifilt_obs, SNR_CALC );    
+  fluxsn_pe_err *= fluxerrCor;
+  // @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 
-      isort = INDEX_SORT[i] + 1; // fortran-like index
-      Trest = TLIST[isort];
 
-      // valid TGAP requires both Trest & Tlast to be within usable 
-      // light curve defined by TRESTMIN & TRESTMAX cuts
+  // Nov 2016: apply user-optional magErr fudge in quadrature (default=0)
+  magerr_tmp = INPUTS.FUDGE_MAGERR_FILTER[ifilt_obs]; 
+  if ( magerr_tmp > 1.0E-9 ) {
+    fluxErr_tmp   = fluxsn_pe * ( 1.0 - pow(10.0,-0.4*magerr_tmp)) ;
+    sqerr_tmp     = fluxErr_tmp * fluxErr_tmp ;
+    fluxsn_pe_err = sqrt(fluxsn_pe_err*fluxsn_pe_err + sqerr_tmp);
+  }
+  // Optional errscale fudge (default=1) applied to true and reported errors.
+  fluxsn_pe_err   *= INPUTS.FUDGESCALE_FLUXERR_FILTER[ifilt_obs] ;
+  template_pe_err *= INPUTS.FUDGESCALE_FLUXERR_FILTER[ifilt_obs] ;
 
-      if ( Trest < INPUTS.CUTWIN_TRESTMIN[0] ) goto SKIPGAP;
-      if ( Trest > INPUTS.CUTWIN_TRESTMAX[1] ) goto SKIPGAP;
-      if ( Tlast < INPUTS.CUTWIN_TRESTMIN[0] ) goto SKIPGAP;
-      if ( Tlast > INPUTS.CUTWIN_TRESTMAX[1] ) goto SKIPGAP;
+  // -----------------------
+  // get search error in ADU
+  fluxsn_adu_errS   = fluxsn_pe_err   / ccdgain ;
+  template_adu_err  = template_pe_err / ccdgain ;
 
-      TGAP = Trest - Tlast; 
-      USE_TGAP = USE_T0GAP = 0;
+  // store individual noise contributions in FLUXCAL units
+  GENLC.NOISE_SN[epoch]        = sqrt(fluxsn_pe ) /Npe_over_FLUXCAL ;
+  GENLC.NOISE_SKY[epoch]       = sqrt(sqskyerr_pe)/Npe_over_FLUXCAL ;
+  GENLC.NOISE_TEMPLATE[epoch]  = sqrt(template_sqskyerr_pe)/Npe_over_FLUXCAL ;
+  GENLC.NOISE_CCD[epoch]       = sqrt(sqccderr_pe)/Npe_over_FLUXCAL ;
+  GENLC.NOISE_HOSTGAL_PHOT[epoch]  = sqrt(fluxgal_pe)/Npe_over_FLUXCAL ;
+  GENLC.NOISE_HOSTGAL_IMAGE[epoch] = sqrt(sqImageNoise_pe)/Npe_over_FLUXCAL ;
+  GENLC.NOISE_TOTAL[epoch]         = fluxsn_pe_err/Npe_over_FLUXCAL ;
 
-      // use T0-gap only of it covers the lower range of TRESTMAX-window,
-      // or the upper range of the TRESTMIN-window.
 
-      T0GAPOVP[0] = INPUTS.CUTWIN_TRESTMIN[1] ; // max TRESTMIN window 
-      T0GAPOVP[1] = INPUTS.CUTWIN_TRESTMAX[0] ; // min TRESTMAX window
-      if ( Trest >= T0GAPOVP[0] && Trest <= T0GAPOVP[1] ) USE_T0GAP = 1 ;
-      if ( Tlast >= T0GAPOVP[0] && Tlast <= T0GAPOVP[1] ) USE_T0GAP = 1 ;
-      if ( Trest >= T0GAPOVP[1] && Tlast <= T0GAPOVP[0] ) USE_T0GAP = 1 ;
+  // ############### ADD ZEROPOINT ERROR ###################
+  // note that zeropoint smearing applies only to fluxcal, and NOT 
+  // to fluxsn_adu. This smearing is random for each epoch.
+  // NOTE: maybe the zpt error should be correlated among epochs ?
 
-      // use T-gap anywhere along light curve
-      USE_TGAP = 1 ;
+  if ( INPUTS.SMEARFLAG_ZEROPT > 0 ) {
+    relerr  = pow(TEN, 0.4*zptsig) - 1.0 ;
+    err1    = fluxsn_adu_errS  ;    
+    err2    = (fluxsn_adu-flux_T) * relerr ;    
+    sqerr1  = err1 * err1 ;    sqerr2  = err2 * err2 ;
+    fluxsn_adu_errSZ  = sqrt ( sqerr1 + sqerr2 );
+    fluxsn_adu_errZ   = err2; 
+  }
+  else {
+    sqerr1 = sqerr2 = fluxsn_adu_errZ = 0.0 ;
+    fluxsn_adu_errSZ = fluxsn_adu_errS ;  // photostat only
+  }
 
-      if ( USE_T0GAP == 1 && TGAP > GENLC.T0GAPMAX )  
-	GENLC.T0GAPMAX = TGAP ;
+  // ############### SMEAR OBSERVED FLUX #####################
+  // Now we have nominal flux in "template" ADUs, and its error.
+  // Apply gaussian fluctuation to get "observed" fluxObs
 
-      if ( USE_TGAP == 1 && TGAP > GENLC.TGAPMAX )  
-	GENLC.TGAPMAX = TGAP ;
 
-      /*
-      if ( LDMP > 0 ) {
-	printf(" xxx sorted Trest(%2d) = %7.3f  TGAP=%6.3f ", 
-	       i, Trest, TGAP );
-	printf(" USE_T0GAP=%d USE_TGAP=%d\n", USE_T0GAP, USE_TGAP );
-      }
-      */
+  // get Gaussian randoms separately for SEARCH and TEMPLATE.
+  // All SEARCH randoms are uncorrelated, but TEMPLATE randoms
+  // depend on field/band, but are the same for each epoch.
+  if ( INPUTS.SMEARFLAG_FLUX > 0 )  {     
+    GAURAN_Search   = GENLC.RANGauss_NOISE_SEARCH[epoch] ; 
+    GAURAN_ZP       = GENLC.RANGauss_NOISE_ZP[epoch] ; 
+    GAURAN_Template = GENLC.RANGauss_NOISE_TEMPLATE[ifield][ifilt_obs] ;
+  }
+  else {  
+    GAURAN_Search   = 0.0 ; 
+    GAURAN_ZP       = 0.0 ; 
+    GAURAN_Template = 0.0 ;
+  }
 
-    SKIPGAP:
-      Tlast = Trest;
-    } // end i-loop over TLIST
 
+  // Feb 2018: fudge error from FLUXERRMODEL. Should replace _legacy codes.
+  if ( NMAP_FLUXERRMODEL > 0 ) {
+    double ERRPARLIST[MXPAR_FLUXERRMAP], fluxerr_sim, fluxerr_data ;
+    double LOGSNR = log10(SNR_CALC);    
+    int OPT = 0;
+    if ( LOGSNR < -0.9 ) { LOGSNR = -0.9 ; }
+    ERRPARLIST[IPAR_FLUXERRMAP_MJD]    = mjd;
+    ERRPARLIST[IPAR_FLUXERRMAP_PSF]    = psfFWHM_arcsec;  // FWHM, arcsec
+    ERRPARLIST[IPAR_FLUXERRMAP_SKYSIG] = skysig;         // ADU/pixel
+    ERRPARLIST[IPAR_FLUXERRMAP_ZP]     = zpt;            // observed ZP, ADU
+    ERRPARLIST[IPAR_FLUXERRMAP_LOGSNR] = LOGSNR ;
+    ERRPARLIST[IPAR_FLUXERRMAP_SBMAG]  = SBmag ;
+    ERRPARLIST[IPAR_FLUXERRMAP_GALMAG] = GALMAG ;
+    ERRPARLIST[IPAR_FLUXERRMAP_SNSEP]  = snsep ;
+    
+    // pass FLUXCAL units to fluxErrModel in case of additive term.
+    double FLUXCALERR_in = fluxsn_adu_errS/NADU_over_FLUXCAL ;
+    double FLUXCALERR_REAL, FLUXCALERR_DATA ;
+
+    get_FLUXERRMODEL(OPT, FLUXCALERR_in, band, field,      // (I)
+		     NPAR_FLUXERRMAP_REQUIRE, ERRPARLIST,  // (I)
+		     &FLUXCALERR_REAL, &FLUXCALERR_DATA) ; // (O)
+
+    // convert FLUXCAL back to pe
+    fluxsn_adu_errReal = FLUXCALERR_REAL * NADU_over_FLUXCAL ;
+    fluxsn_adu_errData = FLUXCALERR_DATA * NADU_over_FLUXCAL ;
+    scale_fluxErr      = fluxsn_adu_errData/fluxsn_adu_errS ;
+  }
+  else {
+    // leagcy option
+    sqsum = 
+      (fluxsn_adu_errS * fluxsn_adu_errS) + 
+      (sqImageNoise_pe / (ccdgain*ccdgain)) ;
 
+    fluxsn_adu_errReal = sqrt(sqsum);
+  }
 
+  fluxObs_adu  = fluxsn_adu 
+    + ( fluxsn_adu_errReal * GAURAN_Search   ) 
+    + ( fluxsn_adu_errZ    * GAURAN_ZP       ) // Feb 2018
+    + ( template_adu_err   * GAURAN_Template ) // coherent template err
+    ;
 
-    if ( LDMP > 0 ) {
-      printf(" xxx CID=%d : TGAPMAX= %6.2f   T0GAPMAX=%6.2f\n", 
-	     GENLC.CID, GENLC.TGAPMAX, GENLC.T0GAPMAX );
-      printf(" xxx CID=%d : TRESTMIN=%f TRESTMAX=%f \n",
-	     GENLC.CID, GENLC.TRESTMIN, GENLC.TRESTMAX );
-      fflush(stdout);
-    }
 
-    // set TGAP cutbits
+  OVP = (INPUTS.SIMLIB_MSKOPT & SIMLIB_MSKOPT_RANDOM_TEMPLATENOISE);
+  if ( OVP > 0 ) {
+    // treat template noise as random instead of coherent
+    // note that fluxObs_adu is overwritten here so that
+    // the coherent-template fluctuation is dropped.
+    sqerr  = fluxsn_adu_errSZ*fluxsn_adu_errSZ ;
+    sqerr += (template_adu_err * template_adu_err);
+    errtmp = sqrt(sqerr);
+    fluxObs_adu  = fluxsn_adu + ( errtmp * GAURAN_Search )  ;
+  }
 
-    if ( GENLC.TGAPMAX <= INPUTS.CUTWIN_TGAPMAX[1] && 
-	 GENLC.TGAPMAX >= INPUTS.CUTWIN_TGAPMAX[0]  ) 
-      { GENLC.CUTBIT_MASK  |= (1<<CUTBIT_TGAPMAX) ; }
 
-    if ( GENLC.T0GAPMAX <= INPUTS.CUTWIN_T0GAPMAX[1] && 
-	 GENLC.T0GAPMAX >= INPUTS.CUTWIN_T0GAPMAX[0]  ) 
-      { GENLC.CUTBIT_MASK  |= (1<<CUTBIT_T0GAPMAX) ; }
+  // use 1/z^2 dependence on mag to set bounds for crazy flux abort;
+  // account for exposure time (xt) and SIMLIB zeropoint (zptfac)
+  // Also add 10 sigma of noise to allow for fluctuations.
 
-    // Set MWEBV cutbit
+  arg        = 0.4 * ( zpt - 31.0 );  
+  zptfac     = pow(10.0,arg);  
+  if ( zsn > 1.0E-9 ) 
+    { crazyflux  = 2.*(1.E4 * zptfac * xt) / (zsn*zsn) ; }
+  else
+    { crazyflux = 1.0E14 ; } // for LCLIB (July 2018)
 
-    if ( GENLC.MWEBV <= INPUTS.CUTWIN_MWEBV[1] && 
-	 GENLC.MWEBV >= INPUTS.CUTWIN_MWEBV[0]  ) 
-      { GENLC.CUTBIT_MASK  |= (1<<CUTBIT_MWEBV) ; }
+  crazyflux += (10.*fluxsn_adu_errS) ;
 
-    // Set PEAKMAG cutbit if any filter satisfies (Sep 2012)
-    int NPASS_PEAKMAG=0, NFAIL_PEAKMAG_ALL=0;
-    for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {      
-      ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];    
-      if ( gen_cutwin_PEAKMAG(1,ifilt_obs) == SUCCESS ) // OR logic
-	{ NPASS_PEAKMAG++; } 
-      if ( gen_cutwin_PEAKMAG(2,ifilt_obs) != SUCCESS )  // AND logic
-	{ NFAIL_PEAKMAG_ALL++; } 
+  if ( mag_smear < 0 ) 
+    { crazyflux *= pow(TEN,-0.4*mag_smear); }
 
-    }
-    if ( NPASS_PEAKMAG > 0 && NFAIL_PEAKMAG_ALL == 0 ) 
-      {  GENLC.CUTBIT_MASK  |= (1<<CUTBIT_PEAKMAG) ; }
+  if ( GENLC.FUDGE_SNRMAX_FLAG == 2 && INPUTS.FUDGE_SNRMAX > 1.0 ) 
+    { crazyflux *= INPUTS.FUDGE_SNRMAX; }
 
-    // May 2018: check SATURATION  cuts 
-    int MINOBS, MAXOBS, NOBS_TOT, NOBS, IPASS=1 ;
-    for(icut=0; icut < INPUTS.NCUTWIN_SATURATE; icut++ ) {
-      MINOBS = INPUTS.CUTWIN_SATURATE_NOBS[icut][0] ;
-      MAXOBS = INPUTS.CUTWIN_SATURATE_NOBS[icut][1] ;
-      NFCUT = PARSE_FILTLIST( INPUTS.CUTWIN_SATURATE_FILTERS[icut], 
-			      IFILTOBS_LIST ); // <== returned   
-      for ( i=0; i < NFCUT; i++ ) {
-	ifilt_obs = IFILTOBS_LIST[i] ;
-	NOBS   = GENLC.NOBS_SATURATE_FILTER[1][ifilt_obs];
-	if ( NOBS < MINOBS || NOBS > MAXOBS ) { IPASS=0; }
-      }
-    } // end icut loop
+  if ( INDEX_GENMODEL == MODEL_SIMSED ) 
+    { crazyflux *= 10.0; }    // allow for really bright objects (Aug 2017)
 
+  if ( INDEX_GENMODEL == MODEL_LCLIB ) 
+    { crazyflux *= 100.0; }  
 
-    // repeat for NOBS_NOSATURATE
-    for(icut=0; icut < INPUTS.NCUTWIN_NOSATURATE; icut++ ) {
-      MINOBS = INPUTS.CUTWIN_NOSATURATE_NOBS[icut][0] ;
-      MAXOBS = INPUTS.CUTWIN_NOSATURATE_NOBS[icut][1] ;
-      NFCUT = PARSE_FILTLIST( INPUTS.CUTWIN_NOSATURATE_FILTERS[icut], 
-			      IFILTOBS_LIST ); // <== returned      
-      for ( i=0; i < NFCUT; i++ ) {
-	ifilt_obs = IFILTOBS_LIST[i] ;
-	NOBS_TOT  = GENLC.NOBS_FILTER[ifilt_obs] ;
+  
+  if ( fluxObs_adu > crazyflux || fluxObs_adu < -xt*1.0E9 ) {
 
-	// require enough NOBS_TOT in this band in case
-	// the model is undefined and we have NOBS_TOT=0.
-	if ( NOBS_TOT > MINOBS ) {
-	  NOBS      = GENLC.NOBS_SATURATE_FILTER[0][ifilt_obs];
-	  if ( NOBS < MINOBS || NOBS > MAXOBS ) { IPASS=0; }
-	}
-	  /* 
-	printf(" xxx ifilt_obs=%d  NOBS=%d (%d-%d)  IPASS=%d\n", 
-	ifilt_obs, NOBS, MINOBS, MAXOBS, IPASS ); */
-      }
+    printf("\n\n PRE-ABORT COMMENTS for CID=%d: \n", GENLC.CID );
+    printf("\t LIBID = %d   MJD=%f  zHel=%6.4f  MU=%7.3f \n",
+	   GENLC.SIMLIB_ID, mjd,
+	   GENLC.REDSHIFT_HELIO, GENLC.DLMU );
 
-    } // end icut loop
+    Trest = GENLC.epoch8_rest[epoch]; 
+    Tobs  = Trest * ( 1.0 + GENLC.REDSHIFT_HELIO );
+    printf("\t Trest=%6.2f  Tobs=%.2f  genmag(%c)=%6.1f  \n", 
+	   Trest, Tobs, FILTERSTRING[ifilt_obs], genmag );
+     
+    printf("\t ccdgain=%6.2f \n",  ccdgain ); 
+    printf("\t zpt(srun) = %f   zptfac=%f \n", 
+	   zpt, zptfac );
+    printf("\t GAURAN(photostat)=%f  magsmear=%6.2f\n", 
+	   GAURAN_Search, mag_smear  );
+    printf("\t sqerr[1,2] = %9.3le , %9.3le \n", sqerr1, sqerr2 );
+    printf("\t ERR_CAL = %f \n", ERR_CAL );
+    printf("\t SKYerr_pe(srun,trun) = %f, %f \n",
+	  sqrt(sqskyerr_pe), sqrt(template_sqskyerr_pe) );
+    printf("\t CCDerr_pe(srun,trun) = %f, %f \n",
+	  sqrt(sqccderr_pe), sqrt(template_sqccderr_pe) );
+    printf("\t err_pe(flux,host,image) = %f, %f, %f \n",
+	   sqrt(fluxsn_pe), sqrt(fluxgal_pe), sqrt(sqImageNoise_pe) );
 
-    //    printf(" xxx IPASS(NOSATURATE) = %d \n", IPASS);
-    if ( IPASS ) { GENLC.CUTBIT_MASK  |= (1<<CUTBIT_SATURATE) ; }
+    printf("\t HOSTNOISE(FLUXCAL,pe) = %f, %f \n",
+	   HOSTNOISE_FLUXCAL, HOSTNOISE_pe);
 
-    // -------------------------------------------
+    printf("\t zptsig=%f   \n",  zptsig);
+    printf("\t GEN(AV,RV) = %7.3f , %7.3f  SHAPEPAR=%7.3f  (c=%7.3f)\n", 
+	   GENLC.AV, GENLC.RV, GENLC.SHAPEPAR, GENLC.SALT2c );
+    printf("\t Gauss random number: %f \n", 
+	   GENLC.GENSMEAR_RANGauss_FILTER[0] );
 
-    if ( LDMP  ) {
-      printf(" xxxxx CID=%d  CUTBIT_MASK = %d  (requires %d) \n",
-	     GENLC.CID, GENLC.CUTBIT_MASK, ALLBIT_CUTMASK );
-      for ( ifilt_obs  = IFILTOBS_LIST[0]; 
-	    ifilt_obs <= IFILTOBS_LIST[1]; ifilt_obs++ ) {
-	SNR = SNRMAX_FILT[1][ifilt_obs] ;
-	printf(" xxxx CID = %d, ifilt_obs = %d, SNRMAX(cut1) = %f \n", 
-	       GENLC.CID, ifilt_obs, SNR);
-	SNR = SNRMAX_FILT[2][ifilt_obs] ;
-	printf(" xxxx CID = %d, ifilt_obs = %d, SNRMAX(cut2) = %f \n", 
-	       GENLC.CID, ifilt_obs, SNR);
-	fflush(stdout);
-      } // end of ifilt_obs loop
+    if ( GENFRAME_OPT  == GENFRAME_REST ) {
+      printf("\t Kcor  %s = %le   AVwarp=%7.3f\n"
+	     , GENLC.kcornam[epoch]
+	     , GENLC.kcorval8[epoch] 
+	     , GENLC.AVwarp8[epoch] 
+	     );
+    }
+    if ( INDEX_GENMODEL  == MODEL_SIMSED ) {
+      printf("\t SIMSED PARAMS %s,%s = %f, %f  (x0=%le)\n"
+	     ,INPUTS.PARNAME_SIMSED[1]
+	     ,INPUTS.PARNAME_SIMSED[2]
+	     ,GENLC.SIMSED_PARVAL[1]
+	     ,GENLC.SIMSED_PARVAL[2], GENLC.SALT2x0 );
     }
 
-    // free memory
-    free(TLIST);  free(INDEX_SORT);
-
-    if ( LDMP ) {
-      printf(" xxx END OF gen_cutwin() dump for CID=%d \n\n", GENLC.CID );
+    if ( INDEX_GENMODEL == MODEL_LCLIB ) {
+      printf("\t LCLIB EVENT ID = %lld \n", LCLIB_EVENT.ID);
     }
 
-    // fail event if SNRMAX-fudge is requested, but exposure time is normal
-    // Next time around with adjusted EXPOSURE_TIME, the event of processed
-    if ( GENLC.FUDGE_SNRMAX_FLAG == 1 ) 
-      { return ERROR; }
+    printf("\t CRAZYFLUX = %9.3le\n", crazyflux);
 
-    if ( INPUTS.APPLY_CUTWIN_OPT == 0 )   
-      { return SUCCESS ; }
+    sprintf(c1err, "Too large %c(%d)-flux = %9.3le  fluxsn_adu=%9.3le", 
+	    FILTERSTRING[ifilt_obs], ifilt_obs, fluxObs_adu, fluxsn_adu );
+    sprintf(c2err, "fluxsn_adu_errS=%9.3le  fluxsn_adu_errSZ=%9.3le ", 
+	    fluxsn_adu_errS, fluxsn_adu_errSZ );
 
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
+    // errmsg(SEV_WARN, 0, fnam, c1err, c2err) ; 
 
-    // if we get here, apply cuts.
+  }
 
-    if ( GENLC.CUTBIT_MASK == ALLBIT_CUTMASK ) 
-      {  return SUCCESS ;  }
-    else
-      { return ERROR ; }
 
+  // Adjust reported error to be based on observed flux instead of
+  // true flux.
+  if ( fluxObs_adu > 0 ) 
+    { sqerr_ran = (fluxObs_adu - fluxsn_adu)/ccdgain; }
+  else
+    { sqerr_ran = -fluxsn_adu/ccdgain; }
+
+  sqerr1 = (fluxsn_adu_errSZ * fluxsn_adu_errSZ) ;
+  fluxsn_adu_errSZ = sqrt(sqerr1 + sqerr_ran);
 
-} // end of gen_cutwin
+  // Add template error to reported error (SZT).
+  sqerr1 = (fluxsn_adu_errSZ * fluxsn_adu_errSZ) ;
+  sqerr2 = (template_adu_err * template_adu_err) ; // add coh template error
+  sqsum  = sqerr1 + sqerr2 ;
+  if ( sqsum < 1.0E-9 ) { sqsum = 1.01E-9 ; }
 
+  if ( sqsum < 1.0E-9 ) {
+    printf(" \n PRE-ABORT DUMP: \n");
+    printf("   sqerr1=%f  sqerr2=%f  sqerr_ran=%f\n",	   
+	   sqerr1, sqerr2, sqerr_ran);
+    printf("   GAURAN(Search,Template) = %f, %f \n",
+	   GAURAN_Search, GAURAN_Template );
+    printf("   fluxADU(obs,true) = %f, %f \n",
+	   fluxObs_adu, fluxsn_adu);
+    printf("   Trest=%6.2f  genmag=%6.2f  zHEL=%.4f \n", 
+	   GENLC.epoch8_rest[epoch], genmag, GENLC.REDSHIFT_HELIO );
+    sprintf(c1err,"Invalid sqerr=%le for fluxsn_adu_errSZT", sqsum);
+    sprintf(c2err,"LIBID=%d  MJD=%.3f  band=%c",
+	    GENLC.SIMLIB_ID, mjd, FILTERSTRING[ifilt_obs]);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ;
+  }
+  fluxsn_adu_errSZT = sqrt(sqsum);
 
-// ******************************************
-int gen_cutwin_PEAKMAG(int OPT, int ifilt_obs) {
 
-  // Created Sep 2015
-  // Apply user-specified PEAKMAG cut(s);
-  // return SUCCESS or ERROR.
-  //
-  // OPT=1 --> test with CUTWIN_PEAKMAG
-  // OPT=2 --> test with CUTWIN_PEAKMAG_ALL
-  //
-  // First apply global CUTWIN_PEAKMAG cut.
-  // Then check field-dependent CUTWIN_PEAKMAG_BYFIELD cuts
-  // to apply stricter cut.
-  //
-  // Aug 31 2018: for LCLIB, apply same cut to template mag.
 
-  int PASS = 1;
-  float MLO, MHI ;
-  double MCOR_TRUE_MW  = GENLC.MAGCOR_MWEBV_TRUE[ifilt_obs]; 
-  float  peakmag       = (float)GENLC.peakmag8_obs[ifilt_obs] ;
-  float  mag_T         = (float)GENLC.genmag8_obs_template[ifilt_obs];
+  // Compute reported without ZP error
+  sqerr1  = fluxsn_adu_errS  * fluxsn_adu_errS ;
+  sqerr2  = template_adu_err * template_adu_err ;
+  sqsum   = sqerr1 + sqerr2 + sqerr_ran ;
+  fluxsn_adu_errST = sqrt(sqsum);   // S & T, but no ZP error
 
-// ------------- BEGIN ---------------
+  // store errors for GENLC storage
+  errstat = fluxsn_adu_errST ;   // reported total error without ZP err
+  errtot  = fluxsn_adu_errSZT  ; // includes ZP error
 
-  // correct MWCOR if option is set. Default MCOR is 0
-  peakmag -=  (float)MCOR_TRUE_MW ;
-  mag_T   -=  (float)MCOR_TRUE_MW ;
 
-  if ( OPT == 1 ) {
-    // OR logic; only 1 filter must pass cut
-     MLO     = INPUTS.CUTWIN_PEAKMAG[0] ; 
-     MHI     = INPUTS.CUTWIN_PEAKMAG[1] ; 
+  // @@@@@@@@@@@@@@@@@ LEGACY ERRFUDGE @@@@@@@@@@@@@@@@@@@@@@@@@
+  // Scale reported (not true) errors to better match data
+  if ( INPUTS.FUDGEOPT_FLUXERR > 0 ) {
+    scale_fluxErr = 
+      scale_fluxErrModel_legacy(band,field,mjd,zpt,skysig,psfsig1);
   }
-  else {
-    // AND logic; all filters must pass cut
-     MLO     = INPUTS.CUTWIN_PEAKMAG_ALL[0] ; 
-     MHI     = INPUTS.CUTWIN_PEAKMAG_ALL[1] ; 
+  // @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+  
+  errtot  *= scale_fluxErr ;
+  errstat *= scale_fluxErr ;      
+
+  // check fudge on measured flux-errors (does not affect true errors)
+  errtot    *= INPUTS.FUDGESCALE_FLUXERR2_FILTER[ifilt_obs] ;
+  errstat   *= INPUTS.FUDGESCALE_FLUXERR2_FILTER[ifilt_obs] ; 
+
+ 
+  // check option to ignore source & host error in reported error
+  // (SMP-like)
+  if ( (INPUTS.SMEARFLAG_FLUX & 2) > 0 ) {
+    double sqerr_pe, err_remove, err_orig=errstat;
+    sqerr_pe   = fluxsn_pe + fluxgal_pe ;
+    err_remove = sqrt(sqerr_pe) * NADU_over_Npe ;  
+    errstat    = sqrt(errstat*errstat - err_remove*err_remove);
+    errtot     = sqrt(errtot *errtot  - err_remove*err_remove);
+
+    /*
+    if ( SBmag < 22. ) {
+      printf(" xxx err = %.1f -> %.1f  : err_remove=%.1f \n",
+	     err_orig, errstat, err_remove );
+    }
+    */
   }
 
-  if ( peakmag < MLO ) { PASS = 0 ; }
-  if ( peakmag > MHI ) { PASS = 0 ; }
+  if ( genmag > 600.0 ) 
+    { fluxObs_adu = errtot = errstat = template_adu_err = -9.0 ; }
 
-  // for LCLIB model, check template mags too
-  if ( INDEX_GENMODEL == MODEL_LCLIB ) {
-    if ( mag_T < MLO ) { PASS = 0 ; }
-    if ( mag_T > MHI ) { PASS = 0 ; }
+
+  // --------------------------------------------
+  // Check optional template flux to subtract (for LCLIB model).
+  // Beware that coherent template fluctuations are not included,
+  // so deep templates are assumed.
+  // This template-flux subtraction is done at the very end so that
+  // search-soure noise is included in the Poisson noise.
+  if ( genmag_T < 90.0 ) {
+    fluxObs_adu       -= flux_T ;  // can be pos or neg
+    fluxsn_adu        -= flux_T ;  // true flux without fluctuations
+    SNR_CALC *= ( fluxsn_adu / ( fluxsn_adu + flux_T) ) ;
   }
 
-  // skip FIELD-dependent cuts for AND logic
-  if ( OPT !=1 ) { goto DONE; }
+  // - - - - - - - - - - - - - - - - - - - 
+  // Jan 2018: check for saturation. NPE > 0 --> saturation
+  int npe_above_sat = npe_above_saturation(epoch,fluxsn_pe+fluxgal_pe );
+  GENLC.npe_above_sat[epoch] = npe_above_sat ;
+  if ( npe_above_sat > 0 ) {
+    fluxObs_adu = 0.0 ;
+    errstat = errtot = FLUXCALERR_SATURATE ;
+  }
+  // - - - - - - - - - - - - - - - - - - - 
+
+  // load global GENLC array.
+  GENLC.flux[epoch]         = fluxObs_adu ;        // flux with fluctuation
 
-  // now check field-dependent PEAKMAG cut(s)
-  int  i, N;
-  char *field, *fieldList;
-  N      = INPUTS.NCUTWIN_PEAKMAG_BYFIELD;
-  field  = GENLC.FIELDNAME[0]; // get field from header/1st epoch
+  // store stat error for the flux in ADU;  the FLUXCAL and FLUXCAL_ERR 
+  // (computed later in fluxcal_SNDATA) include the ZPTSIG term.
+  GENLC.flux_errstat[epoch] = errstat ;    // without ZP smear
 
-  for(i=1; i<=N; i++ ) {
-    fieldList = INPUTS.CUTWIN_BYFIELDLIST[i];
-    if ( strstr(fieldList,field) != NULL ) {
-      if ( peakmag < INPUTS.CUTWIN_PEAKMAG_BYFIELD[i][0] ) { PASS = 0 ; }
-      if ( peakmag > INPUTS.CUTWIN_PEAKMAG_BYFIELD[i][1] ) { PASS = 0 ; }
+  // separately store total error that include ZPTSIG term.
+  GENLC.flux_errtot[epoch]  = errtot ; 
 
-      /*
-      printf(" xxx compare '%s' to '%s' (PASS=%d)\n", 
-      field, fieldList, PASS );  */
-    }
-  }
+  
+  // keep track of epoch with max SNR (Jun 2018)
+  SNR = fluxObs_adu/errstat ;
+  if (SNR > GENLC.SNRMAX_GLOBAL) 
+    { GENLC.SNRMAX_GLOBAL = SNR;  GENLC.IEPOCH_SNRMAX = epoch;  }
 
-  // return appropriate function code
- DONE:
+  // store generated/true SNR without fluctuations
+  GENLC.trueSNR[epoch] =  fluxsn_adu/fluxsn_adu_errSZT  ;
 
-  if( PASS ) 
-    { return SUCCESS; }
-  else
-    { return ERROR; }
+  // Aug 24 2014: store ideal/calculated SNR
+  //  Beware that fluxErrModel scale is not included here ; see below.
+  GENLC.SNR_CALC[epoch] = SNR_CALC ;
 
+  // Mar 18 2018: store SNR of fixed monitor mag
+  GENLC.SNR_MON[epoch]  = SNR_MON ;
 
-} // end  gen_cutwin_PEAKMAG
+  // store coherent template error.
+  GENLC.template_err[epoch] = template_adu_err ;
 
-// ******************************************
-void  LOAD_SEARCHEFF_DATA(void) {
+  // debug dump
+  //  LDMP = ( GENLC.SIMLIB_ID == 121 && ifilt_obs==5  ) ;
+  if ( LDMP ) {
 
-  // Created Jan , 2014
-  // Load structures
-  //   - SEARCHEFF_DATA 
-  //   - SEARCHEFF_RANDOMS
-  // to be used by  SEARCHEFF_xxx functions to evaluate
-  // pipeline and SPEC efficiencies.
-  //
-  // Aug 24 2014: 
-  //   major fix, use SNR_CALC instead of measured SNR.
-  //   But for SDSS, keep using measured SNR so that spec-effic is OK.
-  //
-  // Jun 23 2016: load HOSTMAG and HOSTSB
-  // Jan 03 2018: load NPE_SAT
-  // Jan 15 2018: load GENLC.FIELDNAME[0], not FIELDNAME[1]
-  // Jun 18 2018: load SNRMAX
+    printf("\n # ------------------------------------------ \n");
+    printf(" XXX NOISE DUMP  \n");
+    printf(" XXX CID=%d at MJD=%f  ifilt_obs=%d  LIBID=%d\n",
+	   GENLC.CID, mjd, ifilt_obs, GENLC.SIMLIB_ID );
+ 
+    printf(" flux(obs,true) = %f, %f  ADU\n", fluxObs_adu, fluxsn_adu);
+    printf(" err(S,SZ,SZT) = %f, %f, %f \n",
+	   fluxsn_adu_errS, fluxsn_adu_errSZ, fluxsn_adu_errSZT);
+    printf(" sqerr_ran = %f   GAIN=%f\n", sqerr_ran, ccdgain ) ;
 
-  int imjd, EPMIN, EPMAX, ep, NOBS;
-  double flux, flux_err, SNR_CALC, SNR_MEAS, SNR, oldRan, tmpRan ;
+    printf(" FLUX = %f +- %f  ADU \n", 
+	   GENLC.flux[epoch], GENLC.flux_errstat[epoch] );
 
-  // --------------- BEGIN ----------------
+    printf(" psfsig[1,2] = %f, %f pixels  2/1 = %f   \n",
+	   psfsig1, psfsig2, psfratio );
+    printf(" Effective area = %f pixels \n", area_bg );
+    printf(" skysig(S,T) = %.3f , %.3f (ADU/pix) \n", 
+	   skysig, template_skysig) ;
+    printf(" zpt(S,T) = %.3f , %3f \n", zpt, template_zpt);
+    printf(" scale_fluxErr=%.3f   FUDGEOPT_FLUXERR=%d \n",
+	   scale_fluxErr, INPUTS.FUDGEOPT_FLUXERR );
 
-  SEARCHEFF_DATA.CID        = GENLC.CID ;
-  SEARCHEFF_DATA.REDSHIFT   = GENLC.REDSHIFT_HELIO ;
-  SEARCHEFF_DATA.PEAKMJD    = GENLC.PEAKMJD ;
-  SEARCHEFF_DATA.DTPEAK_MIN = GENLC.DTPEAK_MIN ; // closest T-Tpeak
-  SEARCHEFF_DATA.SALT2mB    = GENLC.SALT2mB ;
-  SEARCHEFF_DATA.SNRMAX     = GENLC.SNRMAX_GLOBAL ;
+    printf(" Gain=%f \n", ccdgain);
+    printf(" GUARAN = %f, %f \n", GAURAN_Search, GAURAN_Template );
+    printf(" Noise(src)  = %f  p.e. \n",   
+	   GENLC.NOISE_SN[epoch]*Npe_over_FLUXCAL );
+    printf(" Noise(sky)  = %f  p.e. \n",  
+	   GENLC.NOISE_SKY[epoch]*Npe_over_FLUXCAL );
+    printf(" Noise(tmpl) = %f  p.e.  USEFLAG=%d \n",  
+	   GENLC.NOISE_TEMPLATE[epoch]*Npe_over_FLUXCAL, 
+	   SIMLIB_TEMPLATE.USEFLAG );
+    printf(" Noise(host-phot) = %f  p.e.   (GALMAG=%.2f, SBmag=%.2f)\n",   
+	   GENLC.NOISE_HOSTGAL_PHOT[epoch]*Npe_over_FLUXCAL, GALMAG, SBmag );
+    printf(" Noise(host-image)= %f  p.e. \n",   
+	   GENLC.NOISE_HOSTGAL_IMAGE[epoch]*Npe_over_FLUXCAL );
+    printf(" Noise(CCD sky+tmpl) = %f p.e. \n", 
+	   GENLC.NOISE_CCD[epoch]*Npe_over_FLUXCAL  );
+    printf(" Noise(tot)  = %f  p.e. \n", 
+	   GENLC.NOISE_TOTAL[epoch]*Npe_over_FLUXCAL );
+    printf(" fluxsn_adu_errS = %f ADU \n",  fluxsn_adu_errS );
+    printf(" errtot=%.3f  errstat=%.3f \n", errtot, errstat );
+    debugexit(fnam); 
+  }
 
+  return SUCCESS ;
 
-  sprintf(SEARCHEFF_DATA.FIELDNAME, "%s", GENLC.FIELDNAME[0] );
+}  // end of gen_smearFlux
 
-  NOBS = 0 ;
 
-  for ( imjd = 1; imjd <= GENLC.NEWMJD ; imjd++ ) {
+// **********************************
+int gen_smearMag ( int epoch, int VBOSE) {
 
-    EPMIN = GENLC.EPOCH_RANGE_NEWMJD[imjd][0] ;
-    EPMAX = GENLC.EPOCH_RANGE_NEWMJD[imjd][1] ;
+  // Dec 2011
+  // Convert flux(ADU) and ZP into observed mag and error.
 
-    for ( ep=EPMIN; ep <= EPMAX; ep++ ) {
+  double flux, flux_errtot, flux_errstat, flux_tmp, zpt ;
+  double mag, mag_err , mag_tmp, genmag ;
 
-      if ( GENLC.ISPEAK[ep]     ) { continue ; } // Sep 24 2017
-      if ( GENLC.ISTEMPLATE[ep] ) { continue ; }
+  //  char fnam[] = "gen_smearMag" ;
 
-      SNR_CALC = GENLC.SNR_CALC[ep] ; // Aug 24, 2014
+  // -------------- BEGIN --------------
 
-      flux      = GENLC.flux[ep] ;
-      flux_err  = GENLC.flux_errstat[ep] ;
-      SNR_MEAS  = -9.0 ;
-      if ( flux_err > 0.0 ) { SNR_MEAS = flux / flux_err ; }
-   
-      SNR = SNR_CALC ;
-      
-      // for SDSS, continue using wrong SNR based on measured flux
-      // so that the spec-efficiency function is still correct.
-      if ( strcmp(GENLC.SURVEY_NAME,"SDSS") == 0 ) { SNR = SNR_MEAS; }
+  flux         = GENLC.flux[epoch];
+  flux_errtot  = GENLC.flux_errtot[epoch];
+  flux_errstat = GENLC.flux_errstat[epoch];
+  genmag       = GENLC.genmag8_obs[epoch];
+  zpt          = SIMLIB_OBS_GEN.ZPTADU[epoch] ;
 
-      SEARCHEFF_DATA.IFILTOBS[NOBS]  = GENLC.IFILT_OBS[ep] ;     
-      SEARCHEFF_DATA.MJD[NOBS]       = GENLC.MJD[ep] ;
-      SEARCHEFF_DATA.MAG[NOBS]       = GENLC.genmag8_obs[ep] ; 
-      SEARCHEFF_DATA.SNR[NOBS]       = SNR ;
-      SEARCHEFF_DATA.NPE_SAT[NOBS]   = GENLC.npe_above_sat[ep];
+  // init output
+  GENLC.mag[epoch]      = NULLFLOAT ;     
+  GENLC.mag_err[epoch]  = NULLFLOAT ;     
 
-      oldRan = SEARCHEFF_RANDOMS.PIPELINE[NOBS] ;
-      if ( oldRan < -0.001 ) 
-	{ SEARCHEFF_RANDOMS.PIPELINE[NOBS] = FlatRan1(1);  }
+  if ( flux > 0.0  )
+    { mag = -2.5 * log10(flux) + zpt ; }
+  else
+    { mag = MAG_NEGFLUX ; }
 
-      oldRan = SEARCHEFF_RANDOMS.PHOTPROB[NOBS] ;
-      if ( oldRan < -998.0 && INPUTS_SEARCHEFF.NMAP_PHOTPROB >0 )  { 
-	if ( INPUTS_SEARCHEFF.NREDUCED_CORR_PHOTPROB == 0 ) 
-	  { tmpRan = FlatRan1(1); } // flat randoms [0,1] for uncorrelated
-	else
-	  { tmpRan = GaussRan(1); } // need Gauss-randoms for correlation
-	SEARCHEFF_RANDOMS.PHOTPROB[NOBS] = tmpRan ;
-      }
-      
-      NOBS++ ;
-    }
-  }
-  SEARCHEFF_DATA.NOBS =  NOBS ;
 
+  // now get the mag error by subtracting 1 sigma from observed flux
+  flux_tmp  =  flux - flux_errstat ; 
 
-  // load SPEC-EFF randoms and filter-dependent quantities
+  if ( flux_tmp > 0.0  )
+    { mag_tmp = -2.5 * log10(flux_tmp) + zpt ; }
+  else
+    { mag_tmp = MAG_NEGFLUX ; }
 
-  int ifilt, ifilt_obs ;
+  mag_err = mag_tmp - mag ;
 
-  for ( ifilt=0; ifilt <= MXFILTINDX; ifilt++ ) {
 
-    if ( SEARCHEFF_RANDOMS.SPEC[ifilt] < -0.01 ) 
-      { SEARCHEFF_RANDOMS.SPEC[ifilt]  = FlatRan1(1); }
+  // Jan 22, 2010: preserve mag=666 to indicate filter-problem
+  if ( genmag > 600.0 )  
+    { mag = MAG_UNDEFINED ; mag_err  = MAGERR_UNDEFINED; }
+ 
+  GENLC.mag[epoch]      = mag ;
+  GENLC.mag_err[epoch]  = mag_err ;
 
-    if ( ifilt == MXFILTINDX ) { continue ; } // avoid array overwrite
-    SEARCHEFF_DATA.PEAKMAG[ifilt] = MAG_UNDEFINED ;
-    SEARCHEFF_DATA.HOSTMAG[ifilt] = MAG_UNDEFINED ;
-    SEARCHEFF_DATA.SBMAG[ifilt]   = MAG_UNDEFINED ;
-    
+  if ( GENLC.npe_above_sat[epoch] > 0 ) {
+    //    GENLC.genmag8_obs[epoch]  = MAG_SATURATE ; // xxx delete Sep 3 2018
+    GENLC.mag[epoch]                   = MAG_SATURATE ;
+    GENLC.mag_err[epoch]               = 5.0 ;
   }
 
+  return SUCCESS ;
 
-  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
-      ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
-      /*
-      printf(" xxx ifilt_obs=%d: MAG[PEAK,HOST,SB] = %.3f, %.3f, %.3f \n",
-	     ifilt_obs, GENLC.peakmag8_obs[ifilt_obs],
-	     SNHOSTGAL.GALMAG[ifilt_obs][0], SNHOSTGAL.SB_MAG[ifilt_obs] );
-      */
-      SEARCHEFF_DATA.PEAKMAG[ifilt_obs] =  GENLC.peakmag8_obs[ifilt_obs] ;
-      SEARCHEFF_DATA.HOSTMAG[ifilt_obs] =  SNHOSTGAL.GALMAG[ifilt_obs][0] ;
-      SEARCHEFF_DATA.SBMAG[ifilt_obs] =    SNHOSTGAL.SB_MAG[ifilt_obs];
-  }  // ifilt
-
-  return ;
+} // end of gen_smearMag
 
-} // end of LOAD_SEARCHEFF_DATA
 
-// ******************************************
-void gen_spectype(void) {
+// ****************************************************
+int npe_above_saturation ( int epoch, double flux_pe) {
 
-  // Created July 2011
-  // Major modif. Mar 2013
-  // Set GENLC.SNTYPE based on spec vs. phot typing.
-  //
-  // Jun 7, 2013: 
-  //  - for photoid, add OFFSET_TYPE_PHOT to SNTYPE.
-  //  - set GENLC.SNTYPE for CC as well as for Ia
-  //
+  // Created jan 3 2018
+  // For input epoch index and source flux (p.e.),
+  // return number of photo-electrons above saturation
+  // in central pixel. 
+  //   npe < 0 ==> not saturated
+  //   npe > 0 ==> saturated
   //
-  // Jun 2 2018: if IFLAG_SPEC_EFFZERO, then set PHOTID flag
+  // Used only if NPE_PIXEL_SATURATION key is given in the SIMLIB header.
 
-  int L_PHOTID, ispgen ;
-  char fnam[] = "gen_spectype" ;
+  int npe = -999 ; // default is not saturated
+  int NEXPOSE      = SIMLIB_OBS_GEN.NEXPOSE[epoch] ;
+  int LDMP ;
 
-  // ---------- BEGIN --------------
+  double ccdgain    = SIMLIB_OBS_GEN.CCDGAIN[epoch] ;
+  double skysig_adu = SIMLIB_OBS_GEN.SKYSIG[epoch] ;
+  double psfsig1    = SIMLIB_OBS_GEN.PSFSIG1[epoch] ; // pixels
+  double PIX        = SIMLIB_OBS_GEN.PIXSIZE[epoch];  // pix size, arcsec
+  double PI         = 3.1415926535 ;
 
-  // if SPECTYPE has not been specified, then
-  // leave GENLC.SNTYPE as-is => 100% spec-typing.
-  // However, for SPECTYPE_SEARCH_FLAG, then use search 
-  // eff for spec-typing.
+  double NPE_SAT = SIMLIB_GLOBAL_HEADER.NPE_PIXEL_SATURATE ;
+  double skysig_pe, sky_pe, areaFrac, areaCor, AREAPIX, SQPSFSIG ;
+  double fluxtot_pe, fluxtot_pe_avg;
+  char fnam[] = "npe_above_saturation" ;
+
+  // -------------- BEGIN ------------
 
+  // if no saturation value is given, then never saturate
+  if ( NPE_SAT > 999999999 ) { return(npe); }
 
-  L_PHOTID =  ( INPUTS_SEARCHEFF.NMAP_SPEC > 0  &&
-		GENLC.SEARCHEFF_MASK  != 3  ) ;
+  skysig_pe = (skysig_adu * ccdgain) ;  // convert ADU -> pe
+  sky_pe    = skysig_pe * skysig_pe ;   // sky counts per pix, Npe
 
-  // un 2018: if user forces EFF_SPEC=0 without a map, then we have PHOTID
-  if ( INPUTS_SEARCHEFF.IFLAG_SPEC_EFFZERO ) { L_PHOTID = 1; }
+  // compute fraction of flux contained in 1 pixel at the
+  // center of the PSF.  For pixel size << PSF, flux-fraction
+  // is about PIXSIZE^2/2*PI*sigma^2. For safety, also include
+  // Taylor-expansion correction in areaCor factor below.
+  AREAPIX    = PIX*PIX ;
+  SQPSFSIG   = psfsig1*psfsig1 * AREAPIX ; // arcSec
+  areaCor    =   AREAPIX/(4.0*PI*SQPSFSIG);  // from Taylor expansion
+  areaFrac   = ( AREAPIX/(2.0*PI*SQPSFSIG) ) * ( 1.0 - areaCor );
 
-  ispgen = GENLC.NON1ASED.ISPARSE ;
+  // flux in central pixel
+  fluxtot_pe = (flux_pe*areaFrac) + sky_pe ;
   
+  // divide by number of exposues
+  fluxtot_pe_avg = fluxtot_pe / (double)NEXPOSE ;
 
-  // set SNTYPE 
+  // comput number of photoelectrons above saturation
+  npe = (int)( fluxtot_pe_avg - NPE_SAT);
 
-  if ( INDEX_GENMODEL == MODEL_FIXMAG ) {
-    GENLC.SNTYPE   = MODEL_FIXMAG ;
-    // xxx mark delete    GENLC.SNTYPE   = (int)INPUTS.FIXMAG[0] ;
-  }
-  else if ( LGEN_SNIA )  { 
-    GENLC.SNTYPE   = INPUTS.SNTYPE_Ia_SPEC ; 
-  }
-  else if ( ispgen >=0 ) {
-    GENLC.SNTYPE = INPUTS.NON1ASED.SNTAG[ispgen];
-  }
 
-  // user-defined GENTYPE over-rides any other type (Apr 11 2017)
-  if ( INPUTS.GENTYPE_SPEC > 0 ) {
-    GENLC.SNTYPE = INPUTS.GENTYPE_SPEC ; 
+  LDMP = ( epoch <= -4) ;
+  if ( LDMP ) {
+    int ifilt_obs = GENLC.IFILT_OBS[epoch] ;
+    double genmag = GENLC.genmag8_obs[epoch];
+    printf("\n");
+    printf(" xxx ------------------------------------ \n");
+    printf(" xxx %s DUMP \n", fnam);
+    printf(" xxx INPUTS: epoch=%d  flux_pe=%.1f  NEXPOSE=%d   NPE_SAT=%.0f\n",
+	   epoch, flux_pe, NEXPOSE, NPE_SAT);
+    printf(" xxx genmag = %.2f   ifiltobs=%d \n", genmag, ifilt_obs);
+    printf(" xxx areaCor = %f  areaFrac = %f \n", areaCor, areaFrac );
+    printf(" xxx sky,fluxtot, fluxtot_avg = %.1f, %.1f, %.1f pe \n", 
+	   sky_pe, fluxtot_pe, fluxtot_pe_avg );
+    printf(" xxx npe above saturation :  %d \n", npe ) ;
+    if ( epoch ==4 ) { debugexit(fnam); }
   }
 
- 
-  if ( L_PHOTID ) {
-    // photometric candidate
-    GENLC.METHOD_TYPE = METHOD_TYPE_PHOT ;
-    GENLC.NTYPE_PHOT++ ; 
-    if ( LGEN_SNIA )  
-      { GENLC.SNTYPE = INPUTS.SNTYPE_Ia_PHOT ; }
-    else
-      { GENLC.SNTYPE += OFFSET_TYPE_PHOT ; }
-
-    // check over-ride from GENTYPE (Apr 11 2017)
-    if ( INPUTS.GENTYPE_PHOT > 0 ) 
-      { GENLC.SNTYPE = INPUTS.GENTYPE_PHOT ; }
 
-    setz_unconfirmed();
-  }
-  else { 
-    // spec-confirmed
-    GENLC.REDSHIFT_FLAG = REDSHIFT_FLAG_SNSPEC ; 
-    GENLC.METHOD_TYPE   = METHOD_TYPE_SPEC ;
-    GENLC.NTYPE_SPEC++ ; 
-  }
+  return(npe);
 
+} // end npe_above_saturation
 
-} // end gen_spectype
 
+// **************************************
+void snlc_to_SNDATA(int FLAG) {
 
-// ***************************************
-void  setz_unconfirmed(void) {
 
-  // Use GENLC.SEARCHEFF_MASK (see sntoolc_trigger.c) 
-  // to determine if this UNCONFIRMED SN has a host-galaxy 
-  // redshift ... and if so, apply optional WRONGHOST model.
-  // If there is no zHOST then set measured redshift and
-  // its error to HOST PHOTOZ, or to -9.
+  // load SNDATA struct using info from GENLC structure.
+  // FLAG = 0 => load everything.
+  // FLAG = 1 => load header info only (for fits format)
   //
+  // Set CUTBIT_MASK bits
   //
-  // July 26 2017: 
-  //  Fix bug when there is no zSPEC(SN or host), but there is
-  //  zPhotHost (SNHOSTGAL.ZPHOT).
+  // Feb 23, 2012: store search-run ZPT instead of ZPT for template run
   //
-  // Mar 17 2018: z -> HOST_PHOTOZ if no host-zSPEC
+  // Aug 23, 2012: write file name with %8.8 of NGEN > 1 million
+  //               or if the CIDRAN flag is set.
+  //               Goes with new MXGEN_SIM = 3 million.
   //
-  // May 30 2018: 
-  //  + GENLC.REDSHIFT_CMB[HELIO] -> -9 of ZHOST < 0
-  //    This doesn't fix any bug, but avoids wierd small-negative 
-  //    ZCMB & ZHELIO that look like a bug.
+  // Mar 3 2014: SMEARFLAG_ZEROPT=2 --> report total error.
+  // Nov 23 2014: set PHOTFLAG
+  // Sep 04 2016: SNDATA.MAG computed in fluxcal_SNDATA().
+  // Apr 17 2017: SKY_SIG back to ADU (not FLUXCAL)
+  // Aug 10 2017: abort of NEPOCH>=MXEPOCH to protect SNDATA arrays.
+  // Aug 26 2017: ctmp[60] -> ctmp[200] to handle long model names
+  // Sep 08 2017: load LCLIB info
+  // Sep 20 2017: fix refactor bug setting SURVEY and SUBSURVEY
+  // Mar 02 2018: scale SKYSIG_T to same ZP as SKYSIG_S
+  //              Only affects output to data files.
+  // Jun 01 2018: for LCLIB, set all redshifts and errors to zero
   //
+  // Jul 21 2018: apply MW correction on fluxes (default is no cor)
+  //
+  // Dec 10 2018: load BYOSED info
+  // ---------------------------------------
 
-  double RA        = GENLC.RA ;
-  double DEC       = GENLC.DEC ;
-  double ZPHOT     = SNHOSTGAL.ZPHOT ;
-  double ZPHOT_ERR = SNHOSTGAL.ZPHOT_ERR ;
-  double ZCMB_ORIG = GENLC.REDSHIFT_CMB_SMEAR ;
-  int    FOUND_zHOST ;
-  int LDMP = 0 ;
-  char eq[]   = "eq" ;
-  char fnam[] = "setz_unconfirmed" ;
+  int PHOTFLAG_DETECT  = INPUTS_SEARCHEFF.PHOTFLAG_DETECT;
+  int PHOTFLAG_TRIGGER = INPUTS_SEARCHEFF.PHOTFLAG_TRIGGER ;
 
-  // ---------- BEGIN -------------
-  
-  FOUND_zHOST = ( (GENLC.SEARCHEFF_MASK & APPLYMASK_SEARCHEFF_zHOST) > 0 ) ;
+  int epoch, ifilt, ifilt_obs, NFILT, NPAR, ipar, MSKTMP, istat, zFLAG ;
+  double ZP_S, ZP_T, SKYSIG_T_scale, arg;
+  double MCOR_MAP_MW, MCOR_TRUE_MW ;
   
-  if ( LDMP ) {
-    printf(" xxx -------------------------- \n");
-    printf(" xxx %s: CID=%d  Found_zHOST=%d   CORRECT_HOSTMATCH=%d \n",
-	   fnam, GENLC.CID, FOUND_zHOST, GENLC.CORRECT_HOSTMATCH );
-  }
+  char ctmp[200], ccid[12];
+  char *cptr, *tmpName;
+  char fnam[] = "snlc_to_SNDATA" ;
 
-  if ( FOUND_zHOST ) {
+  // --------------- BEGIN -------------
 
-    GENLC.REDSHIFT_FLAG = REDSHIFT_FLAG_HOSTSPEC ; 
+  // always start with header info
+  SNDATA.SIMLIB_MSKOPT  = INPUTS.SIMLIB_MSKOPT ;
+  sprintf(SNDATA.SIMLIB_FILE,    "%s", INPUTS.SIMLIB_FILE );
 
-    // update only if we have the wrong host
-    if ( !GENLC.CORRECT_HOSTMATCH  ) {
-      GENLC.REDSHIFT_FLAG        = REDSHIFT_FLAG_WRONGHOST ; 
-      GENLC.REDSHIFT_HELIO_SMEAR = SNHOSTGAL.ZSPEC ;  
-      GENLC.REDSHIFT_CMB_SMEAR =  
-	zhelio_zcmb_translator(SNHOSTGAL.ZSPEC, RA,DEC,eq, +1);
 
-      if ( LDMP ) {
-	printf(" xxx zcmb = %.3f(SN) -> %.3f(WRONGHOST) \n", 
-	       ZCMB_ORIG, GENLC.REDSHIFT_CMB_SMEAR); fflush(stdout);
-      }
-    }
+  sprintf(SNDATA.SURVEY_NAME,   "%s", SIMLIB_GLOBAL_HEADER.SURVEY_NAME );
+  sprintf(SNDATA.SUBSURVEY_NAME,"%s", SIMLIB_HEADER.SUBSURVEY_NAME );  
+
+  sprintf(SNDATA.HOSTLIB_FILE,   "%s", INPUTS.HOSTLIB_FILE );
+  sprintf(SNDATA.SIM_MODEL_NAME, "%s", INPUTS.MODELNAME );
+  sprintf(SNDATA_FILTER.LIST,    "%s", INPUTS.GENFILTERS );
+  SNDATA.SIM_MODEL_INDEX    = INDEX_GENMODEL ;
+
+  SNDATA.SIMOPT_FLUXERR     = INPUTS.FUDGEOPT_FLUXERR; // Oct 30 2015
+  SNDATA.SIMOPT_MWCOLORLAW  = INPUTS.OPT_MWCOLORLAW ;
+  SNDATA.SIMOPT_MWEBV       = INPUTS.OPT_MWEBV ;
+  SNDATA.SIM_MWRV           = INPUTS.RV_MWCOLORLAW ;
+  SNDATA.APPLYFLAG_MWEBV    = INPUTS.APPLYFLAG_MWEBV ;
     
-  }
-  else {
-    // no host galaxy redshift (and no SN redshift)
-    SNHOSTGAL.ZSPEC            = -9.0 ;
-    SNHOSTGAL.ZSPEC_ERR        = -9.0 ;
+  SNDATA.SIM_NOBS_UNDEFINED   = GENLC.NOBS_UNDEFINED;
 
-    if ( ZPHOT < 0.0 ) { // if no host photoz ...
-      GENLC.REDSHIFT_FLAG        = REDSHIFT_FLAG_NONE ; 
-      GENLC.REDSHIFT_CMB_SMEAR   = -9.0 ; 
-      GENLC.REDSHIFT_HELIO_SMEAR = -9.0 ; 
-      GENLC.REDSHIFT_SMEAR_ERR   = -9.0 ;
-    } 
-    else {
-      // use zPHOT  here if it is defined
-      GENLC.REDSHIFT_FLAG        = REDSHIFT_FLAG_HOSTPHOT ; 
-      GENLC.REDSHIFT_HELIO_SMEAR = ZPHOT ;
-      GENLC.REDSHIFT_SMEAR_ERR   = ZPHOT_ERR ;
-      GENLC.REDSHIFT_CMB_SMEAR = zhelio_zcmb_translator(ZPHOT,RA,DEC,eq, +1);
+  SNDATA.MJD_TRIGGER          = GENLC.MJD_TRIGGER ;
+
+  // Jul 18,2011: write INPUTS GENFILTERS only
+  // advantage: does not exceed Kcor bound of there are more than
+  //    10 obs-filters defined in the SIMLIB
+  // disadvantage:  cannot combine simulations that generate
+  //   different filter-subsets; i.e., ugr and ugri
+  //
+
+  NFILT = INPUTS.NFILTDEF_OBS ;
+  SNDATA_FILTER.NDEF = NFILT;
+  for (ifilt=0; ifilt < NFILT; ifilt++ ) 
+    { SNDATA_FILTER.MAP[ifilt] = INPUTS.IFILTMAP_OBS[ifilt]; }
+
+
+  // load SIMSED info (for SIMSED model)
+  if ( INDEX_GENMODEL == MODEL_SIMSED ) {
+    NPAR = INPUTS.NPAR_SIMSED ;
+    SNDATA.NPAR_SIMSED = NPAR ;
+    for ( ipar=0; ipar < NPAR; ipar++ ) {
+
+      sprintf(SNDATA.SIMSED_PARNAME[ipar],"%s",
+	      INPUTS.PARNAME_SIMSED[ipar] );
+
+      sprintf(SNDATA.SIMSED_KEYWORD[ipar],"%s(%s)" 
+	      ,INPUTS.KEYWORD_SIMSED[ipar]
+	      ,INPUTS.PARNAME_SIMSED[ipar] );
+
+      SNDATA.SIMSED_PARVAL[ipar]  = GENLC.SIMSED_PARVAL[ipar];
     }
-  }
+  } // model = MODEL_SIMSED
 
-  return ;
 
-} // end of  setz_unconfirmed
+  // load BYOSED info  (Dec 2018)
+  if ( INDEX_GENMODEL == MODEL_BYOSED ) {
+    NPAR = Event_BYOSED.NPAR ;
+    SNDATA.NPAR_BYOSED = NPAR ; 
+    for ( ipar=0; ipar < NPAR; ipar++ ) {
+      tmpName = Event_BYOSED.PARNAME[ipar];
+      sprintf(SNDATA.BYOSED_PARNAME[ipar], "%s", tmpName ) ;
+      sprintf(SNDATA.BYOSED_KEYWORD[ipar], "BYOSED_PARAM(%s)", tmpName);
+      SNDATA.BYOSED_PARVAL[ipar]  = Event_BYOSED.PARVAL[ipar];
+    }
+  } // model = MODEL_BYOSED
 
 
-// ***************************************
-int gen_smearFlux ( int epoch, int VBOSE ) {
+  // load LCLIB info 
+  if ( INDEX_GENMODEL == MODEL_LCLIB ) {
+    NPAR = LCLIB_INFO.NPAR_MODEL_STORE ; 
+    SNDATA.NPAR_LCLIB = NPAR ; 
+    for ( ipar=0; ipar < NPAR; ipar++ ) {
+      tmpName = LCLIB_INFO.PARNAME_MODEL[ipar];
+      sprintf(SNDATA.LCLIB_PARNAME[ipar], "%s", tmpName ) ;
+      sprintf(SNDATA.LCLIB_KEYWORD[ipar],"LCLIB_PARAM(%s)", tmpName);
+      SNDATA.LCLIB_PARVAL[ipar]  = LCLIB_EVENT.PARVAL_MODEL[ipar];
+    }
+  } // model = MODEL_LCLIB
 
+  hostgal_to_SNDATA(FLAG,0);  // for header init only.
 
-  /**********
 
-   Convert generated  "genmag" into observed flux that
-   includes Poisson fluctuations.
+  // #####################################
+
+  if ( FLAG == 1 ) { return ; }
+
+  // #####################################
+
+  VERSION_INFO.N_SNLC       = NGENLC_WRITE ;
+  VERSION_INFO.GENFRAME_SIM = GENFRAME_OPT ;
 
-   Each genmag is converted into flux in ADU and then into 
-   photo-electrons. Error is computed from photo-statistics 
-   of signal, sky, readnoise. An effective aperture of 4*pi*PSF^2 
-   is used fpr sky- and read-noise.
 
-   The flux is smeared based on fluxcal_err which combines
-   photostat error and mag-zeropt error. However, the 
-   calculated flux error "flux_err" includes only the
-   photostat error and not the mag-zeropt error.
+  // do smearing up front to see what's going on.
+ 
+  SNDATA.WRFLAG_BLINDTEST = WRFLAG_BLINDTEST;
 
+  if ( GENLC.NEPOCH >= MXEPOCH ) {
+    printf("\n PRE-ABORT DUMP: \n");
+    printf("\t LIBID=%d  z=%.3f  PEAKMJD=%.3f\n", 
+	   GENLC.SIMLIB_ID, GENLC.REDSHIFT_CMB, GENLC.PEAKMJD );
 
- Mar 1, 2014:
-    - Add coherent template noise from SKY and CCD.
-    - Use pre-computed randoms from
-         GAURAN_Search   = GENLC.RANGauss_NOISE_SEARCH[epoch] ; 
-         GAURAN_Template = GENLC.RANGauss_NOISE_TEMPLATE[ifilt_obs] ;
-      The simlib 'T: ' option is now ignored -> abort in SIMLIB_READ_DRIVER
+    sprintf(c1err,"NEPOCH=%d exceeds bound of MXEPOCH=%d",
+	    GENLC.NEPOCH, MXEPOCH );
+    sprintf(c2err,"Check TREST range, PEAKMJD range and SIMLIB range");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  }
 
-    - Use new SIMLIB_GEN array to get SIMLIB conditions 
+  SNDATA.NEPOCH        = GENLC.NEPOCH ;
+  SNDATA.RA            = GENLC.RA ;
+  SNDATA.DEC           = GENLC.DEC ;
+  SNDATA.SNTYPE        = GENLC.SNTYPE;
+  SNDATA.SIM_TYPE_INDEX  = GENLC.SIMTYPE ;
+  sprintf(SNDATA.SIM_TYPE_NAME, "%s", GENLC.SNTYPE_NAME );
+  
+  if ( WRFLAG_BLINDTEST ) 
+    { SNDATA.FAKE  = FAKEFLAG_LCSIM_BLINDTEST ; }
+  else
+    { SNDATA.FAKE  = FAKEFLAG_LCSIM ; }
 
-    - cleanup and variable name changes; remove 'srun' and 'trun' suffix.
+  if ( WRFLAG_CIDRAN == 0 ) 
+    { SNDATA.CID  = GENLC.CID ; }
+  else 
+    { SNDATA.CID  = GENLC.CIDRAN ; }
+  
 
- 
-  Aug 21 2014: compute anomalous host-subtraction noise "sqhostNoise_pe".
-               See sim-input key HOSTNOISE_FILE.
+  sprintf(SNDATA.CCID,      "%d", SNDATA.CID ) ;
+  sprintf(SNDATA.IAUC_NAME, "%s", "NULL" );
 
-  Mar 3 2015: pass SBmag to GEN_NOISEMODEL_HOST().
+  SNDATA.SUBSAMPLE_INDEX = GENLC.SUBSAMPLE_INDEX ;
 
-  Sep 2017: for LCLIB model, subtract template flux. Note that 
-            Search-flux can be negative !
+  // Hard-wire legacy search type used by the SDSS
+  // Users really should set "SNTYPE_Ia:  120" in the SDSS sim-input file.
+  if ( strcmp(SNDATA.SURVEY_NAME,"SDSS") == 0  ) {
+    SNDATA.SEARCH_TYPE   = 120 ;  // type Ia
+    if ( INDEX_GENMODEL == MODEL_NON1ASED ) { SNDATA.SEARCH_TYPE  = 110 ; }
+    if ( INDEX_GENMODEL == MODEL_NON1AGRID) { SNDATA.SEARCH_TYPE  = 110 ; }
+    if ( SNDATA.SNTYPE < 0 ) 
+      { SNDATA.SNTYPE = SNDATA.SEARCH_TYPE ; }
+  }
 
-  Oct 6 2017: update SNR_CALC after subtracting optional template flux
+  SNDATA.NOBS                = GENLC.NOBS ; // 5/26/2011
 
-  Oct 31 2017: if sqsum < 0, set sqsum = small positive number
-              (prevents abort)
+  SNDATA.REDSHIFT_FINAL      = GENLC.REDSHIFT_CMB_SMEAR ;
+  SNDATA.REDSHIFT_HELIO      = GENLC.REDSHIFT_HELIO_SMEAR ;
+  SNDATA.REDSHIFT_FINAL_ERR  = GENLC.REDSHIFT_SMEAR_ERR ;
+  SNDATA.REDSHIFT_HELIO_ERR  = GENLC.REDSHIFT_SMEAR_ERR ;
+  SNDATA.VPEC                = GENLC.VPEC_SMEAR;
+  SNDATA.VPEC_ERR            = INPUTS.VPEC_ERR;
 
-  Feb 14 2018: minor refactor/cleanup to prepare for FLUXERRMODEL.
-               "errtot" is used along with errstat.
+  SNDATA.SIM_SEARCHEFF_MASK  = GENLC.SEARCHEFF_MASK ;
+  SNDATA.SIM_SEARCHEFF_SPEC  = GENLC.SEARCHEFF_SPEC ;
+  SNDATA.SIM_SEARCHEFF_zHOST = GENLC.SEARCHEFF_zHOST ;
 
-  Feb 28 2018: 
-   For LCLIB model and SMEARFLAG_ZEROPT, fix bug by subtracting
-   flux_T before taking relErr. Also note that flux_T is computed
-   earlier than before. Bug found by Gautham.
+  // assign photoz to REDSHIFT_FINAL if Zspec error is >= 1
+  if ( GENLC.REDSHIFT_SMEAR_ERR > 0.999  ) {
+    SNDATA.REDSHIFT_FINAL      = SNHOSTGAL.ZPHOT ;
+    SNDATA.REDSHIFT_FINAL_ERR  = SNHOSTGAL.ZPHOT_ERR ;
 
- Mar 03 2018: GENLC.NOISE_XXX -> FLUXCAL units instead of p.e.
+    SNDATA.REDSHIFT_HELIO      = SNHOSTGAL.ZPHOT ;
+    SNDATA.REDSHIFT_HELIO_ERR  = SNHOSTGAL.ZPHOT_ERR ;
+  }
 
- Mar 05 2018: check option to ignore source & galaxy in reported
-              errors (INPUTS.SMEARFLAG_FLUX & 2) 
+  if ( INPUTS.NGENTOT_LC > 1000000 || 
+       INPUTS.NGEN_LC    > 1000000 || 
+       WRFLAG_CIDRAN     > 0 ) {
+    sprintf(ccid, "%8.8d", SNDATA.CID );
+  }
+  else {
+    sprintf(ccid, "%6.6d", SNDATA.CID );
+  }
+  sprintf(SNDATA.snfile_output, "%s_SN%s.DAT",
+	  INPUTS.GENPREFIX, ccid );
+  sprintf(SNDATA.SNFILE_OUTPUT, "%s/%s",
+	  PATH_SNDATA_SIM, SNDATA.snfile_output );
 
- Mar 18 2018: compute GENLC.SNR_MON for mag = INPUTS.MAGMONITOR_SNR
+  sprintf(SNDATA.MAGREF, "%s", GENLC.primary );
 
-  **********************************/
+  // load SIM_XXX info
 
-  // define args stripped from GENLC structure
+  if ( INPUTS.NON1A_MODELFLAG > 0 ) 
+    { sprintf(ctmp,"MODEL = %s", GENLC.SNTEMPLATE ); }
+  else
+    {  sprintf(ctmp,"MODEL = %s", INPUTS.MODELNAME ); }
+  sprintf(SNDATA.SIM_COMMENT, "SN Type = %s , %s", GENLC.SNTYPE_NAME, ctmp );
 
-  int ifilt_obs, ifilt, ifield, LDMP=0, GALID, OVP ;
+  SNDATA.SIM_LIBID           = GENLC.SIMLIB_ID;
+  SNDATA.SIM_NGEN_LIBID      = GENLC.NGEN_SIMLIB_ID;
+  SNDATA.SIM_REDSHIFT_CMB    = GENLC.REDSHIFT_CMB ;
+  SNDATA.SIM_REDSHIFT_HELIO  = GENLC.REDSHIFT_HELIO ;
+  SNDATA.SIM_REDSHIFT_HOST   = GENLC.REDSHIFT_HOST ; // Jan 2016
 
-  double 
-    genmag, genmag_T
-    ,ccdgain, readnoise, skysig, psfsig1, psfsig2, psfratio, zpt, zptsig  
-    ,ZPTDIF_pe, Npe_over_FLUXCAL, ZPTDIF_ADU, NADU_over_FLUXCAL, NADU_over_Npe
-    ,template_readnoise, template_skysig, template_zpt
-    ,zsn, psfsig_arcsec, psfFWHM_arcsec, galmag, GALMAG, SBmag
-    ;
+  // 4.19.2019: store redshift flag to indicate where redshift is from
+  zFLAG = GENLC.REDSHIFT_FLAG;
+  if ( zFLAG >= 0 ) {
+    SNDATA.SIM_REDSHIFT_FLAG   = zFLAG ;
+    sprintf(SNDATA.SIM_REDSHIFT_COMMENT,"%s", STRING_REDSHIFT_FLAG[zFLAG] );
+  }
 
-  // Note three types of errors:
-  //   errS   = search error only  (source+sky+host)
-  //   errSZ  = search error + ZPsmear
-  //   errSZT = search error + ZPsmear + template error
-  
-  // local variables   
-  double 
-    arg, mjd, fluxObs_adu
-    ,fluxsn_pe,  fluxsn_pe_err, fluxgal_pe, fluxmon_pe
-    ,fluxsn_adu, fluxsn_adu_errS, fluxsn_adu_errSZ, fluxsn_adu_errSZT
-    ,fluxsn_adu_errST, fluxsn_adu_errZ, flux_T 
-    ,sqskyerr_pe, template_sqskyerr_pe, template_sqerr_pe
-    ,sqccderr_pe, template_sqccderr_pe
-    ,sqImageNoise_pe, fluxsn_adu_errData
-    ,template_pe_err, template_adu_err, fluxsn_adu_errReal
-    ,sqadderr_pe, area_bg
-    ,mag_smear, magerr_tmp, fluxErr_tmp, sqerr_tmp, skysig_tmp_pe
-    ,sqsum, sqerr, sqerr1, sqerr2, sqerr_ran
-    ,err1, err2, relerr, errtmp, errtot, errstat, pixsize
-    ,xt, zptfac, crazyflux, Trest, Tobs
-    ,fluxerrCor, SNR_CALC, SNR_MON, SNR
-    ,GAURAN_Search, GAURAN_ZP, GAURAN_Template
-    ,snsep, HOSTNOISE_FLUXCAL, HOSTNOISE_ERRSCALE, HOSTNOISE_pe
-    ,noisePar[10]
-    ;
+  SNDATA.SIM_VPEC         = GENLC.VPEC ;
+  SNDATA.SIM_DLMU         = GENLC.DLMU ; 
+  SNDATA.SIM_LENSDMU      = GENLC.LENSDMU ;
+  SNDATA.SIM_RA           = GENLC.RA ;
+  SNDATA.SIM_DEC          = GENLC.DEC ;
+  SNDATA.SIM_AVTAU        = GENLC.AVTAU ;
+  SNDATA.SIM_MWEBV        = GENLC.MWEBV_SMEAR ; // use smeared MWEBV
+  SNDATA.SIM_PEAKMJD      = GENLC.PEAKMJD ;
 
-  double scale_fluxErr = 1.0 ;
-  char field[MXCHAR_FIELDNAME], band[4];
-  char fnam[] = "gen_smearFlux" ;
+  SNDATA.PIXSIZE          = SIMLIB_OBS_GEN.PIXSIZE[1];
+  SNDATA.CCDNUM[0]        = SIMLIB_HEADER.CCDNUM ;
+  SNDATA.SIM_AV           = GENLC.AV ;
+  SNDATA.SIM_RV           = GENLC.RV ;
 
-  // ----------------- BEGIN --------------
+  if ( INDEX_GENMODEL == MODEL_STRETCH ) 
+    {  SNDATA.SIM_STRETCH  = GENLC.STRETCH ; }
 
-  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID  ) { return SUCCESS; }
+  if ( INDEX_GENMODEL == MODEL_MLCS2k2 ) 
+    { SNDATA.SIM_DELTA    = GENLC.DELTA ; }
 
-  // strip GENLC info into local variables.
+  if ( INDEX_GENMODEL == MODEL_SNOOPY ) 
+    { SNDATA.SIM_DM15 = GENLC.DM15 ; }
 
-  ifilt_obs      = GENLC.IFILT_OBS[epoch] ;
-  ifilt = GENLC.IFILTINVMAP_OBS[ifilt_obs] ; // sparse index
-  sprintf(band, "%c", FILTERSTRING[ifilt_obs] );
+  if ( INDEX_GENMODEL == MODEL_S11DM15 ) 
+    { SNDATA.SIM_DM15 = GENLC.DM15 ; }
 
-  genmag         = GENLC.genmag8_obs[epoch];
-  mag_smear      = GENLC.magsmear8[epoch];
-  zsn            = GENLC.REDSHIFT_HELIO ;
-  sprintf(field,"%s", GENLC.FIELDNAME[epoch] );
-  ifield         = IFIELD_OVP_SIMLIB(1,field);
-  if ( ifield < 0 ) { ifield=0; } // Nov 2016: needed for GAURAN_TEMPLATE
 
-  mjd        = SIMLIB_OBS_GEN.MJD[epoch] ;
-  pixsize    = SIMLIB_OBS_GEN.PIXSIZE[epoch] ;
-  ccdgain    = SIMLIB_OBS_GEN.CCDGAIN[epoch] ;
-  skysig     = SIMLIB_OBS_GEN.SKYSIG[epoch] ;
-  readnoise  = SIMLIB_OBS_GEN.READNOISE[epoch] ;
-  psfsig1    = SIMLIB_OBS_GEN.PSFSIG1[epoch] ; // pixels
-  psfsig2    = SIMLIB_OBS_GEN.PSFSIG2[epoch] ;
-  psfratio   = SIMLIB_OBS_GEN.PSFRATIO[epoch] ;
-  zpt        = SIMLIB_OBS_GEN.ZPTADU[epoch] ;
-  zptsig     = SIMLIB_OBS_GEN.ZPTSIG[epoch] ;
-  
-  GALID   = SNHOSTGAL.GALID ;
-  GALMAG  = SNHOSTGAL.GALMAG[ifilt_obs][0] ; // full galaxy mag
-  SBmag   = SNHOSTGAL.SB_MAG[ifilt_obs]  ;   // in 1 sq arcsec
-  if ( SBmag > 32.0 ) { SBmag = 32.0; }      // to limit fluxerrmap size
-  snsep   = SNHOSTGAL.SNSEP ;                // SN-host sep, arcsec
+  SNDATA.SIM_SALT2x0          = GENLC.SALT2x0 ; 
+  SNDATA.SIM_SALT2x1          = GENLC.SALT2x1 ; 
+  SNDATA.SIM_SALT2c           = GENLC.SALT2c  ; 
+  SNDATA.SIM_SALT2mB          = GENLC.SALT2mB ; 
+  SNDATA.SIM_SALT2alpha       = GENLC.SALT2alpha ; 
+  SNDATA.SIM_SALT2beta        = GENLC.SALT2beta ; 
+  SNDATA.SIM_TEMPLATE_INDEX   = GENLC.TEMPLATE_INDEX ; 
+  SNDATA.SIM_MAGSMEAR_COH     = GENLC.MAGSMEAR_COH ;
+  SNDATA.SIM_SNMAGSHIFT_HOSTCOR = GENLC.SNMAGSHIFT_HOSTCOR ;
+  SNDATA.SIM_RISETIME_SHIFT   = GENLC.RISETIME_SHIFT ;
+  SNDATA.SIM_FALLTIME_SHIFT   = GENLC.FALLTIME_SHIFT ;
+  SNDATA.SIM_TRESTMIN         = GENLC.TRESTMIN ;
+  SNDATA.SIM_TRESTMAX         = GENLC.TRESTMAX ;
 
-  template_skysig     = SIMLIB_OBS_GEN.TEMPLATE_SKYSIG[epoch] ; 
-  template_readnoise  = SIMLIB_OBS_GEN.TEMPLATE_READNOISE[epoch] ; 
-  template_zpt        = SIMLIB_OBS_GEN.TEMPLATE_ZPT[epoch] ;
+  // set GALID here in case HOSTLIB_USE=0 in hostgal_to_SNDATA
+  if ( SNHOSTGAL.GALID>0 ) 
+    { SNDATA.HOSTGAL_NMATCH[0]=1 ; SNDATA.HOSTGAL_NMATCH[1]=1 ; }
+  SNDATA.HOSTGAL_OBJID[0]   = SNHOSTGAL.GALID ;
 
-  genmag_T = GENLC.genmag8_obs_template[ifilt_obs]; // Sep 2017/LCLIB
-  flux_T   = 0.0 ;
-  if ( genmag_T < 90.0 ) {
-    arg     = 0.4 * ( zpt - genmag_T );
-    flux_T  = pow(10.0,arg);        // flux in ADUs    
-  }
+  // st HOSTLIB variables
+  ifilt_obs=0 ;  hostgal_to_SNDATA(FLAG,ifilt_obs);
 
-  xt = INPUTS.EXPOSURE_TIME_FILTER[ifilt_obs] ; // for error check only
-  if ( xt < 1.0 ) { xt = 1.0 ; }
+  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
+    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];  
 
-  // compute zp in photo-electrons in case we need to 
-  // convert a FLUXCAL quantity back into pe.
-  ZPTDIF_ADU = zpt - ZEROPOINT_FLUXCAL_DEFAULT ;
-  NADU_over_FLUXCAL = pow( TEN , 0.4*ZPTDIF_ADU) ;
-  Npe_over_FLUXCAL  = NADU_over_FLUXCAL * ccdgain;
-  NADU_over_Npe     = NADU_over_FLUXCAL/Npe_over_FLUXCAL ;  
+    MCOR_TRUE_MW  = GENLC.MAGCOR_MWEBV_TRUE[ifilt_obs]; 
+    MCOR_MAP_MW   = GENLC.MAGCOR_MWEBV_MAP[ifilt_obs];
 
-  // init output
-  GENLC.flux[epoch]         = NULLFLOAT ; 
-  GENLC.flux_errstat[epoch] = NULLFLOAT ;     
-  GENLC.flux_errtot[epoch]  = NULLFLOAT ;     
+    SNDATA.SIM_PEAKMAG[ifilt_obs]     
+      = (float)( GENLC.peakmag8_obs[ifilt_obs] - MCOR_TRUE_MW) ;
 
-  // bail on bad input or non-existant peak epoch
-  int SKIPIT = 0;
-  if ( GENLC.ISPEAK[epoch]      )  { SKIPIT = 1 ; }
-  if ( GENLC.ISTEMPLATE[epoch]  )  { SKIPIT = 1 ; }
-  if ( zpt     < 10.0   )          { SKIPIT = 1 ; }
-  if ( psfsig1 < 0.0001 )          { SKIPIT = 1 ; }
-  if ( skysig  < 0.0001 )          { SKIPIT = 1 ; }
-  if ( SKIPIT ) {    return ERROR ;  }
+    SNDATA.SIM_TEMPLATEMAG[ifilt_obs]       // LCLIB source mag in template
+      = (float)GENLC.genmag8_obs_template[ifilt_obs] - MCOR_MAP_MW ;
 
+    SNDATA.SIM_EXPOSURE_TIME[ifilt_obs]  = 
+      INPUTS.EXPOSURE_TIME_FILTER[ifilt_obs] ; 
 
-  // use search-run zero-point to convert mag -> flux.
-  arg           = 0.4 * ( zpt - genmag );
-  fluxsn_adu    = pow(10.0,arg);         // flux in ADUs
-  fluxsn_pe     = fluxsn_adu * ccdgain ; // flux in pe
-  
-  // compute optional signal for monitor mag
-  if ( INPUTS.MAGMONITOR_SNR > 10 ) {
-    double magmon = (double)INPUTS.MAGMONITOR_SNR ;
-    arg           = 0.4 * ( zpt - magmon );
-    fluxmon_pe    = ccdgain * pow(10.0,arg); 
-  }
 
-  // ################ GET FLUX STAT-ERROR ##################
+    hostgal_to_SNDATA(FLAG,ifilt_obs);
 
-  // get effective aperture  area (pixels)
-  area_bg = NoiseEquivAperture(psfsig1, psfsig2, psfratio );
-  psfsig_arcsec = pixsize * sqrt(area_bg/(2.0*TWOPI))  ; 
-  psfFWHM_arcsec = 2.3548 * psfsig_arcsec ;
+  } // end of ifilt if-block
 
-  // get total sky noise for search run; includes sky & CCD noise
-  skysig_tmp_pe = skysig * ccdgain ;  // convert ADU -> pe
-  sqskyerr_pe = area_bg * (skysig_tmp_pe*skysig_tmp_pe);
-  sqccderr_pe = area_bg * (readnoise*readnoise) ;  // in Npe
 
 
-  // Apri 26 2016: optional non-linearity bias to signal (NONLINEARITY_FILE)
-  double scale_nonLin = GET_NONLIN(band, fluxsn_pe, sqskyerr_pe, genmag);
-  if ( fabs(scale_nonLin-1.0) > 1.0E-7 ) {
-    fluxsn_pe   *= scale_nonLin ;
-    fluxsn_adu  *= scale_nonLin ;
-    sqskyerr_pe *= scale_nonLin ;
-    sqccderr_pe *= scale_nonLin ;
+  SNDATA.MWEBV      = GENLC.MWEBV;      // reported MWEBV from Shlagel map
+  SNDATA.MWEBV_ERR  = GENLC.MWEBV_ERR ; // reported error
+  SNDATA.APPLYFLAG_MWEBV = INPUTS.APPLYFLAG_MWEBV ;
+    
+  // load NEWMJD info
+  SNDATA.NEWMJD = GENLC.NEWMJD ;
+  for ( epoch = 1; epoch <= GENLC.NEWMJD ; epoch++ ) {
+    SNDATA.EPOCH_RANGE_NEWMJD[epoch][0] = 
+      GENLC.EPOCH_RANGE_NEWMJD[epoch][0] ;
+    SNDATA.EPOCH_RANGE_NEWMJD[epoch][1] = 
+      GENLC.EPOCH_RANGE_NEWMJD[epoch][1] ;
   }
 
-  // add sky-noise from template, integrated over effective aperture 
-  template_pe_err = template_sqskyerr_pe = template_sqccderr_pe = 0.0 ;
-  template_sqerr_pe = 0.0 ;
 
-  if ( SIMLIB_TEMPLATE.USEFLAG && template_skysig > 0.0 ) {
-    if ( template_zpt < 10.0 ) {
-      sprintf(c1err,"Invalid template_zpt(%c)=%f for  LIBID=%d at MJD=%.3f", 
-	      FILTERSTRING[ifilt_obs], template_zpt, GENLC.SIMLIB_ID, mjd );
-      sprintf(c2err,"Need TEMPLATE_ZPT to scale template noise.");
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
+  // covmat-scatter info
+  int iscat ;
+  if ( INPUTS.NCOVMAT_SCATTER > 0 ) {
+    SNDATA.SIMFLAG_COVMAT_SCATTER = 1 ;
+    for ( iscat=0; iscat < 3 ; iscat++ ) {
+      SNDATA.SIM_COVMAT_SCATTER[iscat] = 
+	GENLC.COVMAT_SCATTER[iscat] ;
+      cptr = SNDATA.SIM_COVMAT_SCATTER_NAME[iscat];
+      sprintf(cptr,"%s", GENLC.COVMAT_SCATTER_NAME[iscat] );
     }
+  }
 
-    skysig_tmp_pe = template_skysig * ccdgain ;  // convert sigma in ADU -> pe.
-    template_sqskyerr_pe = area_bg * (skysig_tmp_pe*skysig_tmp_pe) ;
-    template_sqccderr_pe = area_bg * (template_readnoise*template_readnoise);
+  // load epoch info
 
-    // scale template noise to the search image
-    double zparg, zfac;
-    zparg = 0.8*(zpt - template_zpt); // Feb 2 2017 bug fix
-    zfac  = pow(TEN, zparg);
-    template_sqskyerr_pe *= zfac ;
-    template_sqccderr_pe *= zfac ;
 
-    template_sqerr_pe = template_sqccderr_pe + template_sqskyerr_pe ;
-    template_pe_err   = sqrt(template_sqerr_pe) ;
-  }
+  for ( epoch = 1; epoch <= GENLC.NEPOCH ; epoch++ ) {
 
+    SNDATA.USE_EPOCH[epoch] = GENLC.USE_EPOCH[epoch] ;
 
-  // @@@@@@@@@@@@ LEGACY ERRFDUGE @@@@@@@@@@@@@@
-  // Feb 2012: add FLUXERR_ADD in quadrature
-  // Jan 2014: require EXPOSURE_TIME=1 to implement; avoid crazy error
-  double  ERR_CAL, ERR_pe, XT ;
-  ERR_CAL  = GENLC.SIMLIB_FLUXERR_ADDPAR[ifilt_obs];
-  XT       = INPUTS.EXPOSURE_TIME_FILTER[ifilt_obs] ; // Jan 2014
-  sqadderr_pe = 0.0 ;
-  if ( SIMLIB_FLUXERR_COR.USE  && ERR_CAL >1.E-6  &&   XT == 1.0 ) {
-    // translate ERR_CAL from FLUXCAL back to p.e.
-    ERR_pe      = ERR_CAL * Npe_over_FLUXCAL ;
-    sqadderr_pe = (ERR_pe * ERR_pe) ;
-  }
-  // @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+    if ( GENLC.ISPEAK[epoch]      ) { continue ; }
+    if ( GENLC.ISTEMPLATE[epoch]  ) { continue ; }
 
+    ifilt_obs    = GENLC.IFILT_OBS[epoch];
+      
+    SNDATA.FILTINDX[epoch]  = ifilt_obs ;
+    sprintf(SNDATA.FILTCHAR[epoch], "%c",  FILTERSTRING[ifilt_obs] );
 
+    MCOR_TRUE_MW  = GENLC.MAGCOR_MWEBV_TRUE[ifilt_obs]; 
+    MCOR_MAP_MW   = GENLC.MAGCOR_MWEBV_MAP[ifilt_obs];
 
-  // -------------------------------------------
-  // galaxy noise from photo-stats
-  fluxgal_pe = 0.0;
+    SNDATA.SIMEPOCH_TREST[epoch]  = GENLC.epoch8_rest[epoch] ;
+    SNDATA.SIMEPOCH_TOBS[epoch]   = GENLC.epoch8_obs[epoch] ;
+    SNDATA.SIMEPOCH_MAG[epoch]    = GENLC.genmag8_obs[epoch] - MCOR_TRUE_MW ;
+    SNDATA.SIMEPOCH_MODELMAGERR[epoch] = GENLC.generr8_rest[epoch] ;
+    SNDATA.SIMEPOCH_MAGSMEAR[epoch] = GENLC.magsmear8[epoch] ;
+    SNDATA.SIMEPOCH_FLUXCAL_HOSTERR[epoch] = GENLC.NOISE_HOSTGAL_PHOT[epoch];
 
-  OVP = INPUTS.SMEARFLAG_HOSTGAL & SMEARMASK_HOSTGAL_PHOT ;
-  if ( OVP > 0 ) {
-    // get galmag and SN-host sep:  4*PI*PSF^2 = area
-    galmag        = interp_GALMAG_HOSTLIB(ifilt_obs, psfsig_arcsec );
-    arg           = 0.4 * ( zpt - galmag );
-    fluxgal_pe    = ccdgain * pow(10.0,arg);   // effec-aper flux in pe.
-  }
+    SNDATA.MJD[epoch]          = GENLC.MJD[epoch];
 
-  // @@@@@@@@@@@@@@@@@ LEGACY ERRFUDGE @@@@@@@@@@@@@@@@@@@@@@@@@
-  // Aug 2014: anomolous host-subtraction noise (HOSTNOISE_FILE)
-  //           Note the dependence on both band and field.
-  OVP = INPUTS.SMEARFLAG_HOSTGAL & SMEARMASK_HOSTGAL_IMAGE ;
-  sqImageNoise_pe = 0.0 ;
-  HOSTNOISE_pe    = HOSTNOISE_FLUXCAL = 0.0 ;
-  if ( OVP ) {    
-    GEN_NOISEMODEL_HOST_LEGACY(band,field,GALID,GALMAG,SBmag,snsep, 
-			       noisePar);  // <== return this array
+    SNDATA.CLOUDCAM_SIG[epoch]    = GENLC.cloudsig[epoch] ;
+    SNDATA.CLOUDCAM_AVG[epoch]    = GENLC.cloudavg[epoch] ;
+    SNDATA.MOONPHASE[epoch]       = GENLC.moonphase[epoch] ;
+    SNDATA.MOONDIST[epoch]        = GENLC.moondist[epoch] ;
 
-    HOSTNOISE_FLUXCAL  = noisePar[0] ; // add this noise, per pixel
-    HOSTNOISE_ERRSCALE = noisePar[1] ; // scale on added sky noise
+    sprintf(SNDATA.TELESCOPE[epoch], "%s", GENLC.TELESCOPE[epoch] );
+    sprintf(SNDATA.FIELDNAME[epoch], "%s", GENLC.FIELDNAME[epoch] );
 
-    // convert extra noise in FLUXCAL unit to Npe (per pixel)
-    HOSTNOISE_pe    = HOSTNOISE_FLUXCAL * Npe_over_FLUXCAL ;
+    SNDATA.GAIN[epoch]      =  SIMLIB_OBS_GEN.CCDGAIN[epoch] ;
+    SNDATA.READNOISE[epoch] =  SIMLIB_OBS_GEN.READNOISE[epoch] ;
 
-    double SQ0 = HOSTNOISE_pe * HOSTNOISE_pe ;
-    double SQ1 = HOSTNOISE_ERRSCALE * HOSTNOISE_ERRSCALE ;
+    // -------------------------------
+    // PHOTFLAG_DETECT is the optional mask to set for each detection;
+    // detectFlag = 0,1 for undetected/detected. Note the epoch offset
+    // bewteen the SNDATA and SEARCHEFF_DATA structures
+    MSKTMP = SEARCHEFF_DATA.detectFlag[epoch-1];
+    if ( (MSKTMP & 1)>0  &&  PHOTFLAG_DETECT>0 ) 
+      { SNDATA.PHOTFLAG[epoch] += PHOTFLAG_DETECT ; } 
 
-    sqImageNoise_pe  = 
-      (area_bg * SQ0)  +                       // quadrature model
-      (sqskyerr_pe+fluxgal_pe)*(SQ1-1.0)  ;    // err-scale;
-  }
-  // @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+    if ( (MSKTMP & 2)>0  &&  PHOTFLAG_TRIGGER>0 ) 
+      { SNDATA.PHOTFLAG[epoch] += PHOTFLAG_TRIGGER ; } 
 
-  // --------------------
-  // add up SN flux error (photo-electrons^2) in quadrature
-  // Do not include correlated template noise here.
-  sqsum 
-    = fluxsn_pe        // signal stat-error
-    + sqskyerr_pe      // sky-err from search run
-    + sqccderr_pe      // CCD read noise (added Dec 13, 2010)
-    + sqadderr_pe      // from FLUXERR_ADD key in simlib
-    + fluxgal_pe       // square of host galaxy stat-error
-    ;
+    // Jan 17 2018: check appended observations
+    int APP = SIMLIB_OBS_GEN.APPEND_PHOTFLAG[epoch] ;
+    if ( APP > 0 ) 
+      { SNDATA.PHOTFLAG[epoch] += APP ; }
 
-  // net search stat error in photoelectrons (no template)
-  fluxsn_pe_err = sqrt ( sqsum ) ;  
+    if ( GENLC.npe_above_sat[epoch] > 0 ) 
+      { SNDATA.PHOTFLAG[epoch] += SIMLIB_GLOBAL_HEADER.PHOTFLAG_SATURATE; }
 
-  // -------------------------------------------
-  // compute calculated SNR to use in lookup maps;
-  // include coh template noise, but ignore anomalous image noise.
-  SNR_CALC      = fluxsn_pe / sqrt(sqsum + template_sqskyerr_pe );
- 
-  if ( INPUTS.MAGMONITOR_SNR > 10 ) {
-    double sqsum_mon = sqsum - fluxsn_pe + fluxmon_pe ;
-    SNR_MON = fluxmon_pe / sqrt(sqsum_mon + template_sqskyerr_pe );
-  }
-  else
-    { SNR_MON = 0.0 ; }
+    if ( GENLC.IEPOCH_SNRMAX == epoch ) 
+      { SNDATA.PHOTFLAG[epoch] += SIMLIB_GLOBAL_HEADER.PHOTFLAG_SNRMAX ; }
 
-  // @@@@@@@@@@@@@@@@@ LEGACY ERRFUDGE @@@@@@@@@@@@@@@@@@@@@@@@@
-  // check optional correction from simlib map
-  fluxerrCor     = get_SIMLIB_fluxerrScale_LEGACY(ifilt_obs, SNR_CALC );    
-  fluxsn_pe_err *= fluxerrCor;
-  // @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+    if ( GENLC.IEPOCH_NEARPEAK == epoch ) 
+      { SNDATA.PHOTFLAG[epoch] += SIMLIB_GLOBAL_HEADER.PHOTFLAG_NEARPEAK ; }
 
+    // load photProb
+    SNDATA.PHOTPROB[epoch] = SEARCHEFF_DATA.PHOTPROB[epoch-1] ;
 
-  // Nov 2016: apply user-optional magErr fudge in quadrature (default=0)
-  magerr_tmp = INPUTS.FUDGE_MAGERR_FILTER[ifilt_obs]; 
-  if ( magerr_tmp > 1.0E-9 ) {
-    fluxErr_tmp   = fluxsn_pe * ( 1.0 - pow(10.0,-0.4*magerr_tmp)) ;
-    sqerr_tmp     = fluxErr_tmp * fluxErr_tmp ;
-    fluxsn_pe_err = sqrt(fluxsn_pe_err*fluxsn_pe_err + sqerr_tmp);
-  }
-  // Optional errscale fudge (default=1) applied to true and reported errors.
-  fluxsn_pe_err   *= INPUTS.FUDGESCALE_FLUXERR_FILTER[ifilt_obs] ;
-  template_pe_err *= INPUTS.FUDGESCALE_FLUXERR_FILTER[ifilt_obs] ;
+    // - - - - - - - - -  -
+    double diff = SNDATA.MJD[epoch] - SEARCHEFF_DATA.MJD[epoch-1] ;
+    if ( diff != 0.0 ) {
+      printf("\n PRE-ABORT DUMP: \n");
+      printf("   SNDATA.MJD[%d]=%.4f   SEARCHEFF_DATA.MJD[%d]=%.4f\n",
+	     epoch, SNDATA.MJD[epoch], 
+	     epoch-1, SEARCHEFF_DATA.MJD[epoch-1] );
+      sprintf(c1err,"Index problem with SEARCHEFF_DATA struct.");
+      sprintf(c2err,"CID=%d  epoch=%d of %d,  MJD-diff=%f", 
+	      GENLC.CID, epoch, GENLC.NEPOCH, diff);
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    }
+      
+    // ------------------------
+    // store conditions
+    SNDATA.PSF_SIG1[epoch]  = SIMLIB_OBS_GEN.PSFSIG1[epoch] ;
+    SNDATA.PSF_SIG2[epoch]  = SIMLIB_OBS_GEN.PSFSIG2[epoch] ;
+    SNDATA.PSF_RATIO[epoch] = SIMLIB_OBS_GEN.PSFRATIO[epoch] ;
 
-  // -----------------------
-  // get search error in ADU
-  fluxsn_adu_errS   = fluxsn_pe_err   / ccdgain ;
-  template_adu_err  = template_pe_err / ccdgain ;
+    // Feb 23, 2012: store search-run zpt instead of template run  zpt
+    SNDATA.ZEROPT[epoch]      = SIMLIB_OBS_GEN.ZPTADU[epoch] ;
+    SNDATA.ZEROPT_ERR[epoch]  = SIMLIB_OBS_GEN.ZPTSIG[epoch] ;
+    SNDATA.ZEROPT_SIG[epoch]  = SIMLIB_OBS_GEN.ZPTSIG[epoch] ;
 
-  // store individual noise contributions in FLUXCAL units
-  GENLC.NOISE_SN[epoch]        = sqrt(fluxsn_pe ) /Npe_over_FLUXCAL ;
-  GENLC.NOISE_SKY[epoch]       = sqrt(sqskyerr_pe)/Npe_over_FLUXCAL ;
-  GENLC.NOISE_TEMPLATE[epoch]  = sqrt(template_sqskyerr_pe)/Npe_over_FLUXCAL ;
-  GENLC.NOISE_CCD[epoch]       = sqrt(sqccderr_pe)/Npe_over_FLUXCAL ;
-  GENLC.NOISE_HOSTGAL_PHOT[epoch]  = sqrt(fluxgal_pe)/Npe_over_FLUXCAL ;
-  GENLC.NOISE_HOSTGAL_IMAGE[epoch] = sqrt(sqImageNoise_pe)/Npe_over_FLUXCAL ;
-  GENLC.NOISE_TOTAL[epoch]         = fluxsn_pe_err/Npe_over_FLUXCAL ;
+    // mar 18 2018: store SNR at fixed mag to monitor data quality 
+    SNDATA.SIMEPOCH_SNRMON[epoch] = GENLC.SNR_MON[epoch];
+
+    // ----------------
+
+    SNDATA.NPE_ABOVE_SAT[epoch]     = GENLC.npe_above_sat[epoch];
+    SNDATA.FLUX[epoch]              = GENLC.flux[epoch];
+    SNDATA.FLUX_ERRTOT[epoch]       = GENLC.flux_errstat[epoch]; 
+    SNDATA.FLUX_ERRTEMPLATE[epoch]  = GENLC.template_err[epoch] ;
+
+    SNDATA.MAG[epoch]          = GENLC.mag[epoch];
+    SNDATA.MAG_ERRPLUS[epoch]  = GENLC.mag_err[epoch];
+    SNDATA.MAG_ERRMINUS[epoch] = GENLC.mag_err[epoch];
 
+    SNDATA.SIMEPOCH_WARPCOLVAL[epoch]  = GENLC.warpcolval8[epoch] ;
 
-  // ############### ADD ZEROPOINT ERROR ###################
-  // note that zeropoint smearing applies only to fluxcal, and NOT 
-  // to fluxsn_adu. This smearing is random for each epoch.
-  // NOTE: maybe the zpt error should be correlated among epochs ?
+    sprintf(SNDATA.SIMEPOCH_WARPCOLNAM[epoch], "%s",
+	    GENLC.warpcolnam[epoch] ) ;
 
-  if ( INPUTS.SMEARFLAG_ZEROPT > 0 ) {
-    relerr  = pow(TEN, 0.4*zptsig) - 1.0 ;
-    err1    = fluxsn_adu_errS  ;    
-    err2    = (fluxsn_adu-flux_T) * relerr ;    
-    sqerr1  = err1 * err1 ;    sqerr2  = err2 * err2 ;
-    fluxsn_adu_errSZ  = sqrt ( sqerr1 + sqerr2 );
-    fluxsn_adu_errZ   = err2; 
-  }
-  else {
-    sqerr1 = sqerr2 = fluxsn_adu_errZ = 0.0 ;
-    fluxsn_adu_errSZ = fluxsn_adu_errS ;  // photostat only
-  }
+    SNDATA.SIMEPOCH_AVWARP[epoch]   = GENLC.AVwarp8[epoch] ;
+    SNDATA.SIMEPOCH_KCORVAL[epoch]  = GENLC.kcorval8[epoch] ;
+    sprintf(SNDATA.SIMEPOCH_KCORNAM[epoch], "%s",
+	    GENLC.kcornam[epoch] ) ;
+    
+    istat = fluxcal_SNDATA ( epoch, "log10" ) ; // --> fill SNDATA.FLUXCAL
+    
+    // check option to make MWEBV-analysis correction on the
+    // reported flux, flux-error and mag
+    if ( INPUTS.APPLYFLAG_MWEBV ) { MWEBVfluxCor_to_SNDATA(epoch); }
 
-  // ############### SMEAR OBSERVED FLUX #####################
-  // Now we have nominal flux in "template" ADUs, and its error.
-  // Apply gaussian fluctuation to get "observed" fluxObs
+    // store SKY sigmas in ADU/pixel
+    // Mar 2 2018: scale output SIG_T to same ZP as search
+    ZP_S = SIMLIB_OBS_GEN.ZPTADU[epoch] ;
+    ZP_T = SIMLIB_OBS_GEN.TEMPLATE_ZPT[epoch] ;
+    arg  = 0.4*(ZP_S-ZP_T);
+    SKYSIG_T_scale = pow(TEN,arg);  // Mar 2 2018
 
+    SNDATA.SKY_SIG[epoch]    = SIMLIB_OBS_GEN.SKYSIG[epoch] ;
+    SNDATA.SKY_SIG_T[epoch]  = 
+      SIMLIB_OBS_GEN.TEMPLATE_SKYSIG[epoch] * SKYSIG_T_scale ;
 
-  // get Gaussian randoms separately for SEARCH and TEMPLATE.
-  // All SEARCH randoms are uncorrelated, but TEMPLATE randoms
-  // depend on field/band, but are the same for each epoch.
-  if ( INPUTS.SMEARFLAG_FLUX > 0 )  {     
-    GAURAN_Search   = GENLC.RANGauss_NOISE_SEARCH[epoch] ; 
-    GAURAN_ZP       = GENLC.RANGauss_NOISE_ZP[epoch] ; 
-    GAURAN_Template = GENLC.RANGauss_NOISE_TEMPLATE[ifield][ifilt_obs] ;
-  }
-  else {  
-    GAURAN_Search   = 0.0 ; 
-    GAURAN_ZP       = 0.0 ; 
-    GAURAN_Template = 0.0 ;
-  }
+  } // end epoch loop
 
 
-  // Feb 2018: fudge error from FLUXERRMODEL. Should replace _legacy codes.
-  if ( NMAP_FLUXERRMODEL > 0 ) {
-    double ERRPARLIST[MXPAR_FLUXERRMAP], fluxerr_sim, fluxerr_data ;
-    double LOGSNR = log10(SNR_CALC);    
-    int OPT = 0;
-    if ( LOGSNR < -0.9 ) { LOGSNR = -0.9 ; }
-    ERRPARLIST[IPAR_FLUXERRMAP_MJD]    = mjd;
-    ERRPARLIST[IPAR_FLUXERRMAP_PSF]    = psfFWHM_arcsec;  // FWHM, arcsec
-    ERRPARLIST[IPAR_FLUXERRMAP_SKYSIG] = skysig;         // ADU/pixel
-    ERRPARLIST[IPAR_FLUXERRMAP_ZP]     = zpt;            // observed ZP, ADU
-    ERRPARLIST[IPAR_FLUXERRMAP_LOGSNR] = LOGSNR ;
-    ERRPARLIST[IPAR_FLUXERRMAP_SBMAG]  = SBmag ;
-    ERRPARLIST[IPAR_FLUXERRMAP_GALMAG] = GALMAG ;
-    ERRPARLIST[IPAR_FLUXERRMAP_SNSEP]  = snsep ;
-    
-    // pass FLUXCAL units to fluxErrModel in case of additive term.
-    double FLUXCALERR_in = fluxsn_adu_errS/NADU_over_FLUXCAL ;
-    double FLUXCALERR_REAL, FLUXCALERR_DATA ;
+  // May 2019: 
+  // estimate PEAKMJD after all of the FLUXCAL[ERR] are  evaluated.
+  GENLC.PEAKMJD_SMEAR   = gen_peakmjd_smear(); 
+  SNDATA.SEARCH_PEAKMJD = GENLC.PEAKMJD_SMEAR;
 
-    get_FLUXERRMODEL(OPT, FLUXCALERR_in, band, field,      // (I)
-		     NPAR_FLUXERRMAP_REQUIRE, ERRPARLIST,  // (I)
-		     &FLUXCALERR_REAL, &FLUXCALERR_DATA) ; // (O)
+  return ;
 
-    // convert FLUXCAL back to pe
-    fluxsn_adu_errReal = FLUXCALERR_REAL * NADU_over_FLUXCAL ;
-    fluxsn_adu_errData = FLUXCALERR_DATA * NADU_over_FLUXCAL ;
-    scale_fluxErr      = fluxsn_adu_errData/fluxsn_adu_errS ;
-  }
-  else {
-    // leagcy option
-    sqsum = 
-      (fluxsn_adu_errS * fluxsn_adu_errS) + 
-      (sqImageNoise_pe / (ccdgain*ccdgain)) ;
+}  // end of snlc_to_SNDATA
 
-    fluxsn_adu_errReal = sqrt(sqsum);
-  }
 
-  fluxObs_adu  = fluxsn_adu 
-    + ( fluxsn_adu_errReal * GAURAN_Search   ) 
-    + ( fluxsn_adu_errZ    * GAURAN_ZP       ) // Feb 2018
-    + ( template_adu_err   * GAURAN_Template ) // coherent template err
-    ;
+// **************************************************
+void MWEBVfluxCor_to_SNDATA(int epoch) {
 
+  // Correct FLUXCAL for MWEBV: 
+  // i.e., FLUXCAL -> FLUXCAL* ( 1 + Delta )
+  // and also increase FLUXCAL_ERRTOT.
 
-  OVP = (INPUTS.SIMLIB_MSKOPT & SIMLIB_MSKOPT_RANDOM_TEMPLATENOISE);
-  if ( OVP > 0 ) {
-    // treat template noise as random instead of coherent
-    // note that fluxObs_adu is overwritten here so that
-    // the coherent-template fluctuation is dropped.
-    sqerr  = fluxsn_adu_errSZ*fluxsn_adu_errSZ ;
-    sqerr += (template_adu_err * template_adu_err);
-    errtmp = sqrt(sqerr);
-    fluxObs_adu  = fluxsn_adu + ( errtmp * GAURAN_Search )  ;
-  }
+  int    ifilt_obs     = GENLC.IFILT_OBS[epoch];
+  double FCOR_MAP_MW   = GENLC.FLUXCOR_MWEBV_MAP[ifilt_obs] ;
+  double MCOR_MAP_MW   = GENLC.MAGCOR_MWEBV_MAP[ifilt_obs]  ;
+  double MCOR_TRUE_MW  = GENLC.MAGCOR_MWEBV_TRUE[ifilt_obs] ;
+  
+  double FLUX    = (double)SNDATA.FLUXCAL[epoch] ;
+  double FLUXERR = (double)SNDATA.FLUXCAL_ERRTOT[epoch] ;
+  double FLUXERR_ORIG = FLUXERR;
+  double MAG     = (double)SNDATA.MAG[epoch] ;
+  double ratio_MWEBV, FLUXERR_ADD, arg;
+
+  double   MAG_T  = SNDATA.SIM_TEMPLATEMAG[ifilt_obs] ;
+  double   FLUX_T = pow(10.0, 0.4*(27.5-MAG_T) ); 
+  int LDMP = (MAG_T < 12 && ifilt_obs == -3);
+  char fnam[] = "MWEBVfluxCor_to_SNDATA" ;
 
+  // --------------- BEGIN --------------
 
-  // use 1/z^2 dependence on mag to set bounds for crazy flux abort;
-  // account for exposure time (xt) and SIMLIB zeropoint (zptfac)
-  // Also add 10 sigma of noise to allow for fluctuations.
+  // bail on saturated epochs
+  if( GENLC.npe_above_sat[epoch] > 0 ) { return ; }
 
-  arg        = 0.4 * ( zpt - 31.0 );  
-  zptfac     = pow(10.0,arg);  
-  if ( zsn > 1.0E-9 ) 
-    { crazyflux  = 2.*(1.E4 * zptfac * xt) / (zsn*zsn) ; }
-  else
-    { crazyflux = 1.0E14 ; } // for LCLIB (July 2018)
+  FLUX      *= FCOR_MAP_MW ;
+  FLUXERR   *= FCOR_MAP_MW ;
+  MAG       -= MCOR_MAP_MW ; 
+    
+  // add extra error based on MWEBV uncertainty
+  // here we use approximation with ratios.
+  ratio_MWEBV = GENLC.MWEBV_ERR / GENLC.MWEBV_SMEAR ;
+  arg         = 0.4*(MCOR_MAP_MW*ratio_MWEBV);
+  FLUXERR_ADD = (pow(10.0,arg)-1.0) * fabs(FLUX) ;
+  FLUXERR     = sqrt(FLUXERR*FLUXERR + FLUXERR_ADD*FLUXERR_ADD);
 
-  crazyflux += (10.*fluxsn_adu_errS) ;
+  // update global FLUX and MAG
+  SNDATA.FLUXCAL[epoch]         = (float)FLUX ;
+  SNDATA.FLUXCAL_ERRTOT[epoch]  = (float)FLUXERR ;
+  SNDATA.MAG[epoch]             = (float)MAG ;
 
-  if ( mag_smear < 0 ) 
-    { crazyflux *= pow(TEN,-0.4*mag_smear); }
+  if ( LDMP ) {
+    printf(" xxx ----------------------------------------- \n");
+    printf(" xxx %s DUMP for CID=%d ifiltobs=%d xxx \n", 
+	   fnam, GENLC.CID, ifilt_obs);
+    printf(" xxx MAG=%.3f  FLUX=%le   MWEBV(meas)=%.3f +- %.3f \n",	   
+	   MAG, FLUX, GENLC.MWEBV_SMEAR, GENLC.MWEBV_ERR);
+    printf(" xxx MAG_T=%.3f   FLUX_T=%le \n" , MAG_T, FLUX_T );
+    printf(" xxx FCOR_MAP = %.4f   MCOR_MAP=%.4f\n", 
+	   FCOR_MAP_MW, MCOR_MAP_MW);
+    printf(" xxx FLUXERR(orig)  = %.2f (%le x FLUX) \n",
+	   FLUXERR_ORIG, FLUXERR_ORIG/FLUX );
+    printf(" xxx FLUXERR(add)   = %.2f (%le x FLUX) \n",
+	   FLUXERR_ADD, FLUXERR_ADD/FLUX );
+    printf(" xxx FLUXERR(final) = %.2f (%le x FLUX) \n",
+	   FLUXERR, FLUXERR_ADD/FLUX );
+  }
 
-  if ( GENLC.FUDGE_SNRMAX_FLAG == 2 && INPUTS.FUDGE_SNRMAX > 1.0 ) 
-    { crazyflux *= INPUTS.FUDGE_SNRMAX; }
+  return;
 
-  if ( INDEX_GENMODEL == MODEL_SIMSED ) 
-    { crazyflux *= 10.0; }    // allow for really bright objects (Aug 2017)
+} // end MWEBVfluxCor_to_SNDATA
 
-  if ( INDEX_GENMODEL == MODEL_LCLIB ) 
-    { crazyflux *= 100.0; }  
+// **************************************************
+void hostgal_to_SNDATA(int IFLAG, int ifilt_obs) {
 
+  // Mar 2012
   
-  if ( fluxObs_adu > crazyflux || fluxObs_adu < -xt*1.0E9 ) {
-
-    printf("\n\n PRE-ABORT COMMENTS for CID=%d: \n", GENLC.CID );
-    printf("\t LIBID = %d   MJD=%f  zHel=%6.4f  MU=%7.3f \n",
-	   GENLC.SIMLIB_ID, mjd,
-	   GENLC.REDSHIFT_HELIO, GENLC.DLMU );
+  // IFLAG = 0 --> nominal loading
+  // IFLAG = 1 --> load header info only (for FITS-file init)
 
-    Trest = GENLC.epoch8_rest[epoch]; 
-    Tobs  = Trest * ( 1.0 + GENLC.REDSHIFT_HELIO );
-    printf("\t Trest=%6.2f  Tobs=%.2f  genmag(%c)=%6.1f  \n", 
-	   Trest, Tobs, FILTERSTRING[ifilt_obs], genmag );
-     
-    printf("\t ccdgain=%6.2f \n",  ccdgain ); 
-    printf("\t zpt(srun) = %f   zptfac=%f \n", 
-	   zpt, zptfac );
-    printf("\t GAURAN(photostat)=%f  magsmear=%6.2f\n", 
-	   GAURAN_Search, mag_smear  );
-    printf("\t sqerr[1,2] = %9.3le , %9.3le \n", sqerr1, sqerr2 );
-    printf("\t ERR_CAL = %f \n", ERR_CAL );
-    printf("\t SKYerr_pe(srun,trun) = %f, %f \n",
-	  sqrt(sqskyerr_pe), sqrt(template_sqskyerr_pe) );
-    printf("\t CCDerr_pe(srun,trun) = %f, %f \n",
-	  sqrt(sqccderr_pe), sqrt(template_sqccderr_pe) );
-    printf("\t err_pe(flux,host,image) = %f, %f, %f \n",
-	   sqrt(fluxsn_pe), sqrt(fluxgal_pe), sqrt(sqImageNoise_pe) );
+  // Compute and global hostgal properties (i.e., epoch-independent)
+  // and load SNDATA structure,
+  //   SNDATA.SIM_GALFRAC[ifilt_obs]      => reference quantity
+  //   SNDATA.HOSTGAL_SB_FLUX[ifilt_obs]  => data-like quantity
+  //   SNDATA.HOSTGAL_USEMASK
+  //   SNDATA.HOSTGAL_MAG[ifilt_obs]   ==> data-like quanity
+  // where SB = surface brightness.
+  //
+  // Dec 17, 2012: fill HOSTGAL_NFILT_MAGOBS and others with ifilt_obs=0
+  // Feb 12, 2014: fill SNDATA.SIM_HOSTGAL_xxx, and add IFLAG arg
+  // Jun 02, 2018: load zphot info for LCLIB
 
-    printf("\t HOSTNOISE(FLUXCAL,pe) = %f, %f \n",
-	   HOSTNOISE_FLUXCAL, HOSTNOISE_pe);
+  int    NPAR, ipar, OVP, ifilt ;
+  double psfsig, mag_GAL, mag_SN, mag_dif, fgal ;
+  char  *name ;
+  char fnam[] = "hostgal_to_SNDATA" ;
 
-    printf("\t zptsig=%f   \n",  zptsig);
-    printf("\t GEN(AV,RV) = %7.3f , %7.3f  SHAPEPAR=%7.3f  (c=%7.3f)\n", 
-	   GENLC.AV, GENLC.RV, GENLC.SHAPEPAR, GENLC.SALT2c );
-    printf("\t Gauss random number: %f \n", 
-	   GENLC.GENSMEAR_RANGauss_FILTER[0] );
+  // --------------- BEGIN ------------
 
-    if ( GENFRAME_OPT  == GENFRAME_REST ) {
-      printf("\t Kcor  %s = %le   AVwarp=%7.3f\n"
-	     , GENLC.kcornam[epoch]
-	     , GENLC.kcorval8[epoch] 
-	     , GENLC.AVwarp8[epoch] 
-	     );
-    }
-    if ( INDEX_GENMODEL  == MODEL_SIMSED ) {
-      printf("\t SIMSED PARAMS %s,%s = %f, %f  (x0=%le)\n"
-	     ,INPUTS.PARNAME_SIMSED[1]
-	     ,INPUTS.PARNAME_SIMSED[2]
-	     ,GENLC.SIMSED_PARVAL[1]
-	     ,GENLC.SIMSED_PARVAL[2], GENLC.SALT2x0 );
-    }
+  // for LCLIB, load photo-z info and return
+  if ( ifilt_obs == 0 &&  INDEX_GENMODEL==MODEL_LCLIB ) {
+    SNDATA.HOSTGAL_SPECZ[0]          = SNHOSTGAL.ZSPEC ;
+    SNDATA.HOSTGAL_SPECZ_ERR[0]      = SNHOSTGAL.ZSPEC_ERR ;
+    SNDATA.HOSTGAL_PHOTOZ[0]         = SNHOSTGAL.ZPHOT ;
+    SNDATA.HOSTGAL_PHOTOZ_ERR[0]     = SNHOSTGAL.ZPHOT_ERR ;
+    return ;
+  }
 
-    if ( INDEX_GENMODEL == MODEL_LCLIB ) {
-      printf("\t LCLIB EVENT ID = %lld \n", LCLIB_EVENT.ID);
-    }
 
-    printf("\t CRAZYFLUX = %9.3le\n", crazyflux);
+  if ( INPUTS.HOSTLIB_USE == 0 ) { return ; }
 
-    sprintf(c1err, "Too large %c(%d)-flux = %9.3le  fluxsn_adu=%9.3le", 
-	    FILTERSTRING[ifilt_obs], ifilt_obs, fluxObs_adu, fluxsn_adu );
-    sprintf(c2err, "fluxsn_adu_errS=%9.3le  fluxsn_adu_errSZ=%9.3le ", 
-	    fluxsn_adu_errS, fluxsn_adu_errSZ );
+  ifilt = GENLC.IFILTINVMAP_OBS[ifilt_obs] ; // sparse index
 
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ; 
-    // errmsg(SEV_WARN, 0, fnam, c1err, c2err) ; 
+  if ( IFLAG == 1 ) {
 
-  }
+    // one-time init before output files are initialized.
+    // set counters and par-names.
 
+    SNDATA.SIM_HOSTLIB_MSKOPT = 
+      INPUTS.HOSTLIB_MSKOPT ; // needed in sntools_fitsio
 
-  // Adjust reported error to be based on observed flux instead of
-  // true flux.
-  if ( fluxObs_adu > 0 ) 
-    { sqerr_ran = (fluxObs_adu - fluxsn_adu)/ccdgain; }
-  else
-    { sqerr_ran = -fluxsn_adu/ccdgain; }
+    NPAR = HOSTLIB_OUTVAR_EXTRA.NOUT ;
+    SNDATA.NPAR_SIM_HOSTLIB = NPAR ;
+    for(ipar=0; ipar < NPAR ; ipar++ ) {
+      name = HOSTLIB_OUTVAR_EXTRA.NAME[ipar] ;
+      sprintf(SNDATA.SIM_HOSTLIB_PARNAME[ipar],"%s", name);
 
-  sqerr1 = (fluxsn_adu_errSZ * fluxsn_adu_errSZ) ;
-  fluxsn_adu_errSZ = sqrt(sqerr1 + sqerr_ran);
+      // set key name for ascii output
+      sprintf(SNDATA.SIM_HOSTLIB_KEYWORD[ipar],"SIM_HOSTLIB(%s)", name);
+    }
+    SNDATA.HOSTLIB_NFILT_MAGOBS   = HOSTLIB.NFILT_MAGOBS ;
 
-  // Add template error to reported error (SZT).
-  sqerr1 = (fluxsn_adu_errSZ * fluxsn_adu_errSZ) ;
-  sqerr2 = (template_adu_err * template_adu_err) ; // add coh template error
-  sqsum  = sqerr1 + sqerr2 ;
-  if ( sqsum < 1.0E-9 ) { sqsum = 1.01E-9 ; }
+    return ;
+  }  // end IFLAG==1
 
-  if ( sqsum < 1.0E-9 ) {
-    printf(" \n PRE-ABORT DUMP: \n");
-    printf("   sqerr1=%f  sqerr2=%f  sqerr_ran=%f\n",	   
-	   sqerr1, sqerr2, sqerr_ran);
-    printf("   GAURAN(Search,Template) = %f, %f \n",
-	   GAURAN_Search, GAURAN_Template );
-    printf("   fluxADU(obs,true) = %f, %f \n",
-	   fluxObs_adu, fluxsn_adu);
-    printf("   Trest=%6.2f  genmag=%6.2f  zHEL=%.4f \n", 
-	   GENLC.epoch8_rest[epoch], genmag, GENLC.REDSHIFT_HELIO );
-    sprintf(c1err,"Invalid sqerr=%le for fluxsn_adu_errSZT", sqsum);
-    sprintf(c2err,"LIBID=%d  MJD=%.3f  band=%c",
-	    GENLC.SIMLIB_ID, mjd, FILTERSTRING[ifilt_obs]);
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err) ;
-  }
-  fluxsn_adu_errSZT = sqrt(sqsum);
 
 
+  if ( ifilt_obs == 0 ) {
+    if ( SNHOSTGAL.GALID>0 ) 
+      { SNDATA.HOSTGAL_NMATCH[0]=1 ; SNDATA.HOSTGAL_NMATCH[1]=1 ; }
+    SNDATA.HOSTGAL_OBJID[0]          = SNHOSTGAL.GALID ;
+    SNDATA.HOSTGAL_PHOTOZ[0]         = SNHOSTGAL.ZPHOT ;
+    SNDATA.HOSTGAL_PHOTOZ_ERR[0]     = SNHOSTGAL.ZPHOT_ERR ;
 
-  // Compute reported without ZP error
-  sqerr1  = fluxsn_adu_errS  * fluxsn_adu_errS ;
-  sqerr2  = template_adu_err * template_adu_err ;
-  sqsum   = sqerr1 + sqerr2 + sqerr_ran ;
-  fluxsn_adu_errST = sqrt(sqsum);   // S & T, but no ZP error
+    SNDATA.HOSTGAL_SPECZ[0]          = SNHOSTGAL.ZSPEC ;
+    SNDATA.HOSTGAL_SPECZ_ERR[0]      = SNHOSTGAL.ZSPEC_ERR ;
+    SNDATA.HOSTGAL_RA[0]     = SNDATA.RA + 
+      (SNHOSTGAL.RA_GAL_DEG-SNHOSTGAL.RA_SN_DEG);
+    SNDATA.HOSTGAL_DEC[0]    = SNDATA.DEC + 
+      (SNHOSTGAL.DEC_GAL_DEG-SNHOSTGAL.DEC_SN_DEG);
+    SNDATA.HOSTGAL_SNSEP[0]          = SNHOSTGAL.SNSEP ;
+    SNDATA.HOSTGAL_DDLR[0]           = SNHOSTGAL.DDLR ;
+    SNDATA.HOSTGAL_LOGMASS[0]        = SNHOSTGAL.LOGMASS ;
+    SNDATA.HOSTGAL_LOGMASS_ERR[0]    = SNHOSTGAL.LOGMASS_ERR ;
 
-  // store errors for GENLC storage
-  errstat = fluxsn_adu_errST ;   // reported total error without ZP err
-  errtot  = fluxsn_adu_errSZT  ; // includes ZP error
+    NPAR = SNDATA.NPAR_SIM_HOSTLIB ;
+    for(ipar=0; ipar < NPAR ; ipar++ ) {
+      SNDATA.SIM_HOSTLIB_PARVAL[ipar] = HOSTLIB_OUTVAR_EXTRA.VALUE[ipar] ;
+    }
 
+    return ;
 
-  // @@@@@@@@@@@@@@@@@ LEGACY ERRFUDGE @@@@@@@@@@@@@@@@@@@@@@@@@
-  // Scale reported (not true) errors to better match data
-  if ( INPUTS.FUDGEOPT_FLUXERR > 0 ) {
-    scale_fluxErr = 
-      scale_fluxErrModel_legacy(band,field,mjd,zpt,skysig,psfsig1);
-  }
-  // @@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+  } // end of ifilt_obs==0
   
-  errtot  *= scale_fluxErr ;
-  errstat *= scale_fluxErr ;      
 
-  // check fudge on measured flux-errors (does not affect true errors)
-  errtot    *= INPUTS.FUDGESCALE_FLUXERR2_FILTER[ifilt_obs] ;
-  errstat   *= INPUTS.FUDGESCALE_FLUXERR2_FILTER[ifilt_obs] ; 
+  // transfer total host mag (Feb 2013)
 
- 
-  // check option to ignore source & host error in reported error
-  // (SMP-like)
-  if ( (INPUTS.SMEARFLAG_FLUX & 2) > 0 ) {
-    double sqerr_pe, err_remove, err_orig=errstat;
-    sqerr_pe   = fluxsn_pe + fluxgal_pe ;
-    err_remove = sqrt(sqerr_pe) * NADU_over_Npe ;  
-    errstat    = sqrt(errstat*errstat - err_remove*err_remove);
-    errtot     = sqrt(errtot *errtot  - err_remove*err_remove);
+  SNDATA.HOSTGAL_MAG[0][ifilt] = (float)SNHOSTGAL.GALMAG[ifilt_obs][0] ;
+  SNDATA.HOSTGAL_USEMASK |= 1 ; // flag to write host mag
 
-    /*
-    if ( SBmag < 22. ) {
-      printf(" xxx err = %.1f -> %.1f  : err_remove=%.1f \n",
-	     err_orig, errstat, err_remove );
-    }
-    */
-  }
+  SNDATA.HOSTGAL_SB_FLUX[ifilt] = (float)SNHOSTGAL.SB_FLUX[ifilt_obs];
+  SNDATA.HOSTGAL_SB_MAG[ifilt]  = (float)SNHOSTGAL.SB_MAG[ifilt_obs];
 
-  if ( genmag > 600.0 ) 
-    { fluxObs_adu = errtot = errstat = template_adu_err = -9.0 ; }
+  OVP = INPUTS.SMEARFLAG_HOSTGAL & SMEARMASK_HOSTGAL_PHOT ;
+  if ( OVP > 0 ) {
+
+    SNDATA.HOSTGAL_USEMASK |= 4 ; // flag to write surface brightness
 
+    psfsig   = 1./2.355 ;     // typical PSF in arcsec
+    mag_GAL  = interp_GALMAG_HOSTLIB(ifilt_obs,psfsig );
+    mag_SN   = (double)SNDATA.SIM_PEAKMAG[ifilt_obs] ;
+    mag_dif  = mag_GAL - mag_SN ;
+    if ( mag_SN < 98.0 ) {
+      // gal/SN fraction in 1" aperture  
+      fgal  = pow(10.0,-0.4*mag_dif); 
+    }
+    else {
+      fgal = -9.0 ; // undefined
+    }
+    SNDATA.SIM_GALFRAC[ifilt_obs] = (float)fgal; 
 
-  // --------------------------------------------
-  // Check optional template flux to subtract (for LCLIB model).
-  // Beware that coherent template fluctuations are not included,
-  // so deep templates are assumed.
-  // This template-flux subtraction is done at the very end so that
-  // search-soure noise is included in the Poisson noise.
-  if ( genmag_T < 90.0 ) {
-    fluxObs_adu       -= flux_T ;  // can be pos or neg
-    fluxsn_adu        -= flux_T ;  // true flux without fluctuations
-    SNR_CALC *= ( fluxsn_adu / ( fluxsn_adu + flux_T) ) ;
   }
 
-  // - - - - - - - - - - - - - - - - - - - 
-  // Jan 2018: check for saturation. NPE > 0 --> saturation
-  int npe_above_sat = npe_above_saturation(epoch,fluxsn_pe+fluxgal_pe );
-  GENLC.npe_above_sat[epoch] = npe_above_sat ;
-  if ( npe_above_sat > 0 ) {
-    fluxObs_adu = 0.0 ;
-    errstat = errtot = FLUXCALERR_SATURATE ;
-  }
-  // - - - - - - - - - - - - - - - - - - - 
+  return ;
 
-  // load global GENLC array.
-  GENLC.flux[epoch]         = fluxObs_adu ;        // flux with fluctuation
+} // end of hostgal_to_SNDATA
 
-  // store stat error for the flux in ADU;  the FLUXCAL and FLUXCAL_ERR 
-  // (computed later in fluxcal_SNDATA) include the ZPTSIG term.
-  GENLC.flux_errstat[epoch] = errstat ;    // without ZP smear
 
-  // separately store total error that include ZPTSIG term.
-  GENLC.flux_errtot[epoch]  = errtot ; 
+// **********************************
+void genmag_boost(void) {
 
-  
-  // keep track of epoch with max SNR (Jun 2018)
-  SNR = fluxObs_adu/errstat ;
-  if (SNR > GENLC.SNRMAX_GLOBAL) 
-    { GENLC.SNRMAX_GLOBAL = SNR;  GENLC.IEPOCH_SNRMAX = epoch;  }
+  /****
+       Start with GENLC.*rest* quantities, and apply generic
+       transformations to get GENLC.*obs* quantities.
+       Apply 
+       - local extinction using AV
+       - K-correction from rest to obs frame
 
-  // store generated/true SNR without fluctuations
-  GENLC.trueSNR[epoch] =  fluxsn_adu/fluxsn_adu_errSZT  ;
+       Note that rest-frame mags are not necessarity in SDSS system.
+       K-correction transforms from rest-system to SDSS mags.
 
-  // Aug 24 2014: store ideal/calculated SNR
-  //  Beware that fluxErrModel scale is not included here ; see below.
-  GENLC.SNR_CALC[epoch] = SNR_CALC ;
+    Nov 30, 2006: compute extinction (x8) with get_snxt8 function.
 
-  // Mar 18 2018: store SNR of fixed monitor mag
-  GENLC.SNR_MON[epoch]  = SNR_MON ;
+    Dec 4, 2006: use fortran NEAREST_IFILT_REST and pass option
 
-  // store coherent template error.
-  GENLC.template_err[epoch] = template_adu_err ;
+    Jun 7, 2007: take wgted average of two nearest filters
+                 Weights wgt1 and wgt2 are inversely proportional
+                 to lambda_obs/(1+z) - lambda_rest
 
-  // debug dump
-  //  LDMP = ( GENLC.SIMLIB_ID == 121 && ifilt_obs==5  ) ;
-  if ( LDMP ) {
+   Mar 5, 2008: if ifilt_rest2 is redder than ifilt_obs (for z ~ 0.02)
+                then do NOT get kcor8_2 to avoid fatal error. 
+                Needed to simulate LOWZ.
 
-    printf("\n # ------------------------------------------ \n");
-    printf(" XXX NOISE DUMP  \n");
-    printf(" XXX CID=%d at MJD=%f  ifilt_obs=%d  LIBID=%d\n",
-	   GENLC.CID, mjd, ifilt_obs, GENLC.SIMLIB_ID );
- 
-    printf(" flux(obs,true) = %f, %f  ADU\n", fluxObs_adu, fluxsn_adu);
-    printf(" err(S,SZ,SZT) = %f, %f, %f \n",
-	   fluxsn_adu_errS, fluxsn_adu_errSZ, fluxsn_adu_errSZT);
-    printf(" sqerr_ran = %f   GAIN=%f\n", sqerr_ran, ccdgain ) ;
+   Jun 11, 2008: remove MWXT calculation from here and move 
+                 it to genmag_MWXT().
 
-    printf(" FLUX = %f +- %f  ADU \n", 
-	   GENLC.flux[epoch], GENLC.flux_errstat[epoch] );
+   May 23, 2009: add istat output arg to get_avwarp8(),
+                 and increment AVwarp-overflows vs. filter
 
-    printf(" psfsig[1,2] = %f, %f pixels  2/1 = %f   \n",
-	   psfsig1, psfsig2, psfratio );
-    printf(" Effective area = %f pixels \n", area_bg );
-    printf(" skysig(S,T) = %.3f , %.3f (ADU/pix) \n", 
-	   skysig, template_skysig) ;
-    printf(" zpt(S,T) = %.3f , %3f \n", zpt, template_zpt);
-    printf(" scale_fluxErr=%.3f   FUDGEOPT_FLUXERR=%d \n",
-	   scale_fluxErr, INPUTS.FUDGEOPT_FLUXERR );
+   Sep 8, 2009: use new kcorfun8 function to do both AVwarp
+                and K-corrections. Eventually will do wgted
+                avg K-cor with both colors.  Get rid of lots
+                of old unecessary code.
 
-    printf(" Gain=%f \n", ccdgain);
-    printf(" GUARAN = %f, %f \n", GAURAN_Search, GAURAN_Template );
-    printf(" Noise(src)  = %f  p.e. \n",   
-	   GENLC.NOISE_SN[epoch]*Npe_over_FLUXCAL );
-    printf(" Noise(sky)  = %f  p.e. \n",  
-	   GENLC.NOISE_SKY[epoch]*Npe_over_FLUXCAL );
-    printf(" Noise(tmpl) = %f  p.e.  USEFLAG=%d \n",  
-	   GENLC.NOISE_TEMPLATE[epoch]*Npe_over_FLUXCAL, 
-	   SIMLIB_TEMPLATE.USEFLAG );
-    printf(" Noise(host-phot) = %f  p.e.   (GALMAG=%.2f, SBmag=%.2f)\n",   
-	   GENLC.NOISE_HOSTGAL_PHOT[epoch]*Npe_over_FLUXCAL, GALMAG, SBmag );
-    printf(" Noise(host-image)= %f  p.e. \n",   
-	   GENLC.NOISE_HOSTGAL_IMAGE[epoch]*Npe_over_FLUXCAL );
-    printf(" Noise(CCD sky+tmpl) = %f p.e. \n", 
-	   GENLC.NOISE_CCD[epoch]*Npe_over_FLUXCAL  );
-    printf(" Noise(tot)  = %f  p.e. \n", 
-	   GENLC.NOISE_TOTAL[epoch]*Npe_over_FLUXCAL );
-    printf(" fluxsn_adu_errS = %f ADU \n",  fluxsn_adu_errS );
-    printf(" errtot=%.3f  errstat=%.3f \n", errtot, errstat );
-    debugexit(fnam); 
-  }
+   Jan 22, 2010: 
+    if mag8[1]  or mag8[2] > is crazy, set mag_obs = 666 as a flag
+    to set flux and fluxerr = -9 in gen_observerSmear().
+
+    Remove obsolete 'istat' dependencies.
 
-  return SUCCESS ;
+   Jun 11, 2010: if Trest < 0 then set undefined mags to 99 instead
+                 of 666 so that pre-explosion epochs are written out.
 
-}  // end of gen_smearFlux
+  *****/
 
+  double 
+    AVwarp8[4], AV8, RV8, Z8, T8,  x8[10]
+    ,mag8[4], lamdif8[4], mag8_obs, kcor8
+    ;
 
-// **********************************
-int gen_smearMag ( int epoch, int VBOSE) {
+  int ifilt_obs, ifilt_rest1, ifilt_rest2, ifilt_rest3, epoch, NZ ;
+  int ifilt_rest_tmp[4] ;   
 
-  // Dec 2011
-  // Convert flux(ADU) and ZP into observed mag and error.
+  char fnam[] = "genmag_boost" ;
 
-  double flux, flux_errtot, flux_errstat, flux_tmp, zpt ;
-  double mag, mag_err , mag_tmp, genmag ;
+  // ------------------ BEGIN ------------
 
-  //  char fnam[] = "gen_smearMag" ;
+  // do NOT apply extinction if AV=0
 
-  // -------------- BEGIN --------------
+  if ( GENLC.AV  == 0.0 ) { goto KCOR ; }
 
-  flux         = GENLC.flux[epoch];
-  flux_errtot  = GENLC.flux_errtot[epoch];
-  flux_errstat = GENLC.flux_errstat[epoch];
-  genmag       = GENLC.genmag8_obs[epoch];
-  zpt          = SIMLIB_OBS_GEN.ZPTADU[epoch] ;
+#ifdef SNGRIDGEN
+  // skip boost for SNOOPY model with just 1 logz-bin
+  NZ = GRIDGEN_INPUTS.NBIN[IPAR_GRIDGEN_LOGZ];
+  if ( NZ == 1 &&  INDEX_GENMODEL == MODEL_SNOOPY ) { return ; }
+#endif
 
-  // init output
-  GENLC.mag[epoch]      = NULLFLOAT ;     
-  GENLC.mag_err[epoch]  = NULLFLOAT ;     
 
-  if ( flux > 0.0  )
-    { mag = -2.5 * log10(flux) + zpt ; }
-  else
-    { mag = MAG_NEGFLUX ; }
+  // apply extinction in rest frame mags/filters
+  AV8 = (double)GENLC.AV ;
+  RV8 = (double)GENLC.RV ;
+  Z8  = 0.0;
 
+  for ( epoch = 1; epoch <= GENLC.NEPOCH; epoch++ ) {  
 
-  // now get the mag error by subtracting 1 sigma from observed flux
-  flux_tmp  =  flux - flux_errstat ; 
 
-  if ( flux_tmp > 0.0  )
-    { mag_tmp = -2.5 * log10(flux_tmp) + zpt ; }
-  else
-    { mag_tmp = MAG_NEGFLUX ; }
+    T8 = GENLC.epoch8_rest[epoch]; 
+    if ( INPUTS.KCORFLAG_STRETCH == 1 ) T8 /= GENLC.STRETCH ;
 
-  mag_err = mag_tmp - mag ;
+    ifilt_obs   = GENLC.IFILT_OBS[epoch];
 
+      if ( GENLC.DOFILT[ifilt_obs] == 0 ) { continue ; }
 
-  // Jan 22, 2010: preserve mag=666 to indicate filter-problem
-  if ( genmag > 600.0 )  
-    { mag = MAG_UNDEFINED ; mag_err  = MAGERR_UNDEFINED; }
- 
-  GENLC.mag[epoch]      = mag ;
-  GENLC.mag_err[epoch]  = mag_err ;
+      ifilt_rest1 = GENLC.IFILTMAP_REST1[ifilt_obs];
+      ifilt_rest2 = GENLC.IFILTMAP_REST2[ifilt_obs];
+      ifilt_rest3 = GENLC.IFILTMAP_REST3[ifilt_obs];     
+       
+      // start with nearest filter.
+      x8[1] = get_snxt8__( &OPT_SNXT, &ifilt_rest1, &T8, &AV8, &RV8 );
+      GENLC.genmag8_rest[epoch] += x8[1] ;
 
-  if ( GENLC.npe_above_sat[epoch] > 0 ) {
-    //    GENLC.genmag8_obs[epoch]  = MAG_SATURATE ; // xxx delete Sep 3 2018
-    GENLC.mag[epoch]                   = MAG_SATURATE ;
-    GENLC.mag_err[epoch]               = 5.0 ;
-  }
+      // now do 2nd nearest filter
+      x8[2] = get_snxt8__( &OPT_SNXT, &ifilt_rest2, &T8, &AV8, &RV8 );
+      GENLC.genmag8_rest2[epoch] += x8[2] ;
 
-  return SUCCESS ;
+      // 3rd nearest filter
+      x8[3] = get_snxt8__( &OPT_SNXT, &ifilt_rest3, &T8, &AV8, &RV8 );
+      GENLC.genmag8_rest3[epoch] += x8[3] ;
 
-} // end of gen_smearMag
 
+  } // end of epoch loop
 
-// ****************************************************
-int npe_above_saturation ( int epoch, double flux_pe) {
 
-  // Created jan 3 2018
-  // For input epoch index and source flux (p.e.),
-  // return number of photo-electrons above saturation
-  // in central pixel. 
-  //   npe < 0 ==> not saturated
-  //   npe > 0 ==> saturated
-  //
-  // Used only if NPE_PIXEL_SATURATION key is given in the SIMLIB header.
+ KCOR:
 
-  int npe = -999 ; // default is not saturated
-  int NEXPOSE      = SIMLIB_OBS_GEN.NEXPOSE[epoch] ;
-  int LDMP ;
+  Z8     = GENLC.REDSHIFT_HELIO ;
 
-  double ccdgain    = SIMLIB_OBS_GEN.CCDGAIN[epoch] ;
-  double skysig_adu = SIMLIB_OBS_GEN.SKYSIG[epoch] ;
-  double psfsig1    = SIMLIB_OBS_GEN.PSFSIG1[epoch] ; // pixels
-  double PIX        = SIMLIB_OBS_GEN.PIXSIZE[epoch];  // pix size, arcsec
-  double PI         = 3.1415926535 ;
+  for ( epoch = 1; epoch <= GENLC.NEPOCH; epoch++ ) {  
 
-  double NPE_SAT = SIMLIB_GLOBAL_HEADER.NPE_PIXEL_SATURATE ;
-  double skysig_pe, sky_pe, areaFrac, areaCor, AREAPIX, SQPSFSIG ;
-  double fluxtot_pe, fluxtot_pe_avg;
-  char fnam[] = "npe_above_saturation" ;
+    T8      = GENLC.epoch8_rest[epoch]; 
+    if ( INPUTS.KCORFLAG_STRETCH == 1 ) { T8 /= GENLC.STRETCH ; }
 
-  // -------------- BEGIN ------------
+    ifilt_obs   = GENLC.IFILT_OBS[epoch];
+    if ( GENLC.DOFILT[ifilt_obs] == 0 ) { continue ; }
 
-  // if no saturation value is given, then never saturate
-  if ( NPE_SAT > 999999999 ) { return(npe); }
+    ifilt_rest1 = GENLC.IFILTMAP_REST1[ifilt_obs] ;
+    ifilt_rest2 = GENLC.IFILTMAP_REST2[ifilt_obs] ;
+    ifilt_rest3 = GENLC.IFILTMAP_REST3[ifilt_obs] ;
 
-  skysig_pe = (skysig_adu * ccdgain) ;  // convert ADU -> pe
-  sky_pe    = skysig_pe * skysig_pe ;   // sky counts per pix, Npe
+    lamdif8[1]  = GENLC.LAMDIF_REST1[ifilt_obs];
+    lamdif8[2]  = GENLC.LAMDIF_REST2[ifilt_obs];
+    lamdif8[3]  = GENLC.LAMDIF_REST3[ifilt_obs];
 
-  // compute fraction of flux contained in 1 pixel at the
-  // center of the PSF.  For pixel size << PSF, flux-fraction
-  // is about PIXSIZE^2/2*PI*sigma^2. For safety, also include
-  // Taylor-expansion correction in areaCor factor below.
-  AREAPIX    = PIX*PIX ;
-  SQPSFSIG   = psfsig1*psfsig1 * AREAPIX ; // arcSec
-  areaCor    =   AREAPIX/(4.0*PI*SQPSFSIG);  // from Taylor expansion
-  areaFrac   = ( AREAPIX/(2.0*PI*SQPSFSIG) ) * ( 1.0 - areaCor );
+    ifilt_rest_tmp[1] = ifilt_rest1 ;
+    ifilt_rest_tmp[2] = ifilt_rest2 ;
+    ifilt_rest_tmp[3] = ifilt_rest3 ;
 
-  // flux in central pixel
-  fluxtot_pe = (flux_pe*areaFrac) + sky_pe ;
-  
-  // divide by number of exposues
-  fluxtot_pe_avg = fluxtot_pe / (double)NEXPOSE ;
+    mag8[1]  = GENLC.genmag8_rest[epoch]  ;
+    mag8[2]  = GENLC.genmag8_rest2[epoch] ;    
+    mag8[3]  = GENLC.genmag8_rest3[epoch] ;
 
-  // comput number of photoelectrons above saturation
-  npe = (int)( fluxtot_pe_avg - NPE_SAT);
+    kcor8 = kcorfun8_ ( &ifilt_obs, &ifilt_rest_tmp[1], 
+			&mag8[1], &lamdif8[1],  &T8, &Z8, &AVwarp8[1] );
 
+    if ( isnan( AVwarp8[2]) ) {
+      sprintf(c1err,"AVwarp=nan for T8=%5.1f  mag8[1,2]=%6.2f,%6.2f",
+	      T8, mag8[1], mag8[2] );
+      sprintf(c2err,"ifilt_rest[1,2]=%d,%d (%c,%c) "
+	      ,ifilt_rest1, ifilt_rest2
+	      ,FILTERSTRING[ifilt_rest1]
+	      ,FILTERSTRING[ifilt_rest2]
+	      );
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    }
 
-  LDMP = ( epoch <= -4) ;
-  if ( LDMP ) {
-    int ifilt_obs = GENLC.IFILT_OBS[epoch] ;
-    double genmag = GENLC.genmag8_obs[epoch];
-    printf("\n");
-    printf(" xxx ------------------------------------ \n");
-    printf(" xxx %s DUMP \n", fnam);
-    printf(" xxx INPUTS: epoch=%d  flux_pe=%.1f  NEXPOSE=%d   NPE_SAT=%.0f\n",
-	   epoch, flux_pe, NEXPOSE, NPE_SAT);
-    printf(" xxx genmag = %.2f   ifiltobs=%d \n", genmag, ifilt_obs);
-    printf(" xxx areaCor = %f  areaFrac = %f \n", areaCor, areaFrac );
-    printf(" xxx sky,fluxtot, fluxtot_avg = %.1f, %.1f, %.1f pe \n", 
-	   sky_pe, fluxtot_pe, fluxtot_pe_avg );
-    printf(" xxx npe above saturation :  %d \n", npe ) ;
-    if ( epoch ==4 ) { debugexit(fnam); }
-  }
+    if ( mag8[1] < -10. ) {
+      NAVWARP_OVERFLOW[0]++ ;             // grand total
+      NAVWARP_OVERFLOW[ifilt_rest1]++ ;   // filter-dependent sum
+    }
 
+    // add up all the contributions
 
-  return(npe);
+    mag8_obs = mag8[1] + kcor8 + GENLC.DLMU ; 
 
-} // end npe_above_saturation
+    // Jan 22, 2010: 
+    // if the spectral warping is crazy, set mag_obs to crazy value
+    if ( T8 > 0 ) {
+      if ( fabs(mag8[1]) > 90.0 ) { mag8_obs = MAG_UNDEFINED ; }
+      if ( fabs(mag8[2]) > 90.0 ) { mag8_obs = MAG_UNDEFINED ; }
+    }
+    else {
+      if ( fabs(mag8[1]) > 90.0 ) mag8_obs = 99;
+      if ( fabs(mag8[2]) > 90.0 ) mag8_obs = 99;
+    }
+
+    if ( fabs(T8) < -90.01 ) {
+      printf(" BOOST: %c(%c) -> %c : Trest=%6.1f (MJD=%7.1f) iep=%d \n"
+	     ,FILTERSTRING[ifilt_rest1]
+	     ,FILTERSTRING[ifilt_rest2]
+	     ,FILTERSTRING[ifilt_obs]
+	     ,T8, GENLC.MJD[epoch], epoch ) ;
 
+      printf("\t M%c = %6.2f(M%c) + %6.3f(kcor) + %7.3f(mu) = %7.3f \n"
+	     ,FILTERSTRING[ifilt_obs]
+	     ,mag8[1]
+	     ,FILTERSTRING[ifilt_rest1]
+	     ,kcor8, GENLC.DLMU,  mag8_obs );
 
-// **************************************
-void snlc_to_SNDATA(int FLAG) {
+    }
 
+      // store Kcor info to include in SNDATA files
 
-  // load SNDATA struct using info from GENLC structure.
-  // FLAG = 0 => load everything.
-  // FLAG = 1 => load header info only (for fits format)
-  //
-  // Set CUTBIT_MASK bits
-  //
-  // Feb 23, 2012: store search-run ZPT instead of ZPT for template run
-  //
-  // Aug 23, 2012: write file name with %8.8 of NGEN > 1 million
-  //               or if the CIDRAN flag is set.
-  //               Goes with new MXGEN_SIM = 3 million.
-  //
-  // Mar 3 2014: SMEARFLAG_ZEROPT=2 --> report total error.
-  // Nov 23 2014: set PHOTFLAG
-  // Sep 04 2016: SNDATA.MAG computed in fluxcal_SNDATA().
-  // Apr 17 2017: SKY_SIG back to ADU (not FLUXCAL)
-  // Aug 10 2017: abort of NEPOCH>=MXEPOCH to protect SNDATA arrays.
-  // Aug 26 2017: ctmp[60] -> ctmp[200] to handle long model names
-  // Sep 08 2017: load LCLIB info
-  // Sep 20 2017: fix refactor bug setting SURVEY and SUBSURVEY
-  // Mar 02 2018: scale SKYSIG_T to same ZP as SKYSIG_S
-  //              Only affects output to data files.
-  // Jun 01 2018: for LCLIB, set all redshifts and errors to zero
-  //
-  // Jul 21 2018: apply MW correction on fluxes (default is no cor)
-  //
-  // Dec 10 2018: load BYOSED info
-  // ---------------------------------------
+    sprintf(GENLC.kcornam[epoch], "K_%c%c"
+	    ,FILTERSTRING[ifilt_rest1]
+	    ,FILTERSTRING[ifilt_obs] 
+	    ) ;
+    sprintf(GENLC.warpcolnam[epoch], "%c-%c"
+	    ,FILTERSTRING[ifilt_rest1]
+	    ,FILTERSTRING[ifilt_rest2] 
+	    ) ;
+
+    GENLC.kcorval8[epoch]        = kcor8 ;
+    GENLC.warpcolval8[epoch]     = mag8[1] - mag8[2] ;
+    GENLC.AVwarp8[epoch]         = AVwarp8[2] ;
+    GENLC.ifilt_AVwarp[epoch][0] = ifilt_rest1 ; // closest filter
+    GENLC.ifilt_AVwarp[epoch][1] = ifilt_rest2 ; // 2nd closest
+
+      // store true obs mag in GENLC structure
+
+    GENLC.genmag8_obs[epoch] = mag8_obs;
+
+    // load model mag-err for observer frame using the model-error
+    // from the nearest rest-frame filter (ifilt_rest1).
 
-  int PHOTFLAG_DETECT  = INPUTS_SEARCHEFF.PHOTFLAG_DETECT;
-  int PHOTFLAG_TRIGGER = INPUTS_SEARCHEFF.PHOTFLAG_TRIGGER ;
+    GENLC.generr8_obs[epoch] = GENLC.generr8_rest[epoch] ;
 
-  int epoch, ifilt, ifilt_obs, NFILT, NPAR, ipar, MSKTMP, istat, zFLAG ;
-  double ZP_S, ZP_T, SKYSIG_T_scale, arg;
-  double MCOR_MAP_MW, MCOR_TRUE_MW ;
-  
-  char ctmp[200], ccid[12];
-  char *cptr, *tmpName;
-  char fnam[] = "snlc_to_SNDATA" ;
 
-  // --------------- BEGIN -------------
+  } // end of epoch loop
 
-  // always start with header info
-  SNDATA.SIMLIB_MSKOPT  = INPUTS.SIMLIB_MSKOPT ;
-  sprintf(SNDATA.SIMLIB_FILE,    "%s", INPUTS.SIMLIB_FILE );
+ 
+}  // end of genmag_boost
 
 
-  sprintf(SNDATA.SURVEY_NAME,   "%s", SIMLIB_GLOBAL_HEADER.SURVEY_NAME );
-  sprintf(SNDATA.SUBSURVEY_NAME,"%s", SIMLIB_HEADER.SUBSURVEY_NAME );  
+// ***********************************
+void genmag_MWXT_fromKcor(void) {
 
-  sprintf(SNDATA.HOSTLIB_FILE,   "%s", INPUTS.HOSTLIB_FILE );
-  sprintf(SNDATA.SIM_MODEL_NAME, "%s", INPUTS.MODELNAME );
-  sprintf(SNDATA_FILTER.LIST,    "%s", INPUTS.GENFILTERS );
-  SNDATA.SIM_MODEL_INDEX    = INDEX_GENMODEL ;
 
-  SNDATA.SIMOPT_FLUXERR     = INPUTS.FUDGEOPT_FLUXERR; // Oct 30 2015
-  SNDATA.SIMOPT_MWCOLORLAW  = INPUTS.OPT_MWCOLORLAW ;
-  SNDATA.SIMOPT_MWEBV       = INPUTS.OPT_MWEBV ;
-  SNDATA.SIM_MWRV           = INPUTS.RV_MWCOLORLAW ;
-  SNDATA.APPLYFLAG_MWEBV    = INPUTS.APPLYFLAG_MWEBV ;
-    
-  SNDATA.SIM_NOBS_UNDEFINED   = GENLC.NOBS_UNDEFINED;
+  /***********
+  Created June 11, 2008 by R.Kessler
+  [major update: Sep 2013]
 
-  SNDATA.MJD_TRIGGER          = GENLC.MJD_TRIGGER ;
+  For rest-frame models only, compute and add MilkyWay extinction 
+  for all observer-frame mags. Also make correction if user 
+  RVMW != RVMW(kcorTable). The correction is an approximation based
+  on the MWXT-difference at the central filter wavelengths, 
+  and should be OKay for small corrections. However, for large 
+  RV differences (order 1 or 2) the approximation may not work so well,
+  particularly in the bluer bands.
 
-  // Jul 18,2011: write INPUTS GENFILTERS only
-  // advantage: does not exceed Kcor bound of there are more than
-  //    10 obs-filters defined in the SIMLIB
-  // disadvantage:  cannot combine simulations that generate
-  //   different filter-subsets; i.e., ugr and ugri
-  //
 
-  NFILT = INPUTS.NFILTDEF_OBS ;
-  SNDATA_FILTER.NDEF = NFILT;
-  for (ifilt=0; ifilt < NFILT; ifilt++ ) 
-    { SNDATA_FILTER.MAP[ifilt] = INPUTS.IFILTMAP_OBS[ifilt]; }
+  May 15, 2009:  check GENLC.DOFILT[ifilt_obs] logical and skip 
+                 calc if observer-mag > 30.
 
+  May 10, 2012: allow RV != RV_MWDUST = 3.1.
+                Compute difference from INPUTS.RVMW and 3.1 at
+                central wavelength of observer-frame filter.
+                Works the same for rest-frame and obs-frame models.
 
-  // load SIMSED info (for SIMSED model)
-  if ( INDEX_GENMODEL == MODEL_SIMSED ) {
-    NPAR = INPUTS.NPAR_SIMSED ;
-    SNDATA.NPAR_SIMSED = NPAR ;
-    for ( ipar=0; ipar < NPAR; ipar++ ) {
+  Feb 13, 2013: return immediately for SALT2 model.
 
-      sprintf(SNDATA.SIMSED_PARNAME[ipar],"%s",
-	      INPUTS.PARNAME_SIMSED[ipar] );
+  Sep 22, 2013: 
+    - return immediatly on obs-frame model.
+    - move RV-correction into get_mwxt8 function; 
+      see extra RV and OPT_COLORLAW args to get_mwxt8.
 
-      sprintf(SNDATA.SIMSED_KEYWORD[ipar],"%s(%s)" 
-	      ,INPUTS.KEYWORD_SIMSED[ipar]
-	      ,INPUTS.PARNAME_SIMSED[ipar] );
+  **********/
 
-      SNDATA.SIMSED_PARVAL[ipar]  = GENLC.SIMSED_PARVAL[ipar];
-    }
-  } // model = MODEL_SIMSED
+  double  z, Trest, mwebv, AVwarp, MWXT, RV    ;
+  int  epoch, ifilt_obs, OPT ;
+  //  char fnam[] = "genmag_MWXT_fromKcor" ;
 
+  // ---------- BEGIN -----------
 
-  // load BYOSED info  (Dec 2018)
-  if ( INDEX_GENMODEL == MODEL_BYOSED ) {
-    NPAR = Event_BYOSED.NPAR ;
-    SNDATA.NPAR_BYOSED = NPAR ; 
-    for ( ipar=0; ipar < NPAR; ipar++ ) {
-      tmpName = Event_BYOSED.PARNAME[ipar];
-      sprintf(SNDATA.BYOSED_PARNAME[ipar], "%s", tmpName ) ;
-      sprintf(SNDATA.BYOSED_KEYWORD[ipar], "BYOSED_PARAM(%s)", tmpName);
-      SNDATA.BYOSED_PARVAL[ipar]  = Event_BYOSED.PARVAL[ipar];
-    }
-  } // model = MODEL_BYOSED
+  if ( GENFRAME_OPT == GENFRAME_OBS ) { return ; }
 
+  z      = GENLC.REDSHIFT_HELIO ;
+  mwebv  = GENLC.MWEBV_SMEAR ;       //  smeared MWEBV
+  RV     = INPUTS.RV_MWCOLORLAW ;
+  OPT    = INPUTS.OPT_MWCOLORLAW ;
 
-  // load LCLIB info 
-  if ( INDEX_GENMODEL == MODEL_LCLIB ) {
-    NPAR = LCLIB_INFO.NPAR_MODEL_STORE ; 
-    SNDATA.NPAR_LCLIB = NPAR ; 
-    for ( ipar=0; ipar < NPAR; ipar++ ) {
-      tmpName = LCLIB_INFO.PARNAME_MODEL[ipar];
-      sprintf(SNDATA.LCLIB_PARNAME[ipar], "%s", tmpName ) ;
-      sprintf(SNDATA.LCLIB_KEYWORD[ipar],"LCLIB_PARAM(%s)", tmpName);
-      SNDATA.LCLIB_PARVAL[ipar]  = LCLIB_EVENT.PARVAL_MODEL[ipar];
-    }
-  } // model = MODEL_LCLIB
+  // ------------------------------------------------
 
-  hostgal_to_SNDATA(FLAG,0);  // for header init only.
+  for ( epoch = 1; epoch <= GENLC.NEPOCH; epoch++ ) {  
 
+    // don't bother with really large mags that have ~ zero flux
+    if ( GENLC.genmag8_obs[epoch]  > 30.0 ) { continue ; }
 
-  // #####################################
+    ifilt_obs  = GENLC.IFILT_OBS[epoch];
+    if ( GENLC.DOFILT[ifilt_obs] == 0 ) { continue ; }
 
-  if ( FLAG == 1 ) { return ; }
+    Trest   = GENLC.epoch8_rest[epoch]; 
+    if ( INPUTS.KCORFLAG_STRETCH == 1 ) { Trest /= GENLC.STRETCH ; }
 
-  // #####################################
+    AVwarp  = GENLC.AVwarp8[epoch] ;
+    MWXT  = get_mwxt8__(&ifilt_obs, &Trest, &z, &AVwarp, &mwebv, &RV, &OPT);
+      
+    // increment observer-frame magnitude.
+    GENLC.genmag8_obs[epoch] += MWXT ;      
 
-  VERSION_INFO.N_SNLC       = NGENLC_WRITE ;
-  VERSION_INFO.GENFRAME_SIM = GENFRAME_OPT ;
 
+  } // end of epoch loop
 
-  // do smearing up front to see what's going on.
- 
-  SNDATA.WRFLAG_BLINDTEST = WRFLAG_BLINDTEST;
 
-  if ( GENLC.NEPOCH >= MXEPOCH ) {
-    printf("\n PRE-ABORT DUMP: \n");
-    printf("\t LIBID=%d  z=%.3f  PEAKMJD=%.3f\n", 
-	   GENLC.SIMLIB_ID, GENLC.REDSHIFT_CMB, GENLC.PEAKMJD );
 
-    sprintf(c1err,"NEPOCH=%d exceeds bound of MXEPOCH=%d",
-	    GENLC.NEPOCH, MXEPOCH );
-    sprintf(c2err,"Check TREST range, PEAKMJD range and SIMLIB range");
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
-  }
+} // end of genmag_MWXT
 
-  SNDATA.NEPOCH        = GENLC.NEPOCH ;
-  SNDATA.RA            = GENLC.RA ;
-  SNDATA.DEC           = GENLC.DEC ;
-  SNDATA.SNTYPE        = GENLC.SNTYPE;
-  SNDATA.SIM_TYPE_INDEX  = GENLC.SIMTYPE ;
-  sprintf(SNDATA.SIM_TYPE_NAME, "%s", GENLC.SNTYPE_NAME );
-  
-  if ( WRFLAG_BLINDTEST ) 
-    { SNDATA.FAKE  = FAKEFLAG_LCSIM_BLINDTEST ; }
-  else
-    { SNDATA.FAKE  = FAKEFLAG_LCSIM ; }
 
-  if ( WRFLAG_CIDRAN == 0 ) 
-    { SNDATA.CID  = GENLC.CID ; }
-  else 
-    { SNDATA.CID  = GENLC.CIDRAN ; }
-  
+// ************************************
+int NEPFILT_GENLC(
+		int opt   // (I) +1 => retrieve from GENLC,  -1 => load GENLC
+		,int ifilt_obs  // (I) 
+		) {
 
-  sprintf(SNDATA.CCID,      "%d", SNDATA.CID ) ;
-  sprintf(SNDATA.IAUC_NAME, "%s", "NULL" );
+  // Returns number of 'ifilt_obs' epochs stored in GENLC & GENFILT
+  // Fill GENFILT structure for 'ifilt_obs;
+  // loads epochs in order for each filter so that epoch-array
+  // can be passed to genmag_xxx functions.
 
-  SNDATA.SUBSAMPLE_INDEX = GENLC.SUBSAMPLE_INDEX ;
+  int  epoch, ifilt_tmp, NEP ;
+  double Trest1, Trest2, Tdif;
 
-  // Hard-wire legacy search type used by the SDSS
-  // Users really should set "SNTYPE_Ia:  120" in the SDSS sim-input file.
-  if ( strcmp(SNDATA.SURVEY_NAME,"SDSS") == 0  ) {
-    SNDATA.SEARCH_TYPE   = 120 ;  // type Ia
-    if ( INDEX_GENMODEL == MODEL_NON1ASED ) { SNDATA.SEARCH_TYPE  = 110 ; }
-    if ( INDEX_GENMODEL == MODEL_NON1AGRID) { SNDATA.SEARCH_TYPE  = 110 ; }
-    if ( SNDATA.SNTYPE < 0 ) 
-      { SNDATA.SNTYPE = SNDATA.SEARCH_TYPE ; }
-  }
+  char fnam[] = "NEPFILT_GENLC" ;
 
-  SNDATA.NOBS                = GENLC.NOBS ; // 5/26/2011
+  // --------------- BEGIN -------------
 
-  SNDATA.REDSHIFT_FINAL      = GENLC.REDSHIFT_CMB_SMEAR ;
-  SNDATA.REDSHIFT_HELIO      = GENLC.REDSHIFT_HELIO_SMEAR ;
-  SNDATA.REDSHIFT_FINAL_ERR  = GENLC.REDSHIFT_SMEAR_ERR ;
-  SNDATA.REDSHIFT_HELIO_ERR  = GENLC.REDSHIFT_SMEAR_ERR ;
-  SNDATA.VPEC                = GENLC.VPEC_SMEAR;
-  SNDATA.VPEC_ERR            = INPUTS.VPEC_ERR;
+  NEP = 0;
 
-  SNDATA.SIM_SEARCHEFF_MASK  = GENLC.SEARCHEFF_MASK ;
-  SNDATA.SIM_SEARCHEFF_SPEC  = GENLC.SEARCHEFF_SPEC ;
-  SNDATA.SIM_SEARCHEFF_zHOST = GENLC.SEARCHEFF_zHOST ;
+  for ( epoch = 1; epoch <= GENLC.NEPOCH; epoch++ ) {
 
-  // assign photoz to REDSHIFT_FINAL if Zspec error is >= 1
-  if ( GENLC.REDSHIFT_SMEAR_ERR > 0.999  ) {
-    SNDATA.REDSHIFT_FINAL      = SNHOSTGAL.ZPHOT ;
-    SNDATA.REDSHIFT_FINAL_ERR  = SNHOSTGAL.ZPHOT_ERR ;
+    ifilt_tmp = GENLC.IFILT_OBS[epoch];
 
-    SNDATA.REDSHIFT_HELIO      = SNHOSTGAL.ZPHOT ;
-    SNDATA.REDSHIFT_HELIO_ERR  = SNHOSTGAL.ZPHOT_ERR ;
-  }
+    if ( ifilt_tmp == ifilt_obs ) {
+      NEP++ ;
 
-  if ( INPUTS.NGENTOT_LC > 1000000 || 
-       INPUTS.NGEN_LC    > 1000000 || 
-       WRFLAG_CIDRAN     > 0 ) {
-    sprintf(ccid, "%8.8d", SNDATA.CID );
-  }
-  else {
-    sprintf(ccid, "%6.6d", SNDATA.CID );
-  }
-  sprintf(SNDATA.snfile_output, "%s_SN%s.DAT",
-	  INPUTS.GENPREFIX, ccid );
-  sprintf(SNDATA.SNFILE_OUTPUT, "%s/%s",
-	  PATH_SNDATA_SIM, SNDATA.snfile_output );
+      if ( NEP >= MXEPSIM_PERFILT ) {
+	sprintf(c1err,"NEP=%d exceeds bound for ifilt_obs=%d(%c).",  
+		NEP, ifilt_obs, FILTERSTRING[ifilt_obs] );
+	sprintf(c2err,"%s", "Check MXEPSIM_PERFILT");
+	errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+      }
 
-  sprintf(SNDATA.MAGREF, "%s", GENLC.primary );
+      if ( opt == +1 ) {
+
+	GENFILT.Trest8[ifilt_obs][NEP]   = GENLC.epoch8_rest[epoch];
+	GENFILT.Tobs8[ifilt_obs][NEP]    = GENLC.epoch8_obs[epoch];
+
+	GENFILT.genmag8_obs[ifilt_obs][NEP]    = GENLC.genmag8_obs[epoch];
+	GENFILT.genmag8_rest[ifilt_obs][NEP]   = GENLC.genmag8_rest[epoch];
+	GENFILT.genmag8_rest2[ifilt_obs][NEP]  = GENLC.genmag8_rest2[epoch];
+	GENFILT.genmag8_rest3[ifilt_obs][NEP]  = GENLC.genmag8_rest3[epoch];
+
+	GENFILT.genmag8_smear[ifilt_obs][NEP]  = GENLC.magsmear8[epoch];
+
+	GENFILT.generr8_obs[ifilt_obs][NEP]    = GENLC.generr8_obs[epoch];
+	GENFILT.generr8_rest[ifilt_obs][NEP]   = GENLC.generr8_rest[epoch];
+	GENFILT.generr8_rest2[ifilt_obs][NEP]  = GENLC.generr8_rest2[epoch];
+
+	//printf(" xxx load Trest(%c=%d) = %f at  epoch=%d,  FILTEPOCH=%d \n", 
+	// FILTERSTRING[ifilt_obs], ifilt_obs, GENLC.epoch8_rest[epoch], epoch,NEP);
+      }
+      else if ( opt == -1 ) {
+
+	// first make sure that Trest matches up
+
+	Trest1	= GENFILT.Trest8[ifilt_obs][NEP] ;
+	Trest2  = GENLC.epoch8_rest[epoch];
+	Tdif    = fabs(Trest1-Trest2) ;
+	if ( Tdif > 0.001 ) {
+	  sprintf(c1err,"GENFILT[ifilt_obs=%d][NEP=%d] = %8.3f", 
+		  ifilt_obs, NEP, Trest1);
+	  sprintf(c2err,"GENLC.epoch8_rest[ep=%d]=%8.3f  (Tdif=%8.3f) \n", 
+		  epoch, Trest2, Tdif );
+	  errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+	}
 
-  // load SIM_XXX info
+	GENLC.genmag8_obs[epoch]   = GENFILT.genmag8_obs[ifilt_obs][NEP] ;
+	GENLC.genmag8_rest[epoch]  = GENFILT.genmag8_rest[ifilt_obs][NEP] ; 
+	GENLC.genmag8_rest2[epoch] = GENFILT.genmag8_rest2[ifilt_obs][NEP] ; 
+	GENLC.genmag8_rest3[epoch] = GENFILT.genmag8_rest3[ifilt_obs][NEP] ; 
 
-  if ( INPUTS.NON1A_MODELFLAG > 0 ) 
-    { sprintf(ctmp,"MODEL = %s", GENLC.SNTEMPLATE ); }
-  else
-    {  sprintf(ctmp,"MODEL = %s", INPUTS.MODELNAME ); }
-  sprintf(SNDATA.SIM_COMMENT, "SN Type = %s , %s", GENLC.SNTYPE_NAME, ctmp );
+	GENLC.magsmear8[epoch]   = GENFILT.genmag8_smear[ifilt_obs][NEP] ;
 
-  SNDATA.SIM_LIBID           = GENLC.SIMLIB_ID;
-  SNDATA.SIM_NGEN_LIBID      = GENLC.NGEN_SIMLIB_ID;
-  SNDATA.SIM_REDSHIFT_CMB    = GENLC.REDSHIFT_CMB ;
-  SNDATA.SIM_REDSHIFT_HELIO  = GENLC.REDSHIFT_HELIO ;
-  SNDATA.SIM_REDSHIFT_HOST   = GENLC.REDSHIFT_HOST ; // Jan 2016
+	GENLC.generr8_obs[epoch]   = GENFILT.generr8_obs[ifilt_obs][NEP] ;
+	GENLC.generr8_rest[epoch]  = GENFILT.generr8_rest[ifilt_obs][NEP] ;
+	GENLC.generr8_rest2[epoch] = GENFILT.generr8_rest2[ifilt_obs][NEP] ;
+      }
+    }
 
-  // 4.19.2019: store redshift flag to indicate where redshift is from
-  zFLAG = GENLC.REDSHIFT_FLAG;
-  if ( zFLAG >= 0 ) {
-    SNDATA.SIM_REDSHIFT_FLAG   = zFLAG ;
-    sprintf(SNDATA.SIM_REDSHIFT_COMMENT,"%s", STRING_REDSHIFT_FLAG[zFLAG] );
   }
 
-  SNDATA.SIM_VPEC         = GENLC.VPEC ;
-  SNDATA.SIM_DLMU         = GENLC.DLMU ; 
-  SNDATA.SIM_LENSDMU      = GENLC.LENSDMU ;
-  SNDATA.SIM_RA           = GENLC.RA ;
-  SNDATA.SIM_DEC          = GENLC.DEC ;
-  SNDATA.SIM_AVTAU        = GENLC.AVTAU ;
-  SNDATA.SIM_MWEBV        = GENLC.MWEBV_SMEAR ; // use smeared MWEBV
-  SNDATA.SIM_PEAKMJD      = GENLC.PEAKMJD ;
+  return NEP ;
 
-  SNDATA.PIXSIZE          = SIMLIB_OBS_GEN.PIXSIZE[1];
-  SNDATA.CCDNUM[0]        = SIMLIB_HEADER.CCDNUM ;
-  SNDATA.SIM_AV           = GENLC.AV ;
-  SNDATA.SIM_RV           = GENLC.RV ;
 
-  if ( INDEX_GENMODEL == MODEL_STRETCH ) 
-    {  SNDATA.SIM_STRETCH  = GENLC.STRETCH ; }
+}  // end of NEPFILT_GENLC
 
-  if ( INDEX_GENMODEL == MODEL_MLCS2k2 ) 
-    { SNDATA.SIM_DELTA    = GENLC.DELTA ; }
 
-  if ( INDEX_GENMODEL == MODEL_SNOOPY ) 
-    { SNDATA.SIM_DM15 = GENLC.DM15 ; }
+// ************************************
+void init_genmodel(void) {
 
-  if ( INDEX_GENMODEL == MODEL_S11DM15 ) 
-    { SNDATA.SIM_DM15 = GENLC.DM15 ; }
+  /**********
+  History:
 
 
-  SNDATA.SIM_SALT2x0          = GENLC.SALT2x0 ; 
-  SNDATA.SIM_SALT2x1          = GENLC.SALT2x1 ; 
-  SNDATA.SIM_SALT2c           = GENLC.SALT2c  ; 
-  SNDATA.SIM_SALT2mB          = GENLC.SALT2mB ; 
-  SNDATA.SIM_SALT2alpha       = GENLC.SALT2alpha ; 
-  SNDATA.SIM_SALT2beta        = GENLC.SALT2beta ; 
-  SNDATA.SIM_TEMPLATE_INDEX   = GENLC.TEMPLATE_INDEX ; 
-  SNDATA.SIM_MAGSMEAR_COH     = GENLC.MAGSMEAR_COH ;
-  SNDATA.SIM_SNMAGSHIFT_HOSTCOR = GENLC.SNMAGSHIFT_HOSTCOR ;
-  SNDATA.SIM_RISETIME_SHIFT   = GENLC.RISETIME_SHIFT ;
-  SNDATA.SIM_FALLTIME_SHIFT   = GENLC.FALLTIME_SHIFT ;
-  SNDATA.SIM_TRESTMIN         = GENLC.TRESTMIN ;
-  SNDATA.SIM_TRESTMAX         = GENLC.TRESTMAX ;
+ Feb 13, 2012: 
+    make calls to get_LAMRANGE_[model] to fill  GENLC.RESTLAM_MODEL[2].
+    Init GENLC.RESTLAM_MODEL to be wide open before calling get_LAMRANGE_XXX.
 
-  // set GALID here in case HOSTLIB_USE=0 in hostgal_to_SNDATA
-  if ( SNHOSTGAL.GALID>0 ) 
-    { SNDATA.HOSTGAL_NMATCH[0]=1 ; SNDATA.HOSTGAL_NMATCH[1]=1 ; }
-  SNDATA.HOSTGAL_OBJID[0]   = SNHOSTGAL.GALID ;
+ Apr 7, 2012: set IFLAG_GENSMEAR
 
-  // st HOSTLIB variables
-  ifilt_obs=0 ;  hostgal_to_SNDATA(FLAG,ifilt_obs);
+ Jul 20 2018: for LCLIB model, set GENRANGE_PEAKMJD= start of season,
+              and GENRANGE_TREST = 0 to MJDLAST
 
-  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
-    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];  
+  ************/
 
-    MCOR_TRUE_MW  = GENLC.MAGCOR_MWEBV_TRUE[ifilt_obs]; 
-    MCOR_MAP_MW   = GENLC.MAGCOR_MWEBV_MAP[ifilt_obs];
+  char *GENMODEL        = INPUTS.GENMODEL;
+  char *GENMODEL_EXTRAP = INPUTS.GENMODEL_EXTRAP_LATETIME ;
 
-    SNDATA.SIM_PEAKMAG[ifilt_obs]     
-      = (float)( GENLC.peakmag8_obs[ifilt_obs] - MCOR_TRUE_MW) ;
+  char  covFile[] = ""  ;
+  char *ARGLIST ;
+  int istat, OPTMASK, NZ, ifilt, ifilt_obs, ifilt_rest ;
+  double dummy[10];
+  float scale_covar_flt ;
+  char fnam[] = "init_genmodel" ;
 
-    SNDATA.SIM_TEMPLATEMAG[ifilt_obs]       // LCLIB source mag in template
-      = (float)GENLC.genmag8_obs_template[ifilt_obs] - MCOR_MAP_MW ;
+  //--------- BEGIN --------
 
-    SNDATA.SIM_EXPOSURE_TIME[ifilt_obs]  = 
-      INPUTS.EXPOSURE_TIME_FILTER[ifilt_obs] ; 
+  // init a few things
+  for ( ifilt_obs=0; ifilt_obs < MXFILTINDX; ifilt_obs++ ) {
+    NSKIP_FILTER[ifilt_obs] = 0;
+    ZVALID_FILTER[0][ifilt_obs] =  +999. ;
+    ZVALID_FILTER[1][ifilt_obs] =  -999. ;
+  }
 
+  GENLC.RESTLAM_MODEL[0] =  1000. ;
+  GENLC.RESTLAM_MODEL[1] = 30000.0 ;
 
-    hostgal_to_SNDATA(FLAG,ifilt_obs);
+  // default is to generate intrinsic smearing at center of filter only
+  IFLAG_GENSMEAR = IFLAG_GENSMEAR_FILT ;
 
-  } // end of ifilt if-block
+  LGEN_SNIA = 0 ;
 
+    // =========================
 
+  if ( INDEX_GENMODEL == MODEL_STRETCH ) {
 
-  SNDATA.MWEBV      = GENLC.MWEBV;      // reported MWEBV from Shlagel map
-  SNDATA.MWEBV_ERR  = GENLC.MWEBV_ERR ; // reported error
-  SNDATA.APPLYFLAG_MWEBV = INPUTS.APPLYFLAG_MWEBV ;
-    
-  // load NEWMJD info
-  SNDATA.NEWMJD = GENLC.NEWMJD ;
-  for ( epoch = 1; epoch <= GENLC.NEWMJD ; epoch++ ) {
-    SNDATA.EPOCH_RANGE_NEWMJD[epoch][0] = 
-      GENLC.EPOCH_RANGE_NEWMJD[epoch][0] ;
-    SNDATA.EPOCH_RANGE_NEWMJD[epoch][1] = 
-      GENLC.EPOCH_RANGE_NEWMJD[epoch][1] ;
+    init_genmag_stretch2(GENMODEL, GENLC.FILTLIST_REST );
+    LGEN_SNIA = 1 ;
   }
 
-
-  // covmat-scatter info
-  int iscat ;
-  if ( INPUTS.NCOVMAT_SCATTER > 0 ) {
-    SNDATA.SIMFLAG_COVMAT_SCATTER = 1 ;
-    for ( iscat=0; iscat < 3 ; iscat++ ) {
-      SNDATA.SIM_COVMAT_SCATTER[iscat] = 
-	GENLC.COVMAT_SCATTER[iscat] ;
-      cptr = SNDATA.SIM_COVMAT_SCATTER_NAME[iscat];
-      sprintf(cptr,"%s", GENLC.COVMAT_SCATTER_NAME[iscat] );
-    }
+  else if ( INDEX_GENMODEL == MODEL_FIXMAG ) {
+    GENLC.SIMTYPE  = MODEL_FIXMAG ;
+    // xxx mark delete  GENLC.SIMTYPE  = (int)INPUTS.FIXMAG[0] ;
   }
+  else if ( INDEX_GENMODEL == MODEL_MLCS2k2 ) {
 
-  // load epoch info
-
+    scale_covar_flt = 1.0;  // 5/02/2009: scale error at mag-smear stage
+    istat = init_genmag_mlcs2k2(GENMODEL, covFile, scale_covar_flt, 
+				GENLC.FILTLIST_REST );
+    get_LAMRANGE_mlcs2k2(&GENLC.RESTLAM_MODEL[0], &GENLC.RESTLAM_MODEL[1] );
+    LGEN_SNIA = 1 ;
+  }
 
-  for ( epoch = 1; epoch <= GENLC.NEPOCH ; epoch++ ) {
+  else if ( INDEX_GENMODEL == MODEL_SNOOPY ) {
 
-    SNDATA.USE_EPOCH[epoch] = GENLC.USE_EPOCH[epoch] ;
+    OPTMASK = 0;
+#ifdef SNGRIDGEN
+    NZ = GRIDGEN_INPUTS.NBIN[IPAR_GRIDGEN_LOGZ];    
+    if ( NZ == 1 ) { OPTMASK = 1; }
+#endif
+    init_genmag_snoopy(GENMODEL, OPTMASK, dummy, GENLC.FILTLIST_REST );
 
-    if ( GENLC.ISPEAK[epoch]      ) { continue ; }
-    if ( GENLC.ISTEMPLATE[epoch]  ) { continue ; }
+    get_LAMRANGE_snoopy(&GENLC.RESTLAM_MODEL[0], &GENLC.RESTLAM_MODEL[1] );
+    LGEN_SNIA = 1 ;
+  }
 
-    ifilt_obs    = GENLC.IFILT_OBS[epoch];
-      
-    SNDATA.FILTINDX[epoch]  = ifilt_obs ;
-    sprintf(SNDATA.FILTCHAR[epoch], "%c",  FILTERSTRING[ifilt_obs] );
+  else if ( INDEX_GENMODEL == MODEL_S11DM15 ) {
 
-    MCOR_TRUE_MW  = GENLC.MAGCOR_MWEBV_TRUE[ifilt_obs]; 
-    MCOR_MAP_MW   = GENLC.MAGCOR_MWEBV_MAP[ifilt_obs];
+    // init generic part of any SEDMODEL (filter & primary ref)
+    init_genSEDMODEL();
 
-    SNDATA.SIMEPOCH_TREST[epoch]  = GENLC.epoch8_rest[epoch] ;
-    SNDATA.SIMEPOCH_TOBS[epoch]   = GENLC.epoch8_obs[epoch] ;
-    SNDATA.SIMEPOCH_MAG[epoch]    = GENLC.genmag8_obs[epoch] - MCOR_TRUE_MW ;
-    SNDATA.SIMEPOCH_MODELMAGERR[epoch] = GENLC.generr8_rest[epoch] ;
-    SNDATA.SIMEPOCH_MAGSMEAR[epoch] = GENLC.magsmear8[epoch] ;
-    SNDATA.SIMEPOCH_FLUXCAL_HOSTERR[epoch] = GENLC.NOISE_HOSTGAL_PHOT[epoch];
+    OPTMASK = 0 ;
+    istat = init_genmag_S11DM15(GENMODEL,OPTMASK);
+    LGEN_SNIA = 1 ;
+  }
 
-    SNDATA.MJD[epoch]          = GENLC.MJD[epoch];
+  else if ( INDEX_GENMODEL == MODEL_SALT2 ) {
 
-    SNDATA.CLOUDCAM_SIG[epoch]    = GENLC.cloudsig[epoch] ;
-    SNDATA.CLOUDCAM_AVG[epoch]    = GENLC.cloudavg[epoch] ;
-    SNDATA.MOONPHASE[epoch]       = GENLC.moonphase[epoch] ;
-    SNDATA.MOONDIST[epoch]        = GENLC.moondist[epoch] ;
+    // init generic part of any SEDMODEL (filter & primary ref)
+    init_genSEDMODEL();
 
-    sprintf(SNDATA.TELESCOPE[epoch], "%s", GENLC.TELESCOPE[epoch] );
-    sprintf(SNDATA.FIELDNAME[epoch], "%s", GENLC.FIELDNAME[epoch] );
+    // model-specific init
+    OPTMASK = 0; 
+    if ( INPUTS.LEGACY_colorXTMW_SALT2 ) { OPTMASK += 128 ; }
 
-    SNDATA.GAIN[epoch]      =  SIMLIB_OBS_GEN.CCDGAIN[epoch] ;
-    SNDATA.READNOISE[epoch] =  SIMLIB_OBS_GEN.READNOISE[epoch] ;
+    istat = init_genmag_SALT2(GENMODEL, GENMODEL_EXTRAP, OPTMASK) ;
 
-    // -------------------------------
-    // PHOTFLAG_DETECT is the optional mask to set for each detection;
-    // detectFlag = 0,1 for undetected/detected. Note the epoch offset
-    // bewteen the SNDATA and SEARCHEFF_DATA structures
-    MSKTMP = SEARCHEFF_DATA.detectFlag[epoch-1];
-    if ( (MSKTMP & 1)>0  &&  PHOTFLAG_DETECT>0 ) 
-      { SNDATA.PHOTFLAG[epoch] += PHOTFLAG_DETECT ; } 
+    get_LAMRANGE_SEDMODEL(1,&GENLC.RESTLAM_MODEL[0],&GENLC.RESTLAM_MODEL[1] );
 
-    if ( (MSKTMP & 2)>0  &&  PHOTFLAG_TRIGGER>0 ) 
-      { SNDATA.PHOTFLAG[epoch] += PHOTFLAG_TRIGGER ; } 
+    if ( istat != 0 ) {
+      sprintf(c1err,"init_genmag_SALT2 failed.");
+      errmsg(SEV_FATAL, 0, fnam, c1err, "" ); 
+    }
 
-    // Jan 17 2018: check appended observations
-    int APP = SIMLIB_OBS_GEN.APPEND_PHOTFLAG[epoch] ;
-    if ( APP > 0 ) 
-      { SNDATA.PHOTFLAG[epoch] += APP ; }
+    // set flag to generate intrinsic smear vs. wavelength
+    // (inside genmag_SALT2).
+    IFLAG_GENSMEAR = IFLAG_GENSMEAR_LAM ;
+    LGEN_SNIA = 1 ;
+  }
 
-    if ( GENLC.npe_above_sat[epoch] > 0 ) 
-      { SNDATA.PHOTFLAG[epoch] += SIMLIB_GLOBAL_HEADER.PHOTFLAG_SATURATE; }
+  else if ( INDEX_GENMODEL == MODEL_SIMSED ) {
 
-    if ( GENLC.IEPOCH_SNRMAX == epoch ) 
-      { SNDATA.PHOTFLAG[epoch] += SIMLIB_GLOBAL_HEADER.PHOTFLAG_SNRMAX ; }
+    // init generic part of any SEDMODEL (filter & primary ref)
+    init_genSEDMODEL();
 
-    if ( GENLC.IEPOCH_NEARPEAK == epoch ) 
-      { SNDATA.PHOTFLAG[epoch] += SIMLIB_GLOBAL_HEADER.PHOTFLAG_NEARPEAK ; }
+    // model-specific init
 
-    // load photProb
-    SNDATA.PHOTPROB[epoch] = SEARCHEFF_DATA.PHOTPROB[epoch-1] ;
+    OPTMASK = INPUTS.GENMODEL_MSKOPT ;
+    if( INPUTS.USE_BINARY_SIMSED > 0 ) { OPTMASK += 1; }
+    if( INPUTS.USE_BINARY_SIMSED > 1 ) { OPTMASK += OPTMASK_SIMSED_MMAP; }
+    SIMSED_LAZY.NSLOT_MAX = INPUTS.NSED_LAZY_SIMSED ;
 
-    // - - - - - - - - -  -
-    double diff = SNDATA.MJD[epoch] - SEARCHEFF_DATA.MJD[epoch-1] ;
-    if ( diff != 0.0 ) {
-      printf("\n PRE-ABORT DUMP: \n");
-      printf("   SNDATA.MJD[%d]=%.4f   SEARCHEFF_DATA.MJD[%d]=%.4f\n",
-	     epoch, SNDATA.MJD[epoch], 
-	     epoch-1, SEARCHEFF_DATA.MJD[epoch-1] );
-      sprintf(c1err,"Index problem with SEARCHEFF_DATA struct.");
-      sprintf(c2err,"CID=%d  epoch=%d of %d,  MJD-diff=%f", 
-	      GENLC.CID, epoch, GENLC.NEPOCH, diff);
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
-    }
-      
-    // ------------------------
-    // store conditions
-    SNDATA.PSF_SIG1[epoch]  = SIMLIB_OBS_GEN.PSFSIG1[epoch] ;
-    SNDATA.PSF_SIG2[epoch]  = SIMLIB_OBS_GEN.PSFSIG2[epoch] ;
-    SNDATA.PSF_RATIO[epoch] = SIMLIB_OBS_GEN.PSFRATIO[epoch] ;
+    istat = init_genmag_SIMSED (INPUTS.GENMODEL
+			       ,INPUTS.PATH_BINARY_SIMSED
+			       ,GENLC.SURVEY_NAME
+			       ,INPUTS.KCOR_FILE
+			       ,OPTMASK );
 
-    // Feb 23, 2012: store search-run zpt instead of template run  zpt
-    SNDATA.ZEROPT[epoch]      = SIMLIB_OBS_GEN.ZPTADU[epoch] ;
-    SNDATA.ZEROPT_ERR[epoch]  = SIMLIB_OBS_GEN.ZPTSIG[epoch] ;
-    SNDATA.ZEROPT_SIG[epoch]  = SIMLIB_OBS_GEN.ZPTSIG[epoch] ;
+    get_LAMRANGE_SEDMODEL(1,&GENLC.RESTLAM_MODEL[0], &GENLC.RESTLAM_MODEL[1] );
+    
+    if ( istat == 0 ) {
+      sprintf(c1err,"init_genmag_SIMSED failed.");
+      errmsg(SEV_FATAL, 0, fnam, c1err, "" ); 
+    }
 
-    // mar 18 2018: store SNR at fixed mag to monitor data quality 
-    SNDATA.SIMEPOCH_SNRMON[epoch] = GENLC.SNR_MON[epoch];
+    // check that SIMSED parameters in sim-input file match
+    // those in the SIMSED model.
+    checkpar_SIMSED();
+    LGEN_SNIA = 0 ;  // July 2017
+  }
 
-    // ----------------
+  else if ( INDEX_GENMODEL == MODEL_BYOSED ) {
 
-    SNDATA.NPE_ABOVE_SAT[epoch]     = GENLC.npe_above_sat[epoch];
-    SNDATA.FLUX[epoch]              = GENLC.flux[epoch];
-    SNDATA.FLUX_ERRTOT[epoch]       = GENLC.flux_errstat[epoch]; 
-    SNDATA.FLUX_ERRTEMPLATE[epoch]  = GENLC.template_err[epoch] ;
+    OPTMASK  = INPUTS.GENMODEL_MSKOPT;
+    ARGLIST  = INPUTS.GENMODEL_ARGLIST;
 
-    SNDATA.MAG[epoch]          = GENLC.mag[epoch];
-    SNDATA.MAG_ERRPLUS[epoch]  = GENLC.mag_err[epoch];
-    SNDATA.MAG_ERRMINUS[epoch] = GENLC.mag_err[epoch];
+    // init generic part of any SEDMODEL (filter & primary ref)
+    init_genSEDMODEL();
+    init_genmag_BYOSED( INPUTS.MODELPATH, OPTMASK, ARGLIST );
+  }
 
-    SNDATA.SIMEPOCH_WARPCOLVAL[epoch]  = GENLC.warpcolval8[epoch] ;
+  else if ( INDEX_GENMODEL == MODEL_NON1ASED ) {
 
-    sprintf(SNDATA.SIMEPOCH_WARPCOLNAM[epoch], "%s",
-	    GENLC.warpcolnam[epoch] ) ;
+    INPUTS.NON1ASED.NGENTOT  = INPUTS.NGEN ;
+    INPUTS.NON1ASED.CIDOFF   = INPUTS.CIDOFF ;
+    GENLC.NON1ASED.IFLAG_GEN = GENLC.IFLAG_GENSOURCE ;
+    
+    GENLC.NON1ASED.FRAC_PEC1A = INPUTS.RATEPAR_PEC1A.SEASON_FRAC ;
+    prep_NON1ASED( &INPUTS.NON1ASED, &GENLC.NON1ASED );
 
-    SNDATA.SIMEPOCH_AVWARP[epoch]   = GENLC.AVwarp8[epoch] ;
-    SNDATA.SIMEPOCH_KCORVAL[epoch]  = GENLC.kcorval8[epoch] ;
-    sprintf(SNDATA.SIMEPOCH_KCORNAM[epoch], "%s",
-	    GENLC.kcornam[epoch] ) ;
+    init_genSEDMODEL();       // pass filters and primary ref
+    init_genmag_NON1ASED(-9,&INPUTS.NON1ASED); // do one-time inits for SEDs
+  }
+  else if ( INDEX_GENMODEL == MODEL_NON1AGRID ) {
+    double FRAC_PEC1A = INPUTS.RATEPAR_PEC1A.SEASON_FRAC ;
+    init_genmag_NON1AGRID(INPUTS.NON1AGRID_FILE, FRAC_PEC1A );
+  }
+  else if ( INDEX_GENMODEL == MODEL_LCLIB ) {
     
-    istat = fluxcal_SNDATA ( epoch, "log10" ) ; // --> fill SNDATA.FLUXCAL
+    double TOBS_RANGE_MAX = INPUTS.GENRANGE_MJD[1] - INPUTS.GENRANGE_MJD[0];
+    int    IFLAG_RANSTART = (INPUTS.JOBID>0) ;
+    OPTMASK = INPUTS.GENMODEL_MSKOPT ;
+    init_genmag_LCLIB(INPUTS.LCLIB_FILE, INPUTS.LCLIB_TEMPLATE_EPOCHS,
+		      GENLC.SURVEY_NAME, INPUTS.GENFILTERS,
+		      TOBS_RANGE_MAX, INPUTS.NGEN, IFLAG_RANSTART, OPTMASK );
     
-    // check option to make MWEBV-analysis correction on the
-    // reported flux, flux-error and mag
-    if ( INPUTS.APPLYFLAG_MWEBV ) { MWEBVfluxCor_to_SNDATA(epoch); }
+    //  Aug 22 2017:
+    //  Hack ugly spaghetti code to run INIT_HOSTLIB if LCLIB has a 
+    //  REDSHIFT parameter. Note that redshift range is read from 
+    //  the LCLIB header, not from sim-input file.
+    //  SHOULD AVOID USING LCLIB MODEL for EXTRA-GALACTIC models.
+    if ( LCLIB_INFO.IPAR_REDSHIFT >= 0 && LCLIB_INFO.HOSTLIB_MSKOPT>0 )  { 
+      INPUTS.GENRANGE_REDSHIFT[0] = LCLIB_INFO.REDSHIFT_RANGE[0] ;
+      INPUTS.GENRANGE_REDSHIFT[1] = LCLIB_INFO.REDSHIFT_RANGE[1] ;
+      INPUTS.HOSTLIB_MSKOPT       = LCLIB_INFO.HOSTLIB_MSKOPT ;
+      INPUTS.HOSTLIB_USE          = 1 ;
+      INIT_HOSTLIB(); 
+    }
+    else {
+      sprintf(INPUTS.HOSTLIB_FILE,"NONE");              // no host  
+      sprintf(INPUTS_SEARCHEFF.USER_zHOST_FILE,"ZERO"); // force EFF_zHOST=0
+    }
 
-    // store SKY sigmas in ADU/pixel
-    // Mar 2 2018: scale output SIG_T to same ZP as search
-    ZP_S = SIMLIB_OBS_GEN.ZPTADU[epoch] ;
-    ZP_T = SIMLIB_OBS_GEN.TEMPLATE_ZPT[epoch] ;
-    arg  = 0.4*(ZP_S-ZP_T);
-    SKYSIG_T_scale = pow(TEN,arg);  // Mar 2 2018
+  }     // end LCLIB if block
 
-    SNDATA.SKY_SIG[epoch]    = SIMLIB_OBS_GEN.SKYSIG[epoch] ;
-    SNDATA.SKY_SIG_T[epoch]  = 
-      SIMLIB_OBS_GEN.TEMPLATE_SKYSIG[epoch] * SKYSIG_T_scale ;
+  else {
+    sprintf(c1err,"%s is not a valid genmag-model", INPUTS.MODELNAME);
+    sprintf(c2err,"Check GENMODEL keyword in input file.");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  }
 
-  } // end epoch loop
 
+  // convert char-filter list into integer map and inverse map
 
-  // May 2019: 
-  // estimate PEAKMJD after all of the FLUXCAL[ERR] are  evaluated.
-  GENLC.PEAKMJD_SMEAR   = gen_peakmjd_smear(); 
-  SNDATA.SEARCH_PEAKMJD = GENLC.PEAKMJD_SMEAR;
+  if ( GENFRAME_OPT == GENFRAME_REST ) {
 
-  return ;
+    printf("\n Rest-frame MODEL FILTERS : '%s' \n", GENLC.FILTLIST_REST );
 
-}  // end of snlc_to_SNDATA
+    GENLC.NFILTDEF_REST = 
+      PARSE_FILTLIST(GENLC.FILTLIST_REST, GENLC.IFILTMAP_REST) ;
 
+    // create inverse map need for genmag_mlcs2k2().
+    for ( ifilt=0 ; ifilt < GENLC.NFILTDEF_REST ; ifilt++ ) {
+      ifilt_rest = GENLC.IFILTMAP_REST[ifilt] ;
+      GENLC.IFILTINVMAP_REST[ifilt_rest] = ifilt;
+    }
 
-// **************************************************
-void MWEBVfluxCor_to_SNDATA(int epoch) {
+    if ( INDEX_GENMODEL == MODEL_MLCS2k2 )   init_covar_mlcs2k2(); 
 
-  // Correct FLUXCAL for MWEBV: 
-  // i.e., FLUXCAL -> FLUXCAL* ( 1 + Delta )
-  // and also increase FLUXCAL_ERRTOT.
+  }
 
-  int    ifilt_obs     = GENLC.IFILT_OBS[epoch];
-  double FCOR_MAP_MW   = GENLC.FLUXCOR_MWEBV_MAP[ifilt_obs] ;
-  double MCOR_MAP_MW   = GENLC.MAGCOR_MWEBV_MAP[ifilt_obs]  ;
-  double MCOR_TRUE_MW  = GENLC.MAGCOR_MWEBV_TRUE[ifilt_obs] ;
-  
-  double FLUX    = (double)SNDATA.FLUXCAL[epoch] ;
-  double FLUXERR = (double)SNDATA.FLUXCAL_ERRTOT[epoch] ;
-  double FLUXERR_ORIG = FLUXERR;
-  double MAG     = (double)SNDATA.MAG[epoch] ;
-  double ratio_MWEBV, FLUXERR_ADD, arg;
+  if ( LGEN_SNIA ) 
+    { GENLC.SIMTYPE  = INPUTS.SNTYPE_Ia_SPEC ; }
 
-  double   MAG_T  = SNDATA.SIM_TEMPLATEMAG[ifilt_obs] ;
-  double   FLUX_T = pow(10.0, 0.4*(27.5-MAG_T) ); 
-  int LDMP = (MAG_T < 12 && ifilt_obs == -3);
-  char fnam[] = "MWEBVfluxCor_to_SNDATA" ;
+  if ( INPUTS.GENTYPE_SPEC > 0 ) 
+    { GENLC.SIMTYPE  = INPUTS.GENTYPE_SPEC ; }
+ 
+  return ;
 
-  // --------------- BEGIN --------------
+}  // end of init_genmodel
 
-  // bail on saturated epochs
-  if( GENLC.npe_above_sat[epoch] > 0 ) { return ; }
 
-  FLUX      *= FCOR_MAP_MW ;
-  FLUXERR   *= FCOR_MAP_MW ;
-  MAG       -= MCOR_MAP_MW ; 
-    
-  // add extra error based on MWEBV uncertainty
-  // here we use approximation with ratios.
-  ratio_MWEBV = GENLC.MWEBV_ERR / GENLC.MWEBV_SMEAR ;
-  arg         = 0.4*(MCOR_MAP_MW*ratio_MWEBV);
-  FLUXERR_ADD = (pow(10.0,arg)-1.0) * fabs(FLUX) ;
-  FLUXERR     = sqrt(FLUXERR*FLUXERR + FLUXERR_ADD*FLUXERR_ADD);
+// *********************************
+void init_genSEDMODEL(void) {
 
-  // update global FLUX and MAG
-  SNDATA.FLUXCAL[epoch]         = (float)FLUX ;
-  SNDATA.FLUXCAL_ERRTOT[epoch]  = (float)FLUXERR ;
-  SNDATA.MAG[epoch]             = (float)MAG ;
+  // Created Oct 15, 2009 by R.Kessler
+  // Perform generic part of initialization for observer-frame
+  // SED model.
+  //
+  // Read K-cor files to fetch primary SED and filter-responses.
+  // Note  that the K-corrections tables are NOT used.
+  //
+  // Dec 19, 2011: abort if zmin <= 1.E-9
+  // Dec 14, 2013: include safety margin on zmin,zmax to allow for
+  //               zcmb -> zhelio because we generate zcmb, but
+  //               generate with zhelio.
+  //
+  // Jan 23, 2014: call extraFilters_4genSmear( ...) to determine
+  //               extra filters needed by genSmear functions.
+  //               See NFILT_extra and IFILTOBS_extra.
+  //
+  // --------------------
+  char  fnam[] = "init_genSEDMODEL" ;
+  char  filtName[40], cfilt[2]    ;
 
-  if ( LDMP ) {
-    printf(" xxx ----------------------------------------- \n");
-    printf(" xxx %s DUMP for CID=%d ifiltobs=%d xxx \n", 
-	   fnam, GENLC.CID, ifilt_obs);
-    printf(" xxx MAG=%.3f  FLUX=%le   MWEBV(meas)=%.3f +- %.3f \n",	   
-	   MAG, FLUX, GENLC.MWEBV_SMEAR, GENLC.MWEBV_ERR);
-    printf(" xxx MAG_T=%.3f   FLUX_T=%le \n" , MAG_T, FLUX_T );
-    printf(" xxx FCOR_MAP = %.4f   MCOR_MAP=%.4f\n", 
-	   FCOR_MAP_MW, MCOR_MAP_MW);
-    printf(" xxx FLUXERR(orig)  = %.2f (%le x FLUX) \n",
-	   FLUXERR_ORIG, FLUXERR_ORIG/FLUX );
-    printf(" xxx FLUXERR(add)   = %.2f (%le x FLUX) \n",
-	   FLUXERR_ADD, FLUXERR_ADD/FLUX );
-    printf(" xxx FLUXERR(final) = %.2f (%le x FLUX) \n",
-	   FLUXERR, FLUXERR_ADD/FLUX );
-  }
+  int 
+    ifilt, ifilt_obs
+    ,NLAM, NFILT, NZBIN, NFILT_extra, LEN=40
+    ,DONEFILT[MXFILTINDX]
+    ,IFILTLOCAL[MXFILTINDX]
+    ,IFILTOBS_extra[MXFILTINDX]
+    ,MASKFRAME[MXFILTINDX]      
+    ;
+  
+  double  lamshift, magprim, zmin, zmax, dz, z1min, z1max,logzdif  ;
 
-  return;
+  // ------------ BEGIN -------------
 
-} // end MWEBVfluxCor_to_SNDATA
+  reset_SEDMODEL();
 
-// **************************************************
-void hostgal_to_SNDATA(int IFLAG, int ifilt_obs) {
+  // allocate temporary arrays to hold primary SED and filter trans.
+  int MEMD = MXLAMSIM * sizeof(double);
+  genSEDMODEL.lam         = (double*) malloc( MEMD );
+  genSEDMODEL.primaryFlux = (double*) malloc( MEMD );
+  genSEDMODEL.TransSN     = (double*) malloc( MEMD );
+  genSEDMODEL.TransREF    = (double*) malloc( MEMD );
 
-  // Mar 2012
-  
-  // IFLAG = 0 --> nominal loading
-  // IFLAG = 1 --> load header info only (for FITS-file init)
 
-  // Compute and global hostgal properties (i.e., epoch-independent)
-  // and load SNDATA structure,
-  //   SNDATA.SIM_GALFRAC[ifilt_obs]      => reference quantity
-  //   SNDATA.HOSTGAL_SB_FLUX[ifilt_obs]  => data-like quantity
-  //   SNDATA.HOSTGAL_USEMASK
-  //   SNDATA.HOSTGAL_MAG[ifilt_obs]   ==> data-like quanity
-  // where SB = surface brightness.
-  //
-  // Dec 17, 2012: fill HOSTGAL_NFILT_MAGOBS and others with ifilt_obs=0
-  // Feb 12, 2014: fill SNDATA.SIM_HOSTGAL_xxx, and add IFLAG arg
-  // Jun 02, 2018: load zphot info for LCLIB
+  // -----------
+  sprintf(GENLC.primary,"%s", "NULL");
+  get_primary__(GENLC.primary, &NLAM, 
+		genSEDMODEL.lam, genSEDMODEL.primaryFlux, LEN) ;
+  //		strlen(GENLC.primary) );
 
-  int    NPAR, ipar, OVP, ifilt ;
-  double psfsig, mag_GAL, mag_SN, mag_dif, fgal ;
-  char  *name ;
-  char fnam[] = "hostgal_to_SNDATA" ;
+  init_primary_SEDMODEL( GENLC.primary, NLAM, 
+			 genSEDMODEL.lam, genSEDMODEL.primaryFlux );
+
+
+  init_MWXT_SEDMODEL(INPUTS.OPT_MWCOLORLAW, INPUTS.RV_MWCOLORLAW);
+
+  // init z-range; include safety margin for zcmb->zhelio 
+  // and for VPEC
+  z1min    = 1. + INPUTS.GENRANGE_REDSHIFT[0] ;
+  z1max    = 1. + INPUTS.GENRANGE_REDSHIFT[1] ;
+  dz       = INPUTS.VEL_CMBAPEX/LIGHT_km  ;
+  dz      += INPUTS.GENSIGMA_VPEC*5.0/LIGHT_km ;  // 5sigma safety margin
+  zmin     = INPUTS.GENRANGE_REDSHIFT[0] - dz*z1min ;
+  zmax     = INPUTS.GENRANGE_REDSHIFT[1] + dz*z1max ;
 
-  // --------------- BEGIN ------------
+  if ( zmin <= 1.0E-9 ) {
+    sprintf(c1err, "Invalid zmin=%le (must be > 0)", zmin);
+    sprintf(c2err, "Check GENRANGE_REDSHIFT key in sim-input file." );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  }
 
-  // for LCLIB, load photo-z info and return
-  if ( ifilt_obs == 0 &&  INDEX_GENMODEL==MODEL_LCLIB ) {
-    SNDATA.HOSTGAL_SPECZ[0]          = SNHOSTGAL.ZSPEC ;
-    SNDATA.HOSTGAL_SPECZ_ERR[0]      = SNHOSTGAL.ZSPEC_ERR ;
-    SNDATA.HOSTGAL_PHOTOZ[0]         = SNHOSTGAL.ZPHOT ;
-    SNDATA.HOSTGAL_PHOTOZ_ERR[0]     = SNHOSTGAL.ZPHOT_ERR ;
-    return ;
+  logzdif =  log10(zmax) - log10(zmin) ;
+  // xxx mark delete  NZBIN = (int)( 100. * logzdif ) + 1 ;
+  NZBIN = (int)( 50. * logzdif ) + 1 ;
+  init_redshift_SEDMODEL(NZBIN, zmin, zmax);
+
+  NFILT = INPUTS.NFILTDEF_OBS ;
+  for ( ifilt = 0; ifilt < MXFILTINDX; ifilt++ ) {
+    DONEFILT[ifilt]   = 0 ;
+    IFILTLOCAL[ifilt] = 0 ;
+    MASKFRAME[ifilt]  = GENFRAME_OBS ;
+    if ( ifilt < NFILT ) 
+      { IFILTLOCAL[ifilt] = INPUTS.IFILTMAP_OBS[ifilt]; }
   }
 
 
-  if ( INPUTS.HOSTLIB_USE == 0 ) { return ; }
+  // check for extra filters needed by the intrinsic scatter model.
+  extraFilters_4genSmear(INPUTS.GENMAG_SMEAR_MODELNAME,
+			 &NFILT_extra, IFILTOBS_extra) ;
 
-  ifilt = GENLC.IFILTINVMAP_OBS[ifilt_obs] ; // sparse index
+  printf("\n");
 
-  if ( IFLAG == 1 ) {
+  for(ifilt=0; ifilt < NFILT_extra ; ifilt++ ) {
+    ifilt_obs           = IFILTOBS_extra[ifilt] ;
+    IFILTLOCAL[NFILT]   = ifilt_obs ;
+    MASKFRAME[NFILT]    = GENFRAME_OBS + GENFRAME_REST ; // check both
+    NFILT++ ;
+    sprintf(cfilt,  "%c", FILTERSTRING[ifilt_obs] ); 
+    printf("  %s : add %s filter needed by %s \n", 
+	   fnam, cfilt, INPUTS.GENMAG_SMEAR_MODELNAME ); fflush(stdout);
+  }
 
-    // one-time init before output files are initialized.
-    // set counters and par-names.
 
-    SNDATA.SIM_HOSTLIB_MSKOPT = 
-      INPUTS.HOSTLIB_MSKOPT ; // needed in sntools_fitsio
+  // pass filter info to SEDMODEL generator
 
-    NPAR = HOSTLIB_OUTVAR_EXTRA.NOUT ;
-    SNDATA.NPAR_SIM_HOSTLIB = NPAR ;
-    for(ipar=0; ipar < NPAR ; ipar++ ) {
-      name = HOSTLIB_OUTVAR_EXTRA.NAME[ipar] ;
-      sprintf(SNDATA.SIM_HOSTLIB_PARNAME[ipar],"%s", name);
+  for ( ifilt=0; ifilt < NFILT; ifilt++ ) {
+      
+    ifilt_obs = IFILTLOCAL[ifilt] ;	
+        
+    // avoid initializing same filter twice.
+    if ( DONEFILT[ifilt_obs] > 0 ) { continue ; }
 
-      // set key name for ascii output
-      sprintf(SNDATA.SIM_HOSTLIB_KEYWORD[ipar],"SIM_HOSTLIB(%s)", name);
-    }
-    SNDATA.HOSTLIB_NFILT_MAGOBS   = HOSTLIB.NFILT_MAGOBS ;
+    // get_filttrans returns separate trans for SN and REF,
+    // but these are always the same for sims.
 
-    return ;
-  }  // end IFLAG==1
+    sprintf(filtName,"NULL") ;
 
+    get_filttrans__(&MASKFRAME[ifilt],     // (I) obs/rest-frame mask
+		    &ifilt_obs,            // (I) absolute filter index
+		    filtName,              // (O) full name of filter
+		    &magprim,              // (O) mag of primary ref 
+		    &NLAM,                 // (O) Number of lambda bins
+		    genSEDMODEL.lam,       // (O) lambda array 
+		    genSEDMODEL.TransSN,   // (O) filter trans 
+		    genSEDMODEL.TransREF,  // (O) idem
+		    LEN ); 
 
+    if ( NLAM > MXLAMSIM ) {
+      sprintf(cfilt,  "%c", FILTERSTRING[ifilt_obs] );
+      sprintf(c1err,"NLAM(%s) = %d exceeds bound of MXLAMSIM=%d",
+	      cfilt, NLAM, MXLAMSIM );
+      sprintf(c2err,"Check filter trans files.");
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    }
 
-  if ( ifilt_obs == 0 ) {
-    if ( SNHOSTGAL.GALID>0 ) 
-      { SNDATA.HOSTGAL_NMATCH[0]=1 ; SNDATA.HOSTGAL_NMATCH[1]=1 ; }
-    SNDATA.HOSTGAL_OBJID[0]          = SNHOSTGAL.GALID ;
-    SNDATA.HOSTGAL_PHOTOZ[0]         = SNHOSTGAL.ZPHOT ;
-    SNDATA.HOSTGAL_PHOTOZ_ERR[0]     = SNHOSTGAL.ZPHOT_ERR ;
+    lamshift = 0.0 ;
+    init_filter_SEDMODEL(ifilt_obs, filtName, magprim, NLAM, 
+			 genSEDMODEL.lam, 
+			 genSEDMODEL.TransSN, 
+			 genSEDMODEL.TransREF, 
+			 lamshift );
 
-    SNDATA.HOSTGAL_SPECZ[0]          = SNHOSTGAL.ZSPEC ;
-    SNDATA.HOSTGAL_SPECZ_ERR[0]      = SNHOSTGAL.ZSPEC_ERR ;
-    SNDATA.HOSTGAL_RA[0]     = SNDATA.RA + 
-      (SNHOSTGAL.RA_GAL_DEG-SNHOSTGAL.RA_SN_DEG);
-    SNDATA.HOSTGAL_DEC[0]    = SNDATA.DEC + 
-      (SNHOSTGAL.DEC_GAL_DEG-SNHOSTGAL.DEC_SN_DEG);
-    SNDATA.HOSTGAL_SNSEP[0]          = SNHOSTGAL.SNSEP ;
-    SNDATA.HOSTGAL_DDLR[0]           = SNHOSTGAL.DDLR ;
-    SNDATA.HOSTGAL_LOGMASS[0]        = SNHOSTGAL.LOGMASS ;
-    SNDATA.HOSTGAL_LOGMASS_ERR[0]    = SNHOSTGAL.LOGMASS_ERR ;
+    DONEFILT[ifilt_obs] = 1 ;
+  }
 
-    NPAR = SNDATA.NPAR_SIM_HOSTLIB ;
-    for(ipar=0; ipar < NPAR ; ipar++ ) {
-      SNDATA.SIM_HOSTLIB_PARVAL[ipar] = HOSTLIB_OUTVAR_EXTRA.VALUE[ipar] ;
-    }
 
-    return ;
+  // free temp memory
+  free(genSEDMODEL.lam);
+  free(genSEDMODEL.primaryFlux);
+  free(genSEDMODEL.TransSN);
+  free(genSEDMODEL.TransREF);
 
-  } // end of ifilt_obs==0
-  
+} // end of init_genSEDMODEL
 
-  // transfer total host mag (Feb 2013)
 
-  SNDATA.HOSTGAL_MAG[0][ifilt] = (float)SNHOSTGAL.GALMAG[ifilt_obs][0] ;
-  SNDATA.HOSTGAL_USEMASK |= 1 ; // flag to write host mag
+// *******************************
+void check_model_default(int index_model ) {
 
-  SNDATA.HOSTGAL_SB_FLUX[ifilt] = (float)SNHOSTGAL.SB_FLUX[ifilt_obs];
-  SNDATA.HOSTGAL_SB_MAG[ifilt]  = (float)SNHOSTGAL.SB_MAG[ifilt_obs];
+  // if default model is used, then change INPUTS.MODELNAME
+  // to that listed in [model].default file.
 
-  OVP = INPUTS.SMEARFLAG_HOSTGAL & SMEARMASK_HOSTGAL_PHOT ;
-  if ( OVP > 0 ) {
+  int   j, lentmp, ICMP;
+  FILE *fp;
+  char *cptr, *PTR_GENMODEL ;
+  char  model[40],suffix[20], defaultFile[MXPATHLEN], defaultPath[MXPATHLEN] ;
+  char  model_lc[40] = { "  " } ;    
+  char  fnam[] = "check_model_default"  ;
 
-    SNDATA.HOSTGAL_USEMASK |= 4 ; // flag to write surface brightness
 
-    psfsig   = 1./2.355 ;     // typical PSF in arcsec
-    mag_GAL  = interp_GALMAG_HOSTLIB(ifilt_obs,psfsig );
-    mag_SN   = (double)SNDATA.SIM_PEAKMAG[ifilt_obs] ;
-    mag_dif  = mag_GAL - mag_SN ;
-    if ( mag_SN < 98.0 ) {
-      // gal/SN fraction in 1" aperture  
-      fgal  = pow(10.0,-0.4*mag_dif); 
-    }
-    else {
-      fgal = -9.0 ; // undefined
-    }
-    SNDATA.SIM_GALFRAC[ifilt_obs] = (float)fgal; 
+  // ----------------- BEGIN ---------------
 
-  }
+  if ( index_model == MODEL_NON1ASED  ) return ;
+  if ( index_model == MODEL_NON1AGRID ) return ;
+  if ( index_model == MODEL_FIXMAG    ) return ;
+  if ( index_model == MODEL_LCLIB     ) return ;
+  if ( index_model == MODEL_BYOSED    ) return ;
 
-  return ;
+  sprintf(model, "%s", INPUTS.MODELNAME );
 
-} // end of hostgal_to_SNDATA
+  PTR_GENMODEL = GENMODEL_NAME[index_model][0] ; // generic model name
 
+  // if there is no dot (.) in the model name,
+  // then assume that we have the generic name and
+  // read the [model].default file to get the model version.
 
-// **********************************
-void genmag_boost(void) {
+  cptr = strstr ( model, "." ) ; 
+  if ( cptr == NULL ) {
 
-  /****
-       Start with GENLC.*rest* quantities, and apply generic
-       transformations to get GENLC.*obs* quantities.
-       Apply 
-       - local extinction using AV
-       - K-correction from rest to obs frame
+    // check if model is lower/upper case to determine if
+    // .default  suffix is lower/upper case.
 
-       Note that rest-frame mags are not necessarity in SDSS system.
-       K-correction transforms from rest-system to SDSS mags.
+    lentmp = strlen(PTR_GENMODEL);
+    for (j=0; j<lentmp; j++) { model_lc[j] = tolower(PTR_GENMODEL[j]); }
+    model_lc[lentmp] = '\0' ;
+    ICMP = strcmp(model_lc,PTR_GENMODEL) ;
 
-    Nov 30, 2006: compute extinction (x8) with get_snxt8 function.
+    if ( ICMP == 0 ) 
+      { sprintf(suffix, "%s", "default"); }
+    else
+      { sprintf(suffix, "%s", "DEFAULT"); }
 
-    Dec 4, 2006: use fortran NEAREST_IFILT_REST and pass option
 
-    Jun 7, 2007: take wgted average of two nearest filters
-                 Weights wgt1 and wgt2 are inversely proportional
-                 to lambda_obs/(1+z) - lambda_rest
+    // construct full name of file with default model version
+    sprintf(defaultPath,"%s/models/%s", 
+	    PATH_SNDATA_ROOT, PTR_GENMODEL );
+    sprintf(defaultFile,"%s/%s.%s", 
+	    defaultPath, PTR_GENMODEL, suffix);
 
-   Mar 5, 2008: if ifilt_rest2 is redder than ifilt_obs (for z ~ 0.02)
-                then do NOT get kcor8_2 to avoid fatal error. 
-                Needed to simulate LOWZ.
+    if ( (fp = fopen(defaultFile, "rt")) == NULL ) {
+      sprintf(c1err,"Default version file does not exist:");
+      sprintf(c2err,"%s",  defaultFile );
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    }
 
-   Jun 11, 2008: remove MWXT calculation from here and move 
-                 it to genmag_MWXT().
+    // read default model-version from default-file
+    readchar(fp, model ) ;
 
-   May 23, 2009: add istat output arg to get_avwarp8(),
-                 and increment AVwarp-overflows vs. filter
+    fclose(fp);
 
-   Sep 8, 2009: use new kcorfun8 function to do both AVwarp
-                and K-corrections. Eventually will do wgted
-                avg K-cor with both colors.  Get rid of lots
-                of old unecessary code.
+    // re-load global GENMODEL with default model version
+    sprintf(INPUTS.GENMODEL, "%s/%s", defaultPath, model);
+    sprintf(INPUTS.MODELNAME, "%s", model ); // copy full name 
+  }
 
-   Jan 22, 2010: 
-    if mag8[1]  or mag8[2] > is crazy, set mag_obs = 666 as a flag
-    to set flux and fluxerr = -9 in gen_observerSmear().
 
-    Remove obsolete 'istat' dependencies.
+} // end of check_model_default
 
-   Jun 11, 2010: if Trest < 0 then set undefined mags to 99 instead
-                 of 666 so that pre-explosion epochs are written out.
+// ******************************
+void init_kcor(char *kcorFile) {
 
-  *****/
+  /********
+   Created May 18, 2008 by R.Kessler
 
-  double 
-    AVwarp8[4], AV8, RV8, Z8, T8,  x8[10]
-    ,mag8[4], lamdif8[4], mag8_obs, kcor8
-    ;
+   Read K-corrections and filter transmissions (rdkcor).
+   We do not yet know GENFRAME_OPT ('rest' or 'obs'),
+   but always read the K-cors to be safe, since even
+   obs-frame models will likely need the filter transmissions.
 
-  int ifilt_obs, ifilt_rest1, ifilt_rest2, ifilt_rest3, epoch, NZ ;
-  int ifilt_rest_tmp[4] ;   
+   Also do miscelaneous chores like fetching
+   AB (zeropoint) offets.
 
-  char fnam[] = "genmag_boost" ;
+   Sep 1, 2010: fix evil bug: tmpoff[20] -> tmpoff[MXFILTINDX]
 
-  // ------------------ BEGIN ------------
+   May 13, 2013: few fixes for MODEL_FIXMAG.
 
-  // do NOT apply extinction if AV=0
+   Sep 22 2013: for rest-frame models call get_kcor_mwpar(RV,OPT_COLORLAW)
 
-  if ( GENLC.AV  == 0.0 ) { goto KCOR ; }
+   Jun 20 2017: pass FILTER_LAMSHIFT argument to set_survey_
 
-#ifdef SNGRIDGEN
-  // skip boost for SNOOPY model with just 1 logz-bin
-  NZ = GRIDGEN_INPUTS.NBIN[IPAR_GRIDGEN_LOGZ];
-  if ( NZ == 1 &&  INDEX_GENMODEL == MODEL_SNOOPY ) { return ; }
-#endif
+   Nov 2 2017: add AB offsets to user offsets; see tmpoff_kcor
+   Apr 24 2019: for FIXMAG model, return before doing rest-frame stuff.
 
+  *********/
 
-  // apply extinction in rest frame mags/filters
-  AV8 = (double)GENLC.AV ;
-  RV8 = (double)GENLC.RV ;
-  Z8  = 0.0;
+  int ISMODEL_FIXMAG = ( INDEX_GENMODEL == MODEL_FIXMAG );
+  int ierrstat, ifilt, ifilt_obs, OPT ;
+  float tmpoff_kcor[MXFILTINDX] ;
+  float *ptr ;
+  char   copt[40], xtDir[MXPATHLEN], cfilt[4], *NAME;
+  char fnam[] = "init_kcor" ;
 
-  for ( epoch = 1; epoch <= GENLC.NEPOCH; epoch++ ) {  
+  // -------------- BEGIN --------------
 
+  // set fortran arrays needed for K-correction lookup
+  // The GENLC variables are set in SIMLIB_open
+ 
+  set_survey__( GENLC.SURVEY_NAME  
+		,&GENLC.NFILTDEF_OBS
+		,GENLC.IFILTMAP_OBS
+		,INPUTS.TMPOFF_LAMSHIFT
+		,strlen(GENLC.SURVEY_NAME)   
+		);
 
-    T8 = GENLC.epoch8_rest[epoch]; 
-    if ( INPUTS.KCORFLAG_STRETCH == 1 ) T8 /= GENLC.STRETCH ;
+  // read K-cor and mag tables (vs. Z, epoch, AV)
+  rdkcor_(kcorFile, &ierrstat, strlen(kcorFile) );
 
-    ifilt_obs   = GENLC.IFILT_OBS[epoch];
+  if ( ierrstat != 0 ) {
+    sprintf(c1err, "Could not open kcor file: '%s'", kcorFile);
+    errmsg(SEV_FATAL, 0, fnam, c1err, "" ); 
+  } 
 
-      if ( GENLC.DOFILT[ifilt_obs] == 0 ) { continue ; }
 
-      ifilt_rest1 = GENLC.IFILTMAP_REST1[ifilt_obs];
-      ifilt_rest2 = GENLC.IFILTMAP_REST2[ifilt_obs];
-      ifilt_rest3 = GENLC.IFILTMAP_REST3[ifilt_obs];     
-       
-      // start with nearest filter.
-      x8[1] = get_snxt8__( &OPT_SNXT, &ifilt_rest1, &T8, &AV8, &RV8 );
-      GENLC.genmag8_rest[epoch] += x8[1] ;
+  // get zeropoint (AB) offsets from kcor/calib file.
+  sprintf(copt,"ABOFF") ;
+  get_filtmap__(copt, tmpoff_kcor, strlen(copt) );
 
-      // now do 2nd nearest filter
-      x8[2] = get_snxt8__( &OPT_SNXT, &ifilt_rest2, &T8, &AV8, &RV8 );
-      GENLC.genmag8_rest2[epoch] += x8[2] ;
 
-      // 3rd nearest filter
-      x8[3] = get_snxt8__( &OPT_SNXT, &ifilt_rest3, &T8, &AV8, &RV8 );
-      GENLC.genmag8_rest3[epoch] += x8[3] ;
+  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
+    ifilt_obs  = GENLC.IFILTMAP_OBS[ifilt] ;
+    ptr = &INPUTS.GENMAG_OFF_ZP[ifilt_obs] ;
 
+    if ( !ISMODEL_FIXMAG ) {
+      *ptr += tmpoff_kcor[ifilt]; // add AB off to user offset
+    }
 
-  } // end of epoch loop
+    // get mean and RMS of filter-wavelength 
+    OPT = GENFRAME_OBS ;
+    get_filtlam__(&OPT, &ifilt_obs
+		  ,&INPUTS.LAMAVG_OBS[ifilt_obs]
+		  ,&INPUTS.LAMRMS_OBS[ifilt_obs]   
+		  ,&INPUTS.LAMMIN_OBS[ifilt_obs]   
+		  ,&INPUTS.LAMMAX_OBS[ifilt_obs]   
+		  );
+  }  // end ifilt loop
 
 
- KCOR:
+  // misc. inits
+  for ( ifilt=0; ifilt<MXFILTINDX; ifilt++ ) { 
+    NAVWARP_OVERFLOW[ifilt] = 0; 
+    GENLC.IFLAG_SYNFILT_SPECTROGRAPH[ifilt] = 0 ;
+  }
 
-  Z8     = GENLC.REDSHIFT_HELIO ;
+  if ( ISMODEL_FIXMAG ) { return ; } // 4.24.2019
 
-  for ( epoch = 1; epoch <= GENLC.NEPOCH; epoch++ ) {  
+  // init MW extinction (moved from end of init_genmodel on Aug 30 2010)
+  if ( GENFRAME_OPT == GENFRAME_REST )  {
 
-    T8      = GENLC.epoch8_rest[epoch]; 
-    if ( INPUTS.KCORFLAG_STRETCH == 1 ) { T8 /= GENLC.STRETCH ; }
+    // Sep 2013: fetch params used to compute MW extinct in kcor files.
+    //           Needed to re-compute MWXT if RV is changed.
+    get_kcor_mwpar__(&GENLC.kcor_RVMW, &GENLC.kcor_OPT_MWCOLORLAW );
 
-    ifilt_obs   = GENLC.IFILT_OBS[epoch];
-    if ( GENLC.DOFILT[ifilt_obs] == 0 ) { continue ; }
+    double RVDIF ;
+    RVDIF = fabs ( INPUTS.RV_MWCOLORLAW - GENLC.kcor_RVMW) ;
+    if ( RVDIF > 0.001 ) {
+      printf("\n");
+      printf("   User RVMW=%.3f != RVMW(kcorTable)=%.3f  \n",
+	     INPUTS.RV_MWCOLORLAW, GENLC.kcor_RVMW) ;
+      printf("   -> Compute MWXT correction with OPT_MWCOLORLAW=%d\n", 
+	     GENLC.kcor_OPT_MWCOLORLAW );
+      fflush(stdout);
+    }
 
-    ifilt_rest1 = GENLC.IFILTMAP_REST1[ifilt_obs] ;
-    ifilt_rest2 = GENLC.IFILTMAP_REST2[ifilt_obs] ;
-    ifilt_rest3 = GENLC.IFILTMAP_REST3[ifilt_obs] ;
+    if ( OPT_SNXT  == OPT_SNXT_CCM89 ) {
+      init_xthost__(&OPT_SNXT);
+    }
+    else if ( OPT_SNXT  == OPT_SNXT_SJPAR ) {
+      print_banner("Init HOST-GALAXY Extinction Parameters");
+      sprintf(xtDir, "%s ",INPUTS.MODELPATH); // leave blank space for fortran
+      rdxtpar_(xtDir, strlen(xtDir) );      
+    }
 
-    lamdif8[1]  = GENLC.LAMDIF_REST1[ifilt_obs];
-    lamdif8[2]  = GENLC.LAMDIF_REST2[ifilt_obs];
-    lamdif8[3]  = GENLC.LAMDIF_REST3[ifilt_obs];
+  } // end rest-frame
 
-    ifilt_rest_tmp[1] = ifilt_rest1 ;
-    ifilt_rest_tmp[2] = ifilt_rest2 ;
-    ifilt_rest_tmp[3] = ifilt_rest3 ;
 
-    mag8[1]  = GENLC.genmag8_rest[epoch]  ;
-    mag8[2]  = GENLC.genmag8_rest2[epoch] ;    
-    mag8[3]  = GENLC.genmag8_rest3[epoch] ;
+  // check for optional spectrograph information (July 2016)
+  sprintf(copt,"SPECTROGRAPH") ;
+  int NF = get_filtmap__(copt, tmpoff_kcor, strlen(copt) );
+  GENLC.NFILTDEF_SPECTROGRAPH = NF ;
+  GENLC.FILTERLIST_SPECTROGRAPH[0] = 0 ;
+  for(ifilt=0; ifilt < NF; ifilt++ ) {
+    ifilt_obs = (int)tmpoff_kcor[ifilt] ;
+    GENLC.IFILTDEF_SPECTROGRAPH[ifilt]     = ifilt_obs ;
+    GENLC.IFILTINV_SPECTROGRAPH[ifilt_obs] = ifilt ;
+    GENLC.IFLAG_SYNFILT_SPECTROGRAPH[ifilt_obs] = 1 ;
+    sprintf(cfilt, "%c", FILTERSTRING[ifilt_obs] );
+    strcat(GENLC.FILTERLIST_SPECTROGRAPH,cfilt);
+  }
 
-    kcor8 = kcorfun8_ ( &ifilt_obs, &ifilt_rest_tmp[1], 
-			&mag8[1], &lamdif8[1],  &T8, &Z8, &AVwarp8[1] );
+  // check for optional SPECTROGRPH info
+  
+  read_spectrograph_fits(kcorFile) ;   
+  if ( SPECTROGRAPH_USEFLAG ) {
+    printf("   Found %d synthetic spectrograph filters (%s) \n",
+	   GENLC.NFILTDEF_SPECTROGRAPH, GENLC.FILTERLIST_SPECTROGRAPH );
+    fflush(stdout);
+  }
 
-    if ( isnan( AVwarp8[2]) ) {
-      sprintf(c1err,"AVwarp=nan for T8=%5.1f  mag8[1,2]=%6.2f,%6.2f",
-	      T8, mag8[1], mag8[2] );
-      sprintf(c2err,"ifilt_rest[1,2]=%d,%d (%c,%c) "
-	      ,ifilt_rest1, ifilt_rest2
-	      ,FILTERSTRING[ifilt_rest1]
-	      ,FILTERSTRING[ifilt_rest2]
-	      );
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
-    }
+  return ;
 
-    if ( mag8[1] < -10. ) {
-      NAVWARP_OVERFLOW[0]++ ;             // grand total
-      NAVWARP_OVERFLOW[ifilt_rest1]++ ;   // filter-dependent sum
-    }
+} // end of init_kcor
+ 
 
-    // add up all the contributions
+// *********************************************
+int gen_TRIGGER_PEAKMAG_SPEC(void) {
 
-    mag8_obs = mag8[1] + kcor8 + GENLC.DLMU ; 
+  // Nov 2017
+  // Utility to speed generation when the spec-efficieny map
+  // depends ONLY on peakMag or peak-color. Idea here is to
+  // call GENMAG_DRIVER only for peakmag (not entire LC)
+  // and check if spec-trigger is satisfied. This will skip
+  // generating mags for entire light curve, and also skip
+  // checking for detection at each epoch.
+  //
+  // Return 1 if trigger is satisfied (nominal epochs restored)
+  // Return 0 if trigger fails.       (nominal epochs NOT restored)
+  //
+  // Jun 2 2018: bail out for LCLIB model because PEAKMAG is ill-defined.
 
-    // Jan 22, 2010: 
-    // if the spectral warping is crazy, set mag_obs to crazy value
-    if ( T8 > 0 ) {
-      if ( fabs(mag8[1]) > 90.0 ) { mag8_obs = MAG_UNDEFINED ; }
-      if ( fabs(mag8[2]) > 90.0 ) { mag8_obs = MAG_UNDEFINED ; }
-    }
-    else {
-      if ( fabs(mag8[1]) > 90.0 ) mag8_obs = 99;
-      if ( fabs(mag8[2]) > 90.0 ) mag8_obs = 99;
-    }
+  int  LFIND_SPEC=0, NEP_PEAKONLY=0, iep,ifilt ;
+  int  MEMI  = (GENLC.NEPOCH+1) * sizeof(int);
+  int  MEMD  = (GENLC.NEPOCH+1) * sizeof(double);
+  int  DOSPEC = (INPUTS.APPLY_SEARCHEFF_OPT & 2) ;
+  double EFF ;
 
-    if ( fabs(T8) < -90.01 ) {
-      printf(" BOOST: %c(%c) -> %c : Trest=%6.1f (MJD=%7.1f) iep=%d \n"
-	     ,FILTERSTRING[ifilt_rest1]
-	     ,FILTERSTRING[ifilt_rest2]
-	     ,FILTERSTRING[ifilt_obs]
-	     ,T8, GENLC.MJD[epoch], epoch ) ;
+  struct {
+    int NEPOCH, *IFILT_OBS, *ISPEAK;
+    double *MJD, *TOBS, *TREST ;
+  } GENLC_ORIG ;
 
-      printf("\t M%c = %6.2f(M%c) + %6.3f(kcor) + %7.3f(mu) = %7.3f \n"
-	     ,FILTERSTRING[ifilt_obs]
-	     ,mag8[1]
-	     ,FILTERSTRING[ifilt_rest1]
-	     ,kcor8, GENLC.DLMU,  mag8_obs );
 
-    }
+  char fnam[] = "gen_TRIGGER_PEAKMAG_SPEC" ;
 
-      // store Kcor info to include in SNDATA files
+  // -------------- BEGIN ----------------
 
-    sprintf(GENLC.kcornam[epoch], "K_%c%c"
-	    ,FILTERSTRING[ifilt_rest1]
-	    ,FILTERSTRING[ifilt_obs] 
-	    ) ;
-    sprintf(GENLC.warpcolnam[epoch], "%c-%c"
-	    ,FILTERSTRING[ifilt_rest1]
-	    ,FILTERSTRING[ifilt_rest2] 
-	    ) ;
+  if ( DOSPEC == 0 ) 
+    { return(1); }
 
-    GENLC.kcorval8[epoch]        = kcor8 ;
-    GENLC.warpcolval8[epoch]     = mag8[1] - mag8[2] ;
-    GENLC.AVwarp8[epoch]         = AVwarp8[2] ;
-    GENLC.ifilt_AVwarp[epoch][0] = ifilt_rest1 ; // closest filter
-    GENLC.ifilt_AVwarp[epoch][1] = ifilt_rest2 ; // 2nd closest
+  if ( SEARCHEFF_SPEC_INFO.FLAG_PEAKMAG_ONLY == 0 ) 
+    { return(1); }
 
-      // store true obs mag in GENLC structure
+  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID  ) 
+    { return(1); }
 
-    GENLC.genmag8_obs[epoch] = mag8_obs;
+  if ( INDEX_GENMODEL == MODEL_LCLIB ) // Jun 2 2018
+    { return(1); }
 
-    // load model mag-err for observer frame using the model-error
-    // from the nearest rest-frame filter (ifilt_rest1).
+  GENLC_ORIG.NEPOCH      = GENLC.NEPOCH;
+  GENLC_ORIG.IFILT_OBS   = (int*)malloc ( MEMI ) ; 
+  GENLC_ORIG.ISPEAK      = (int*)malloc ( MEMI ) ;
+  GENLC_ORIG.MJD         = (double*)malloc( MEMD ) ;
+  GENLC_ORIG.TOBS        = (double*)malloc( MEMD ) ;
+  GENLC_ORIG.TREST       = (double*)malloc( MEMD ) ;
 
-    GENLC.generr8_obs[epoch] = GENLC.generr8_rest[epoch] ;
+  for(iep=1; iep <= GENLC_ORIG.NEPOCH ; iep++ ) {
+    GENLC_ORIG.ISPEAK[iep]    = GENLC.ISPEAK[iep] ;
+    GENLC_ORIG.IFILT_OBS[iep] = GENLC.IFILT_OBS[iep] ;
+    GENLC_ORIG.MJD[iep]       = GENLC.MJD[iep];
+    GENLC_ORIG.TOBS[iep]      = GENLC.epoch8_obs[iep];  
+    GENLC_ORIG.TREST[iep]     = GENLC.epoch8_rest[iep] ;
+
+    if ( GENLC_ORIG.ISPEAK[iep] == 0 ) { continue ; }
+    NEP_PEAKONLY++ ;
+    GENLC.ISPEAK[NEP_PEAKONLY]       = GENLC_ORIG.ISPEAK[iep] ;
+    GENLC.IFILT_OBS[NEP_PEAKONLY]    = GENLC_ORIG.IFILT_OBS[iep] ;
+    GENLC.MJD[NEP_PEAKONLY]          = GENLC_ORIG.MJD[iep] ;
+    GENLC.epoch8_obs[NEP_PEAKONLY]   = GENLC_ORIG.TOBS[iep] ;
+    GENLC.epoch8_rest[NEP_PEAKONLY]  = GENLC_ORIG.TREST[iep] ;
+  }
+  GENLC.NEPOCH = NEP_PEAKONLY;
 
 
-  } // end of epoch loop
+  GENLC.PEAKMAG_TRIGGER_FLAG = 1 ; // global flag
+  GENMAG_DRIVER(); 
+  LOAD_SEARCHEFF_DATA();
+  LFIND_SPEC = gen_SEARCHEFF_SPEC(GENLC.CID, &EFF) ;  // return EFF 
+    
+  GENLC.NEPOCH = GENLC_ORIG.NEPOCH ; // always needed for init_GENLC
+
+  // check to restore ALL epochs
+  if ( LFIND_SPEC ) {
+    for(iep=1; iep <= GENLC.NEPOCH ; iep++ ) {
+      GENLC.ISPEAK[iep]      = GENLC_ORIG.ISPEAK[iep];
+      GENLC.IFILT_OBS[iep]   = GENLC_ORIG.IFILT_OBS[iep] ;
+      GENLC.MJD[iep]         = GENLC_ORIG.MJD[iep];
+      GENLC.epoch8_obs[iep]  = GENLC_ORIG.TOBS[iep]  ;
+      GENLC.epoch8_rest[iep] = GENLC_ORIG.TREST[iep] ;
+    }
+  }
 
- 
-}  // end of genmag_boost
 
+  free(GENLC_ORIG.IFILT_OBS);
+  free(GENLC_ORIG.ISPEAK);
+  free(GENLC_ORIG.MJD);
+  free(GENLC_ORIG.TOBS);
+  free(GENLC_ORIG.TREST);
 
-// ***********************************
-void genmag_MWXT_fromKcor(void) {
+  GENLC.PEAKMAG_TRIGGER_FLAG = 0 ;
+  return(LFIND_SPEC) ;
 
+} // end gen_TRIGGER_PEAKMAG_SPEC
 
-  /***********
-  Created June 11, 2008 by R.Kessler
-  [major update: Sep 2013]
 
-  For rest-frame models only, compute and add MilkyWay extinction 
-  for all observer-frame mags. Also make correction if user 
-  RVMW != RVMW(kcorTable). The correction is an approximation based
-  on the MWXT-difference at the central filter wavelengths, 
-  and should be OKay for small corrections. However, for large 
-  RV differences (order 1 or 2) the approximation may not work so well,
-  particularly in the bluer bands.
+// ==========================================
+int gen_TRIGGER_zHOST(void) {
 
+  // Created Dec 1 2017
+  // Evaluate zHOST trigger and return 1=PASS, 0=FAIL.
+  // Intended to reject events before digitization to
+  // speed simulation.
+  //
+  // Mar 15 2018: bail if zHOST is NOT required by user
+  // Jun 19 2018: bail of CUTWIN_SNRMAX is specified.
 
-  May 15, 2009:  check GENLC.DOFILT[ifilt_obs] logical and skip 
-                 calc if observer-mag > 30.
+  double EFF, IPASS;
+  int  NEPOCH_ORIG   = GENLC.NEPOCH;
+  int  APPLY_OPT     = INPUTS.APPLY_SEARCHEFF_OPT ;
+  int  REQUIRE_SPEC  = (APPLY_OPT & APPLYMASK_SEARCHEFF_SPEC) ;
+  int  REQUIRE_zHOST = (APPLY_OPT & APPLYMASK_SEARCHEFF_zHOST);
+  char fnam[] = "gen_TRIGGER_zHOST" ;
 
-  May 10, 2012: allow RV != RV_MWDUST = 3.1.
-                Compute difference from INPUTS.RVMW and 3.1 at
-                central wavelength of observer-frame filter.
-                Works the same for rest-frame and obs-frame models.
+  // -------------- BEGIN ------------------
 
-  Feb 13, 2013: return immediately for SALT2 model.
+  // bail if spec-confirmation is required
+  if ( REQUIRE_SPEC ) { return(1); }
 
-  Sep 22, 2013: 
-    - return immediatly on obs-frame model.
-    - move RV-correction into get_mwxt8 function; 
-      see extra RV and OPT_COLORLAW args to get_mwxt8.
+  // bail if zHOST is not required  (Mar 15, 2018)
+  if ( !REQUIRE_zHOST ) { return(1); }
 
-  **********/
+  // bail if zHOST map is NOT defined.
+  if ( INPUTS_SEARCHEFF.NMAP_zHOST == 0 )     { return(1); }
 
-  double  z, Trest, mwebv, AVwarp, MWXT, RV    ;
-  int  epoch, ifilt_obs, OPT ;
-  //  char fnam[] = "genmag_MWXT_fromKcor" ;
+  // bail if CUTWIN_SNRMAX is specified (June 18 2018)
+  if ( INPUTS_SEARCHEFF.CUTWIN_SNRMAX_zHOST[0] > 0.0 ) { return(1); }
 
-  // ---------- BEGIN -----------
+  // bail if generating GRID
+  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID  )     { return(1); }
 
-  if ( GENFRAME_OPT == GENFRAME_OBS ) { return ; }
+  // load data to load randoms used for efficiencies.
+  GENLC.NEPOCH=1;  LOAD_SEARCHEFF_DATA();
 
-  z      = GENLC.REDSHIFT_HELIO ;
-  mwebv  = GENLC.MWEBV_SMEAR ;       //  smeared MWEBV
-  RV     = INPUTS.RV_MWCOLORLAW ;
-  OPT    = INPUTS.OPT_MWCOLORLAW ;
+  // evaluate zHOST trigger
+  IPASS = gen_SEARCHEFF_zHOST(GENLC.CID,&EFF);
 
-  // ------------------------------------------------
+  // restore GENLC.NEPOCH
+  GENLC.NEPOCH = NEPOCH_ORIG; 
 
-  for ( epoch = 1; epoch <= GENLC.NEPOCH; epoch++ ) {  
+  return(IPASS) ;
 
-    // don't bother with really large mags that have ~ zero flux
-    if ( GENLC.genmag8_obs[epoch]  > 30.0 ) { continue ; }
+} // end gen_TRIGGER_zHOST
 
-    ifilt_obs  = GENLC.IFILT_OBS[epoch];
-    if ( GENLC.DOFILT[ifilt_obs] == 0 ) { continue ; }
+// *********************************************
+void GENMAG_DRIVER(void) {
 
-    Trest   = GENLC.epoch8_rest[epoch]; 
-    if ( INPUTS.KCORFLAG_STRETCH == 1 ) { Trest /= GENLC.STRETCH ; }
+  // Created July 2016
+  // [for spectra refactor, move code from main to here]
+  // Driver routine to generate true mags at each epoch & passband.
+  //
+  // Aut 17 2017: call get_lightCurveWidth
 
-    AVwarp  = GENLC.AVwarp8[epoch] ;
-    MWXT  = get_mwxt8__(&ifilt_obs, &Trest, &z, &AVwarp, &mwebv, &RV, &OPT);
-      
-    // increment observer-frame magnitude.
-    GENLC.genmag8_obs[epoch] += MWXT ;      
+  int ifilt, ifilt_obs, DOFILT ;
+  int NEPCUT = INPUTS.CUTWIN_NEPOCH[0];
+  char fnam[] = "GENMAG_DRIVER" ;
 
+  // -------------- BEGIN ---------------
 
-  } // end of epoch loop
+  genran_modelSmear(); // randoms for intrinsic scatter
 
+  // Oct 2026: SALT2 mags for all bands & epochs in one call;
+  //           genmodel below then only applies smearing per band.
+  GENLC.GENMAG_EVENT_DONE = 0 ;
+  if ( INDEX_GENMODEL == MODEL_SALT2 ) { genmodel_SALT2_EVENT(); }
 
+  // this loop is to generate ideal mag in each filter.
+  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
+    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt] ;
 
-} // end of genmag_MWXT
+    DOFILT = GENLC.DOFILT[ifilt_obs] ;
 
+    if ( DOFILT == 0 ) { continue ; }
+    
+    genmodel(ifilt_obs,1); 
 
-// ************************************
-int NEPFILT_GENLC(
-		int opt   // (I) +1 => retrieve from GENLC,  -1 => load GENLC
-		,int ifilt_obs  // (I) 
-		) {
 
-  // Returns number of 'ifilt_obs' epochs stored in GENLC & GENFILT
-  // Fill GENFILT structure for 'ifilt_obs;
-  // loads epochs in order for each filter so that epoch-array
-  // can be passed to genmag_xxx functions.
+    if ( GENFRAME_OPT == GENFRAME_REST ) {
+      genmodel(ifilt_obs,2);      // 2nd nearest filter
+      genmodel(ifilt_obs,3);      // 3rd nearest filter
+    } 
+  } // ifilt
+ 
 
-  int  epoch, ifilt_tmp, NEP ;
-  double Trest1, Trest2, Tdif;
+  // spaghetti hack to pass LCLIB redshift and compute HOSTLIB photo-z
+  gen_redshift_LCLIB();
 
-  char fnam[] = "NEPFILT_GENLC" ;
+  // if generation is in rest frame, apply generic "boost" 
+  // to observer frame
+  if ( GENFRAME_OPT == GENFRAME_REST ) {
+    genmag_boost();           // warp rest-frame SED and apply KCOR      
+    genmag_MWXT_fromKcor() ;  //  apply MilkyWay extinction
+  }
 
-  // --------------- BEGIN -------------
+  // Mar 2016: apply filter-dependent MAGOFF and load peakMag per band
+  genmag_offsets();
+ 
 
-  NEP = 0;
+  // estimate light-curve Width in each band (Aug 17 2017)
+  compute_lightCurveWidths();
 
-  for ( epoch = 1; epoch <= GENLC.NEPOCH; epoch++ ) {
+  return ;
 
-    ifilt_tmp = GENLC.IFILT_OBS[epoch];
+} // end GENMAG_DRIVER
 
-    if ( ifilt_tmp == ifilt_obs ) {
-      NEP++ ;
 
-      if ( NEP >= MXEPSIM_PERFILT ) {
-	sprintf(c1err,"NEP=%d exceeds bound for ifilt_obs=%d(%c).",  
-		NEP, ifilt_obs, FILTERSTRING[ifilt_obs] );
-	sprintf(c2err,"%s", "Check MXEPSIM_PERFILT");
-	errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
-      }
+// *********************************************
+void GENFLUX_DRIVER(void) {
 
-      if ( opt == +1 ) {
+  // Created July 2016
+  // [for spectra refactor, move code from main to here]
+  // Driver routine to generate observed fluxes and uncertainties
+  // from true/generated mags.
+  //
+  // May 2018: set GENLC.NOBS_SATURATE
+  // Oct 30 2018: fix bug setting L_SATURATE
 
-	GENFILT.Trest8[ifilt_obs][NEP]   = GENLC.epoch8_rest[epoch];
-	GENFILT.Tobs8[ifilt_obs][NEP]    = GENLC.epoch8_obs[epoch];
+  int epoch, istat, ifilt_obs, ISPEAK, L_ERRPOS, L_UNDEFINED, L_SATURATE ;
+  int VBOSE_SMEAR = 0;
+  double genmag, obsmag;
+  char fnam[] = "GENFLUX_DRIVER" ;
 
-	GENFILT.genmag8_obs[ifilt_obs][NEP]    = GENLC.genmag8_obs[epoch];
-	GENFILT.genmag8_rest[ifilt_obs][NEP]   = GENLC.genmag8_rest[epoch];
-	GENFILT.genmag8_rest2[ifilt_obs][NEP]  = GENLC.genmag8_rest2[epoch];
-	GENFILT.genmag8_rest3[ifilt_obs][NEP]  = GENLC.genmag8_rest3[epoch];
+  // -------------- BEGIN ---------------
 
-	GENFILT.genmag8_smear[ifilt_obs][NEP]  = GENLC.magsmear8[epoch];
+  genran_obsNoise();   // randoms for instrumental noise
 
-	GENFILT.generr8_obs[ifilt_obs][NEP]    = GENLC.generr8_obs[epoch];
-	GENFILT.generr8_rest[ifilt_obs][NEP]   = GENLC.generr8_rest[epoch];
-	GENFILT.generr8_rest2[ifilt_obs][NEP]  = GENLC.generr8_rest2[epoch];
+  for ( epoch = 1; epoch <= GENLC.NEPOCH; epoch++ ) {
 
-	//printf(" xxx load Trest(%c=%d) = %f at  epoch=%d,  FILTEPOCH=%d \n", 
-	// FILTERSTRING[ifilt_obs], ifilt_obs, GENLC.epoch8_rest[epoch], epoch,NEP);
-      }
-      else if ( opt == -1 ) {
+    ifilt_obs = GENLC.IFILT_OBS[epoch] ;
+    if ( GENLC.DOFILT[ifilt_obs] == 0 ) { continue ; }
 
-	// first make sure that Trest matches up
+    if (   GENLC.ISPEAK[epoch]      ) { continue; }
+    if (   GENLC.ISTEMPLATE[epoch]  ) { continue; }
 
-	Trest1	= GENFILT.Trest8[ifilt_obs][NEP] ;
-	Trest2  = GENLC.epoch8_rest[epoch];
-	Tdif    = fabs(Trest1-Trest2) ;
-	if ( Tdif > 0.001 ) {
-	  sprintf(c1err,"GENFILT[ifilt_obs=%d][NEP=%d] = %8.3f", 
-		  ifilt_obs, NEP, Trest1);
-	  sprintf(c2err,"GENLC.epoch8_rest[ep=%d]=%8.3f  (Tdif=%8.3f) \n", 
-		  epoch, Trest2, Tdif );
-	  errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
-	}
+    // convert 'genmag' into Possion-smeared mag and flux
+    istat =  gen_smearFlux ( epoch, VBOSE_SMEAR );
+    istat =  gen_smearMag  ( epoch, VBOSE_SMEAR );
 
-	GENLC.genmag8_obs[epoch]   = GENFILT.genmag8_obs[ifilt_obs][NEP] ;
-	GENLC.genmag8_rest[epoch]  = GENFILT.genmag8_rest[ifilt_obs][NEP] ; 
-	GENLC.genmag8_rest2[epoch] = GENFILT.genmag8_rest2[ifilt_obs][NEP] ; 
-	GENLC.genmag8_rest3[epoch] = GENFILT.genmag8_rest3[ifilt_obs][NEP] ; 
+    obsmag      = GENLC.mag[epoch];
+    genmag      = GENLC.genmag8_obs[epoch] ;
+    L_ERRPOS    = (GENLC.flux_errstat[epoch] > 0 );
+    L_UNDEFINED = (genmag == MAG_UNDEFINED) ; // model undefined
+    L_SATURATE  = (obsmag == MAG_SATURATE ) ;    
 
-	GENLC.magsmear8[epoch]   = GENFILT.genmag8_smear[ifilt_obs][NEP] ;
+    if ( L_UNDEFINED ) 
+	{ GENLC.NOBS_UNDEFINED++ ; } // model is undefined 
 
-	GENLC.generr8_obs[epoch]   = GENFILT.generr8_obs[ifilt_obs][NEP] ;
-	GENLC.generr8_rest[epoch]  = GENFILT.generr8_rest[ifilt_obs][NEP] ;
-	GENLC.generr8_rest2[epoch] = GENFILT.generr8_rest2[ifilt_obs][NEP] ;
+    if ( L_ERRPOS ) {
+      if ( !L_UNDEFINED ) { 
+	GENLC.USE_EPOCH[epoch] = 1 ; 
+	GENLC.NOBS++ ;
+	GENLC.NOBS_FILTER[ifilt_obs]++ ;
       }
-    }
+  
+      if ( L_SATURATE ) { 
+	GENLC.NOBS_SATURATE[1]++ ; 
+	GENLC.NOBS_SATURATE_FILTER[1][ifilt_obs]++ ; 
+      }
+      else {
+	// number of unsaturated epochs
+	GENLC.NOBS_SATURATE[0]++; 
+	GENLC.NOBS_SATURATE_FILTER[0][ifilt_obs]++ ; 
+      }
+    } // end L_ERRPOS
 
-  }
+  }  // end of epoch loop
+  
 
-  return NEP ;
+  return ;
 
+} // end GENFLUX_DRIVER
 
-}  // end of NEPFILT_GENLC
 
+// **************************************
+void compute_lightCurveWidths(void) {
 
-// ************************************
-void init_genmodel(void) {
+  // call gen_lightCurveWidth for each band,
+  // and store GENLC.WIDTH[ifilt_obs].
+  // These quantities are for SIMGEN_DUMP file
+  // (varNames WIDTH_[band] ).
 
-  /**********
-  History:
+  int ifilt, ifilt_obs, N, ep, NEP[MXFILTINDX], ERRFLAG ;
+  int MEM = (GENLC.NEPOCH+1) * sizeof(double) ;
+  int OPTMASK = 1 ;
+  double Width, *TLIST[MXFILTINDX], *MAGLIST[MXFILTINDX] ;
+  char FUNCALL[100], cfilt[2] ;
+  char fnam[] = "compute_lightCurveWidths" ;
+  
+  // --------------- BEGIN -------------
 
+  if ( GENLC.NWIDTH_SIMGEN_DUMP == 0 ) { return ; }
 
- Feb 13, 2012: 
-    make calls to get_LAMRANGE_[model] to fill  GENLC.RESTLAM_MODEL[2].
-    Init GENLC.RESTLAM_MODEL to be wide open before calling get_LAMRANGE_XXX.
+  // first allocate memory to store LC separately in each band.
+  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
+    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
+    GENLC.WIDTH[ifilt_obs] = -9.0 ; // init to undefined
+    if ( GENLC.DOFILT[ifilt_obs] == 0 ) { continue ; }
+    TLIST[ifilt_obs]   = (double*)malloc(MEM);
+    MAGLIST[ifilt_obs] = (double*)malloc(MEM);
+    NEP[ifilt_obs]     = 0 ;
+  }
 
- Apr 7, 2012: set IFLAG_GENSMEAR
+  // load LC for each band
 
- Jul 20 2018: for LCLIB model, set GENRANGE_PEAKMJD= start of season,
-              and GENRANGE_TREST = 0 to MJDLAST
+  for(ep=1; ep <= GENLC.NEPOCH; ep++ ) {
+    ifilt_obs = GENLC.IFILT_OBS[ep] ;    
+    if ( GENLC.DOFILT[ifilt_obs] == 0 ) { continue ; }
+    N = NEP[ifilt_obs];
+    TLIST[ifilt_obs][N]   = GENLC.epoch8_obs[ep] ;
+    MAGLIST[ifilt_obs][N] = GENLC.genmag8_obs[ep] ;
+    NEP[ifilt_obs]++ ;
+  }
+ 
 
-  ************/
+  // compute Width, then free memory
+  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
+    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
+    if ( GENLC.DOFILT[ifilt_obs] == 0 ) { continue ; }
 
-  char *GENMODEL        = INPUTS.GENMODEL;
-  char *GENMODEL_EXTRAP = INPUTS.GENMODEL_EXTRAP_LATETIME ;
+    // construct error-message string
+    sprintf(cfilt, "%c", FILTERSTRING[ifilt_obs] );
+    sprintf(FUNCALL, "%s(%s)", fnam, cfilt);
+    
+    //      printf(" xxx ------------------ \n");
+    //      printf(" xxx PEAKMJD = %.3f  LIBID=%d \n",
+    //	     GENLC.PEAKMJD, GENLC.SIMLIB_ID );
+  GENLC.WIDTH[ifilt_obs] = 
+    get_lightCurveWidth(OPTMASK, NEP[ifilt_obs], 
+			TLIST[ifilt_obs], MAGLIST[ifilt_obs], &ERRFLAG,FUNCALL);
+    
+    // free memory for this band
+    free(TLIST[ifilt_obs]);  free(MAGLIST[ifilt_obs]);
+  }
 
-  char  covFile[] = ""  ;
-  char *ARGLIST ;
-  int istat, OPTMASK, NZ, ifilt, ifilt_obs, ifilt_rest ;
-  double dummy[10];
-  float scale_covar_flt ;
-  char fnam[] = "init_genmodel" ;
+  return ;
 
-  //--------- BEGIN --------
+} // end compute_lightCurveWidths
 
-  // init a few things
-  for ( ifilt_obs=0; ifilt_obs < MXFILTINDX; ifilt_obs++ ) {
-    NSKIP_FILTER[ifilt_obs] = 0;
-    ZVALID_FILTER[0][ifilt_obs] =  +999. ;
-    ZVALID_FILTER[1][ifilt_obs] =  -999. ;
-  }
 
-  GENLC.RESTLAM_MODEL[0] =  1000. ;
-  GENLC.RESTLAM_MODEL[1] = 30000.0 ;
+// *********************************************
+void genmodel(
+	      int ifilt_obs  // observer filter index 
+	      ,int inear      // 1=>nearest rest-filter; 2=2nd nearest
+	      ) {
 
-  // default is to generate intrinsic smearing at center of filter only
-  IFLAG_GENSMEAR = IFLAG_GENSMEAR_FILT ;
+  /*********
+   Generate magnitude at each epoch according to model.
+   Output is GENLC.genmag8_obs[ifilt][epoch] for obs-frame model,
+   or GENLC.genmag8_rest[ifilt][epoch] for rest frame model.
+   Note that for rest-frame models, genmag_boost transforms
+   rest-frame mags to observer frame.
 
-  LGEN_SNIA = 0 ;
+  ***********/
 
-    // =========================
+  int
+    istat, ifilt_tmp, ifilt_rest, iep
+    ,NEPFILT, NGRID, NEPFILT_SAVE
+    ,index, isp, OPTMASK, NPAR
+    ;
 
-  if ( INDEX_GENMODEL == MODEL_STRETCH ) {
+  double 
+    z, zz, mu, stretch[2], delta, dm15, av, RV, AV, tmpdif
+    ,errtmp, mwebv, Tep, Tshift, dummy
+    ,Tmodel[MXEPSIM], TGRID[MXEPSIM]    
+    ,*ptr_genmag, *ptr_generr, *ptr_epoch
+    ;
 
-    init_genmag_stretch2(GENMODEL, GENLC.FILTLIST_REST );
-    LGEN_SNIA = 1 ;
-  }
+  char  model[40], cfilt_obs[2], cfilt_rest[2]    ;
 
-  else if ( INDEX_GENMODEL == MODEL_FIXMAG ) {
-    GENLC.SIMTYPE  = MODEL_FIXMAG ;
-    // xxx mark delete  GENLC.SIMTYPE  = (int)INPUTS.FIXMAG[0] ;
-  }
-  else if ( INDEX_GENMODEL == MODEL_MLCS2k2 ) {
+  char fnam[] = "genmodel" ;
 
-    scale_covar_flt = 1.0;  // 5/02/2009: scale error at mag-smear stage
-    istat = init_genmag_mlcs2k2(GENMODEL, covFile, scale_covar_flt, 
-				GENLC.FILTLIST_REST );
-    get_LAMRANGE_mlcs2k2(&GENLC.RESTLAM_MODEL[0], &GENLC.RESTLAM_MODEL[1] );
-    LGEN_SNIA = 1 ;
-  }
+  // -------- BEGIN ---------
 
-  else if ( INDEX_GENMODEL == MODEL_SNOOPY ) {
+  // create temp structure with epoch-list for this filter
+  NEPFILT = NEPFILT_GENLC(1,ifilt_obs);
 
-    OPTMASK = 0;
-#ifdef SNGRIDGEN
-    NZ = GRIDGEN_INPUTS.NBIN[IPAR_GRIDGEN_LOGZ];    
-    if ( NZ == 1 ) { OPTMASK = 1; }
-#endif
-    init_genmag_snoopy(GENMODEL, OPTMASK, dummy, GENLC.FILTLIST_REST );
+  // make local copy of model
+  sprintf(model, "%s", INPUTS.MODELNAME );
+  sprintf(cfilt_obs,  "%c", FILTERSTRING[ifilt_obs] );
 
-    get_LAMRANGE_snoopy(&GENLC.RESTLAM_MODEL[0], &GENLC.RESTLAM_MODEL[1] );
-    LGEN_SNIA = 1 ;
+  if ( GENFRAME_OPT == GENFRAME_REST ) {
+    z      = ZAT10PC ; 
+    av     = 0.0; 
+    mu     = 0.0;
+    mwebv  = -9.0; // not used for mlcs
+  }
+  else {
+    z      = GENLC.REDSHIFT_HELIO ;
+    av     = GENLC.AV ;
+    mwebv  = GENLC.MWEBV_SMEAR ; // smeared value, not sigma
+    mu     = GENLC.DLMU ;
   }
 
-  else if ( INDEX_GENMODEL == MODEL_S11DM15 ) {
 
-    // init generic part of any SEDMODEL (filter & primary ref)
-    init_genSEDMODEL();
+  zz = 1. + z ;
+  stretch[0]   = GENLC.STRETCH ;
+  stretch[1]   = GENLC.STRETCH ;
+  delta        = GENLC.DELTA;  // for MLCS model
+  dm15         = GENLC.DM15;
+  RV           = GENLC.RV ;
+  AV           = GENLC.AV ;
+  ifilt_rest = -9;
+  ptr_genmag = ptr_generr = &dummy; // avoid compile warning
 
-    OPTMASK = 0 ;
-    istat = init_genmag_S11DM15(GENMODEL,OPTMASK);
-    LGEN_SNIA = 1 ;
-  }
+  if ( GENFRAME_OPT == GENFRAME_REST ) {
 
-  else if ( INDEX_GENMODEL == MODEL_SALT2 ) {
+    ptr_epoch    = &GENFILT.Trest8[ifilt_obs][1] ;
 
-    // init generic part of any SEDMODEL (filter & primary ref)
-    init_genSEDMODEL();
+    if ( inear == 1 ) {
+      ptr_genmag   = &GENFILT.genmag8_rest[ifilt_obs][1];
+      ptr_generr   = &GENFILT.generr8_rest[ifilt_obs][1];
+      ifilt_rest   = GENLC.IFILTMAP_REST1[ifilt_obs];
+    }
+    else if ( inear == 2 ) {
+      ptr_genmag   = &GENFILT.genmag8_rest2[ifilt_obs][1];
+      ptr_generr   = &GENFILT.generr8_rest2[ifilt_obs][1];
+      ifilt_rest   = GENLC.IFILTMAP_REST2[ifilt_obs];
+    }
+    else if ( inear == 3 ) {
 
-    // model-specific init
-    OPTMASK = 0; 
-    if ( INPUTS.LEGACY_colorXTMW_SALT2 ) { OPTMASK += 128 ; }
+      // to save CPU, only do the 3rd filter if it is nearly as 
+      // close to filt1 as the 2nd closest filter.
 
-    istat = init_genmag_SALT2(GENMODEL, GENMODEL_EXTRAP, OPTMASK) ;
+      tmpdif  = GENLC.LAMDIF_REST3[ifilt_obs] - GENLC.LAMDIF_REST2[ifilt_obs];
+      if ( tmpdif > 300.0 ) return ;  // beware hard-wired cut in Angstroms
 
-    get_LAMRANGE_SEDMODEL(1,&GENLC.RESTLAM_MODEL[0],&GENLC.RESTLAM_MODEL[1] );
+      if ( tmpdif < 0.0 ) {
+	sprintf(c1err,"GENLC.LAMDIF_REST(2,3)[ifilt_obs=%d] = %6.0f,%6.0f"
+		,ifilt_obs
+		,GENLC.LAMDIF_REST2[ifilt_obs]
+		,GENLC.LAMDIF_REST3[ifilt_obs] );
 
-    if ( istat != 0 ) {
-      sprintf(c1err,"init_genmag_SALT2 failed.");
-      errmsg(SEV_FATAL, 0, fnam, c1err, "" ); 
+	sprintf(c2err,"But LAMDIF_REST3 should be larger than LAMDIF_REST2");
+	errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+      }
+
+      ptr_genmag   = &GENFILT.genmag8_rest3[ifilt_obs][1];
+      ptr_generr   = &GENFILT.generr8_rest3[ifilt_obs][1];
+      ifilt_rest   = GENLC.IFILTMAP_REST3[ifilt_obs];
     }
 
-    // set flag to generate intrinsic smear vs. wavelength
-    // (inside genmag_SALT2).
-    IFLAG_GENSMEAR = IFLAG_GENSMEAR_LAM ;
-    LGEN_SNIA = 1 ;
-  }
+    sprintf(cfilt_rest, "%c", FILTERSTRING[ifilt_rest] );
 
-  else if ( INDEX_GENMODEL == MODEL_SIMSED ) {
+  }
+  else {
+    // observer-frame model
+    ptr_genmag   = &GENFILT.genmag8_obs[ifilt_obs][1] ;
+    ptr_epoch    = &GENFILT.Tobs8[ifilt_obs][1] ;
+    ptr_generr   = &GENFILT.generr8_obs[ifilt_obs][1];    
+  } 
 
-    // init generic part of any SEDMODEL (filter & primary ref)
-    init_genSEDMODEL();
 
-    // model-specific init
+  // - - - - - - 
+  // Aug 20, 2008
+  // convert ptr_epoch to account for perturbing the
+  // light curve shape such as changing the rise time.
+  // Note that shift is positive for positive risetime shifts,
+  // and negative for positive falltime shifts.
+  for ( iep=0; iep <= NEPFILT ; iep++ ) {
+    Tep    = ptr_epoch[iep] ;
+    Tshift = genmodel_Tshift(Tep,z); // generate epoch shift    
+    Tmodel[iep] = Tep + Tshift ;
+  }
+  // change epoch-pointer to local array
+  ptr_epoch = Tmodel ;
 
-    OPTMASK = INPUTS.GENMODEL_MSKOPT ;
-    if( INPUTS.USE_BINARY_SIMSED > 0 ) { OPTMASK += 1; }
 
-    istat = init_genmag_SIMSED (INPUTS.GENMODEL
-			       ,INPUTS.PATH_BINARY_SIMSED
-			       ,GENLC.SURVEY_NAME
-			       ,INPUTS.KCOR_FILE
-			       ,OPTMASK );
+  // check option to interpolate model on an Epoch grid.
+  // e.g., to mimic interpolated fakes on images.
+  if ( INPUTS.TGRIDSTEP_MODEL_INTERP > 0.001 ) {
+    NEPFILT_SAVE  = NEPFILT ;
+    NGRID     = setEpochGrid( Tmodel[0], Tmodel[NEPFILT-2], TGRID );
+    NEPFILT   = NGRID ;
+    ptr_epoch = TGRID ;  // TGRID returned from setEpochGrid
+  }
+  else
+    { NGRID = NEPFILT_SAVE = 0 ; }
 
-    get_LAMRANGE_SEDMODEL(1,&GENLC.RESTLAM_MODEL[0], &GENLC.RESTLAM_MODEL[1] );
-    
-    if ( istat == 0 ) {
-      sprintf(c1err,"init_genmag_SIMSED failed.");
-      errmsg(SEV_FATAL, 0, fnam, c1err, "" ); 
-    }
 
-    // check that SIMSED parameters in sim-input file match
-    // those in the SIMSED model.
-    checkpar_SIMSED();
-    LGEN_SNIA = 0 ;  // July 2017
-  }
+  // -------------------------------------------
+  // -------------------------------------------
+  // -------------------------------------------
 
-  else if ( INDEX_GENMODEL == MODEL_BYOSED ) {
+  if (  INDEX_GENMODEL  == MODEL_STRETCH ) {
 
-    OPTMASK  = INPUTS.GENMODEL_MSKOPT;
-    ARGLIST  = INPUTS.GENMODEL_ARGLIST;
+    // this model can generate rest or observer frame
 
-    // init generic part of any SEDMODEL (filter & primary ref)
-    init_genSEDMODEL();
-    init_genmag_BYOSED( INPUTS.MODELPATH, OPTMASK, ARGLIST );
-  }
+    istat = 
+      genmag_stretch2 
+	(
+	 stretch[0]              // (I) rise-time stretch
+	 ,stretch[1]             // (I) fall-time stretch
+	 ,ifilt_rest          // (I) absolute rest-filter index
+	 ,NEPFILT             // (I) number of epochs passed
+	 ,ptr_epoch           // (I) Tobs-Tpeak (days)
+	 ,ptr_genmag          // (O) perfect magnitudes
+	 ,ptr_generr          // (O) ideal rest mag-errs
+	 );
 
-  else if ( INDEX_GENMODEL == MODEL_NON1ASED ) {
 
-    INPUTS.NON1ASED.NGENTOT  = INPUTS.NGEN ;
-    INPUTS.NON1ASED.CIDOFF   = INPUTS.CIDOFF ;
-    GENLC.NON1ASED.IFLAG_GEN = GENLC.IFLAG_GENSOURCE ;
-    
-    GENLC.NON1ASED.FRAC_PEC1A = INPUTS.RATEPAR_PEC1A.SEASON_FRAC ;
-    prep_NON1ASED( &INPUTS.NON1ASED, &GENLC.NON1ASED );
+    // cap errors at .25 mag to avoid ridiculous light curves
+    // from blown-up U,R,I errors (blown up for fitter)
 
-    init_genSEDMODEL();       // pass filters and primary ref
-    init_genmag_NON1ASED(-9,&INPUTS.NON1ASED); // do one-time inits for SEDs
-  }
-  else if ( INDEX_GENMODEL == MODEL_NON1AGRID ) {
-    double FRAC_PEC1A = INPUTS.RATEPAR_PEC1A.SEASON_FRAC ;
-    init_genmag_NON1AGRID(INPUTS.NON1AGRID_FILE, FRAC_PEC1A );
-  }
-  else if ( INDEX_GENMODEL == MODEL_LCLIB ) {
-    
-    double TOBS_RANGE_MAX = INPUTS.GENRANGE_MJD[1] - INPUTS.GENRANGE_MJD[0];
-    int    IFLAG_RANSTART = (INPUTS.JOBID>0) ;
-    OPTMASK = INPUTS.GENMODEL_MSKOPT ;
-    init_genmag_LCLIB(INPUTS.LCLIB_FILE, INPUTS.LCLIB_TEMPLATE_EPOCHS,
-		      GENLC.SURVEY_NAME, INPUTS.GENFILTERS,
-		      TOBS_RANGE_MAX, INPUTS.NGEN, IFLAG_RANSTART, OPTMASK );
-    
-    //  Aug 22 2017:
-    //  Hack ugly spaghetti code to run INIT_HOSTLIB if LCLIB has a 
-    //  REDSHIFT parameter. Note that redshift range is read from 
-    //  the LCLIB header, not from sim-input file.
-    //  SHOULD AVOID USING LCLIB MODEL for EXTRA-GALACTIC models.
-    if ( LCLIB_INFO.IPAR_REDSHIFT >= 0 && LCLIB_INFO.HOSTLIB_MSKOPT>0 )  { 
-      INPUTS.GENRANGE_REDSHIFT[0] = LCLIB_INFO.REDSHIFT_RANGE[0] ;
-      INPUTS.GENRANGE_REDSHIFT[1] = LCLIB_INFO.REDSHIFT_RANGE[1] ;
-      INPUTS.HOSTLIB_MSKOPT       = LCLIB_INFO.HOSTLIB_MSKOPT ;
-      INPUTS.HOSTLIB_USE          = 1 ;
-      INIT_HOSTLIB(); 
-    }
-    else {
-      sprintf(INPUTS.HOSTLIB_FILE,"NONE");              // no host  
-      sprintf(INPUTS_SEARCHEFF.USER_zHOST_FILE,"ZERO"); // force EFF_zHOST=0
+    for ( iep=0; iep<NEPFILT; iep++ ) {
+      errtmp = ptr_generr[iep];
+      if ( errtmp > .25 ) { errtmp = .25 ; }
+      ptr_generr[iep] = errtmp ;
     }
 
-  }     // end LCLIB if block
-
-  else {
-    sprintf(c1err,"%s is not a valid genmag-model", INPUTS.MODELNAME);
-    sprintf(c2err,"Check GENMODEL keyword in input file.");
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
   }
 
+  else if ( INDEX_GENMODEL  == MODEL_FIXMAG ) {
 
-  // convert char-filter list into integer map and inverse map
-
-  if ( GENFRAME_OPT == GENFRAME_REST ) {
+    GENLC.FIXMAG = GENLC.NOSHAPE ;
 
-    printf("\n Rest-frame MODEL FILTERS : '%s' \n", GENLC.FILTLIST_REST );
+    for ( iep = 0 ; iep < NEPFILT; iep++ ) {
+      ptr_genmag[iep] = GENLC.FIXMAG ;
+      ptr_generr[iep] = 0.0 ;
+    }
 
-    GENLC.NFILTDEF_REST = 
-      PARSE_FILTLIST(GENLC.FILTLIST_REST, GENLC.IFILTMAP_REST) ;
+    sprintf(GENLC.SNTYPE_NAME, "%s", INPUTS.MODELNAME ); 
+    GENLC.TEMPLATE_INDEX = MODEL_FIXMAG ;  //anything but zero
 
-    // create inverse map need for genmag_mlcs2k2().
-    for ( ifilt=0 ; ifilt < GENLC.NFILTDEF_REST ; ifilt++ ) {
-      ifilt_rest = GENLC.IFILTMAP_REST[ifilt] ;
-      GENLC.IFILTINVMAP_REST[ifilt_rest] = ifilt;
+    /* xxx mark delete April 24 2019 xxxxxxxx
+    if ( strcmp(INPUTS.MODELNAME,"FIXMAG") == 0 ) {
+      sprintf(GENLC.SNTYPE_NAME, "FIXMAG" ); 
+      GENLC.TEMPLATE_INDEX = MODEL_FIXMAG ;  //anything but zero
     }
-
-    if ( INDEX_GENMODEL == MODEL_MLCS2k2 )   init_covar_mlcs2k2(); 
+    else {
+      sprintf(GENLC.SNTYPE_NAME, "RANMAG" ); 
+      GENLC.TEMPLATE_INDEX = (int)INPUTS.FIXMAG[0] ;
+    }
+    xxxxxxxxxxx end mark xxxxxxxxxxxxx */
 
   }
+  else if ( INDEX_GENMODEL  == MODEL_MLCS2k2 ) {
 
-  if ( LGEN_SNIA ) 
-    { GENLC.SIMTYPE  = INPUTS.SNTYPE_Ia_SPEC ; }
+    // define function to translage ifilt_rest into ifilt_model(ifilt_rest]
+    ifilt_tmp  = GENLC.IFILTINVMAP_REST[ifilt_rest] ;
 
-  if ( INPUTS.GENTYPE_SPEC > 0 ) 
-    { GENLC.SIMTYPE  = INPUTS.GENTYPE_SPEC ; }
- 
-  return ;
+    genmag_mlcs2k2( 
+		   ifilt_tmp          // (I) 0-8 => UBVRIYJHK
+		   ,delta             // (I) shape parameter 
+		   ,NEPFILT           // (I) number of epochs
+		   ,ptr_epoch         // (I) Trest-Tpeak (days)
+		   ,ptr_genmag        // (O) ideal rest mags
+		   ,ptr_generr        // (O) ideal rest mag-errs
+		   ) ;
 
-}  // end of init_genmodel
+  }
 
+  else if ( INDEX_GENMODEL  == MODEL_SALT2 ) {
 
-// *********************************
-void init_genSEDMODEL(void) {
+    // 1: bit0 => return flux instead of mag;
+    // 2: bit1 => print warning when flux < 0
+    // 8: bit3 => SALT2 dump
 
-  // Created Oct 15, 2009 by R.Kessler
-  // Perform generic part of initialization for observer-frame
-  // SED model.
-  //
-  // Read K-cor files to fetch primary SED and filter-responses.
-  // Note  that the K-corrections tables are NOT used.
-  //
-  // Dec 19, 2011: abort if zmin <= 1.E-9
-  // Dec 14, 2013: include safety margin on zmin,zmax to allow for
-  //               zcmb -> zhelio because we generate zcmb, but
-  //               generate with zhelio.
-  //
-  // Jan 23, 2014: call extraFilters_4genSmear( ...) to determine
-  //               extra filters needed by genSmear functions.
-  //               See NFILT_extra and IFILTOBS_extra.
-  //
-  // --------------------
-  char  fnam[] = "init_genSEDMODEL" ;
-  char  filtName[40], cfilt[2]    ;
+    OPTMASK      = 0 ; // return mag
+                      
+    /*
+    printf(" xxx passing ifilt_obs=%d x0=%f x1=%f c=%f \n",
+	   ifilt_obs,GENLC.SALT2x0, GENLC.SALT2x1, GENLC.SALT2c );
+    */
+    // apply scatter matrix
+    double S2x0, S2x1, S2c ;
+    getpar_SALT2_SCATTER(&S2x0, &S2x1, &S2c);
 
-  int 
-    ifilt, ifilt_obs
-    ,NLAM, NFILT, NZBIN, NFILT_extra, LEN=40
-    ,DONEFILT[MXFILTINDX]
-    ,IFILTLOCAL[MXFILTINDX]
-    ,IFILTOBS_extra[MXFILTINDX]
-    ,MASKFRAME[MXFILTINDX]      
-    ;
-  
-  double  lamshift, magprim, zmin, zmax, dz, z1min, z1max,logzdif  ;
+    // Oct 2026: skip if mags were already computed for all bands;
+    //           GENFILT arrays were loaded above by NEPFILT_GENLC.
+    if ( !GENLC.GENMAG_EVENT_DONE ) {
+      genmag_SALT2 (
+		  OPTMASK         // (I) bit-mask options
+		  ,ifilt_obs      // (I) obs filter index 
+		  ,S2x0           // (I) x0 term
+		  ,S2x1,S2x1      // (I) x1 and x1 used for error calc.
+		  ,S2c            // (I) SN color: E(B-V)
+		  ,mwebv          // (I) Galactic E(B-V)
+		  ,RV, AV         // (I) host extinc params (July 2016)
+		  ,z,z            // (I) redshift, and z used for error
+		  ,NEPFILT        // (I) number of epochs
+		  ,ptr_epoch         // (I) obs-frame time (days)
+		  ,ptr_genmag        // (O) mag vs. Tobs
+		  ,ptr_generr        // (O) mag-errs
+		  ) ;    
+    }
+  }
 
-  // ------------ BEGIN -------------
+  else if ( INDEX_GENMODEL  == MODEL_SIMSED ) {
 
-  reset_SEDMODEL();
+    // 1: bit0=> return flux instead of mag;
+    // 2: bit1 => print warning when flux < 0
 
-  // allocate temporary arrays to hold primary SED and filter trans.
-  int MEMD = MXLAMSIM * sizeof(double);
-  genSEDMODEL.lam         = (double*) malloc( MEMD );
-  genSEDMODEL.primaryFlux = (double*) malloc( MEMD );
-  genSEDMODEL.TransSN     = (double*) malloc( MEMD );
-  genSEDMODEL.TransREF    = (double*) malloc( MEMD );
+    NPAR         = INPUTS.NPAR_SIMSED;
 
+    OPTMASK      =  0              // 0->return mags   
+      + INPUTS.OPTMASK_SIMSED      // 4 => sequential GRIDONLY option
+      ;
 
-  // -----------
-  sprintf(GENLC.primary,"%s", "NULL");
-  get_primary__(GENLC.primary, &NLAM, 
-		genSEDMODEL.lam, genSEDMODEL.primaryFlux, LEN) ;
-  //		strlen(GENLC.primary) );
+    //    if ( GENLC.CID==19201 && ifilt_obs==1 ) { OPTMASK += 8 ; }
+    
+    genmag_SIMSED (
+		  OPTMASK            // (I) bit-mask options
+		  ,ifilt_obs         // (I) obs filter index 
+		  ,GENLC.SALT2x0     // (I) x0 (flux-scale)
+		  ,NPAR              // (I) Number of SIMSED pars + baggage
+		  ,INPUTS.GENFLAG_SIMSED // (I) SIMSED flag per param
+		  ,GENLC.SIMSED_IPARMAP  // (I) ipar map
+		  ,GENLC.SIMSED_PARVAL   // (I) SIMSED gen params (lumipar)
+		  ,GENLC.RV, GENLC.AV        // (I) added Mar 1 2017
+		  ,mwebv             // (I) Galactic E(B-V)
+		  ,z                 // (I) redshift
+		  ,NEPFILT           // (I) number of epochs
+		  ,ptr_epoch         // (I) rest-frame time (days)
+		  ,ptr_genmag        // (O) mag vs. Tobs
+		  ,ptr_generr        // (O) ideal rest mag-errs
+		  ,&GENLC.TEMPLATE_INDEX // (O) SED index
+		  ) ;
 
-  init_primary_SEDMODEL( GENLC.primary, NLAM, 
-			 genSEDMODEL.lam, genSEDMODEL.primaryFlux );
+    if ( INPUTS.OPTMASK_SIMSED == OPTMASK_SIMSED_GRIDONLY ) 
+      { GENLC.CID = GENLC.TEMPLATE_INDEX ; }
 
+  }
 
-  init_MWXT_SEDMODEL(INPUTS.OPT_MWCOLORLAW, INPUTS.RV_MWCOLORLAW);
+  else if ( INDEX_GENMODEL  == MODEL_BYOSED ) {
 
-  // init z-range; include safety margin for zcmb->zhelio 
-  // and for VPEC
-  z1min    = 1. + INPUTS.GENRANGE_REDSHIFT[0] ;
-  z1max    = 1. + INPUTS.GENRANGE_REDSHIFT[1] ;
-  dz       = INPUTS.VEL_CMBAPEX/LIGHT_km  ;
-  dz      += INPUTS.GENSIGMA_VPEC*5.0/LIGHT_km ;  // 5sigma safety margin
-  zmin     = INPUTS.GENRANGE_REDSHIFT[0] - dz*z1min ;
-  zmax     = INPUTS.GENRANGE_REDSHIFT[1] + dz*z1max ;
+    double HOSTPAR_BYOSED[20];
+    HOSTPAR_BYOSED[0] = GENLC.RV ;
+    HOSTPAR_BYOSED[1] = GENLC.AV ;
+    HOSTPAR_BYOSED[2] = SNHOSTGAL.LOGMASS ;
 
-  if ( zmin <= 1.0E-9 ) {
-    sprintf(c1err, "Invalid zmin=%le (must be > 0)", zmin);
-    sprintf(c2err, "Check GENRANGE_REDSHIFT key in sim-input file." );
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    genmag_BYOSED(
+		  GENLC.CID
+		  ,z, GENLC.DLMU       // (I) helio-z and distance modulus
+		  ,mwebv               // (I) E(B-V) for Milky Way
+		  ,HOSTPAR_BYOSED      // (I) host properties
+		  ,ifilt_obs           // (I) filter index
+		  ,NEPFILT             // (I) number of epochs
+		  ,ptr_epoch           // (I) rest-frame time (days)
+		  ,ptr_genmag        // (O) mag vs. Tobs
+		  ,ptr_generr        // (O) ideal rest mag-errs
+		  );		  
   }
 
-  logzdif =  log10(zmax) - log10(zmin) ;
-  // xxx mark delete  NZBIN = (int)( 100. * logzdif ) + 1 ;
-  NZBIN = (int)( 50. * logzdif ) + 1 ;
-  init_redshift_SEDMODEL(NZBIN, zmin, zmax);
+  else if ( INDEX_GENMODEL  == MODEL_SNOOPY ) {
 
-  NFILT = INPUTS.NFILTDEF_OBS ;
-  for ( ifilt = 0; ifilt < MXFILTINDX; ifilt++ ) {
-    DONEFILT[ifilt]   = 0 ;
-    IFILTLOCAL[ifilt] = 0 ;
-    MASKFRAME[ifilt]  = GENFRAME_OBS ;
-    if ( ifilt < NFILT ) 
-      { IFILTLOCAL[ifilt] = INPUTS.IFILTMAP_OBS[ifilt]; }
-  }
+    ifilt_tmp = GENLC.IFILTINVMAP_REST[ifilt_rest] + 1 ;
+    genmag_snoopy (
+		   ifilt_tmp             // (I) SNoopY internal filter index
+		   ,dm15                 // (I) shape parameter 
+		   ,NEPFILT              // (I) number of epochs
+		   ,ptr_epoch            // (I) Trest-Tpeak (days)
+		   ,ptr_genmag           // (O) ideal rest mags
+		   ,ptr_generr           // (O) rest mag-errors
+		   );
 
+  }
 
-  // check for extra filters needed by the intrinsic scatter model.
-  extraFilters_4genSmear(INPUTS.GENMAG_SMEAR_MODELNAME,
-			 &NFILT_extra, IFILTOBS_extra) ;
+  else if ( INDEX_GENMODEL  == MODEL_S11DM15 ) {
 
-  printf("\n");
+    genmag_S11DM15(ifilt_obs, dm15, AV, RV, mwebv, z, mu,
+		   NEPFILT, ptr_epoch, ptr_genmag, ptr_generr);
 
-  for(ifilt=0; ifilt < NFILT_extra ; ifilt++ ) {
-    ifilt_obs           = IFILTOBS_extra[ifilt] ;
-    IFILTLOCAL[NFILT]   = ifilt_obs ;
-    MASKFRAME[NFILT]    = GENFRAME_OBS + GENFRAME_REST ; // check both
-    NFILT++ ;
-    sprintf(cfilt,  "%c", FILTERSTRING[ifilt_obs] ); 
-    printf("  %s : add %s filter needed by %s \n", 
-	   fnam, cfilt, INPUTS.GENMAG_SMEAR_MODELNAME ); fflush(stdout);
   }
 
+  else if (  INDEX_GENMODEL  == MODEL_NON1ASED ) {
 
-  // pass filter info to SEDMODEL generator
+    index    = GENLC.TEMPLATE_INDEX; 
+    isp      = GENLC.NON1ASED.ISPARSE ;
+    sprintf(GENLC.SNTYPE_NAME,  "%s", INPUTS.NON1ASED.LIST_TYPE[index] );
+    sprintf(GENLC.SNTEMPLATE,   "%s", INPUTS.NON1ASED.LIST_NAME[index] );
+    sprintf(GENLC.NON1ASED.TYPE[isp], "%s", GENLC.SNTYPE_NAME );
 
-  for ( ifilt=0; ifilt < NFILT; ifilt++ ) {
-      
-    ifilt_obs = IFILTLOCAL[ifilt] ;	
-        
-    // avoid initializing same filter twice.
-    if ( DONEFILT[ifilt_obs] > 0 ) { continue ; }
+    genmag_NON1ASED (
+		  index                // (I) NON1A class
+		  ,ifilt_obs           // (I) obs-filter index
+		  ,mwebv               // (I) Galactic E(B-V)
+		  ,z                   // (I) redshift
+		  ,GENLC.DLMU          // (I) distance modulus
+		  ,RV, AV             // (I) RV and AV of host
+		  ,NEPFILT             // (I) number of epochs
+		  ,ptr_epoch           // (I) Tobs (days)
+		  ,ptr_genmag          // (O) obs mags
+		  ,ptr_generr          // (O) obs mag-errs
+		  );
+  }
+  else if (  INDEX_GENMODEL  == MODEL_NON1AGRID ) {  // Mar 2016
 
-    // get_filttrans returns separate trans for SN and REF,
-    // but these are always the same for sims.
+    /*
+    printf(" xxx pass NON1AGRID args: \n");
+    printf(" xxx ifilt_obs=%d  mwebv=%f z=%f \n", ifilt_obs, mwebv8, z8);
+    printf(" xxx RV=%f AV=%f  NEP=%d \n", RV8, AV8, NEPFILT);
+    fflush(stdout);
+    */
+    
+    // use same randoms for each band
+    double ranWgt   = GENLC.NON1AGRID_RANFlat ;
+    double ranSmear = GENLC.NON1AGRID_RANGauss ;
+    
+    genmag_NON1AGRID (
+		   ifilt_obs           // (I) obs-filter index
+		   ,mwebv               // (I) Galactic E(B-V)
+		   ,GENLC.REDSHIFT_CMB  // (I) CMB redshift, NOT zhelio
+		   ,RV, AV             // (I) RV and AV of host
+		   ,ranWgt, ranSmear    // (I) to pick random index & magSmear
+		   ,NEPFILT             // (I) number of epochs
+		   ,ptr_epoch           // (I) Trest-Tpeak (days)
+		   ,ptr_genmag          // (O) obs mags
+		   ,ptr_generr          // (O) obs mag-errs
+		   ,&GENLC.MAGSMEAR_COH // (O) store random magSmear
+		      );
 
-    sprintf(filtName,"NULL") ;
+    GENLC.TEMPLATE_INDEX = fetchInfo_NON1AGRID("NON1A_INDEX");
+    GENLC.SNTYPE         = fetchInfo_NON1AGRID("NON1A_ITYPE_USER");
+  }
+  else if ( INDEX_GENMODEL  == MODEL_LCLIB ) {  // July 2017
 
-    get_filttrans__(&MASKFRAME[ifilt],     // (I) obs/rest-frame mask
-		    &ifilt_obs,            // (I) absolute filter index
-		    filtName,              // (O) full name of filter
-		    &magprim,              // (O) mag of primary ref 
-		    &NLAM,                 // (O) Number of lambda bins
-		    genSEDMODEL.lam,       // (O) lambda array 
-		    genSEDMODEL.TransSN,   // (O) filter trans 
-		    genSEDMODEL.TransREF,  // (O) idem
-		    LEN ); 
+    set_TobsRange_LCLIB(GENLC.epoch8_obs_range);
 
-    if ( NLAM > MXLAMSIM ) {
-      sprintf(cfilt,  "%c", FILTERSTRING[ifilt_obs] );
-      sprintf(c1err,"NLAM(%s) = %d exceeds bound of MXLAMSIM=%d",
-	      cfilt, NLAM, MXLAMSIM );
-      sprintf(c2err,"Check filter trans files.");
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    sprintf(GENLC.SNTYPE_NAME, "%s", LCLIB_INFO.NAME_MODEL ); 
+    double *ptr_template = &GENLC.genmag8_obs_template[ifilt_obs];
+    double LAMAVG        = INPUTS.LAMAVG_OBS[ifilt_obs];
+    double ZTRUE, TobsPeak ;
+
+    genmag_LCLIB(GENLC.CID, ifilt_obs, GENLC.RA, GENLC.DEC, 
+		 mwebv, LAMAVG,
+		 NEPFILT, ptr_epoch, 
+		 ptr_genmag, ptr_template,    // return args
+		 &TobsPeak                    // Tobs with peak brightness
+		 );
+
+    // for non-recurring events, set PKMJD like any other transient
+    if ( LCLIB_INFO.IFLAG_RECUR_CLASS == IFLAG_RECUR_NONRECUR ) {
+      GENLC.PEAKMJD  = INPUTS.GENRANGE_PEAKMJD[0] + TobsPeak ;
+      // xxx mark delete  GENLC.PEAKMJD_SMEAR         = GENLC.PEAKMJD ;
     }
 
-    lamshift = 0.0 ;
-    init_filter_SEDMODEL(ifilt_obs, filtName, magprim, NLAM, 
-			 genSEDMODEL.lam, 
-			 genSEDMODEL.TransSN, 
-			 genSEDMODEL.TransREF, 
-			 lamshift );
+    /*
+    printf(" xxx genmag_LCLIB returns zphot = %.3f +- %.3f  (ztrue=%.3f)\n",
+	   SNHOSTGAL.ZPHOT, SNHOSTGAL.ZPHOT_ERR, GENLC.REDSHIFT_CMB );
+    */
 
-    DONEFILT[ifilt_obs] = 1 ;
   }
 
+  // !=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=
+  //         end of model if-block
+  // !=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=
 
-  // free temp memory
-  free(genSEDMODEL.lam);
-  free(genSEDMODEL.primaryFlux);
-  free(genSEDMODEL.TransSN);
-  free(genSEDMODEL.TransREF);
+  // ---------------------------------------
+  // check option to interpolate model mags (see setEpochGrid above)
+  if ( INPUTS.TGRIDSTEP_MODEL_INTERP > 0.001 ) {
+    NEPFILT = NEPFILT_SAVE ;
+    interpEpochGrid(NEPFILT, Tmodel, NGRID,              // I
+		    ptr_epoch, ptr_genmag, ptr_generr) ; // I/O
+  } 
 
-} // end of init_genSEDMODEL
+  // ======================================
+  // store peak mag in rest-frame
 
+  if ( GENFRAME_OPT == GENFRAME_REST ) {
+    iep =  NEPFILT - 1 ; // last epoch is always peak
+    GENLC.peakmag8_rest[ifilt_rest] = ptr_genmag[iep] ;
+  }
 
-// *******************************
-void check_model_default(int index_model ) {
+  // apply intrinsic model mag-smearing AFTER model-mag generation
+  // Note that ptr_genmag is both an input and output arg.
+  genmodelSmear(NEPFILT, ifilt_obs, ifilt_rest, z, 
+		 ptr_epoch, ptr_genmag, ptr_generr ); 
 
-  // if default model is used, then change INPUTS.MODELNAME
-  // to that listed in [model].default file.
+  NEPFILT = NEPFILT_GENLC(-1, ifilt_obs);
 
-  int   j, lentmp, ICMP;
-  FILE *fp;
-  char *cptr, *PTR_GENMODEL ;
-  char  model[40],suffix[20], defaultFile[MXPATHLEN], defaultPath[MXPATHLEN] ;
-  char  model_lc[40] = { "  " } ;    
-  char  fnam[] = "check_model_default"  ;
+  return ;
 
+}  // end of genmodel
 
-  // ----------------- BEGIN ---------------
 
-  if ( index_model == MODEL_NON1ASED  ) return ;
-  if ( index_model == MODEL_NON1AGRID ) return ;
-  if ( index_model == MODEL_FIXMAG    ) return ;
-  if ( index_model == MODEL_LCLIB     ) return ;
-  if ( index_model == MODEL_BYOSED    ) return ;
+// *********************************************
+void genmodel_SALT2_EVENT(void) {
+
+  // Created Oct 2026
+  // Compute SALT2 mags and model errors for all bands & epochs
+  // of this event with one call to genmag_SALT2_EVENT, and store
+  // them in GENLC.genmag8_obs & generr8_obs. Then genmodel only
+  // applies intrinsic smearing (genmodelSmear) for each band.
+  // Not used with TGRIDSTEP_MODEL_INTERP, where genmodel evaluates
+  // the model on a separate epoch grid for each band.
+
+  int    ep, ifilt_obs, NOBS, OPTMASK = 0 ;
+  int    IFILT_LIST[MXEPSIM], EP_LIST[MXEPSIM] ;
+  double TOBS_LIST[MXEPSIM], MAG_LIST[MXEPSIM], ERR_LIST[MXEPSIM] ;
+  double S2x0, S2x1, S2c ;
+  double z     = GENLC.REDSHIFT_HELIO ;
+  double mwebv = GENLC.MWEBV_SMEAR ;
+  //  char fnam[] = "genmodel_SALT2_EVENT" ;
 
-  sprintf(model, "%s", INPUTS.MODELNAME );
+  // ----------- BEGIN -----------
 
-  PTR_GENMODEL = GENMODEL_NAME[index_model][0] ; // generic model name
+  if ( INPUTS.TGRIDSTEP_MODEL_INTERP > 0.001 ) { return ; }
 
-  // if there is no dot (.) in the model name,
-  // then assume that we have the generic name and
-  // read the [model].default file to get the model version.
+  NOBS = 0 ;
+  for ( ep = 1; ep <= GENLC.NEPOCH; ep++ ) {
+    ifilt_obs = GENLC.IFILT_OBS[ep] ;
+    if ( GENLC.DOFILT[ifilt_obs] == 0 ) { continue ; }
+    IFILT_LIST[NOBS] = ifilt_obs ;
+    TOBS_LIST[NOBS]  = GENLC.epoch8_obs[ep] ;
+    EP_LIST[NOBS]    = ep ;
+    NOBS++ ;
+  }
 
-  cptr = strstr ( model, "." ) ; 
-  if ( cptr == NULL ) {
+  getpar_SALT2_SCATTER(&S2x0, &S2x1, &S2c);
 
-    // check if model is lower/upper case to determine if
-    // .default  suffix is lower/upper case.
+  genmag_SALT2_EVENT(OPTMASK, NOBS, IFILT_LIST, TOBS_LIST,
+		     S2x0, S2x1, S2x1, S2c, mwebv, GENLC.RV, GENLC.AV,
+		     z, z, MAG_LIST, ERR_LIST, NULL );
 
-    lentmp = strlen(PTR_GENMODEL);
-    for (j=0; j<lentmp; j++) { model_lc[j] = tolower(PTR_GENMODEL[j]); }
-    model_lc[lentmp] = '\0' ;
-    ICMP = strcmp(model_lc,PTR_GENMODEL) ;
+  for ( ep=0; ep < NOBS; ep++ ) {
+    GENLC.genmag8_obs[EP_LIST[ep]] = MAG_LIST[ep] ;
+    GENLC.generr8_obs[EP_LIST[ep]] = ERR_LIST[ep] ;
+  }
 
-    if ( ICMP == 0 ) 
-      { sprintf(suffix, "%s", "default"); }
-    else
-      { sprintf(suffix, "%s", "DEFAULT"); }
+  GENLC.GENMAG_EVENT_DONE = 1 ;
 
+} // end genmodel_SALT2_EVENT
 
-    // construct full name of file with default model version
-    sprintf(defaultPath,"%s/models/%s", 
-	    PATH_SNDATA_ROOT, PTR_GENMODEL );
-    sprintf(defaultFile,"%s/%s.%s", 
-	    defaultPath, PTR_GENMODEL, suffix);
 
-    if ( (fp = fopen(defaultFile, "rt")) == NULL ) {
-      sprintf(c1err,"Default version file does not exist:");
-      sprintf(c2err,"%s",  defaultFile );
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
-    }
+// *********************************************
+void getpar_SALT2_SCATTER(double *x0, double *x1, double *c) {
 
-    // read default model-version from default-file
-    readchar(fp, model ) ;
+  // Created Oct 2026 (moved from genmodel)
+  // Return SALT2 x0, x1, c after applying intrinsic scatter matrix.
 
-    fclose(fp);
+  double tmp ;
+  *x1  = GENLC.SALT2x1 + GENLC.COVMAT_SCATTER[1] ;
+  *c   = GENLC.SALT2c  + GENLC.COVMAT_SCATTER[2] ;
+  tmp  = -0.4 * GENLC.COVMAT_SCATTER[0] ;
+  *x0  = GENLC.SALT2x0 * pow(10.0,tmp);
 
-    // re-load global GENMODEL with default model version
-    sprintf(INPUTS.GENMODEL, "%s/%s", defaultPath, model);
-    sprintf(INPUTS.MODELNAME, "%s", model ); // copy full name 
-  }
+} // end getpar_SALT2_SCATTER
 
 
-} // end of check_model_default
+// ********************************************
+double  genmodel_Tshift(double T, double z) {
 
-// ******************************
-void init_kcor(char *kcorFile) {
+  // Created Jun 2017
+  // Return model phase shift to smear rise/fall times.
+  // Input T = phase (days) w.r.t. peak
+  // Works only for rest-frame models.
 
-  /********
-   Created May 18, 2008 by R.Kessler
+  double Tshift; 
+  double zz = 1.0 + z ;
+  // --------------- BEGIN --------------
 
-   Read K-corrections and filter transmissions (rdkcor).
-   We do not yet know GENFRAME_OPT ('rest' or 'obs'),
-   but always read the K-cors to be safe, since even
-   obs-frame models will likely need the filter transmissions.
+  if ( GENFRAME_OPT == GENFRAME_REST ) {
+    if ( T < 0.0 ) {
+      Tshift = -(T/18.0) * GENLC.RISETIME_SHIFT * zz ;
+    }
+    else {
+      Tshift = -(T/15.0) * GENLC.FALLTIME_SHIFT * zz ;
+    }    
+  }
+  else {
+    // no shift for OBS-frame models (e.g., SALT2, NON1ASED)
+    Tshift = 0.0 ;
+  }
 
-   Also do miscelaneous chores like fetching
-   AB (zeropoint) offets.
+  return(Tshift) ;
 
-   Sep 1, 2010: fix evil bug: tmpoff[20] -> tmpoff[MXFILTINDX]
+} // end genmodel_Tshift
 
-   May 13, 2013: few fixes for MODEL_FIXMAG.
+// ********************************************
+int setEpochGrid(double TMIN, double TMAX, double *TGRID ) {
 
-   Sep 22 2013: for rest-frame models call get_kcor_mwpar(RV,OPT_COLORLAW)
+  // Created Oct 23 2015
+  // Inputs: TMIN and TMAX
+  // Ouput: TGRID[i] = fixed grid
+  // Function outut = size of grid
 
-   Jun 20 2017: pass FILTER_LAMSHIFT argument to set_survey_
+  double t, TSTEP, TSTART, TEND;
+  int  NGRID, iTround ;
+  //  char fnam[] = "setEpochGrid" ;
 
-   Nov 2 2017: add AB offsets to user offsets; see tmpoff_kcor
-   Apr 24 2019: for FIXMAG model, return before doing rest-frame stuff.
+  // ---------------- BEGIN ----------------
 
-  *********/
+  TSTEP = INPUTS.TGRIDSTEP_MODEL_INTERP ;
+  NGRID = 0 ;
+  if ( TSTEP <= 0.0 ) { return(NGRID) ; }
 
-  int ISMODEL_FIXMAG = ( INDEX_GENMODEL == MODEL_FIXMAG );
-  int ierrstat, ifilt, ifilt_obs, OPT ;
-  float tmpoff_kcor[MXFILTINDX] ;
-  float *ptr ;
-  char   copt[40], xtDir[MXPATHLEN], cfilt[4], *NAME;
-  char fnam[] = "init_kcor" ;
+  iTround = (int)TMIN ;
+  TSTART  = (double)iTround -2.0 ;
+  if ( TSTART > 0.0 ) { TSTART = -TSTEP; }
 
-  // -------------- BEGIN --------------
+  TEND    = TMAX + TSTEP ;
+  if ( TEND < TSTEP ) { TEND = TSTEP + 1.0 ; }
 
-  // set fortran arrays needed for K-correction lookup
-  // The GENLC variables are set in SIMLIB_open
- 
-  set_survey__( GENLC.SURVEY_NAME  
-		,&GENLC.NFILTDEF_OBS
-		,GENLC.IFILTMAP_OBS
-		,INPUTS.TMPOFF_LAMSHIFT
-		,strlen(GENLC.SURVEY_NAME)   
-		);
+  /*
+  if( TEND < 20.0 ) {
+    printf(" xxx %s: TMIN,TMAX -> TSTART,TEND = %.2f, %.2f -> %.2f, %.2f \n", 
+	   fnam, TMIN, TMAX, TSTART, TEND );
+  }
+  */
 
-  // read K-cor and mag tables (vs. Z, epoch, AV)
-  rdkcor_(kcorFile, &ierrstat, strlen(kcorFile) );
+  for(t=TSTART; t <= TEND; t += TSTEP ) {
+    TGRID[NGRID] = t;
+    NGRID++ ;
+  }
 
-  if ( ierrstat != 0 ) {
-    sprintf(c1err, "Could not open kcor file: '%s'", kcorFile);
-    errmsg(SEV_FATAL, 0, fnam, c1err, "" ); 
-  } 
+  return(NGRID);
 
+} // end of setEpochGrid
 
-  // get zeropoint (AB) offsets from kcor/calib file.
-  sprintf(copt,"ABOFF") ;
-  get_filtmap__(copt, tmpoff_kcor, strlen(copt) );
 
+void interpEpochGrid(
+		     int NEP_LC,           // (I) Nep for LC
+		     double *TList_LC,     // (I) Tlist for LC
+		     int NGRID,            // (I) Number of grid points
+		     double *TList,        // (I/O) T at each grid point
+		     double *magList,      // (I/O) mag at each grid point
+		     double *magerrList )  // (I/O) magerr at each grid
+{ 
 
-  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
-    ifilt_obs  = GENLC.IFILTMAP_OBS[ifilt] ;
-    ptr = &INPUTS.GENMAG_OFF_ZP[ifilt_obs] ;
+  // Oct 23 2015
+  // Use input grid of mags (maglist vs. Tlist) to interpolate
+  // mags on the light curve epochs (TList_LC).
+  // Note that TList, magList and magerrList are input
+  // with GRID values and overwritten with the LightCurve values.
+  //
+  // This function is associated with user-input key 
+  // TGRIDSTEP_MODEL_INTERP  to generate LC mags on a grid
+  // and then interpolate.
 
-    if ( !ISMODEL_FIXMAG ) {
-      *ptr += tmpoff_kcor[ifilt]; // add AB off to user offset
-    }
+  double *GRID_T, *GRID_MAG, *GRID_MAGERR;
+  double T, mag, magerr;
+  int MEMD, ep;
+  int OPT_INTERP=1;  // linear interp
+  char fnam[] = "interpEpochGrid" ;
 
-    // get mean and RMS of filter-wavelength 
-    OPT = GENFRAME_OBS ;
-    get_filtlam__(&OPT, &ifilt_obs
-		  ,&INPUTS.LAMAVG_OBS[ifilt_obs]
-		  ,&INPUTS.LAMRMS_OBS[ifilt_obs]   
-		  ,&INPUTS.LAMMIN_OBS[ifilt_obs]   
-		  ,&INPUTS.LAMMAX_OBS[ifilt_obs]   
-		  );
-  }  // end ifilt loop
+  // -------------- BEGIN -------------------
+  
+  // create arrays to store input GRID
+  MEMD        = NGRID * sizeof(double);
+  GRID_T      = (double*) malloc( MEMD );
+  GRID_MAG    = (double*) malloc( MEMD );
+  GRID_MAGERR = (double*) malloc( MEMD );
 
+  for(ep=0; ep<NGRID; ep++ ) {
+    GRID_T[ep]      = TList[ep];
+    GRID_MAG[ep]    = magList[ep];
+    GRID_MAGERR[ep] = magerrList[ep];    
 
-  // misc. inits
-  for ( ifilt=0; ifilt<MXFILTINDX; ifilt++ ) { 
-    NAVWARP_OVERFLOW[ifilt] = 0; 
-    GENLC.IFLAG_SYNFILT_SPECTROGRAPH[ifilt] = 0 ;
+    TList[ep]      = 999. ; // init output
+    magList[ep]    = 999. ; // idem 
+    magerrList[ep] = 999. ; // idem
   }
 
-  if ( ISMODEL_FIXMAG ) { return ; } // 4.24.2019
-
-  // init MW extinction (moved from end of init_genmodel on Aug 30 2010)
-  if ( GENFRAME_OPT == GENFRAME_REST )  {
-
-    // Sep 2013: fetch params used to compute MW extinct in kcor files.
-    //           Needed to re-compute MWXT if RV is changed.
-    get_kcor_mwpar__(&GENLC.kcor_RVMW, &GENLC.kcor_OPT_MWCOLORLAW );
+  // interpolate for each LC epoch and overwrite input arrays
+  for(ep=0; ep < NEP_LC; ep++ ) {    
 
-    double RVDIF ;
-    RVDIF = fabs ( INPUTS.RV_MWCOLORLAW - GENLC.kcor_RVMW) ;
-    if ( RVDIF > 0.001 ) {
-      printf("\n");
-      printf("   User RVMW=%.3f != RVMW(kcorTable)=%.3f  \n",
-	     INPUTS.RV_MWCOLORLAW, GENLC.kcor_RVMW) ;
-      printf("   -> Compute MWXT correction with OPT_MWCOLORLAW=%d\n", 
-	     GENLC.kcor_OPT_MWCOLORLAW );
-      fflush(stdout);
-    }
+    T      = TList_LC[ep];
 
-    if ( OPT_SNXT  == OPT_SNXT_CCM89 ) {
-      init_xthost__(&OPT_SNXT);
-    }
-    else if ( OPT_SNXT  == OPT_SNXT_SJPAR ) {
-      print_banner("Init HOST-GALAXY Extinction Parameters");
-      sprintf(xtDir, "%s ",INPUTS.MODELPATH); // leave blank space for fortran
-      rdxtpar_(xtDir, strlen(xtDir) );      
-    }
+    mag    = interp_1DFUN(OPT_INTERP, T, 
+			  NGRID, GRID_T, GRID_MAG, fnam);
 
-  } // end rest-frame
+    magerr = interp_1DFUN(OPT_INTERP, T,
+			  NGRID, GRID_T, GRID_MAGERR, fnam);
 
+    TList[ep]      = T ;
+    magList[ep]    = mag;
+    magerrList[ep] = magerr ;
 
-  // check for optional spectrograph information (July 2016)
-  sprintf(copt,"SPECTROGRAPH") ;
-  int NF = get_filtmap__(copt, tmpoff_kcor, strlen(copt) );
-  GENLC.NFILTDEF_SPECTROGRAPH = NF ;
-  GENLC.FILTERLIST_SPECTROGRAPH[0] = 0 ;
-  for(ifilt=0; ifilt < NF; ifilt++ ) {
-    ifilt_obs = (int)tmpoff_kcor[ifilt] ;
-    GENLC.IFILTDEF_SPECTROGRAPH[ifilt]     = ifilt_obs ;
-    GENLC.IFILTINV_SPECTROGRAPH[ifilt_obs] = ifilt ;
-    GENLC.IFLAG_SYNFILT_SPECTROGRAPH[ifilt_obs] = 1 ;
-    sprintf(cfilt, "%c", FILTERSTRING[ifilt_obs] );
-    strcat(GENLC.FILTERLIST_SPECTROGRAPH,cfilt);
-  }
+    /*
+    printf(" xxx ep=%2d  T=%.2f  mag= %.2f +- %.2f \n", 
+	   ep, T, mag, magerr ); // xxxxxxxxxxxxxxxxxxxxxx
+    */
 
-  // check for optional SPECTROGRPH info
-  
-  read_spectrograph_fits(kcorFile) ;   
-  if ( SPECTROGRAPH_USEFLAG ) {
-    printf("   Found %d synthetic spectrograph filters (%s) \n",
-	   GENLC.NFILTDEF_SPECTROGRAPH, GENLC.FILTERLIST_SPECTROGRAPH );
-    fflush(stdout);
   }
 
-  return ;
+  free(GRID_T);
+  free(GRID_MAG);
+  free(GRID_MAGERR);
 
-} // end of init_kcor
- 
+} // end of interpEpochGrid
 
-// *********************************************
-int gen_TRIGGER_PEAKMAG_SPEC(void) {
+// ********************************************
+void genmodelSmear(int NEPFILT, int ifilt_obs, int ifilt_rest,  double z, 
+		   double *ptr_epoch, double *ptr_genmag, double *ptr_generr ) {
 
-  // Nov 2017
-  // Utility to speed generation when the spec-efficieny map
-  // depends ONLY on peakMag or peak-color. Idea here is to
-  // call GENMAG_DRIVER only for peakmag (not entire LC)
-  // and check if spec-trigger is satisfied. This will skip
-  // generating mags for entire light curve, and also skip
-  // checking for detection at each epoch.
   //
-  // Return 1 if trigger is satisfied (nominal epochs restored)
-  // Return 0 if trigger fails.       (nominal epochs NOT restored)
+  // Created Jul 1, 2010 by R.Kessler
+  // Move model-mag smearing  code from end of genmag_smear to here.
+  // Also add new option to specify smearing vs. lambda
+  //
+  // Inputs:
+  //
+  // NEPFILT     : Number of epochs for this filter
+  // ifilt_obs   : observer filter index
+  // ifilt_rest  : rest-frame filter index (for rest-frame model only)
+  // z           : redshift
+  //
+  // *ptr_epoch  : pointer to epochs (rest or observer)
+  //
+  // *ptr_genmag : pointer to list of generated mags
+  //               NOTE THAT *ptr_genmag values are CHANGED
+  //               based on smearing model !!!
+  //
+  // Jul 19, 2010: return if DO_MODELSMEAR == 0.
+  // Oct 16, 2010: return for GRID option
+  //
+  // Apr 2012: cleanup with call to genSmear_ERRSCALE 
+  //           Also call new functino get_genSmear(...)
+  //
+  // Jun 14 2016: load GENLC.MAGSMEAR_COH at end of function
   //
-  // Jun 2 2018: bail out for LCLIB model because PEAKMAG is ill-defined.
-
-  int  LFIND_SPEC=0, NEP_PEAKONLY=0, iep,ifilt ;
-  int  MEMI  = (GENLC.NEPOCH+1) * sizeof(int);
-  int  MEMD  = (GENLC.NEPOCH+1) * sizeof(double);
-  int  DOSPEC = (INPUTS.APPLY_SEARCHEFF_OPT & 2) ;
-  double EFF ;
 
-  struct {
-    int NEPOCH, *IFILT_OBS, *ISPEAK;
-    double *MJD, *TOBS, *TREST ;
-  } GENLC_ORIG ;
+  int
+    iep, opt_frame, ifilt_local
+    ,USE_GENMODEL_ERRSCALE, USE_GENSMEAR_MODEL       
+    ,ONE = 1
+    ;
 
+  double 
+    ran_COH, ran_FILT
+    ,magSmear, magSmear_model
+    ,smearsig, smearsig_fix, smearsig_model
+    ,Tep, Tpeak, Trest, lamrest, Z1
+    ;
 
-  char fnam[] = "gen_TRIGGER_PEAKMAG_SPEC" ;
+  float lamavg4, lamrms4, lammin4, lammax4 ;
 
-  // -------------- BEGIN ----------------
+  char cfilt[2];
+  char fnam[] = "genmodelSmear" ;
 
-  if ( DOSPEC == 0 ) 
-    { return(1); }
+  // -------------- BEGIN ------------
 
-  if ( SEARCHEFF_SPEC_INFO.FLAG_PEAKMAG_ONLY == 0 ) 
-    { return(1); }
+  if ( INPUTS.DO_MODELSMEAR  == 0 ) 
+    { return ; }
 
   if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID  ) 
-    { return(1); }
+    { return ; }
 
-  if ( INDEX_GENMODEL == MODEL_LCLIB ) // Jun 2 2018
-    { return(1); }
+  if ( GENFRAME_OPT == GENFRAME_REST  ) 
+    { ifilt_local = ifilt_rest ;  Z1 = 1.0 ; }
+  else 
+    { ifilt_local = ifilt_obs ;   Z1 = 1.0 + z ; }
 
-  GENLC_ORIG.NEPOCH      = GENLC.NEPOCH;
-  GENLC_ORIG.IFILT_OBS   = (int*)malloc ( MEMI ) ; 
-  GENLC_ORIG.ISPEAK      = (int*)malloc ( MEMI ) ;
-  GENLC_ORIG.MJD         = (double*)malloc( MEMD ) ;
-  GENLC_ORIG.TOBS        = (double*)malloc( MEMD ) ;
-  GENLC_ORIG.TREST       = (double*)malloc( MEMD ) ;
 
-  for(iep=1; iep <= GENLC_ORIG.NEPOCH ; iep++ ) {
-    GENLC_ORIG.ISPEAK[iep]    = GENLC.ISPEAK[iep] ;
-    GENLC_ORIG.IFILT_OBS[iep] = GENLC.IFILT_OBS[iep] ;
-    GENLC_ORIG.MJD[iep]       = GENLC.MJD[iep];
-    GENLC_ORIG.TOBS[iep]      = GENLC.epoch8_obs[iep];  
-    GENLC_ORIG.TREST[iep]     = GENLC.epoch8_rest[iep] ;
+  sprintf(cfilt,  "%c", FILTERSTRING[ifilt_local] ); // for err msg only
 
-    if ( GENLC_ORIG.ISPEAK[iep] == 0 ) { continue ; }
-    NEP_PEAKONLY++ ;
-    GENLC.ISPEAK[NEP_PEAKONLY]       = GENLC_ORIG.ISPEAK[iep] ;
-    GENLC.IFILT_OBS[NEP_PEAKONLY]    = GENLC_ORIG.IFILT_OBS[iep] ;
-    GENLC.MJD[NEP_PEAKONLY]          = GENLC_ORIG.MJD[iep] ;
-    GENLC.epoch8_obs[NEP_PEAKONLY]   = GENLC_ORIG.TOBS[iep] ;
-    GENLC.epoch8_rest[NEP_PEAKONLY]  = GENLC_ORIG.TREST[iep] ;
-  }
-  GENLC.NEPOCH = NEP_PEAKONLY;
+  // sanity check that epoch at peak really as Tpeak = 0
+  Tpeak = ptr_epoch[NEPFILT - 1];
 
+  if ( fabs(Tpeak) > 0.0001 && NEPFILT > 0 ) {
+    sprintf(c1err,"Tpeak(%s) = %f but expected T=0 at peak", 
+	    cfilt, Tpeak );
+    sprintf(c2err,"PEAKMJD(GEN) = %f  LIBID=%d  NEPFILT=%d \n", 
+	    GENLC.PEAKMJD, GENLC.SIMLIB_ID, NEPFILT );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+  }
 
-  GENLC.PEAKMAG_TRIGGER_FLAG = 1 ; // global flag
-  GENMAG_DRIVER(); 
-  LOAD_SEARCHEFF_DATA();
-  LFIND_SPEC = gen_SEARCHEFF_SPEC(GENLC.CID, &EFF) ;  // return EFF 
-    
-  GENLC.NEPOCH = GENLC_ORIG.NEPOCH ; // always needed for init_GENLC
 
-  // check to restore ALL epochs
-  if ( LFIND_SPEC ) {
-    for(iep=1; iep <= GENLC.NEPOCH ; iep++ ) {
-      GENLC.ISPEAK[iep]      = GENLC_ORIG.ISPEAK[iep];
-      GENLC.IFILT_OBS[iep]   = GENLC_ORIG.IFILT_OBS[iep] ;
-      GENLC.MJD[iep]         = GENLC_ORIG.MJD[iep];
-      GENLC.epoch8_obs[iep]  = GENLC_ORIG.TOBS[iep]  ;
-      GENLC.epoch8_rest[iep] = GENLC_ORIG.TREST[iep] ;
-    }
+  // init all smearing to zero
+  for ( iep = 0; iep <= NEPFILT; iep++ )  {  
+    GENFILT.genmag8_smear[ifilt_obs][iep] = 0.0 ; 
   }
 
 
-  free(GENLC_ORIG.IFILT_OBS);
-  free(GENLC_ORIG.ISPEAK);
-  free(GENLC_ORIG.MJD);
-  free(GENLC_ORIG.TOBS);
-  free(GENLC_ORIG.TREST);
-
-  GENLC.PEAKMAG_TRIGGER_FLAG = 0 ;
-  return(LFIND_SPEC) ;
+  // ----------------------------------------------
+  // start with coherent smearing (GENMAG_SMEAR)
+  // that is common to all passbands.
 
-} // end gen_TRIGGER_PEAKMAG_SPEC
+  if ( INPUTS.GENMAG_SMEAR > 0.0001 ) {
 
+    ran_COH = GENLC.GENSMEAR_RANGauss_FILTER[0] ; // retrieve random #
 
-// ==========================================
-int gen_TRIGGER_zHOST(void) {
+    magSmear = INPUTS.GENMAG_SMEAR * ran_COH ;
+    GENLC.MAGSMEAR_COH = magSmear ;  // store global
 
-  // Created Dec 1 2017
-  // Evaluate zHOST trigger and return 1=PASS, 0=FAIL.
-  // Intended to reject events before digitization to
-  // speed simulation.
-  //
-  // Mar 15 2018: bail if zHOST is NOT required by user
-  // Jun 19 2018: bail of CUTWIN_SNRMAX is specified.
+    for ( iep = 1; iep <= NEPFILT; iep++ )   { 
+      *(ptr_genmag+iep-1)                   += magSmear ;
+      GENFILT.genmag8_smear[ifilt_obs][iep] += magSmear ;
+    }
+  }
 
-  double EFF, IPASS;
-  int  NEPOCH_ORIG   = GENLC.NEPOCH;
-  int  APPLY_OPT     = INPUTS.APPLY_SEARCHEFF_OPT ;
-  int  REQUIRE_SPEC  = (APPLY_OPT & APPLYMASK_SEARCHEFF_SPEC) ;
-  int  REQUIRE_zHOST = (APPLY_OPT & APPLYMASK_SEARCHEFF_zHOST);
-  char fnam[] = "gen_TRIGGER_zHOST" ;
 
-  // -------------- BEGIN ------------------
+  // check old model of using the fit-model errors
+  if ( INPUTS.GENMODEL_ERRSCALE > 1.0E-6  ) 
+    { USE_GENMODEL_ERRSCALE = 1 ; }
+  else
+    { USE_GENMODEL_ERRSCALE = 0 ; }
 
-  // bail if spec-confirmation is required
-  if ( REQUIRE_SPEC ) { return(1); }
 
-  // bail if zHOST is not required  (Mar 15, 2018)
-  if ( !REQUIRE_zHOST ) { return(1); }
+  USE_GENSMEAR_MODEL = 
+    ( (istat_genSmear() > 0) && (IFLAG_GENSMEAR == IFLAG_GENSMEAR_FILT) ) ;
 
-  // bail if zHOST map is NOT defined.
-  if ( INPUTS_SEARCHEFF.NMAP_zHOST == 0 )     { return(1); }
+  smearsig_fix   = 0.0 ;
+  smearsig_model = 0.0 ;
 
-  // bail if CUTWIN_SNRMAX is specified (June 18 2018)
-  if ( INPUTS_SEARCHEFF.CUTWIN_SNRMAX_zHOST[0] > 0.0 ) { return(1); }
+  // first get random number for this passband based on 
+  // rest- or observer-frame model
 
-  // bail if generating GRID
-  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID  )     { return(1); }
+  ran_FILT = GENLC.GENSMEAR_RANGauss_FILTER[ifilt_local] ; 
 
-  // load data to load randoms used for efficiencies.
-  GENLC.NEPOCH=1;  LOAD_SEARCHEFF_DATA();
+  // now get filter-dependent smearing
+  if ( INPUTS.NFILT_SMEAR > 0 ) 
+    { smearsig_fix = INPUTS.GENMAG_SMEAR_FILTER[ifilt_local]; }
 
-  // evaluate zHOST trigger
-  IPASS = gen_SEARCHEFF_zHOST(GENLC.CID,&EFF);
 
-  // restore GENLC.NEPOCH
-  GENLC.NEPOCH = NEPOCH_ORIG; 
+  // loop over epochs and apply same mag-smear 
 
-  return(IPASS) ;
+  for ( iep=1; iep <= NEPFILT; iep++ ) {
 
-} // end gen_TRIGGER_zHOST
+    smearsig_model = 0.0 ;
+    Tep   = *(ptr_epoch + iep - 1); // rest or obs.
+    Trest = Tep / Z1 ;  // Z1=1 (rest) or 1+z (obs)
+     
+    if ( USE_GENMODEL_ERRSCALE  ) 
+      { smearsig_model = genSmear_ERRSCALE(ptr_generr,iep, NEPFILT ); }
 
-// *********************************************
-void GENMAG_DRIVER(void) {
+    // add two sources of smear in quadrature: FILTER and ERRSCALE
+    smearsig = sqrt( pow(smearsig_model,2.) + pow(smearsig_fix,2.) );      
+    magSmear = smearsig * ran_FILT ;  // apply filter-dependent random smear
 
-  // Created July 2016
-  // [for spectra refactor, move code from main to here]
-  // Driver routine to generate true mags at each epoch & passband.
-  //
-  // Aut 17 2017: call get_lightCurveWidth
 
-  int ifilt, ifilt_obs, DOFILT ;
-  int NEPCUT = INPUTS.CUTWIN_NEPOCH[0];
-  char fnam[] = "GENMAG_DRIVER" ;
+    // model-dependent smearing; note that get_genSmear returns
+    // a randomly generated magSmear rather than a sigma-smear.
+    // Also, this magSmear over-writes previous magSmear since 
+    // the two cannot both be set.
+    if ( USE_GENSMEAR_MODEL ) {
+      // convert mean lambda of filter in obs frame to rest frame
+      opt_frame = GENFRAME_OBS ;
+      get_filtlam__(&opt_frame, &ifilt_obs, 
+		    &lamavg4, &lamrms4, &lammin4, &lammax4 );
+      lamrest = (double)lamavg4 / ( 1.0 + z );   
+      get_genSmear(Trest, ONE,  &lamrest, &magSmear_model);
+      magSmear = magSmear_model ;
+    }
+   
+    
+    //* xxxxxxxxxxxxxxxx
+    if  ( fabs(Tep) < .01 && ifilt_obs == -2 ) {
+      printf("\t xxx ------------------------------------- \n");
+      printf("\t xxx ifllt[obs,rest] = %d %d   T=%5.2f  mag=%6.3f \n", 
+	     ifilt_obs, ifilt_rest, Tep, *(ptr_genmag+iep-1) );
+      printf("\t xxx magSmear=%7.4f  sig[model,fix]=%6.3f,%6.3f  rr=%6.3f \n",
+		magSmear, smearsig_model, smearsig_fix, ran_FILT );
+    }
+    // xxxxxxxxxxxxxx */
 
-  // -------------- BEGIN ---------------
+    // insanity check:
+    if ( fabs(magSmear) > 30.0 ) {
 
-  genran_modelSmear(); // randoms for intrinsic scatter
+      printf("\n xxx smearsig(model,fix,tot) = %f , %f , %f \n", 
+	     smearsig_model, smearsig_fix, smearsig );
+      
+      sprintf(c1err,"magSmear = %f is for filt=%s T=%6.1f", 
+	      magSmear, cfilt, Tep );
+      sprintf(c2err,"magsig(model)=%4.1f  GaussRan=%5.3f  errscale=%4.2f", 
+	      smearsig, ran_FILT, INPUTS.GENMODEL_ERRSCALE );
+      errmsg(SEV_WARN, 0, fnam, c1err, c2err ); 
+    }
 
-  // this loop is to generate ideal mag in each filter.
-  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
-    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt] ;
+    // Aug 15, 2009: clip mag-smear at +- 3 mag to avoid catastrophe
 
-    DOFILT = GENLC.DOFILT[ifilt_obs] ;
+    if ( magSmear < -3.0 ) { magSmear = -3.0 ; }
+    if ( magSmear > +3.0 ) { magSmear = +3.0 ; }
 
-    if ( DOFILT == 0 ) { continue ; }
+    // check flag (negative smearsig) to interpolate smearing
+    if ( smearsig_fix < -1.0E-6 ) {
+      magSmear = genmodelSmear_interp(ifilt_obs,iep) ;
+    }
     
-    genmodel(ifilt_obs,1); 
-
-
-    if ( GENFRAME_OPT == GENFRAME_REST ) {
-      genmodel(ifilt_obs,2);      // 2nd nearest filter
-      genmodel(ifilt_obs,3);      // 3rd nearest filter
-    } 
-  } // ifilt
- 
-
-  // spaghetti hack to pass LCLIB redshift and compute HOSTLIB photo-z
-  gen_redshift_LCLIB();
-
-  // if generation is in rest frame, apply generic "boost" 
-  // to observer frame
-  if ( GENFRAME_OPT == GENFRAME_REST ) {
-    genmag_boost();           // warp rest-frame SED and apply KCOR      
-    genmag_MWXT_fromKcor() ;  //  apply MilkyWay extinction
-  }
+    ptr_genmag[iep-1]                     += magSmear ;
+    GENFILT.genmag8_smear[ifilt_obs][iep] += magSmear ;
 
-  // Mar 2016: apply filter-dependent MAGOFF and load peakMag per band
-  genmag_offsets();
- 
+  } // ep loop
 
-  // estimate light-curve Width in each band (Aug 17 2017)
-  compute_lightCurveWidths();
+  if ( istat_genSmear() > 0 ) 
+    { GENLC.MAGSMEAR_COH = MAGSMEAR_COH ; } // see sntools_genSmear.c
 
   return ;
 
-} // end GENMAG_DRIVER
-
-
-// *********************************************
-void GENFLUX_DRIVER(void) {
-
-  // Created July 2016
-  // [for spectra refactor, move code from main to here]
-  // Driver routine to generate observed fluxes and uncertainties
-  // from true/generated mags.
-  //
-  // May 2018: set GENLC.NOBS_SATURATE
-  // Oct 30 2018: fix bug setting L_SATURATE
-
-  int epoch, istat, ifilt_obs, ISPEAK, L_ERRPOS, L_UNDEFINED, L_SATURATE ;
-  int VBOSE_SMEAR = 0;
-  double genmag, obsmag;
-  char fnam[] = "GENFLUX_DRIVER" ;
-
-  // -------------- BEGIN ---------------
+} // end of genmodelSmear
 
-  genran_obsNoise();   // randoms for instrumental noise
 
-  for ( epoch = 1; epoch <= GENLC.NEPOCH; epoch++ ) {
+// ********************************
+double genSmear_ERRSCALE(double *ptr_generr, int iep, int NEPFILT ) {
 
-    ifilt_obs = GENLC.IFILT_OBS[epoch] ;
-    if ( GENLC.DOFILT[ifilt_obs] == 0 ) { continue ; }
+  // April 2012 [code moved from genmodelSmear]
+  // Implement ERRSCALE model where intrinsic smear
+  // is based on the genmag model error.
+  // This model is really obsolete and is not recommended.
+  //
+  // ptr_generr is an array of fitter-model errors.
+  // 'iep' is the current epoch index.
 
-    if (   GENLC.ISPEAK[epoch]      ) { continue; }
-    if (   GENLC.ISTEMPLATE[epoch]  ) { continue; }
+  double errtmp, smearsig_model, GENMODEL_ERRSCALE  ;
+  int iep_modelerr;
+  char fnam[] = "genSmear_ERRSCALE" ;
 
-    // convert 'genmag' into Possion-smeared mag and flux
-    istat =  gen_smearFlux ( epoch, VBOSE_SMEAR );
-    istat =  gen_smearMag  ( epoch, VBOSE_SMEAR );
+  // ----------- BEGIN ----------
 
-    obsmag      = GENLC.mag[epoch];
-    genmag      = GENLC.genmag8_obs[epoch] ;
-    L_ERRPOS    = (GENLC.flux_errstat[epoch] > 0 );
-    L_UNDEFINED = (genmag == MAG_UNDEFINED) ; // model undefined
-    L_SATURATE  = (obsmag == MAG_SATURATE ) ;    
+  iep_modelerr = -9 ;
 
-    if ( L_UNDEFINED ) 
-	{ GENLC.NOBS_UNDEFINED++ ; } // model is undefined 
+  if ( INPUTS.GENMODEL_ERRSCALE_OPT == 1 )       
+    { iep_modelerr = NEPFILT ; }  // use peak model error at all epochs
+  else if ( INPUTS.GENMODEL_ERRSCALE_OPT == 2 )
+    { iep_modelerr = iep ; } // use epoch-dependent model error    
+  else {
+    sprintf(c1err,"Invalid  GENMODEL_ERRSCALE_OPT = %d",
+	    INPUTS.GENMODEL_ERRSCALE_OPT  );
+    errmsg(SEV_FATAL, 0, fnam, c1err, ""); 
+  }
 
-    if ( L_ERRPOS ) {
-      if ( !L_UNDEFINED ) { 
-	GENLC.USE_EPOCH[epoch] = 1 ; 
-	GENLC.NOBS++ ;
-	GENLC.NOBS_FILTER[ifilt_obs]++ ;
-      }
-  
-      if ( L_SATURATE ) { 
-	GENLC.NOBS_SATURATE[1]++ ; 
-	GENLC.NOBS_SATURATE_FILTER[1][ifilt_obs]++ ; 
-      }
-      else {
-	// number of unsaturated epochs
-	GENLC.NOBS_SATURATE[0]++; 
-	GENLC.NOBS_SATURATE_FILTER[0][ifilt_obs]++ ; 
-      }
-    } // end L_ERRPOS
+  // make a few sanity checks
 
-  }  // end of epoch loop
+  if ( iep_modelerr <= 0 || iep_modelerr > NEPFILT ) {
+    sprintf(c1err,"Insane iep_modelerr = %d", iep_modelerr);
+    sprintf(c2err,"at iep=%d ", iep );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  }
   
+  GENMODEL_ERRSCALE  = (double)INPUTS.GENMODEL_ERRSCALE; 
+  errtmp             = *(ptr_generr + iep_modelerr - 1 ); // model error
+  smearsig_model     = errtmp * GENMODEL_ERRSCALE ;
 
-  return ;
+  return smearsig_model ; 
 
-} // end GENFLUX_DRIVER
+} // end of genSmear_ERRSCALE
+ 
+// ****************************************************
+double  genmodelSmear_interp(int ifilt_interp, int iep) {
 
+  // Created Feb 3, 2012 by R.Kessler
+  // interpolate smearing for this observer-frame ifilt_interp.
+  // 'iep' is the epoch index.
+  // Interpolate with filters that have closest wavelength.
+  //
+  // Initial use is for SNACC teeth since the nominal
+  // filter mags must already be set.
 
-// **************************************
-void compute_lightCurveWidths(void) {
+  int ifilt, ifilt_obs,  ifilt1_obs, ifilt2_obs ;
 
-  // call gen_lightCurveWidth for each band,
-  // and store GENLC.WIDTH[ifilt_obs].
-  // These quantities are for SIMGEN_DUMP file
-  // (varNames WIDTH_[band] ).
+  double 
+    smear 
+    ,LAM_INTERP
+    ,LAM, LAM1, LAM2, LAMDIF, LAMDIF_MIN
+    ,SMEAR1, SMEAR2
+    ;
 
-  int ifilt, ifilt_obs, N, ep, NEP[MXFILTINDX], ERRFLAG ;
-  int MEM = (GENLC.NEPOCH+1) * sizeof(double) ;
-  int OPTMASK = 1 ;
-  double Width, *TLIST[MXFILTINDX], *MAGLIST[MXFILTINDX] ;
-  char FUNCALL[100], cfilt[2] ;
-  char fnam[] = "compute_lightCurveWidths" ;
-  
-  // --------------- BEGIN -------------
+  char fnam[] = "genmodelSmear_interp" ;
 
-  if ( GENLC.NWIDTH_SIMGEN_DUMP == 0 ) { return ; }
+  // -------------- BEGIN --------------
 
-  // first allocate memory to store LC separately in each band.
-  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
-    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
-    GENLC.WIDTH[ifilt_obs] = -9.0 ; // init to undefined
-    if ( GENLC.DOFILT[ifilt_obs] == 0 ) { continue ; }
-    TLIST[ifilt_obs]   = (double*)malloc(MEM);
-    MAGLIST[ifilt_obs] = (double*)malloc(MEM);
-    NEP[ifilt_obs]     = 0 ;
-  }
+  LAM_INTERP = (double)INPUTS.LAMAVG_OBS[ifilt_interp] ;
 
-  // load LC for each band
 
-  for(ep=1; ep <= GENLC.NEPOCH; ep++ ) {
-    ifilt_obs = GENLC.IFILT_OBS[ep] ;    
-    if ( GENLC.DOFILT[ifilt_obs] == 0 ) { continue ; }
-    N = NEP[ifilt_obs];
-    TLIST[ifilt_obs][N]   = GENLC.epoch8_obs[ep] ;
-    MAGLIST[ifilt_obs][N] = GENLC.genmag8_obs[ep] ;
-    NEP[ifilt_obs]++ ;
-  }
- 
+  ifilt1_obs = ifilt2_obs = -9;
 
-  // compute Width, then free memory
+  // get closest filter
+  LAMDIF_MIN = 99999999. ;
   for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
     ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
-    if ( GENLC.DOFILT[ifilt_obs] == 0 ) { continue ; }
-
-    // construct error-message string
-    sprintf(cfilt, "%c", FILTERSTRING[ifilt_obs] );
-    sprintf(FUNCALL, "%s(%s)", fnam, cfilt);
-    
-    //      printf(" xxx ------------------ \n");
-    //      printf(" xxx PEAKMJD = %.3f  LIBID=%d \n",
-    //	     GENLC.PEAKMJD, GENLC.SIMLIB_ID );
-  GENLC.WIDTH[ifilt_obs] = 
-    get_lightCurveWidth(OPTMASK, NEP[ifilt_obs], 
-			TLIST[ifilt_obs], MAGLIST[ifilt_obs], &ERRFLAG,FUNCALL);
-    
-    // free memory for this band
-    free(TLIST[ifilt_obs]);  free(MAGLIST[ifilt_obs]);
-  }
-
-  return ;
 
-} // end compute_lightCurveWidths
-
-
-// *********************************************
-void genmodel(
-	      int ifilt_obs  // observer filter index 
-	      ,int inear      // 1=>nearest rest-filter; 2=2nd nearest
-	      ) {
+    // only include filters with positive smear
+    if ( INPUTS.GENMAG_SMEAR_FILTER[ifilt_obs] < 0.000001 ) { continue ; }
 
-  /*********
-   Generate magnitude at each epoch according to model.
-   Output is GENLC.genmag8_obs[ifilt][epoch] for obs-frame model,
-   or GENLC.genmag8_rest[ifilt][epoch] for rest frame model.
-   Note that for rest-frame models, genmag_boost transforms
-   rest-frame mags to observer frame.
+    LAM       = INPUTS.LAMAVG_OBS[ifilt_obs] ;
+    LAMDIF    = fabs(LAM - LAM_INTERP) ;
+    if ( LAMDIF < LAMDIF_MIN ) { 
+      LAMDIF_MIN = LAMDIF ; 
+      ifilt1_obs = ifilt_obs ; 
+    }
+  }     // ifilt
 
-  ***********/
 
-  int
-    istat, ifilt_tmp, ifilt_rest, iep
-    ,NEPFILT, NGRID, NEPFILT_SAVE
-    ,index, isp, OPTMASK, NPAR
-    ;
+  // get 2nd closest filter
+  LAMDIF_MIN = 99999999. ;
+  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
+    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
+    if ( ifilt_obs == ifilt1_obs ) { continue ; }
 
-  double 
-    z, zz, mu, stretch[2], delta, dm15, av, RV, AV, tmpdif
-    ,errtmp, mwebv, Tep, Tshift, dummy
-    ,Tmodel[MXEPSIM], TGRID[MXEPSIM]    
-    ,*ptr_genmag, *ptr_generr, *ptr_epoch
-    ;
+    // only include filters with positive smear
+    if ( INPUTS.GENMAG_SMEAR_FILTER[ifilt_obs] < .0000001 ) { continue ; }
 
-  char  model[40], cfilt_obs[2], cfilt_rest[2]    ;
+    LAM       = INPUTS.LAMAVG_OBS[ifilt_obs] ;
+    LAMDIF    = fabs(LAM - LAM_INTERP) ;
+    if ( LAMDIF < LAMDIF_MIN ) { 
+      LAMDIF_MIN = LAMDIF ; 
+      ifilt2_obs = ifilt_obs ; 
+    }
+  }     // ifilt
 
-  char fnam[] = "genmodel" ;
 
-  // -------- BEGIN ---------
+  // idiot check.
+  if ( ifilt2_obs < 1 ) {
+    sprintf(c1err,"Could not find nearest filters to %c (LAM=%6.1f)",
+	    FILTERSTRING[ifilt_interp], INPUTS.LAMAVG_OBS[ifilt_interp] );
+    sprintf(c2err,"ifilt1_obs=%d  ifilt2_obs=%d", 
+	    ifilt1_obs, ifilt2_obs);
+    errmsg( SEV_FATAL,0 , fnam, c1err, c2err);
+  }
 
-  // create temp structure with epoch-list for this filter
-  NEPFILT = NEPFILT_GENLC(1,ifilt_obs);
+  // interpolate
+  LAM1   = (double)INPUTS.LAMAVG_OBS[ifilt1_obs] ;
+  LAM2   = (double)INPUTS.LAMAVG_OBS[ifilt2_obs] ;
+  LAMDIF = (LAM_INTERP -  LAM1);
+  SMEAR1 = GENFILT.genmag8_smear[ifilt1_obs][iep] ;  
+  SMEAR2 = GENFILT.genmag8_smear[ifilt2_obs][iep] ;  
+  
+  smear = SMEAR1 + (SMEAR2-SMEAR1) * LAMDIF/(LAM2-LAM1);
 
-  // make local copy of model
-  sprintf(model, "%s", INPUTS.MODELNAME );
-  sprintf(cfilt_obs,  "%c", FILTERSTRING[ifilt_obs] );
+  if ( iep == -3 ) {
+    
+    printf(" xxx -------------------------------------------------- \n");
+    printf(" xxx LAMDA[%c,%c -> %c] =  %7.1f , %7.1f  -> %7.1f   \n"
+	   ,FILTERSTRING[ifilt1_obs]
+	   ,FILTERSTRING[ifilt2_obs]
+	   ,FILTERSTRING[ifilt_interp]
+	   ,LAM1, LAM2, LAM_INTERP );
 
-  if ( GENFRAME_OPT == GENFRAME_REST ) {
-    z      = ZAT10PC ; 
-    av     = 0.0; 
-    mu     = 0.0;
-    mwebv  = -9.0; // not used for mlcs
-  }
-  else {
-    z      = GENLC.REDSHIFT_HELIO ;
-    av     = GENLC.AV ;
-    mwebv  = GENLC.MWEBV_SMEAR ; // smeared value, not sigma
-    mu     = GENLC.DLMU ;
+    printf(" xxx SMEAR[%c,%c -> %c] = %7.4f  , %7.4f  -> %7.4f \n" 
+	   ,FILTERSTRING[ifilt1_obs]
+	   ,FILTERSTRING[ifilt2_obs]
+	   ,FILTERSTRING[ifilt_interp]
+	   ,SMEAR1, SMEAR2, smear );
   }
 
 
-  zz = 1. + z ;
-  stretch[0]   = GENLC.STRETCH ;
-  stretch[1]   = GENLC.STRETCH ;
-  delta        = GENLC.DELTA;  // for MLCS model
-  dm15         = GENLC.DM15;
-  RV           = GENLC.RV ;
-  AV           = GENLC.AV ;
-  ifilt_rest = -9;
-  ptr_genmag = ptr_generr = &dummy; // avoid compile warning
 
-  if ( GENFRAME_OPT == GENFRAME_REST ) {
+  return smear ;
+
+}  // end of smearsig_interp
 
-    ptr_epoch    = &GENFILT.Trest8[ifilt_obs][1] ;
 
-    if ( inear == 1 ) {
-      ptr_genmag   = &GENFILT.genmag8_rest[ifilt_obs][1];
-      ptr_generr   = &GENFILT.generr8_rest[ifilt_obs][1];
-      ifilt_rest   = GENLC.IFILTMAP_REST1[ifilt_obs];
-    }
-    else if ( inear == 2 ) {
-      ptr_genmag   = &GENFILT.genmag8_rest2[ifilt_obs][1];
-      ptr_generr   = &GENFILT.generr8_rest2[ifilt_obs][1];
-      ifilt_rest   = GENLC.IFILTMAP_REST2[ifilt_obs];
-    }
-    else if ( inear == 3 ) {
 
-      // to save CPU, only do the 3rd filter if it is nearly as 
-      // close to filt1 as the 2nd closest filter.
 
-      tmpdif  = GENLC.LAMDIF_REST3[ifilt_obs] - GENLC.LAMDIF_REST2[ifilt_obs];
-      if ( tmpdif > 300.0 ) return ;  // beware hard-wired cut in Angstroms
+// ==================================================
+void ZERO_COVMAT_SCATTER(void)
+{
+  //  Created July 2011 by R.Biswas 
+  //  April 12, 2012 (RK) init the Cholesky matrix too.
 
-      if ( tmpdif < 0.0 ) {
-	sprintf(c1err,"GENLC.LAMDIF_REST(2,3)[ifilt_obs=%d] = %6.0f,%6.0f"
-		,ifilt_obs
-		,GENLC.LAMDIF_REST2[ifilt_obs]
-		,GENLC.LAMDIF_REST3[ifilt_obs] );
+  // ------------ BEGIN --------------
 
-	sprintf(c2err,"But LAMDIF_REST3 should be larger than LAMDIF_REST2");
-	errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
-      }
+  /// Set INPUTS. covariance matrix to 0.  
+  INPUTS.NCOVMAT_SCATTER = 0;
 
-      ptr_genmag   = &GENFILT.genmag8_rest3[ifilt_obs][1];
-      ptr_generr   = &GENFILT.generr8_rest3[ifilt_obs][1];
-      ifilt_rest   = GENLC.IFILTMAP_REST3[ifilt_obs];
+  int i,j ;
+  for (i = 0 ; i < 3 ; i++ ){
+    for (j = 0 ; j < 3 ; j++ ){
+      INPUTS.COVMAT_SCATTER[i][j]          = 0. ;
+      INPUTS.COVMAT_SCATTER_SQRT[i][j]     = 0. ;
+      INPUTS.COVMAT_SCATTER_REDUCED[i][j]  = 0. ;
+      INPUTS.COVMAT_CHOLESKY_SCATTER[i][j] = 0.0 ; // RK
+      
     }
+  }
+}//End of ZERO_COVMAT_SCATTER
 
-    sprintf(cfilt_rest, "%c", FILTERSTRING[ifilt_rest] );
+void PARSE_COVMAT_SCATTER(char *CKEY , char *CVAL) 
+{
+  /// Created July 2011 by R.Biswas 
+  /// Parses a character array CKEY specifying the element of 
+  /// the covariance matrix and a character array CVAL 
+  /// having the associated value to assign the covariance matrix.
 
-  }
-  else {
-    // observer-frame model
-    ptr_genmag   = &GENFILT.genmag8_obs[ifilt_obs][1] ;
-    ptr_epoch    = &GENFILT.Tobs8[ifilt_obs][1] ;
-    ptr_generr   = &GENFILT.generr8_obs[ifilt_obs][1];    
-  } 
+  /// CKEY     (I) char string specifying COVMAT_SCATTER element 
+  ///			of the form COVMAT_SCATTER[0][0]:
+  ///			or COVMAT_SCATTER_SQRT[0][0]:
+  ///			or COVMAT_SCATTER_REDUCED[0][0]:
+  /// CVAL     (I) char string giving value of the the covariance
+  ///			matrix entry
 
+  char fname [100];
+  
+  // --------------- BEGIN -----------------
 
-  // - - - - - - 
-  // Aug 20, 2008
-  // convert ptr_epoch to account for perturbing the
-  // light curve shape such as changing the rise time.
-  // Note that shift is positive for positive risetime shifts,
-  // and negative for positive falltime shifts.
-  for ( iep=0; iep <= NEPFILT ; iep++ ) {
-    Tep    = ptr_epoch[iep] ;
-    Tshift = genmodel_Tshift(Tep,z); // generate epoch shift    
-    Tmodel[iep] = Tep + Tshift ;
-  }
-  // change epoch-pointer to local array
-  ptr_epoch = Tmodel ;
+  strcpy(fname,"PARSE_COVMAT_SCATTER");
 
 
-  // check option to interpolate model on an Epoch grid.
-  // e.g., to mimic interpolated fakes on images.
-  if ( INPUTS.TGRIDSTEP_MODEL_INTERP > 0.001 ) {
-    NEPFILT_SAVE  = NEPFILT ;
-    NGRID     = setEpochGrid( Tmodel[0], Tmodel[NEPFILT-2], TGRID );
-    NEPFILT   = NGRID ;
-    ptr_epoch = TGRID ;  // TGRID returned from setEpochGrid
+  //convert the char value into a double
+  double cvalcont;
+  cvalcont = atof(CVAL);	
+
+
+  char covmatentries[1000];
+
+  int m , n ; 		
+  //PARSE routine looks for something like 
+  //COVMAT_SCATTER[m][n] only
+			
+  strcpy(covmatentries,"COVMAT_SCATTER[0][0]:");
+  int lencovmat= strlen(covmatentries);
+  lencovmat = lencovmat+1;
+
+  for ( m = 0 ; m < 3 ; m++ ){
+    for ( n = 0 ; n < 3 ; n++ ){ 
+      sprintf(covmatentries,"COVMAT_SCATTER[%d][%d]:", m ,n );
+      if (0==strncmp(covmatentries,CKEY,lencovmat)){
+	INPUTS.COVMAT_SCATTER[m][n]= cvalcont;
+	INPUTS.NCOVMAT_SCATTER++ ;
+	return;
+      }
+    }
   }
-  else
-    { NGRID = NEPFILT_SAVE = 0 ; }
+  
+  //PARSE routine looks for something like 
+  //COVMAT_SCATTER_SQRT[m][n] only
 
+  strcpy(covmatentries , "COVMAT_SCATTER_SQRT[0][0]:");
+  lencovmat= strlen(covmatentries);
+  lencovmat = lencovmat+1;
+  
+  for ( m = 0 ; m < 3 ; m++ ){
+    for ( n = 0 ; n < 3 ; n++ ){ 
+      sprintf(covmatentries,"COVMAT_SCATTER_SQRT[%d][%d]:", m ,n );
+      if (0==strncmp(covmatentries,CKEY,lencovmat)){
+	//code to abort if one enters COVMAT_SCATTER_SQRT
+	//elements that are off diagonal
+	if (n != m) {
+	  sprintf(c1err,
+		  " off-diagonal COVMAT_SCATTER_SQRT entered: %d %d", m , n );
+	  errmsg( SEV_FATAL,0 , fname, c1err, c2err);
+	}
+	INPUTS.COVMAT_SCATTER_SQRT[m][n]= cvalcont;
+	INPUTS.NCOVMAT_SCATTER++ ;
+	return;
+      }
+    }
+  }
 
-  // -------------------------------------------
-  // -------------------------------------------
-  // -------------------------------------------
+  //Code to parse off diagonal reduced scatter 
+  //terms
+  for ( m = 0 ; m < 3 ; m++ ){
+    for ( n = 0 ; n < 3 ; n++ ){ 
+      sprintf(covmatentries,"COVMAT_SCATTER_REDUCED[%d][%d]:", m ,n );
+      if (0==strncmp(covmatentries,CKEY,lencovmat)){
+	//code to abort if one enters COVMAT_SCATTER_SQRT
+	//elements that are off diagonal
+	if (n == m) {
+	  sprintf(c1err,
+		  " diagonal COVMAT_SCATTER_REDUCED entered: %d %d", m , n );
+	  errmsg( SEV_FATAL,0 , fname, c1err, c2err);
+	}
+	INPUTS.COVMAT_SCATTER_REDUCED[m][n]= cvalcont;
+	INPUTS.NCOVMAT_SCATTER++ ;
+	return;
+      }
+    }
+  }
+  // If nothing found return
+  return;
+ }//END OF PARSE_COVMAT_SCATTER
 
-  if (  INDEX_GENMODEL  == MODEL_STRETCH ) {
+// =======================================
+void INIT_COVMAT_SCATTER( void )
+{
+  // Created July 2011 by R.Biswas
+  // todo: 
+  // - use c1err and c2err instead of errormsg and c2err (done)
+  // - move comments from PARSE_COVMAT to here; 
+  // - fill GENLC.COVMAT_SCATTER_README with cov matrix text string
+  // - print the above
+  //
 
-    // this model can generate rest or observer frame
+  char fname[28] = "INIT_COVMAT_SCATTER" ;
+  int m, n, LDMP, i,j ;
+  double epsilon = 0.00000000001; //tolerance level for differences
+  double xsig, xred, xx;
 
-    istat = 
-      genmag_stretch2 
-	(
-	 stretch[0]              // (I) rise-time stretch
-	 ,stretch[1]             // (I) fall-time stretch
-	 ,ifilt_rest          // (I) absolute rest-filter index
-	 ,NEPFILT             // (I) number of epochs passed
-	 ,ptr_epoch           // (I) Tobs-Tpeak (days)
-	 ,ptr_genmag          // (O) perfect magnitudes
-	 ,ptr_generr          // (O) ideal rest mag-errs
-	 );
+  // ----------------- BEGIN --------------------
 
+  if ( INPUTS.NCOVMAT_SCATTER <= 0 ) { return ; }
 
-    // cap errors at .25 mag to avoid ridiculous light curves
-    // from blown-up U,R,I errors (blown up for fitter)
+  print_banner("INIT_COVMAT_SCATTER:");
 
-    for ( iep=0; iep<NEPFILT; iep++ ) {
-      errtmp = ptr_generr[iep];
-      if ( errtmp > .25 ) { errtmp = .25 ; }
-      ptr_generr[iep] = errtmp ;
-    }
+  LDMP = 1;
 
+  // asign name to each scatter element based on model
+  if ( INDEX_GENMODEL == MODEL_SALT2 ) {
+    sprintf(GENLC.COVMAT_SCATTER_NAME[0],"%s", "mb" );
+    sprintf(GENLC.COVMAT_SCATTER_NAME[1],"%s", "x1" );
+    sprintf(GENLC.COVMAT_SCATTER_NAME[2],"%s", "c"  );
+  }
+  else {
+    sprintf(c1err,"COVMAT_SCATTER not defined for GENMODEL=%s",
+	    INPUTS.MODELNAME );
+    sprintf(c2err,"%s", "Remove COVMAT_SCATTER* keys");
+    errmsg( SEV_FATAL,0 , fname, c1err, c2err);
   }
 
-  else if ( INDEX_GENMODEL  == MODEL_FIXMAG ) {
-
-    GENLC.FIXMAG = GENLC.NOSHAPE ;
 
-    for ( iep = 0 ; iep < NEPFILT; iep++ ) {
-      ptr_genmag[iep] = GENLC.FIXMAG ;
-      ptr_generr[iep] = 0.0 ;
-    }
 
-    sprintf(GENLC.SNTYPE_NAME, "%s", INPUTS.MODELNAME ); 
-    GENLC.TEMPLATE_INDEX = MODEL_FIXMAG ;  //anything but zero
+  //Abort if the same element of covmat
+  //has been entered twice
+  strcpy(c1err," Same element of covariance matrix entered twice");
+  //char comb[10];
+  for (m =0; m<3; m++){
+    for (n=0; n<3;n++){
+      sprintf(c2err, 
+	      "INPUTS.COVMAT_SCATTER[%d][%d]", m , n);
+      float t1 = fabs(INPUTS.COVMAT_SCATTER[m][n]);
+      float t2 = fabs(INPUTS.COVMAT_SCATTER_SQRT[m][n]);
+      float t3 = fabs(INPUTS.COVMAT_SCATTER_REDUCED[m][n]);
+      if( (t1>0) && (t2>0)  )
+	{ errmsg( SEV_FATAL,0 , fname, c1err, c2err); }
 
-    /* xxx mark delete April 24 2019 xxxxxxxx
-    if ( strcmp(INPUTS.MODELNAME,"FIXMAG") == 0 ) {
-      sprintf(GENLC.SNTYPE_NAME, "FIXMAG" ); 
-      GENLC.TEMPLATE_INDEX = MODEL_FIXMAG ;  //anything but zero
-    }
-    else {
-      sprintf(GENLC.SNTYPE_NAME, "RANMAG" ); 
-      GENLC.TEMPLATE_INDEX = (int)INPUTS.FIXMAG[0] ;
+      if ( (t1>0) && (t3>0)  ) 
+	{ errmsg( SEV_FATAL,0 , fname, c1err, c2err ); }
     }
-    xxxxxxxxxxx end mark xxxxxxxxxxxxx */
+  }
+  
 
+  //If INPUTS.COVMAT_SCATTER are negative abort
+  strcpy(c1err," diagonal entries of covariance matrix negative");
+  for (m = 0 ; m < 3 ; m++){
+    sprintf(c2err, "INPUTS.COVMAT_SCATTER[%d][%d]", m , m);
+    if (INPUTS.COVMAT_SCATTER[m][m] < -epsilon ) 
+      { errmsg( SEV_FATAL,0 , fname, c1err , c2err); }
   }
-  else if ( INDEX_GENMODEL  == MODEL_MLCS2k2 ) {
 
-    // define function to translage ifilt_rest into ifilt_model(ifilt_rest]
-    ifilt_tmp  = GENLC.IFILTINVMAP_REST[ifilt_rest] ;
+  //If values are given in terms of sqrt or reduced
+  //scatter, convert to covmat_scatter
+  for (m = 0 ; m < 3 ; m++){
 
-    genmag_mlcs2k2( 
-		   ifilt_tmp          // (I) 0-8 => UBVRIYJHK
-		   ,delta             // (I) shape parameter 
-		   ,NEPFILT           // (I) number of epochs
-		   ,ptr_epoch         // (I) Trest-Tpeak (days)
-		   ,ptr_genmag        // (O) ideal rest mags
-		   ,ptr_generr        // (O) ideal rest mag-errs
-		   ) ;
+    if (INPUTS.COVMAT_SCATTER_SQRT[m][m] > epsilon ){
+      xsig = INPUTS.COVMAT_SCATTER_SQRT[m][m]; // sqrt(DIAG) = sigma
+      INPUTS.COVMAT_SCATTER[m][m] = xsig * xsig;
 
+      if ( LDMP ) 
+	{ printf("\t Read SQRT[COV(%d,%d)] = %g \n",  m, m, xsig ); }
+      
+    }
   }
 
-  else if ( INDEX_GENMODEL  == MODEL_SALT2 ) {
 
-    // 1: bit0 => return flux instead of mag;
-    // 2: bit1 => print warning when flux < 0
-    // 8: bit3 => SALT2 dump
+  //If values are given in terms of a reduced 
+  //covariance matrix, convert to covmat_scatter
+  for (m = 0; m < 3 ; m++){
+    for (n = 0; n <3; n++){
+      if (m == n) continue;
 
-    OPTMASK      = 0 ; // return mag
-                      
-    /*
-    printf(" xxx passing ifilt_obs=%d x0=%f x1=%f c=%f \n",
-	   ifilt_obs,GENLC.SALT2x0, GENLC.SALT2x1, GENLC.SALT2c );
-    */
-    // apply scatter matrix
-    double S2x0, S2x1, S2c, S2mB, tmp ;
-    S2mB = GENLC.SALT2mB + GENLC.COVMAT_SCATTER[0] ;
-    S2x1 = GENLC.SALT2x1 + GENLC.COVMAT_SCATTER[1] ;
-    S2c  = GENLC.SALT2c  + GENLC.COVMAT_SCATTER[2] ;
-    tmp  = -0.4 * GENLC.COVMAT_SCATTER[0] ;
-    S2x0 = GENLC.SALT2x0 * pow(10.0,tmp);
+      xred = INPUTS.COVMAT_SCATTER_REDUCED[m][n] ;
 
+      if (fabs(xred) > epsilon) {
+	xx = INPUTS.COVMAT_SCATTER[m][m] * INPUTS.COVMAT_SCATTER[n][n] ;
+	INPUTS.COVMAT_SCATTER[m][n] = xred * sqrt(xx);
 
-    genmag_SALT2 (
-		  OPTMASK         // (I) bit-mask options
-		  ,ifilt_obs      // (I) obs filter index 
-		  ,S2x0           // (I) x0 term
-		  ,S2x1,S2x1      // (I) x1 and x1 used for error calc.
-		  ,S2c            // (I) SN color: E(B-V)
-		  ,mwebv          // (I) Galactic E(B-V)
-		  ,RV, AV         // (I) host extinc params (July 2016)
-		  ,z,z            // (I) redshift, and z used for error
-		  ,NEPFILT        // (I) number of epochs
-		  ,ptr_epoch         // (I) obs-frame time (days)
-		  ,ptr_genmag        // (O) mag vs. Tobs
-		  ,ptr_generr        // (O) mag-errs
-		  ) ;    
-  }
+	if ( LDMP ) 
+	  { printf("\t Read RHO(%d,%d) = %g\n", m, n, xred ); }
+      }
 
-  else if ( INDEX_GENMODEL  == MODEL_SIMSED ) {
+    }  // n
+  }  // m
+	
 
-    // 1: bit0=> return flux instead of mag;
-    // 2: bit1 => print warning when flux < 0
+  // Test that intrinsic matrix is symmetric in case both 
+  // off-diagonal elements have been provided.
 
-    NPAR         = INPUTS.NPAR_SIMSED;
+  strcpy(c1err,"Symmetric off-diagonal entries entered and different for ");
+  double diff ;
+  int    Ldiff, Lmn, Lnm ;
+  //	int mm, nn ;
+  for (m = 0; m < 3 ; m++){
+    for (n = 0;  n < 3 ; n++){
+      sprintf(c2err, "INPUTS.COVMAT_SCATTER[%d][%d]", m , n);
+      if (n <= m) continue;
+      diff =  fabs(INPUTS.COVMAT_SCATTER[m][n] - 
+	           INPUTS.COVMAT_SCATTER[n][m]);
 
-    OPTMASK      =  0              // 0->return mags   
-      + INPUTS.OPTMASK_SIMSED      // 4 => sequential GRIDONLY option
-      ;
+      Ldiff = diff > epsilon ;
+      Lmn   = fabs(INPUTS.COVMAT_SCATTER[m][n]) > epsilon ;
+      Lnm   = fabs(INPUTS.COVMAT_SCATTER[n][m]) > epsilon ;
 
-    //    if ( GENLC.CID==19201 && ifilt_obs==1 ) { OPTMASK += 8 ; }
-    
-    genmag_SIMSED (
-		  OPTMASK            // (I) bit-mask options
-		  ,ifilt_obs         // (I) obs filter index 
-		  ,GENLC.SALT2x0     // (I) x0 (flux-scale)
-		  ,NPAR              // (I) Number of SIMSED pars + baggage
-		  ,INPUTS.GENFLAG_SIMSED // (I) SIMSED flag per param
-		  ,GENLC.SIMSED_IPARMAP  // (I) ipar map
-		  ,GENLC.SIMSED_PARVAL   // (I) SIMSED gen params (lumipar)
-		  ,GENLC.RV, GENLC.AV        // (I) added Mar 1 2017
-		  ,mwebv             // (I) Galactic E(B-V)
-		  ,z                 // (I) redshift
-		  ,NEPFILT           // (I) number of epochs
-		  ,ptr_epoch         // (I) rest-frame time (days)
-		  ,ptr_genmag        // (O) mag vs. Tobs
-		  ,ptr_generr        // (O) ideal rest mag-errs
-		  ,&GENLC.TEMPLATE_INDEX // (O) SED index
-		  ) ;
+      if ( Ldiff && Lmn && Lnm ) 
+	{  errmsg( SEV_FATAL,0 , fname, c1err, c2err);  }
 
-    if ( INPUTS.OPTMASK_SIMSED == OPTMASK_SIMSED_GRIDONLY ) 
-      { GENLC.CID = GENLC.TEMPLATE_INDEX ; }
+    }
+  }    	
 
-  }
 
-  else if ( INDEX_GENMODEL  == MODEL_BYOSED ) {
 
-    double HOSTPAR_BYOSED[20];
-    HOSTPAR_BYOSED[0] = GENLC.RV ;
-    HOSTPAR_BYOSED[1] = GENLC.AV ;
-    HOSTPAR_BYOSED[2] = SNHOSTGAL.LOGMASS ;
+  //If only one of the asymmetric off-diagonal element
+  //entered, put in the remaining terms.
 
-    genmag_BYOSED(
-		  GENLC.CID
-		  ,z, GENLC.DLMU       // (I) helio-z and distance modulus
-		  ,mwebv               // (I) E(B-V) for Milky Way
-		  ,HOSTPAR_BYOSED      // (I) host properties
-		  ,ifilt_obs           // (I) filter index
-		  ,NEPFILT             // (I) number of epochs
-		  ,ptr_epoch           // (I) rest-frame time (days)
-		  ,ptr_genmag        // (O) mag vs. Tobs
-		  ,ptr_generr        // (O) ideal rest mag-errs
-		  );		  
+  if(fabs(INPUTS.COVMAT_SCATTER[0][1])>epsilon){
+    INPUTS.COVMAT_SCATTER[1][0] = INPUTS.COVMAT_SCATTER[0][1];
+  } else {
+    INPUTS.COVMAT_SCATTER[1][0] = INPUTS.COVMAT_SCATTER[1][0];
   }
-
-  else if ( INDEX_GENMODEL  == MODEL_SNOOPY ) {
-
-    ifilt_tmp = GENLC.IFILTINVMAP_REST[ifilt_rest] + 1 ;
-    genmag_snoopy (
-		   ifilt_tmp             // (I) SNoopY internal filter index
-		   ,dm15                 // (I) shape parameter 
-		   ,NEPFILT              // (I) number of epochs
-		   ,ptr_epoch            // (I) Trest-Tpeak (days)
-		   ,ptr_genmag           // (O) ideal rest mags
-		   ,ptr_generr           // (O) rest mag-errors
-		   );
-
+  
+  if (fabs(INPUTS.COVMAT_SCATTER[2][0])>epsilon){
+    INPUTS.COVMAT_SCATTER[0][2] = INPUTS.COVMAT_SCATTER[2][0];
+  } else {
+    INPUTS.COVMAT_SCATTER[2][0] = INPUTS.COVMAT_SCATTER[0][2];
+  }	
+  if (fabs(INPUTS.COVMAT_SCATTER[2][1])>epsilon){
+    INPUTS.COVMAT_SCATTER[1][2] = INPUTS.COVMAT_SCATTER[2][1];
+  }else {
+    INPUTS.COVMAT_SCATTER[2][1] = INPUTS.COVMAT_SCATTER[1][2];
   }
 
-  else if ( INDEX_GENMODEL  == MODEL_S11DM15 ) {
+  //Have INPUTS.COVMAT_SCATTER completely. 
 
-    genmag_S11DM15(ifilt_obs, dm15, AV, RV, mwebv, z, mu,
-		   NEPFILT, ptr_epoch, ptr_genmag, ptr_generr);
+  //Check that submatrices have non-singular dets
+  strcpy(c1err,"Submatrices are not positive definite for the combination ");
 
+  for (m =0; m < 3 ; m++){
+    n = m + 1; 
+    
+    if (3 == n ) {n = 0;}
+    
+    diff = (INPUTS.COVMAT_SCATTER[m][m]*
+	    INPUTS.COVMAT_SCATTER[n][n]) - 
+      (INPUTS.COVMAT_SCATTER[m][n]*
+       INPUTS.COVMAT_SCATTER[m][n]);
+
+    sprintf(c2err, "%d\t%d", m , n);
+    
+    if (diff < 0) {
+      printf("PRE-ABORT DUMP \n\t %d \t %d \t %g\n", m, n , diff);
+      errmsg( SEV_FATAL,0 , fname, c1err, c2err);
+    }
   }
 
-  else if (  INDEX_GENMODEL  == MODEL_NON1ASED ) {
+  int N = -1;
+  char *cptr ;
+  N++ ; cptr = GENLC.COVMAT_SCATTER_README[N] ;
+  sprintf(cptr,"%s", "\t Cov matrix:");
 
-    index    = GENLC.TEMPLATE_INDEX; 
-    isp      = GENLC.NON1ASED.ISPARSE ;
-    sprintf(GENLC.SNTYPE_NAME,  "%s", INPUTS.NON1ASED.LIST_TYPE[index] );
-    sprintf(GENLC.SNTEMPLATE,   "%s", INPUTS.NON1ASED.LIST_NAME[index] );
-    sprintf(GENLC.NON1ASED.TYPE[isp], "%s", GENLC.SNTYPE_NAME );
 
-    genmag_NON1ASED (
-		  index                // (I) NON1A class
-		  ,ifilt_obs           // (I) obs-filter index
-		  ,mwebv               // (I) Galactic E(B-V)
-		  ,z                   // (I) redshift
-		  ,GENLC.DLMU          // (I) distance modulus
-		  ,RV, AV             // (I) RV and AV of host
-		  ,NEPFILT             // (I) number of epochs
-		  ,ptr_epoch           // (I) Tobs (days)
-		  ,ptr_genmag          // (O) obs mags
-		  ,ptr_generr          // (O) obs mag-errs
-		  );
-  }
-  else if (  INDEX_GENMODEL  == MODEL_NON1AGRID ) {  // Mar 2016
+  N++ ; cptr = GENLC.COVMAT_SCATTER_README[N] ;
+  sprintf(cptr,"\t\t %8s(%d) %8s(%d) %8s(%d) "
+	  ,GENLC.COVMAT_SCATTER_NAME[0], 0
+	  ,GENLC.COVMAT_SCATTER_NAME[1], 1
+	  ,GENLC.COVMAT_SCATTER_NAME[2], 2 );
 
-    /*
-    printf(" xxx pass NON1AGRID args: \n");
-    printf(" xxx ifilt_obs=%d  mwebv=%f z=%f \n", ifilt_obs, mwebv8, z8);
-    printf(" xxx RV=%f AV=%f  NEP=%d \n", RV8, AV8, NEPFILT);
-    fflush(stdout);
-    */
-    
-    // use same randoms for each band
-    double ranWgt   = GENLC.NON1AGRID_RANFlat ;
-    double ranSmear = GENLC.NON1AGRID_RANGauss ;
-    
-    genmag_NON1AGRID (
-		   ifilt_obs           // (I) obs-filter index
-		   ,mwebv               // (I) Galactic E(B-V)
-		   ,GENLC.REDSHIFT_CMB  // (I) CMB redshift, NOT zhelio
-		   ,RV, AV             // (I) RV and AV of host
-		   ,ranWgt, ranSmear    // (I) to pick random index & magSmear
-		   ,NEPFILT             // (I) number of epochs
-		   ,ptr_epoch           // (I) Trest-Tpeak (days)
-		   ,ptr_genmag          // (O) obs mags
-		   ,ptr_generr          // (O) obs mag-errs
-		   ,&GENLC.MAGSMEAR_COH // (O) store random magSmear
-		      );
+  N++ ; cptr = GENLC.COVMAT_SCATTER_README[N] ;
+  sprintf(cptr,"%s", "\t -----------------------------------------------");
+  
+  
+  for (m = 0 ; m < 3 ; m++){
+    N++ ; cptr = GENLC.COVMAT_SCATTER_README[N] ;
+    sprintf(cptr,"\t %-4s(%d) :  %10.6f  %10.6f  %10.6f"
+	    ,GENLC.COVMAT_SCATTER_NAME[m], m
+	    ,INPUTS.COVMAT_SCATTER[m][0]
+	    ,INPUTS.COVMAT_SCATTER[m][1]
+	    ,INPUTS.COVMAT_SCATTER[m][2]  );
 
-    GENLC.TEMPLATE_INDEX = fetchInfo_NON1AGRID("NON1A_INDEX");
-    GENLC.SNTYPE         = fetchInfo_NON1AGRID("NON1A_ITYPE_USER");
   }
-  else if ( INDEX_GENMODEL  == MODEL_LCLIB ) {  // July 2017
-
-    set_TobsRange_LCLIB(GENLC.epoch8_obs_range);
+  
+  N++ ; cptr = GENLC.COVMAT_SCATTER_README[N] ;
+  cptr[0] = 0 ;
+	
+  for ( i=0; i <= N; i++ ) {
+    printf("%s\n", GENLC.COVMAT_SCATTER_README[i] );
+  }
 
-    sprintf(GENLC.SNTYPE_NAME, "%s", LCLIB_INFO.NAME_MODEL ); 
-    double *ptr_template = &GENLC.genmag8_obs_template[ifilt_obs];
-    double LAMAVG        = INPUTS.LAMAVG_OBS[ifilt_obs];
-    double ZTRUE, TobsPeak ;
+  //printvals();
+  //Do the Cholesky Decomposition once and for all
+  double a_data[] = { 
+    INPUTS.COVMAT_SCATTER[0][0],
+    INPUTS.COVMAT_SCATTER[0][1],
+    INPUTS.COVMAT_SCATTER[0][2],
+    INPUTS.COVMAT_SCATTER[1][0],
+    INPUTS.COVMAT_SCATTER[1][1],
+    INPUTS.COVMAT_SCATTER[1][2],
+    INPUTS.COVMAT_SCATTER[2][0],
+    INPUTS.COVMAT_SCATTER[2][1],
+    INPUTS.COVMAT_SCATTER[2][2]
+  };
 
-    genmag_LCLIB(GENLC.CID, ifilt_obs, GENLC.RA, GENLC.DEC, 
-		 mwebv, LAMAVG,
-		 NEPFILT, ptr_epoch, 
-		 ptr_genmag, ptr_template,    // return args
-		 &TobsPeak                    // Tobs with peak brightness
-		 );
+  gsl_matrix_view chk;  
 
-    // for non-recurring events, set PKMJD like any other transient
-    if ( LCLIB_INFO.IFLAG_RECUR_CLASS == IFLAG_RECUR_NONRECUR ) {
-      GENLC.PEAKMJD  = INPUTS.GENRANGE_PEAKMJD[0] + TobsPeak ;
-      // xxx mark delete  GENLC.PEAKMJD_SMEAR         = GENLC.PEAKMJD ;
+  chk  = gsl_matrix_view_array (a_data, 3, 3); 
+  gsl_linalg_cholesky_decomp ( &chk.matrix)  ;
+  
+  for (i =0; i<3; i++){
+    for (j = 0; j < 3 ; j++){      
+      if (i <= j ) { 
+	INPUTS.COVMAT_CHOLESKY_SCATTER[i][j] =  
+	  gsl_matrix_get(&chk.matrix,i,j); 
+      }
+      else {
+	INPUTS.COVMAT_CHOLESKY_SCATTER[i][j] = 0.0 ;
+      }
     }
+    
+  }
+  //printvals();
+  
 
-    /*
-    printf(" xxx genmag_LCLIB returns zphot = %.3f +- %.3f  (ztrue=%.3f)\n",
-	   SNHOSTGAL.ZPHOT, SNHOSTGAL.ZPHOT_ERR, GENLC.REDSHIFT_CMB );
-    */
+  return;	
+	
+} // END OF INIT_COVMAT_SCATTER
 
-  }
 
-  // !=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=
-  //         end of model if-block
-  // !=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=!=
 
-  // ---------------------------------------
-  // check option to interpolate model mags (see setEpochGrid above)
-  if ( INPUTS.TGRIDSTEP_MODEL_INTERP > 0.001 ) {
-    NEPFILT = NEPFILT_SAVE ;
-    interpEpochGrid(NEPFILT, Tmodel, NGRID,              // I
-		    ptr_epoch, ptr_genmag, ptr_generr) ; // I/O
-  } 
+// ========================================================
+int GEN_COVMAT_SCATTER ( double *randoms, double *SCATTER_VALUES  ) 
+{
+  // Created July 2011 by R.Biswas
+  // Ensure Initialization of scatter vector;
+  //
+  // *randoms        (I) : 3 gaussian random numbers
+  // *SCATTER_VALUES (O) : ..
+  //
 
-  // ======================================
-  // store peak mag in rest-frame
+  SCATTER_VALUES[0] = 0. ;
+  SCATTER_VALUES[1] = 0. ;
+  SCATTER_VALUES[2] = 0. ;
+  
+  if ( INPUTS.NCOVMAT_SCATTER <= 0 ) { return 0 ; }
 
-  if ( GENFRAME_OPT == GENFRAME_REST ) {
-    iep =  NEPFILT - 1 ; // last epoch is always peak
-    GENLC.peakmag8_rest[ifilt_rest] = ptr_genmag[iep] ;
+  //Draw 3 vector from a standard (uncorrelated multinormal distribution)
+  int i , j;
+  //double sigma =1.0;
+  double normalvector[3];
+  
+  //Form 3 vector of standard normal RV
+  for (i =0; i <3; i++ ){
+    normalvector[i] = randoms[i];    
   }
 
-  // apply intrinsic model mag-smearing AFTER model-mag generation
-  // Note that ptr_genmag is both an input and output arg.
-  genmodelSmear(NEPFILT, ifilt_obs, ifilt_rest, z, 
-		 ptr_epoch, ptr_genmag, ptr_generr ); 
+  //Matrix Multiply
+  //scatter_values = ch^T normalvector
+  for (i = 0 ; i < 3 ; i++){
+    for (j = 0 ; j < 3 ; j++){
+      //transpose cholesky matrix
+      double tmp = INPUTS.COVMAT_CHOLESKY_SCATTER[j][i]; 
+      SCATTER_VALUES[i] += tmp * normalvector[j];      
+    }
+  }
+  return 0;
 
-  NEPFILT = NEPFILT_GENLC(-1, ifilt_obs);
+} //END OF GEN_COVMAT_SCATTER
 
-  return ;
 
-}  // end of genmodel
+// *******************************
+void INIT_FUDGE_SNRMAX(void) {
 
 
-// ********************************************
-double  genmodel_Tshift(double T, double z) {
+  // Created May 2015 by R.Kessler
+  // Parse INPUTS.STRING_FUDGE_SNRMAX
+  
+  //  char fnam[] = "INIT_FUDGE_SNRMAX" ;
+  char *ptrStr, f1[2], strSNRMAX[20] ;
 
-  // Created Jun 2017
-  // Return model phase shift to smear rise/fall times.
-  // Input T = phase (days) w.r.t. peak
-  // Works only for rest-frame models.
+  // -------------- BEGIN -------------
 
-  double Tshift; 
-  double zz = 1.0 + z ;
-  // --------------- BEGIN --------------
+  if ( INPUTS.OPT_FUDGE_SNRMAX == 0 ) { return ; }
 
-  if ( GENFRAME_OPT == GENFRAME_REST ) {
-    if ( T < 0.0 ) {
-      Tshift = -(T/18.0) * GENLC.RISETIME_SHIFT * zz ;
-    }
-    else {
-      Tshift = -(T/15.0) * GENLC.FALLTIME_SHIFT * zz ;
-    }    
+  ptrStr = INPUTS.STRING_FUDGE_SNRMAX ;
+  if ( strstr(ptrStr,"=") != NULL ) {
+    sprintf(f1, "%c", ptrStr[0] ) ; // single-char band
+    sprintf(strSNRMAX, "%s", (ptrStr+2) );
+    INPUTS.IFILTOBS_FUDGE_SNRMAX = INTFILTER(f1);
   }
   else {
-    // no shift for OBS-frame models (e.g., SALT2, NON1ASED)
-    Tshift = 0.0 ;
+    sprintf(strSNRMAX, "%s", ptrStr );
   }
 
-  return(Tshift) ;
+  // read SNRMAX part of string into float
+  sscanf(strSNRMAX, "%f", &INPUTS.FUDGE_SNRMAX); 
 
-} // end genmodel_Tshift
+} // end of INIT_FUDGE_SNRMAX
 
 // ********************************************
-int setEpochGrid(double TMIN, double TMAX, double *TGRID ) {
+void init_covar_mlcs2k2(void) {
 
-  // Created Oct 23 2015
-  // Inputs: TMIN and TMAX
-  // Ouput: TGRID[i] = fixed grid
-  // Function outut = size of grid
+  /*******
+   Initialize covariance matrix used to generate MLCS model.
+   First version (9/2006) assumes 100% correlation among epochs
+   within a bandpass, and zero correlation between bandpasses.
+   The correlation model may get more sophisticate later.
 
-  double t, TSTEP, TSTART, TEND;
-  int  NGRID, iTround ;
-  //  char fnam[] = "setEpochGrid" ;
+   Note that this uses "gencovar_mlcs2k2" to fetch pieces
+   of the real MLCS smatrix.
 
-  // ---------------- BEGIN ----------------
 
-  TSTEP = INPUTS.TGRIDSTEP_MODEL_INTERP ;
-  NGRID = 0 ;
-  if ( TSTEP <= 0.0 ) { return(NGRID) ; }
+  History
+  ~~~~~~~~
+  Dec 30, 2007:  fill GENLC.PEAKMAGERR_MODEL[ifilt] 
 
-  iTround = (int)TMIN ;
-  TSTART  = (double)iTround -2.0 ;
-  if ( TSTART > 0.0 ) { TSTART = -TSTEP; }
+  May 28,  2009:  don't write covFile because this is called
+                  before the [VERSION]/ subdir is created,
+                  and because nobody uses this COV file.
 
-  TEND    = TMAX + TSTEP ;
-  if ( TEND < TSTEP ) { TEND = TSTEP + 1.0 ; }
+  *******/
 
-  /*
-  if( TEND < 20.0 ) {
-    printf(" xxx %s: TMIN,TMAX -> TSTART,TEND = %.2f, %.2f -> %.2f, %.2f \n", 
-	   fnam, TMIN, TMAX, TSTART, TEND );
-  }
-  */
+  int 
+    NFILT, MINEP, MAXEP, NEP, NMAT
+    ,iep, ifilt,ifilt_rest, iep1, iep2, ifilt1, ifilt2
+    ;
 
-  for(t=TSTART; t <= TEND; t += TSTEP ) {
-    TGRID[NGRID] = t;
-    NGRID++ ;
-  }
+  double epoch8, sqerr8    ;
+  float MODELERR[MXFILTINDX][MXEPCOV] ;
+  float err1, err2, errtmp,T1 ;
+  char fnam[] = "init_covar_mlcs2k2" ;
 
-  return(NGRID);
+  // --------------- BEGIN ---------
 
-} // end of setEpochGrid
 
+  //  if ( INPUTS.GENMODEL_ERRSCALE <= 0.000001 ) return
 
-void interpEpochGrid(
-		     int NEP_LC,           // (I) Nep for LC
-		     double *TList_LC,     // (I) Tlist for LC
-		     int NGRID,            // (I) Number of grid points
-		     double *TList,        // (I/O) T at each grid point
-		     double *magList,      // (I/O) mag at each grid point
-		     double *magerrList )  // (I/O) magerr at each grid
-{ 
+  NMAT = 1 ;      // size of covar matrix to fetch
+  MINEP = mlcs2k2_Tmin() ;
+  MAXEP = mlcs2k2_Tmax() ;
+  NEP   = MAXEP - MINEP + 1 ;
 
-  // Oct 23 2015
-  // Use input grid of mags (maglist vs. Tlist) to interpolate
-  // mags on the light curve epochs (TList_LC).
-  // Note that TList, magList and magerrList are input
-  // with GRID values and overwritten with the LightCurve values.
-  //
-  // This function is associated with user-input key 
-  // TGRIDSTEP_MODEL_INTERP  to generate LC mags on a grid
-  // and then interpolate.
+  sprintf(BANNER,"Init covariance matrix for sim: %d to %d days.", 
+	  MINEP, MAXEP);
+  print_banner(BANNER);
 
-  double *GRID_T, *GRID_MAG, *GRID_MAGERR;
-  double T, mag, magerr;
-  int MEMD, ep;
-  int OPT_INTERP=1;  // linear interp
-  char fnam[] = "interpEpochGrid" ;
+  if ( NEP >= MXEPCOV ) {
+    sprintf(c1err,"NEP = %d exceeds array bound (MXEPCOV=%d)", NEP, MXEPCOV);
+    errmsg(SEV_FATAL, 0, fnam, c1err, ""); 
+  }
 
-  // -------------- BEGIN -------------------
-  
-  // create arrays to store input GRID
-  MEMD        = NGRID * sizeof(double);
-  GRID_T      = (double*) malloc( MEMD );
-  GRID_MAG    = (double*) malloc( MEMD );
-  GRID_MAGERR = (double*) malloc( MEMD );
 
-  for(ep=0; ep<NGRID; ep++ ) {
-    GRID_T[ep]      = TList[ep];
-    GRID_MAG[ep]    = magList[ep];
-    GRID_MAGERR[ep] = magerrList[ep];    
 
-    TList[ep]      = 999. ; // init output
-    magList[ep]    = 999. ; // idem 
-    magerrList[ep] = 999. ; // idem
+  NFILT   = GENLC.NFILTDEF_REST; 
+
+  if ( NFILT > MXFILT_COVAR ) {
+    sprintf(c1err,"NFILT=%d exceeds COVAR array bound MXFILT=%d", 
+	    NFILT, MXFILT_COVAR );
+    errmsg(SEV_FATAL, 0, fnam, c1err, ""); 
   }
 
-  // interpolate for each LC epoch and overwrite input arrays
-  for(ep=0; ep < NEP_LC; ep++ ) {    
+  for ( ifilt = 0 ; ifilt < NFILT ; ifilt++ ) {
+
+    ifilt_rest = GENLC.IFILTMAP_REST[ifilt];
+
+    for ( iep = MINEP; iep <= MAXEP ; iep++ ) {
+      epoch8 = (double)iep ;
+      gencovar_mlcs2k2(NMAT, &ifilt, &epoch8, &sqerr8 );  // get sqerr8
+      errtmp  = (float)sqrt(sqerr8);
+      MODELERR[ifilt][iep-MINEP] = errtmp ;
+
+      T1 = (float)(iep);
+      
+      // store errors at peak for each filter.
+      if ( fabsf(T1) < 0.5 )
+	{ GENLC.PEAKMAGERR_MODEL[ifilt_rest] = errtmp ; }
 
-    T      = TList_LC[ep];
 
-    mag    = interp_1DFUN(OPT_INTERP, T, 
-			  NGRID, GRID_T, GRID_MAG, fnam);
+    } // end of iep loop
+  }  // end of ifilt loop
 
-    magerr = interp_1DFUN(OPT_INTERP, T,
-			  NGRID, GRID_T, GRID_MAGERR, fnam);
 
-    TList[ep]      = T ;
-    magList[ep]    = mag;
-    magerrList[ep] = magerr ;
+  // now construct full covar matrix using error at each epoch
 
-    /*
-    printf(" xxx ep=%2d  T=%.2f  mag= %.2f +- %.2f \n", 
-	   ep, T, mag, magerr ); // xxxxxxxxxxxxxxxxxxxxxx
-    */
+  for ( ifilt1=0; ifilt1 < NFILT; ifilt1++ ) {
+    for ( iep1=0; iep1 < NEP; iep1++ ) {
+      for ( ifilt2=0; ifilt2 < NFILT; ifilt2++ ) {
+	for ( iep2=0; iep2 < NEP; iep2++ ) {
+   
+	  GENLC.COVAR[ifilt1][iep1][ifilt2][iep2] = 0.0 ;  // init to zero
+
+	  // set 100% correlation only within same passband
+	  if ( ifilt1 == ifilt2 ) {
+	    err1 = MODELERR[ifilt1][iep1] ;
+	    err2 = MODELERR[ifilt2][iep2] ;
+	    GENLC.COVAR[ifilt1][iep1][ifilt2][iep2] = err1 * err2 ;
+	  }
 
+	}
+      }
+    }
   }
 
-  free(GRID_T);
-  free(GRID_MAG);
-  free(GRID_MAGERR);
 
-} // end of interpEpochGrid
+}  // end of init_covar_mlcs2k2
 
-// ********************************************
-void genmodelSmear(int NEPFILT, int ifilt_obs, int ifilt_rest,  double z, 
-		   double *ptr_epoch, double *ptr_genmag, double *ptr_generr ) {
 
+
+// *********************************************
+void readme_doc(int iflag_readme) {
+
+  // Created 2007 by R.Kessler
+  // fill VERSION_INFO.README_DOC structure with 
+  // "VERSION_INFO.NLINE_README" lines of README content.
+  // Note that the contents are printed from elsewhere
   //
-  // Created Jul 1, 2010 by R.Kessler
-  // Move model-mag smearing  code from end of genmag_smear to here.
-  // Also add new option to specify smearing vs. lambda
-  //
-  // Inputs:
+  // iflag_readme = 1 => fill init-part
+  // iflag_readme = 2 => fill post-sim part
   //
-  // NEPFILT     : Number of epochs for this filter
-  // ifilt_obs   : observer filter index
-  // ifilt_rest  : rest-frame filter index (for rest-frame model only)
-  // z           : redshift
+  // Jul 24, 2009: re-write mag-smearing stuff, 
+  //               and include new GENMAG_SMEAR_FILTER
   //
-  // *ptr_epoch  : pointer to epochs (rest or observer)
+  // Dec 20, 2009: print out SIMSED parameters and ranges
+  // Jul 01, 2010: print lambda-dependent mag smearing stuff
   //
-  // *ptr_genmag : pointer to list of generated mags
-  //               NOTE THAT *ptr_genmag values are CHANGED
-  //               based on smearing model !!!
+  // Oct 29, 2010: print nonIa info for both non1a and NON1A;
   //
-  // Jul 19, 2010: return if DO_MODELSMEAR == 0.
-  // Oct 16, 2010: return for GRID option
+  // Mar 2011 : write FUDGE_SNRMAX, FUDGE2_SNRMAX if they are non-zero.
   //
-  // Apr 2012: cleanup with call to genSmear_ERRSCALE 
-  //           Also call new functino get_genSmear(...)
+  // Jul 19, 2011: clarify APPLY_SEARCHEFF_OPT
   //
-  // Jun 14 2016: load GENLC.MAGSMEAR_COH at end of function
+  // Mar 14, 2012: write SMEAR_FUNPAR
   //
+  // Jan 19 2016: remove redundant NON1A dump at beginning.
+  // Feb 01 2017: call readme_doc_NON1ASED
+  // Jan 16 2019: always print KCOR file (before, only printed for SNIA)
+  // May 27 2019: print PEAKMJD-estimate method
 
-  int
-    iep, opt_frame, ifilt_local
-    ,USE_GENMODEL_ERRSCALE, USE_GENSMEAR_MODEL       
-    ,ONE = 1
-    ;
+  char ctmp[MXPATHLEN], cfilt[2], cwd[MXPATHLEN] ;
+  char *cptr;
+  char conoff[2][4] = { "OFF" , "ON" } ;
 
-  double 
-    ran_COH, ran_FILT
-    ,magSmear, magSmear_model
-    ,smearsig, smearsig_fix, smearsig_model
-    ,Tep, Tpeak, Trest, lamrest, Z1
-    ;
+  int i, j, j2, ifilt_obs, ifilt_rest, ifilt, itmp, imap, iopt, ipar ;
+  int NLINE, NOV, NON1A_non1a, OVP1, OVP2, OVP3 ;
 
-  float lamavg4, lamrms4, lammin4, lammax4 ;
+  double XN, XNERR ;
+  float xt, xtprod, val, ZMIN, ZMAX, shift[2];
 
-  char cfilt[2];
-  char fnam[] = "genmodelSmear" ;
+  char  fnam[] = "readme_doc" ;
 
-  // -------------- BEGIN ------------
+  // ------------ BEGIN readme_doc() ---------------
 
-  if ( INPUTS.DO_MODELSMEAR  == 0 ) 
-    { return ; }
+  i=0 ;
 
-  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID  ) 
-    { return ; }
+  print_banner ( " Fill comments for README doc-file" );
 
-  if ( GENFRAME_OPT == GENFRAME_REST  ) 
-    { ifilt_local = ifilt_rest ;  Z1 = 1.0 ; }
-  else 
-    { ifilt_local = ifilt_obs ;   Z1 = 1.0 + z ; }
+  if ( iflag_readme == 2 ) goto AFTERSIM ;
 
+  //--- brief description
 
-  sprintf(cfilt,  "%c", FILTERSTRING[ifilt_local] ); // for err msg only
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr," USER COMMENT: %s \n\n", INPUTS.COMMENT);
 
-  // sanity check that epoch at peak really as Tpeak = 0
-  Tpeak = ptr_epoch[NEPFILT - 1];
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr," BRIEF_DESCRIPTION: simulate %s SNe with GENMODEL = %s \n", 
+	  INPUTS.GENSOURCE, INPUTS.MODELNAME );
 
-  if ( fabs(Tpeak) > 0.0001 && NEPFILT > 0 ) {
-    sprintf(c1err,"Tpeak(%s) = %f but expected T=0 at peak", 
-	    cfilt, Tpeak );
-    sprintf(c2err,"PEAKMJD(GEN) = %f  LIBID=%d  NEPFILT=%d \n", 
-	    GENLC.PEAKMJD, GENLC.SIMLIB_ID, NEPFILT );
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
-  }
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\n");
 
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"  HOST MACHINE: %s \n", getenv("HOST") );
 
-  // init all smearing to zero
-  for ( iep = 0; iep <= NEPFILT; iep++ )  {  
-    GENFILT.genmag8_smear[ifilt_obs][iep] = 0.0 ; 
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf( cptr, "  USERNAME:  %s \n", getenv("USER") );
+
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"  SNDATA_ROOT:  %s \n", PATH_SNDATA_ROOT );
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"  SNANA_DIR:     %s \n", PATH_SNANA_DIR );
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"  SNANA_VERSION: %s \n", SNANA_VERSION_CURRENT );
+
+  // write current directory (Sep 5 2013)
+  if ( getcwd(cwd,MXPATHLEN) != NULL ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"  Current Dir:  %s \n", cwd );
   }
 
+  // -----------------------------
+
+  // indicate changes if "GENPERFECT" is requested.
+  readme_doc_GENPERFECT(&i);
 
-  // ----------------------------------------------
-  // start with coherent smearing (GENMAG_SMEAR)
-  // that is common to all passbands.
+  // ---- full description
 
-  if ( INPUTS.GENMAG_SMEAR > 0.0001 ) {
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\n FULL_DESCRIPTION: \n" ); 
 
-    ran_COH = GENLC.GENSMEAR_RANGauss_FILTER[0] ; // retrieve random #
+  readme_doc_SIMLIB(&i);
 
-    magSmear = INPUTS.GENMAG_SMEAR * ran_COH ;
-    GENLC.MAGSMEAR_COH = magSmear ;  // store global
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t Generation VERSION: %s \n", INPUTS.GENVERSION ); 
 
-    for ( iep = 1; iep <= NEPFILT; iep++ )   { 
-      *(ptr_genmag+iep-1)                   += magSmear ;
-      GENFILT.genmag8_smear[ifilt_obs][iep] += magSmear ;
-    }
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t Generation source : %s \n", INPUTS.GENSOURCE ); 
+
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t Generation FILTERS: %s \n", INPUTS.GENFILTERS ); 
+
+  if ( GENFRAME_OPT == GENFRAME_REST ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t Rest-frame FILTERS: %s  for  model=%s\n", 
+	    GENLC.FILTLIST_REST, INPUTS.MODELNAME );
+
+  }
+  // ------------
+  // print info for skipped filters
+
+  readme_doc_filterWarn(&i);
+
+  NON1A_non1a = ( INDEX_GENMODEL == MODEL_NON1ASED ) ;
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t KCOR lookup tables: %s \n", INPUTS.KCOR_FILE ); 
+    
+
+  if ( GENFRAME_OPT == GENFRAME_REST ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t KCOR lookup  time : Trest" );
+    if ( INPUTS.KCORFLAG_STRETCH == 1 ) strcat ( cptr, "/STRETCH" );
+    strcat ( cptr, "\n" );
+
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t AVwarp option for SED : color from " );
+    if ( INPUTS.KCORFLAG_COLOR == 1 ) 
+      { strcat ( cptr, "closest passbands \n" ); }
+    else if ( INPUTS.KCORFLAG_COLOR == 2 ) 
+      { strcat ( cptr, "Jha table \n" ); }
+    else
+      { strcat ( cptr, "UNKNOWN\n" ); }
   }
 
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  if ( INPUTS.SMEARFLAG_FLUX>0 ) { j=1; } else { j=0; }
+  sprintf(cptr, "\t Flux-smearing is %s \n", conoff[j] );
 
-  // check old model of using the fit-model errors
-  if ( INPUTS.GENMODEL_ERRSCALE > 1.0E-6  ) 
-    { USE_GENMODEL_ERRSCALE = 1 ; }
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t Reported flux-uncertainty includes " ); 
+  j2 = (INPUTS.SMEARFLAG_FLUX & 2);
+  if ( j2 == 0 ) 
+    { strcat(cptr,"SKY+GALAXY+SOURCE\n"); }
   else
-    { USE_GENMODEL_ERRSCALE = 0 ; }
+    { strcat(cptr,"SKY only\n"); } // SMP-like errors
+
+
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  j = INPUTS.SMEARFLAG_ZEROPT ;
+  sprintf(cptr, "\t Zeropt-smearing is %s \n", conoff[j] );
+
+  i++; cptr = VERSION_INFO.README_DOC[i] ;  j=0;
+  OVP1 = INPUTS.SMEARFLAG_HOSTGAL & SMEARMASK_HOSTGAL_PHOT ; 
+  if ( OVP1 ) { j = 1; }
+  sprintf(cptr, "\t Host-galaxy shot-noise  is %s \n", conoff[j] );
+
+
+  i++; cptr = VERSION_INFO.README_DOC[i] ;  j=0;
+  OVP2 = INPUTS.SMEARFLAG_HOSTGAL & SMEARMASK_HOSTGAL_IMAGE ; 
+  if ( OVP2 ) { j = 1; }
+  sprintf(cptr, "\t Host-galaxy image-noise  is %s \n", conoff[j] );
+
+
+  readme_doc_MWXT(&i);
+
+
+  // ------- RATE INFO ---------
+
+  for ( j=0; j < NLINE_RATE_INFO; j++ ) {
+     i++; cptr = VERSION_INFO.README_DOC[i] ;
+     sprintf(cptr,"%s\n", LINE_RATE_INFO[j] );
+  }
 
+  // ------- generation --------
 
-  USE_GENSMEAR_MODEL = 
-    ( (istat_genSmear() > 0) && (IFLAG_GENSMEAR == IFLAG_GENSMEAR_FILT) ) ;
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\n  GENERATION RANGES: \n");
 
-  smearsig_fix   = 0.0 ;
-  smearsig_model = 0.0 ;
+  if ( INPUTS.USE_SIMLIB_GENOPT ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t ==> Override gen-values with SIMLIB header values.\n");
+  }
 
-  // first get random number for this passband based on 
-  // rest- or observer-frame model
+  if ( INPUTS.USE_SIMLIB_REDSHIFT == 0 ) 
+    { sprintf(ctmp,"%s distribution.", INPUTS.RATEPAR.NAME ); }
+  else
+    { sprintf(ctmp,"SIMLIB values." ); }
 
-  ran_FILT = GENLC.GENSMEAR_RANGauss_FILTER[ifilt_local] ; 
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,
+	  "\t Generate Redshift : %6.3f to %6.3f  using  %s \n"
+	  ,INPUTS.GENRANGE_REDSHIFT[0]
+	  ,INPUTS.GENRANGE_REDSHIFT[1] 
+	  ,ctmp	  );
 
-  // now get filter-dependent smearing
-  if ( INPUTS.NFILT_SMEAR > 0 ) 
-    { smearsig_fix = INPUTS.GENMAG_SMEAR_FILTER[ifilt_local]; }
 
+  if ( INPUTS.GENBIAS_REDSHIFT != 0.0 ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t Generate redshift bias : %f \n", 
+	    INPUTS.GENBIAS_REDSHIFT );
+  }
 
-  // loop over epochs and apply same mag-smear 
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  if ( INPUTS.GENSIGMA_REDSHIFT >= 0.0 ) {
+    sprintf(cptr,"\t REDSHIFT_FINAL is ZCMB_GEN smeared by : %8.5f \n", 
+	    INPUTS.GENSIGMA_REDSHIFT);
+  }
+  else
+    { sprintf(cptr,"\t REDSHIFT_FINAL is host-photoZ \n"); }
 
-  for ( iep=1; iep <= NEPFILT; iep++ ) {
+  
+  if ( WRONGHOST.NLIST > 0.0 ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t WRONGHOST model frac: %.3f + %.3f*z + %.5f*z^2 \n"
+	    ,WRONGHOST.PROB_POLY[0]
+	    ,WRONGHOST.PROB_POLY[1]
+	    ,WRONGHOST.PROB_POLY[2]     );
+  }
 
-    smearsig_model = 0.0 ;
-    Tep   = *(ptr_epoch + iep - 1); // rest or obs.
-    Trest = Tep / Z1 ;  // Z1=1 (rest) or 1+z (obs)
-     
-    if ( USE_GENMODEL_ERRSCALE  ) 
-      { smearsig_model = genSmear_ERRSCALE(ptr_generr,iep, NEPFILT ); }
+  if ( INPUTS.VEL_CMBAPEX == 0.0 ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,
+	    "\t v(cmb)=0 -> REDSHIFT_HELIO=REDSHIFT_CMB (legacy option)\n");
+  }
 
-    // add two sources of smear in quadrature: FILTER and ERRSCALE
-    smearsig = sqrt( pow(smearsig_model,2.) + pow(smearsig_fix,2.) );      
-    magSmear = smearsig * ran_FILT ;  // apply filter-dependent random smear
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t Peculiar Velocity Gaussian sigma: %.1f km/sec\n", 
+	  INPUTS.GENSIGMA_VPEC );
 
 
-    // model-dependent smearing; note that get_genSmear returns
-    // a randomly generated magSmear rather than a sigma-smear.
-    // Also, this magSmear over-writes previous magSmear since 
-    // the two cannot both be set.
-    if ( USE_GENSMEAR_MODEL ) {
-      // convert mean lambda of filter in obs frame to rest frame
-      opt_frame = GENFRAME_OBS ;
-      get_filtlam__(&opt_frame, &ifilt_obs, 
-		    &lamavg4, &lamrms4, &lammin4, &lammax4 );
-      lamrest = (double)lamavg4 / ( 1.0 + z );   
-      get_genSmear(Trest, ONE,  &lamrest, &magSmear_model);
-      magSmear = magSmear_model ;
-    }
-   
-    
-    //* xxxxxxxxxxxxxxxx
-    if  ( fabs(Tep) < .01 && ifilt_obs == -2 ) {
-      printf("\t xxx ------------------------------------- \n");
-      printf("\t xxx ifllt[obs,rest] = %d %d   T=%5.2f  mag=%6.3f \n", 
-	     ifilt_obs, ifilt_rest, Tep, *(ptr_genmag+iep-1) );
-      printf("\t xxx magSmear=%7.4f  sig[model,fix]=%6.3f,%6.3f  rr=%6.3f \n",
-		magSmear, smearsig_model, smearsig_fix, ran_FILT );
-    }
-    // xxxxxxxxxxxxxx */
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t %s   ZP   offsets : ", INPUTS.GENFILTERS);
+  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
+    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
+    sprintf(ctmp,"%6.3f ", INPUTS.GENMAG_OFF_ZP[ifilt_obs] ); 
+    strcat(cptr,ctmp); 
+  }
+  strcat(cptr,"\n"); 
 
-    // insanity check:
-    if ( fabs(magSmear) > 30.0 ) {
 
-      printf("\n xxx smearsig(model,fix,tot) = %f , %f , %f \n", 
-	     smearsig_model, smearsig_fix, smearsig );
-      
-      sprintf(c1err,"magSmear = %f is for filt=%s T=%6.1f", 
-	      magSmear, cfilt, Tep );
-      sprintf(c2err,"magsig(model)=%4.1f  GaussRan=%5.3f  errscale=%4.2f", 
-	      smearsig, ran_FILT, INPUTS.GENMODEL_ERRSCALE );
-      errmsg(SEV_WARN, 0, fnam, c1err, c2err ); 
-    }
+  float magoff;
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t %s  MODEL offsets : ", INPUTS.GENFILTERS);
+  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
+    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
+    magoff = INPUTS.GENMAG_OFF_MODEL[ifilt_obs] + INPUTS.GENMAG_OFF_GLOBAL ;
+    sprintf(ctmp,"%6.3f ", magoff ); 
+    strcat(cptr,ctmp); 
+  }
+  strcat(cptr,"\n"); 
 
-    // Aug 15, 2009: clip mag-smear at +- 3 mag to avoid catastrophe
 
-    if ( magSmear < -3.0 ) { magSmear = -3.0 ; }
-    if ( magSmear > +3.0 ) { magSmear = +3.0 ; }
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t %s  exposure times: ", INPUTS.GENFILTERS);
+  xtprod = 1.0 ;
+  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
+    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
+    xt = INPUTS.EXPOSURE_TIME_FILTER[ifilt_obs] ;
+    xtprod *= xt ;
 
-    // check flag (negative smearsig) to interpolate smearing
-    if ( smearsig_fix < -1.0E-6 ) {
-      magSmear = genmodelSmear_interp(ifilt_obs,iep) ;
-    }
-    
-    ptr_genmag[iep-1]                     += magSmear ;
-    GENFILT.genmag8_smear[ifilt_obs][iep] += magSmear ;
+    if ( xt > 10.0 )   sprintf(ctmp,"%6.1f ", xt ); 
+    else               sprintf(ctmp,"%6.4f ", xt ); 
 
-  } // ep loop
+    strcat(cptr,ctmp); 
+  } // end if ifilt
+  strcat(cptr,"\n"); 
 
-  if ( istat_genSmear() > 0 ) 
-    { GENLC.MAGSMEAR_COH = MAGSMEAR_COH ; } // see sntools_genSmear.c
+  // indicate which quantities were scaled by EXPOSURE_TIME  
+  // xxx mark delete May 2019  if ( fabsf(xtprod-1.0) > .001 ) {
+    if ( xtprod != 1.0 ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t %s  exposure MSKOPT=%d => ", 
+	    INPUTS.GENFILTERS, INPUTS.EXPOSURE_TIME_MSKOPT );
 
-  return ;
+    if ( INPUTS.EXPOSURE_TIME_MSKOPT  & (1 << 0) )
+      { strcat(cptr, "ZPT  "); }
+    if ( INPUTS.EXPOSURE_TIME_MSKOPT  & (1 << 1) )
+      { strcat(cptr, "SKYSIG  "); }
+    if ( INPUTS.EXPOSURE_TIME_MSKOPT  & (1 << 2) )
+      { strcat(cptr, "READNOISE  "); }
 
-} // end of genmodelSmear
+    strcat(cptr,"\n");
+  }
 
+  // - - - - - - -  -
+  // optional MJD_TEMPLAT (Sep 2017)
+  if ( INPUTS.USE_MJD_TEMPLATE ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t MJD_TEMPLATE: " );
+    
+    for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
+      ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
+      val       = INPUTS.MJD_TEMPLATE_FILTER[ifilt_obs] ;
+      if ( val > 1.0 ) {
+	sprintf(ctmp,"%6.1f(%c) ", val, FILTERSTRING[ifilt_obs] ); 
+	strcat(cptr,ctmp); 
+      }
+    } // end if ifilt
+    strcat(cptr,"\n"); 
+  }
 
-// ********************************
-double genSmear_ERRSCALE(double *ptr_generr, int iep, int NEPFILT ) {
+  // - - - - - - -
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t RA       : %6.2f to %6.2f  deg\n", 
+	  INPUTS.GENRANGE_RA[0], INPUTS.GENRANGE_RA[1] );
 
-  // April 2012 [code moved from genmodelSmear]
-  // Implement ERRSCALE model where intrinsic smear
-  // is based on the genmag model error.
-  // This model is really obsolete and is not recommended.
-  //
-  // ptr_generr is an array of fitter-model errors.
-  // 'iep' is the current epoch index.
+  // - - - -  PEAKMJD stuff - - - - - 
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t PEAKMJD  : %8.1f to %8.1f   \n", 
+	  INPUTS.GENRANGE_PEAKMJD[0], INPUTS.GENRANGE_PEAKMJD[1] );
 
-  double errtmp, smearsig_model, GENMODEL_ERRSCALE  ;
-  int iep_modelerr;
-  char fnam[] = "genSmear_ERRSCALE" ;
+  if ( INPUTS.GENSIGMA_PEAKMJD > 1.0E-9 ) {
+    sprintf(ctmp,"Gauss smear, sigma=%5.2f days", INPUTS.GENSIGMA_PEAKMJD);
+  }
+  else if ( (INPUTS.OPT_SETPKMJD & OPTMASK_SETPKMJD_FLUXMAX2)>0 ) {
+    sprintf(ctmp,"Fmax-clump, MJDWIN=%.1f, SNRCUT>%.1f(3.0)",
+	    INPUTS.MJDWIN_SETPKMJD, INPUTS.SNRCUT_SETPKMJD );
+  }
+  else if ( (INPUTS.OPT_SETPKMJD & OPTMASK_SETPKMJD_FLUXMAX)>0 ) {
+    sprintf(ctmp,"naive max flux.");
+  }
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t PEAKMJD-estimate  : %s\n", ctmp);
 
-  // ----------- BEGIN ----------
+  // - - - - - - - - - 
 
-  iep_modelerr = -9 ;
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t Trest    : %8.2f to %8.2f  days \n", 
+	  INPUTS.GENRANGE_TREST[0], INPUTS.GENRANGE_TREST[1] );
 
-  if ( INPUTS.GENMODEL_ERRSCALE_OPT == 1 )       
-    { iep_modelerr = NEPFILT ; }  // use peak model error at all epochs
-  else if ( INPUTS.GENMODEL_ERRSCALE_OPT == 2 )
-    { iep_modelerr = iep ; } // use epoch-dependent model error    
-  else {
-    sprintf(c1err,"Invalid  GENMODEL_ERRSCALE_OPT = %d",
-	    INPUTS.GENMODEL_ERRSCALE_OPT  );
-    errmsg(SEV_FATAL, 0, fnam, c1err, ""); 
+  
+  if ( INPUTS.TGRIDSTEP_MODEL_INTERP > 0.0 ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t TGRIDSTEP  : %.1f days (for model-mag interp) \n",
+	    INPUTS.TGRIDSTEP_MODEL_INTERP );
   }
 
-  // make a few sanity checks
-
-  if ( iep_modelerr <= 0 || iep_modelerr > NEPFILT ) {
-    sprintf(c1err,"Insane iep_modelerr = %d", iep_modelerr);
-    sprintf(c2err,"at iep=%d ", iep );
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
-  }
-  
-  GENMODEL_ERRSCALE  = (double)INPUTS.GENMODEL_ERRSCALE; 
-  errtmp             = *(ptr_generr + iep_modelerr - 1 ); // model error
-  smearsig_model     = errtmp * GENMODEL_ERRSCALE ;
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t RISETIME-SHIFT(days) SIGMA(lo,hi) : %3.1f , %3.1f  (Mean= %3.1f) \n"
+	  ,INPUTS.GENGAUSS_RISETIME_SHIFT.SIGMA[0]
+	  ,INPUTS.GENGAUSS_RISETIME_SHIFT.SIGMA[1] 
+	  ,INPUTS.GENGAUSS_RISETIME_SHIFT.PEAK
+	  );
 
-  return smearsig_model ; 
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t FALLTIME-SHIFT(days) SIGMA(lo,hi) : %3.1f , %3.1f  (Mean= %3.1f) \n"
+	  ,INPUTS.GENGAUSS_FALLTIME_SHIFT.SIGMA[0]
+	  ,INPUTS.GENGAUSS_FALLTIME_SHIFT.SIGMA[1] 
+	  ,INPUTS.GENGAUSS_FALLTIME_SHIFT.PEAK
+	  );
 
-} // end of genSmear_ERRSCALE
- 
-// ****************************************************
-double  genmodelSmear_interp(int ifilt_interp, int iep) {
+  // print shape-par info for all models except SIMSED
+  if ( INPUTS.NPAR_SIMSED == 0  ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(ctmp,"\t Shape-par(%s)", GENLC.SHAPEPAR_NAME );
+    sprintf_GENGAUSS(cptr, ctmp, &INPUTS.GENGAUSS_SHAPEPAR);
 
-  // Created Feb 3, 2012 by R.Kessler
-  // interpolate smearing for this observer-frame ifilt_interp.
-  // 'iep' is the epoch index.
-  // Interpolate with filters that have closest wavelength.
-  //
-  // Initial use is for SNACC teeth since the nominal
-  // filter mags must already be set.
+  }
 
-  int ifilt, ifilt_obs,  ifilt1_obs, ifilt2_obs ;
+  // SIMSED parameters
+  readme_doc_SIMSED(&i);
 
-  double 
-    smear 
-    ,LAM_INTERP
-    ,LAM, LAM1, LAM2, LAMDIF, LAMDIF_MIN
-    ,SMEAR1, SMEAR2
-    ;
+  // ---- SALT2 params
+  readme_doc_SALT2params(&i);
 
-  char fnam[] = "genmodelSmear_interp" ;
+  // ---- FIXMAG params
+  readme_doc_FIXMAG(&i);
 
-  // -------------- BEGIN --------------
 
-  LAM_INTERP = (double)INPUTS.LAMAVG_OBS[ifilt_interp] ;
+  // --------------------------------
+  // dump host extinction params
 
+  readme_doc_hostxt(&i);
 
-  ifilt1_obs = ifilt2_obs = -9;
 
-  // get closest filter
-  LAMDIF_MIN = 99999999. ;
-  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
-    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
+  // ====================================
+  // Z-dependent parameters (if requested)
 
-    // only include filters with positive smear
-    if ( INPUTS.GENMAG_SMEAR_FILTER[ifilt_obs] < 0.000001 ) { continue ; }
+  if ( NPAR_ZVAR_USR > 0 ) {
+    
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr, "\n  Z-dependent SN-parameter shifts: \n");
 
-    LAM       = INPUTS.LAMAVG_OBS[ifilt_obs] ;
-    LAMDIF    = fabs(LAM - LAM_INTERP) ;
-    if ( LAMDIF < LAMDIF_MIN ) { 
-      LAMDIF_MIN = LAMDIF ; 
-      ifilt1_obs = ifilt_obs ; 
-    }
-  }     // ifilt
+    for ( ipar=0; ipar < NPAR_ZVAR_USR; ipar++ ) {
+      sprintf(ctmp,"%s", INPUT_ZVARIATION[ipar].PARNAME );
+      ZMIN = INPUTS.GENRANGE_REDSHIFT[0] ; 
+      ZMAX = INPUTS.GENRANGE_REDSHIFT[1] ; 
+      shift[0] = get_zvariation(ZMIN,ctmp) ;
+      shift[1] = get_zvariation(ZMAX,ctmp) ;
 
+      i++; cptr = VERSION_INFO.README_DOC[i] ;
+      sprintf(cptr," %20s-shift = %6.3f(ZMIN=%5.3f), %6.3f(ZMAX=%5.3f) \n",
+	      ctmp, shift[0],ZMIN, shift[1], ZMAX );
+    }  // end of NPAR_ZVAR_USR loop
+  } else {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr, "\n  Z-dependent SN-parameter shifts:  None. \n");
+  }
 
-  // get 2nd closest filter
-  LAMDIF_MIN = 99999999. ;
-  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
-    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
-    if ( ifilt_obs == ifilt1_obs ) { continue ; }
 
-    // only include filters with positive smear
-    if ( INPUTS.GENMAG_SMEAR_FILTER[ifilt_obs] < .0000001 ) { continue ; }
+  // ===========================================
 
-    LAM       = INPUTS.LAMAVG_OBS[ifilt_obs] ;
-    LAMDIF    = fabs(LAM - LAM_INTERP) ;
-    if ( LAMDIF < LAMDIF_MIN ) { 
-      LAMDIF_MIN = LAMDIF ; 
-      ifilt2_obs = ifilt_obs ; 
-    }
-  }     // ifilt
+  readme_doc_magSmear(&i);
 
+  readme_doc_nonLin(&i); // May 27 2016
 
-  // idiot check.
-  if ( ifilt2_obs < 1 ) {
-    sprintf(c1err,"Could not find nearest filters to %c (LAM=%6.1f)",
-	    FILTERSTRING[ifilt_interp], INPUTS.LAMAVG_OBS[ifilt_interp] );
-    sprintf(c2err,"ifilt1_obs=%d  ifilt2_obs=%d", 
-	    ifilt1_obs, ifilt2_obs);
-    errmsg( SEV_FATAL,0 , fnam, c1err, c2err);
-  }
+  // ============================================
+  // AVWARP-overflows vs. rest-frame filter
 
-  // interpolate
-  LAM1   = (double)INPUTS.LAMAVG_OBS[ifilt1_obs] ;
-  LAM2   = (double)INPUTS.LAMAVG_OBS[ifilt2_obs] ;
-  LAMDIF = (LAM_INTERP -  LAM1);
-  SMEAR1 = GENFILT.genmag8_smear[ifilt1_obs][iep] ;  
-  SMEAR2 = GENFILT.genmag8_smear[ifilt2_obs][iep] ;  
-  
-  smear = SMEAR1 + (SMEAR2-SMEAR1) * LAMDIF/(LAM2-LAM1);
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
 
-  if ( iep == -3 ) {
+  sprintf(ctmp, "\n  AVWARP_OVERFLOWS: ");
+  if ( NAVWARP_OVERFLOW[0] == 0 ) {
+    strcat(ctmp," NONE. ");
+    // xxx mark delete   sprintf(ctmp, "%s NONE. ", ctmp);
+  }
+  else {
     
-    printf(" xxx -------------------------------------------------- \n");
-    printf(" xxx LAMDA[%c,%c -> %c] =  %7.1f , %7.1f  -> %7.1f   \n"
-	   ,FILTERSTRING[ifilt1_obs]
-	   ,FILTERSTRING[ifilt2_obs]
-	   ,FILTERSTRING[ifilt_interp]
-	   ,LAM1, LAM2, LAM_INTERP );
-
-    printf(" xxx SMEAR[%c,%c -> %c] = %7.4f  , %7.4f  -> %7.4f \n" 
-	   ,FILTERSTRING[ifilt1_obs]
-	   ,FILTERSTRING[ifilt2_obs]
-	   ,FILTERSTRING[ifilt_interp]
-	   ,SMEAR1, SMEAR2, smear );
+    for ( ifilt=0; ifilt < GENLC.NFILTDEF_REST; ifilt++ ) {
+      ifilt_rest = GENLC.IFILTMAP_REST[ifilt] ;
+      sprintf(cfilt,"%c", FILTERSTRING[ifilt_rest] ); 
+      NOV = NAVWARP_OVERFLOW[ifilt_rest] ;
+      if ( NOV > 0 ) sprintf(ctmp, "%s %d(%s)", ctmp, NOV, cfilt);
+    } 
   }
+  strcat(ctmp,"\n");
+  // xxx mark delete  sprintf(ctmp,"%s\n", ctmp);
+  strcat(cptr,ctmp);
+  // xxx mark delete  sprintf(cptr,"%s", ctmp);
+  sprintf(WARNING_AVWARP_OVERFLOW,"\n  WARNING: %s", ctmp); 
 
+  readme_doc_TAKE_SPECTRUM(&i);
 
+  // ----- cosmology parameters
 
-  return smear ;
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\n  Cosmology Parameters: \n");
 
-}  // end of smearsig_interp
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t H0 = %6.2f km/s per MPc \n", INPUTS.H0 );
 
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t Omega_{M,L} = %5.2f, %5.2f   w = %5.2f  \n",
+	  INPUTS.OMEGA_MATTER, INPUTS.OMEGA_LAMBDA, INPUTS.W0_LAMBDA );
 
 
 
-// ==================================================
-void ZERO_COVMAT_SCATTER(void)
-{
-  //  Created July 2011 by R.Biswas 
-  //  April 12, 2012 (RK) init the Cholesky matrix too.
+  // ------ software Search efficiency
 
-  // ------------ BEGIN --------------
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\n --------------------------------------------------- \n");
 
-  /// Set INPUTS. covariance matrix to 0.  
-  INPUTS.NCOVMAT_SCATTER = 0;
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"  Software-Pipeline Search Efficiency (MINOBS=%d) from \n", 
+	  INPUTS_SEARCHEFF.MINOBS );
 
-  int i,j ;
-  for (i = 0 ; i < 3 ; i++ ){
-    for (j = 0 ; j < 3 ; j++ ){
-      INPUTS.COVMAT_SCATTER[i][j]          = 0. ;
-      INPUTS.COVMAT_SCATTER_SQRT[i][j]     = 0. ;
-      INPUTS.COVMAT_SCATTER_REDUCED[i][j]  = 0. ;
-      INPUTS.COVMAT_CHOLESKY_SCATTER[i][j] = 0.0 ; // RK
-      
-    }
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"%s", SEARCHEFF_DETECT[MXMAP_SEARCHEFF_DETECT].README[0] ) ;
+  for ( imap=0; imap < INPUTS_SEARCHEFF.NMAP_DETECT; imap++ ) {
+    NLINE = SEARCHEFF_DETECT[imap].NLINE_README ; 
+    for ( itmp = 1; itmp <= NLINE; itmp++ ) {
+      i++; cptr = VERSION_INFO.README_DOC[i] ;
+      sprintf(cptr,"%s", SEARCHEFF_DETECT[imap].README[itmp] ) ;
+    }    
   }
-}//End of ZERO_COVMAT_SCATTER
-
-void PARSE_COVMAT_SCATTER(char *CKEY , char *CVAL) 
-{
-  /// Created July 2011 by R.Biswas 
-  /// Parses a character array CKEY specifying the element of 
-  /// the covariance matrix and a character array CVAL 
-  /// having the associated value to assign the covariance matrix.
-
-  /// CKEY     (I) char string specifying COVMAT_SCATTER element 
-  ///			of the form COVMAT_SCATTER[0][0]:
-  ///			or COVMAT_SCATTER_SQRT[0][0]:
-  ///			or COVMAT_SCATTER_REDUCED[0][0]:
-  /// CVAL     (I) char string giving value of the the covariance
-  ///			matrix entry
 
-  char fname [100];
+  // print detection logic
+  NLINE = SEARCHEFF_DETECT[MXMAP_SEARCHEFF_DETECT].NLINE_README ; 
+  for ( itmp = 1; itmp <= NLINE; itmp++ ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"%s", SEARCHEFF_DETECT[MXMAP_SEARCHEFF_DETECT].README[itmp] ) ;
+  }    
   
-  // --------------- BEGIN -----------------
 
-  strcpy(fname,"PARSE_COVMAT_SCATTER");
+  // ------ Spec Search efficiency
 
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"%s", "\n  Spectroscopic Efficiency : \n" );
+  for ( iopt=1; iopt <= SEARCHEFF_SPEC_INFO.NLINE_README; iopt++ ) {
+      i++; cptr = VERSION_INFO.README_DOC[i] ;
+      sprintf(cptr, "%s \n", SEARCHEFF_SPEC_INFO.README[iopt] ) ;    
+  }
+  
 
-  //convert the char value into a double
-  double cvalcont;
-  cvalcont = atof(CVAL);	
+  if ( INPUTS_SEARCHEFF.NMAP_zHOST ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"%s", "\n  Unconfirmed zHOST Efficiency map from \n" );
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t %s \n", INPUTS_SEARCHEFF.zHOST_FILE );
+  }
+  else {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"%s", "\n  Unconfirmed zHOST Efficiency : 100% \n" );
+  }
+  
 
 
-  char covmatentries[1000];
+  // write APPLY-mask
+  OVP1 = (INPUTS.APPLY_SEARCHEFF_OPT & 1);
+  OVP2 = (INPUTS.APPLY_SEARCHEFF_OPT & 2);
+  OVP3 = (INPUTS.APPLY_SEARCHEFF_OPT & 4);
 
-  int m , n ; 		
-  //PARSE routine looks for something like 
-  //COVMAT_SCATTER[m][n] only
-			
-  strcpy(covmatentries,"COVMAT_SCATTER[0][0]:");
-  int lencovmat= strlen(covmatentries);
-  lencovmat = lencovmat+1;
+  if ( OVP1 && OVP2 ) 
+    { sprintf(ctmp,"%s", "Apply both PIPELINE+SPEC efficiencies"); }
+  else if ( OVP1 && OVP2 == 0 ) 
+    { sprintf(ctmp,"%s", "Apply only PIPELINE efficiency (not SPEC-eff)"); }
+  else if ( OVP1 == 0 && OVP2 ) 
+    { sprintf(ctmp,"%s", "Apply only SPEC efficiency (not PIPELINE-eff)"); }
+  else if ( OVP1 == 0 && OVP2 == 0 ) 
+    { sprintf(ctmp,"%s", "Do NOT Apply trigger efficiency "); }
+      
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\n  APPLY_SEARCHEFF_OPT:  %d => %s \n", 
+	  INPUTS.APPLY_SEARCHEFF_OPT, ctmp);
 
-  for ( m = 0 ; m < 3 ; m++ ){
-    for ( n = 0 ; n < 3 ; n++ ){ 
-      sprintf(covmatentries,"COVMAT_SCATTER[%d][%d]:", m ,n );
-      if (0==strncmp(covmatentries,CKEY,lencovmat)){
-	INPUTS.COVMAT_SCATTER[m][n]= cvalcont;
-	INPUTS.NCOVMAT_SCATTER++ ;
-	return;
-      }
-    }
+  // print SNTYPE values for SPEC and PHOT Ia-subsets 
+  // For NONIA there is only one type specified with the NONIA keys.
+  if ( LGEN_SNIA ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"  SNTYPE(Ia) = %d(SPEC)  and %d(PHOT) \n", 
+	    INPUTS.SNTYPE_Ia_SPEC, INPUTS.SNTYPE_Ia_PHOT);    
   }
-  
-  //PARSE routine looks for something like 
-  //COVMAT_SCATTER_SQRT[m][n] only
 
-  strcpy(covmatentries , "COVMAT_SCATTER_SQRT[0][0]:");
-  lencovmat= strlen(covmatentries);
-  lencovmat = lencovmat+1;
-  
-  for ( m = 0 ; m < 3 ; m++ ){
-    for ( n = 0 ; n < 3 ; n++ ){ 
-      sprintf(covmatentries,"COVMAT_SCATTER_SQRT[%d][%d]:", m ,n );
-      if (0==strncmp(covmatentries,CKEY,lencovmat)){
-	//code to abort if one enters COVMAT_SCATTER_SQRT
-	//elements that are off diagonal
-	if (n != m) {
-	  sprintf(c1err,
-		  " off-diagonal COVMAT_SCATTER_SQRT entered: %d %d", m , n );
-	  errmsg( SEV_FATAL,0 , fname, c1err, c2err);
-	}
-	INPUTS.COVMAT_SCATTER_SQRT[m][n]= cvalcont;
-	INPUTS.NCOVMAT_SCATTER++ ;
-	return;
-      }
-    }
-  }
 
-  //Code to parse off diagonal reduced scatter 
-  //terms
-  for ( m = 0 ; m < 3 ; m++ ){
-    for ( n = 0 ; n < 3 ; n++ ){ 
-      sprintf(covmatentries,"COVMAT_SCATTER_REDUCED[%d][%d]:", m ,n );
-      if (0==strncmp(covmatentries,CKEY,lencovmat)){
-	//code to abort if one enters COVMAT_SCATTER_SQRT
-	//elements that are off diagonal
-	if (n == m) {
-	  sprintf(c1err,
-		  " diagonal COVMAT_SCATTER_REDUCED entered: %d %d", m , n );
-	  errmsg( SEV_FATAL,0 , fname, c1err, c2err);
-	}
-	INPUTS.COVMAT_SCATTER_REDUCED[m][n]= cvalcont;
-	INPUTS.NCOVMAT_SCATTER++ ;
-	return;
-      }
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr," --------------------------------------------------- \n");
+
+
+  // ------ software cuts -----------
+  if ( INPUTS.APPLY_CUTWIN_OPT  ) {  readme_doc_CUTWIN(&i) ; }
+
+
+  // ---- HOST-GALAXY 
+
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\n  HOSTLIB Summary: " );
+
+  if ( INPUTS.HOSTLIB_USE == 0 ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"None. \n" );
+  }
+  else {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\n" );
+    NLINE = HOSTLIB.NLINE_COMMENT ;
+    for ( itmp=1; itmp <= NLINE; itmp++ ) {
+      i++; cptr = VERSION_INFO.README_DOC[i] ;
+      sprintf(cptr,"\t %s \n", HOSTLIB.COMMENT[itmp] );
     }
   }
-  // If nothing found return
-  return;
- }//END OF PARSE_COVMAT_SCATTER
 
-// =======================================
-void INIT_COVMAT_SCATTER( void )
-{
-  // Created July 2011 by R.Biswas
-  // todo: 
-  // - use c1err and c2err instead of errormsg and c2err (done)
-  // - move comments from PARSE_COVMAT to here; 
-  // - fill GENLC.COVMAT_SCATTER_README with cov matrix text string
-  // - print the above
-  //
 
-  char fname[28] = "INIT_COVMAT_SCATTER" ;
-  int m, n, LDMP, i,j ;
-  double epsilon = 0.00000000001; //tolerance level for differences
-  double xsig, xred, xx;
+  // -----  FUDGES on observing conditions ------
+  readme_doc_FUDGES(&i);
 
-  // ----------------- BEGIN --------------------
+  // ======================================
+  VERSION_INFO.NLINE_README_INIT = i;   // can dump to here after init
+  if ( iflag_readme == 1 ) return ;
+  // ======================================
 
-  if ( INPUTS.NCOVMAT_SCATTER <= 0 ) { return ; }
+ AFTERSIM:
+  i = VERSION_INFO.NLINE_README_INIT ;
 
-  print_banner("INIT_COVMAT_SCATTER:");
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\n ============ END OF SIMULATION SUMMARY ============== \n");
 
-  LDMP = 1;
+  // ---- random seed and first/last random
 
-  // asign name to each scatter element based on model
-  if ( INDEX_GENMODEL == MODEL_SALT2 ) {
-    sprintf(GENLC.COVMAT_SCATTER_NAME[0],"%s", "mb" );
-    sprintf(GENLC.COVMAT_SCATTER_NAME[1],"%s", "x1" );
-    sprintf(GENLC.COVMAT_SCATTER_NAME[2],"%s", "c"  );
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\n  Random Number Sync: \n");
+
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t RANDOM SEED: %d   (RANLIST_START_GENSMEAR: %d)\n", 
+	  INPUTS.ISEED, INPUTS.RANLIST_START_GENSMEAR );
+
+  if ( INPUTS.RANDOM_COUNTER ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t RANDOM_COUNTER: randoms keyed by (SEED,ilc,NTRY)\n");
   }
-  else {
-    sprintf(c1err,"COVMAT_SCATTER not defined for GENMODEL=%s",
-	    INPUTS.MODELNAME );
-    sprintf(c2err,"%s", "Remove COVMAT_SCATTER* keys");
-    errmsg( SEV_FATAL,0 , fname, c1err, c2err);
+
+
+  int ilist;
+  for ( ilist=1; ilist <= NLIST_RAN; ilist++ ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t FIRST/LAST Random Number (List=%d): %f %f  \n", 
+	    ilist, RANFIRST[ilist], RANLAST[ilist] );
   }
 
+  // ---- statistics
+
+  double t_tot   = (t_end-t_start) ; // total proc time, sec
+  double R_gen   = (double)NGENLC_TOT / t_tot ;  // NGEN/sec
+  double R_write = (double)NGENLC_WRITE/t_tot ;  // NWRITE/sec
 
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\n  Generation Statistics (total CPU=%.1f minutes): \n", 
+	  t_tot/60.);
 
-  //Abort if the same element of covmat
-  //has been entered twice
-  strcpy(c1err," Same element of covariance matrix entered twice");
-  //char comb[10];
-  for (m =0; m<3; m++){
-    for (n=0; n<3;n++){
-      sprintf(c2err, 
-	      "INPUTS.COVMAT_SCATTER[%d][%d]", m , n);
-      float t1 = fabs(INPUTS.COVMAT_SCATTER[m][n]);
-      float t2 = fabs(INPUTS.COVMAT_SCATTER_SQRT[m][n]);
-      float t3 = fabs(INPUTS.COVMAT_SCATTER_REDUCED[m][n]);
-      if( (t1>0) && (t2>0)  )
-	{ errmsg( SEV_FATAL,0 , fname, c1err, c2err); }
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t Generated %5d simulated light curves "
+	  "(%.f/sec) \n",  NGENLC_TOT, R_gen );
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t Wrote     %5d simulated light curves to SNDATA files "
+	  "(%.f/sec). \n",  NGENLC_WRITE, R_write );
 
-      if ( (t1>0) && (t3>0)  ) 
-	{ errmsg( SEV_FATAL,0 , fname, c1err, c2err ); }
-    }
+  if ( NGENSPEC_WRITE > 0 ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t Wrote     %5d simulated spectra to SNDATA files \n",
+	    NGENSPEC_WRITE );
   }
-  
 
-  //If INPUTS.COVMAT_SCATTER are negative abort
-  strcpy(c1err," diagonal entries of covariance matrix negative");
-  for (m = 0 ; m < 3 ; m++){
-    sprintf(c2err, "INPUTS.COVMAT_SCATTER[%d][%d]", m , m);
-    if (INPUTS.COVMAT_SCATTER[m][m] < -epsilon ) 
-      { errmsg( SEV_FATAL,0 , fname, c1err , c2err); }
-  }
+  // spectroscopic tags
 
-  //If values are given in terms of sqrt or reduced
-  //scatter, convert to covmat_scatter
-  for (m = 0 ; m < 3 ; m++){
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"  Spectroscopic-type: %d -> %d (before -> after cuts)\n",
+	  GENLC.NTYPE_SPEC, GENLC.NTYPE_SPEC_CUTS);
+  
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"  Photometric-type:   %d -> %d (before -> after cuts)\n",
+	  GENLC.NTYPE_PHOT, GENLC.NTYPE_PHOT_CUTS);
 
-    if (INPUTS.COVMAT_SCATTER_SQRT[m][m] > epsilon ){
-      xsig = INPUTS.COVMAT_SCATTER_SQRT[m][m]; // sqrt(DIAG) = sigma
-      INPUTS.COVMAT_SCATTER[m][m] = xsig * xsig;
 
-      if ( LDMP ) 
-	{ printf("\t Read SQRT[COV(%d,%d)] = %g \n",  m, m, xsig ); }
-      
-    }
+  if ( !IGNOREFILE(INPUTS.WRONGHOST_FILE) ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    double frac = 0.0 ;
+    int N0      = NGENLC_WRITE ;
+    int N1      = GENLC.NTYPE_PHOT_WRONGHOST ;
+    if ( GENLC.NTYPE_PHOT_CUTS > 0 ) { frac = (double)N1 / (double)N0 ; }
+    sprintf(cptr,"  Wrong-host fraction: %d/%d = %.4f\n", N1,N0,frac);
   }
 
+  // ----------------
 
-  //If values are given in terms of a reduced 
-  //covariance matrix, convert to covmat_scatter
-  for (m = 0; m < 3 ; m++){
-    for (n = 0; n <3; n++){
-      if (m == n) continue;
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"  Rejection Statistics: \n");
 
-      xred = INPUTS.COVMAT_SCATTER_REDUCED[m][n] ;
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t %5d rejected by NEPOCH<%d \n",
+	  NGEN_REJECT.NEPOCH, (int)INPUTS.CUTWIN_NEPOCH[0] ) ;
 
-      if (fabs(xred) > epsilon) {
-	xx = INPUTS.COVMAT_SCATTER[m][m] * INPUTS.COVMAT_SCATTER[n][n] ;
-	INPUTS.COVMAT_SCATTER[m][n] = xred * sqrt(xx);
 
-	if ( LDMP ) 
-	  { printf("\t Read RHO(%d,%d) = %g\n", m, n, xred ); }
-      }
+  double MAGMIN = INPUTS.GENRANGE_PEAKMAG[0];
+  double MAGMAX = INPUTS.GENRANGE_PEAKMAG[1];
+  if ( MAGMIN > 0.0 && MAGMAX < 9999. ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t %5d rejected by GENRANGE_PEAKMAG(%.1f to %.1f) \n",  
+	    NGEN_REJECT.GENMAG, MAGMIN, MAGMAX );
+  }
 
-    }  // n
-  }  // m
-	
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t %5d rejected by GENRANGEs \n",  
+	  NGEN_REJECT.GENRANGE );
 
-  // Test that intrinsic matrix is symmetric in case both 
-  // off-diagonal elements have been provided.
+  if ( GENPAR_SELECT.NSTORE > 0 ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t %5d rejected by GENPAR_SELECT_FILE \n",  
+	    NGEN_REJECT.GENPAR_SELECT_FILE );
+  }
 
-  strcpy(c1err,"Symmetric off-diagonal entries entered and different for ");
-  double diff ;
-  int    Ldiff, Lmn, Lnm ;
-  //	int mm, nn ;
-  for (m = 0; m < 3 ; m++){
-    for (n = 0;  n < 3 ; n++){
-      sprintf(c2err, "INPUTS.COVMAT_SCATTER[%d][%d]", m , n);
-      if (n <= m) continue;
-      diff =  fabs(INPUTS.COVMAT_SCATTER[m][n] - 
-	           INPUTS.COVMAT_SCATTER[n][m]);
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t %5d rejected by SEARCH-TRIGGER \n",  
+	  NGEN_REJECT.SEARCHEFF );
 
-      Ldiff = diff > epsilon ;
-      Lmn   = fabs(INPUTS.COVMAT_SCATTER[m][n]) > epsilon ;
-      Lnm   = fabs(INPUTS.COVMAT_SCATTER[n][m]) > epsilon ;
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t %5d rejected by CUTWIN-SELECTION \n",  
+	  NGEN_REJECT.CUTWIN );
 
-      if ( Ldiff && Lmn && Lnm ) 
-	{  errmsg( SEV_FATAL,0 , fname, c1err, c2err);  }
+  // ---
 
-    }
-  }    	
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"  SEARCH+CUTS Efficiency: %7.4f +- %7.4f \n", 
+	  GENLC.GENEFF, GENLC.GENEFFERR);
 
+  // Oct 2026: one-line summary of counters, parsed by 
+  //   util/merge_simShards.py to combine --shard jobs.
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"  SIMSTATS: NGEN=%d NWRITE=%d NSPEC=%d "
+	  "NREJ_NEPOCH=%d NREJ_GENRANGE=%d NREJ_GENMAG=%d "
+	  "NREJ_SEARCH=%d NREJ_CUTWIN=%d \n",
+	  NGENLC_TOT, NGENLC_WRITE, NGENSPEC_WRITE,
+	  NGEN_REJECT.NEPOCH, NGEN_REJECT.GENRANGE, NGEN_REJECT.GENMAG,
+	  NGEN_REJECT.SEARCHEFF, NGEN_REJECT.CUTWIN );
 
+  // give warning if generation stops early
+  if ( GENLC.STOPGEN_FLAG == 1  ) {
 
-  //If only one of the asymmetric off-diagonal element
-  //entered, put in the remaining terms.
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\n  WARNING: GENERATION STOPPED WHEN ERROR\n");
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t   on ERR(EFF) <= EFFERR_STOPGEN(=%f)\n",  
+	    INPUTS.EFFERR_STOPGEN );
 
-  if(fabs(INPUTS.COVMAT_SCATTER[0][1])>epsilon){
-    INPUTS.COVMAT_SCATTER[1][0] = INPUTS.COVMAT_SCATTER[0][1];
-  } else {
-    INPUTS.COVMAT_SCATTER[1][0] = INPUTS.COVMAT_SCATTER[1][0];
-  }
-  
-  if (fabs(INPUTS.COVMAT_SCATTER[2][0])>epsilon){
-    INPUTS.COVMAT_SCATTER[0][2] = INPUTS.COVMAT_SCATTER[2][0];
-  } else {
-    INPUTS.COVMAT_SCATTER[2][0] = INPUTS.COVMAT_SCATTER[0][2];
-  }	
-  if (fabs(INPUTS.COVMAT_SCATTER[2][1])>epsilon){
-    INPUTS.COVMAT_SCATTER[1][2] = INPUTS.COVMAT_SCATTER[2][1];
-  }else {
-    INPUTS.COVMAT_SCATTER[2][1] = INPUTS.COVMAT_SCATTER[1][2];
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t  => YOU HAVE %d FEWER LIGHT CURVES THAN REQUESTED\n",
+	    INPUTS.NGEN_LC - NGENLC_WRITE );
   }
 
-  //Have INPUTS.COVMAT_SCATTER completely. 
 
-  //Check that submatrices have non-singular dets
-  strcpy(c1err,"Submatrices are not positive definite for the combination ");
+  // give SN-stats with cuts
+  XN   = (INPUTS.RATEPAR.SEASON_COUNT  + INPUTS.RATEPAR_PEC1A.SEASON_COUNT) ;
+  XN  *= GENLC.GENEFF ; // multiply by cut-efficiency
+  if ( NGENLC_WRITE > 0 ) 
+    { XNERR = XN/sqrt((double)NGENLC_WRITE); }
+  else
+    { XNERR = 0.0 ; }
 
-  for (m =0; m < 3 ; m++){
-    n = m + 1; 
-    
-    if (3 == n ) {n = 0;}
-    
-    diff = (INPUTS.COVMAT_SCATTER[m][m]*
-	    INPUTS.COVMAT_SCATTER[n][n]) - 
-      (INPUTS.COVMAT_SCATTER[m][n]*
-       INPUTS.COVMAT_SCATTER[m][n]);
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\n  Number of SNe per season AFTER CUTS : %6.0f +- %5.0f \n", 
+	  XN, XNERR );
 
-    sprintf(c2err, "%d\t%d", m , n);
-    
-    if (diff < 0) {
-      printf("PRE-ABORT DUMP \n\t %d \t %d \t %g\n", m, n , diff);
-      errmsg( SEV_FATAL,0 , fname, c1err, c2err);
-    }
-  }
 
-  int N = -1;
-  char *cptr ;
-  N++ ; cptr = GENLC.COVMAT_SCATTER_README[N] ;
-  sprintf(cptr,"%s", "\t Cov matrix:");
+  // NON1ASED
+  if ( INPUTS.NON1ASED.NINDEX > 0 ) { readme_doc_NON1ASED(&i); }
 
 
-  N++ ; cptr = GENLC.COVMAT_SCATTER_README[N] ;
-  sprintf(cptr,"\t\t %8s(%d) %8s(%d) %8s(%d) "
-	  ,GENLC.COVMAT_SCATTER_NAME[0], 0
-	  ,GENLC.COVMAT_SCATTER_NAME[1], 1
-	  ,GENLC.COVMAT_SCATTER_NAME[2], 2 );
+  // end marker
 
-  N++ ; cptr = GENLC.COVMAT_SCATTER_README[N] ;
-  sprintf(cptr,"%s", "\t -----------------------------------------------");
-  
-  
-  for (m = 0 ; m < 3 ; m++){
-    N++ ; cptr = GENLC.COVMAT_SCATTER_README[N] ;
-    sprintf(cptr,"\t %-4s(%d) :  %10.6f  %10.6f  %10.6f"
-	    ,GENLC.COVMAT_SCATTER_NAME[m], m
-	    ,INPUTS.COVMAT_SCATTER[m][0]
-	    ,INPUTS.COVMAT_SCATTER[m][1]
-	    ,INPUTS.COVMAT_SCATTER[m][2]  );
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\n\t ===== END OF README FILE ====== \n");
 
-  }
-  
-  N++ ; cptr = GENLC.COVMAT_SCATTER_README[N] ;
-  cptr[0] = 0 ;
-	
-  for ( i=0; i <= N; i++ ) {
-    printf("%s\n", GENLC.COVMAT_SCATTER_README[i] );
+  // ------
+  if ( i >= MXDOCLINE ) {
+    sprintf ( c1err, "%d README.DOC lines exceeds array bound of %d",
+	      i, MXDOCLINE );
+    sprintf ( c2err,"Increase parameter MXDOCLINE and re-make ");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
   }
 
-  //printvals();
-  //Do the Cholesky Decomposition once and for all
-  double a_data[] = { 
-    INPUTS.COVMAT_SCATTER[0][0],
-    INPUTS.COVMAT_SCATTER[0][1],
-    INPUTS.COVMAT_SCATTER[0][2],
-    INPUTS.COVMAT_SCATTER[1][0],
-    INPUTS.COVMAT_SCATTER[1][1],
-    INPUTS.COVMAT_SCATTER[1][2],
-    INPUTS.COVMAT_SCATTER[2][0],
-    INPUTS.COVMAT_SCATTER[2][1],
-    INPUTS.COVMAT_SCATTER[2][2]
-  };
+  VERSION_INFO.NLINE_README  = i;
 
-  gsl_matrix_view chk;  
 
-  chk  = gsl_matrix_view_array (a_data, 3, 3); 
-  gsl_linalg_cholesky_decomp ( &chk.matrix)  ;
-  
-  for (i =0; i<3; i++){
-    for (j = 0; j < 3 ; j++){      
-      if (i <= j ) { 
-	INPUTS.COVMAT_CHOLESKY_SCATTER[i][j] =  
-	  gsl_matrix_get(&chk.matrix,i,j); 
-      }
-      else {
-	INPUTS.COVMAT_CHOLESKY_SCATTER[i][j] = 0.0 ;
-      }
-    }
-    
-  }
-  //printvals();
+}  // end of readme_doc
+
+
+// ********************************************
+void readme_doc_CUTWIN(int *iline) {
   
+  int i, icut ;
+  char *cptr, ctmp[80] ;
+  // ---------- BEGIN ---------
 
-  return;	
-	
-} // END OF INIT_COVMAT_SCATTER
+  i = *iline ;
 
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\n  SOFTWARE CUTS: \n");
 
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t EPOCH CUT: %5.0f Lambda(rest) < %5.0f A \n",
+	  INPUTS.EPCUTWIN_LAMREST[0], INPUTS.EPCUTWIN_LAMREST[1] );
 
-// ========================================================
-int GEN_COVMAT_SCATTER ( double *randoms, double *SCATTER_VALUES  ) 
-{
-  // Created July 2011 by R.Biswas
-  // Ensure Initialization of scatter vector;
-  //
-  // *randoms        (I) : 3 gaussian random numbers
-  // *SCATTER_VALUES (O) : ..
-  //
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t EPOCH CUT: SNR >= %2.0f  \n",
+	  INPUTS.EPCUTWIN_SNRMIN[0] );
 
-  SCATTER_VALUES[0] = 0. ;
-  SCATTER_VALUES[1] = 0. ;
-  SCATTER_VALUES[2] = 0. ;
-  
-  if ( INPUTS.NCOVMAT_SCATTER <= 0 ) { return 0 ; }
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t TrestMIN < %5.1f  &&  TrestMAX > %4.1f days \n",
+	  INPUTS.CUTWIN_TRESTMIN[1], INPUTS.CUTWIN_TRESTMAX[0] );
 
-  //Draw 3 vector from a standard (uncorrelated multinormal distribution)
-  int i , j;
-  //double sigma =1.0;
-  double normalvector[3];
-  
-  //Form 3 vector of standard normal RV
-  for (i =0; i <3; i++ ){
-    normalvector[i] = randoms[i];    
-  }
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t Max TGAP(rest) <= %5.1f  days \n",
+	  INPUTS.CUTWIN_TGAPMAX[1] );
 
-  //Matrix Multiply
-  //scatter_values = ch^T normalvector
-  for (i = 0 ; i < 3 ; i++){
-    for (j = 0 ; j < 3 ; j++){
-      //transpose cholesky matrix
-      double tmp = INPUTS.COVMAT_CHOLESKY_SCATTER[j][i]; 
-      SCATTER_VALUES[i] += tmp * normalvector[j];      
-    }
-  }
-  return 0;
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t Max T0GAP(rest) <= %5.1f  days \n",
+	  INPUTS.CUTWIN_T0GAPMAX[1] );
 
-} //END OF GEN_COVMAT_SCATTER
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t NOBS(MJDDIF > %3.1f) >= %2d \n",
+	  INPUTS.CUTWIN_MJDDIF[0], INPUTS.CUTWIN_NOBSDIF[0] );
 
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t NEPOCH(SNR > %4.1f) >= %2.0f \n",
+	  INPUTS.CUTWIN_NEPOCH[1], INPUTS.CUTWIN_NEPOCH[0] ) ;
 
-// *******************************
-void INIT_FUDGE_SNRMAX(void) {
+  for ( icut=1; icut <= INPUTS.NCUTWIN_SNRMAX; icut++ ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t SNRMAX > %4.1f for %d of the '%s' filters "
+	    "(%5.1f < Trest < %5.1f) \n"
+	    , INPUTS.CUTWIN_SNRMAX[icut][0]
+	    , INPUTS.CUTWIN_SNRMAX_NFILT[icut]
+	    , INPUTS.CUTWIN_SNRMAX_FILTERS[icut]
+	    , INPUTS.CUTWIN_SNRMAX_TREST[icut][0]
+	    , INPUTS.CUTWIN_SNRMAX_TREST[icut][1]
+	    );
+  }
 
 
-  // Created May 2015 by R.Kessler
-  // Parse INPUTS.STRING_FUDGE_SNRMAX
-  
-  //  char fnam[] = "INIT_FUDGE_SNRMAX" ;
-  char *ptrStr, f1[2], strSNRMAX[20] ;
+  for ( icut=0; icut < INPUTS.NCUTWIN_SATURATE; icut++ ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t NOBS_SATURATE = %d to %d for each %s filter. \n"
+	    , INPUTS.CUTWIN_SATURATE_NOBS[icut][0]
+	    , INPUTS.CUTWIN_SATURATE_NOBS[icut][1]
+	    , INPUTS.CUTWIN_SATURATE_FILTERS[icut]	    );
+  }
+  for ( icut=0; icut < INPUTS.NCUTWIN_NOSATURATE; icut++ ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t NOBS_NOSATURATE = %d to %d for each %s filter. \n"
+	    , INPUTS.CUTWIN_NOSATURATE_NOBS[icut][0]
+	    , INPUTS.CUTWIN_NOSATURATE_NOBS[icut][1]
+	    , INPUTS.CUTWIN_NOSATURATE_FILTERS[icut]	    );
+  }
 
-  // -------------- BEGIN -------------
 
-  if ( INPUTS.OPT_FUDGE_SNRMAX == 0 ) { return ; }
+  if ( INPUTS.NVAR_SIMGEN_DUMP > 0 ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(ctmp,"\t SIMGEN_DUMP file includes" );
+    if ( INPUTS.APPLY_CUTWIN_OPT  == 1 ) 
+      { sprintf(cptr,"%s SNe passing software cuts. \n", ctmp ); }
+    else 
+      { sprintf(cptr,"%s ALL SNe; use CUTMASK for software cuts.\n", ctmp); }
+    
+  }
 
-  ptrStr = INPUTS.STRING_FUDGE_SNRMAX ;
-  if ( strstr(ptrStr,"=") != NULL ) {
-    sprintf(f1, "%c", ptrStr[0] ) ; // single-char band
-    sprintf(strSNRMAX, "%s", (ptrStr+2) );
-    INPUTS.IFILTOBS_FUDGE_SNRMAX = INTFILTER(f1);
+  if ( INPUTS.CUTWIN_PEAKMAG[1] < 998.0 ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t PEAKMAG(All bands) :  %.1f - %.1f\n", 
+	    INPUTS.CUTWIN_PEAKMAG_ALL[0], INPUTS.CUTWIN_PEAKMAG_ALL[1] ) ;
+  }
+
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t PEAKMAG(any filter) < %3.1f \n", 
+	  INPUTS.CUTWIN_PEAKMAG[1] ) ;
+  
+  for ( icut=1; icut <= INPUTS.NCUTWIN_PEAKMAG_BYFIELD; icut++ ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t PEAKMAG(%s): %.1f to %1.f \n", 
+	    INPUTS.CUTWIN_BYFIELDLIST[icut],
+	    INPUTS.CUTWIN_PEAKMAG_BYFIELD[icut][0],
+	    INPUTS.CUTWIN_PEAKMAG_BYFIELD[icut][1] );
   }
-  else {
-    sprintf(strSNRMAX, "%s", ptrStr );
+  
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t MWEBV <= %3.1f \n", INPUTS.CUTWIN_MWEBV[1] ) ;
+  
+  // optional cut on time above SNRMIN
+  if ( INPUTS.CUTWIN_EPOCHS_NFILT > 0 ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t Time < %.1f days for SNR(%s) > %.1f \n",
+	    INPUTS.CUTWIN_EPOCHS_TRANGE[1],
+	    INPUTS.CUTWIN_EPOCHS_FILTERS,
+	    INPUTS.CUTWIN_EPOCHS_SNRMIN );
   }
 
-  // read SNRMAX part of string into float
-  sscanf(strSNRMAX, "%f", &INPUTS.FUDGE_SNRMAX); 
+  // ------------
+  *iline  = i ;
+
+}  // end of readme_doc_CUTWIN
 
-} // end of INIT_FUDGE_SNRMAX
 
 // ********************************************
-void init_covar_mlcs2k2(void) {
+void  readme_doc_TAKE_SPECTRUM(int *iline) {
 
-  /*******
-   Initialize covariance matrix used to generate MLCS model.
-   First version (9/2006) assumes 100% correlation among epochs
-   within a bandpass, and zero correlation between bandpasses.
-   The correlation model may get more sophisticate later.
+  // Mar 14 2017: 
+  // write TAKE_SPECTRUM info to readme file.
+  //
+  // Mar 23 2019: use GENPOLY typedefs and write WARP info
 
-   Note that this uses "gencovar_mlcs2k2" to fetch pieces
-   of the real MLCS smatrix.
+  int N = NPEREVT_TAKE_SPECTRUM ;
+  int i, j , OPT_FRAME_EPOCH, OPT_TEXPOSE ;
+  float *ptrEP, *ptrLAM ;
+  char *cptr, Tname[20], name2[20], zpolyString[100], warpString[100] ;
+  GENPOLY_DEF *GENZPOLY_SNR, *GENZPOLY_TEXPOSE, *GENLAMPOLY_WARP; 
 
+  // ------- BEGIN -------
 
-  History
-  ~~~~~~~~
-  Dec 30, 2007:  fill GENLC.PEAKMAGERR_MODEL[ifilt] 
+  if ( N == 0 ) { return ; }
 
-  May 28,  2009:  don't write covFile because this is called
-                  before the [VERSION]/ subdir is created,
-                  and because nobody uses this COV file.
+  i = *iline ;
+  
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\n  TAKE_SPECTRUM: \n");
 
-  *******/
+  
+  for(j=0; j < N; j++ ) {
 
-  int 
-    NFILT, MINEP, MAXEP, NEP, NMAT
-    ,iep, ifilt,ifilt_rest, iep1, iep2, ifilt1, ifilt2
-    ;
+    ptrEP    = INPUTS.TAKE_SPECTRUM[j].EPOCH_RANGE; 
+    ptrLAM   = INPUTS.TAKE_SPECTRUM[j].SNR_LAMRANGE ;
 
-  double epoch8, sqerr8    ;
-  float MODELERR[MXFILTINDX][MXEPCOV] ;
-  float err1, err2, errtmp,T1 ;
-  char fnam[] = "init_covar_mlcs2k2" ;
+    GENZPOLY_SNR     = &INPUTS.TAKE_SPECTRUM[j].GENZPOLY_SNR ;
+    GENZPOLY_TEXPOSE = &INPUTS.TAKE_SPECTRUM[j].GENZPOLY_TEXPOSE ;
+    GENLAMPOLY_WARP  = &INPUTS.TAKE_SPECTRUM[j].GENLAMPOLY_WARP ;
 
-  // --------------- BEGIN ---------
+    OPT_FRAME_EPOCH = INPUTS.TAKE_SPECTRUM[j].OPT_FRAME_EPOCH ;
+    OPT_TEXPOSE = INPUTS.TAKE_SPECTRUM[j].OPT_TEXPOSE ;
+    Tname[0] = name2[0] = zpolyString[0] = warpString[0] = 0 ;
 
+    if ( OPT_FRAME_EPOCH == GENFRAME_REST ) 
+      { sprintf(Tname,"TREST"); }
+    else
+      { sprintf(Tname,"TOBS"); }
 
-  //  if ( INPUTS.GENMODEL_ERRSCALE <= 0.000001 ) return
+    if ( OPT_TEXPOSE == 1 )  { 
+      sprintf(name2, "TEXPOSE" ); 
+      sprintf(zpolyString,"%s", GENZPOLY_TEXPOSE->STRING) ;
+    }
+    else { 
+      // sprintf(name2, "SNR(%.0f:%.0f)", ptrLAM[0], ptrLAM[1] ) ; 
+      sprintf(name2, "SNR" );
+      sprintf(zpolyString,"%s", GENZPOLY_SNR->STRING) ;
+    }
 
-  NMAT = 1 ;      // size of covar matrix to fetch
-  MINEP = mlcs2k2_Tmin() ;
-  MAXEP = mlcs2k2_Tmax() ;
-  NEP   = MAXEP - MINEP + 1 ;
+    if ( GENLAMPOLY_WARP->ORDER > 0 ) 
+      { sprintf(warpString,"WARP:%s", GENLAMPOLY_WARP->STRING ); }
 
-  sprintf(BANNER,"Init covariance matrix for sim: %d to %d days.", 
-	  MINEP, MAXEP);
-  print_banner(BANNER);
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"    %s = %5.1f to %5.1f  "
+	    "  %s-zPOLY:%s  %s\n",
+	    Tname, ptrEP[0], ptrEP[1],
+	    name2, zpolyString, warpString );
 
-  if ( NEP >= MXEPCOV ) {
-    sprintf(c1err,"NEP = %d exceeds array bound (MXEPCOV=%d)", NEP, MXEPCOV);
-    errmsg(SEV_FATAL, 0, fnam, c1err, ""); 
-  }
 
+    /* xxx mark delete xxxx
+    sprintf(cptr,"    %s = %5.1f to %5.1f  "
+	    "  %s zPOLY: %s \n",
+	    Tname, ptrEP[0], ptrEP[1],
+	    name2, zpolyString );
+    xxxx */
 
+  } // end j loop over spectra
 
-  NFILT   = GENLC.NFILTDEF_REST; 
+  *iline = i;
+  return ;
 
-  if ( NFILT > MXFILT_COVAR ) {
-    sprintf(c1err,"NFILT=%d exceeds COVAR array bound MXFILT=%d", 
-	    NFILT, MXFILT_COVAR );
-    errmsg(SEV_FATAL, 0, fnam, c1err, ""); 
-  }
+} // end readme_doc_TAKE_SPECTRUM
 
-  for ( ifilt = 0 ; ifilt < NFILT ; ifilt++ ) {
 
-    ifilt_rest = GENLC.IFILTMAP_REST[ifilt];
+// ********************************************
+void readme_doc_FUDGES(int *iline) {
 
-    for ( iep = MINEP; iep <= MAXEP ; iep++ ) {
-      epoch8 = (double)iep ;
-      gencovar_mlcs2k2(NMAT, &ifilt, &epoch8, &sqerr8 );  // get sqerr8
-      errtmp  = (float)sqrt(sqerr8);
-      MODELERR[ifilt][iep-MINEP] = errtmp ;
+  // Created May 2014 (pulled from readme_doc)
+  
+  int i, NLINE_FUDGE, j ;
+  char *cptr ;
+  char fudgeLine[10][100] ;
 
-      T1 = (float)(iep);
-      
-      // store errors at peak for each filter.
-      if ( fabsf(T1) < 0.5 )
-	{ GENLC.PEAKMAGERR_MODEL[ifilt_rest] = errtmp ; }
+  // ------- BEGIN -------
+  i = *iline ;
 
+  NLINE_FUDGE = 0 ;
 
-    } // end of iep loop
-  }  // end of ifilt loop
+  // create local comment lines based on used fudges.
 
+  if ( INPUTS.FUDGESCALE_SKYNOISE != 1.0 ) {
+    cptr = fudgeLine[NLINE_FUDGE] ;
+    sprintf(cptr,"\t Fudge-scale for SIMLIB NOISE(SKY) : %5.2f ", 
+	  INPUTS.FUDGESCALE_SKYNOISE);
+    NLINE_FUDGE++ ;
+  }
 
-  // now construct full covar matrix using error at each epoch
+  if ( INPUTS.FUDGESCALE_READNOISE != 1.0 ) {
+    cptr = fudgeLine[NLINE_FUDGE] ;
+    sprintf(cptr,"\t Fudge-scale for SIMLIB NOISE(CCD-read) : %5.2f ", 
+	  INPUTS.FUDGESCALE_READNOISE);
+    NLINE_FUDGE++ ;
+  }
 
-  for ( ifilt1=0; ifilt1 < NFILT; ifilt1++ ) {
-    for ( iep1=0; iep1 < NEP; iep1++ ) {
-      for ( ifilt2=0; ifilt2 < NFILT; ifilt2++ ) {
-	for ( iep2=0; iep2 < NEP; iep2++ ) {
-   
-	  GENLC.COVAR[ifilt1][iep1][ifilt2][iep2] = 0.0 ;  // init to zero
+  if ( INPUTS.FUDGESCALE_PSF != 1.0 ) {
+    cptr = fudgeLine[NLINE_FUDGE] ;
+    sprintf(cptr,"\t Fudge-scale for SIMLIB PSF      : %5.2f ", 
+	  INPUTS.FUDGESCALE_PSF);
+    NLINE_FUDGE++ ;
+  }
 
-	  // set 100% correlation only within same passband
-	  if ( ifilt1 == ifilt2 ) {
-	    err1 = MODELERR[ifilt1][iep1] ;
-	    err2 = MODELERR[ifilt2][iep2] ;
-	    GENLC.COVAR[ifilt1][iep1][ifilt2][iep2] = err1 * err2 ;
-	  }
+  if ( INPUTS.FUDGESHIFT_ZPT != 0.0 ) {
+    cptr = fudgeLine[NLINE_FUDGE] ;
+    sprintf(cptr,"\t Fudge-shift for SIMLIB ZPT      : %5.2f ", 
+	  INPUTS.FUDGESHIFT_ZPT);
+    NLINE_FUDGE++ ;
+  }
 
-	}
-      }
-    }
+  if ( INPUTS.FUDGE_MAGERR != 0.0 ) {
+    cptr = fudgeLine[NLINE_FUDGE] ;
+    sprintf(cptr,"\t Fudge MAGERR (add in quad)      : %6.4f ", 
+	  INPUTS.FUDGE_MAGERR);
+    NLINE_FUDGE++ ;
+  }
+
+  if ( INPUTS.FUDGESCALE_FLUXERR != 1.0 ) {
+    cptr = fudgeLine[NLINE_FUDGE] ;
+    sprintf(cptr,"\t Fudge-scale for FLUX-ERROR      : %5.2f ", 
+	  INPUTS.FUDGESCALE_FLUXERR);
+    NLINE_FUDGE++ ;
   }
 
+  if ( INPUTS.OPT_FUDGE_SNRMAX == 1 ) {
+    cptr = fudgeLine[NLINE_FUDGE] ;
+    sprintf(cptr,"\t FUDGE_SNRMAX    : %s  (adjust exposure time)",  
+	    INPUTS.STRING_FUDGE_SNRMAX);
+    NLINE_FUDGE++ ;
+  }
 
-}  // end of init_covar_mlcs2k2
+  if ( INPUTS.OPT_FUDGE_SNRMAX == 2 ) {
+    cptr = fudgeLine[NLINE_FUDGE] ;
+    sprintf(cptr,"\t FUDGE_SNRMAX    : %s  (adjust sky noise)",  
+	    INPUTS.STRING_FUDGE_SNRMAX);
+    NLINE_FUDGE++ ;
+  }
 
+  // ----------------------
+  // make README comment based on whether any of the fudges are used.
 
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  if( NLINE_FUDGE == 0 ) 
+    {  sprintf(cptr,"\n  Fudges on SIMLIB Seeing Conditions: NONE. \n"); }
+  else
+    {  sprintf(cptr,"\n  Fudges on SIMLIB Seeing Conditions: \n"); }
 
-// *********************************************
-void readme_doc(int iflag_readme) {
 
-  // Created 2007 by R.Kessler
-  // fill VERSION_INFO.README_DOC structure with 
-  // "VERSION_INFO.NLINE_README" lines of README content.
-  // Note that the contents are printed from elsewhere
-  //
-  // iflag_readme = 1 => fill init-part
-  // iflag_readme = 2 => fill post-sim part
-  //
-  // Jul 24, 2009: re-write mag-smearing stuff, 
-  //               and include new GENMAG_SMEAR_FILTER
-  //
-  // Dec 20, 2009: print out SIMSED parameters and ranges
-  // Jul 01, 2010: print lambda-dependent mag smearing stuff
-  //
-  // Oct 29, 2010: print nonIa info for both non1a and NON1A;
-  //
-  // Mar 2011 : write FUDGE_SNRMAX, FUDGE2_SNRMAX if they are non-zero.
-  //
-  // Jul 19, 2011: clarify APPLY_SEARCHEFF_OPT
-  //
-  // Mar 14, 2012: write SMEAR_FUNPAR
-  //
-  // Jan 19 2016: remove redundant NON1A dump at beginning.
-  // Feb 01 2017: call readme_doc_NON1ASED
-  // Jan 16 2019: always print KCOR file (before, only printed for SNIA)
-  // May 27 2019: print PEAKMJD-estimate method
+  // print summary of USED fudges only.
+  for(j=0; j < NLINE_FUDGE; j++ ) {
+    i++ ; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr, "%s\n", fudgeLine[j]);
+  }
 
-  char ctmp[MXPATHLEN], cfilt[2], cwd[MXPATHLEN] ;
-  char *cptr;
-  char conoff[2][4] = { "OFF" , "ON" } ;
 
-  int i, j, j2, ifilt_obs, ifilt_rest, ifilt, itmp, imap, iopt, ipar ;
-  int NLINE, NOV, NON1A_non1a, OVP1, OVP2, OVP3 ;
+  *iline = i;
 
-  double XN, XNERR ;
-  float xt, xtprod, val, ZMIN, ZMAX, shift[2];
+  return ;
 
-  char  fnam[] = "readme_doc" ;
+} // end readme_doc_FUDGES
 
-  // ------------ BEGIN readme_doc() ---------------
 
-  i=0 ;
+// ********************************************
+void readme_doc_GENPERFECT(int *iline) {
 
-  print_banner ( " Fill comments for README doc-file" );
+  // April 2014
 
-  if ( iflag_readme == 2 ) goto AFTERSIM ;
+  int i, itmp ;
+  char *cptr, *PARNAME ;
+  double DPARVAL_ORIG, DPARVAL_USED ;
+  int    IPARVAL_ORIG, IPARVAL_USED ;
+  // --------- BEGIN ---------
 
-  //--- brief description
+  i = *iline ;
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr," USER COMMENT: %s \n\n", INPUTS.COMMENT);
+  if ( GENPERFECT.NVAR <= 0 ) { return ; }
 
   i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr," BRIEF_DESCRIPTION: simulate %s SNe with GENMODEL = %s \n", 
-	  INPUTS.GENSOURCE, INPUTS.MODELNAME );
+  sprintf(cptr,"\n PERFECT LIGHTCURVES REQUESTED: \n");
+  
+  for ( itmp=1; itmp <= GENPERFECT.NVAR; itmp++ ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    
+    PARNAME      = GENPERFECT.parnam[itmp] ;
+    DPARVAL_ORIG = GENPERFECT.parval[itmp][0] ;
+    DPARVAL_USED = GENPERFECT.parval[itmp][1] ;
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n");
+    if ( GENPERFECT.partype[itmp] == 1 ) {
+      IPARVAL_ORIG = (int)DPARVAL_ORIG ;
+      IPARVAL_USED = (int)DPARVAL_USED ;
+      sprintf(cptr,"\t %-28.28s : %d -> %d \n",
+	      PARNAME, IPARVAL_ORIG, IPARVAL_USED );
+    }
+    else {
+      sprintf(cptr,"\t %-28.28s : %.5f -> %.5f \n" ,
+	      PARNAME, DPARVAL_ORIG, DPARVAL_USED );
+    }
+  }
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"  HOST MACHINE: %s \n", getenv("HOST") );
+  *iline = i;
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf( cptr, "  USERNAME:  %s \n", getenv("USER") );
+}  // end of readme_doc_GENPERFECT
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"  SNDATA_ROOT:  %s \n", PATH_SNDATA_ROOT );
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"  SNANA_DIR:     %s \n", PATH_SNANA_DIR );
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"  SNANA_VERSION: %s \n", SNANA_VERSION_CURRENT );
+// ********************************************
+void readme_doc_NON1ASED(int *iline) {
 
-  // write current directory (Sep 5 2013)
-  if ( getcwd(cwd,MXPATHLEN) != NULL ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"  Current Dir:  %s \n", cwd );
-  }
+  // Created Feb 1 2017    [code moved out of readme_doc()]
+  //
+  // Print SEDs which have NGENTOT>0.
 
-  // -----------------------------
+  int i, j, NSKIP, isp, index, NINDEX ;
+  int NGENTOT, NGENWR, NGENUSR, CID0, CID1 ;
+  float eff;
+  char *cptr,  *ptrtype, ctmp[100], cline[200] ;
+  char fnam[] = "readme_doc_NON1ASED" ;
 
-  // indicate changes if "GENPERFECT" is requested.
-  readme_doc_GENPERFECT(&i);
+  // --------------- BEGIN --------------
 
-  // ---- full description
+  i = *iline ;
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n FULL_DESCRIPTION: \n" ); 
+  NINDEX = INPUTS.NON1ASED.NINDEX ;
 
-  readme_doc_SIMLIB(&i);
+  sprintf(cline,
+	  " ---------------------------------------------------"
+	  "-------------------------\n");
 
+  // summarize user inputs
   i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t Generation VERSION: %s \n", INPUTS.GENVERSION ); 
+  sprintf(cptr,"\n\n  NON1A USER INPUTS vs. INDEX: \n");
 
   i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t Generation source : %s \n", INPUTS.GENSOURCE ); 
+  sprintf(cptr," INDEX(TYPE) " );
+  for ( j = 2; j <= INPUTS.NON1ASED.NKEY; j++ )
+    { sprintf(cptr,"%s %8s", cptr, INPUTS.NON1ASED.KEYLIST[j] ); }
+  strcat(cptr,"\n");
 
   i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t Generation FILTERS: %s \n", INPUTS.GENFILTERS ); 
-
-  if ( GENFRAME_OPT == GENFRAME_REST ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t Rest-frame FILTERS: %s  for  model=%s\n", 
-	    GENLC.FILTLIST_REST, INPUTS.MODELNAME );
-
-  }
-  // ------------
-  // print info for skipped filters
+  sprintf(cptr,"%s", cline);
 
-  readme_doc_filterWarn(&i);
+  for ( isp=1; isp <= NINDEX; isp++ ) {
+    index   = INPUTS.NON1ASED.INDEX[isp];
+    ptrtype = GENLC.NON1ASED.TYPE[isp];
+    NGENTOT = GENLC.NON1ASED.NGENTOT[isp];
+    if ( NGENTOT == 0 ) { continue ; }
 
-  NON1A_non1a = ( INDEX_GENMODEL == MODEL_NON1ASED ) ;
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t KCOR lookup tables: %s \n", INPUTS.KCOR_FILE ); 
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr," %3.3d (%5s) ", index, ptrtype );
     
-
-  if ( GENFRAME_OPT == GENFRAME_REST ) {
+    for ( j = 2; j <= INPUTS.NON1ASED.NKEY; j++ )
+      { sprintf(cptr,"%s %8.3f", cptr, INPUTS.NON1ASED.KEYVAL[isp][j] ); }
+    
+    sprintf(cptr,"%s  %s\n", cptr,  INPUTS.NON1ASED.LIST_NAME[index] );
+  } // end isp loop
+  
+  // ----------------------------------------
+  // now summarize stats, effic, CID-range, peakmags ...
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\n  NON1A-SUMMARY vs. INDEX: \n");
+  
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"                  NGEN    NGEN   SEARCH   \n");
+  
     i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t KCOR lookup  time : Trest" );
-    if ( INPUTS.KCORFLAG_STRETCH == 1 ) strcat ( cptr, "/STRETCH" );
-    strcat ( cptr, "\n" );
+    sprintf(cptr," INDEX(TYPE)      written total  Effic    CID-range \n" );
 
     i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t AVwarp option for SED : color from " );
-    if ( INPUTS.KCORFLAG_COLOR == 1 ) 
-      { strcat ( cptr, "closest passbands \n" ); }
-    else if ( INPUTS.KCORFLAG_COLOR == 2 ) 
-      { strcat ( cptr, "Jha table \n" ); }
-    else
-      { strcat ( cptr, "UNKNOWN\n" ); }
-  }
+    sprintf(cptr,"%s", cline);
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  if ( INPUTS.SMEARFLAG_FLUX>0 ) { j=1; } else { j=0; }
-  sprintf(cptr, "\t Flux-smearing is %s \n", conoff[j] );
+    for ( isp=1; isp <= NINDEX; isp++ ) {
+      index     = INPUTS.NON1ASED.INDEX[isp];
+      NGENTOT   = GENLC.NON1ASED.NGENTOT[isp];
+      NGENWR    = GENLC.NON1ASED.NGENWR[isp];
+      NGENUSR   = INPUTS.NON1ASED.NGEN[isp];
+      ptrtype   = GENLC.NON1ASED.TYPE[isp];
+      CID0      = GENLC.NON1ASED.CIDRANGE[isp][0];
+      CID1      = GENLC.NON1ASED.CIDRANGE[isp][1];
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t Reported flux-uncertainty includes " ); 
-  j2 = (INPUTS.SMEARFLAG_FLUX & 2);
-  if ( j2 == 0 ) 
-    { strcat(cptr,"SKY+GALAXY+SOURCE\n"); }
-  else
-    { strcat(cptr,"SKY only\n"); } // SMP-like errors
+      if ( NGENTOT > 0 ) { eff = (float)NGENWR/(float)NGENTOT ; }
+      else               { eff = 0.0 ; continue ; }
+      
+      // glue together rest-frame peakmags
 
+      ctmp[0] = 0 ;
+      i++; cptr = VERSION_INFO.README_DOC[i] ;
+      sprintf(cptr," %3.3d (%10s)  %4d  %5d   %5.3f %6d -%6d\n", 
+	      index, ptrtype, NGENWR, NGENTOT, eff, CID0, CID1 );
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  j = INPUTS.SMEARFLAG_ZEROPT ;
-  sprintf(cptr, "\t Zeropt-smearing is %s \n", conoff[j] );
+      if ( NGENUSR != NGENWR  && INPUTS.NGEN_LC > 0 ) {
+	sprintf(c1err,"NGEN[NONIA index=%d]=%d, but expected NGEN=%d",
+		index, NGENWR, NGENUSR );
+	errmsg(SEV_WARN, 0, fnam, c1err, ""); 
+      }
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;  j=0;
-  OVP1 = INPUTS.SMEARFLAG_HOSTGAL & SMEARMASK_HOSTGAL_PHOT ; 
-  if ( OVP1 ) { j = 1; }
-  sprintf(cptr, "\t Host-galaxy shot-noise  is %s \n", conoff[j] );
+    }  // end of isp loop
 
+  *iline = i;
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;  j=0;
-  OVP2 = INPUTS.SMEARFLAG_HOSTGAL & SMEARMASK_HOSTGAL_IMAGE ; 
-  if ( OVP2 ) { j = 1; }
-  sprintf(cptr, "\t Host-galaxy image-noise  is %s \n", conoff[j] );
+  return ;
 
+} // end readme_doc_NON1ASED
 
-  readme_doc_MWXT(&i);
 
+// ********************************************
+void readme_doc_SIMLIB(int *iline) {
 
-  // ------- RATE INFO ---------
+  // add SIMLIB info to readme file.
+  int i, j, NSKIP ;
+  char *cptr, ctmp[100];
 
-  for ( j=0; j < NLINE_RATE_INFO; j++ ) {
-     i++; cptr = VERSION_INFO.README_DOC[i] ;
-     sprintf(cptr,"%s\n", LINE_RATE_INFO[j] );
-  }
+  // ------------- BEGIN ---------------
 
-  // ------- generation --------
+  i = *iline ;
 
+  // - - - - - - 
   i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n  GENERATION RANGES: \n");
+  if ( GENLC.SIMLIB_IDLOCK >= 0 ) 
+    { sprintf(ctmp,"Lock LIBID=%d", GENLC.SIMLIB_IDLOCK ); }
+  else
+    { sprintf(ctmp,"start at LIBID=%d", INPUTS.SIMLIB_IDSTART ); }
 
-  if ( INPUTS.USE_SIMLIB_GENOPT ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t ==> Override gen-values with SIMLIB header values.\n");
-  }
+  if ( INPUTS.SIMLIB_NREPEAT > 1 ) // Apr 26 2017
+    { sprintf(ctmp,"NREPEAT=%d", INPUTS.SIMLIB_NREPEAT ); } 
 
-  if ( INPUTS.USE_SIMLIB_REDSHIFT == 0 ) 
-    { sprintf(ctmp,"%s distribution.", INPUTS.RATEPAR.NAME ); }
-  else
-    { sprintf(ctmp,"SIMLIB values." ); }
+  sprintf(cptr,"\t SIMLIB filename  : %s (%s) \n", 
+	  INPUTS.SIMLIB_FILE, ctmp ); 
+
+  // - - - - - - 
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"\t SIMLIB SURVEY    : %s  (TELESCOPE=%s, MINOBS=%d) \n", 
+	  GENLC.SURVEY_NAME, GENLC.TELESCOPE[0], INPUTS.SIMLIB_MINOBS  ); 
 
   i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,
-	  "\t Generate Redshift : %6.3f to %6.3f  using  %s \n"
-	  ,INPUTS.GENRANGE_REDSHIFT[0]
-	  ,INPUTS.GENRANGE_REDSHIFT[1] 
-	  ,ctmp	  );
+  sprintf(cptr,"\t SIMLIB UNITS     : %s for PSF,  %s for SKYSIG \n", 
+	  SIMLIB_GLOBAL_HEADER.PSF_UNIT, SIMLIB_GLOBAL_HEADER.SKYSIG_UNIT  ); 
 
+  if ( INPUTS.SIMLIB_MSKOPT != 0 ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t SIMLIB MSKOPT   : %d \n", INPUTS.SIMLIB_MSKOPT );
+  }
 
-  if ( INPUTS.GENBIAS_REDSHIFT != 0.0 ) {
+  double MINSEASON = INPUTS.SIMLIB_MINSEASON;
+  if ( MINSEASON > 0.01 ) {
     i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t Generate redshift bias : %f \n", 
-	    INPUTS.GENBIAS_REDSHIFT );
+    sprintf(cptr,"\t SIMLIB min season len : %.0f days", MINSEASON);
   }
+ 
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  if ( INPUTS.GENSIGMA_REDSHIFT >= 0.0 ) {
-    sprintf(cptr,"\t REDSHIFT_FINAL is ZCMB_GEN smeared by : %8.5f \n", 
-	    INPUTS.GENSIGMA_REDSHIFT);
+  int NPE_SAT  = SIMLIB_GLOBAL_HEADER.NPE_PIXEL_SATURATE ;
+  int PHOTFLAG = SIMLIB_GLOBAL_HEADER.PHOTFLAG_SATURATE ;
+  if ( NPE_SAT < 999999999 ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t SIMLIB Saturation : %d pe in central pixel "
+	    "-> PHOTFLAG=%d\n",  NPE_SAT, PHOTFLAG);
   }
-  else
-    { sprintf(cptr,"\t REDSHIFT_FINAL is host-photoZ \n"); }
 
-  
-  if ( WRONGHOST.NLIST > 0.0 ) {
+  if ( INPUTS.FUDGEOPT_FLUXERR ) {
     i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t WRONGHOST model frac: %.3f + %.3f*z + %.5f*z^2 \n"
-	    ,WRONGHOST.PROB_POLY[0]
-	    ,WRONGHOST.PROB_POLY[1]
-	    ,WRONGHOST.PROB_POLY[2]     );
+    sprintf(cptr,"\t FUDGEOPT_FLUXERR : %d \n",
+	    INPUTS.FUDGEOPT_FLUXERR );
   }
 
-  if ( INPUTS.VEL_CMBAPEX == 0.0 ) {
+  if ( INPUTS.SIMLIB_IDLOCK > 1 ) {
     i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,
-	    "\t v(cmb)=0 -> REDSHIFT_HELIO=REDSHIFT_CMB (legacy option)\n");
+    sprintf(cptr,"\t SIMLIB ID LOCKED to LIBID : %d \n", 
+	    GENLC.SIMLIB_IDLOCK ); 
   }
-
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t Peculiar Velocity Gaussian sigma: %.1f km/sec\n", 
-	  INPUTS.GENSIGMA_VPEC );
-
-
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t %s   ZP   offsets : ", INPUTS.GENFILTERS);
-  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
-    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
-    sprintf(ctmp,"%6.3f ", INPUTS.GENMAG_OFF_ZP[ifilt_obs] ); 
-    strcat(cptr,ctmp); 
+  if ( INPUTS.SIMLIB_IDLOCK == 1 ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t SIMLIB ID LOCKED to first accepted LIBID : %d \n", 
+	    GENLC.SIMLIB_IDLOCK ); 
   }
-  strcat(cptr,"\n"); 
 
+  NSKIP = INPUTS.NSKIP_SIMLIB ;
+  if ( NSKIP > 0 ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t SIMLIB IDs skipped : " );
+    for ( j=0; j < NSKIP ; j++ ) {
+      sprintf(ctmp," %d", INPUTS.SIMLIB_IDSKIP[j] );
+      strcat(cptr, ctmp);
+    }
+    strcat ( cptr, "\n" );
+  }
 
-  float magoff;
   i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t %s  MODEL offsets : ", INPUTS.GENFILTERS);
-  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
-    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
-    magoff = INPUTS.GENMAG_OFF_MODEL[ifilt_obs] + INPUTS.GENMAG_OFF_GLOBAL ;
-    sprintf(ctmp,"%6.3f ", magoff ); 
-    strcat(cptr,ctmp); 
-  }
-  strcat(cptr,"\n"); 
+  sprintf(cptr,"\t NEWMJD_DIF       : "
+	  "%5.2f  minutes (defines trigger epoch)\n", 
+	  24.*60.*INPUTS.NEWMJD_DIF ); 
 
+  *iline = i;
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t %s  exposure times: ", INPUTS.GENFILTERS);
-  xtprod = 1.0 ;
-  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
-    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
-    xt = INPUTS.EXPOSURE_TIME_FILTER[ifilt_obs] ;
-    xtprod *= xt ;
 
-    if ( xt > 10.0 )   sprintf(ctmp,"%6.1f ", xt ); 
-    else               sprintf(ctmp,"%6.4f ", xt ); 
+} // end of readme_doc_SIMLIB
 
-    strcat(cptr,ctmp); 
-  } // end if ifilt
-  strcat(cptr,"\n"); 
 
-  // indicate which quantities were scaled by EXPOSURE_TIME  
-  // xxx mark delete May 2019  if ( fabsf(xtprod-1.0) > .001 ) {
-    if ( xtprod != 1.0 ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t %s  exposure MSKOPT=%d => ", 
-	    INPUTS.GENFILTERS, INPUTS.EXPOSURE_TIME_MSKOPT );
+// *******************************
+void  readme_doc_magSmear(int *iline) {
 
-    if ( INPUTS.EXPOSURE_TIME_MSKOPT  & (1 << 0) )
-      { strcat(cptr, "ZPT  "); }
-    if ( INPUTS.EXPOSURE_TIME_MSKOPT  & (1 << 1) )
-      { strcat(cptr, "SKYSIG  "); }
-    if ( INPUTS.EXPOSURE_TIME_MSKOPT  & (1 << 2) )
-      { strcat(cptr, "READNOISE  "); }
+  int i, j, ifilt, onoff;
+  char *cptr, ctmp[80] ;
+  char conoff[2][4] = { "OFF" , "ON" } ;
 
-    strcat(cptr,"\n");
-  }
+  i = *iline ;
 
-  // - - - - - - -  -
-  // optional MJD_TEMPLAT (Sep 2017)
-  if ( INPUTS.USE_MJD_TEMPLATE ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t MJD_TEMPLATE: " );
-    
-    for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
-      ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
-      val       = INPUTS.MJD_TEMPLATE_FILTER[ifilt_obs] ;
-      if ( val > 1.0 ) {
-	sprintf(ctmp,"%6.1f(%c) ", val, FILTERSTRING[ifilt_obs] ); 
-	strcat(cptr,ctmp); 
-      }
-    } // end if ifilt
-    strcat(cptr,"\n"); 
-  }
 
-  // - - - - - - -
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t RA       : %6.2f to %6.2f  deg\n", 
-	  INPUTS.GENRANGE_RA[0], INPUTS.GENRANGE_RA[1] );
+  // intrinsic smearing params
 
-  // - - - -  PEAKMJD stuff - - - - - 
   i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t PEAKMJD  : %8.1f to %8.1f   \n", 
-	  INPUTS.GENRANGE_PEAKMJD[0], INPUTS.GENRANGE_PEAKMJD[1] );
+  sprintf(cptr,"\n  Intrinsic MAG-smearing models "
+	  "(sigma clip %4.1f to %4.1f) : \n"
+	  ,INPUTS.SIGMACLIP_MAGSMEAR[0]
+	  ,INPUTS.SIGMACLIP_MAGSMEAR[1]
+	  );
 
-  if ( INPUTS.GENSIGMA_PEAKMJD > 1.0E-9 ) {
-    sprintf(ctmp,"Gauss smear, sigma=%5.2f days", INPUTS.GENSIGMA_PEAKMJD);
-  }
-  else if ( (INPUTS.OPT_SETPKMJD & OPTMASK_SETPKMJD_FLUXMAX2)>0 ) {
-    sprintf(ctmp,"Fmax-clump, MJDWIN=%.1f, SNRCUT>%.1f(3.0)",
-	    INPUTS.MJDWIN_SETPKMJD, INPUTS.SNRCUT_SETPKMJD );
-  }
-  else if ( (INPUTS.OPT_SETPKMJD & OPTMASK_SETPKMJD_FLUXMAX)>0 ) {
-    sprintf(ctmp,"naive max flux.");
-  }
   i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t PEAKMJD-estimate  : %s\n", ctmp);
+  sprintf(cptr,"   Model 1: Coherent MAG-smearing (GENMAG_SMEAR) : %6.3f  \n", 
+	  INPUTS.GENMAG_SMEAR);
 
-  // - - - - - - - - - 
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t Trest    : %8.2f to %8.2f  days \n", 
-	  INPUTS.GENRANGE_TREST[0], INPUTS.GENRANGE_TREST[1] );
+  onoff = 0;
+  if ( INPUTS.GENMODEL_ERRSCALE > 0.0 ) onoff=1; 
+  if ( INPUTS.NFILT_SMEAR       > 0   ) onoff=1; 
 
-  
-  if ( INPUTS.TGRIDSTEP_MODEL_INTERP > 0.0 ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t TGRIDSTEP  : %.1f days (for model-mag interp) \n",
-	    INPUTS.TGRIDSTEP_MODEL_INTERP );
-  }
 
   i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t RISETIME-SHIFT(days) SIGMA(lo,hi) : %3.1f , %3.1f  (Mean= %3.1f) \n"
-	  ,INPUTS.GENGAUSS_RISETIME_SHIFT.SIGMA[0]
-	  ,INPUTS.GENGAUSS_RISETIME_SHIFT.SIGMA[1] 
-	  ,INPUTS.GENGAUSS_RISETIME_SHIFT.PEAK
-	  );
+  sprintf(cptr,"   Model 2: passband MAG-smearing is %s \n", conoff[onoff] );
+
+  if ( onoff > 0 ) {
+    if ( INPUTS.GENMODEL_ERRSCALE_OPT == 1 )  
+      { sprintf(ctmp,"PEAK"); }
+    else           
+      { sprintf(ctmp,"EPOCH-DEPENDENT"); }
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t FALLTIME-SHIFT(days) SIGMA(lo,hi) : %3.1f , %3.1f  (Mean= %3.1f) \n"
-	  ,INPUTS.GENGAUSS_FALLTIME_SHIFT.SIGMA[0]
-	  ,INPUTS.GENGAUSS_FALLTIME_SHIFT.SIGMA[1] 
-	  ,INPUTS.GENGAUSS_FALLTIME_SHIFT.PEAK
-	  );
 
-  // print shape-par info for all models except SIMSED
-  if ( INPUTS.NPAR_SIMSED == 0  ) {
     i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(ctmp,"\t Shape-par(%s)", GENLC.SHAPEPAR_NAME );
-    sprintf_GENGAUSS(cptr, ctmp, &INPUTS.GENGAUSS_SHAPEPAR);
+    sprintf(cptr,"\t Scale %s model errors (GENMODEL_ERRSCALE) : %6.3f  \n", 
+	    ctmp, INPUTS.GENMODEL_ERRSCALE );
 
-  }
+    if ( INPUTS.NFILT_SMEAR > 0 ) {
+      i++; cptr = VERSION_INFO.README_DOC[i] ;
+      sprintf(cptr,"\t Fixed ");
+      for ( j=1; j <= INPUTS.NFILT_SMEAR; j++ ) {
+	ifilt = INPUTS.IFILT_SMEAR[j]; 
+	sprintf(cptr, "%s%c", cptr, FILTERSTRING[ifilt] ) ;
+      }
+      strcat(cptr," mag-smear:");
 
-  // SIMSED parameters
-  readme_doc_SIMSED(&i);
+      for ( j=1; j <= INPUTS.NFILT_SMEAR; j++ ) {
+	ifilt = INPUTS.IFILT_SMEAR[j]; 
+	sprintf(cptr, "%s %4.2f", cptr, INPUTS.GENMAG_SMEAR_FILTER[ifilt] ) ;
+      }
+      strcat(cptr,"\n");
 
-  // ---- SALT2 params
-  readme_doc_SALT2params(&i);
+    }
 
-  // ---- FIXMAG params
-  readme_doc_FIXMAG(&i);
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t Correlation between models 1 & 2 : %5.2f \n",
+	    INPUTS.GENMODEL_ERRSCALE_CORRELATION );
 
+  } // NFILT_SMEAR
 
   // --------------------------------
-  // dump host extinction params
+  // restlambda-dependent smearing using  GENMAG_SMEAR_MODELNAME
 
-  readme_doc_hostxt(&i);
+  onoff = 0;   ctmp[0] = 0 ;
+  if ( istat_genSmear() > 0 ) { 
+    onoff=1; 
+    sprintf(ctmp,"%s", INPUTS.GENMAG_SMEAR_MODELNAME);
+  }
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"   Model 3: %s model-smear is %s  \n", 
+	  ctmp, conoff[onoff] );
 
+  // print override parameter names xxxgenmag
+  for(j=0; j < NSMEARPAR_OVERRIDE; j++ ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr, "\t    %s-Override :  %d values for %s\n" 
+	    , ctmp
+	    , GENMAG_SMEARPAR_OVERRIDE[j].NVAL
+	    , GENMAG_SMEARPAR_OVERRIDE[j].NAME );
+  }
 
-  // ====================================
-  // Z-dependent parameters (if requested)
+  // -------------------------
+  // model 4: intrinsic scatter matrix
 
-  if ( NPAR_ZVAR_USR > 0 ) {
-    
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr, "\n  Z-dependent SN-parameter shifts: \n");
+  if ( INPUTS.NCOVMAT_SCATTER > 0 ) { onoff=1;} else { onoff=0;}
 
-    for ( ipar=0; ipar < NPAR_ZVAR_USR; ipar++ ) {
-      sprintf(ctmp,"%s", INPUT_ZVARIATION[ipar].PARNAME );
-      ZMIN = INPUTS.GENRANGE_REDSHIFT[0] ; 
-      ZMAX = INPUTS.GENRANGE_REDSHIFT[1] ; 
-      shift[0] = get_zvariation(ZMIN,ctmp) ;
-      shift[1] = get_zvariation(ZMAX,ctmp) ;
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"   Model 4: intrinsic scatter matrix is %s \n", 
+	  conoff[onoff] );
 
+  char *ptrScat; 
+  for ( j=0; j < 8; j++ ) {
+    ptrScat = GENLC.COVMAT_SCATTER_README[j] ;
+    if ( strlen(ptrScat) > 0 ) {
       i++; cptr = VERSION_INFO.README_DOC[i] ;
-      sprintf(cptr," %20s-shift = %6.3f(ZMIN=%5.3f), %6.3f(ZMAX=%5.3f) \n",
-	      ctmp, shift[0],ZMIN, shift[1], ZMAX );
-    }  // end of NPAR_ZVAR_USR loop
-  } else {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr, "\n  Z-dependent SN-parameter shifts:  None. \n");
+      sprintf(cptr,"%s\n", ptrScat ); 
+    }
+  }
+
+  
+  // model 5: SMEAR_USRFUN
+  if ( INPUTS.NPAR_GENSMEAR_USRFUN > 0 )  { onoff=1;} else { onoff=0;}
+  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  sprintf(cptr,"   Model 5: GENMAG_SMEAR_USRFUN is  %s \n", 
+	  conoff[onoff] );
+  
+  if ( onoff == 1 ) {
+    i++ ; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t FUNPAR[1-%d] = ", INPUTS.NPAR_GENSMEAR_USRFUN );
+    for ( j=0; j < INPUTS.NPAR_GENSMEAR_USRFUN; j++ )  { 
+      sprintf(ctmp,"%6.2f ", INPUTS.GENMAG_SMEAR_USRFUN[j] );  
+      cptr = strcat(cptr,ctmp);
+    }
+    cptr = strcat(cptr,"\n");
   }
 
 
-  // ===========================================
 
-  readme_doc_magSmear(&i);
+  *iline = i;
+  return ;
 
-  readme_doc_nonLin(&i); // May 27 2016
+} // end of readme_doc_magSmear
 
-  // ============================================
-  // AVWARP-overflows vs. rest-frame filter
+// ***************************************
+void  readme_doc_nonLin(int *iline) {
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
+  int i,j;
+  char *cptr ;
+  // ------------- BEGIN ----------------
 
-  sprintf(ctmp, "\n  AVWARP_OVERFLOWS: ");
-  if ( NAVWARP_OVERFLOW[0] == 0 ) {
-    strcat(ctmp," NONE. ");
-    // xxx mark delete   sprintf(ctmp, "%s NONE. ", ctmp);
-  }
-  else {
-    
-    for ( ifilt=0; ifilt < GENLC.NFILTDEF_REST; ifilt++ ) {
-      ifilt_rest = GENLC.IFILTMAP_REST[ifilt] ;
-      sprintf(cfilt,"%c", FILTERSTRING[ifilt_rest] ); 
-      NOV = NAVWARP_OVERFLOW[ifilt_rest] ;
-      if ( NOV > 0 ) sprintf(ctmp, "%s %d(%s)", ctmp, NOV, cfilt);
-    } 
-  }
-  strcat(ctmp,"\n");
-  // xxx mark delete  sprintf(ctmp,"%s\n", ctmp);
-  strcat(cptr,ctmp);
-  // xxx mark delete  sprintf(cptr,"%s", ctmp);
-  sprintf(WARNING_AVWARP_OVERFLOW,"\n  WARNING: %s", ctmp); 
+  if ( NONLIN_README.NLINE == 0 ) { return ; }
 
-  readme_doc_TAKE_SPECTRUM(&i);
+  i = *iline ;
 
-  // ----- cosmology parameters
+  for(j=0; j < NONLIN_README.NLINE; j++ ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"%s\n", NONLIN_README.LINE[j] );
+  }
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n  Cosmology Parameters: \n");
+  *iline = i;
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t H0 = %6.2f km/s per MPc \n", INPUTS.H0 );
+  return ;
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t Omega_{M,L} = %5.2f, %5.2f   w = %5.2f  \n",
-	  INPUTS.OMEGA_MATTER, INPUTS.OMEGA_LAMBDA, INPUTS.W0_LAMBDA );
+} // end readme_doc_nonLin
 
+// ***************************************
+void  readme_doc_SIMSED(int *iline) {
 
+  int i, ipar, iflag ;
+  char *cptr, ctmp[80], ctmp2[80] ;
 
-  // ------ software Search efficiency
+  i = *iline ;
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n --------------------------------------------------- \n");
+  if ( INPUTS.OPTMASK_SIMSED == OPTMASK_SIMSED_GRIDONLY ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;  
+    sprintf(cptr,"\n   %s model option is GRIDONLY & SEQUENTIAL \n", 
+	    INPUTS.MODELNAME );
+  } 
+  else if ( INPUTS.NPAR_SIMSED > 0  ) {
+    i++; cptr = VERSION_INFO.README_DOC[i] ;  
+    sprintf(cptr,"\n   %s model parameters: \n", 
+	    INPUTS.MODELNAME );
+  }
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"  Software-Pipeline Search Efficiency (MINOBS=%d) from \n", 
-	  INPUTS_SEARCHEFF.MINOBS );
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"%s", SEARCHEFF_DETECT[MXMAP_SEARCHEFF_DETECT].README[0] ) ;
-  for ( imap=0; imap < INPUTS_SEARCHEFF.NMAP_DETECT; imap++ ) {
-    NLINE = SEARCHEFF_DETECT[imap].NLINE_README ; 
-    for ( itmp = 1; itmp <= NLINE; itmp++ ) {
-      i++; cptr = VERSION_INFO.README_DOC[i] ;
-      sprintf(cptr,"%s", SEARCHEFF_DETECT[imap].README[itmp] ) ;
-    }    
-  }
+  for ( ipar = 0; ipar < INPUTS.NPAR_SIMSED; ipar++ ) {
 
-  // print detection logic
-  NLINE = SEARCHEFF_DETECT[MXMAP_SEARCHEFF_DETECT].NLINE_README ; 
-  for ( itmp = 1; itmp <= NLINE; itmp++ ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"%s", SEARCHEFF_DETECT[MXMAP_SEARCHEFF_DETECT].README[itmp] ) ;
-  }    
-  
+    iflag = INPUTS.GENFLAG_SIMSED[ipar];
 
-  // ------ Spec Search efficiency
+    if ( (iflag & 1) == 0 ) 
+      { continue ; } // baggage
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"%s", "\n  Spectroscopic Efficiency : \n" );
-  for ( iopt=1; iopt <= SEARCHEFF_SPEC_INFO.NLINE_README; iopt++ ) {
-      i++; cptr = VERSION_INFO.README_DOC[i] ;
-      sprintf(cptr, "%s \n", SEARCHEFF_SPEC_INFO.README[iopt] ) ;    
-  }
-  
+    if ( (iflag & 4) > 0 ) 
+      { sprintf(ctmp, "GRIDONLY" ); }
+    else
+      { sprintf(ctmp, "contin." ); }
 
-  if ( INPUTS_SEARCHEFF.NMAP_zHOST ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"%s", "\n  Unconfirmed zHOST Efficiency map from \n" );
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t %s \n", INPUTS_SEARCHEFF.zHOST_FILE );
-  }
-  else {
     i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"%s", "\n  Unconfirmed zHOST Efficiency : 100% \n" );
+    sprintf(ctmp2,"    %s(%s)", INPUTS.PARNAME_SIMSED[ipar], ctmp );
+    sprintf_GENGAUSS(cptr, ctmp2, &INPUTS.GENGAUSS_SIMSED[ipar] );
+
   }
-  
 
 
-  // write APPLY-mask
-  OVP1 = (INPUTS.APPLY_SEARCHEFF_OPT & 1);
-  OVP2 = (INPUTS.APPLY_SEARCHEFF_OPT & 2);
-  OVP3 = (INPUTS.APPLY_SEARCHEFF_OPT & 4);
+  *iline = i;
 
-  if ( OVP1 && OVP2 ) 
-    { sprintf(ctmp,"%s", "Apply both PIPELINE+SPEC efficiencies"); }
-  else if ( OVP1 && OVP2 == 0 ) 
-    { sprintf(ctmp,"%s", "Apply only PIPELINE efficiency (not SPEC-eff)"); }
-  else if ( OVP1 == 0 && OVP2 ) 
-    { sprintf(ctmp,"%s", "Apply only SPEC efficiency (not PIPELINE-eff)"); }
-  else if ( OVP1 == 0 && OVP2 == 0 ) 
-    { sprintf(ctmp,"%s", "Do NOT Apply trigger efficiency "); }
-      
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n  APPLY_SEARCHEFF_OPT:  %d => %s \n", 
-	  INPUTS.APPLY_SEARCHEFF_OPT, ctmp);
+} // end of  readme_doc_SIMSED
 
-  // print SNTYPE values for SPEC and PHOT Ia-subsets 
-  // For NONIA there is only one type specified with the NONIA keys.
-  if ( LGEN_SNIA ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"  SNTYPE(Ia) = %d(SPEC)  and %d(PHOT) \n", 
-	    INPUTS.SNTYPE_Ia_SPEC, INPUTS.SNTYPE_Ia_PHOT);    
-  }
+// *******************************
+void  readme_doc_MWXT(int *iline) {
 
+  int i ;
+  char *cptr ;
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr," --------------------------------------------------- \n");
+  i = *iline ;
+   
+  if ( INPUTS.MWEBV_FLAG ) {
 
+    i++; cptr = VERSION_INFO.README_DOC[i] ; 
+    sprintf(cptr, "\t MilkyWay extinction  is ON  \n" );
 
-  // ------ software cuts -----------
-  if ( INPUTS.APPLY_CUTWIN_OPT  ) {  readme_doc_CUTWIN(&i) ; }
+    i++; cptr = VERSION_INFO.README_DOC[i] ; 
+    sprintf(cptr, "\t    Color law: %s  (OPT_MWCOLORLAW=%d) \n",  
+	    INPUTS.STR_MWCOLORLAW, INPUTS.OPT_MWCOLORLAW );
 
 
-  // ---- HOST-GALAXY 
+    i++; cptr = VERSION_INFO.README_DOC[i] ; 
+    if ( INPUTS.GENRANGE_MWEBV[0] >= 0.0 ) {
+      sprintf(cptr, "\t    E(B-V) randomly picked between %.3f and %.3f\n",  
+	      INPUTS.GENRANGE_MWEBV[0], INPUTS.GENRANGE_MWEBV[1] );
+    }
+    else {
+      sprintf(cptr, "\t    E(B-V): %s   (OPT_MWEBV=%d)\n",  
+	      INPUTS.STR_MWEBV, INPUTS.OPT_MWEBV );
+    }
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n  HOSTLIB Summary: " );
+    i++; cptr = VERSION_INFO.README_DOC[i] ; 
+    sprintf(cptr, "\t    sigma(MWEBV) = %.2f*MWEBV + %.2f  \n", 
+	    INPUTS.MWEBV_SIGRATIO, INPUTS.MWEBV_SIG );
 
-  if ( INPUTS.HOSTLIB_USE == 0 ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"None. \n" );
+    i++; cptr = VERSION_INFO.README_DOC[i] ; 
+    sprintf(cptr, "\t    shift(MWEBV) = %5.3f mag \n", 
+	    INPUTS.MWEBV_SHIFT );
+
+    if ( INPUTS.APPLYFLAG_MWEBV ) {
+      i++; cptr = VERSION_INFO.README_DOC[i] ; 
+      sprintf(cptr, "\t    Correct dataFile FLUXCAL for MWEBV \n");
+    }
+    
   }
   else {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\n" );
-    NLINE = HOSTLIB.NLINE_COMMENT ;
-    for ( itmp=1; itmp <= NLINE; itmp++ ) {
-      i++; cptr = VERSION_INFO.README_DOC[i] ;
-      sprintf(cptr,"\t %s \n", HOSTLIB.COMMENT[itmp] );
-    }
+    i++; cptr = VERSION_INFO.README_DOC[i] ; 
+    sprintf(cptr, "\t MilkyWay extinction  is OFF \n" );
   }
 
+  *iline = i ;
 
-  // -----  FUDGES on observing conditions ------
-  readme_doc_FUDGES(&i);
-
-  // ======================================
-  VERSION_INFO.NLINE_README_INIT = i;   // can dump to here after init
-  if ( iflag_readme == 1 ) return ;
-  // ======================================
-
- AFTERSIM:
-  i = VERSION_INFO.NLINE_README_INIT ;
-
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n ============ END OF SIMULATION SUMMARY ============== \n");
-
-  // ---- random seed and first/last random
-
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n  Random Number Sync: \n");
+} // end of readme_doc_MWXT
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t RANDOM SEED: %d   (RANLIST_START_GENSMEAR: %d)\n", 
-	  INPUTS.ISEED, INPUTS.RANLIST_START_GENSMEAR );
+// *******************************
+void readme_doc_filterWarn(int *iline) {
 
+  double ZMIN, ZMAX;
+  int i, ifilt, ifilt_obs, NSKIP;
+  char *cptr, cfilt[2];
 
-  int ilist;
-  for ( ilist=1; ilist <= NLIST_RAN; ilist++ ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t FIRST/LAST Random Number (List=%d): %f %f  \n", 
-	    ilist, RANFIRST[ilist], RANLAST[ilist] );
-  }
+  i = *iline ;
 
-  // ---- statistics
+  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
+    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
 
-  double t_tot   = (t_end-t_start) ; // total proc time, sec
-  double R_gen   = (double)NGENLC_TOT / t_tot ;  // NGEN/sec
-  double R_write = (double)NGENLC_WRITE/t_tot ;  // NWRITE/sec
+    sprintf(cfilt,"%c", FILTERSTRING[ifilt_obs] ); 
+    NSKIP = NSKIP_FILTER[ifilt_obs] ;
+    ZMIN  = ZVALID_FILTER[0][ifilt_obs] ;
+    ZMAX  = ZVALID_FILTER[1][ifilt_obs] ;
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n  Generation Statistics (total CPU=%.1f minutes): \n", 
-	  t_tot/60.);
+    if ( NSKIP > 0 && ZMIN > 100. ) {
+      i++; cptr = VERSION_INFO.README_DOC[i] ;
+      sprintf(cptr,"\t FILTER-WARNING: %s not generated for any z-range. \n", 
+	      cfilt);
+    }
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t Generated %5d simulated light curves "
-	  "(%.f/sec) \n",  NGENLC_TOT, R_gen );
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t Wrote     %5d simulated light curves to SNDATA files "
-	  "(%.f/sec). \n",  NGENLC_WRITE, R_write );
+    if ( NSKIP > 0 && ZMIN < 10. ) {
+      i++; cptr = VERSION_INFO.README_DOC[i] ;
+      sprintf(cptr,"\t FILTER-WARNING: %s generated only for %5.3f < z < %5.3f\n",
+	      cfilt, ZMIN, ZMAX );       
+    }
 
-  if ( NGENSPEC_WRITE > 0 ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t Wrote     %5d simulated spectra to SNDATA files \n",
-	    NGENSPEC_WRITE );
   }
 
-  // spectroscopic tags
+  *iline = i;
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"  Spectroscopic-type: %d -> %d (before -> after cuts)\n",
-	  GENLC.NTYPE_SPEC, GENLC.NTYPE_SPEC_CUTS);
-  
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"  Photometric-type:   %d -> %d (before -> after cuts)\n",
-	  GENLC.NTYPE_PHOT, GENLC.NTYPE_PHOT_CUTS);
+} // end of readme_doc_filterWarn
 
 
-  if ( !IGNOREFILE(INPUTS.WRONGHOST_FILE) ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    double frac = 0.0 ;
-    int N0      = NGENLC_WRITE ;
-    int N1      = GENLC.NTYPE_PHOT_WRONGHOST ;
-    if ( GENLC.NTYPE_PHOT_CUTS > 0 ) { frac = (double)N1 / (double)N0 ; }
-    sprintf(cptr,"  Wrong-host fraction: %d/%d = %.4f\n", N1,N0,frac);
-  }
+// *******************************
+void readme_doc_hostxt(int *iline) {
 
-  // ----------------
+  // add host extinction info to README 
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"  Rejection Statistics: \n");
+  int i;
+  int LDMP_HOSTXT, USE_AV ;
+  char *cptr, cEXPON[40], cGAUSS[40] ;
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t %5d rejected by NEPOCH<%d \n",
-	  NGEN_REJECT.NEPOCH, (int)INPUTS.CUTWIN_NEPOCH[0] ) ;
+  // ------------ BEGIN --------------
 
+  i = *iline ;
 
-  double MAGMIN = INPUTS.GENRANGE_PEAKMAG[0];
-  double MAGMAX = INPUTS.GENRANGE_PEAKMAG[1];
-  if ( MAGMIN > 0.0 && MAGMAX < 9999. ) {
+  LDMP_HOSTXT = 
+    ( GENFRAME_OPT   == GENFRAME_REST ) ||
+    ( INPUTS.NON1A_MODELFLAG > 0 )  ;
+
+  USE_AV = 
+    (INPUTS.GENRANGE_AV[1] > 1.0E-9 ) &&
+    (INPUTS.GENEXPTAU_AV   > 1.0E-9  || INPUTS.GENGAUSIG_AV > 1.0E-9 ) ;
+
+  if ( LDMP_HOSTXT && (USE_AV==0)  ) {
     i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t %5d rejected by GENRANGE_PEAKMAG(%.1f to %.1f) \n",  
-	    NGEN_REJECT.GENMAG, MAGMIN, MAGMAX );
+    sprintf(cptr,"\n  Host Extinction Parameters: NONE  (AV=0) \n");    
   }
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t %5d rejected by GENRANGEs \n",  
-	  NGEN_REJECT.GENRANGE );
+  if ( LDMP_HOSTXT && USE_AV  ) {
 
-  if ( GENPAR_SELECT.NSTORE > 0 ) {
     i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t %5d rejected by GENPAR_SELECT_FILE \n",  
-	    NGEN_REJECT.GENPAR_SELECT_FILE );
-  }
+    sprintf(cptr,"\n  Host Extinction Parameters: \n");
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t %5d rejected by SEARCH-TRIGGER \n",  
-	  NGEN_REJECT.SEARCHEFF );
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf_GENGAUSS(cptr, "\t RV ", &INPUTS.GENGAUSS_RV);
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t %5d rejected by CUTWIN-SELECTION \n",  
-	  NGEN_REJECT.CUTWIN );
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t Gen-Range for AV  : %4.2f to %4.2f  (model=%s) \n", 
+	    INPUTS.GENRANGE_AV[0], INPUTS.GENRANGE_AV[1], INPUTS.GENSNXT );
+  
 
-  // ---
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    if ( INPUTS.GENEXPTAU_AV < 50.0 ) {
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"  SEARCH+CUTS Efficiency: %7.4f +- %7.4f \n", 
-	  GENLC.GENEFF, GENLC.GENEFFERR);
+      cEXPON[0] = 0 ;
+      cGAUSS[0] = 0 ;
+      if ( INPUTS.GENEXPTAU_AV > 1.0E-9 ) 
+	{ sprintf(cEXPON,"exp(-AV/%4.2f)/tau", 
+		  INPUTS.GENEXPTAU_AV ); 
+	}
+      if ( INPUTS.GENGAUSIG_AV > 1.0E-9 ) 
+	{ sprintf(cGAUSS,"%4.2f x Gauss(AV,sig=%4.2f)",
+		  INPUTS.GENRATIO_AV0, INPUTS.GENGAUSIG_AV ); 
+	}
 
-  // give warning if generation stops early
-  if ( GENLC.STOPGEN_FLAG == 1  ) {
+      sprintf(cptr,"\t dN/dAv = %s + %s \n", cEXPON, cGAUSS ); 
+    }
+    else  { 
+      sprintf(cptr,"\t dN/dAv = flat \n");  // Rodney request (Oct 2012)
+    }
 
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\n  WARNING: GENERATION STOPPED WHEN ERROR\n");
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t   on ERR(EFF) <= EFFERR_STOPGEN(=%f)\n",  
-	    INPUTS.EFFERR_STOPGEN );
+  }  // end of SALT2/color/dust if-block
 
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t  => YOU HAVE %d FEWER LIGHT CURVES THAN REQUESTED\n",
-	    INPUTS.NGEN_LC - NGENLC_WRITE );
-  }
 
+  *iline = i ;
 
-  // give SN-stats with cuts
-  XN   = (INPUTS.RATEPAR.SEASON_COUNT  + INPUTS.RATEPAR_PEC1A.SEASON_COUNT) ;
-  XN  *= GENLC.GENEFF ; // multiply by cut-efficiency
-  if ( NGENLC_WRITE > 0 ) 
-    { XNERR = XN/sqrt((double)NGENLC_WRITE); }
-  else
-    { XNERR = 0.0 ; }
+} // end of readme_doc_hostxt
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n  Number of SNe per season AFTER CUTS : %6.0f +- %5.0f \n", 
-	  XN, XNERR );
 
+// **************************************
+void readme_doc_FIXMAG(int *iline ) {
 
-  // NON1ASED
-  if ( INPUTS.NON1ASED.NINDEX > 0 ) { readme_doc_NON1ASED(&i); }
+  int i ;
+  char *cptr ;
 
+  if ( INDEX_GENMODEL != MODEL_FIXMAG ) { return ; }
 
-  // end marker
+  i = *iline ;
 
   i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n\t ===== END OF README FILE ====== \n");
+  sprintf(cptr, "\t %s Range: %.2f to %.2f",
+	  INPUTS.GENMODEL, INPUTS.FIXMAG[0], INPUTS.FIXMAG[1] );
 
-  // ------
-  if ( i >= MXDOCLINE ) {
-    sprintf ( c1err, "%d README.DOC lines exceeds array bound of %d",
-	      i, MXDOCLINE );
-    sprintf ( c2err,"Increase parameter MXDOCLINE and re-make ");
-    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
-  }
+  *iline = i;
 
-  VERSION_INFO.NLINE_README  = i;
+} // end readme_doc_FIXMAG
 
+// **************************************
+void readme_doc_SALT2params(int *iline ) {
 
-}  // end of readme_doc
+  int i ;
+  char *cptr, string[40] ;
+  char star[2];
 
+  // ------------ BEGIN ---------
 
-// ********************************************
-void readme_doc_CUTWIN(int *iline) {
-  
-  int i, icut ;
-  char *cptr, ctmp[80] ;
-  // ---------- BEGIN ---------
+  if ( INDEX_GENMODEL != MODEL_SALT2 ) { return ; }
+
+  if ( strlen(INPUTS.SALT2mu_FILE) > 0 )   { sprintf(star,"*"); }
+  else { sprintf(star," "); }
 
   i = *iline ;
 
+  
   i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n  SOFTWARE CUTS: \n");
-
+  sprintf_GENGAUSS(cptr, "\t SALT2c", &INPUTS.GENGAUSS_SALT2c);
+  
   i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t EPOCH CUT: %5.0f Lambda(rest) < %5.0f A \n",
-	  INPUTS.EPCUTWIN_LAMREST[0], INPUTS.EPCUTWIN_LAMREST[1] );
+  sprintf(string, "\t Alpha%s", star);
+  sprintf_GENGAUSS(cptr, string, &INPUTS.GENGAUSS_SALT2ALPHA );
+  
 
   i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t EPOCH CUT: SNR >= %2.0f  \n",
-	  INPUTS.EPCUTWIN_SNRMIN[0] );
+  if ( INPUTS.SALT2BETA_cPOLY[0] > 0.0 ) { 
+    sprintf(cptr,"\t Beta = %.3f + %.3f*c + %.3f*c^2 "
+	    , INPUTS.SALT2BETA_cPOLY[0] 
+	    , INPUTS.SALT2BETA_cPOLY[1] 
+	    , INPUTS.SALT2BETA_cPOLY[2]  );
+  }
+  else {
+    sprintf(string, "\t Beta%s ", star);
+    sprintf_GENGAUSS(cptr, string, &INPUTS.GENGAUSS_SALT2BETA);
+  }
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t TrestMIN < %5.1f  &&  TrestMAX > %4.1f days \n",
-	  INPUTS.CUTWIN_TRESTMIN[1], INPUTS.CUTWIN_TRESTMAX[0] );
+  if ( strlen(INPUTS.SALT2mu_FILE) > 0 )   { 
+    i++; cptr = VERSION_INFO.README_DOC[i] ;
+    sprintf(cptr,"\t * Alpha,Beta read from a SALT2mu_FILE. \n");
+  }
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t Max TGAP(rest) <= %5.1f  days \n",
-	  INPUTS.CUTWIN_TGAPMAX[1] );
+  *iline = i ;
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t Max T0GAP(rest) <= %5.1f  days \n",
-	  INPUTS.CUTWIN_T0GAPMAX[1] );
+} // end of readme_doc_SALT2params
+ 
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t NOBS(MJDDIF > %3.1f) >= %2d \n",
-	  INPUTS.CUTWIN_MJDDIF[0], INPUTS.CUTWIN_NOBSDIF[0] );
+// **************************************
+void sprintf_GENGAUSS(char *string, char *name, 
+		      GENGAUSS_ASYM_DEF *genGauss) {
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t NEPOCH(SNR > %4.1f) >= %2.0f \n",
-	  INPUTS.CUTWIN_NEPOCH[1], INPUTS.CUTWIN_NEPOCH[0] ) ;
+  // write genGauss info to string
+  // Mar 16 2015: include new SKEW parameter.
+  // Aug 30 2016: check SKEWNORMAL
 
-  for ( icut=1; icut <= INPUTS.NCUTWIN_SNRMAX; icut++ ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t SNRMAX > %4.1f for %d of the '%s' filters "
-	    "(%5.1f < Trest < %5.1f) \n"
-	    , INPUTS.CUTWIN_SNRMAX[icut][0]
-	    , INPUTS.CUTWIN_SNRMAX_NFILT[icut]
-	    , INPUTS.CUTWIN_SNRMAX_FILTERS[icut]
-	    , INPUTS.CUTWIN_SNRMAX_TREST[icut][0]
-	    , INPUTS.CUTWIN_SNRMAX_TREST[icut][1]
-	    );
+  double s0, s1;
+  char cPEAK[80], cSIGMA[80], cSKEW[80], cRANGE[80];
+
+  // ------------------- BEGIN ---------------
+
+  sprintf(cPEAK,"Peak=%.2f", genGauss->PEAK);
+
+  s0 =  genGauss->SIGMA[0];
+  s1 =  genGauss->SIGMA[1];
+  if ( s0 < 1.0E5 || s1 < 1.0E5 ) {
+    sprintf(cSIGMA,"SIG-+= %.3f,%.3f", 
+	    genGauss->SIGMA[0], genGauss->SIGMA[1] );
+  }
+  else
+    { sprintf(cSIGMA,"SIG-+ > E5,E5"); }
+
+
+  if( genGauss->SKEWNORMAL[1] != 0.0 ) {
+    double *ptrSKEW = genGauss->SKEWNORMAL ;
+    sprintf(string,"%s: SKEWNORMAL(MEAN,SIG,SKEW) = %.3f, %.3f, %.3f\n",
+	    name, ptrSKEW[0], ptrSKEW[1], ptrSKEW[2] );
+  }
+  else {
+    sprintf(cSKEW,"SKEW=%.2f,%.2f",  
+	    genGauss->SKEW[0], genGauss->SKEW[1] );
+    
+    sprintf(cRANGE,"BND=%.2f,%.2f", 
+	    genGauss->RANGE[0], genGauss->RANGE[1] );
+    
+    sprintf(string,"%s: %s  %s  %s  %s\n"
+	    ,name, cPEAK, cSIGMA, cSKEW, cRANGE  );
   }
 
+  return ;
+
+} // sprintf_GENGAUSS
+
 
-  for ( icut=0; icut < INPUTS.NCUTWIN_SATURATE; icut++ ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t NOBS_SATURATE = %d to %d for each %s filter. \n"
-	    , INPUTS.CUTWIN_SATURATE_NOBS[icut][0]
-	    , INPUTS.CUTWIN_SATURATE_NOBS[icut][1]
-	    , INPUTS.CUTWIN_SATURATE_FILTERS[icut]	    );
-  }
-  for ( icut=0; icut < INPUTS.NCUTWIN_NOSATURATE; icut++ ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t NOBS_NOSATURATE = %d to %d for each %s filter. \n"
-	    , INPUTS.CUTWIN_NOSATURATE_NOBS[icut][0]
-	    , INPUTS.CUTWIN_NOSATURATE_NOBS[icut][1]
-	    , INPUTS.CUTWIN_NOSATURATE_FILTERS[icut]	    );
-  }
 
 
-  if ( INPUTS.NVAR_SIMGEN_DUMP > 0 ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(ctmp,"\t SIMGEN_DUMP file includes" );
-    if ( INPUTS.APPLY_CUTWIN_OPT  == 1 ) 
-      { sprintf(cptr,"%s SNe passing software cuts. \n", ctmp ); }
-    else 
-      { sprintf(cptr,"%s ALL SNe; use CUTMASK for software cuts.\n", ctmp); }
-    
-  }
+// ***************************************************
+void update_accept_counters(void) {
 
-  if ( INPUTS.CUTWIN_PEAKMAG[1] < 998.0 ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t PEAKMAG(All bands) :  %.1f - %.1f\n", 
-	    INPUTS.CUTWIN_PEAKMAG_ALL[0], INPUTS.CUTWIN_PEAKMAG_ALL[1] ) ;
-  }
+  // Created June 2017
+  // Called from main for accppted event, so here we
+  // increment various counters.
+  // Most code moved from main for cleanup.
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t PEAKMAG(any filter) < %3.1f \n", 
-	  INPUTS.CUTWIN_PEAKMAG[1] ) ;
+  int isp ;
+  char fnam[] = "update_accept_counters" ;
+
+  // -------------- BEGIN ---------------
+
+  // increment number of generated SN that are written
+  NGENLC_WRITE++ ;
+ 
   
-  for ( icut=1; icut <= INPUTS.NCUTWIN_PEAKMAG_BYFIELD; icut++ ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t PEAKMAG(%s): %.1f to %1.f \n", 
-	    INPUTS.CUTWIN_BYFIELDLIST[icut],
-	    INPUTS.CUTWIN_PEAKMAG_BYFIELD[icut][0],
-	    INPUTS.CUTWIN_PEAKMAG_BYFIELD[icut][1] );
+  // increment stats based on typing method
+  if ( GENLC.METHOD_TYPE == METHOD_TYPE_SPEC )    
+    { GENLC.NTYPE_SPEC_CUTS++ ; }   // spec-tags after cuts
+  if ( GENLC.METHOD_TYPE == METHOD_TYPE_PHOT ) { 
+    GENLC.NTYPE_PHOT_CUTS++ ;    // phot-tags after cuts   
+    if ( !GENLC.CORRECT_HOSTMATCH ) { GENLC.NTYPE_PHOT_WRONGHOST++; }
   }
-  
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t MWEBV <= %3.1f \n", INPUTS.CUTWIN_MWEBV[1] ) ;
-  
-  // optional cut on time above SNRMIN
-  if ( INPUTS.CUTWIN_EPOCHS_NFILT > 0 ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t Time < %.1f days for SNR(%s) > %.1f \n",
-	    INPUTS.CUTWIN_EPOCHS_TRANGE[1],
-	    INPUTS.CUTWIN_EPOCHS_FILTERS,
-	    INPUTS.CUTWIN_EPOCHS_SNRMIN );
+  // check screen update
+  if ( INPUTS.NGEN_LC > 0 )  { screen_update(); }
+      
+
+  // increment NGENWR per non1a index
+  if ( INPUTS.NON1ASED.NINDEX > 0  ) {
+    isp = GENLC.NON1ASED.ISPARSE;
+    GENLC.NON1ASED.NGENWR[isp]++; 
   }
 
-  // ------------
-  *iline  = i ;
+  // Jun 2017: check SUBSAMPLE_MARK option
+  double XN0, XN1;
+  int NTMP = INPUTS.NSUBSAMPLE_MARK ;
+  if ( NTMP > 1 ) {
+    XN0   = (double)NTMP ; 
+    XN1   = (double)NGENLC_WRITE ;
+    GENLC.SUBSAMPLE_INDEX = (int)fmod( XN1, XN0 ) ;
+  }
+  else {
+    GENLC.SUBSAMPLE_INDEX = -9 ;
+  }
 
-}  // end of readme_doc_CUTWIN
+  return ;
 
+} // end update_accept_counters
 
-// ********************************************
-void  readme_doc_TAKE_SPECTRUM(int *iline) {
+// ***************************************************
+void init_simFiles(SIMFILE_AUX_DEF *SIMFILE_AUX) {
 
-  // Mar 14 2017: 
-  // write TAKE_SPECTRUM info to readme file.
+  // May 28, 2009 R.Kessler
+  // Init auxiliary files create by sim program.
+  // Does NOT include special dump files where
+  // the sim quits after the dump.
   //
-  // Mar 23 2019: use GENPOLY typedefs and write WARP info
+  // Jun 2011: check option to call WR_SNFITSIO_INIT
+  //
+  // Feb 12, 2014: always call snlc_to_SNDATA(1) instead of only
+  //               for FITS format.
 
-  int N = NPEREVT_TAKE_SPECTRUM ;
-  int i, j , OPT_FRAME_EPOCH, OPT_TEXPOSE ;
-  float *ptrEP, *ptrLAM ;
-  char *cptr, Tname[20], name2[20], zpolyString[100], warpString[100] ;
-  GENPOLY_DEF *GENZPOLY_SNR, *GENZPOLY_TEXPOSE, *GENLAMPOLY_WARP; 
+  int i, isys ;
+  char headFile[MXPATHLEN];
+  char cmd[2*MXPATHLEN], prefix[2*MXPATHLEN];
+  char fnam[] = "init_simFiles" ;
 
-  // ------- BEGIN -------
+  // ------------ BEGIN -------------
 
-  if ( N == 0 ) { return ; }
 
-  i = *iline ;
-  
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n  TAKE_SPECTRUM: \n");
+  // always construct readme lines
+  readme_doc(1);    
 
-  
-  for(j=0; j < N; j++ ) {
+  // init DUMP file regardless of SNDATA file status
 
-    ptrEP    = INPUTS.TAKE_SPECTRUM[j].EPOCH_RANGE; 
-    ptrLAM   = INPUTS.TAKE_SPECTRUM[j].SNR_LAMRANGE ;
+  if ( INPUTS.FORMAT_MASK <= 0 ) {
+    sprintf(SIMFILE_AUX->DUMP,  "%s.DUMP",  INPUTS.GENVERSION );
+    sprintf(SIMFILE_AUX->TIMING,"%s.TIMING",INPUTS.GENVERSION );
+    wr_SIMGEN_DUMP(1,SIMFILE_AUX);  // always make DUMP file if requested
+    return ;
+  }
 
-    GENZPOLY_SNR     = &INPUTS.TAKE_SPECTRUM[j].GENZPOLY_SNR ;
-    GENZPOLY_TEXPOSE = &INPUTS.TAKE_SPECTRUM[j].GENZPOLY_TEXPOSE ;
-    GENLAMPOLY_WARP  = &INPUTS.TAKE_SPECTRUM[j].GENLAMPOLY_WARP ;
+  // clear out old GENVERSION files; 2nd arg is PROMPT flag
+  clr_VERSION(INPUTS.GENVERSION,INPUTS.CLEARPROMPT);
 
-    OPT_FRAME_EPOCH = INPUTS.TAKE_SPECTRUM[j].OPT_FRAME_EPOCH ;
-    OPT_TEXPOSE = INPUTS.TAKE_SPECTRUM[j].OPT_TEXPOSE ;
-    Tname[0] = name2[0] = zpolyString[0] = warpString[0] = 0 ;
+  // create new subdir for simulated SNDATA files
 
-    if ( OPT_FRAME_EPOCH == GENFRAME_REST ) 
-      { sprintf(Tname,"TREST"); }
-    else
-      { sprintf(Tname,"TOBS"); }
+  sprintf(cmd,"mkdir -m g+wr %s", PATH_SNDATA_SIM );
+  isys = system(cmd);
 
-    if ( OPT_TEXPOSE == 1 )  { 
-      sprintf(name2, "TEXPOSE" ); 
-      sprintf(zpolyString,"%s", GENZPOLY_TEXPOSE->STRING) ;
-    }
-    else { 
-      // sprintf(name2, "SNR(%.0f:%.0f)", ptrLAM[0], ptrLAM[1] ) ; 
-      sprintf(name2, "SNR" );
-      sprintf(zpolyString,"%s", GENZPOLY_SNR->STRING) ;
-    }
+  // create full names for auxilliary files,
+  // whether they are used or not.
 
-    if ( GENLAMPOLY_WARP->ORDER > 0 ) 
-      { sprintf(warpString,"WARP:%s", GENLAMPOLY_WARP->STRING ); }
+  sprintf(prefix,"%s/%s", PATH_SNDATA_SIM, INPUTS.GENVERSION );
 
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"    %s = %5.1f to %5.1f  "
-	    "  %s-zPOLY:%s  %s\n",
-	    Tname, ptrEP[0], ptrEP[1],
-	    name2, zpolyString, warpString );
+  // mandatory
+  sprintf(SIMFILE_AUX->LIST,       "%s.LIST",        prefix );
+  sprintf(SIMFILE_AUX->README,     "%s.README",      prefix );
+  sprintf(SIMFILE_AUX->IGNORE,     "%s.IGNORE",      prefix );
 
 
-    /* xxx mark delete xxxx
-    sprintf(cptr,"    %s = %5.1f to %5.1f  "
-	    "  %s zPOLY: %s \n",
-	    Tname, ptrEP[0], ptrEP[1],
-	    name2, zpolyString );
-    xxxx */
+  // optional
+  sprintf(SIMFILE_AUX->DUMP,       "%s.DUMP",        prefix );
+  sprintf(SIMFILE_AUX->TIMING,     "%s.TIMING",      prefix );
+  sprintf(SIMFILE_AUX->ZVAR,       "%s.ZVARIATION",  prefix );
+  sprintf(SIMFILE_AUX->GRIDGEN,    "%s.GRID",        prefix );
 
-  } // end j loop over spectra
 
-  *iline = i;
-  return ;
+  // create mandatory files.
+  SIMFILE_AUX->FP_LIST   = fopen(SIMFILE_AUX->LIST,   "wt") ;  
+  SIMFILE_AUX->FP_README = fopen(SIMFILE_AUX->README, "wt") ;  
+  SIMFILE_AUX->FP_IGNORE = fopen(SIMFILE_AUX->IGNORE, "wt") ;   
+  fclose(SIMFILE_AUX->FP_IGNORE);
 
-} // end readme_doc_TAKE_SPECTRUM
 
+  // dump out the README file
+  for ( i = 1; i <= VERSION_INFO.NLINE_README_INIT; i++ )
+    { fprintf(SIMFILE_AUX->FP_README, "%s", VERSION_INFO.README_DOC[i] ); }
 
-// ********************************************
-void readme_doc_FUDGES(int *iline) {
+  fflush(SIMFILE_AUX->FP_README);
 
-  // Created May 2014 (pulled from readme_doc)
+  // if FITRES DUMP-file is requested, open and init header
+  wr_SIMGEN_DUMP(1,SIMFILE_AUX);
   
-  int i, NLINE_FUDGE, j ;
-  char *cptr ;
-  char fudgeLine[10][100] ;
+  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID  ) {
+#ifdef SNGRIDGEN
+    init_GRIDsource(1); 
+    wr_GRIDfile(1,SIMFILE_AUX->GRIDGEN);
+#endif
+  }
 
-  // ------- BEGIN -------
-  i = *iline ;
+  snlc_to_SNDATA(1) ;  // 1 => load header only
 
-  NLINE_FUDGE = 0 ;
+  // check option for fits format (Jun 2011)
+  if ( WRFLAG_FITS ) { 
 
-  // create local comment lines based on used fudges.
+    // abort of any text-option is defined along with fits format
+    if ( WRFLAG_TEXT || WRFLAG_VBOSE ) {
+      sprintf(c1err, "Cannot mix TEXT and FITS format ; FORMAT_MASK=%d",
+	      INPUTS.FORMAT_MASK );
+      sprintf(c2err,"WRFLAG[TEXT,VBOSE,FITS] = %d, %d, %d",
+	      WRFLAG_TEXT, WRFLAG_VBOSE, WRFLAG_FITS );
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
+    }
 
-  if ( INPUTS.FUDGESCALE_SKYNOISE != 1.0 ) {
-    cptr = fudgeLine[NLINE_FUDGE] ;
-    sprintf(cptr,"\t Fudge-scale for SIMLIB NOISE(SKY) : %5.2f ", 
-	  INPUTS.FUDGESCALE_SKYNOISE);
-    NLINE_FUDGE++ ;
-  }
+    WR_SNFITSIO_INIT(PATH_SNDATA_SIM
+		     , INPUTS.GENVERSION
+		     , INPUTS.GENPREFIX
+		     , INPUTS.WRITE_MASK
+		     , INPUTS.NSUBSAMPLE_MARK
+		     , headFile); // <== return arg for list file
 
-  if ( INPUTS.FUDGESCALE_READNOISE != 1.0 ) {
-    cptr = fudgeLine[NLINE_FUDGE] ;
-    sprintf(cptr,"\t Fudge-scale for SIMLIB NOISE(CCD-read) : %5.2f ", 
-	  INPUTS.FUDGESCALE_READNOISE);
-    NLINE_FUDGE++ ;
+    fprintf(SIMFILE_AUX->FP_LIST,"%s", headFile);
   }
 
-  if ( INPUTS.FUDGESCALE_PSF != 1.0 ) {
-    cptr = fudgeLine[NLINE_FUDGE] ;
-    sprintf(cptr,"\t Fudge-scale for SIMLIB PSF      : %5.2f ", 
-	  INPUTS.FUDGESCALE_PSF);
-    NLINE_FUDGE++ ;
-  }
+  // write filter responses for non-SNANA programs
+  if ( WRFLAG_FILTERS ) 
+    { wr_SIMGEN_FILTERS(SIMFILE_AUX->PATH_FILTERS); }
+ 
+
+} // end of init_simFiles
+
+// ***********************************
+void update_simFiles(SIMFILE_AUX_DEF *SIMFILE_AUX) {
 
-  if ( INPUTS.FUDGESHIFT_ZPT != 0.0 ) {
-    cptr = fudgeLine[NLINE_FUDGE] ;
-    sprintf(cptr,"\t Fudge-shift for SIMLIB ZPT      : %5.2f ", 
-	  INPUTS.FUDGESHIFT_ZPT);
-    NLINE_FUDGE++ ;
-  }
+  // May 28, 2009: control output from here
+  // May 24, 2011: call snfitsio_update()
+  // Jan 23, 2014: remove call to append_SNDATA_MODEL();
+  //
+  // May 27, 2019: 
+  //  + call wr_SIMGEN_DUMP after snlc_to_SNDATA to allow for
+  //    things like PEAKMJD_SMEAR
+  //
+  // Oct 2026: NTHREAD_GEN worker sends FITS event (or LIST line for 
+  //           TEXT) to parent; parent calls this function with 
+  //           SIMTHREAD.REPLAY=1 to write the received SNDATA.
 
-  if ( INPUTS.FUDGE_MAGERR != 0.0 ) {
-    cptr = fudgeLine[NLINE_FUDGE] ;
-    sprintf(cptr,"\t Fudge MAGERR (add in quad)      : %6.4f ", 
-	  INPUTS.FUDGE_MAGERR);
-    NLINE_FUDGE++ ;
-  }
+  int  NEWMJD, CID    ;
+  char fnam[] = "update_simFiles";
 
-  if ( INPUTS.FUDGESCALE_FLUXERR != 1.0 ) {
-    cptr = fudgeLine[NLINE_FUDGE] ;
-    sprintf(cptr,"\t Fudge-scale for FLUX-ERROR      : %5.2f ", 
-	  INPUTS.FUDGESCALE_FLUXERR);
-    NLINE_FUDGE++ ;
-  }
+  // ------------ BEGIN -------------
 
-  if ( INPUTS.OPT_FUDGE_SNRMAX == 1 ) {
-    cptr = fudgeLine[NLINE_FUDGE] ;
-    sprintf(cptr,"\t FUDGE_SNRMAX    : %s  (adjust exposure time)",  
-	    INPUTS.STRING_FUDGE_SNRMAX);
-    NLINE_FUDGE++ ;
-  }
+  if ( SIMTHREAD.REPLAY ) { WR_SNFITSIO_UPDATE();  return ; }
 
-  if ( INPUTS.OPT_FUDGE_SNRMAX == 2 ) {
-    cptr = fudgeLine[NLINE_FUDGE] ;
-    sprintf(cptr,"\t FUDGE_SNRMAX    : %s  (adjust sky noise)",  
-	    INPUTS.STRING_FUDGE_SNRMAX);
-    NLINE_FUDGE++ ;
-  }
 
-  // ----------------------
-  // make README comment based on whether any of the fudges are used.
+#ifdef SNGRIDGEN
+  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID  ) {
+    update_GRIDarrays();
+    wr_GRIDfile(2,"");
+    return ;
+  }
+#endif
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  if( NLINE_FUDGE == 0 ) 
-    {  sprintf(cptr,"\n  Fudges on SIMLIB Seeing Conditions: NONE. \n"); }
+  if ( WRFLAG_CIDRAN == 0 ) 
+    { CID = GENLC.CID ; }
   else
-    {  sprintf(cptr,"\n  Fudges on SIMLIB Seeing Conditions: \n"); }
-
+    { CID = GENLC.CIDRAN ; }
 
-  // print summary of USED fudges only.
-  for(j=0; j < NLINE_FUDGE; j++ ) {
-    i++ ; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr, "%s\n", fudgeLine[j]);
+  if ( CID > MXCID_SIM  ) {
+    sprintf(c1err,"CID=%d exceeds MXCID_SIM=%d", GENLC.CID, MXCID_SIM );
+    errmsg(SEV_FATAL, 0, fnam, c1err, ""); 
   }
 
 
-  *iline = i;
+  // init SNDATA strucure
+  init_SNDATA() ; 
 
-  return ;
+  // load SNDATA structure
+  snlc_to_SNDATA(0) ;
 
-} // end readme_doc_FUDGES
+  // always fill DUMP file even if SNDATA files are not written
+  wr_SIMGEN_DUMP(2,SIMFILE_AUX);
 
+  if ( INPUTS.FORMAT_MASK <= 0 ) { return ; }
 
-// ********************************************
-void readme_doc_GENPERFECT(int *iline) {
+  if ( WRFLAG_FITS ) { 
+    if ( SIMTHREAD.ITHREAD > 0 ) 
+      { send_SIMTHREAD_EVENT(); }
+    else
+      { WR_SNFITSIO_UPDATE(); }
+    return ;
+  }
 
-  // April 2014
+  // below are the text-output options
 
-  int i, itmp ;
-  char *cptr, *PARNAME ;
-  double DPARVAL_ORIG, DPARVAL_USED ;
-  int    IPARVAL_ORIG, IPARVAL_USED ;
-  // --------- BEGIN ---------
+  NEWMJD = SNDATA.NEWMJD ; // save NEWMJD value
 
-  i = *iline ;
+  // check option to suppress verbose output
+  if ( WRFLAG_VBOSE == 0 ) { SNDATA.NEWMJD = 0; }
 
-  if ( GENPERFECT.NVAR <= 0 ) { return ; }
+      
+  // alawys write header, and write NEWMJD epochs if verbose format 
+  wr_SNDATA ( INPUTS.WRITE_MASK, 0 );
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n PERFECT LIGHTCURVES REQUESTED: \n");
-  
-  for ( itmp=1; itmp <= GENPERFECT.NVAR; itmp++ ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    
-    PARNAME      = GENPERFECT.parnam[itmp] ;
-    DPARVAL_ORIG = GENPERFECT.parval[itmp][0] ;
-    DPARVAL_USED = GENPERFECT.parval[itmp][1] ;
+  SNDATA.NEWMJD = NEWMJD ;   // restore NEWMJD
 
-    if ( GENPERFECT.partype[itmp] == 1 ) {
-      IPARVAL_ORIG = (int)DPARVAL_ORIG ;
-      IPARVAL_USED = (int)DPARVAL_USED ;
-      sprintf(cptr,"\t %-28.28s : %d -> %d \n",
-	      PARNAME, IPARVAL_ORIG, IPARVAL_USED );
-    }
-    else {
-      sprintf(cptr,"\t %-28.28s : %.5f -> %.5f \n" ,
-	      PARNAME, DPARVAL_ORIG, DPARVAL_USED );
-    }
+  // check option to append TERSE output at end of SNDATA file
+  if ( WRFLAG_TEXT > 0 ) { 
+    append_SNPHOT_TEXT() ; 
+    append_SNSPEC_TEXT() ;   // July 2016
   }
 
-  *iline = i;
-
-}  // end of readme_doc_GENPERFECT
+  // update LIST file (or let parent do it in CID order)
+  if ( SIMTHREAD.ITHREAD > 0 ) {
+    send_SIMTHREAD_packet(ITYPE_SIMTHREAD_LIST, 
+			  strlen(SNDATA.snfile_output)+1, 
+			  SNDATA.snfile_output); 
+  }
+  else
+    { fprintf(SIMFILE_AUX->FP_LIST,"%s\n", SNDATA.snfile_output); }
 
-// ********************************************
-void readme_doc_NON1ASED(int *iline) {
+} // end of upd_simFiles
 
-  // Created Feb 1 2017    [code moved out of readme_doc()]
-  //
-  // Print SEDs which have NGENTOT>0.
 
-  int i, j, NSKIP, isp, index, NINDEX ;
-  int NGENTOT, NGENWR, NGENUSR, CID0, CID1 ;
-  float eff;
-  char *cptr,  *ptrtype, ctmp[100], cline[200] ;
-  char fnam[] = "readme_doc_NON1ASED" ;
+// ***********************************
+void end_simFiles(SIMFILE_AUX_DEF *SIMFILE_AUX) {
 
-  // --------------- BEGIN --------------
+  // May 28, 2009
+  // close out auxiliary simfiles, and leave 1-line 
+  // summary to stdout for each aux file.
+  //
+  // Oct 16, 2010: print GRIDGEN summary if used
+  // Jun 09, 2012:  replace GRIDGEN stuff call to wr_GRIDfile(3);
+  // May 14, 2019: add call to wr_SIMGEN_DUMP(3,SIMFILE_AUX);
+  int i, N1, N2 ;
 
-  i = *iline ;
+  // ------------ BEGIN -------------
 
-  NINDEX = INPUTS.NON1ASED.NINDEX ;
+  // fill post-sim part of readme
+  readme_doc(2); 
 
-  sprintf(cline,
-	  " ---------------------------------------------------"
-	  "-------------------------\n");
 
-  // summarize user inputs
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n\n  NON1A USER INPUTS vs. INDEX: \n");
+  // always dump entire readme contents to screen
+  print_banner("DUMP README CONTENTS TO SCREEN\n");
+  for ( i = 1; i<= VERSION_INFO.NLINE_README; i++ )
+    printf("%s", VERSION_INFO.README_DOC[i] );
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr," INDEX(TYPE) " );
-  for ( j = 2; j <= INPUTS.NON1ASED.NKEY; j++ )
-    { sprintf(cptr,"%s %8s", cptr, INPUTS.NON1ASED.KEYLIST[j] ); }
-  strcat(cptr,"\n");
+  // ==========================================
+  // continue only if SNDATA files are written for each SN
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"%s", cline);
+  if ( INPUTS.FORMAT_MASK <= 0 ) return ;
 
-  for ( isp=1; isp <= NINDEX; isp++ ) {
-    index   = INPUTS.NON1ASED.INDEX[isp];
-    ptrtype = GENLC.NON1ASED.TYPE[isp];
-    NGENTOT = GENLC.NON1ASED.NGENTOT[isp];
-    if ( NGENTOT == 0 ) { continue ; }
+  // ==========================================
 
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr," %3.3d (%5s) ", index, ptrtype );
-    
-    for ( j = 2; j <= INPUTS.NON1ASED.NKEY; j++ )
-      { sprintf(cptr,"%s %8.3f", cptr, INPUTS.NON1ASED.KEYVAL[isp][j] ); }
-    
-    sprintf(cptr,"%s  %s\n", cptr,  INPUTS.NON1ASED.LIST_NAME[index] );
-  } // end isp loop
-  
-  // ----------------------------------------
-  // now summarize stats, effic, CID-range, peakmags ...
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n  NON1A-SUMMARY vs. INDEX: \n");
-  
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"                  NGEN    NGEN   SEARCH   \n");
-  
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr," INDEX(TYPE)      written total  Effic    CID-range \n" );
+  printf("\n  AUXILIARY FILES: \n");
+  printf("  %s \n", SIMFILE_AUX->LIST );
+  printf("  %s \n", SIMFILE_AUX->README );
 
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"%s", cline);
+  if ( WRFLAG_FILTERS ) 
+    { printf("  %s \n", SIMFILE_AUX->PATH_FILTERS ); }  // it's a subdir
 
-    for ( isp=1; isp <= NINDEX; isp++ ) {
-      index     = INPUTS.NON1ASED.INDEX[isp];
-      NGENTOT   = GENLC.NON1ASED.NGENTOT[isp];
-      NGENWR    = GENLC.NON1ASED.NGENWR[isp];
-      NGENUSR   = INPUTS.NON1ASED.NGEN[isp];
-      ptrtype   = GENLC.NON1ASED.TYPE[isp];
-      CID0      = GENLC.NON1ASED.CIDRANGE[isp][0];
-      CID1      = GENLC.NON1ASED.CIDRANGE[isp][1];
+  fflush(stdout);
 
-      if ( NGENTOT > 0 ) { eff = (float)NGENWR/(float)NGENTOT ; }
-      else               { eff = 0.0 ; continue ; }
-      
-      // glue together rest-frame peakmags
+  // dump post-sim part of readme to README file.
+  N1 = VERSION_INFO.NLINE_README_INIT + 1 ; 
+  N2 = VERSION_INFO.NLINE_README ; 
+  for ( i = N1; i <= N2; i++ )
+    {  fprintf(SIMFILE_AUX->FP_README, "%s", VERSION_INFO.README_DOC[i] ); }
 
-      ctmp[0] = 0 ;
-      i++; cptr = VERSION_INFO.README_DOC[i] ;
-      sprintf(cptr," %3.3d (%10s)  %4d  %5d   %5.3f %6d -%6d\n", 
-	      index, ptrtype, NGENWR, NGENTOT, eff, CID0, CID1 );
 
-      if ( NGENUSR != NGENWR  && INPUTS.NGEN_LC > 0 ) {
-	sprintf(c1err,"NGEN[NONIA index=%d]=%d, but expected NGEN=%d",
-		index, NGENWR, NGENUSR );
-	errmsg(SEV_WARN, 0, fnam, c1err, ""); 
-      }
+  // close files.
+  fclose(SIMFILE_AUX->FP_LIST);
+  fclose(SIMFILE_AUX->FP_README);
 
-    }  // end of isp loop
+  // check optional auxiliary files.
 
-  *iline = i;
+  // close out SIMGEN_DUMP file if it exists
+  if ( INPUTS.NVAR_SIMGEN_DUMP > 0 ) {
+    wr_SIMGEN_DUMP(3,SIMFILE_AUX);
+    // xxx mark delete    fclose(SIMFILE_AUX->FP_DUMP);
+    // xxx mark delete    printf("  %s \n", SIMFILE_AUX->DUMP );
+  }
 
-  return ;
 
-} // end readme_doc_NON1ASED
+  // copy ZVARATION file to SIM/[VERSION]
+  if ( USE_ZVAR_FILE ) {
+    cp_zvariation(SIMFILE_AUX->ZVAR);  
+    printf("  %s\n", SIMFILE_AUX->ZVAR);
+  }
 
+#ifdef SNGRIDGEN
+  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID ) {
+    printf("  %s\n", SIMFILE_AUX->GRIDGEN );
+    wr_GRIDfile(3,"");
+  }
+#endif
 
-// ********************************************
-void readme_doc_SIMLIB(int *iline) {
+  fflush(stdout);
+  if ( WRFLAG_FITS) { WR_SNFITSIO_END(); }
 
-  // add SIMLIB info to readme file.
-  int i, j, NSKIP ;
-  char *cptr, ctmp[100];
+} // end of end_simFiles
 
-  // ------------- BEGIN ---------------
 
-  i = *iline ;
+// ***********************************
+void prep_SIMTHREAD(void) {
 
-  // - - - - - - 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  if ( GENLC.SIMLIB_IDLOCK >= 0 ) 
-    { sprintf(ctmp,"Lock LIBID=%d", GENLC.SIMLIB_IDLOCK ); }
-  else
-    { sprintf(ctmp,"start at LIBID=%d", INPUTS.SIMLIB_IDSTART ); }
+  // Created Oct 2026
+  // Check NTHREAD_GEN input, and abort on options that cannot
+  // be split among forked workers (see fork_SIMTHREAD).
+  // Workers must reproduce the serial job, so every event must 
+  // depend only on ilc (RANDOM_COUNTER), and the number of tries 
+  // per ilc must not depend on the back end (GENMAG ... CUTWIN)
+  // that only the owner of ilc runs.
 
-  if ( INPUTS.SIMLIB_NREPEAT > 1 ) // Apr 26 2017
-    { sprintf(ctmp,"NREPEAT=%d", INPUTS.SIMLIB_NREPEAT ); } 
+  int NTHREAD = INPUTS.NTHREAD_GEN ;
+  int OVP ;
+  char fnam[] = "prep_SIMTHREAD" ;
 
-  sprintf(cptr,"\t SIMLIB filename  : %s (%s) \n", 
-	  INPUTS.SIMLIB_FILE, ctmp ); 
+  // ------------ BEGIN -------------
 
-  // - - - - - - 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t SIMLIB SURVEY    : %s  (TELESCOPE=%s, MINOBS=%d) \n", 
-	  GENLC.SURVEY_NAME, GENLC.TELESCOPE[0], INPUTS.SIMLIB_MINOBS  ); 
+  if ( NTHREAD <= 1 ) { INPUTS.NTHREAD_GEN = 1;  return ; }
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t SIMLIB UNITS     : %s for PSF,  %s for SKYSIG \n", 
-	  SIMLIB_GLOBAL_HEADER.PSF_UNIT, SIMLIB_GLOBAL_HEADER.SKYSIG_UNIT  ); 
+  // these options quit before generation, so nothing to split
+  if ( INPUTS.USEFLAG_DMPTREST || INPUTS.INIT_ONLY > 0 || 
+       INPUTS.SIMLIB_DUMP >= 0 ) {
+    printf("\t Turn off NTHREAD_GEN for dump/init-only job.\n");
+    INPUTS.NTHREAD_GEN = 1 ;
+    return ;
+  }
 
-  if ( INPUTS.SIMLIB_MSKOPT != 0 ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t SIMLIB MSKOPT   : %d \n", INPUTS.SIMLIB_MSKOPT );
+  if ( NTHREAD > MXTHREAD_GEN ) {
+    sprintf(c1err,"NTHREAD_GEN=%d exceeds bound of %d", 
+	    NTHREAD, MXTHREAD_GEN );
+    sprintf(c2err,"Reduce NTHREAD_GEN, or increase MXTHREAD_GEN");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );     
   }
 
-  double MINSEASON = INPUTS.SIMLIB_MINSEASON;
-  if ( MINSEASON > 0.01 ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t SIMLIB min season len : %.0f days", MINSEASON);
+  if ( GENLC.IFLAG_GENSOURCE != IFLAG_GENRANDOM ) {
+    sprintf(c1err,"NTHREAD_GEN=%d requires GENSOURCE=RANDOM", NTHREAD);
+    sprintf(c2err,"but GENSOURCE = %s", INPUTS.GENSOURCE );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );     
   }
- 
 
-  int NPE_SAT  = SIMLIB_GLOBAL_HEADER.NPE_PIXEL_SATURATE ;
-  int PHOTFLAG = SIMLIB_GLOBAL_HEADER.PHOTFLAG_SATURATE ;
-  if ( NPE_SAT < 999999999 ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t SIMLIB Saturation : %d pe in central pixel "
-	    "-> PHOTFLAG=%d\n",  NPE_SAT, PHOTFLAG);
+  if ( INPUTS.RANDOM_COUNTER == 0 ) {
+    sprintf(c1err,"NTHREAD_GEN=%d requires RANDOM_COUNTER: 1", NTHREAD);
+    sprintf(c2err,"so that each event depends only on ilc.");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );     
   }
 
-  if ( INPUTS.FUDGEOPT_FLUXERR ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t FUDGEOPT_FLUXERR : %d \n",
-	    INPUTS.FUDGEOPT_FLUXERR );
+  // rejected events are re-tried after the back end
+  if ( INPUTS.NGEN_LC > 0 ) {
+    sprintf(c1err,"NTHREAD_GEN=%d not allowed with NGEN_LC=%d", 
+	    NTHREAD, INPUTS.NGEN_LC );
+    sprintf(c2err,"Use NGENTOT_LC or NGEN_SEASON instead.");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );     
   }
 
-  if ( INPUTS.SIMLIB_IDLOCK > 1 ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t SIMLIB ID LOCKED to LIBID : %d \n", 
-	    GENLC.SIMLIB_IDLOCK ); 
+  // LCLIB events are read sequentially from one library file
+  if ( INDEX_GENMODEL == MODEL_LCLIB ) {
+    sprintf(c1err,"NTHREAD_GEN=%d not allowed for GENMODEL=LCLIB", NTHREAD);
+    sprintf(c2err,"Use batch jobs (sim_SNmix.pl) instead.");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );     
   }
-  if ( INPUTS.SIMLIB_IDLOCK == 1 ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t SIMLIB ID LOCKED to first accepted LIBID : %d \n", 
-	    GENLC.SIMLIB_IDLOCK ); 
+
+  // each worker has its own copy of the used-host list
+  if ( INPUTS.HOSTLIB_MSKOPT & HOSTLIB_MSKOPT_USEONCE ) {
+    sprintf(c1err,"NTHREAD_GEN=%d not allowed with HOSTLIB USEONCE", 
+	    NTHREAD);
+    sprintf(c2err,"because workers cannot share the list of used hosts.");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );     
   }
 
-  NSKIP = INPUTS.NSKIP_SIMLIB ;
-  if ( NSKIP > 0 ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t SIMLIB IDs skipped : " );
-    for ( j=0; j < NSKIP ; j++ ) {
-      sprintf(ctmp," %d", INPUTS.SIMLIB_IDSKIP[j] );
-      strcat(cptr, ctmp);
-    }
-    strcat ( cptr, "\n" );
+  // SIMLIB choice depends on previous accepted event
+  OVP = (INPUTS.SIMLIB_MSKOPT & SIMLIB_MSKOPT_REPEAT_UNTIL_ACCEPT );
+  if ( INPUTS.SIMLIB_IDLOCK == 1 || OVP > 0 ) {
+    sprintf(c1err,"NTHREAD_GEN=%d not allowed with SIMLIB_IDLOCK=1 "
+	    "or REPEAT_UNTIL_ACCEPT", NTHREAD);
+    sprintf(c2err,"because LIBID depends on previous accepted event.");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );     
   }
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\t NEWMJD_DIF       : "
-	  "%5.2f  minutes (defines trigger epoch)\n", 
-	  24.*60.*INPUTS.NEWMJD_DIF ); 
+  // FUDGE_SNRMAX re-generates each event after the back end,
+  // and SUBSAMPLE index depends on number of previous accepted events.
+  if ( INPUTS.OPT_FUDGE_SNRMAX != 0 || INPUTS.NSUBSAMPLE_MARK > 1 ) {
+    sprintf(c1err,"NTHREAD_GEN=%d not allowed with FUDGE_SNRMAX "
+	    "or NSUBSAMPLE_MARK", NTHREAD);
+    sprintf(c2err,"OPT_FUDGE_SNRMAX=%d  NSUBSAMPLE_MARK=%d", 
+	    INPUTS.OPT_FUDGE_SNRMAX, INPUTS.NSUBSAMPLE_MARK );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );     
+  }
 
-  *iline = i;
+  printf("\t Generate with NTHREAD_GEN = %d forked workers. \n", NTHREAD);
+  fflush(stdout);
 
+  return ;
 
-} // end of readme_doc_SIMLIB
+} // end prep_SIMTHREAD
 
 
-// *******************************
-void  readme_doc_magSmear(int *iline) {
+// ***********************************
+int fork_SIMTHREAD(void) {
+
+  // Created Oct 2026
+  // Fork NTHREAD_GEN worker processes after the full init and after
+  // the output files are opened, so that every worker inherits the 
+  // kcor, HOSTLIB, SIMLIB, model and SEARCHEFF init without re-reading
+  // anything, while having private copies of the per-event structures 
+  // (GENLC, SNHOSTGAL, SNDATA, random lists). Threads are not used 
+  // because nearly every generation stage writes to these global 
+  // structures.
+  //
+  // Each worker gets a pipe to send its events to the parent.
+  // The parent keeps a shadow copy of SNDATA & GENSPEC per worker
+  // so that workers only send the bytes that changed.
+  //
+  // Function returns worker index (1 to NTHREAD) to each worker, 
+  // and returns 0 to the parent.
+
+  int  NTHREAD  = INPUTS.NTHREAD_GEN ;
+  int  ILC_MIN, ILC_MAX, NGEN, t, fd[2] ;
+  int  NBYTE_SNDATA  = sizeof(SNDATA);
+  int  NBYTE_GENSPEC = sizeof(GENSPEC);
+  pid_t pid ;
+  char fnam[] = "fork_SIMTHREAD" ;
 
-  int i, j, ifilt, onoff;
-  char *cptr, ctmp[80] ;
-  char conoff[2][4] = { "OFF" , "ON" } ;
+  // ------------ BEGIN -------------
 
-  i = *iline ;
+  get_SIMSHARD_ILCRANGE(&ILC_MIN, &ILC_MAX);
+  NGEN = ILC_MAX - ILC_MIN + 1 ;
 
+  if ( NGEN < NTHREAD ) { NTHREAD = NGEN ; } // at least 1 event/worker
+  INPUTS.NTHREAD_GEN = SIMTHREAD.NTHREAD = NTHREAD ;
+  SIMTHREAD.ILC_MIN  = ILC_MIN ;
+  SIMTHREAD.ILC_MAX  = ILC_MAX ;
+  memcpy(SIMTHREAD.RANLAST, RANLAST, sizeof(RANLAST) );
 
-  // intrinsic smearing params
+  sprintf(BANNER,"%s: split %d events among %d workers", 
+	  fnam, NGEN, NTHREAD );
+  print_banner(BANNER);
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"\n  Intrinsic MAG-smearing models "
-	  "(sigma clip %4.1f to %4.1f) : \n"
-	  ,INPUTS.SIGMACLIP_MAGSMEAR[0]
-	  ,INPUTS.SIGMACLIP_MAGSMEAR[1]
-	  );
+  // The inherited fp_SIMLIB shares its file offset with the parent
+  // and all other workers, so each worker re-opens the SIMLIB and
+  // moves to the current position. A gunzip pipe cannot be re-opened
+  // at the same position. Binary SIMLIB (fmemopen) and SIMLIB_CACHE
+  // do not depend on a file offset.
+  SIMTHREAD.OFFSET_SIMLIB = -1 ;
+  if ( SIMLIB_CACHE.USE == 0 && SIMLIB_BIN.USE == 0 ) {
+    if ( INPUTS.SIMLIB_GZIPFLAG ) {
+      sprintf(c1err,"NTHREAD_GEN=%d cannot share gzipped SIMLIB", NTHREAD);
+      sprintf(c2err,"Unzip SIMLIB, or use SIMLIB_CACHE or binary SIMLIB");
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err );     
+    }
+    SIMTHREAD.OFFSET_SIMLIB = ftello(fp_SIMLIB);
+  }
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"   Model 1: Coherent MAG-smearing (GENMAG_SMEAR) : %6.3f  \n", 
-	  INPUTS.GENMAG_SMEAR);
+  for ( t=1; t <= NTHREAD; t++ ) {
+    SIMTHREAD.SHADOW_SNDATA[t] = SIMTHREAD.SHADOW_GENSPEC[t] = NULL ;
+    if ( !WRFLAG_FITS ) { continue ; }
+    SIMTHREAD.SHADOW_SNDATA[t]  = (char*) malloc(NBYTE_SNDATA);
+    SIMTHREAD.SHADOW_GENSPEC[t] = (char*) malloc(NBYTE_GENSPEC);
+    memcpy(SIMTHREAD.SHADOW_SNDATA[t],  &SNDATA,  NBYTE_SNDATA );
+    memcpy(SIMTHREAD.SHADOW_GENSPEC[t], &GENSPEC, NBYTE_GENSPEC );
+  }
 
+  // flush all buffers so that workers don't repeat buffered output
+  fflush(NULL);
 
-  onoff = 0;
-  if ( INPUTS.GENMODEL_ERRSCALE > 0.0 ) onoff=1; 
-  if ( INPUTS.NFILT_SMEAR       > 0   ) onoff=1; 
+  for ( t=1; t <= NTHREAD; t++ ) {
 
+    if ( pipe(fd) != 0 ) {
+      sprintf(c1err,"pipe failed for worker %d of %d", t, NTHREAD);
+      sprintf(c2err,"Try smaller NTHREAD_GEN");
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err );     
+    }
+#ifdef F_SETPIPE_SZ
+    fcntl(fd[1], F_SETPIPE_SZ, 1048576); // bigger buffer, if allowed
+#endif
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"   Model 2: passband MAG-smearing is %s \n", conoff[onoff] );
+    pid = fork();
+    if ( pid < 0 ) {
+      sprintf(c1err,"fork failed for worker %d of %d", t, NTHREAD);
+      sprintf(c2err,"Try smaller NTHREAD_GEN");
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err );     
+    }
+    if ( pid == 0 ) { 
+      close(fd[0]);
+      SIMTHREAD.FDPIPE[t] = fd[1] ;
+      init_SIMTHREAD_worker(t);  
+      return(t); 
+    }
 
-  if ( onoff > 0 ) {
-    if ( INPUTS.GENMODEL_ERRSCALE_OPT == 1 )  
-      { sprintf(ctmp,"PEAK"); }
-    else           
-      { sprintf(ctmp,"EPOCH-DEPENDENT"); }
+    close(fd[1]);
+    SIMTHREAD.FDPIPE[t] = fd[0] ;
+    SIMTHREAD.PID[t]    = pid ;
+  }
 
+  return(0) ;
 
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t Scale %s model errors (GENMODEL_ERRSCALE) : %6.3f  \n", 
-	    ctmp, INPUTS.GENMODEL_ERRSCALE );
+} // end fork_SIMTHREAD
 
-    if ( INPUTS.NFILT_SMEAR > 0 ) {
-      i++; cptr = VERSION_INFO.README_DOC[i] ;
-      sprintf(cptr,"\t Fixed ");
-      for ( j=1; j <= INPUTS.NFILT_SMEAR; j++ ) {
-	ifilt = INPUTS.IFILT_SMEAR[j]; 
-	sprintf(cptr, "%s%c", cptr, FILTERSTRING[ifilt] ) ;
-      }
-      strcat(cptr," mag-smear:");
 
-      for ( j=1; j <= INPUTS.NFILT_SMEAR; j++ ) {
-	ifilt = INPUTS.IFILT_SMEAR[j]; 
-	sprintf(cptr, "%s %4.2f", cptr, INPUTS.GENMAG_SMEAR_FILTER[ifilt] ) ;
-      }
-      strcat(cptr,"\n");
+// ***********************************
+void init_SIMTHREAD_worker(int ITHREAD) {
 
-    }
+  // Created Oct 2026
+  // Called by forked worker ITHREAD to 
+  //  + close pipes to other workers
+  //  + redirect stdout to [GENVERSION]_T[ITHREAD].LOG
+  //  + open private SIMLIB file handle at parent position.
+  // Randoms are not re-seeded: with RANDOM_COUNTER they depend only
+  // on ilc, so each worker generates exactly the serial events.
 
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t Correlation between models 1 & 2 : %5.2f \n",
-	    INPUTS.GENMODEL_ERRSCALE_CORRELATION );
+  int  NTHREAD = SIMTHREAD.NTHREAD ;
+  int  t ;
+  char logFile[MXPATHLEN];
+  char fnam[] = "init_SIMTHREAD_worker" ;
 
-  } // NFILT_SMEAR
+  // ------------ BEGIN -------------
 
-  // --------------------------------
-  // restlambda-dependent smearing using  GENMAG_SMEAR_MODELNAME
+  SIMTHREAD.ITHREAD = ITHREAD ;
+  for ( t=1; t < ITHREAD; t++ ) { close(SIMTHREAD.FDPIPE[t]); }
 
-  onoff = 0;   ctmp[0] = 0 ;
-  if ( istat_genSmear() > 0 ) { 
-    onoff=1; 
-    sprintf(ctmp,"%s", INPUTS.GENMAG_SMEAR_MODELNAME);
+  get_SIMTHREAD_LOGFILE(ITHREAD, logFile);
+  if ( freopen(logFile, "wt", stdout) == NULL ) {
+    sprintf(c1err,"Cannot open log file for worker %d", ITHREAD);
+    sprintf(c2err,"%s", logFile);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );         
   }
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"   Model 3: %s model-smear is %s  \n", 
-	  ctmp, conoff[onoff] );
 
-  // print override parameter names xxxgenmag
-  for(j=0; j < NSMEARPAR_OVERRIDE; j++ ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr, "\t    %s-Override :  %d values for %s\n" 
-	    , ctmp
-	    , GENMAG_SMEARPAR_OVERRIDE[j].NVAL
-	    , GENMAG_SMEARPAR_OVERRIDE[j].NAME );
+  sprintf(BANNER,"%s %d of %d  (back end for every %d-th ilc)", 
+	  fnam, ITHREAD, NTHREAD, NTHREAD );
+  print_banner(BANNER);
+
+  // Do not close the inherited handle: fclose would move the
+  // shared file offset.
+  if ( SIMTHREAD.OFFSET_SIMLIB >= 0 ) {
+    fp_SIMLIB = fopen(INPUTS.SIMLIB_OPENFILE, "rt");
+    if ( fp_SIMLIB == NULL ||
+	 fseeko(fp_SIMLIB, SIMTHREAD.OFFSET_SIMLIB, SEEK_SET) != 0 ) {
+      sprintf(c1err,"Cannot re-open SIMLIB for worker %d", ITHREAD);
+      sprintf(c2err,"%s", INPUTS.SIMLIB_OPENFILE);
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err );         
+    }
   }
 
-  // -------------------------
-  // model 4: intrinsic scatter matrix
+  fflush(stdout);
 
-  if ( INPUTS.NCOVMAT_SCATTER > 0 ) { onoff=1;} else { onoff=0;}
+  return ;
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"   Model 4: intrinsic scatter matrix is %s \n", 
-	  conoff[onoff] );
+} // end init_SIMTHREAD_worker
 
-  char *ptrScat; 
-  for ( j=0; j < 8; j++ ) {
-    ptrScat = GENLC.COVMAT_SCATTER_README[j] ;
-    if ( strlen(ptrScat) > 0 ) {
-      i++; cptr = VERSION_INFO.README_DOC[i] ;
-      sprintf(cptr,"%s\n", ptrScat ); 
-    }
-  }
 
-  
-  // model 5: SMEAR_USRFUN
-  if ( INPUTS.NPAR_GENSMEAR_USRFUN > 0 )  { onoff=1;} else { onoff=0;}
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr,"   Model 5: GENMAG_SMEAR_USRFUN is  %s \n", 
-	  conoff[onoff] );
-  
-  if ( onoff == 1 ) {
-    i++ ; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t FUNPAR[1-%d] = ", INPUTS.NPAR_GENSMEAR_USRFUN );
-    for ( j=0; j < INPUTS.NPAR_GENSMEAR_USRFUN; j++ )  { 
-      sprintf(ctmp,"%6.2f ", INPUTS.GENMAG_SMEAR_USRFUN[j] );  
-      cptr = strcat(cptr,ctmp);
-    }
-    cptr = strcat(cptr,"\n");
+// ***********************************
+void get_SIMTHREAD_LOGFILE(int ITHREAD, char *logFile) {
+
+  // Created Oct 2026
+  // Return name of log file for worker ITHREAD.
+
+  if ( INPUTS.FORMAT_MASK > 0 ) {
+    sprintf(logFile,"%s/%s_T%3.3d.LOG", 
+	    PATH_SNDATA_SIM, INPUTS.GENVERSION, ITHREAD );
   }
+  else
+    { sprintf(logFile,"%s_T%3.3d.LOG", INPUTS.GENVERSION, ITHREAD ); }
 
+} // end get_SIMTHREAD_LOGFILE
 
 
-  *iline = i;
-  return ;
+// ***********************************
+void set_SIMTHREAD_OWNER(int ilc) {
 
-} // end of readme_doc_magSmear
+  // Created Oct 2026
+  // Called at start of each try in main.
+  // Owner of ilc is worker (ilc-ILC_MIN)%NTHREAD + 1, so that the
+  // parent can read the events from the workers in ilc order.
+  // Serial job owns every ilc.
 
-// ***************************************
-void  readme_doc_nonLin(int *iline) {
+  int NTHREAD = SIMTHREAD.NTHREAD ;
+  int ITHREAD = SIMTHREAD.ITHREAD ;
 
-  int i,j;
-  char *cptr ;
-  // ------------- BEGIN ----------------
+  SIMTHREAD.ILC_TRY = ilc ;
+  if ( ITHREAD == 0 ) { SIMTHREAD.OWNER = 1 ;  return ; }
 
-  if ( NONLIN_README.NLINE == 0 ) { return ; }
+  SIMTHREAD.OWNER = ( (ilc-SIMTHREAD.ILC_MIN)%NTHREAD + 1 == ITHREAD );
 
-  i = *iline ;
+} // end set_SIMTHREAD_OWNER
 
-  for(j=0; j < NONLIN_README.NLINE; j++ ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"%s\n", NONLIN_README.LINE[j] );
-  }
 
-  *iline = i;
+// ***********************************
+void end_SIMTHREAD_ilc(int ilc) {
 
-  return ;
+  // Created Oct 2026
+  // Called at the end of each try in main.
+  // If this worker owns ilc, and ilc is not tried again (i.e., ilc
+  // was not decremented by gen_event_reject), tell parent that ilc 
+  // is done. Send RANLAST only if it changed.
 
-} // end readme_doc_nonLin
+  int NBYTE = (NLIST_RAN+1) * sizeof(double);
 
-// ***************************************
-void  readme_doc_SIMSED(int *iline) {
+  if ( SIMTHREAD.ITHREAD == 0 || !SIMTHREAD.OWNER ) { return ; }
+  if ( ilc != SIMTHREAD.ILC_TRY ) { return ; }
 
-  int i, ipar, iflag ;
-  char *cptr, ctmp[80], ctmp2[80] ;
+  if ( memcmp(SIMTHREAD.RANLAST, RANLAST, NBYTE) == 0 ) 
+    { NBYTE = 0 ; }
+  else
+    { memcpy(SIMTHREAD.RANLAST, RANLAST, NBYTE); }
 
-  i = *iline ;
+  send_SIMTHREAD_packet(ITYPE_SIMTHREAD_ENDILC, NBYTE, RANLAST);
 
-  if ( INPUTS.OPTMASK_SIMSED == OPTMASK_SIMSED_GRIDONLY ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;  
-    sprintf(cptr,"\n   %s model option is GRIDONLY & SEQUENTIAL \n", 
-	    INPUTS.MODELNAME );
-  } 
-  else if ( INPUTS.NPAR_SIMSED > 0  ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;  
-    sprintf(cptr,"\n   %s model parameters: \n", 
-	    INPUTS.MODELNAME );
+} // end end_SIMTHREAD_ilc
+
+
+// ***********************************
+void end_SIMTHREAD_worker(void) {
+
+  // Created Oct 2026
+  // Called by worker after the ilc loop: send summary counters
+  // to parent and exit without closing the output files that
+  // belong to the parent.
+
+  SIMTHREAD_SUMMARY_DEF SUMMARY ;
+  int i ;
+
+  // ------------ BEGIN -------------
+
+  memset(&SUMMARY, 0, sizeof(SUMMARY) );
+  SUMMARY.NGENLC_TOT           = NGENLC_TOT ;
+  SUMMARY.NGENLC_WRITE         = NGENLC_WRITE ;
+  SUMMARY.NGENSPEC_WRITE       = NGENSPEC_WRITE ;
+  SUMMARY.NGEN_ALLSKIP         = NGEN_ALLSKIP ;
+  SUMMARY.NTYPE_SPEC           = GENLC.NTYPE_SPEC ;
+  SUMMARY.NTYPE_SPEC_CUTS      = GENLC.NTYPE_SPEC_CUTS ;
+  SUMMARY.NTYPE_PHOT           = GENLC.NTYPE_PHOT ;
+  SUMMARY.NTYPE_PHOT_CUTS      = GENLC.NTYPE_PHOT_CUTS ;
+  SUMMARY.NTYPE_PHOT_WRONGHOST = GENLC.NTYPE_PHOT_WRONGHOST ;
+  SUMMARY.NGEN_REJECT          = NGEN_REJECT ;
+
+  for ( i=0; i < MXFILTINDX; i++ ) 
+    { SUMMARY.NAVWARP_OVERFLOW[i] = NAVWARP_OVERFLOW[i] ; }
+
+  for ( i=0; i < MXNON1A_TYPE; i++ ) {
+    SUMMARY.NGENWR_NON1ASED[i]  = GENLC.NON1ASED.NGENWR[i] ;
+    SUMMARY.NGENTOT_NON1ASED[i] = GENLC.NON1ASED.NGENTOT[i] ;
   }
 
+  for ( i=0; i < MXSTAGE_SIMTIME; i++ ) {
+    SUMMARY.NCALL[i]     = SIMTIME.NCALL[i] ;
+    SUMMARY.TSUM_WALL[i] = SIMTIME.TSUM_WALL[i] ;
+    SUMMARY.TSUM_CPU[i]  = SIMTIME.TSUM_CPU[i] ;
+  }
+  for ( i=0; i < MXOUT_SIMTIME; i++ ) {
+    SUMMARY.NEVT[i]      = SIMTIME.NEVT[i] ;
+    SUMMARY.TEVT_WALL[i] = SIMTIME.TEVT_WALL[i] ;
+    SUMMARY.TEVT_CPU[i]  = SIMTIME.TEVT_CPU[i] ;
+  }
+
+  send_SIMTHREAD_packet(ITYPE_SIMTHREAD_END, sizeof(SUMMARY), &SUMMARY);
+  close(SIMTHREAD.FDPIPE[SIMTHREAD.ITHREAD]);
+
+  printf("\n DONE with worker %d \n", SIMTHREAD.ITHREAD );
+  fflush(stdout);
+  _exit(0);
+
+} // end end_SIMTHREAD_worker
+
+
+// ***********************************
+void write_SIMTHREAD(SIMFILE_AUX_DEF *SIMFILE_AUX) {
+
+  // Created Oct 2026
+  // Parent after forking NTHREAD_GEN workers: loop over ilc in
+  // order, read the packets of each ilc from its owner, and write 
+  // them with the same functions as the serial job, so that the
+  // output is the same as for the serial job.
+
+  int  NTHREAD = SIMTHREAD.NTHREAD ;
+  int  ilc, t, ITYPE, NSPEC, LEN, MXBUF=0 ;
+  int  NBYTE_SNDATA  = sizeof(SNDATA);
+  int  NBYTE_GENSPEC = sizeof(GENSPEC);
+  char *BUF = NULL ;
+  SIMTHREAD_HEADER_DEF HEADER ;
+  char fnam[] = "write_SIMTHREAD" ;
 
-  for ( ipar = 0; ipar < INPUTS.NPAR_SIMSED; ipar++ ) {
+  // ------------ BEGIN -------------
 
-    iflag = INPUTS.GENFLAG_SIMSED[ipar];
+  for ( ilc = SIMTHREAD.ILC_MIN; ilc <= SIMTHREAD.ILC_MAX; ilc++ ) {
 
-    if ( (iflag & 1) == 0 ) 
-      { continue ; } // baggage
+    t = (ilc-SIMTHREAD.ILC_MIN)%NTHREAD + 1 ;
+    ITYPE = -9 ;
 
-    if ( (iflag & 4) > 0 ) 
-      { sprintf(ctmp, "GRIDONLY" ); }
-    else
-      { sprintf(ctmp, "contin." ); }
+    while ( ITYPE != ITYPE_SIMTHREAD_ENDILC ) {
 
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(ctmp2,"    %s(%s)", INPUTS.PARNAME_SIMSED[ipar], ctmp );
-    sprintf_GENGAUSS(cptr, ctmp2, &INPUTS.GENGAUSS_SIMSED[ipar] );
+      ITYPE = read_SIMTHREAD_packet(t, &HEADER, &BUF, &MXBUF);
 
-  }
+      if ( HEADER.ILC != ilc ) {
+	sprintf(c1err,"Worker %d sent ITYPE=%d for ilc=%d", 
+		t, ITYPE, HEADER.ILC );
+	sprintf(c2err,"but expected ilc=%d", ilc);
+	errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
+      }
 
+      if ( ITYPE == ITYPE_SIMTHREAD_SNDATA ) {
+	apply_SIMTHREAD_diff(BUF, HEADER.NBYTE, 
+			     SIMTHREAD.SHADOW_SNDATA[t], NBYTE_SNDATA);
+	memcpy(&SNDATA, SIMTHREAD.SHADOW_SNDATA[t], NBYTE_SNDATA);
+      }
+      else if ( ITYPE == ITYPE_SIMTHREAD_GENSPEC ) {
+	// GENSPEC pointers were malloced before fork, so they are
+	// the same for parent and workers.
+	apply_SIMTHREAD_diff(BUF, HEADER.NBYTE, 
+			     SIMTHREAD.SHADOW_GENSPEC[t], NBYTE_GENSPEC);
+	memcpy(&GENSPEC, SIMTHREAD.SHADOW_GENSPEC[t], NBYTE_GENSPEC);
+      }
+      else if ( ITYPE == ITYPE_SIMTHREAD_SPECFLUX ) 
+	{ copy_SIMTHREAD_SPECFLUX(BUF, HEADER.NBYTE, -1); }
 
-  *iline = i;
+      else if ( ITYPE == ITYPE_SIMTHREAD_EVENT ) {
+	SIMTHREAD.REPLAY = 1 ;
+	update_simFiles(SIMFILE_AUX);
+	SIMTHREAD.REPLAY = 0 ;
+      }
+      else if ( ITYPE == ITYPE_SIMTHREAD_DUMP ) {
+	NSPEC = NPEREVT_TAKE_SPECTRUM ;
+	LEN   = NSPEC * sizeof(int);
+	memcpy(GENSPEC.INDEX_TAKE_SPECTRUM, BUF, LEN);
+	sprintf(SIMFILE_AUX->OUTLINE, "%s", &BUF[LEN] );
+	SIMTHREAD.REPLAY = 1 ;
+	wr_SIMGEN_DUMP(2,SIMFILE_AUX);
+	SIMTHREAD.REPLAY = 0 ;
+      }
+      else if ( ITYPE == ITYPE_SIMTHREAD_LIST ) 
+	{ fprintf(SIMFILE_AUX->FP_LIST,"%s\n", BUF); }
 
-} // end of  readme_doc_SIMSED
+      else if ( ITYPE == ITYPE_SIMTHREAD_ENDILC ) {
+	if ( HEADER.NBYTE > 0 ) { memcpy(RANLAST, BUF, HEADER.NBYTE); }
+      }
+      else {
+	sprintf(c1err,"Invalid ITYPE=%d from worker %d at ilc=%d", 
+		ITYPE, t, ilc );
+	sprintf(c2err,"NBYTE=%d", HEADER.NBYTE );
+	errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
+      }
+    } // end ITYPE loop
 
-// *******************************
-void  readme_doc_MWXT(int *iline) {
+    if ( LUPDGEN(ilc-SIMTHREAD.ILC_MIN+1) ) {
+      printf("\t Finished writing ilc %8d of %d-%d \n", 
+	     ilc, SIMTHREAD.ILC_MIN, SIMTHREAD.ILC_MAX );
+      fflush(stdout);
+    }
 
-  int i ;
-  char *cptr ;
+  } // end ilc loop
 
-  i = *iline ;
-   
-  if ( INPUTS.MWEBV_FLAG ) {
+  end_SIMTHREAD(&BUF, &MXBUF);
 
-    i++; cptr = VERSION_INFO.README_DOC[i] ; 
-    sprintf(cptr, "\t MilkyWay extinction  is ON  \n" );
+  if ( BUF != NULL ) { free(BUF); }
 
-    i++; cptr = VERSION_INFO.README_DOC[i] ; 
-    sprintf(cptr, "\t    Color law: %s  (OPT_MWCOLORLAW=%d) \n",  
-	    INPUTS.STR_MWCOLORLAW, INPUTS.OPT_MWCOLORLAW );
+  return ;
 
+} // end write_SIMTHREAD
 
-    i++; cptr = VERSION_INFO.README_DOC[i] ; 
-    if ( INPUTS.GENRANGE_MWEBV[0] >= 0.0 ) {
-      sprintf(cptr, "\t    E(B-V) randomly picked between %.3f and %.3f\n",  
-	      INPUTS.GENRANGE_MWEBV[0], INPUTS.GENRANGE_MWEBV[1] );
-    }
-    else {
-      sprintf(cptr, "\t    E(B-V): %s   (OPT_MWEBV=%d)\n",  
-	      INPUTS.STR_MWEBV, INPUTS.OPT_MWEBV );
+
+// ***********************************
+void end_SIMTHREAD(char **BUF, int *MXBUF) {
+
+  // Created Oct 2026
+  // Called by parent after writing all events:
+  // read summary counters from each worker, wait for the workers, 
+  // and remove the worker LOG files if all workers succeeded.
+  // Counters of the back end are summed over workers; counters of 
+  // the front end (e.g., NGENLC_TOT) are the same in each worker.
+
+  int  NTHREAD = SIMTHREAD.NTHREAD ;
+  int  t, i, ITYPE, status, NFAIL=0 ;
+  SIMTHREAD_HEADER_DEF  HEADER ;
+  SIMTHREAD_SUMMARY_DEF SUMMARY ;
+  char logFile[MXPATHLEN];
+  char fnam[] = "end_SIMTHREAD" ;
+
+  // ------------ BEGIN -------------
+
+  for ( t=1; t <= NTHREAD; t++ ) {
+
+    ITYPE = read_SIMTHREAD_packet(t, &HEADER, BUF, MXBUF);
+    if ( ITYPE != ITYPE_SIMTHREAD_END || HEADER.NBYTE != sizeof(SUMMARY)){
+      sprintf(c1err,"Expected summary from worker %d, but got", t);
+      sprintf(c2err,"ITYPE=%d with NBYTE=%d", ITYPE, HEADER.NBYTE);
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
     }
+    memcpy(&SUMMARY, *BUF, sizeof(SUMMARY) );
+    close(SIMTHREAD.FDPIPE[t]);
 
-    i++; cptr = VERSION_INFO.README_DOC[i] ; 
-    sprintf(cptr, "\t    sigma(MWEBV) = %.2f*MWEBV + %.2f  \n", 
-	    INPUTS.MWEBV_SIGRATIO, INPUTS.MWEBV_SIG );
+    NGENLC_TOT                  = SUMMARY.NGENLC_TOT ;
+    NGEN_ALLSKIP                = SUMMARY.NGEN_ALLSKIP ;
+    NGENLC_WRITE               += SUMMARY.NGENLC_WRITE ;
+    NGENSPEC_WRITE             += SUMMARY.NGENSPEC_WRITE ;
+    GENLC.NTYPE_SPEC           += SUMMARY.NTYPE_SPEC ;
+    GENLC.NTYPE_SPEC_CUTS      += SUMMARY.NTYPE_SPEC_CUTS ;
+    GENLC.NTYPE_PHOT           += SUMMARY.NTYPE_PHOT ;
+    GENLC.NTYPE_PHOT_CUTS      += SUMMARY.NTYPE_PHOT_CUTS ;
+    GENLC.NTYPE_PHOT_WRONGHOST += SUMMARY.NTYPE_PHOT_WRONGHOST ;
 
-    i++; cptr = VERSION_INFO.README_DOC[i] ; 
-    sprintf(cptr, "\t    shift(MWEBV) = %5.3f mag \n", 
-	    INPUTS.MWEBV_SHIFT );
+    NGEN_REJECT.GENRANGE           += SUMMARY.NGEN_REJECT.GENRANGE ;
+    NGEN_REJECT.GENMAG             += SUMMARY.NGEN_REJECT.GENMAG ;
+    NGEN_REJECT.GENPAR_SELECT_FILE += SUMMARY.NGEN_REJECT.GENPAR_SELECT_FILE;
+    NGEN_REJECT.HOSTLIB            += SUMMARY.NGEN_REJECT.HOSTLIB ;
+    NGEN_REJECT.SEARCHEFF          += SUMMARY.NGEN_REJECT.SEARCHEFF ;
+    NGEN_REJECT.CUTWIN             += SUMMARY.NGEN_REJECT.CUTWIN ;
+    NGEN_REJECT.NEPOCH             += SUMMARY.NGEN_REJECT.NEPOCH ;
 
-    if ( INPUTS.APPLYFLAG_MWEBV ) {
-      i++; cptr = VERSION_INFO.README_DOC[i] ; 
-      sprintf(cptr, "\t    Correct dataFile FLUXCAL for MWEBV \n");
+    for ( i=0; i < MXFILTINDX; i++ ) 
+      { NAVWARP_OVERFLOW[i] += SUMMARY.NAVWARP_OVERFLOW[i] ; }
+
+    for ( i=0; i < MXNON1A_TYPE; i++ ) {
+      GENLC.NON1ASED.NGENWR[i] += SUMMARY.NGENWR_NON1ASED[i] ;
+      GENLC.NON1ASED.NGENTOT[i] = SUMMARY.NGENTOT_NON1ASED[i] ;
+    }
+
+    for ( i=0; i < MXSTAGE_SIMTIME; i++ ) {
+      SIMTIME.NCALL[i]     += SUMMARY.NCALL[i] ;
+      SIMTIME.TSUM_WALL[i] += SUMMARY.TSUM_WALL[i] ;
+      SIMTIME.TSUM_CPU[i]  += SUMMARY.TSUM_CPU[i] ;
+    }
+    for ( i=0; i < MXOUT_SIMTIME; i++ ) {
+      SIMTIME.NEVT[i]      += SUMMARY.NEVT[i] ;
+      SIMTIME.TEVT_WALL[i] += SUMMARY.TEVT_WALL[i] ;
+      SIMTIME.TEVT_CPU[i]  += SUMMARY.TEVT_CPU[i] ;
     }
-    
   }
-  else {
-    i++; cptr = VERSION_INFO.README_DOC[i] ; 
-    sprintf(cptr, "\t MilkyWay extinction  is OFF \n" );
+
+  for ( t=1; t <= NTHREAD; t++ ) {
+    waitpid(SIMTHREAD.PID[t], &status, 0);
+    if ( !WIFEXITED(status) || WEXITSTATUS(status) != 0 ) {
+      printf("  ERROR: worker %3d (pid=%d) failed; see %s_T%3.3d.LOG\n",
+	     t, (int)SIMTHREAD.PID[t], INPUTS.GENVERSION, t );
+      NFAIL++ ;
+    }
+    if ( WRFLAG_FITS ) {
+      free(SIMTHREAD.SHADOW_SNDATA[t]);
+      free(SIMTHREAD.SHADOW_GENSPEC[t]);
+    }
   }
 
-  *iline = i ;
+  if ( NFAIL > 0 ) {
+    sprintf(c1err,"%d of %d workers failed.", NFAIL, NTHREAD);
+    sprintf(c2err,"Check worker LOG files.");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
+  }
 
-} // end of readme_doc_MWXT
+  for ( t=1; t <= NTHREAD; t++ ) 
+    { get_SIMTHREAD_LOGFILE(t, logFile);  remove(logFile); }
 
-// *******************************
-void readme_doc_filterWarn(int *iline) {
+  printf("\t %d workers finished. \n", NTHREAD);
+  fflush(stdout);
 
-  double ZMIN, ZMAX;
-  int i, ifilt, ifilt_obs, NSKIP;
-  char *cptr, cfilt[2];
+  GENLC.STOPGEN_FLAG = geneff_calc();
 
-  i = *iline ;
+  return ;
 
-  for ( ifilt=0; ifilt < GENLC.NFILTDEF_OBS; ifilt++ ) {
-    ifilt_obs = GENLC.IFILTMAP_OBS[ifilt];
+} // end end_SIMTHREAD
 
-    sprintf(cfilt,"%c", FILTERSTRING[ifilt_obs] ); 
-    NSKIP = NSKIP_FILTER[ifilt_obs] ;
-    ZMIN  = ZVALID_FILTER[0][ifilt_obs] ;
-    ZMAX  = ZVALID_FILTER[1][ifilt_obs] ;
 
-    if ( NSKIP > 0 && ZMIN > 100. ) {
-      i++; cptr = VERSION_INFO.README_DOC[i] ;
-      sprintf(cptr,"\t FILTER-WARNING: %s not generated for any z-range. \n", 
-	      cfilt);
-    }
+// ***********************************
+void send_SIMTHREAD_packet(int ITYPE, int NBYTE, void *PTR) {
 
-    if ( NSKIP > 0 && ZMIN < 10. ) {
-      i++; cptr = VERSION_INFO.README_DOC[i] ;
-      sprintf(cptr,"\t FILTER-WARNING: %s generated only for %5.3f < z < %5.3f\n",
-	      cfilt, ZMIN, ZMAX );       
-    }
+  // Created Oct 2026
+  // Worker sends packet header, and NBYTE payload from PTR
+  // (PTR=NULL => caller sends payload).
 
-  }
+  SIMTHREAD_HEADER_DEF HEADER ;
 
-  *iline = i;
+  HEADER.ITYPE = ITYPE ;
+  HEADER.ILC   = SIMTHREAD.ILC_TRY ;
+  HEADER.NBYTE = NBYTE ;
+  write_SIMTHREAD_bytes(&HEADER, sizeof(HEADER) );
+  if ( NBYTE > 0 && PTR != NULL ) { write_SIMTHREAD_bytes(PTR, NBYTE); }
 
-} // end of readme_doc_filterWarn
+} // end send_SIMTHREAD_packet
 
 
-// *******************************
-void readme_doc_hostxt(int *iline) {
+// ***********************************
+void send_SIMTHREAD_diff(int ITYPE, void *PTR, char *SHADOW, int NBYTE) {
 
-  // add host extinction info to README 
+  // Created Oct 2026
+  // Compare NBYTE struct at PTR with SHADOW copy (last struct sent)
+  // in blocks of NBYTE_BLOCK_SIMTHREAD, and send each range of 
+  // changed blocks as [OFFSET, LEN, bytes]. Update SHADOW.
+  // SNDATA is ~0.8 MB, but most of it is unchanged between events.
 
-  int i;
-  int LDMP_HOSTXT, USE_AV ;
-  char *cptr, cEXPON[40], cGAUSS[40] ;
+  static char *BUF = NULL ;
+  static int   MXBUF = 0 ;
+  char *P = (char*)PTR ;
+  int  NBLK = NBYTE_BLOCK_SIMTHREAD, NINT = 2*sizeof(int) ;
+  int  OFF, OFF0, LEN, NBUF = 0, MXBUF_NEED ;
 
-  // ------------ BEGIN --------------
+  // ------------ BEGIN -------------
 
-  i = *iline ;
+  MXBUF_NEED = NBYTE + (NBYTE/NBLK + 1)*NINT ;
+  if ( MXBUF < MXBUF_NEED ) {
+    BUF   = (char*) realloc(BUF, MXBUF_NEED);
+    MXBUF = MXBUF_NEED ;
+  }
 
-  LDMP_HOSTXT = 
-    ( GENFRAME_OPT   == GENFRAME_REST ) ||
-    ( INPUTS.NON1A_MODELFLAG > 0 )  ;
+  OFF = 0 ;
+  while ( OFF < NBYTE ) {
+    LEN = ( NBYTE-OFF < NBLK ) ? NBYTE-OFF : NBLK ;
+    if ( memcmp(&P[OFF], &SHADOW[OFF], LEN) == 0 ) { OFF += LEN; continue; }
 
-  USE_AV = 
-    (INPUTS.GENRANGE_AV[1] > 1.0E-9 ) &&
-    (INPUTS.GENEXPTAU_AV   > 1.0E-9  || INPUTS.GENGAUSIG_AV > 1.0E-9 ) ;
+    // extend range over consecutive changed blocks
+    OFF0 = OFF ;
+    while ( OFF < NBYTE ) {
+      LEN = ( NBYTE-OFF < NBLK ) ? NBYTE-OFF : NBLK ;
+      if ( memcmp(&P[OFF], &SHADOW[OFF], LEN) == 0 ) { break; }
+      OFF += LEN ;
+    }
+    LEN = OFF - OFF0 ;
 
-  if ( LDMP_HOSTXT && (USE_AV==0)  ) {
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\n  Host Extinction Parameters: NONE  (AV=0) \n");    
+    memcpy(&BUF[NBUF], &OFF0, sizeof(int));  NBUF += sizeof(int);
+    memcpy(&BUF[NBUF], &LEN,  sizeof(int));  NBUF += sizeof(int);
+    memcpy(&BUF[NBUF], &P[OFF0], LEN);       NBUF += LEN ;
+    memcpy(&SHADOW[OFF0], &P[OFF0], LEN);
   }
 
-  if ( LDMP_HOSTXT && USE_AV  ) {
+  send_SIMTHREAD_packet(ITYPE, NBUF, BUF);
 
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\n  Host Extinction Parameters: \n");
+} // end send_SIMTHREAD_diff
 
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf_GENGAUSS(cptr, "\t RV ", &INPUTS.GENGAUSS_RV);
 
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t Gen-Range for AV  : %4.2f to %4.2f  (model=%s) \n", 
-	    INPUTS.GENRANGE_AV[0], INPUTS.GENRANGE_AV[1], INPUTS.GENSNXT );
-  
+// ***********************************
+void apply_SIMTHREAD_diff(char *BUF, int NBYTE_BUF, char *SHADOW, 
+			  int NBYTE) {
 
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    if ( INPUTS.GENEXPTAU_AV < 50.0 ) {
+  // Created Oct 2026
+  // Parent applies [OFFSET, LEN, bytes] ranges from send_SIMTHREAD_diff
+  // to SHADOW copy of NBYTE struct.
 
-      cEXPON[0] = 0 ;
-      cGAUSS[0] = 0 ;
-      if ( INPUTS.GENEXPTAU_AV > 1.0E-9 ) 
-	{ sprintf(cEXPON,"exp(-AV/%4.2f)/tau", 
-		  INPUTS.GENEXPTAU_AV ); 
-	}
-      if ( INPUTS.GENGAUSIG_AV > 1.0E-9 ) 
-	{ sprintf(cGAUSS,"%4.2f x Gauss(AV,sig=%4.2f)",
-		  INPUTS.GENRATIO_AV0, INPUTS.GENGAUSIG_AV ); 
-	}
+  int  NBUF = 0, OFF, LEN ;
+  char fnam[] = "apply_SIMTHREAD_diff" ;
 
-      sprintf(cptr,"\t dN/dAv = %s + %s \n", cEXPON, cGAUSS ); 
-    }
-    else  { 
-      sprintf(cptr,"\t dN/dAv = flat \n");  // Rodney request (Oct 2012)
+  while ( NBUF < NBYTE_BUF ) {
+    memcpy(&OFF, &BUF[NBUF], sizeof(int));  NBUF += sizeof(int);
+    memcpy(&LEN, &BUF[NBUF], sizeof(int));  NBUF += sizeof(int);
+    if ( OFF < 0 || LEN < 0 || OFF+LEN > NBYTE || NBUF+LEN > NBYTE_BUF ) {
+      sprintf(c1err,"Invalid OFFSET=%d LEN=%d for NBYTE=%d", 
+	      OFF, LEN, NBYTE);
+      sprintf(c2err,"NBUF=%d of %d", NBUF, NBYTE_BUF);
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
     }
+    memcpy(&SHADOW[OFF], &BUF[NBUF], LEN);  NBUF += LEN ;
+  }
 
-  }  // end of SALT2/color/dust if-block
+} // end apply_SIMTHREAD_diff
 
 
-  *iline = i ;
+// ***********************************
+void send_SIMTHREAD_EVENT(void) {
 
-} // end of readme_doc_hostxt
+  // Created Oct 2026
+  // Worker sends accepted event for FITS output: changed bytes of 
+  // SNDATA (and GENSPEC), the spectra that are written to the FITS 
+  // file, and then EVENT to tell parent to write.
 
+  int ITHREAD = SIMTHREAD.ITHREAD ;
 
-// **************************************
-void readme_doc_FIXMAG(int *iline ) {
+  send_SIMTHREAD_diff(ITYPE_SIMTHREAD_SNDATA, &SNDATA, 
+		      SIMTHREAD.SHADOW_SNDATA[ITHREAD], sizeof(SNDATA) );
 
-  int i ;
-  char *cptr ;
+  if ( SNFITSIO_SIMFLAG_SPECTROGRAPH ) {
+    send_SIMTHREAD_diff(ITYPE_SIMTHREAD_GENSPEC, &GENSPEC, 
+			SIMTHREAD.SHADOW_GENSPEC[ITHREAD], sizeof(GENSPEC));
+    copy_SIMTHREAD_SPECFLUX(NULL, 0, SIMTHREAD.FDPIPE[ITHREAD]);
+  }
 
-  if ( INDEX_GENMODEL != MODEL_FIXMAG ) { return ; }
+  send_SIMTHREAD_packet(ITYPE_SIMTHREAD_EVENT, 0, NULL);
 
-  i = *iline ;
+} // end send_SIMTHREAD_EVENT
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(cptr, "\t %s Range: %.2f to %.2f",
-	  INPUTS.GENMODEL, INPUTS.FIXMAG[0], INPUTS.FIXMAG[1] );
 
-  *iline = i;
+// ***********************************
+void copy_SIMTHREAD_SPECFLUX(char *BUF, int NBYTE_BUF, int FD) {
 
-} // end readme_doc_FIXMAG
+  // Created Oct 2026
+  // FD >= 0 : worker sends GENSPEC arrays used by wr_snfitsio_update_spec
+  // FD <  0 : parent copies these arrays from BUF into GENSPEC.
 
-// **************************************
-void readme_doc_SALT2params(int *iline ) {
+  int  NMJD  = GENSPEC.NMJD_TOT ;
+  int  NBLAM = GENSPEC.NBLAM_TOT ;
+  int  NBYTE = NBLAM * sizeof(double);
+  int  imjd, iarr, NBUF = 0 ;
+  double *ARR[5] ;
+  char fnam[] = "copy_SIMTHREAD_SPECFLUX" ;
 
-  int i ;
-  char *cptr, string[40] ;
-  char star[2];
+  // ------------ BEGIN -------------
 
-  // ------------ BEGIN ---------
+  if ( FD >= 0 ) 
+    { send_SIMTHREAD_packet(ITYPE_SIMTHREAD_SPECFLUX, 5*NMJD*NBYTE, NULL); }
+  else if ( NBYTE_BUF != 5*NMJD*NBYTE ) {
+    sprintf(c1err,"Received %d bytes of spectra", NBYTE_BUF);
+    sprintf(c2err,"but expected 5 x NMJD(%d) x NBLAM(%d) doubles",
+	    NMJD, NBLAM);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
+  }
+
+  for ( imjd=0; imjd < NMJD; imjd++ ) {
+    ARR[0] = GENSPEC.GENFLAM_LIST[imjd] ;
+    ARR[1] = GENSPEC.GENMAG_LIST[imjd] ;
+    ARR[2] = GENSPEC.FLAM_LIST[imjd] ;
+    ARR[3] = GENSPEC.FLAMERR_LIST[imjd] ;
+    ARR[4] = GENSPEC.FLAMWARP_LIST[imjd] ;
+    for ( iarr=0; iarr < 5; iarr++ ) {
+      if ( FD >= 0 ) 
+	{ write_SIMTHREAD_bytes(ARR[iarr], NBYTE); }
+      else
+	{ memcpy(ARR[iarr], &BUF[NBUF], NBYTE);  NBUF += NBYTE ; }
+    }
+  }
 
-  if ( INDEX_GENMODEL != MODEL_SALT2 ) { return ; }
+} // end copy_SIMTHREAD_SPECFLUX
 
-  if ( strlen(INPUTS.SALT2mu_FILE) > 0 )   { sprintf(star,"*"); }
-  else { sprintf(star," "); }
 
-  i = *iline ;
+// ***********************************
+void write_SIMTHREAD_bytes(void *PTR, int NBYTE) {
 
-  
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf_GENGAUSS(cptr, "\t SALT2c", &INPUTS.GENGAUSS_SALT2c);
-  
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  sprintf(string, "\t Alpha%s", star);
-  sprintf_GENGAUSS(cptr, string, &INPUTS.GENGAUSS_SALT2ALPHA );
-  
+  // Created Oct 2026
+  // Worker writes NBYTE to its pipe; abort on error.
 
-  i++; cptr = VERSION_INFO.README_DOC[i] ;
-  if ( INPUTS.SALT2BETA_cPOLY[0] > 0.0 ) { 
-    sprintf(cptr,"\t Beta = %.3f + %.3f*c + %.3f*c^2 "
-	    , INPUTS.SALT2BETA_cPOLY[0] 
-	    , INPUTS.SALT2BETA_cPOLY[1] 
-	    , INPUTS.SALT2BETA_cPOLY[2]  );
-  }
-  else {
-    sprintf(string, "\t Beta%s ", star);
-    sprintf_GENGAUSS(cptr, string, &INPUTS.GENGAUSS_SALT2BETA);
-  }
+  int  FD = SIMTHREAD.FDPIPE[SIMTHREAD.ITHREAD] ;
+  char *P = (char*)PTR ;
+  ssize_t N ;
+  char fnam[] = "write_SIMTHREAD_bytes" ;
 
-  if ( strlen(INPUTS.SALT2mu_FILE) > 0 )   { 
-    i++; cptr = VERSION_INFO.README_DOC[i] ;
-    sprintf(cptr,"\t * Alpha,Beta read from a SALT2mu_FILE. \n");
+  while ( NBYTE > 0 ) {
+    N = write(FD, P, NBYTE);
+    if ( N < 0 && errno == EINTR ) { continue ; }
+    if ( N <= 0 ) {
+      sprintf(c1err,"Worker %d cannot write to parent", SIMTHREAD.ITHREAD);
+      sprintf(c2err,"errno=%d (%s)", errno, strerror(errno) );
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
+    }
+    P += N ;  NBYTE -= N ;
   }
 
-  *iline = i ;
-
-} // end of readme_doc_SALT2params
- 
-
-// **************************************
-void sprintf_GENGAUSS(char *string, char *name, 
-		      GENGAUSS_ASYM_DEF *genGauss) {
+} // end write_SIMTHREAD_bytes
 
-  // write genGauss info to string
-  // Mar 16 2015: include new SKEW parameter.
-  // Aug 30 2016: check SKEWNORMAL
 
-  double s0, s1;
-  char cPEAK[80], cSIGMA[80], cSKEW[80], cRANGE[80];
+// ***********************************
+int read_SIMTHREAD_packet(int ITHREAD, SIMTHREAD_HEADER_DEF *HEADER, 
+			  char **BUF, int *MXBUF) {
 
-  // ------------------- BEGIN ---------------
+  // Created Oct 2026
+  // Parent reads next packet from worker ITHREAD: header, and payload
+  // into *BUF (realloc if needed). Returns ITYPE.
 
-  sprintf(cPEAK,"Peak=%.2f", genGauss->PEAK);
+  read_SIMTHREAD_bytes(ITHREAD, HEADER, sizeof(SIMTHREAD_HEADER_DEF) );
 
-  s0 =  genGauss->SIGMA[0];
-  s1 =  genGauss->SIGMA[1];
-  if ( s0 < 1.0E5 || s1 < 1.0E5 ) {
-    sprintf(cSIGMA,"SIG-+= %.3f,%.3f", 
-	    genGauss->SIGMA[0], genGauss->SIGMA[1] );
+  if ( HEADER->NBYTE > *MXBUF ) {
+    *BUF   = (char*) realloc(*BUF, HEADER->NBYTE);
+    *MXBUF = HEADER->NBYTE ;
   }
-  else
-    { sprintf(cSIGMA,"SIG-+ > E5,E5"); }
+  if ( HEADER->NBYTE > 0 ) 
+    { read_SIMTHREAD_bytes(ITHREAD, *BUF, HEADER->NBYTE); }
 
+  return(HEADER->ITYPE) ;
 
-  if( genGauss->SKEWNORMAL[1] != 0.0 ) {
-    double *ptrSKEW = genGauss->SKEWNORMAL ;
-    sprintf(string,"%s: SKEWNORMAL(MEAN,SIG,SKEW) = %.3f, %.3f, %.3f\n",
-	    name, ptrSKEW[0], ptrSKEW[1], ptrSKEW[2] );
-  }
-  else {
-    sprintf(cSKEW,"SKEW=%.2f,%.2f",  
-	    genGauss->SKEW[0], genGauss->SKEW[1] );
-    
-    sprintf(cRANGE,"BND=%.2f,%.2f", 
-	    genGauss->RANGE[0], genGauss->RANGE[1] );
-    
-    sprintf(string,"%s: %s  %s  %s  %s\n"
-	    ,name, cPEAK, cSIGMA, cSKEW, cRANGE  );
-  }
+} // end read_SIMTHREAD_packet
 
-  return ;
 
-} // sprintf_GENGAUSS
+// ***********************************
+void read_SIMTHREAD_bytes(int ITHREAD, void *PTR, int NBYTE) {
 
+  // Created Oct 2026
+  // Parent reads NBYTE from pipe of worker ITHREAD.
+  // Abort if worker quits (EOF) before sending all bytes.
 
+  int  FD = SIMTHREAD.FDPIPE[ITHREAD] ;
+  char *P = (char*)PTR ;
+  ssize_t N ;
+  char logFile[MXPATHLEN];
+  char fnam[] = "read_SIMTHREAD_bytes" ;
 
+  while ( NBYTE > 0 ) {
+    N = read(FD, P, NBYTE);
+    if ( N < 0 && errno == EINTR ) { continue ; }
+    if ( N <= 0 ) {
+      get_SIMTHREAD_LOGFILE(ITHREAD, logFile);
+      sprintf(c1err,"Worker %d quit before sending all events.", ITHREAD);
+      sprintf(c2err,"Check %s", logFile);
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
+    }
+    P += N ;  NBYTE -= N ;
+  }
 
-// ***************************************************
-void update_accept_counters(void) {
+} // end read_SIMTHREAD_bytes
 
-  // Created June 2017
-  // Called from main for accppted event, so here we
-  // increment various counters.
-  // Most code moved from main for cleanup.
 
-  int isp ;
-  char fnam[] = "update_accept_counters" ;
+// ***********************************
+void parse_SIMSHARD_arg(int iarg) {
 
-  // -------------- BEGIN ---------------
+  // Created Oct 2026
+  // Parse command-line '--shard ISHARD/NSHARD' starting at
+  // ARGV_LIST[iarg], and mark both args as used.
 
-  // increment number of generated SN that are written
-  NGENLC_WRITE++ ;
- 
-  
-  // increment stats based on typing method
-  if ( GENLC.METHOD_TYPE == METHOD_TYPE_SPEC )    
-    { GENLC.NTYPE_SPEC_CUTS++ ; }   // spec-tags after cuts
-  if ( GENLC.METHOD_TYPE == METHOD_TYPE_PHOT ) { 
-    GENLC.NTYPE_PHOT_CUTS++ ;    // phot-tags after cuts   
-    if ( !GENLC.CORRECT_HOSTMATCH ) { GENLC.NTYPE_PHOT_WRONGHOST++; }
-  }
-  // check screen update
-  if ( INPUTS.NGEN_LC > 0 )  { screen_update(); }
-      
+  char *cshard ;
+  char fnam[] = "parse_SIMSHARD_arg" ;
 
-  // increment NGENWR per non1a index
-  if ( INPUTS.NON1ASED.NINDEX > 0  ) {
-    isp = GENLC.NON1ASED.ISPARSE;
-    GENLC.NON1ASED.NGENWR[isp]++; 
-  }
+  // ------------ BEGIN -------------
 
-  // Jun 2017: check SUBSAMPLE_MARK option
-  double XN0, XN1;
-  int NTMP = INPUTS.NSUBSAMPLE_MARK ;
-  if ( NTMP > 1 ) {
-    XN0   = (double)NTMP ; 
-    XN1   = (double)NGENLC_WRITE ;
-    GENLC.SUBSAMPLE_INDEX = (int)fmod( XN1, XN0 ) ;
+  if ( iarg+1 >= NARGV_LIST ) {
+    sprintf(c1err,"Missing ISHARD/NSHARD after --shard");
+    sprintf(c2err,"Example: snlc_sim.exe myInput.input --shard 3/10");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );     
   }
-  else {
-    GENLC.SUBSAMPLE_INDEX = -9 ;
+
+  cshard = ARGV_LIST[iarg+1] ;
+  if ( sscanf(cshard, "%d/%d", &SIMSHARD.ISHARD, &SIMSHARD.NSHARD) != 2 ||
+       SIMSHARD.NSHARD < 1 || 
+       SIMSHARD.ISHARD < 1 || SIMSHARD.ISHARD > SIMSHARD.NSHARD ) {
+    sprintf(c1err,"Invalid '--shard %s'", cshard);
+    sprintf(c2err,"Expect ISHARD/NSHARD with 1 <= ISHARD <= NSHARD");
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );     
   }
 
-  return ;
+  sprintf(SIMSHARD.SUFFIX, "_SHARD%3.3d", SIMSHARD.ISHARD);
+  USE_ARGV_LIST[iarg]   = 1 ;
+  USE_ARGV_LIST[iarg+1] = 1 ;
 
-} // end update_accept_counters
+} // end parse_SIMSHARD_arg
 
-// ***************************************************
-void init_simFiles(SIMFILE_AUX_DEF *SIMFILE_AUX) {
 
-  // May 28, 2009 R.Kessler
-  // Init auxiliary files create by sim program.
-  // Does NOT include special dump files where
-  // the sim quits after the dump.
-  //
-  // Jun 2011: check option to call WR_SNFITSIO_INIT
-  //
-  // Feb 12, 2014: always call snlc_to_SNDATA(1) instead of only
-  //               for FITS format.
+// ***********************************
+void prep_SIMSHARD(void) {
 
-  int i, isys ;
-  char headFile[MXPATHLEN];
-  char cmd[2*MXPATHLEN], prefix[2*MXPATHLEN];
-  char fnam[] = "init_simFiles" ;
+  // Created Oct 2026
+  // For '--shard ISHARD/NSHARD', 
+  //  + append _SHARD[ISHARD] to GENVERSION and GENPREFIX 
+  //  + set JOBID & NJOBTOT so that SIMLIB_findStart gives each 
+  //    shard a different starting LIBID (as for batch jobs).
+  // Shard ilc range is computed later in get_SIMSHARD_ILCRANGE
+  // because NGEN is not known here.
+
+  int  ISHARD = SIMSHARD.ISHARD ;
+  int  NSHARD = SIMSHARD.NSHARD ;
+  int  USE_JOBID ;
+  char fnam[] = "prep_SIMSHARD" ;
 
   // ------------ BEGIN -------------
 
+  if ( NSHARD == 0 ) { return ; }
 
-  // always construct readme lines
-  readme_doc(1);    
+  if ( GENLC.IFLAG_GENSOURCE != IFLAG_GENRANDOM ) {
+    sprintf(c1err,"--shard %d/%d requires GENSOURCE=RANDOM", 
+	    ISHARD, NSHARD);
+    sprintf(c2err,"but GENSOURCE = %s", INPUTS.GENSOURCE );
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );     
+  }
 
-  // init DUMP file regardless of SNDATA file status
+  if ( strlen(INPUTS.GENVERSION) + strlen(SIMSHARD.SUFFIX) >= MXVERLEN ){
+    sprintf(c1err,"GENVERSION + '%s' is too long", SIMSHARD.SUFFIX);
+    sprintf(c2err,"for GENVERSION = %s", INPUTS.GENVERSION);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err );     
+  }
 
-  if ( INPUTS.FORMAT_MASK <= 0 ) {
-    sprintf(SIMFILE_AUX->DUMP,  "%s.DUMP",  INPUTS.GENVERSION );
-    wr_SIMGEN_DUMP(1,SIMFILE_AUX);  // always make DUMP file if requested
-    return ;
+  strcat(INPUTS.GENVERSION, SIMSHARD.SUFFIX);
+  strcat(INPUTS.GENPREFIX,  SIMSHARD.SUFFIX);
+
+  USE_JOBID = ( INPUTS.SIMLIB_IDSTART <= 0 && 
+		INPUTS.SIMLIB_IDLOCK  <  0 &&
+		INPUTS.SIMLIB_MAXRANSTART <= 0 ) ;
+  if ( USE_JOBID ) {
+    if ( INPUTS.NJOBTOT > 0 ) {
+      INPUTS.JOBID   = (INPUTS.JOBID-1)*NSHARD + ISHARD ;
+      INPUTS.NJOBTOT = INPUTS.NJOBTOT * NSHARD ;
+    }
+    else
+      { INPUTS.JOBID = ISHARD ;  INPUTS.NJOBTOT = NSHARD ; }
   }
 
-  // clear out old GENVERSION files; 2nd arg is PROMPT flag
-  clr_VERSION(INPUTS.GENVERSION,INPUTS.CLEARPROMPT);
+  printf("\t Generate shard %d of %d -> GENVERSION = %s \n", 
+	 ISHARD, NSHARD, INPUTS.GENVERSION );
+  fflush(stdout);
 
-  // create new subdir for simulated SNDATA files
+  return ;
 
-  sprintf(cmd,"mkdir -m g+wr %s", PATH_SNDATA_SIM );
-  isys = system(cmd);
+} // end prep_SIMSHARD
 
-  // create full names for auxilliary files,
-  // whether they are used or not.
 
-  sprintf(prefix,"%s/%s", PATH_SNDATA_SIM, INPUTS.GENVERSION );
+// ***********************************
+void init_SIMSHARD_randoms(void) {
 
-  // mandatory
-  sprintf(SIMFILE_AUX->LIST,       "%s.LIST",        prefix );
-  sprintf(SIMFILE_AUX->README,     "%s.README",      prefix );
-  sprintf(SIMFILE_AUX->IGNORE,     "%s.IGNORE",      prefix );
+  // Created Oct 2026
+  // Called after init_CIDRAN so that all shards have the same
+  // random CID list and the same random systematic shifts.
+  // Here random() is re-seeded so that the per-event randoms
+  // differ among shards.
+  // For RANDOM_COUNTER the per-event randoms are keyed by the 
+  // global ilc, so the counter seed is left unchanged.
 
+  int ISHARD = SIMSHARD.ISHARD ;
+  int ilist ;
 
-  // optional
-  sprintf(SIMFILE_AUX->DUMP,       "%s.DUMP",        prefix );
-  sprintf(SIMFILE_AUX->ZVAR,       "%s.ZVARIATION",  prefix );
-  sprintf(SIMFILE_AUX->GRIDGEN,    "%s.GRID",        prefix );
+  // ------------ BEGIN -------------
 
+  if ( SIMSHARD.NSHARD == 0 ) { return ; }
+  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID ) { return ; }
 
-  // create mandatory files.
-  SIMFILE_AUX->FP_LIST   = fopen(SIMFILE_AUX->LIST,   "wt") ;  
-  SIMFILE_AUX->FP_README = fopen(SIMFILE_AUX->README, "wt") ;  
-  SIMFILE_AUX->FP_IGNORE = fopen(SIMFILE_AUX->IGNORE, "wt") ;   
-  fclose(SIMFILE_AUX->FP_IGNORE);
+  INPUTS.ISEED += ISEED_STRIDE_SHARD * ISHARD ;
+  srandom(INPUTS.ISEED);
+  init_RANLIST(); 
+  for ( ilist=1; ilist <= NLIST_RAN; ilist++ ) 
+    { RANFIRST[ilist] = FlatRan1(ilist); }
 
+  printf("\t Shard %d ISEED = %d \n", ISHARD, INPUTS.ISEED );
+  fflush(stdout);
 
-  // dump out the README file
-  for ( i = 1; i <= VERSION_INFO.NLINE_README_INIT; i++ )
-    { fprintf(SIMFILE_AUX->FP_README, "%s", VERSION_INFO.README_DOC[i] ); }
+} // end init_SIMSHARD_randoms
 
-  fflush(SIMFILE_AUX->FP_README);
 
-  // if FITRES DUMP-file is requested, open and init header
-  wr_SIMGEN_DUMP(1,SIMFILE_AUX);
-  
-  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID  ) {
-#ifdef SNGRIDGEN
-    init_GRIDsource(1); 
-    wr_GRIDfile(1,SIMFILE_AUX->GRIDGEN);
-#endif
-  }
+// ***********************************
+void get_SIMSHARD_ILCRANGE(int *ILC_MIN, int *ILC_MAX) {
 
-  snlc_to_SNDATA(1) ;  // 1 => load header only
+  // Created Oct 2026
+  // Return ilc range for this shard: the NGEN events are split
+  // into NSHARD contiguous ranges (1 to NGEN if no sharding).
 
-  // check option for fits format (Jun 2011)
-  if ( WRFLAG_FITS ) { 
+  int NGEN   = INPUTS.NGEN ;
+  int NSHARD = SIMSHARD.NSHARD ;
+  int ISHARD = SIMSHARD.ISHARD ;
+  int NGEN_SHARD, NEXTRA ;
 
-    // abort of any text-option is defined along with fits format
-    if ( WRFLAG_TEXT || WRFLAG_VBOSE ) {
-      sprintf(c1err, "Cannot mix TEXT and FITS format ; FORMAT_MASK=%d",
-	      INPUTS.FORMAT_MASK );
-      sprintf(c2err,"WRFLAG[TEXT,VBOSE,FITS] = %d, %d, %d",
-	      WRFLAG_TEXT, WRFLAG_VBOSE, WRFLAG_FITS );
-      errmsg(SEV_FATAL, 0, fnam, c1err, c2err ); 
-    }
+  if ( NSHARD <= 1 ) { *ILC_MIN = 1;  *ILC_MAX = NGEN;  return ; }
 
-    WR_SNFITSIO_INIT(PATH_SNDATA_SIM
-		     , INPUTS.GENVERSION
-		     , INPUTS.GENPREFIX
-		     , INPUTS.WRITE_MASK
-		     , INPUTS.NSUBSAMPLE_MARK
-		     , headFile); // <== return arg for list file
+  NGEN_SHARD = NGEN / NSHARD ;
+  NEXTRA     = NGEN % NSHARD ;   // first NEXTRA shards get 1 more
 
-    fprintf(SIMFILE_AUX->FP_LIST,"%s", headFile);
-  }
+  *ILC_MIN = (ISHARD-1)*NGEN_SHARD + 1 ;
+  if ( ISHARD <= NEXTRA ) 
+    { *ILC_MIN += (ISHARD-1);  NGEN_SHARD++ ; }
+  else
+    { *ILC_MIN += NEXTRA ; }
 
-  // write filter responses for non-SNANA programs
-  if ( WRFLAG_FILTERS ) 
-    { wr_SIMGEN_FILTERS(SIMFILE_AUX->PATH_FILTERS); }
- 
+  *ILC_MAX = *ILC_MIN + NGEN_SHARD - 1 ;
 
-} // end of init_simFiles
+  SIMSHARD.ILC_RANGE[0] = *ILC_MIN ;
+  SIMSHARD.ILC_RANGE[1] = *ILC_MAX ;
 
-// ***********************************
-void update_simFiles(SIMFILE_AUX_DEF *SIMFILE_AUX) {
+} // end get_SIMSHARD_ILCRANGE
 
-  // May 28, 2009: control output from here
-  // May 24, 2011: call snfitsio_update()
-  // Jan 23, 2014: remove call to append_SNDATA_MODEL();
-  //
-  // May 27, 2019: 
-  //  + call wr_SIMGEN_DUMP after snlc_to_SNDATA to allow for
-  //    things like PEAKMJD_SMEAR
 
-  int  NEWMJD, CID    ;
-  char fnam[] = "update_simFiles";
+// ***********************************
+void init_SIMTIME(void) {
 
-  // ------------ BEGIN -------------
+  // Created Oct 2026
+  // Zero timers and counters before the generation loop.
 
+  int i;
 
-#ifdef SNGRIDGEN
-  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID  ) {
-    update_GRIDarrays();
-    wr_GRIDfile(2,"");
-    return ;
+  for ( i=0; i < MXSTAGE_SIMTIME; i++ ) {
+    SIMTIME.NCALL[i]     = 0 ;
+    SIMTIME.TSUM_WALL[i] = SIMTIME.TSUM_CPU[i] = 0.0 ;
+    SIMTIME.T0_WALL[i]   = SIMTIME.T0_CPU[i]   = 0.0 ;
+  }
+  for ( i=0; i < MXOUT_SIMTIME; i++ ) {
+    SIMTIME.NEVT[i]      = 0 ;
+    SIMTIME.TEVT_WALL[i] = SIMTIME.TEVT_CPU[i] = 0.0 ;
   }
-#endif
 
-  if ( WRFLAG_CIDRAN == 0 ) 
-    { CID = GENLC.CID ; }
-  else
-    { CID = GENLC.CIDRAN ; }
+  SIMTIME.T0_EVT_WALL = SIMTIME.T0_EVT_CPU = 0.0 ;
 
-  if ( CID > MXCID_SIM  ) {
-    sprintf(c1err,"CID=%d exceeds MXCID_SIM=%d", GENLC.CID, MXCID_SIM );
-    errmsg(SEV_FATAL, 0, fnam, c1err, ""); 
-  }
+} // end init_SIMTIME
 
 
-  // init SNDATA strucure
-  init_SNDATA() ; 
+// ***********************************
+void get_SIMTIME_now(double *TWALL, double *TCPU) {
 
-  // load SNDATA structure
-  snlc_to_SNDATA(0) ;
+  // Return wall time and process CPU time, in seconds.
+  // clock_gettime is used instead of time() for sub-msec resolution.
 
-  // always fill DUMP file even if SNDATA files are not written
-  wr_SIMGEN_DUMP(2,SIMFILE_AUX);
+  struct timespec ts ;
 
-  if ( INPUTS.FORMAT_MASK <= 0 ) { return ; }
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  *TWALL = (double)ts.tv_sec + 1.0E-9*(double)ts.tv_nsec ;
 
-  if ( WRFLAG_FITS ) { 
-    WR_SNFITSIO_UPDATE(); 
-    return ;
-  }
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+  *TCPU  = (double)ts.tv_sec + 1.0E-9*(double)ts.tv_nsec ;
 
-  // below are the text-output options
+} // end get_SIMTIME_now
 
-  NEWMJD = SNDATA.NEWMJD ; // save NEWMJD value
 
-  // check option to suppress verbose output
-  if ( WRFLAG_VBOSE == 0 ) { SNDATA.NEWMJD = 0; }
+// ***********************************
+void start_SIMTIME_event(void) {
+  if ( !INPUTS.USE_SIMTIME ) { return ; }
+  get_SIMTIME_now(&SIMTIME.T0_EVT_WALL, &SIMTIME.T0_EVT_CPU);
+} 
 
-      
-  // alawys write header, and write NEWMJD epochs if verbose format 
-  wr_SNDATA ( INPUTS.WRITE_MASK, 0 );
+void end_SIMTIME_event(char *OUTCOME) {
 
-  SNDATA.NEWMJD = NEWMJD ;   // restore NEWMJD
+  // Add time since start_SIMTIME_event to OUTCOME = 
+  // ACCEPT or reject stage passed to gen_event_reject.
 
-  // check option to append TERSE output at end of SNDATA file
-  if ( WRFLAG_TEXT > 0 ) { 
-    append_SNPHOT_TEXT() ; 
-    append_SNSPEC_TEXT() ;   // July 2016
+  int  iout ;
+  double TWALL, TCPU ;
+
+  if ( !INPUTS.USE_SIMTIME ) { return ; }
+
+  for ( iout=0; iout < MXOUT_SIMTIME; iout++ ) {
+    if ( strcmp(OUTCOME,SIMTIME_OUTCOME_NAMES[iout]) == 0 ) { break; }
   }
+  if ( iout == MXOUT_SIMTIME ) { return ; } // gen_event_reject aborts
 
-  // update LIST file
-  fprintf(SIMFILE_AUX->FP_LIST,"%s\n", SNDATA.snfile_output);
+  get_SIMTIME_now(&TWALL, &TCPU);
+  SIMTIME.NEVT[iout]++ ;
+  SIMTIME.TEVT_WALL[iout] += ( TWALL - SIMTIME.T0_EVT_WALL );
+  SIMTIME.TEVT_CPU[iout]  += ( TCPU  - SIMTIME.T0_EVT_CPU  );
 
-} // end of upd_simFiles
+} // end end_SIMTIME_event
 
 
 // ***********************************
-void end_simFiles(SIMFILE_AUX_DEF *SIMFILE_AUX) {
+void start_SIMTIME_stage(int ISTAGE) {
+  if ( !INPUTS.USE_SIMTIME ) { return ; }
+  get_SIMTIME_now(&SIMTIME.T0_WALL[ISTAGE], &SIMTIME.T0_CPU[ISTAGE]);
+}
 
-  // May 28, 2009
-  // close out auxiliary simfiles, and leave 1-line 
-  // summary to stdout for each aux file.
-  //
-  // Oct 16, 2010: print GRIDGEN summary if used
-  // Jun 09, 2012:  replace GRIDGEN stuff call to wr_GRIDfile(3);
-  // May 14, 2019: add call to wr_SIMGEN_DUMP(3,SIMFILE_AUX);
-  int i, N1, N2 ;
+void end_SIMTIME_stage(int ISTAGE) {
 
-  // ------------ BEGIN -------------
+  double TWALL, TCPU ;
 
-  // fill post-sim part of readme
-  readme_doc(2); 
+  // NTHREAD_GEN worker: count only the ilc that it owns
+  if ( !INPUTS.USE_SIMTIME || !SIMTHREAD.OWNER ) { return ; }
 
+  get_SIMTIME_now(&TWALL, &TCPU);
+  SIMTIME.NCALL[ISTAGE]++ ;
+  SIMTIME.TSUM_WALL[ISTAGE] += ( TWALL - SIMTIME.T0_WALL[ISTAGE] );
+  SIMTIME.TSUM_CPU[ISTAGE]  += ( TCPU  - SIMTIME.T0_CPU[ISTAGE]  );
 
-  // always dump entire readme contents to screen
-  print_banner("DUMP README CONTENTS TO SCREEN\n");
-  for ( i = 1; i<= VERSION_INFO.NLINE_README; i++ )
-    printf("%s", VERSION_INFO.README_DOC[i] );
+} // end end_SIMTIME_stage
 
-  // ==========================================
-  // continue only if SNDATA files are written for each SN
 
-  if ( INPUTS.FORMAT_MASK <= 0 ) return ;
+// ***********************************
+void print_SIMTIME(void) {
 
-  // ==========================================
+  // Created Oct 2026
+  // Print CPU time per stage, and CPU time per event outcome.
+  // FRAC is the fraction of CPU time in the generation loop.
 
-  printf("\n  AUXILIARY FILES: \n");
-  printf("  %s \n", SIMFILE_AUX->LIST );
-  printf("  %s \n", SIMFILE_AUX->README );
+  int    i, N ;
+  double TCPU, TSUM_CPU = 0.0 ;
 
-  if ( WRFLAG_FILTERS ) 
-    { printf("  %s \n", SIMFILE_AUX->PATH_FILTERS ); }  // it's a subdir
+  // ------------ BEGIN -------------
+
+  if ( !INPUTS.USE_SIMTIME ) { return ; }
 
+  for ( i=0; i < MXOUT_SIMTIME; i++ ) { TSUM_CPU += SIMTIME.TEVT_CPU[i]; }
+  if ( TSUM_CPU <= 0.0 ) { return ; }
+
+  printf("\n  Generation-loop timing (CPU = %.1f sec): \n", TSUM_CPU);
+  printf("\t %-20s %9s %10s %10s %7s \n",
+	 "STAGE", "NCALL", "CPU(sec)", "msec/call", "FRAC");
+  for ( i=0; i < MXSTAGE_SIMTIME; i++ ) {
+    N = SIMTIME.NCALL[i] ;  TCPU = SIMTIME.TSUM_CPU[i] ;
+    if ( N == 0 ) { continue ; }
+    printf("\t %-20s %9d %10.2f %10.4f %7.4f \n",
+	   SIMTIME_STAGE_NAMES[i], N, TCPU, 1000.*TCPU/(double)N, 
+	   TCPU/TSUM_CPU );
+  }
+
+  printf("\t %-20s %9s %10s %10s %7s \n",
+	 "EVENT OUTCOME", "NEVT", "CPU(sec)", "msec/evt", "FRAC");
+  for ( i=0; i < MXOUT_SIMTIME; i++ ) {
+    N = SIMTIME.NEVT[i] ;  TCPU = SIMTIME.TEVT_CPU[i] ;
+    if ( N == 0 ) { continue ; }
+    printf("\t %-20s %9d %10.2f %10.4f %7.4f \n",
+	   SIMTIME_OUTCOME_NAMES[i], N, TCPU, 1000.*TCPU/(double)N, 
+	   TCPU/TSUM_CPU );
+  }
   fflush(stdout);
 
-  // dump post-sim part of readme to README file.
-  N1 = VERSION_INFO.NLINE_README_INIT + 1 ; 
-  N2 = VERSION_INFO.NLINE_README ; 
-  for ( i = N1; i <= N2; i++ )
-    {  fprintf(SIMFILE_AUX->FP_README, "%s", VERSION_INFO.README_DOC[i] ); }
+} // end print_SIMTIME
 
 
-  // close files.
-  fclose(SIMFILE_AUX->FP_LIST);
-  fclose(SIMFILE_AUX->FP_README);
+// ***********************************
+void wr_SIMTIME_TABLE(char *fileName) {
 
-  // check optional auxiliary files.
+  // Created Oct 2026
+  // Write SIMTIME info as a key-table with one ROW per stage
+  // and one ROW per event outcome (EVT_ACCEPT, EVT_NEPOCH, ...).
+  // TSUM is summed over calls (stage) or events (outcome).
+  // For NTHREAD_GEN, TSUM is summed over workers (end_SIMTHREAD).
 
-  // close out SIMGEN_DUMP file if it exists
-  if ( INPUTS.NVAR_SIMGEN_DUMP > 0 ) {
-    wr_SIMGEN_DUMP(3,SIMFILE_AUX);
-    // xxx mark delete    fclose(SIMFILE_AUX->FP_DUMP);
-    // xxx mark delete    printf("  %s \n", SIMFILE_AUX->DUMP );
-  }
+  int    i, NROW=0 ;
+  FILE  *fp ;
+  char   fnam[] = "wr_SIMTIME_TABLE" ;
 
+  // ------------ BEGIN -------------
 
-  // copy ZVARATION file to SIM/[VERSION]
-  if ( USE_ZVAR_FILE ) {
-    cp_zvariation(SIMFILE_AUX->ZVAR);  
-    printf("  %s\n", SIMFILE_AUX->ZVAR);
+  if ( !INPUTS.USE_SIMTIME  ) { return ; }
+  if ( strlen(fileName) == 0 ) { return ; }
+  if ( (fp = fopen(fileName,"wt")) == NULL ) {
+    sprintf(c1err,"Cannot open timing table");
+    sprintf(c2err,"%s", fileName);
+    errmsg(SEV_WARN, 0, fnam, c1err, c2err );
+    return ;
   }
 
-#ifdef SNGRIDGEN
-  if ( GENLC.IFLAG_GENSOURCE == IFLAG_GENGRID ) {
-    printf("  %s\n", SIMFILE_AUX->GRIDGEN );
-    wr_GRIDfile(3,"");
+  fprintf(fp,"# snlc_sim timing for GENVERSION = %s \n", INPUTS.GENVERSION);
+  fprintf(fp,"# Stage rows: NCALL and time summed over calls.\n");
+  fprintf(fp,"# EVT rows: number of events and time from start of event\n"
+	  "#    to accept or reject.\n");
+  fprintf(fp,"\nVARNAMES: ROW NAME NCALL TSUM_CPU TSUM_WALL \n");
+
+  for ( i=0; i < MXSTAGE_SIMTIME; i++ ) {
+    NROW++ ;
+    fprintf(fp,"ROW: %2d %-20s %9d %10.3f %10.3f \n", 
+	    NROW, SIMTIME_STAGE_NAMES[i], SIMTIME.NCALL[i],
+	    SIMTIME.TSUM_CPU[i], SIMTIME.TSUM_WALL[i] );
+  }
+  for ( i=0; i < MXOUT_SIMTIME; i++ ) {
+    NROW++ ;
+    fprintf(fp,"ROW: %2d EVT_%-16s %9d %10.3f %10.3f \n", 
+	    NROW, SIMTIME_OUTCOME_NAMES[i], SIMTIME.NEVT[i],
+	    SIMTIME.TEVT_CPU[i], SIMTIME.TEVT_WALL[i] );
   }
-#endif
 
+  fclose(fp);
+  printf("  %s \n", fileName);
   fflush(stdout);
-  if ( WRFLAG_FITS) { WR_SNFITSIO_END(); }
 
-} // end of end_simFiles
+} // end wr_SIMTIME_TABLE
 
 
 // ===========================
@@ -166,6 +166,7 @@ typedef struct {
   // optional outputs (just filename, not pointer)
   char  ZVAR[MXPATHLEN] ;   // optional zvariation file
   char  GRIDGEN[MXPATHLEN]; // optional GRID-output
+  char  TIMING[MXPATHLEN];  // per-stage timing table (Oct 2026)
 
   // char string to write each line to memory, and then
   // one ASCI write per line instead of per value.
@@ -345,6 +346,8 @@ struct INPUTS {
   int    NSKIP_SIMLIB ;       // number of SIMLIB_IDSKIP values read
 
   int    SIMLIB_DUMP;  // dump this simlib id, then quit (0=all)
+  char   SIMLIB_MKBIN[MXPATHLEN]; // convert SIMLIB_FILE to binary, then quit
+  double SIMLIB_CACHE ; // >0 -> cache cadences in memory up to this many MB
   float  SIMLIB_CADENCEFOM_ANGSEP; // controls calc of cadence FoM
   double SIMLIB_CADENCEFOM_PARLIST[10] ; // optional *parList for SNcadenceFoM
 
@@ -363,11 +366,14 @@ struct INPUTS {
 
   int  JOBID;       // command-line only, to compute SIMLIB_IDSTART
   int  NJOBTOT;     // idel, for sim_SNmix only
+  int  NTHREAD_GEN; // number of forked generation workers (default=1)
+  int  USE_SIMTIME; // 1 => time each stage of generation loop (default=1)
 
   char HOSTLIB_FILE[MXPATHLEN]; // lib of Ztrue, Zphot, Zerr ...
   int  HOSTLIB_USE ;            // 1=> used; 0 => not used (internal)
   char HOSTLIB_WGTMAP_FILE[MXPATHLEN];  // optional wgtmap override
   char HOSTLIB_ZPHOTEFF_FILE[MXPATHLEN];  // optional EFF(zphot) vs. ZTRUE
+  char HOSTLIB_CACHE_DIR[MXPATHLEN];  // dir for binary HOSTLIB cache (Oct 2026)
   int  HOSTLIB_MSKOPT ;         // user bitmask of options
   int  HOSTLIB_MAXREAD ;        // max entries to read (def= infinite)
   int  HOSTLIB_GALID_NULL ;     // value for no galaxy; default is -9
@@ -430,6 +436,7 @@ struct INPUTS {
   unsigned int ISEED;         // random seed
  
   int    RANLIST_START_GENSMEAR;  // to pick different genSmear randoms
+  int    RANDOM_COUNTER ;  // 1 => counter-based randoms keyed by event
 
   double OMEGA_MATTER;   // used to select random Z and SN magnitudes
   double OMEGA_LAMBDA;
@@ -516,6 +523,8 @@ struct INPUTS {
 
   // SIMSED parameters & ranges
   int   USE_BINARY_SIMSED;  // 1 => use binary files fof faster I/O
+                            // 2 => also memory-map flux table (Oct 2026)
+  int   NSED_LAZY_SIMSED;   // >0 => load SEDs on first use; keep this many
   char  PATH_BINARY_SIMSED[MXPATHLEN]; // location of binaries (default = ./)
 
   int   NPAR_SIMSED_PARAM;     // continuous interp params
@@ -891,6 +900,8 @@ struct GENLC {
   int   CID ;           // internal data CID or 40000 + ilc
   int   CIDOFF ;       // CID offset depends on MJD range (random only)
   int   CIDRAN ;       // use this random CID (if INPUTS.CIDRAN > 0)
+  int   ILC_RANKEY ;   // ilc of last RANDOM_COUNTER key
+  int   NTRY_RANKEY ;  // number of previous tries with this ilc
   //  int   YEAR ;         // survey year simulated
   int   SUBSAMPLE_INDEX ; // only if NSUBSAMPLE_MARK > 0 (June 2017)
   int   NEPOCH;        // includes model-epoch at T=0 and epoch with fluxerr<0
@@ -1001,6 +1012,7 @@ struct GENLC {
   double  epoch8_rest[MXEPSIM];      // rest epoch relative to peak, days
   double  genmag8_obs[MXEPSIM] ;     // generated obs  magnitude
   double  generr8_obs[MXEPSIM] ;     // obs mag err from model
+  int     GENMAG_EVENT_DONE ;        // 1 -> genmag8_obs done for all bands
   double  peakmag8_obs[MXFILTINDX] ;          
   double  genmag8_obs_template[MXFILTINDX]; // for LCLIB model (stars)
 
@@ -1102,6 +1114,90 @@ int NGENLC_TOT ;             // actual number of generated LC
 int NGENLC_WRITE ;           // number written
 int NGENSPEC_WRITE ;         // number of spectra written
 
+// Oct 2026: NTHREAD_GEN workers. Each worker is a forked copy of the
+// fully initialized sim-job, so it carries its own GENLC, SNHOSTGAL,
+// SNDATA and random-number state. Every worker runs the sequential
+// front end (SIMLIB read, GENRANGE cuts) of every event so that the
+// SIMLIB and try-counters stay in sync, but only the owner of ilc
+// (round-robin) runs the expensive back end (GENMAG, GENSPEC, GENFLUX,
+// SEARCHEFF, CUTWIN). Owners send accepted events to the parent
+// through a pipe, and the parent writes them in ilc (CID) order.
+#define MXTHREAD_GEN       256
+struct {
+  int  NTHREAD ;     // number of workers (1 => serial, no fork)
+  int  ITHREAD ;     // 1-NTHREAD for worker, 0 for parent/serial job
+  int  OWNER ;       // 1 => this process generates back end of ilc
+  int  REPLAY ;      // 1 => parent writes event received from worker
+  int  ILC_MIN, ILC_MAX ;  // ilc range shared by all workers
+  int  ILC_TRY ;     // ilc at start of current try
+  int  PID[MXTHREAD_GEN+1] ;    // process id of each worker
+  int  FDPIPE[MXTHREAD_GEN+1] ; // parent read-end; worker write-end
+  off_t OFFSET_SIMLIB ;         // parent SIMLIB file position at fork
+  char *SHADOW_SNDATA[MXTHREAD_GEN+1] ;  // last SNDATA sent by worker
+  char *SHADOW_GENSPEC[MXTHREAD_GEN+1] ; // last GENSPEC sent by worker
+  double RANLAST[MXLIST_RAN+1] ;         // last RANLAST sent by worker
+} SIMTHREAD ;
+
+// packet types sent from worker to parent
+#define ITYPE_SIMTHREAD_SNDATA   1  // changed SNDATA bytes
+#define ITYPE_SIMTHREAD_GENSPEC  2  // changed GENSPEC bytes
+#define ITYPE_SIMTHREAD_SPECFLUX 3  // spectra written to FITS
+#define ITYPE_SIMTHREAD_EVENT    4  // write event (FITS) 
+#define ITYPE_SIMTHREAD_DUMP     5  // SIMGEN_DUMP line
+#define ITYPE_SIMTHREAD_LIST     6  // LIST line (TEXT)
+#define ITYPE_SIMTHREAD_ENDILC   7  // done with ilc; RANLAST
+#define ITYPE_SIMTHREAD_END      8  // worker summary
+#define NBYTE_BLOCK_SIMTHREAD  256  // block size for SNDATA/GENSPEC diff
+
+typedef struct {
+  int ITYPE, ILC, NBYTE ; // NBYTE of payload following header
+} SIMTHREAD_HEADER_DEF ;
+
+// Oct 2026: command-line '--shard ISHARD/NSHARD' splits one sim-job
+// into NSHARD independent jobs. Shard ISHARD generates the contiguous
+// ilc range ILC_RANGE of the NGEN events (same random CID list for all
+// shards), writes GENVERSION_SHARDnnn, and util/merge_simShards.py 
+// merges the shards into GENVERSION.
+struct {
+  int  ISHARD, NSHARD ;  // NSHARD=0 => no sharding
+  int  ILC_RANGE[2] ;    // ilc range for this shard
+  char SUFFIX[20] ;      // GENVERSION suffix, e.g., _SHARD003
+} SIMSHARD ;
+
+#define ISEED_STRIDE_SHARD 2571799  // ISEED offset between shards
+
+// Oct 2026: CPU & wall time per stage of the generation loop, and
+// total time of events for each outcome (accept or reject reason),
+// to see where time is spent and how much is wasted on rejected
+// events. Printed in simEnd and written to [GENVERSION].TIMING.
+// Input key 'SIMTIME: 0' turns off the timers.
+#define ISTAGE_SIMTIME_EVENT      0  // gen_event_driver
+#define ISTAGE_SIMTIME_GENMAG     1  // GENMAG_DRIVER
+#define ISTAGE_SIMTIME_GENSPEC    2  // GENSPEC_DRIVER
+#define ISTAGE_SIMTIME_GENFLUX    3  // GENFLUX_DRIVER
+#define ISTAGE_SIMTIME_SEARCHEFF  4  // gen_SEARCHEFF
+#define ISTAGE_SIMTIME_WRITE      5  // update_simFiles
+#define MXSTAGE_SIMTIME           6
+static const char * const SIMTIME_STAGE_NAMES[MXSTAGE_SIMTIME] = {
+  "gen_event_driver", "GENMAG_DRIVER", "GENSPEC_DRIVER", "GENFLUX_DRIVER",
+  "gen_SEARCHEFF", "update_simFiles" } ;
+
+#define IOUT_SIMTIME_ACCEPT       0
+#define MXOUT_SIMTIME             7
+static const char * const SIMTIME_OUTCOME_NAMES[MXOUT_SIMTIME] = { 
+  "ACCEPT", "NEPOCH", "GENRANGE", "GENMAG", "GENPAR_SELECT", 
+  "SEARCHEFF", "CUTWIN" } ;
+
+struct {
+  double T0_WALL[MXSTAGE_SIMTIME], T0_CPU[MXSTAGE_SIMTIME] ; // stage start
+  double T0_EVT_WALL, T0_EVT_CPU ;  // start of current event
+  int    NCALL[MXSTAGE_SIMTIME] ;
+  double TSUM_WALL[MXSTAGE_SIMTIME], TSUM_CPU[MXSTAGE_SIMTIME] ;
+  int    NEVT[MXOUT_SIMTIME] ;      // number of events per outcome
+  double TEVT_WALL[MXOUT_SIMTIME], TEVT_CPU[MXOUT_SIMTIME] ;
+} SIMTIME ;
+
+
 struct NGEN_REJECT {
   int GENRANGE, GENMAG;
   int GENPAR_SELECT_FILE ;
@@ -1111,6 +1207,19 @@ struct NGEN_REJECT {
   int NEPOCH ;   // counts NEPOCH < NEPOCH_MIN
 } NGEN_REJECT ;
 
+// summary counters sent by each worker at the end
+typedef struct {
+  int NGENLC_TOT, NGENLC_WRITE, NGENSPEC_WRITE, NGEN_ALLSKIP ;
+  int NTYPE_SPEC, NTYPE_SPEC_CUTS, NTYPE_PHOT, NTYPE_PHOT_CUTS ;
+  int NTYPE_PHOT_WRONGHOST ;
+  struct NGEN_REJECT NGEN_REJECT ;
+  int NAVWARP_OVERFLOW[MXFILTINDX] ;
+  int NGENWR_NON1ASED[MXNON1A_TYPE], NGENTOT_NON1ASED[MXNON1A_TYPE] ;
+  int NCALL[MXSTAGE_SIMTIME], NEVT[MXOUT_SIMTIME] ;
+  double TSUM_WALL[MXSTAGE_SIMTIME], TSUM_CPU[MXSTAGE_SIMTIME] ;
+  double TEVT_WALL[MXOUT_SIMTIME],   TEVT_CPU[MXOUT_SIMTIME] ;
+} SIMTHREAD_SUMMARY_DEF ;
+
 
 // valid Z-range with defined rest-frame model for each obs-filter
 // (for README comment only)
@@ -1287,6 +1396,58 @@ SIMLIB_OBS_DEF SIMLIB_OBS_RAW ;  // read from simlib
 SIMLIB_OBS_DEF SIMLIB_OBS_GEN ;  // used to generate SN
 
 
+// Oct 2026: binary SIMLIB (made with SIMLIB_MKBIN key).
+// Each S: row is stored as a fixed-width record; everything else
+// (global header, LIBID header keys, FIELD/TEMPLATE/SPECTROGRAPH 
+// lines, ...) is kept as text in which each S: row is replaced by 
+// a bare 'S:' token. The file is memory-mapped, and each LIBID text 
+// is read with fmemopen so that SIMLIB_readNextCadence_TEXT parses
+// only the few header tokens while the S: values are copied from 
+// the records. The LIBID index gives O(1) access to any LIBID;
+// LIBIDs must be in increasing order so that a specific LIBID
+// (SIMLIB_IDSTART, SIMLIB_IDLOCK) is found with a binary search.
+// File is native-endian; re-make it on a different architecture.
+#define MAGIC_SIMLIB_BIN    "SNANA_SIMLIB_BIN"
+#define VERSION_SIMLIB_BIN  2  // v2: LIBIDs sorted
+#define SUFFIX_SIMLIB_BIN   ".BIN"
+
+typedef struct {
+  char      MAGIC[16] ;
+  int       VERSION, NLIBID ;
+  long long NREC ;                     // total number of S: records
+  long long OFFSET_GLOBAL, LEN_GLOBAL; // global header text (to BEGIN)
+  long long OFFSET_INDEX ;             // LIBID index table
+  long long OFFSET_REC ;               // S: records
+  long long OFFSET_TEXT ;              // LIBID text blocks
+} SIMLIB_BIN_FILEHEAD_DEF ;
+
+typedef struct {
+  int       LIBID, NREC ;
+  long long IREC0 ;                 // first S: record for this LIBID
+  long long OFFSET_TEXT, LEN_TEXT ; // w.r.t. FILEHEAD.OFFSET_TEXT
+} SIMLIB_BIN_INDEX_DEF ;
+
+typedef struct {
+  double MJD, CCDGAIN, READNOISE, SKYSIG, PSFSIG1, PSFSIG2, PSFRATIO ;
+  double ZPTADU, ZPTSIG, MAG ;
+  int    IDEXPT, NEXPOSE ;
+  char   BAND[8] ;
+} SIMLIB_BIN_REC_DEF ;
+
+struct {
+  int   USE ;          // 1 => SIMLIB_FILE is binary
+  char  *MAP ;         // mmap of entire file
+  size_t SIZE_MAP ;
+  SIMLIB_BIN_FILEHEAD_DEF *HEAD ;
+  SIMLIB_BIN_INDEX_DEF    *INDEX ;
+  SIMLIB_BIN_REC_DEF      *REC ;
+  char                    *TEXT ;
+  int       ILIBID_NEXT ;  // next index to open (0 to NLIBID-1)
+  long long IREC_NEXT ;    // next S: record for current LIBID
+  long long IREC_CUR ;     // S: record for current 'S:' token
+} SIMLIB_BIN ;
+
+
 // Jan 6 2016 - define contiguous temp arrays used to sort SIMLIB by MJD.
 struct {
   int     NMJD ;
@@ -1313,6 +1474,48 @@ struct SIMLIB_TEMPLATE {
 } SIMLIB_TEMPLATE ;
 
 
+// Oct 2026: in-memory SIMLIB cache (SIMLIB_CACHE key). All cadences
+// are read once, starting from SIMLIB_findStart, and stored after 
+// SPECTROGRAPH expansion, unit conversion, MJD-sorting and 
+// season-splitting; each event then restores a cached cadence 
+// instead of re-reading and re-sorting. LIBID cuts that depend on
+// the event (e.g., redshift) are still applied for each event.
+// FIELD and TELESCOPE strings are stored once in STRLIST.
+typedef struct {
+  double MJD, CCDGAIN, READNOISE, SKYSIG, PSFSIG1, PSFSIG2, PSFRATIO ;
+  double ZPTADU, ZPTSIG, MAG, PIXSIZE, TEXPOSE_SPECTROGRAPH ;
+  double TEMPLATE_SKYSIG, TEMPLATE_READNOISE, TEMPLATE_ZPT ;
+  int    OPTLINE, IFILT_OBS, IDEXPT, NEXPOSE, APPEND_PHOTFLAG, ISEASON ;
+  int    IFILT_SPECTROGRAPH, INDX_TAKE_SPECTRUM ;
+  int    INDEX_SORT ;               // MJD-sort index
+  short  ISTR_FIELD, ISTR_TEL ;     // index in SIMLIB_CACHE.STRLIST
+  char   BAND[4] ;
+} SIMLIB_CACHE_OBS_DEF ;
+
+typedef struct {
+  struct SIMLIB_HEADER HEADER ;  // after sort and seasons
+  int    NOBS_HEADER_READ ;      // HEADER.NOBS before SPECTROGRAPH expansion
+  int    NOBS, NOBS_READ, NOBS_SPECTROGRAPH, NMJD ;
+  SIMLIB_CACHE_OBS_DEF *OBS ;
+
+  // correlated template noise (only if TEMPLATE keys are used)
+  int    USEFLAG_TEMPLATE, NFIELD_OVP ;
+  double TEXPOSE_SPECTROGRAPH_TEMPLATE ;
+  char   (*TEMPLATE_FIELDNAME)[MXCHAR_FIELDNAME] ;
+  double *TEMPLATE_NOISE ;       // [NFIELD_OVP+1][3][MXFILTINDX]
+} SIMLIB_CACHE_LIBID_DEF ;
+
+struct {
+  int    USE, LOADING ;
+  int    NLIBID, MXLIBID, ILIBID_NEXT ;
+  int    NSKIP_START ;  // LIBIDs skipped before first cached LIBID
+  SIMLIB_CACHE_LIBID_DEF *LIBID ;
+  int    NSTR, MXSTR ;
+  char   **STRLIST ;
+  double MEMORY ;   // total bytes allocated
+} SIMLIB_CACHE ;
+
+
 // LEGACY FLUXERR_COR map structure (Dec 2011); COR <-> correction
 struct SIMLIB_FLUXERR_COR {
   int     USE ;
@@ -1575,6 +1778,7 @@ int    get_NON1A_MODELFLAG(char *GENVERSION) ;
 
 void   genperfect_override(void);
 void   gen_event_driver(int ilc);    // generate RA, DEC, Z, PEAKMJD, etc.
+void   set_simRandoms_key(int ilc);
 void   gen_event_reject(int *ILC, SIMFILE_AUX_DEF *SIMFILE_AUX,
 			char *REJECT_STAGE );
 
@@ -1619,6 +1823,55 @@ void init_simFiles(SIMFILE_AUX_DEF *SIMFILE_AUX);
 void update_simFiles(SIMFILE_AUX_DEF *SIMFILE_AUX);
 void end_simFiles(SIMFILE_AUX_DEF *SIMFILE_AUX);
 
+void prep_SIMTHREAD(void);
+int  fork_SIMTHREAD(void);
+void init_SIMTHREAD_worker(int ITHREAD);
+void set_SIMTHREAD_OWNER(int ilc);
+void end_SIMTHREAD_ilc(int ilc);
+void end_SIMTHREAD_worker(void);
+void write_SIMTHREAD(SIMFILE_AUX_DEF *SIMFILE_AUX);
+void end_SIMTHREAD(char **BUF, int *MXBUF);
+void get_SIMTHREAD_LOGFILE(int ITHREAD, char *logFile);
+void write_SIMTHREAD_bytes(void *PTR, int NBYTE);
+void copy_SIMTHREAD_SPECFLUX(char *BUF, int NBYTE_BUF, int FD);
+void send_SIMTHREAD_packet(int ITYPE, int NBYTE, void *PTR);
+void send_SIMTHREAD_diff(int ITYPE, void *PTR, char *SHADOW, int NBYTE);
+void send_SIMTHREAD_EVENT(void);
+int  read_SIMTHREAD_packet(int ITHREAD, SIMTHREAD_HEADER_DEF *HEADER, 
+			   char **BUF, int *MXBUF);
+void apply_SIMTHREAD_diff(char *BUF, int NBYTE_BUF, char *SHADOW, 
+			  int NBYTE);
+void read_SIMTHREAD_bytes(int ITHREAD, void *PTR, int NBYTE);
+void parse_SIMSHARD_arg(int iarg);
+void prep_SIMSHARD(void);
+void init_SIMSHARD_randoms(void);
+void get_SIMSHARD_ILCRANGE(int *ILC_MIN, int *ILC_MAX);
+
+int  ISBIN_SIMLIB(char *fileName);
+void SIMLIB_mkBinary(char *textFile, char *binFile);
+void SIMLIB_openBinary(char *binFile);
+void SIMLIB_openLIBID_BIN(int ILIBID);
+int  SIMLIB_findLIBID_BIN(int IDSEEK);
+int  SIMLIB_nextToken(char *c_get);
+void SIMLIB_copyObs_BIN(int ISTORE);
+
+void init_SIMLIB_CACHE(void);
+void SIMLIB_prepCadence_RAW(void);
+void SIMLIB_storeCadence_CACHE(int NOBS_HEADER_READ);
+void SIMLIB_readNextCadence_CACHE(void);
+int  SIMLIB_findStart_CACHE(int NSKIP_LIBID, int IDSEEK);
+int  get_SIMLIB_CACHE_ISTR(char *STRING);
+void get_SIMLIB_CACHE_ISORT_RANGE(int *ISORT_MIN, int *ISORT_MAX);
+
+void init_SIMTIME(void);
+void get_SIMTIME_now(double *TWALL, double *TCPU);
+void start_SIMTIME_event(void);
+void end_SIMTIME_event(char *OUTCOME);
+void start_SIMTIME_stage(int ISTAGE);
+void end_SIMTIME_stage(int ISTAGE);
+void print_SIMTIME(void);
+void wr_SIMTIME_TABLE(char *fileName);
+
 void update_accept_counters(void);
 
 void    simEnd(SIMFILE_AUX_DEF *SIMFILE_AUX);
@@ -1650,6 +1903,8 @@ double GENSPEC_PICKMJD(int OPT, int INDX, double z,
 void   GENSPEC_FUDGES(int imjd);
 
 void   genmodel(int ifilt_obs, int inear);   // generate model-mags
+void   genmodel_SALT2_EVENT(void);  // SALT2 mags for all bands at once
+void   getpar_SALT2_SCATTER(double *x0, double *x1, double *c);
 void   genmodelSmear(int NEPFILT, int ifilt_obs, int ifilt_rest, 
 		     double z, double *epoch, double *genmag, double *generr);
 
@@ -1761,6 +2016,7 @@ void test_zcmb_dLmag_invert(void);
 void wr_HOSTLIB_info(void);    // write hostgal info
 void wr_SIMGEN_FITLERS(char *path);
 void wr_SIMGEN_DUMP(int OPT_DUMP, SIMFILE_AUX_DEF *SIMFILE_AUX);
+void fill_SIMGEN_DUMP_LINE(char *OUTLINE);
 int  MATCH_INDEX_SIMGEN_DUMP(char *varName ) ;
 void PREP_SIMGEN_DUMP(int OPT_DUMP );
 void PREP_SIMGEN_DUMP_TAKE_SPECTRUM(void);
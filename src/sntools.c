@@ -2153,6 +2153,70 @@ int IGNOREFILE(char *fileName) {
 
 int ignorefile_(char *fileName) { return IGNOREFILE(fileName); }
 
+
+// ==================================================
+void cksum_FNV1a(void *buf, size_t nbyte, unsigned long long *CKSUM) {
+
+  // Created Oct 2026
+  // Update 64-bit FNV-1a checksum *CKSUM with nbyte bytes of buf.
+  // Start with *CKSUM = CKSUM_INIT_FNV1A. Used to name cache files
+  // so that a change in any input results in a new cache file.
+
+  unsigned char *ptr = (unsigned char*)buf ;
+  unsigned long long H = *CKSUM ;
+  size_t i ;
+
+  for(i=0; i < nbyte; i++ ) 
+    { H ^= (unsigned long long)ptr[i] ;  H *= 1099511628211ULL ; }
+
+  *CKSUM = H ;
+
+} // end cksum_FNV1a
+
+
+// ==================================================
+void set_TEMPFILE(char *fileName, char *tmpFile) {
+  // Created Oct 2026
+  // Return name of temp file for fileName; see open_TEMPFILE.
+  sprintf(tmpFile, "%s.tmp%d", fileName, (int)getpid() );
+} // end set_TEMPFILE
+
+
+FILE *open_TEMPFILE(char *fileName, char *tmpFile) {
+
+  // Created Oct 2026
+  // Open temp file (for binary write) that close_TEMPFILE renames 
+  // to fileName, so that parallel jobs never read a partial file.
+  // Returns NULL if temp file cannot be opened.
+
+  set_TEMPFILE(fileName, tmpFile);
+  return( fopen(tmpFile, "wb") );
+
+} // end open_TEMPFILE
+
+
+int close_TEMPFILE(FILE *fp, int NERR, char *tmpFile, char *fileName) {
+
+  // Created Oct 2026
+  // Close temp file fp (if not NULL) and rename tmpFile to fileName.
+  // NERR is the number of write errors found by the caller.
+  // If NERR > 0, or a write error is flagged on fp, or close or 
+  // rename fails, remove tmpFile and return ERROR; else SUCCESS.
+  // Caller decides whether failure is fatal.
+
+  if ( fp != NULL ) {
+    if ( ferror(fp)      ) { NERR++ ; }
+    if ( fclose(fp) != 0 ) { NERR++ ; }
+  }
+
+  if ( NERR == 0 && rename(tmpFile, fileName) == 0 ) 
+    { return(SUCCESS); }
+
+  remove(tmpFile);
+  return(ERROR);
+
+} // end close_TEMPFILE
+
 // ==================================================
 int strcmp_ignoreCase(char *str1, char *str2) {
 
@@ -5127,6 +5191,9 @@ void init_RANLIST(void) {
   //              changing synced randoms for main generation.
   //
   // Jun 9 2018: use unix_random() call.
+  //
+  // Oct 2026: for RANMODE_COUNTER, only reset counters; randoms 
+  //           are computed on the fly in FlatRan1.
 
   int ilist, istore;
   char fnam[] = "init_RANLIST" ;
@@ -5149,6 +5216,7 @@ void init_RANLIST(void) {
 
   for (ilist = 1; ilist <= NLIST_RAN; ilist++ ) {
     NSTORE_RAN[ilist] = 0 ;
+    if ( RANCOUNTER.MODE == RANMODE_COUNTER ) { continue ; }
     for ( istore=0; istore < MXSTORE_RAN; istore++ ) {
       RANSTORE8[ilist][istore] = unix_random();
     }
@@ -5156,6 +5224,59 @@ void init_RANLIST(void) {
 
 }  // end of init_RANLIST
 
+
+// **********************************************
+void init_RANCOUNTER(int ISEED) {
+
+  // Created Oct 2026
+  // Switch FlatRan1 to counter-based mode with global seed ISEED.
+  // Caller must call set_RANCOUNTER_KEY for each event;
+  // here the key is set to (0,0) so that FlatRan1 works right away.
+
+  RANCOUNTER.MODE = RANMODE_COUNTER ;
+  RANCOUNTER.SEED = mix64_RANCOUNTER( (unsigned long long)ISEED );
+  set_RANCOUNTER_KEY(0,0);
+
+} // end init_RANCOUNTER
+
+
+// **********************************************
+void set_RANCOUNTER_KEY(int ID, int NTRY) {
+
+  // Created Oct 2026
+  // Set event key for counter-based randoms.
+  // ID   = unique event index (e.g., ilc in the simulation)
+  // NTRY = number of previous attempts with this ID
+  //        (for ID that is re-used after rejected event)
+  // 
+  // Each random list gets its own SplitMix64 sequence starting at 
+  // BASE[ilist], so that the i'th random is mix64(BASE + (i+1)*GAMMA)
+  // and can be computed in any order.
+
+  unsigned long long GAMMA = 0x9E3779B97F4A7C15ULL ;
+  unsigned long long KEY, BASE ;
+  int ilist ;
+
+  KEY  = ((unsigned long long)ID << 32) | (unsigned long long)NTRY ;
+  BASE = mix64_RANCOUNTER( RANCOUNTER.SEED ^ mix64_RANCOUNTER(KEY+GAMMA) );
+
+  for ( ilist=0; ilist <= MXLIST_RAN; ilist++ ) {
+    RANCOUNTER.BASE[ilist] = 
+      mix64_RANCOUNTER( BASE + (unsigned long long)(ilist+1)*GAMMA );
+    NSTORE_RAN[ilist] = 0 ;
+  }
+
+} // end set_RANCOUNTER_KEY
+
+
+// **********************************************
+unsigned long long mix64_RANCOUNTER(unsigned long long X) {
+  // SplitMix64 finalizer: bijective 64-bit hash with good avalanche.
+  X = (X ^ (X >> 30)) * 0xBF58476D1CE4E5B9ULL ;
+  X = (X ^ (X >> 27)) * 0x94D049BB133111EBULL ;
+  return( X ^ (X >> 31) );
+} // end mix64_RANCOUNTER
+
 // **********************************
 double unix_random(void) {
   // Created Jun 9 2018
@@ -5201,6 +5322,7 @@ double FlatRan1(int ilist) {
 
   // return random number between 0 and 1
   // Feb 2013: pass argument 'ilist' to pick random list.
+  // Oct 2026: check RANMODE_COUNTER
 
   if ( ilist < 1 || ilist > NLIST_RAN ) {
     sprintf(c1err,"Invalid ilist = %d", ilist);
@@ -5208,6 +5330,19 @@ double FlatRan1(int ilist) {
     errmsg(SEV_FATAL, 0, fnam, c1err, c2err );
   }
 
+  if ( RANCOUNTER.MODE == RANMODE_COUNTER ) {
+    // NSTORE_RAN is the counter; no wrap-around. 
+    // Keep top 53 bits, and shift by half bin so that 0 < x8 < 1.
+    unsigned long long GAMMA = 0x9E3779B97F4A7C15ULL ;
+    unsigned long long X ;
+    N  = NSTORE_RAN[ilist] ;
+    X  = RANCOUNTER.BASE[ilist] + (unsigned long long)(N+1)*GAMMA ;
+    X  = mix64_RANCOUNTER(X);
+    x8 = ( (double)(X >> 11) + 0.5 ) * (1.0/9007199254740992.0) ;
+    NSTORE_RAN[ilist]++ ;
+    return x8 ;
+  }
+
   // check to wrap around with random list.
   if ( NSTORE_RAN[ilist] >= MXSTORE_RAN ) { NSTORE_RAN[ilist] = 0;  }
 
@@ -6304,6 +6439,194 @@ double dVdz
 }  // end of dVdz
 
 
+// ******************************************
+// Oct 2026: tabulated comoving-distance engine (DLTAB).
+// For each cosmology (OM,OL,w0,wa), int_0^z dz/E(z) is integrated 
+// once on a uniform z-grid (Simpson rule in each bin, cumulative sum)
+// so that all distance queries for this cosmology share the same
+// integration. The MXCACHE_DLTAB most recent cosmologies are kept.
+//
+//   E(z)^2 = OM(1+z)^3 + OK(1+z)^2 + OL(1+z)^{3(1+w0+wa)} e^{-3wa z/(1+z)}
+//   OK     = 1 - OM - OL
+//
+// get_DLTAB fills the cache and is not thread safe; find_DLTAB and
+// the chi/dL functions only read the tables.
+
+void init_DLTAB(double ZMAX, double ZBIN) {
+
+  // Set z-grid for new tables and clear the cache.
+
+  int islot ;
+
+  for(islot=0; islot < DLTAB.NCACHE; islot++ ) 
+    { free(DLTAB.CHI[islot]); }
+
+  DLTAB.NZBIN  = (int)(ZMAX/ZBIN + 0.5) ;
+  DLTAB.ZBIN   = ZBIN ;
+  DLTAB.ZMAX   = ZBIN * (double)DLTAB.NZBIN ;
+  DLTAB.NCACHE = DLTAB.NCALL = DLTAB.NCALC = 0 ;
+  DLTAB.INIT_FLAG = 1 ;
+
+} // end init_DLTAB
+
+
+double EzInv_DLTAB(double *COSPAR, double z) {
+
+  // return 1/E(z) for COSPAR = { OM, OL, w0, wa }
+
+  double OM = COSPAR[0], OL = COSPAR[1], w0 = COSPAR[2], wa = COSPAR[3] ;
+  double OK = 1.0 - OM - OL ;
+  double zz = 1.0 + z, zz2 = zz*zz, rhode, sqE ;
+
+  rhode = OL * pow(zz, 3.0*(1.0+w0+wa) ) ;
+  if ( wa != 0.0 ) { rhode *= exp(-3.0*wa*z/zz) ; }
+
+  sqE = OM*zz2*zz + rhode + OK*zz2 ;
+  return( 1.0/sqrt(sqE) );
+
+} // end EzInv_DLTAB
+
+
+int find_DLTAB(double OM, double OL, double w0, double wa) {
+
+  // return cache slot for this cosmology, or -1 if not in cache.
+  // Does not modify DLTAB.
+
+  int islot ;
+  double *COSPAR ;
+
+  for(islot=0; islot < DLTAB.NCACHE; islot++ ) {
+    COSPAR = DLTAB.COSPAR[islot] ;
+    if ( COSPAR[0] == OM && COSPAR[1] == OL && 
+	 COSPAR[2] == w0 && COSPAR[3] == wa ) { return(islot); }
+  }
+  return(-1);
+
+} // end find_DLTAB
+
+
+int get_DLTAB(double OM, double OL, double w0, double wa) {
+
+  // return cache slot for this cosmology; if not in cache,
+  // compute table in new slot, or replace least-recently used slot.
+
+  int    islot, iz, NZBIN ;
+  double ZBIN, z0, f0, fmid, f1, *COSPAR, *CHI ;
+
+  // ----------- BEGIN -----------
+
+  if ( DLTAB.INIT_FLAG == 0 ) { init_DLTAB(ZMAX_SNANA, ZBIN_DLTAB); }
+
+  DLTAB.NCALL++ ;
+
+  islot = find_DLTAB(OM, OL, w0, wa);
+  if ( islot >= 0 ) 
+    { DLTAB.LASTCALL[islot] = DLTAB.NCALL;  return(islot); }
+
+  // pick new or least-recently used slot
+  if ( DLTAB.NCACHE < MXCACHE_DLTAB ) {
+    islot = DLTAB.NCACHE ;
+    DLTAB.CHI[islot] = (double*)malloc( (DLTAB.NZBIN+1)*sizeof(double) );
+    DLTAB.NCACHE++ ;
+  }
+  else {
+    int i;   islot = 0 ;
+    for(i=1; i < MXCACHE_DLTAB; i++ ) 
+      { if ( DLTAB.LASTCALL[i] < DLTAB.LASTCALL[islot] ) { islot=i; } }
+  }
+
+  COSPAR    = DLTAB.COSPAR[islot] ;
+  COSPAR[0] = OM;  COSPAR[1] = OL;  COSPAR[2] = w0;  COSPAR[3] = wa ;
+  DLTAB.LASTCALL[islot] = DLTAB.NCALL ;
+  DLTAB.NCALC++ ;
+
+  CHI   = DLTAB.CHI[islot] ;
+  NZBIN = DLTAB.NZBIN ;
+  ZBIN  = DLTAB.ZBIN ;
+
+  CHI[0] = 0.0 ;
+  f0     = EzInv_DLTAB(COSPAR, 0.0);
+  for(iz=0; iz < NZBIN; iz++ ) {
+    z0     = ZBIN * (double)iz ;
+    fmid   = EzInv_DLTAB(COSPAR, z0 + 0.5*ZBIN );
+    f1     = EzInv_DLTAB(COSPAR, z0 + ZBIN );
+    CHI[iz+1] = CHI[iz] + ZBIN*(f0 + 4.0*fmid + f1)/6.0 ;
+    f0     = f1 ;
+  }
+
+  return(islot) ;
+
+} // end get_DLTAB
+
+
+double chi_DLTAB(int ISLOT, double z) {
+
+  // Return dimensionless comoving distance int_0^z dz/E(z) from 
+  // table ISLOT; the partial bin (or z beyond the table) is 
+  // integrated with Simpson's rule.
+
+  double *COSPAR = DLTAB.COSPAR[ISLOT] ;
+  double *CHI    = DLTAB.CHI[ISLOT] ;
+  double ZBIN    = DLTAB.ZBIN ;
+  double z0, dz, chi, f0, fmid, f1 ;
+  int    iz, NSTEP, istep ;
+
+  // ----------- BEGIN -----------
+
+  if ( z <= 0.0 ) { return(0.0); }
+
+  iz = (int)(z/ZBIN) ;
+  if ( iz > DLTAB.NZBIN ) { iz = DLTAB.NZBIN ; }
+  z0  = ZBIN * (double)iz ;
+  chi = CHI[iz] ;
+
+  // integrate from grid node z0 to z in steps <= ZBIN
+  NSTEP = (int)ceil( (z-z0)/ZBIN - 1.0E-9 ) ;
+  if ( NSTEP < 1 ) { NSTEP = 1; }
+  dz  = (z-z0) / (double)NSTEP ;
+  f0  = EzInv_DLTAB(COSPAR, z0);
+  for(istep=0; istep < NSTEP; istep++ ) {
+    fmid = EzInv_DLTAB(COSPAR, z0 + 0.5*dz);
+    f1   = EzInv_DLTAB(COSPAR, z0 + dz);
+    chi += dz*(f0 + 4.0*fmid + f1)/6.0 ;
+    z0  += dz;   f0 = f1 ;
+  }
+
+  return(chi);
+
+} // end chi_DLTAB
+
+
+double dL_DLTAB(int ISLOT, double zCMB, double zHEL) {
+
+  // Return luminosity distance in units of c/H0,
+  //    dL = (1+zHEL) * S_k(chi(zCMB)) ,
+  // with sin/sinh for curvature |OK| > 1.0E-6.
+
+  double OK  = 1.0 - DLTAB.COSPAR[ISLOT][0] - DLTAB.COSPAR[ISLOT][1] ;
+  double chi = chi_DLTAB(ISLOT, zCMB);
+  double sqOK, r ;
+
+  if ( OK < -1.0E-6 ) 
+    { sqOK = sqrt(-OK);  r = sin(sqOK*chi)/sqOK ; }
+  else if ( OK > 1.0E-6 ) 
+    { sqOK = sqrt(OK);   r = sinh(sqOK*chi)/sqOK ; }
+  else
+    { r = chi ; }
+
+  return( (1.0+zHEL) * r );
+
+} // end dL_DLTAB
+
+
+void dL_DLTAB_LIST(int ISLOT, int NZ, double *zCMB, double *zHEL, 
+		   double *dL) {
+  // batched dL_DLTAB for NZ redshifts.
+  int i;
+  for(i=0; i < NZ; i++ ) { dL[i] = dL_DLTAB(ISLOT, zCMB[i], zHEL[i]); }
+} // end dL_DLTAB_LIST
+
+
 // ******************************************
 double Hzinv_integral 
 ( 
@@ -6317,29 +6640,18 @@ double Hzinv_integral
 
   // 
   // Jun 2016: bug fix, (float)NZbin -> (double)NZbin
+  // Oct 2026: replace midpoint sum with tabulated integral (DLTAB),
+  //           which is computed once per cosmology.
 
-  int iz, NZbin ;
-  double dz, Hz, xz, Ztmp, sum, Hzinv, KAPPA, SQRT_KAPPA ; 
+  int islot ;
+  double sum, Hzinv, KAPPA, SQRT_KAPPA ; 
 
   // ------ return integral c*r(z) = int c*dz/H(z) -------------
   // Note that D_L = (1+z)*Hzinv_integral
 
-  sum = 0.0;
-
-  NZbin = (int)( (Zmax-Zmin) * 1000.0 ) ;
-  if ( NZbin < 10 ) { NZbin = 10 ; }
-  dz  = (Zmax-Zmin) / (double)NZbin ;      // integration binsize
-
-  for ( iz=1; iz <= NZbin; iz++ ) {
-    xz   = (double)iz ;
-    Ztmp = Zmin + dz * (xz - 0.5) ;
-    Hz   = Hzfun ( H0, OM, OL, W, Ztmp );
-    sum += (1.0/Hz) ;
-  }
-
-  // remove H0 factor from inetgral before checking curvature.
-
-  sum *= (dz * H0) ;
+  // dimensionless integral (without H0 factor) 
+  islot = get_DLTAB(OM, OL, W, 0.0);
+  sum   = chi_DLTAB(islot,Zmax) - chi_DLTAB(islot,Zmin) ;
 
   // check for curvature
   KAPPA      = 1.0 - OM - OL ; 
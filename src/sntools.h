@@ -115,6 +115,18 @@ int     NLIST_RAN;         // Number of lists
 int     NSTORE_RAN[MXLIST_RAN+1] ;
 double  RANFIRST[MXLIST_RAN+1], RANLAST[MXLIST_RAN+1]; // for syncing.
 
+// Oct 2026: optional counter-based randoms; FlatRan1 returns a hash
+// of (SEED, event KEY, ilist, NSTORE_RAN[ilist]) instead of reading
+// RANSTORE8, so that any event is reproduced without replaying
+// the previous events, and there is no per-event refill or wrap-around.
+#define RANMODE_LIST     0  // refill RANSTORE8 with random() each event
+#define RANMODE_COUNTER  1  // counter-based (see set_RANCOUNTER_KEY)
+struct {
+  int MODE ;                                   // RANMODE_[LIST,COUNTER]
+  unsigned long long SEED ;                    // global seed
+  unsigned long long BASE[MXLIST_RAN+1] ;      // per-event & per-list key
+} RANCOUNTER ;
+
 // errmsg parameters 
 char c1err[200];   // for kcorerr utility 
 char c2err[200];   // for kcorerr utility 
@@ -360,6 +372,13 @@ void set_exit_errcode__(int *ERRCODE);
 int  IGNOREFILE(char *fileName);
 int  ignorefile_(char *fileName);
 
+// Oct 2026: checksum and temp-file utilities for cache files
+#define CKSUM_INIT_FNV1A  14695981039346656037ULL // FNV-1a offset basis
+void  cksum_FNV1a(void *buf, size_t nbyte, unsigned long long *CKSUM);
+void  set_TEMPFILE(char *fileName, char *tmpFile);
+FILE *open_TEMPFILE(char *fileName, char *tmpFile);
+int   close_TEMPFILE(FILE *fp, int NERR, char *tmpFile, char *fileName);
+
 int strcmp_ignoreCase(char *str1, char *str2) ;
 
 
@@ -637,6 +656,30 @@ double dlmag_ (double *H0, double *OM, double *OL, double *W,
 
 double zcmb_dLmag_invert(double H0, double OM, double OL, double W, double MU);
 
+// Oct 2026: tabulated comoving distance, shared by all programs.
+// See init_DLTAB in sntools.c
+#define MXCACHE_DLTAB  8      // number of recent cosmologies kept
+#define ZBIN_DLTAB     0.001  // default z-bin size of table
+struct {
+  int    INIT_FLAG ;
+  int    NZBIN ;             // number of z-bins per table
+  double ZBIN, ZMAX ;        // z-bin size and max z of table
+  int    NCACHE ;            // number of filled tables
+  int    NCALL, NCALC ;      // calls to get_DLTAB, and tables computed
+  double COSPAR[MXCACHE_DLTAB][4] ; // OM, OL, w0, wa
+  int    LASTCALL[MXCACHE_DLTAB] ;  // NCALL at last use (for LRU)
+  double *CHI[MXCACHE_DLTAB] ;      // int_0^z dz/E at z = iz*ZBIN
+} DLTAB ;
+
+void   init_DLTAB(double ZMAX, double ZBIN);
+double EzInv_DLTAB(double *COSPAR, double z);
+int    find_DLTAB(double OM, double OL, double w0, double wa);
+int    get_DLTAB(double OM, double OL, double w0, double wa);
+double chi_DLTAB(int ISLOT, double z);
+double dL_DLTAB(int ISLOT, double zCMB, double zHEL);
+void   dL_DLTAB_LIST(int ISLOT, int NZ, double *zCMB, double *zHEL, 
+		     double *dL);
+
 double angSep( double RA1,double DEC1,
 	       double RA2,double DEC2, double  scale);
 
@@ -644,6 +687,9 @@ double angSep( double RA1,double DEC1,
 // random-number generators.
 // May 2014: snran1 -> Flatran1,  float rangen -> double FlatRan
 void   init_RANLIST(void);
+void   init_RANCOUNTER(int ISEED);
+void   set_RANCOUNTER_KEY(int ID, int NTRY);
+unsigned long long mix64_RANCOUNTER(unsigned long long X);
 double unix_random(void) ;
 double FlatRan (int ilist, double *range);  //return rnmd on range[0-1]
 double FlatRan1(int ilist);          // return 0 < random  < 1
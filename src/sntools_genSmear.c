@@ -64,6 +64,12 @@
 
  July 29 2016: new utility exec_genSmear_override().
 
+ Oct 2026: event-level cache of magSmear vs. lambda (GENSMEAR_CACHE)
+           for models that do not depend on Trest; each lambda list
+           (i.e., each band) is evaluated once per event and re-used 
+           for all epochs. Node search for sorted lambda lists uses
+           INODE_LAMBDA_NEXT instead of scanning all nodes per lambda.
+
 **********************************/
 
 #include <stdio.h> 
@@ -107,6 +113,14 @@ void  init_genSmear_FLAGS(double SCALE) {
 
   GENSMEAR.SCALE = SCALE ; // Oct 9 2018
 
+  // Oct 2026: smear is Trest-independent unless a model says otherwise
+  GENSMEAR_CACHE.USE       = 1 ;
+  GENSMEAR_CACHE.NSLOT     = 0 ;
+  GENSMEAR_CACHE.NCALL_HIT = 0 ;
+  int islot ;
+  for(islot=0; islot < MXSLOT_GENSMEAR_CACHE; islot++ ) 
+    { GENSMEAR_CACHE.MXLAM[islot] = 0 ; }
+
   // abort on unitialized NSMEARPAR_OVERRIDE
   if ( NSMEARPAR_OVERRIDE < 0 || NSMEARPAR_OVERRIDE >= MXSMEARPAR_OVERRIDE ) {
     sprintf(c1err,"Unitialized NSMEARPAR_OVERRIDE=%d", NSMEARPAR_OVERRIDE);
@@ -136,6 +150,7 @@ void get_genSmear(double Trest, int NLam, double *Lam,
   //
   // Oct 9 2018: check option to scale the magSmear values
   //
+  // Oct 2026: check event cache before evaluating model.
   //
   char fnam[] = "get_genSmear" ;
 
@@ -143,6 +158,16 @@ void get_genSmear(double Trest, int NLam, double *Lam,
 
   NCALL_GENSMEAR++ ;
 
+  if ( GENSMEAR_CACHE.USE ) {
+    int islot = islot_genSmear_CACHE(NLam, Lam);
+    if ( islot >= 0 ) {
+      memcpy(magSmear, GENSMEAR_CACHE.MAGSMEAR[islot], NLam*sizeof(double));
+      MAGSMEAR_COH = GENSMEAR_CACHE.MAGSMEAR_COH ;
+      GENSMEAR_CACHE.NCALL_HIT++ ;
+      return ;
+    }
+  }
+
   MAGSMEAR_COH = 0.0 ; // Jun 14 2016
 
   // abort if more than one model has been initialized.
@@ -190,11 +215,79 @@ void get_genSmear(double Trest, int NLam, double *Lam,
       { magSmear[ilam] *= GENSMEAR.SCALE; }
   }
 
+  if ( GENSMEAR_CACHE.USE ) { store_genSmear_CACHE(NLam, Lam, magSmear); }
+
   return ;
 
 } // end of get_genSmear
 
 
+// ********************************
+int istat_genSmear_Trest(void) {
+  // Oct 2026: return 1 if magSmear depends on Trest; 
+  // if 0, magSmear can be computed once per event for each lambda.
+  if ( NUSE_GENSMEAR == 0 ) { return 0 ; }
+  return ( GENSMEAR_CACHE.USE == 0 ) ;
+}
+
+// ********************************
+void reset_genSmear_CACHE(void) {
+  // Oct 2026: called for each new set of randoms or SN params.
+  GENSMEAR_CACHE.NSLOT = 0 ;
+}
+
+// ********************************
+int islot_genSmear_CACHE(int NLam, double *Lam) {
+
+  // Created Oct 2026
+  // Return cache slot for which stored lambda list is
+  // identical to input *Lam; return -1 if not found.
+
+  int islot, NSLOT = GENSMEAR_CACHE.NSLOT ;
+  int MEMD = NLam * sizeof(double);
+
+  for(islot=0; islot < NSLOT; islot++ ) {
+    if ( GENSMEAR_CACHE.NLAM[islot] != NLam ) { continue ; }
+    if ( memcmp(GENSMEAR_CACHE.LAM[islot], Lam, MEMD) == 0 ) 
+      { return islot ; }
+  }
+
+  return -1 ;
+
+} // end islot_genSmear_CACHE
+
+// ********************************
+void store_genSmear_CACHE(int NLam, double *Lam, double *magSmear) {
+
+  // Created Oct 2026
+  // Store magSmear for this *Lam list in next cache slot.
+  // If all slots are used, just skip caching for this list.
+
+  int islot = GENSMEAR_CACHE.NSLOT ;
+  int MEMD  = NLam * sizeof(double);
+
+  if ( islot >= MXSLOT_GENSMEAR_CACHE ) { return ; }
+  if ( NLam <= 0 ) { return ; }
+
+  if ( NLam > GENSMEAR_CACHE.MXLAM[islot] ) {
+    if ( GENSMEAR_CACHE.MXLAM[islot] > 0 ) {
+      free(GENSMEAR_CACHE.LAM[islot]);
+      free(GENSMEAR_CACHE.MAGSMEAR[islot]);
+    }
+    GENSMEAR_CACHE.LAM[islot]      = (double*) malloc(MEMD);
+    GENSMEAR_CACHE.MAGSMEAR[islot] = (double*) malloc(MEMD);
+    GENSMEAR_CACHE.MXLAM[islot]    = NLam ;
+  }
+
+  memcpy(GENSMEAR_CACHE.LAM[islot],      Lam,      MEMD);
+  memcpy(GENSMEAR_CACHE.MAGSMEAR[islot], magSmear, MEMD);
+  GENSMEAR_CACHE.NLAM[islot]   = NLam ;
+  GENSMEAR_CACHE.MAGSMEAR_COH  = MAGSMEAR_COH ;
+  GENSMEAR_CACHE.NSLOT++ ;
+
+} // end store_genSmear_CACHE
+
+
 // *********************************************
 void init_genSmear_USRFUN(int NPAR, double *parList, double *LAMRANGE) {
 
@@ -239,6 +332,7 @@ void init_genSmear_USRFUN(int NPAR, double *parList, double *LAMRANGE) {
 
   // load global struct
   GENSMEAR_USRFUN.USE   = 1 ;   NUSE_GENSMEAR++ ;
+  GENSMEAR_CACHE.USE    = 0 ;   // depends on Trest
 
   i = -1 ;
   
@@ -345,6 +439,7 @@ void SETRANGauss_genSmear(int NRAN, double *ranList) {
   }
 
   GENSMEAR.NSET_RANGauss++ ;
+  reset_genSmear_CACHE();
 
   // store randoms; official list starts at 1.
   cList[0] = 0 ;
@@ -382,6 +477,7 @@ void SETRANFlat_genSmear(int NRAN, double *ranList) {
   }
 
   GENSMEAR.NSET_RANFlat++ ;
+  reset_genSmear_CACHE();
 
   // store randoms; official list starts at 1.
   cList[0] = 0 ;
@@ -405,6 +501,7 @@ void SETSNPAR_genSmear(double shape, double color, double redshift) {
   GENSMEAR.SHAPE    = shape ;
   GENSMEAR.COLOR    = color ;
   GENSMEAR.REDSHIFT = redshift ;
+  reset_genSmear_CACHE();
 
   // store powers of redshift 
   int i;  double zpow ;
@@ -527,7 +624,8 @@ void get_genSmear_USRFUN(double Trest, int NLam, double *Lam,
     lam = Lam[ilam];
     
     // find nodes that  bound this 'lam'
-    INODE = INODE_LAMBDA(lam, NNODE, GENSMEAR_USRFUN.LAM_NODE );
+    INODE = INODE_LAMBDA_NEXT(lam, NNODE, GENSMEAR_USRFUN.LAM_NODE,
+			      LAST_INODE );
 
     if ( INODE < 0 ) {
       sprintf(c1err,"Could not find INODE for lam=%7.1f", lam);
@@ -1118,7 +1216,7 @@ void get_genSmear_SALT2(double Trest, int NLam, double *Lam,
   double *ptrSIGCOH = GENSMEAR_SALT2.SIGCOH_LAM.YVAL ;
   int OPT_INTERP=1;
 
-  int    ilam, INODE, N, LDMP, NLAM ;
+  int    ilam, INODE = -9, N, LDMP, NLAM ;
   double lam, rCOH, r0, r1, SMEAR0, SMEAR, MINLAM, MAXLAM ;
   double LAM_NODE[2], MAG_NODE[2];
   char   fnam[] = "get_genSmear_SALT2";
@@ -1157,7 +1255,8 @@ void get_genSmear_SALT2(double Trest, int NLam, double *Lam,
     if ( lam <= MINLAM ) { continue ; }
     if ( lam >= MAXLAM ) { continue ; }
 
-    INODE = INODE_LAMBDA(lam, GENSMEAR_SALT2.NNODE, GENSMEAR_SALT2.LAM_NODE);
+    INODE = INODE_LAMBDA_NEXT(lam, GENSMEAR_SALT2.NNODE, 
+			      GENSMEAR_SALT2.LAM_NODE, INODE);
     if ( INODE < 0 || INODE >= GENSMEAR_SALT2.NNODE ) {      
       sprintf(c1err,"Could not find INODE for lam=%7.1f", lam);
       sprintf(c2err,"NNODE=%d  INODE=%d", GENSMEAR_SALT2.NNODE, INODE) ;
@@ -1376,7 +1475,7 @@ void  init_genSmear_Chotard11(int OPT_farUV) {
 void get_genSmear_Chotard11(double Trest, int NLam, double *Lam, 
 			    double *magSmear) {
 
-  int    ilam, i, j, IFILT ;
+  int    ilam, i, j, IFILT = -9 ;
   double lam, tmp, SCATTER_VALUES[NBAND_C11] ;
 
   double LAMCEN[NBAND_C11] = 
@@ -1411,7 +1510,7 @@ void get_genSmear_Chotard11(double Trest, int NLam, double *Lam,
       tmp   = SCATTER_VALUES[NBAND_C11-1];  // extend redward of I band
     }
     else {
-      IFILT = INODE_LAMBDA(lam, NBAND_C11, LAMCEN);
+      IFILT = INODE_LAMBDA_NEXT(lam, NBAND_C11, LAMCEN, IFILT);
       if ( IFILT < 0 ) {
 	sprintf(c1err,"Could not find UBVRI band for lam=%7.1f", lam);
 	sprintf(c2err,"ilam = %d", ilam);
@@ -1969,7 +2068,7 @@ void get_genSmear_VCR(double Trest, int NLam, double *Lam,
   // to the Si velocity.
   //
 
-  int ilam, NC, i, j, IFILTDEF, iband, NBAND ;
+  int ilam, NC, i, j, IFILTDEF, iband, NBAND, INODE = -9 ;
 
   double 
     VSI, VSI_zShift, SUMPROB, tmp, lam, ranB, sigB, magSmearB
@@ -2092,7 +2191,7 @@ void get_genSmear_VCR(double Trest, int NLam, double *Lam,
       tmp   = MAGSMEAR[NBAND-1] ;  // extend redward 
     }
     else {
-      iband = INODE_LAMBDA(lam, NBAND, LAMCEN);
+      iband = INODE = INODE_LAMBDA_NEXT(lam, NBAND, LAMCEN, INODE);
       if ( iband < 0 || iband >= NBAND ) {
 	sprintf(c1err,"Could not find band for lam=%7.1f", lam);
 	sprintf(c2err,"ilam = %d", ilam);
@@ -2335,6 +2434,37 @@ int INODE_LAMBDA(double LAM, int NNODE, double *LAM_NODES) {
 } // end of INODE_LAMBDA
 
 
+// *********************************************************
+int INODE_LAMBDA_NEXT(double LAM, int NNODE, double *LAM_NODES, 
+		      int INODE_LAST) {
+
+  // Created Oct 2026
+  // Same as INODE_LAMBDA (for increasing LAM_NODES), but start 
+  // from INODE_LAST and walk to neighboring nodes; for a sorted 
+  // lambda list, this is ~1 step per lambda instead of scanning
+  // all nodes. Pass INODE_LAST < 0 for first lambda.
+
+  int INODE ;
+
+  // -------------- BEGIN -----------
+
+  if ( NNODE < 2 ) { return -9 ; }
+
+  INODE = INODE_LAST ;
+  if ( INODE < 0       ) { INODE = 0 ; }
+  if ( INODE > NNODE-2 ) { INODE = NNODE-2 ; }
+
+  while ( INODE < NNODE-2 && LAM >= LAM_NODES[INODE+1] ) { INODE++ ; }
+  while ( INODE > 0       && LAM <  LAM_NODES[INODE]   ) { INODE-- ; }
+
+  if ( LAM >= LAM_NODES[INODE] && LAM <= LAM_NODES[INODE+1] ) 
+    { return INODE ; }
+  else
+    { return -9 ; }
+
+} // end of INODE_LAMBDA_NEXT
+
+
 // ===============================================
 void extraFilters_4genSmear(char *modelName,      // (I) name of scatter model
 			    int *NFILT_extra,    // (O) Number of extra filt
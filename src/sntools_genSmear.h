@@ -67,6 +67,13 @@ void  get_genSmear_private(double Trest, int NLam, double *Lam,
 			   double *magSmear ) ;
 
 int INODE_LAMBDA(double LAM, int NNODE, double *LAM_NODES);
+int INODE_LAMBDA_NEXT(double LAM, int NNODE, double *LAM_NODES, 
+		      int INODE_LAST);
+
+int  istat_genSmear_Trest(void);
+void reset_genSmear_CACHE(void);
+int  islot_genSmear_CACHE(int NLam, double *Lam);
+void store_genSmear_CACHE(int NLam, double *Lam, double *magSmear);
 
 void extraFilters_4genSmear(char *modelName,
 			    int *NFILT_extra, int *IFILTOBS_extra) ;
@@ -262,6 +269,20 @@ struct GENSMEAR_PRIVATE {
 int NUSE_GENSMEAR ;
 int NCALL_GENSMEAR ;
 
+// Oct 2026: event-level cache of magSmear for each lambda list 
+// (i.e., each band); reset for each new set of randoms.
+#define MXSLOT_GENSMEAR_CACHE 2*MXFILTINDX
+struct GENSMEAR_CACHE {
+  int    USE ;         // 1 -> magSmear does not depend on Trest
+  int    NSLOT ;       // number of filled slots for this event
+  int    NLAM[MXSLOT_GENSMEAR_CACHE] ;
+  int    MXLAM[MXSLOT_GENSMEAR_CACHE] ;     // allocated size
+  double *LAM[MXSLOT_GENSMEAR_CACHE] ;      // rest-frame lambda list
+  double *MAGSMEAR[MXSLOT_GENSMEAR_CACHE] ; // magSmear at each LAM
+  double MAGSMEAR_COH ;
+  int    NCALL_HIT ;   // number of get_genSmear calls using cache
+} GENSMEAR_CACHE ;
+
 
 // --------------------------------------------------------------------
 // Override params passed from simulation to allow command-line overrides
@@ -128,6 +128,16 @@
 
     + account for VPEC when SN coords are transferred to host.
 
+  Oct 2026:
+    + optional binary HOSTLIB cache (sim-input key HOSTLIB_CACHE_DIR);
+      see cksum_HOSTLIB_CACHE, read_HOSTLIB_CACHE, write_HOSTLIB_CACHE.
+    + O(logN) host selection in GEN_SNHOST_GALID: binary search on
+      ZTRUE and WGTSUM, and Fenwick trees of available hosts
+      (see init_SAMEHOST_FENWICK).
+    + faster GEN_SNHOST_GALMAG: Sersic profile table replaces
+      pow & exp in get_GALFLUX_HOSTLIB, and Gauss2d overlaps are
+      computed once in init_GALMAG_HOSTLIB.
+
 =========================================================== */
 
 #include <stdio.h>
@@ -136,6 +146,9 @@
 #include <string.h>
 #include <time.h>
 #include <math.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 
 #include "sntools.h"
 #include "sntools_trigger.h"
@@ -180,8 +193,12 @@ void INIT_HOSTLIB(void) {
   // read header info : NVAR, VARNAMES ...
   rdhead_HOSTLIB(fp_hostlib);
 
-  // read GAL: keys
-  rdgal_HOSTLIB(fp_hostlib);
+  // check for binary cache from previous job (Oct 2026)
+  cksum_HOSTLIB_CACHE();
+
+  // read GAL: keys, unless already loaded from binary cache
+  if ( read_HOSTLIB_CACHE() == 0 ) 
+    { rdgal_HOSTLIB(fp_hostlib); }
 
   // summarize SNPARams that were/weren't found
   summary_snpar_HOSTLIB();
@@ -193,17 +210,27 @@ void INIT_HOSTLIB(void) {
   else
     { fclose(fp_hostlib); } // close normal file stream
 
-  // sort HOSTLIB entries by redshift
-  sortz_HOSTLIB();
+  if ( HOSTLIB_CACHE.USE == 0 ) {
+    // sort HOSTLIB entries by redshift
+    sortz_HOSTLIB();
 
-  // abort if any GALID+ZTRUE pair appears more than once
-  check_duplicate_GALID();
+    // abort if any GALID+ZTRUE pair appears more than once
+    check_duplicate_GALID();
   
-  // set redshift pointers for faster lookup
-  zptr_HOSTLIB();
+    // set redshift pointers for faster lookup
+    zptr_HOSTLIB();
 
-  // setup optional wgt-map grid
-  init_HOSTLIB_WGTMAP();
+    // setup optional wgt-map grid
+    init_HOSTLIB_WGTMAP();
+
+    // write binary cache for next job
+    write_HOSTLIB_CACHE();
+  }
+  else {
+    // same checks as for text HOSTLIB, but on the mapped columns
+    check_duplicate_GALID();
+    check_HOSTLIB_WGTMAP();
+  }
 
   // read optional EFF(zPHOT) vs. ZTRUE (Aug 2015)
   init_HOSTLIB_ZPHOTEFF();
@@ -1818,17 +1845,15 @@ void init_HOSTLIB_WGTMAP(void) {
   // Jan 27 2017: fix bug mallocing GRIDMAP_HOSTLIB_WGT.FUNVAL;
   //              I8p -> I8p*2
   // 
-  int  i, NDIM, ivar, ivar_STORE, ID, NFUN, NROW, istat ;
-  int  NGAL, NCHECK, NN, igal, igal_difmax, LDMPWGT, VBOSE ;
+  int  NDIM, ivar, ivar_STORE, ID, NFUN, NROW, istat ;
+  int  NGAL, igal, LDMPWGT, VBOSE ;
 
-  long long GALID, GALID_CHECK ;
+  long long GALID ;
   int I8  = sizeof(double);
 
   double
     VAL, WGT, WGTSUM, WGTSUM_LAST, SNMAGSHIFT
     ,VAL_WGTMAP[MXVAR_HOSTLIB]
-    ,ZTRUE, ZTRUE_CHECK, ZDIF, WGT_EXACT, WGT_INTERP, WDIF
-    ,WDIF_SUM, SQWDIF_SUM, WDIF_AVG, WDIF_RMS, XN, WDIF_MAX, SQTMP
     ,*PTRFUN[2]
     ,TMPVAL[2]
     ;
@@ -1864,7 +1889,6 @@ void init_HOSTLIB_WGTMAP(void) {
     HOSTLIB_WGTMAP.SNMAGSHIFT[igal] = 0.0 ;
 
     GALID  = get_GALID_HOSTLIB(igal);
-    ZTRUE  = get_ZTRUE_HOSTLIB(igal);
 
     if ( NROW == 0 ) {
       WGT        = 1.0 ;
@@ -1907,15 +1931,6 @@ void init_HOSTLIB_WGTMAP(void) {
     HOSTLIB_WGTMAP.SNMAGSHIFT[igal] = SNMAGSHIFT ;
     WGTSUM_LAST =  WGTSUM ;
 
-    // store IGAL if this GALID is on the check-list
-    for ( i=0; i < HOSTLIB_WGTMAP.NCHECKLIST; i++ ) {
-      GALID_CHECK = HOSTLIB_WGTMAP.CHECKLIST_GALID[i];
-      ZTRUE_CHECK = HOSTLIB_WGTMAP.CHECKLIST_ZTRUE[i] ;
-      ZDIF        = fabs(ZTRUE - ZTRUE_CHECK) ;
-      if ( GALID == GALID_CHECK && ZDIF < 2.0E-4 ) 
-	{ HOSTLIB_WGTMAP.CHECKLIST_IGAL[i] = igal ; }
-    }
-
 
     LDMPWGT = ( igal == -9 ) ; //  INPUTS.HOSTLIB_MAXREAD - 10  );
     if ( LDMPWGT ) {
@@ -1928,7 +1943,44 @@ void init_HOSTLIB_WGTMAP(void) {
   } // end if igal loop
 
 
-  // --------------------------
+  // compare with optional WGTMAP_CHECK values
+  check_HOSTLIB_WGTMAP();
+
+  //  debugexit("checklist"); // xxxxxxxxx
+
+} // end of init_HOSTLIB_WGTMAP
+
+
+// =======================================
+void check_HOSTLIB_WGTMAP(void) {
+
+  // Created Oct 2026 (moved from init_HOSTLIB_WGTMAP)
+  // Find IGAL for each GALID on the WGTMAP_CHECK list, and compare
+  // interpolated WGT with exact WGT. Called after init_HOSTLIB_WGTMAP,
+  // or after WGT is loaded from binary HOSTLIB cache.
+
+  int    i, igal, NGAL, NCHECK, NN, igal_difmax ;
+  long long GALID, GALID_CHECK ;
+  double ZTRUE, ZTRUE_CHECK, ZDIF, WGT_EXACT, WGT_INTERP, WDIF
+    ,WDIF_SUM, SQWDIF_SUM, WDIF_AVG, WDIF_RMS, XN, WDIF_MAX, SQTMP ;
+
+  // --------- BEGIN -----------
+
+  NGAL   = HOSTLIB.NGAL_STORE;
+
+  // store IGAL if this GALID is on the check-list
+  for ( i=0; i < HOSTLIB_WGTMAP.NCHECKLIST; i++ ) {
+    GALID_CHECK = HOSTLIB_WGTMAP.CHECKLIST_GALID[i];
+    ZTRUE_CHECK = HOSTLIB_WGTMAP.CHECKLIST_ZTRUE[i] ;
+    for ( igal=0; igal < NGAL; igal++ ) {
+      GALID  = get_GALID_HOSTLIB(igal);
+      ZTRUE  = get_ZTRUE_HOSTLIB(igal);
+      ZDIF   = fabs(ZTRUE - ZTRUE_CHECK) ;
+      if ( GALID == GALID_CHECK && ZDIF < 2.0E-4 ) 
+	{ HOSTLIB_WGTMAP.CHECKLIST_IGAL[i] = igal ; }
+    }
+  }
+
   // verify interpolated WGTMAP values against optional list of 
   // exact WGT values specified by the WGTMAP_CHECK keys.
 
@@ -1971,11 +2023,322 @@ void init_HOSTLIB_WGTMAP(void) {
     fflush(stdout);
   }
 
+} // end of check_HOSTLIB_WGTMAP
 
-  //  debugexit("checklist"); // xxxxxxxxx
 
-} // end of init_HOSTLIB_WGTMAP
+// =======================================
+void cksum_HOSTLIB_CACHE(void) {
+
+  // Created Oct 2026
+  // If HOSTLIB_CACHE_DIR is set, compute checksum of the HOSTLIB
+  // and WGTMAP file names, sizes and modification times, the stored 
+  // variables and the cuts applied in rdgal_HOSTLIB. Then construct name of cache file,
+  //   [HOSTLIB_CACHE_DIR]/[HOSTLIB base name]_[checksum].HOSTLIB_BIN
+  // Must be called after rdhead_HOSTLIB so that VARNAME_STORE is set.
+
+  unsigned long long CKSUM = CKSUM_INIT_FNV1A ;
+  int  ivar, NVAR_STORE = HOSTLIB.NVAR_STORE ;
+  int  VERSION = VERSION_HOSTLIB_CACHE ;
+  char fileName[MXPATHLEN], baseName[MXPATHLEN], *ptr ;
+  double CUTS[6] ;
+
+  // ----------- BEGIN -----------
+
+  HOSTLIB_CACHE.USE         = 0 ;
+  HOSTLIB_CACHE.FILENAME[0] = 0 ;
+  HOSTLIB_CACHE.CHECKSUM    = 0 ;
+  HOSTLIB_CACHE.MAP         = NULL ;
+  HOSTLIB_CACHE.SIZE_MAP    = 0 ;
+
+  if ( IGNOREFILE(INPUTS.HOSTLIB_CACHE_DIR) ) { return ; }
+
+  // HOSTLIB file (gzipped file if gzipped)
+  sprintf(fileName, "%s", HOSTLIB.FILENAME);
+  if ( HOSTLIB.GZIPFLAG && strstr(fileName,".gz") == NULL ) 
+    { strcat(fileName,".gz"); }
+  cksumFile_HOSTLIB_CACHE(fileName, &CKSUM);
+
+  // supplemental WGTMAP file
+  if ( !IGNOREFILE(INPUTS.HOSTLIB_WGTMAP_FILE) ) 
+    { cksumFile_HOSTLIB_CACHE(INPUTS.HOSTLIB_WGTMAP_FILE, &CKSUM); }
+
+  // stored variables and cuts
+  cksum_FNV1a(&VERSION, sizeof(int), &CKSUM);
+  cksum_FNV1a(&NVAR_STORE, sizeof(int), &CKSUM);
+  for ( ivar=0; ivar < NVAR_STORE; ivar++ ) {
+    ptr = HOSTLIB.VARNAME_STORE[ivar] ;
+    cksum_FNV1a(ptr, strlen(ptr)+1, &CKSUM);
+  }
+  CUTS[0] = INPUTS.GENRANGE_REDSHIFT[0] ;
+  CUTS[1] = INPUTS.GENRANGE_REDSHIFT[1] ;
+  CUTS[2] = INPUTS.HOSTLIB_GENRANGE_RA[0] ;
+  CUTS[3] = INPUTS.HOSTLIB_GENRANGE_RA[1] ;
+  CUTS[4] = INPUTS.HOSTLIB_GENRANGE_DEC[0] ;
+  CUTS[5] = INPUTS.HOSTLIB_GENRANGE_DEC[1] ;
+  cksum_FNV1a(CUTS, sizeof(CUTS), &CKSUM);
+  cksum_FNV1a(&INPUTS.HOSTLIB_MAXREAD, sizeof(int), &CKSUM);
+
+  HOSTLIB_CACHE.CHECKSUM = CKSUM ;
+
+  // cache file name from HOSTLIB base name without path or .gz
+  ptr = strrchr(HOSTLIB.FILENAME,'/');
+  if ( ptr == NULL ) 
+    { sprintf(baseName, "%s", HOSTLIB.FILENAME); }
+  else
+    { sprintf(baseName, "%s", ptr+1 ); }
+  if ( (ptr=strstr(baseName,".gz")) != NULL ) { *ptr = 0 ; }
+
+  sprintf(HOSTLIB_CACHE.FILENAME, "%s/%s_%16.16llx%s", 
+	  INPUTS.HOSTLIB_CACHE_DIR, baseName, CKSUM, SUFFIX_HOSTLIB_CACHE);
+
+  printf("\t HOSTLIB cache file: %s \n", HOSTLIB_CACHE.FILENAME);
+  fflush(stdout);
+
+  return ;
+
+} // end of cksum_HOSTLIB_CACHE
+
+// =======================================
+void cksumFile_HOSTLIB_CACHE(char *fileName, unsigned long long *CKSUM) {
+
+  // Created Oct 2026
+  // Update FNV-1a checksum with name, size and modification time
+  // of fileName. Reading the whole file would cost about as much
+  // as reading the text HOSTLIB.
+
+  struct stat statbuf ;
+  long long   SIZE_MTIME[3] ;
+  char   fnam[] = "cksumFile_HOSTLIB_CACHE" ;
+
+  // ----------- BEGIN -----------
+
+  if ( stat(fileName, &statbuf) != 0 ) {
+    sprintf(c1err,"Cannot stat file to compute checksum:");
+    sprintf(c2err,"%s", fileName);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  }
+
+  SIZE_MTIME[0] = (long long)statbuf.st_size ;
+  SIZE_MTIME[1] = (long long)statbuf.st_mtim.tv_sec ;
+  SIZE_MTIME[2] = (long long)statbuf.st_mtim.tv_nsec ;
+  cksum_FNV1a(fileName, strlen(fileName)+1, CKSUM);
+  cksum_FNV1a(SIZE_MTIME, sizeof(SIZE_MTIME), CKSUM);
+
+} // end of cksumFile_HOSTLIB_CACHE
+
+// =======================================
+int read_HOSTLIB_CACHE(void) {
+
+  // Created Oct 2026
+  // If binary cache file exists, memory-map it and point the
+  // HOSTLIB z-sorted arrays and WGTMAP arrays to the mapped columns.
+  // Functions returns 1 if cache is loaded; 0 otherwise.
+  //
+  // Mapping is private & writable so that the rare in-place change
+  // (e.g., debug ANGLE reset) gets a private page copy; all other
+  // pages are shared via the page cache by every job on the node.
+
+  int    fd, ivar, igal, NGAL, NVAR_STORE ;
+  double *ptrD ;
+  struct stat statbuf ;
+  HOSTLIB_CACHE_HEAD_DEF *HEAD ;
+  char fnam[] = "read_HOSTLIB_CACHE" ;
+
+  // ----------- BEGIN -----------
+
+  if ( strlen(HOSTLIB_CACHE.FILENAME) == 0 ) { return(0); }
+  if ( (fd = open(HOSTLIB_CACHE.FILENAME, O_RDONLY)) < 0 ) { return(0); }
+
+  fstat(fd, &statbuf);
+  if ( statbuf.st_size < (off_t)sizeof(HOSTLIB_CACHE_HEAD_DEF) ) {
+    sprintf(c1err,"Invalid size (%lld bytes) for HOSTLIB cache", 
+	    (long long)statbuf.st_size );
+    sprintf(c2err,"%s", HOSTLIB_CACHE.FILENAME);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  }
+
+  HOSTLIB_CACHE.SIZE_MAP = (size_t)statbuf.st_size ;
+  HOSTLIB_CACHE.MAP = (char*)mmap(NULL, HOSTLIB_CACHE.SIZE_MAP,
+				  PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if ( HOSTLIB_CACHE.MAP == MAP_FAILED ) {
+    sprintf(c1err,"mmap failed for HOSTLIB cache");
+    sprintf(c2err,"%s", HOSTLIB_CACHE.FILENAME);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  }
+
+  HEAD       = (HOSTLIB_CACHE_HEAD_DEF*)HOSTLIB_CACHE.MAP ;
+  NGAL       = HEAD->NGAL_STORE ;
+  NVAR_STORE = HEAD->NVAR_STORE ;
+
+  // sanity checks; a mismatch here means a corrupt or foreign file
+  if ( strcmp(HEAD->MAGIC,MAGIC_HOSTLIB_CACHE) != 0      ||
+       HEAD->VERSION    != VERSION_HOSTLIB_CACHE         ||
+       HEAD->CHECKSUM   != HOSTLIB_CACHE.CHECKSUM        ||
+       HEAD->NZPTR      != NZPTR_HOSTLIB                 ||
+       NVAR_STORE       != HOSTLIB.NVAR_STORE            ||
+       HEAD->SIZE       != (long long)HOSTLIB_CACHE.SIZE_MAP ) {
+    sprintf(c1err,"Invalid header (VERSION=%d NVAR=%d SIZE=%lld) for",
+	    HEAD->VERSION, NVAR_STORE, HEAD->SIZE );
+    sprintf(c2err,"%s ; remove this file.", HOSTLIB_CACHE.FILENAME);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  }
+
+  for ( ivar=0; ivar < NVAR_STORE; ivar++ ) {
+    if ( strcmp(HEAD->VARNAME_STORE[ivar],HOSTLIB.VARNAME_STORE[ivar])==0 ) 
+      { continue ; }
+    sprintf(c1err,"VARNAME_STORE[%d] = '%s' in cache, but '%s' expected",
+	    ivar, HEAD->VARNAME_STORE[ivar], HOSTLIB.VARNAME_STORE[ivar] );
+    sprintf(c2err,"Remove %s", HOSTLIB_CACHE.FILENAME);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  }
+
+  // load HOSTLIB info set by rdgal, sortz & zptr
+  HOSTLIB.NGAL_READ  = HEAD->NGAL_READ ;
+  HOSTLIB.NGAL_STORE = NGAL ;
+  HOSTLIB.MALLOCSIZE = sizeof(double) * MALLOCSIZE_HOSTLIB * 
+    ( NGAL/MALLOCSIZE_HOSTLIB + 1 ) ; // same as malloc_HOSTLIB
+  HOSTLIB.SORTFLAG   = 1 ;
+  HOSTLIB.ZMIN       = HEAD->ZMIN ;
+  HOSTLIB.ZMAX       = HEAD->ZMAX ;
+  HOSTLIB.ZGAPMAX    = HEAD->ZGAPMAX ;
+  HOSTLIB.ZGAPAVG    = HEAD->ZGAPAVG ;
+  HOSTLIB.Z_ATGAPMAX[0] = HEAD->Z_ATGAPMAX[0] ;
+  HOSTLIB.Z_ATGAPMAX[1] = HEAD->Z_ATGAPMAX[1] ;
+  HOSTLIB.MINiz      = HEAD->MINiz ;
+  HOSTLIB.MAXiz      = HEAD->MAXiz ;
+  memcpy(HOSTLIB.IZPTR, HEAD->IZPTR, sizeof(HOSTLIB.IZPTR) );
+
+  ptrD = (double*)(HOSTLIB_CACHE.MAP + HEAD->OFFSET_VALUE) ;
+  for ( ivar=0; ivar < NVAR_STORE; ivar++ ) {
+    HOSTLIB.VALMIN[ivar]        = HEAD->VALMIN[ivar] ;
+    HOSTLIB.VALMAX[ivar]        = HEAD->VALMAX[ivar] ;
+    HOSTLIB.VALUE_ZSORTED[ivar] = ptrD + (size_t)ivar*(size_t)NGAL ;
+  }
+
+  if ( HEAD->DOFIELD ) {
+    HOSTLIB.FIELD_ZSORTED = (char**)malloc( (NGAL+1) * sizeof(char*) ) ;
+    for ( igal=0; igal < NGAL; igal++ ) {
+      HOSTLIB.FIELD_ZSORTED[igal] = HOSTLIB_CACHE.MAP + HEAD->OFFSET_FIELD 
+	+ (size_t)igal*MXCHAR_FIELDNAME ;
+    }
+  }
+
+  // WGTMAP info from init_HOSTLIB_WGTMAP
+  ptrD = (double*)(HOSTLIB_CACHE.MAP + HEAD->OFFSET_WGT) ;
+  HOSTLIB_WGTMAP.WGT        = ptrD ;
+  HOSTLIB_WGTMAP.WGTSUM     = ptrD + NGAL ;
+  HOSTLIB_WGTMAP.SNMAGSHIFT = ptrD + 2*(size_t)NGAL ;
+
+  // same default as in rdgal_HOSTLIB
+  if ( INPUTS.HOSTLIB_GENZPHOT_OUTLIER[0] < 0.0 ) {
+    INPUTS.HOSTLIB_GENZPHOT_OUTLIER[0] = HOSTLIB.ZMIN ;
+    INPUTS.HOSTLIB_GENZPHOT_OUTLIER[1] = HOSTLIB.ZMAX ;
+  }
+
+  HOSTLIB_CACHE.USE = 1 ;
+  printf("\t Stored %d galaxies from HOSTLIB cache (%.1f MB mapped). \n",
+	 NGAL, (double)HOSTLIB_CACHE.SIZE_MAP/1.0E6 );
+  fflush(stdout);
+
+  return(1);
+
+} // end of read_HOSTLIB_CACHE
+
+// =======================================
+void write_HOSTLIB_CACHE(void) {
+
+  // Created Oct 2026
+  // Write binary cache after HOSTLIB is read, z-sorted, and WGTMAP
+  // is interpolated. Write to temp file and rename at the end so that
+  // concurrent jobs never see a partial cache file.
+
+  int  NGAL       = HOSTLIB.NGAL_STORE ;
+  int  NVAR_STORE = HOSTLIB.NVAR_STORE ;
+  int  DOFIELD    = ( HOSTLIB.IVAR_FIELD > 0 ) ;
+  int  ivar, igal ;
+  long long OFFSET ;
+  FILE *fp ;
+  HOSTLIB_CACHE_HEAD_DEF HEAD ;
+  char tmpFile[MXPATHLEN+20], FIELD[MXCHAR_FIELDNAME], pad[64] ;
+  char fnam[] = "write_HOSTLIB_CACHE" ;
+
+  // ----------- BEGIN -----------
+
+  if ( strlen(HOSTLIB_CACHE.FILENAME) == 0 ) { return ; }
+
+  memset(&HEAD, 0, sizeof(HOSTLIB_CACHE_HEAD_DEF) );
+  memset(pad,   0, sizeof(pad) );
+  sprintf(HEAD.MAGIC, "%s", MAGIC_HOSTLIB_CACHE);
+  HEAD.VERSION    = VERSION_HOSTLIB_CACHE ;
+  HEAD.NVAR_STORE = NVAR_STORE ;
+  HEAD.NGAL_READ  = HOSTLIB.NGAL_READ ;
+  HEAD.NGAL_STORE = NGAL ;
+  HEAD.DOFIELD    = DOFIELD ;
+  HEAD.NZPTR      = NZPTR_HOSTLIB ;
+  HEAD.MINiz      = HOSTLIB.MINiz ;
+  HEAD.MAXiz      = HOSTLIB.MAXiz ;
+  HEAD.CHECKSUM   = HOSTLIB_CACHE.CHECKSUM ;
+  HEAD.ZMIN       = HOSTLIB.ZMIN ;
+  HEAD.ZMAX       = HOSTLIB.ZMAX ;
+  HEAD.ZGAPMAX    = HOSTLIB.ZGAPMAX ;
+  HEAD.ZGAPAVG    = HOSTLIB.ZGAPAVG ;
+  HEAD.Z_ATGAPMAX[0] = HOSTLIB.Z_ATGAPMAX[0] ;
+  HEAD.Z_ATGAPMAX[1] = HOSTLIB.Z_ATGAPMAX[1] ;
+  memcpy(HEAD.IZPTR, HOSTLIB.IZPTR, sizeof(HOSTLIB.IZPTR) );
+  for ( ivar=0; ivar < NVAR_STORE; ivar++ ) {
+    HEAD.VALMIN[ivar] = HOSTLIB.VALMIN[ivar] ;
+    HEAD.VALMAX[ivar] = HOSTLIB.VALMAX[ivar] ;
+    sprintf(HEAD.VARNAME_STORE[ivar], "%s", HOSTLIB.VARNAME_STORE[ivar]);
+  }
+
+  // columns start on 64-byte boundary
+  OFFSET = ( (sizeof(HOSTLIB_CACHE_HEAD_DEF) + 63) / 64 ) * 64 ;
+  HEAD.OFFSET_VALUE = OFFSET ;
+  HEAD.OFFSET_WGT   = OFFSET + (long long)NVAR_STORE*NGAL*sizeof(double);
+  HEAD.OFFSET_FIELD = HEAD.OFFSET_WGT + 3LL*NGAL*sizeof(double) ;
+  HEAD.SIZE         = HEAD.OFFSET_FIELD ;
+  if ( DOFIELD ) { HEAD.SIZE += (long long)NGAL*MXCHAR_FIELDNAME ; }
+
+  if ( (fp = open_TEMPFILE(HOSTLIB_CACHE.FILENAME,tmpFile)) == NULL ) {
+    sprintf(c1err,"Cannot open HOSTLIB cache file for writing:");
+    sprintf(c2err,"%s", tmpFile);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  }
+
+  fwrite(&HEAD, sizeof(HOSTLIB_CACHE_HEAD_DEF), 1, fp);
+  fwrite(pad, 1, OFFSET - sizeof(HOSTLIB_CACHE_HEAD_DEF), fp);
+
+  for ( ivar=0; ivar < NVAR_STORE; ivar++ ) 
+    { fwrite(HOSTLIB.VALUE_ZSORTED[ivar], sizeof(double), NGAL, fp); }
+
+  fwrite(HOSTLIB_WGTMAP.WGT,        sizeof(double), NGAL, fp);
+  fwrite(HOSTLIB_WGTMAP.WGTSUM,     sizeof(double), NGAL, fp);
+  fwrite(HOSTLIB_WGTMAP.SNMAGSHIFT, sizeof(double), NGAL, fp);
+
+  if ( DOFIELD ) {
+    for ( igal=0; igal < NGAL; igal++ ) {
+      memset(FIELD, 0, MXCHAR_FIELDNAME);
+      strncpy(FIELD, HOSTLIB.FIELD_ZSORTED[igal], MXCHAR_FIELDNAME-1);
+      fwrite(FIELD, 1, MXCHAR_FIELDNAME, fp);
+    }
+  }
+
+  if ( close_TEMPFILE(fp, (ftell(fp) != HEAD.SIZE), tmpFile, 
+		      HOSTLIB_CACHE.FILENAME) != SUCCESS ) {
+    sprintf(c1err,"Error writing HOSTLIB cache file (disk full?)");
+    sprintf(c2err,"%s", HOSTLIB_CACHE.FILENAME);
+    errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+  }
+
+  printf("\t Wrote HOSTLIB cache (%d galaxies, %.1f MB) \n",
+	 NGAL, (double)HEAD.SIZE/1.0E6 );
+  fflush(stdout);
+
+  return ;
 
+} // end of write_HOSTLIB_CACHE
 
 // =======================================
 void init_HOSTLIB_ZPHOTEFF(void) {
@@ -2106,6 +2469,29 @@ void init_GALMAG_HOSTLIB(void) {
   // init 2d Gaussian integrals
   init_Gauss2d_Overlap();
 
+  // Oct 2026: store Gauss2d overlap for each R-bin w.r.t. SN, 
+  // using same R-loop as in GEN_SNHOST_GALMAG
+  int    ir = 0 ;
+  double R, Rcen, Rbin = HOSTLIB.Aperture_Rbin ;
+  for ( R = 0.0; R < Rmax; R += Rbin ) {
+    if ( ir > NRBIN_GALMAG ) {
+      sprintf(c1err,"Too many R bins (%d) for Aperture_GaussOvp", ir);
+      sprintf(c2err,"Check NRBIN_GALMAG = %d", NRBIN_GALMAG );
+      errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
+    }
+    Rcen = R + 0.5*Rbin ;
+    for ( j=1; j <= NMAGPSF_HOSTLIB ; j++ ) { 
+      HOSTLIB.Aperture_GaussOvp[ir][j] = 
+	Gauss2d_Overlap(Rcen/HOSTLIB.Aperture_Radius[j],
+			HOSTLIB.Aperture_PSFSIG[j]/HOSTLIB.Aperture_Radius[j]);
+    }
+    ir++ ;
+  }
+  HOSTLIB.NRBIN_GaussOvp = ir ;
+
+  // Sersic profile table for get_GALFLUX_HOSTLIB
+  init_Sersic_profile_table();
+
 } // init_GALMAG_HOSTLIB
 
 
@@ -2879,6 +3265,9 @@ void  init_SAMEHOST(void) {
   for(igal=0; igal < NGAL+10; igal++ ) 
     { SAMEHOST.NUSE[igal] = 0; }
 
+  // trees of available hosts for GEN_SNHOST_GALID (Oct 2026)
+  init_SAMEHOST_FENWICK();
+
   USEONCE   = ( INPUTS.HOSTLIB_MSKOPT & HOSTLIB_MSKOPT_USEONCE );
   MINDAYSEP = INPUTS.HOSTLIB_MINDAYSEP_SAMEGAL ;
 
@@ -3316,16 +3705,24 @@ void GEN_SNHOST_GALID(double ZGEN) {
   // Dec 18 2015: if we have intentional wrong host, do NOT move SN redshift
   //              to match that of HOST. See GENLC.CORRECT_HOSTMATCH .
   //
+  // Oct 2026: 
+  //   + binary search on ZTRUE for igal_start & igal_end, and on
+  //     WGTSUM for the weighted pick; then use Fenwick tree
+  //     (SAMEHOST.FENWICK_AVAIL) to jump to next available host.
+  //     Same host as previous linear scans, but O(logN) per event.
+  //   + GALID_PRIORITY picks first available host in range as
+  //     intended, instead of marking every available one as used.
+  //
 
   int 
-    IZ_CEN, iz_cen, IGAL_SELECT
-    ,igal_start, igal_end, igal, LSN2GAL, LDMP
-    ,NSKIP_WGT, NSKIP_USED, NGAL_CHECK, MATCH, OVP
+    IGAL_SELECT, NGAL
+    ,igal_start, igal_end, igal, igal_wgt
+    ,NSKIP_WGT, NSKIP_USED, NGAL_CHECK
     ;
 
   long long GALID_FORCE, GALID ;
-  double  ZTRUE, LOGZGEN ,WGT_start, WGT_end, WGT_dif, WGT_select, WGT ;
-  double  ztol, dztol, z, z_start, z_end ;
+  double  ZTRUE, LOGZGEN ,WGT_start, WGT_end, WGT_dif, WGT_select ;
+  double  dztol, z_start, z_end ;
 
   char fnam[] = "GEN_SNHOST_GALID" ;
 
@@ -3351,38 +3748,18 @@ void GEN_SNHOST_GALID(double ZGEN) {
     errmsg(SEV_FATAL, 0, fnam, c1err, c2err); 
   }
 
-  IZ_CEN  = (int)((LOGZGEN-MINLOGZ_HOSTLIB)/DZPTR_HOSTLIB) ; 
-
   // Nov 23 2015: New algorithm to select min/max GALID using
   //              dztol from user
+  // Oct 2026: binary search for first ZTRUE > ZGEN-dztol and
+  //           last ZTRUE < ZGEN+dztol. As before, the first
+  //           and last library entries are never selected.
 
-  iz_cen=IZ_CEN;    z=ZGEN ;  ztol=z-dztol ; 
-  if ( iz_cen >= HOSTLIB.MAXiz ) 
-    { igal_start = HOSTLIB.NGAL_STORE-1; }
-  else 
-    { igal_start = HOSTLIB.IZPTR[iz_cen+1]; }
-
-  
-  LDMP = ( GENLC.CID == -117 ) ; 
-
-  while ( z > ztol && igal_start > 1 )   { 
-    igal_start-- ; z = get_ZTRUE_HOSTLIB(igal_start);  
-  }
-
+  NGAL       = HOSTLIB.NGAL_STORE ;
+  igal_start = igal_zbound_HOSTLIB(ZGEN-dztol, +1) ;
+  igal_end   = igal_zbound_HOSTLIB(ZGEN+dztol,  0) - 1 ;
+  if ( igal_start < 1      ) { igal_start = 1 ;      }
+  if ( igal_end   > NGAL-2 ) { igal_end   = NGAL-2 ; }
 
-  // - - - - - - - - - 
-
-  iz_cen   = IZ_CEN;  z = ZGEN ; ztol = z+dztol ;
-  if ( iz_cen < HOSTLIB.MINiz ) 
-    { igal_end = 0; }
-  else   
-    { igal_end = HOSTLIB.IZPTR[iz_cen-1]; }
-  
-  while ( z < ztol && igal_end < HOSTLIB.NGAL_STORE-1 ) 
-    { igal_end++ ; z = get_ZTRUE_HOSTLIB(igal_end);  }
-
-  // back up one step to stay inside dztol
-  igal_start++ ;    igal_end--   ; 
   z_start = get_ZTRUE_HOSTLIB(igal_start); 
   z_end   = get_ZTRUE_HOSTLIB(igal_end); 
 
@@ -3434,45 +3811,42 @@ void GEN_SNHOST_GALID(double ZGEN) {
   long long GALID_MIN = INPUTS.HOSTLIB_GALID_PRIORITY[0] ;
   long long GALID_MAX = INPUTS.HOSTLIB_GALID_PRIORITY[1] ;
   if ( GALID_MIN < GALID_MAX  ) {
-    for ( igal = igal_start; igal <= igal_end; igal++ ) {
-      GALID = get_GALID_HOSTLIB(igal) ;
-      if ( GALID < GALID_MIN ) { continue ; }
-      if ( GALID > GALID_MAX ) { continue ; }
-      if ( USEHOST_GALID(igal) == 0 ) { continue ; }
-      IGAL_SELECT = igal; 
+    igal = next_FENWICK_HOSTLIB(SAMEHOST.FENWICK_PRIORITY, igal_start);
+    while ( igal >= 0 && igal <= igal_end ) {
+      if ( USEHOST_GALID(igal) ) 
+	{ IGAL_SELECT = igal;  goto DONE_SELECT_GALID ; }
+      igal = next_FENWICK_HOSTLIB(SAMEHOST.FENWICK_PRIORITY, igal+1);
     }
-    if ( IGAL_SELECT >= 0 ) { goto DONE_SELECT_GALID ; }
   } 
 
-
-  // ---------------------------------------------------
-  // start nominal loop over galaxies
-  for ( igal = igal_start; igal <= igal_end; igal++ ) {
-
-    NGAL_CHECK++ ;
-
-    // check for forced GALID (Mar 12 2012)
-    if ( GALID_FORCE > 0 ) {
-      MATCH = (GALID_FORCE == get_GALID_HOSTLIB(igal) ) ; 
-      if ( MATCH ) 
+  // check for forced GALID (Mar 12 2012)
+  if ( GALID_FORCE > 0 ) {
+    for ( igal = igal_start; igal <= igal_end; igal++ ) {
+      NGAL_CHECK++ ;
+      if ( GALID_FORCE == get_GALID_HOSTLIB(igal) ) 
 	{ IGAL_SELECT = igal; goto DONE_SELECT_GALID ; }
-      else
-	{ continue ; }
     }
+    goto DONE_SELECT_GALID ;
+  }
 
-    WGT  = HOSTLIB_WGTMAP.WGTSUM[igal]; 
-
-    if ( WGT <  WGT_select  ) 
-      { NSKIP_WGT++; continue ; }
-
-    if ( USEHOST_GALID(igal) == 0 ) 
-      { NSKIP_USED++ ; continue ; }
+  // ---------------------------------------------------
+  // nominal selection: first host with WGTSUM >= WGT_select,
+  // then first available host at or after that one.
 
-    IGAL_SELECT = igal ;
-    goto DONE_SELECT_GALID ;
+  igal_wgt   = igal_wgtbound_HOSTLIB(WGT_select, igal_start, igal_end);
+  NSKIP_WGT  = igal_wgt - igal_start ;
+  NGAL_CHECK = igal_end - igal_start + 1 ;
 
+  igal = next_FENWICK_HOSTLIB(SAMEHOST.FENWICK_AVAIL, igal_wgt);
+  while ( igal >= 0 && igal <= igal_end ) {
+    if ( USEHOST_GALID(igal) ) 
+      { IGAL_SELECT = igal ;  goto DONE_SELECT_GALID ; }
+    igal = next_FENWICK_HOSTLIB(SAMEHOST.FENWICK_AVAIL, igal+1);
   }
 
+  // all hosts after the WGT_select point are used or blocked
+  NSKIP_USED = igal_end - igal_wgt + 1 ;
+
 
   // - - - - - - - - - - - - - - - - - - - - - - - - 
 
@@ -3596,6 +3970,153 @@ void init_SNHOSTGAL(void) {
 } // end init_SNHOSTGAL
 
 
+// =======================================
+void init_SAMEHOST_FENWICK(void) {
+
+  // Created Oct 2026
+  // Build Fenwick trees of available hosts; at init all hosts are
+  // available, and the PRIORITY tree counts only hosts with GALID
+  // in the GALID_PRIORITY range. For USEONCE, USEHOST_GALID removes
+  // each used host so that GEN_SNHOST_GALID finds the next available
+  // host in O(logN) instead of skipping used hosts one by one.
+
+  int NGAL = HOSTLIB.NGAL_STORE ;
+  int i, j, I4 = sizeof(int) ;
+  int *T_AVAIL, *T_PRIOR ;
+
+  // ----------- BEGIN -----------
+
+  SAMEHOST.NGAL_FENWICK     = NGAL ;
+  SAMEHOST.FENWICK_AVAIL    = (int*)malloc( (NGAL+1)*I4 );
+  SAMEHOST.FENWICK_PRIORITY = (int*)malloc( (NGAL+1)*I4 );
+  T_AVAIL = SAMEHOST.FENWICK_AVAIL ;
+  T_PRIOR = SAMEHOST.FENWICK_PRIORITY ;
+
+  SAMEHOST.BITMAX_FENWICK = 1;
+  while ( 2*SAMEHOST.BITMAX_FENWICK <= NGAL )
+    { SAMEHOST.BITMAX_FENWICK *= 2 ; }
+
+  // O(N) build: load leaf values, then push each node to its parent
+  T_AVAIL[0] = T_PRIOR[0] = 0 ;
+  for ( i=1; i <= NGAL; i++ )
+    { T_AVAIL[i] = 1 ;  T_PRIOR[i] = priority_GALID(i-1) ; }
+
+  for ( i=1; i <= NGAL; i++ ) {
+    j = i + (i & (-i)) ;
+    if ( j <= NGAL ) { T_AVAIL[j] += T_AVAIL[i];  T_PRIOR[j] += T_PRIOR[i]; }
+  }
+
+} // end of init_SAMEHOST_FENWICK
+
+// =======================================
+void update_FENWICK_HOSTLIB(int *TREE, int igal, int delta) {
+
+  // Created Oct 2026
+  // Add delta to count for host igal (0 to NGAL-1).
+  int i, N = SAMEHOST.NGAL_FENWICK ;
+  for ( i=igal+1; i <= N; i += (i & (-i)) ) { TREE[i] += delta; }
+
+} // end of update_FENWICK_HOSTLIB
+
+// =======================================
+int sum_FENWICK_HOSTLIB(int *TREE, int igal) {
+
+  // Created Oct 2026
+  // Return sum of counts for hosts 0 to igal.
+  int i, SUM = 0 ;
+  for ( i=igal+1; i > 0; i -= (i & (-i)) ) { SUM += TREE[i]; }
+  return(SUM);
+
+} // end of sum_FENWICK_HOSTLIB
+
+// =======================================
+int next_FENWICK_HOSTLIB(int *TREE, int igal) {
+
+  // Created Oct 2026
+  // Return first host index >= igal with non-zero count,
+  // or -9 if there is no such host.
+
+  int N = SAMEHOST.NGAL_FENWICK ;
+  int NTH, pos, bit ;
+
+  // ----------- BEGIN -----------
+
+  if ( igal >= N ) { return(-9); }
+  if ( igal <  0 ) { igal = 0 ; }
+
+  // find NTH entry where NTH = 1 + number of entries before igal
+  NTH = 1 + sum_FENWICK_HOSTLIB(TREE, igal-1) ;
+  if ( NTH > sum_FENWICK_HOSTLIB(TREE, N-1) ) { return(-9); }
+
+  pos = 0 ;
+  for ( bit = SAMEHOST.BITMAX_FENWICK; bit > 0; bit /= 2 ) {
+    if ( pos+bit <= N && TREE[pos+bit] < NTH )
+      { pos += bit ;  NTH -= TREE[pos] ; }
+  }
+
+  return(pos);  // 1-indexed pos+1 -> 0-indexed pos
+
+} // end of next_FENWICK_HOSTLIB
+
+// =======================================
+int priority_GALID(int IGAL) {
+
+  // Created Oct 2026
+  // Returns 1 if GALID is inside user GALID_PRIORITY range.
+
+  long long GALID_MIN = INPUTS.HOSTLIB_GALID_PRIORITY[0] ;
+  long long GALID_MAX = INPUTS.HOSTLIB_GALID_PRIORITY[1] ;
+  long long GALID ;
+
+  if ( GALID_MIN >= GALID_MAX ) { return(0); }
+  GALID = get_GALID_HOSTLIB(IGAL);
+  return ( GALID >= GALID_MIN && GALID <= GALID_MAX ) ;
+
+} // end of priority_GALID
+
+// =======================================
+int igal_zbound_HOSTLIB(double Z, int OPT) {
+
+  // Created Oct 2026
+  // Binary search on z-sorted HOSTLIB.
+  // OPT =  0 : return first igal with ZTRUE >= Z
+  // OPT = +1 : return first igal with ZTRUE >  Z
+  // Returns NGAL_STORE if there is no such igal.
+
+  double *ZTRUE = HOSTLIB.VALUE_ZSORTED[HOSTLIB.IVAR_ZTRUE] ;
+  int lo = 0, hi = HOSTLIB.NGAL_STORE, mid ;
+
+  while ( lo < hi ) {
+    mid = lo + (hi-lo)/2 ;
+    if ( ZTRUE[mid] < Z || (OPT > 0 && ZTRUE[mid] == Z) )
+      { lo = mid + 1 ; }
+    else
+      { hi = mid ; }
+  }
+  return(lo);
+
+} // end of igal_zbound_HOSTLIB
+
+// =======================================
+int igal_wgtbound_HOSTLIB(double WGT, int igal_start, int igal_end) {
+
+  // Created Oct 2026
+  // Binary search on cumulative HOSTLIB_WGTMAP.WGTSUM and
+  // return first igal in [igal_start,igal_end] with WGTSUM >= WGT,
+  // or igal_end+1 if there is no such igal.
+
+  double *WGTSUM = HOSTLIB_WGTMAP.WGTSUM ;
+  int lo = igal_start, hi = igal_end+1, mid ;
+
+  while ( lo < hi ) {
+    mid = lo + (hi-lo)/2 ;
+    if ( WGTSUM[mid] < WGT ) { lo = mid + 1 ; }  else { hi = mid ; }
+  }
+  return(lo);
+
+} // end of igal_wgtbound_HOSTLIB
+
+
 // ===============================
 int USEHOST_GALID(int IGAL) {
 
@@ -3624,6 +4145,10 @@ int USEHOST_GALID(int IGAL) {
     if ( NUSE_PRIOR == 0 ) {
       SAMEHOST.NUSE[IGAL]++ ;
       retCode = 1 ;
+      // remove from Fenwick trees of available hosts
+      update_FENWICK_HOSTLIB(SAMEHOST.FENWICK_AVAIL, IGAL, -1);
+      if ( priority_GALID(IGAL) ) 
+	{ update_FENWICK_HOSTLIB(SAMEHOST.FENWICK_PRIORITY, IGAL, -1); }
     }
   }
   else if ( SAMEHOST.REUSE_FLAG == 1 ) {
@@ -4464,22 +4989,24 @@ void GEN_SNHOST_GALMAG(int IGAL) {
   // May 5 2017: use user-input INPUTS.HOSTLIB_SBRADIUS
   //
 
+  // Oct 2026: use pre-computed Aperture_GaussOvp and Sersic profile
+  //           table; sum flux over TH before multiplying by GaussOvp.
+  //
+
   double 
      x_SN, y_SN
-    ,xgal, ygal, MAGOBS, MAGOBS_LIB, PSF, FGAL, dF
+    ,xgal, ygal, MAGOBS, MAGOBS_LIB, FGAL, FGAL_SUMTH
     ,Rmin, Rmax, Rbin, R, Rcen, dm
     ,THmin, THmax, THbin, TH
     ,dRdTH, Jac
     ,GALFRAC_SUM[NMAGPSF_HOSTLIB+1]       // summed over Sersic profile
-    ,sigFrac, RcenFrac
-    ,GaussOvp[NMAGPSF_HOSTLIB+1] 
+    ,*GaussOvp
     ,AV, LAMOBS_AVG, MWXT[MXFILTINDX]
     ,RVMW = 3.1
     ;
 
   float lamavg4, lamrms4, lammin4, lammax4  ;
-  int ifilt, ifilt_obs, i, IVAR, jbinTH, opt_frame    ;
-  char fnam[] = "GEN_SNHOST_GALMAG" ;
+  int ifilt, ifilt_obs, i, IVAR, jbinTH, jbinR, opt_frame    ;
 
   // ------------ BEGIN -------------
 
@@ -4545,20 +5072,20 @@ void GEN_SNHOST_GALMAG(int IGAL) {
 
   dRdTH = Rbin * THbin ;
 
+  // update Sersic profile table if Sersic index has changed
+  prep_Sersic_profile_table();
+
   // start integration loop in polar coords around the SN.
+  jbinR = 0 ;
   for ( R = Rmin; R < Rmax; R += Rbin ) {
     Rcen = R  + 0.5*Rbin ;  // center of R-bin w.r.t SN (arcsec)
     Jac  = Rcen * dRdTH ;   // Jacobian factor = r dr dtheta
     
-    // store aperture-dependent stuff before THETA loop
-    for ( i=1; i <= NMAGPSF_HOSTLIB ; i++ ) { 
-      PSF         = HOSTLIB.Aperture_PSFSIG[i] ; // = 1/2 x Aperture_Radius
-      RcenFrac    = Rcen / HOSTLIB.Aperture_Radius[i] ; 
-      sigFrac     = PSF  / HOSTLIB.Aperture_Radius[i] ; 
-      GaussOvp[i] = Gauss2d_Overlap(RcenFrac,sigFrac);   
-    }
+    // aperture-dependent overlaps for this R-bin (from init)
+    GaussOvp = HOSTLIB.Aperture_GaussOvp[jbinR] ;
+    jbinR++ ;
 
-    jbinTH = 0;
+    jbinTH = 0;  FGAL_SUMTH = 0.0 ;
     for ( TH = THmin; TH < THmax; TH += THbin ) {
 
       // Translate from SN polar coords to galaxy a,b coords
@@ -4566,16 +5093,15 @@ void GEN_SNHOST_GALMAG(int IGAL) {
       xgal = x_SN + ( Rcen * HOSTLIB.Aperture_cosTH[jbinTH] ) ;
       ygal = y_SN + ( Rcen * HOSTLIB.Aperture_sinTH[jbinTH] ) ;
       FGAL = get_GALFLUX_HOSTLIB(xgal,ygal) ;
+      FGAL_SUMTH += FGAL ;
       jbinTH++ ;
-
-      // increment GALFRAC for each PSF grid value
-      for ( i=1; i <= NMAGPSF_HOSTLIB ; i++ ) { 
-	dF       = Jac * FGAL * GaussOvp[i] ;
-	GALFRAC_SUM[i] += dF ;
-      }
-
     }  // end of TH loop
 
+    // GaussOvp is the same for each TH, so increment GALFRAC 
+    // for each PSF grid value after TH loop
+    for ( i=1; i <= NMAGPSF_HOSTLIB ; i++ ) 
+      { GALFRAC_SUM[i] += Jac * FGAL_SUMTH * GaussOvp[i] ; }
+
   }  // end of R loop
 
 
@@ -4789,6 +5315,142 @@ double Gauss2d_Overlap(double offset, double sig) {
 
 
 
+// ===================================
+void init_Sersic_profile_table(void) {
+
+  // Created Oct 2026
+  // Compute Sersic profile table used by get_GALFLUX_HOSTLIB, in
+  // bins of Sersic index (DN_PROFILE_SERSIC) and log10[(R/Re)^2].
+  // The n-range covers the HOSTLIB range of each Sersic index, or 
+  // the fixed index, with one extra bin on each side for the 
+  // quadratic interpolation in prep_Sersic_profile_table.
+
+  int    j, in, ib, IVAR_n, NBIN_n, MEM, VBOSE ;
+  double n, nlo, nhi, nmin=1.0E9, nmax=-1.0E9, bn, rexp, SQlogR, R ;
+  double SQlogRbin ;
+
+  // ----------- BEGIN -----------
+
+  VBOSE = ( INPUTS.HOSTLIB_MSKOPT & HOSTLIB_MSKOPT_VERBOSE );
+
+  SERSIC_TABLE.NBIN_PROFILE_n = 0 ;
+  SERSIC_TABLE.PROFILE        = NULL ;
+  SQlogRbin = (MAXSQLOGR_PROFILE - MINSQLOGR_PROFILE) / 
+    (double)NBIN_PROFILE_SERSIC ;
+  SERSIC_TABLE.PROFILE_SQlogRbin = SQlogRbin ;
+
+  for ( j=0; j < SERSIC_PROFILE.NDEF; j++ ) {
+    IVAR_n = SERSIC_PROFILE.IVAR_n[j] ;
+    if ( IVAR_n >= 0 ) 
+      { nlo = HOSTLIB.VALMIN[IVAR_n] ;  nhi = HOSTLIB.VALMAX[IVAR_n] ; }
+    else
+      { nlo = nhi = SERSIC_PROFILE.FIXn[j] ; }
+    if ( nlo < nmin ) { nmin = nlo ; }
+    if ( nhi > nmax ) { nmax = nhi ; }
+  }
+
+  // outside SERSIC_INDEX range, get_Sersic_profile uses exact formula
+  if ( nmin < SERSIC_INDEX_MIN ) { nmin = SERSIC_INDEX_MIN ; }
+  if ( nmax > SERSIC_INDEX_MAX ) { nmax = SERSIC_INDEX_MAX ; }
+  if ( nmax < nmin ) { return ; }
+
+  NBIN_n = (int)((nmax-nmin)/DN_PROFILE_SERSIC) + 3 ;
+  SERSIC_TABLE.NBIN_PROFILE_n = NBIN_n ;
+  SERSIC_TABLE.PROFILE_nmin   = nmin - DN_PROFILE_SERSIC ;
+  SERSIC_TABLE.PROFILE = (double**)malloc(NBIN_n*sizeof(double*));
+
+  MEM = (NBIN_PROFILE_SERSIC+1) * sizeof(double) ;
+  for ( in=0; in < NBIN_n; in++ ) {
+    n    = SERSIC_TABLE.PROFILE_nmin + DN_PROFILE_SERSIC*(double)in ;
+    bn   = get_Sersic_bn(n);
+    rexp = 1.0/n ;
+    SERSIC_TABLE.PROFILE[in] = (double*)malloc(MEM);
+    SERSIC_TABLE.TABLEMEMORY += MEM ;
+    for ( ib=0; ib <= NBIN_PROFILE_SERSIC; ib++ ) {
+      SQlogR = MINSQLOGR_PROFILE + SQlogRbin * (double)ib ;
+      R      = pow(TEN, 0.5*SQlogR) ;
+      SERSIC_TABLE.PROFILE[in][ib] = exp(-bn*(pow(R,rexp) - 1.0)) ;
+    }
+  }
+
+  if ( VBOSE ) {
+    printf("\t Init Sersic profile table: %d n-bins (n=%.2f-%.2f) x "
+	   "%d R-bins (%.1f MB)\n",
+	   NBIN_n, nmin, nmax, NBIN_PROFILE_SERSIC+1,
+	   1.0E-6*(double)(NBIN_n*MEM) );
+    fflush(stdout);
+  }
+
+} // end of init_Sersic_profile_table
+
+// ===================================
+void prep_Sersic_profile_table(void) {
+
+  // Created Oct 2026
+  // For each Sersic component of current host, set nearest n-bin
+  // of profile table and the weights for quadratic interpolation
+  // in n over bins in-1, in, in+1. Interpolation error is below
+  // 1E-5 of the peak profile.
+
+  int    j, in ;
+  double n, t, u ;
+
+  // ----------- BEGIN -----------
+
+  for ( j=0; j < SERSIC_PROFILE.NDEF; j++ ) {
+    n  = SNHOSTGAL.SERSIC_n[j] ;
+    t  = (n - SERSIC_TABLE.PROFILE_nmin) / DN_PROFILE_SERSIC ;
+    in = (int)floor(t + 0.5) ;
+
+    if ( in < 1 || in > SERSIC_TABLE.NBIN_PROFILE_n-2 ) 
+      { SERSIC_TABLE.PROFILE_in[j] = -1 ;  continue ; }
+
+    u  = t - (double)in ;
+    SERSIC_TABLE.PROFILE_in[j]     = in ;
+    SERSIC_TABLE.PROFILE_wgt[j][0] = 0.5*u*(u-1.0) ;
+    SERSIC_TABLE.PROFILE_wgt[j][1] = 1.0 - u*u ;
+    SERSIC_TABLE.PROFILE_wgt[j][2] = 0.5*u*(u+1.0) ;
+  }
+
+} // end of prep_Sersic_profile_table
+
+// ===================================
+double get_Sersic_profile(int j, double sqsum) {
+
+  // Created Oct 2026
+  // Return Sersic profile exp[-bn*(x^(1/n)-1)] for component j,
+  // where input sqsum = x^2 = (R/Re)^2.
+  // Quadratic interpolation in n (weights from prep_Sersic_profile_table)
+  // and linear interpolation in log10(x^2); outside the table range 
+  // the profile is computed directly.
+
+  int    ib, in = SERSIC_TABLE.PROFILE_in[j] ;
+  double SQlogR, t, frac, F0, F1, *W, **ROW ;
+
+  // ----------- BEGIN -----------
+
+  if ( sqsum > 0.0 && in > 0 ) {
+    SQlogR = log10(sqsum) ;
+    if ( SQlogR >= MINSQLOGR_PROFILE && SQlogR < MAXSQLOGR_PROFILE ) {
+      t    = (SQlogR - MINSQLOGR_PROFILE) / SERSIC_TABLE.PROFILE_SQlogRbin ;
+      ib   = (int)t ;
+      frac = t - (double)ib ;
+      W    = SERSIC_TABLE.PROFILE_wgt[j] ;
+      ROW  = &SERSIC_TABLE.PROFILE[in-1] ;
+      F0   = W[0]*ROW[0][ib]   + W[1]*ROW[1][ib]   + W[2]*ROW[2][ib] ;
+      F1   = W[0]*ROW[0][ib+1] + W[1]*ROW[1][ib+1] + W[2]*ROW[2][ib+1] ;
+      return ( F0 + frac*(F1 - F0) ) ;
+    }
+  }
+
+  // outside table
+  double n   = SNHOSTGAL.SERSIC_n[j] ;
+  double bn  = SNHOSTGAL.SERSIC_bn[j] ;
+  double arg = pow(sqrt(sqsum),1.0/n) - 1.0 ;
+  return ( exp(-bn*arg) ) ;
+
+} // end of get_Sersic_profile
+
 // ===================================
 double get_GALFLUX_HOSTLIB(double xgal, double ygal) {
 
@@ -4800,16 +5462,17 @@ double get_GALFLUX_HOSTLIB(double xgal, double ygal) {
   // Mar 4 2015: fix aweful index bug setting FGAL_TOT.
   //             Bug affects only the host-noise contribution.
   //
+  // Oct 2026: get profile from table (get_Sersic_profile) instead
+  //           of computing pow and exp.
+  //
 
   int  j, NBIN ;
 
   double 
-    a, b, w, n, bn, rexp, sqsum,  arg
-    ,reduced_R, xx, yy, FSUM_PROFILE, F, FGAL_TOT
+    a, b, w, sqsum
+    ,xx, yy, FSUM_PROFILE, F, FGAL_TOT
     ;
 
-  char fnam[] = "get_GALFLUX_HOSTLIB" ;
-
   // ---------------- BEGIN ---------------
 
   FSUM_PROFILE = 0.0 ;
@@ -4820,10 +5483,7 @@ double get_GALFLUX_HOSTLIB(double xgal, double ygal) {
     // strip off info for this galaxy component.
     a   = SNHOSTGAL.SERSIC_a[j] ;
     b   = SNHOSTGAL.SERSIC_b[j] ;
-    n   = SNHOSTGAL.SERSIC_n[j] ;
     w   = SNHOSTGAL.SERSIC_w[j] ;
-    bn  = SNHOSTGAL.SERSIC_bn[j] ;
-    rexp = 1./n ;
 
     // Flux normalization = total flux over galaxy.
     // The stored INTEG_SUM is integrated over the reduced radius;
@@ -4835,12 +5495,10 @@ double get_GALFLUX_HOSTLIB(double xgal, double ygal) {
     // half-light ellipse; this scale is the reduced radius (R/Re)
     xx        = xgal/a ;
     yy        = ygal/b ;
-    sqsum     = xx*xx + yy*yy ; 
-    reduced_R = sqrt(sqsum) ;
+    sqsum     = xx*xx + yy*yy ;   // (R/Re)^2
 
     // calculate Flux for this Sersic component
-    arg  = pow(reduced_R,rexp) - 1.0 ; 
-    F    = (w/FGAL_TOT) * exp(-bn*arg) ;
+    F    = (w/FGAL_TOT) * get_Sersic_profile(j,sqsum) ;
 
     FSUM_PROFILE += F ;
   }
@@ -25,6 +25,10 @@
 
  Feb 4 2019: add DLR and d_DLR
 
+ Oct 2026: add HOSTLIB_CACHE struct for binary HOSTLIB cache.
+           add Sersic profile table and Aperture_GaussOvp table.
+           add Fenwick trees to SAMEHOST for O(logN) host selection.
+
 ==================================================== */
 
 #define HOSTLIB_MSKOPT_USE           1 // internally set if HOSTLIB_FILE
@@ -61,6 +65,10 @@
 
 #define NRBIN_GALMAG        100    // No. of radius bins for Galmag 
 #define NTHBIN_GALMAG        36    // No. theta bins for galmag
+#define NBIN_PROFILE_SERSIC 4000    // log10(R/Re)^2 bins for profile table
+#define MINSQLOGR_PROFILE   -8.0    // min log10[(R/Re)^2] in profile table
+#define MAXSQLOGR_PROFILE   +6.0    // max log10[(R/Re)^2] in profile table
+#define DN_PROFILE_SERSIC   0.02    // Sersic-index bin size in profile table
 #define MXBIN_SERSIC_bn     2000   // max bins in Sersic_bn file
  
 // hard wire logarithmic z-bins
@@ -196,6 +204,11 @@ struct HOSTLIB_DEF {
   double Aperture_cosTH[NTHBIN_GALMAG+1] ;
   double Aperture_sinTH[NTHBIN_GALMAG+1] ;
 
+  // Oct 2026: Gauss2d_Overlap for each radius bin (w.r.t. SN) and PSF;
+  // depends only on aperture binning, so compute once at init.
+  int    NRBIN_GaussOvp ;
+  double Aperture_GaussOvp[NRBIN_GALMAG+2][NMAGPSF_HOSTLIB+1] ;
+
 } HOSTLIB ;
 
 
@@ -209,6 +222,15 @@ struct SAMEHOST_DEF {
   unsigned short **PEAKDAY_STORE ; // add PEAKMJD_STORE_OFFSET to get PEAKMJD
   int PEAKMJD_STORE_OFFSET ;       // min generated PEAKMJD
 
+  // Oct 2026: Fenwick (binary-indexed) trees counting hosts that
+  // are still available (NUSE=0 for USEONCE), and available hosts in
+  // GALID_PRIORITY range. Used in GEN_SNHOST_GALID to find the next 
+  // available host in O(logN). Arrays are 1-indexed with NGAL+1 elements.
+  int *FENWICK_AVAIL ;
+  int *FENWICK_PRIORITY ;
+  int  NGAL_FENWICK ;
+  int  BITMAX_FENWICK ;   // largest power of 2 <= NGAL_FENWICK
+
 } SAMEHOST ;
 
 // Sersic quantities to define galaxy profile
@@ -257,6 +279,18 @@ struct SERSIC_TABLE_DEF {
   double  reduced_logRmin ;  // max R/Re in table
   double  reduced_logRbin ;  // bin size  of R/Re
 
+  // Oct 2026: profile exp[-bn*(x^(1/n)-1)] vs. Sersic index n and 
+  // log10(x^2), x=R/Re. Computed once in init_Sersic_profile_table
+  // for the n-range of the HOSTLIB; prep_Sersic_profile_table sets
+  // the n-bin and quadratic-interp weights for each component (j) 
+  // of current host.
+  int     NBIN_PROFILE_n ;
+  double  PROFILE_nmin ;
+  double  PROFILE_SQlogRbin ;
+  double **PROFILE ;                        // [n-bin][logR-bin]
+  int     PROFILE_in[MXSERSIC_HOSTLIB] ;    // n-bin for host; -1 => no table
+  double  PROFILE_wgt[MXSERSIC_HOSTLIB][3]; // weights for n-bins in-1,in,in+1
+
   // define table-grid of b_n vs. n read from ascii file FILENAME_SERSIC_BN
   int    Ngrid_bn ;
   double grid_n[MXBIN_SERSIC_bn] ;
@@ -304,6 +338,42 @@ struct HOSTLIB_WGTMAP_DEF {
 } HOSTLIB_WGTMAP ;
 
 
+// Oct 2026: binary HOSTLIB cache in directory HOSTLIB_CACHE_DIR.
+// Written after the first text read; contains the z-sorted columns
+// (including Sersic a,b,w,n), FIELD strings, IZPTR and the WGTMAP 
+// WGT, WGTSUM & SNMAGSHIFT. The file name and header carry a checksum 
+// of the HOSTLIB & WGTMAP file names, sizes and modification times,
+// and of the cuts applied while reading, so that any change forces a 
+// new cache file. Later jobs memory-map the cache and skip rdgal, 
+// sortz, zptr and WGTMAP interp. File is native-endian.
+#define MAGIC_HOSTLIB_CACHE   "SNANA_HOSTLIB_CACHE"
+#define VERSION_HOSTLIB_CACHE  2
+#define SUFFIX_HOSTLIB_CACHE  ".HOSTLIB_BIN"
+
+typedef struct {
+  char   MAGIC[24] ;
+  int    VERSION, NVAR_STORE, NGAL_READ, NGAL_STORE ;
+  int    DOFIELD, NZPTR, MINiz, MAXiz ;
+  unsigned long long CHECKSUM ;
+  double ZMIN, ZMAX, ZGAPMAX, ZGAPAVG, Z_ATGAPMAX[2] ;
+  double VALMIN[MXVAR_HOSTLIB], VALMAX[MXVAR_HOSTLIB] ;
+  char   VARNAME_STORE[MXVAR_HOSTLIB][40] ;
+  int    IZPTR[NZPTR_HOSTLIB] ;
+  long long OFFSET_VALUE ;  // NVAR_STORE columns of NGAL_STORE doubles
+  long long OFFSET_WGT ;    // WGT, WGTSUM, SNMAGSHIFT columns
+  long long OFFSET_FIELD ;  // NGAL_STORE x MXCHAR_FIELDNAME chars
+  long long SIZE ;          // total file size
+} HOSTLIB_CACHE_HEAD_DEF ;
+
+struct {
+  int    USE ;                 // 1 => HOSTLIB loaded from cache
+  char   FILENAME[MXPATHLEN] ;
+  unsigned long long CHECKSUM ;
+  char   *MAP ;
+  size_t SIZE_MAP ;
+} HOSTLIB_CACHE ;
+
+
 
 // define structure to hold information for one event ...
 // gets over-written for each generated SN
@@ -429,10 +499,22 @@ void   malloc_HOSTLIB(int NGAL);
 void   sortz_HOSTLIB(void);
 void   zptr_HOSTLIB(void);
 void   init_HOSTLIB_WGTMAP(void);
+void   check_HOSTLIB_WGTMAP(void);
 void   init_HOSTLIB_ZPHOTEFF(void);
+void   cksum_HOSTLIB_CACHE(void);
+void   cksumFile_HOSTLIB_CACHE(char *fileName, unsigned long long *CKSUM);
+int    read_HOSTLIB_CACHE(void);
+void   write_HOSTLIB_CACHE(void);
 void   init_GALMAG_HOSTLIB(void);
 void   init_Gauss2d_Overlap(void);
 void   init_SAMEHOST(void);
+void   init_SAMEHOST_FENWICK(void);
+void   update_FENWICK_HOSTLIB(int *TREE, int igal, int delta);
+int    sum_FENWICK_HOSTLIB(int *TREE, int igal);
+int    next_FENWICK_HOSTLIB(int *TREE, int igal);
+int    priority_GALID(int IGAL);
+int    igal_zbound_HOSTLIB(double Z, int OPT);
+int    igal_wgtbound_HOSTLIB(double WGT, int igal_start, int igal_end);
 
 void   init_Sersic_VARNAMES(void);
 void   init_Sersic_HOSTLIB(void);
@@ -452,6 +534,9 @@ int    IVAR_HOSTLIB(char *varname, int ABORTFLAG);
 long long get_GALID_HOSTLIB(int igal);
 double get_ZTRUE_HOSTLIB(int igal);
 double get_GALFLUX_HOSTLIB(double a, double b);
+void   init_Sersic_profile_table(void);
+void   prep_Sersic_profile_table(void);
+double get_Sersic_profile(int j, double sqsum);
 
 double interp_GALMAG_HOSTLIB(int ifilt_obs, double PSF ); 
 double Gauss2d_Overlap(double offset, double sig);
@@ -91,6 +91,12 @@
               See .NPTR[ivar]. Need by SALT2mu to read some info
               into redundant CUTWIN array.
 
+ Oct 2026: staged read of TEXT tables; see SNTABLE_STAGE_OPEN.
+           Requested columns are parsed into memory (multi-threaded)
+           without SNTABLE_NEVT, then copied to user arrays by
+           SNTABLE_READ_EXEC. Optional binary stage file is read
+           instead of the TEXT file on later jobs.
+
 ************************************************/
 
 #include <stdio.h>
@@ -101,6 +107,7 @@
 #include <math.h>
 #include <ctype.h>
 #include <sys/stat.h>
+#include <pthread.h>   // Oct 2026
 
 // #include "sntools.h"
 #include "sntools_output.h"
@@ -156,6 +163,13 @@ void TABLEFILE_INIT(void) {
   OUTLIER_INFO.USEFLAG = 0 ;
   NLINE_TABLECOMMENT = 0 ;
 
+  // staged read (Oct 2026)
+  READTABLE_POINTERS.ISTAGE = -9 ;
+  NTHREAD_STAGE     = 1 ;
+  CACHEDIR_STAGE[0] = 0 ;
+  for(o=0; o < MXSTAGE_READTABLE; o++ ) 
+    { READTABLE_STAGE[o].USE = 0 ;  READTABLE_STAGE[o].NVAR_STAGE = 0 ; }
+
   for(o=0; o < MXOPENFLAG; o++ ) {
     sprintf(STRING_TABLEFILE_OPENFLAG[o],"%s", U) ; 
     for(t=0; t < MXTABLEFILETYPE; t++ ) {
@@ -1000,7 +1014,7 @@ int SNTABLE_READPREP(int IFILETYPE, char *TABLENAME) {
   // For hbook, translate table name text into ntuple id.
 
   char fnam[] = "SNTABLE_READPREP" ;
-  int  NVAR, ISOPEN_DEJA, ivar ;
+  int  NVAR, ISOPEN_DEJA ;
   char msg[200], TBNAME_LOCAL[40] ;
   // --------------- BEGIN --------------
 
@@ -1008,18 +1022,7 @@ int SNTABLE_READPREP(int IFILETYPE, char *TABLENAME) {
   TABLEFILE_INIT_VERIFY(fnam, msg) ;
 
   // init pointers
-  READTABLE_POINTERS.NVAR_TOT  = 0 ;
-  READTABLE_POINTERS.NVAR_READ = 0 ;
-  READTABLE_POINTERS.IFILETYPE = IFILETYPE_NULL ;
-  READTABLE_POINTERS.NROW      = 0 ;
-  READTABLE_POINTERS.FP_DUMP   = NULL ;
-  for(ivar=0; ivar < MXVAR_TABLE; ivar++ ) {
-    READTABLE_POINTERS.NPTR[ivar] = 0 ;
-    sprintf(READTABLE_POINTERS.VARNAME[ivar], "unknown");
-    READTABLE_POINTERS.ICAST_READ[ivar]     = -9 ;
-    READTABLE_POINTERS.ICAST_STORE[ivar]    = -9 ;
-    READTABLE_POINTERS.PTRINDEX[ivar]       = -9 ;
-  }
+  init_READTABLE_POINTERS();
 
   sprintf(TBNAME_LOCAL, "%s", TABLENAME);
 
@@ -1079,6 +1082,29 @@ int SNTABLE_READPREP(int IFILETYPE, char *TABLENAME) {
 
 
 
+// ==========================================
+void init_READTABLE_POINTERS(void) {
+
+  // Oct 2026: code moved from SNTABLE_READPREP
+  int ivar;
+
+  READTABLE_POINTERS.NVAR_TOT  = 0 ;
+  READTABLE_POINTERS.NVAR_READ = 0 ;
+  READTABLE_POINTERS.IFILETYPE = IFILETYPE_NULL ;
+  READTABLE_POINTERS.NROW      = 0 ;
+  READTABLE_POINTERS.FP_DUMP   = NULL ;
+  READTABLE_POINTERS.ISTAGE    = -9 ;
+  for(ivar=0; ivar < MXVAR_TABLE; ivar++ ) {
+    READTABLE_POINTERS.NPTR[ivar] = 0 ;
+    sprintf(READTABLE_POINTERS.VARNAME[ivar], "unknown");
+    READTABLE_POINTERS.ICAST_READ[ivar]     = -9 ;
+    READTABLE_POINTERS.ICAST_STORE[ivar]    = -9 ;
+    READTABLE_POINTERS.PTRINDEX[ivar]       = -9 ;
+  }
+
+} // end init_READTABLE_POINTERS
+
+
 // ========================================================
 int SNTABLE_READPREP_VARDEF(char *VARLIST, void *ptr, 
 			    int mxlen, int optMask) {
@@ -1401,6 +1427,8 @@ int SNTABLE_READ_EXEC(void) {
   // execute table-read and fill arrays defined by
   // previous calls to SNTABLE_READPREP_VARDEF.
   // Function returns number of table rows read.
+  //
+  // Oct 2026: copy from staged columns if ISTAGE >= 0.
 
   int IFILETYPE = READTABLE_POINTERS.IFILETYPE ;
   int NROW ;
@@ -1410,6 +1438,11 @@ int SNTABLE_READ_EXEC(void) {
 
   NROW = -777 ;
 
+  if ( READTABLE_POINTERS.ISTAGE >= 0 ) {
+    NROW = SNTABLE_READ_EXEC_STAGE();
+    goto READ_DONE ;
+  }
+
 #ifdef USE_HBOOK
   if ( IFILETYPE == IFILETYPE_HBOOK ) {
     NROW = SNTABLE_READ_EXEC_HBOOK();
@@ -1430,6 +1463,7 @@ int SNTABLE_READ_EXEC(void) {
 #endif
   
   // sanity check
+ READ_DONE:
   if ( NROW == -777 ) {
     sprintf(MSGERR1,"Unknown file type -> cannot exec table-read for");
     sprintf(MSGERR2,"table = '%s'", READTABLE_POINTERS.TABLENAME );
@@ -1449,6 +1483,342 @@ int SNTABLE_READ_EXEC(void) {
 
 } // end of  SNTABLE_READ_EXEC
 
+
+// ==================================================
+void SNTABLE_STAGE_CONFIG(int NTHREAD, char *CACHEDIR) {
+
+  // Created Oct 2026
+  // Set number of threads to parse staged TEXT tables, and
+  // directory for binary stage files (blank -> no stage files).
+
+  NTHREAD_STAGE = NTHREAD ;
+  if ( NTHREAD_STAGE < 1              ) { NTHREAD_STAGE = 1; }
+  if ( NTHREAD_STAGE > MXTHREAD_STAGE ) { NTHREAD_STAGE = MXTHREAD_STAGE; }
+  sprintf(CACHEDIR_STAGE, "%s", CACHEDIR);
+
+} // end SNTABLE_STAGE_CONFIG
+
+
+// ==================================================
+int SNTABLE_STAGE_OPEN(char *FILENAME, char *TABLENAME) {
+
+  // Created Oct 2026
+  // Replaces TABLEFILE_OPEN + SNTABLE_READPREP for a TEXT table that
+  // is read before the user arrays are allocated:
+  //
+  //   ISTAGE = SNTABLE_STAGE_OPEN(FILENAME,TABLENAME);
+  //   SNTABLE_READPREP_VARDEF(VARLIST, ptr, 0, optMask);  // mxlen=0
+  //   NROW = SNTABLE_STAGE_READ();    // parse requested columns
+  //     [malloc user arrays with NROW]
+  //   SNTABLE_READPREP_STAGE(ISTAGE);
+  //   SNTABLE_READPREP_VARDEF(VARLIST, ptr, NROW, optMask);
+  //   SNTABLE_READ_EXEC();            // copy staged columns
+  //
+  // If the binary stage file for this table exists in CACHEDIR_STAGE,
+  // the header and staged columns are read from it and the TEXT file
+  // is not opened. Function returns stage index.
+
+  int  ISTAGE, istage, IFILETYPE, ivar ;
+  READTABLE_STAGE_DEF *STAGE ;
+  char fnam[] = "SNTABLE_STAGE_OPEN" ;
+
+  // ------------ BEGIN ------------
+
+  ISTAGE = -9 ;
+  for(istage=0; istage < MXSTAGE_READTABLE; istage++ ) {
+    if ( READTABLE_STAGE[istage].USE == 0 ) { ISTAGE = istage; break; }
+  }
+
+  if ( ISTAGE < 0 ) {
+    sprintf(MSGERR1,"Cannot stage table from %s", FILENAME);
+    sprintf(MSGERR2,"because all MXSTAGE_READTABLE=%d are used.",
+	    MXSTAGE_READTABLE );
+    errmsg(SEV_FATAL, 0, fnam, MSGERR1, MSGERR2); 
+  }
+
+  STAGE = &READTABLE_STAGE[ISTAGE] ;
+  STAGE->USE        = 1 ;
+  STAGE->NROW       = 0 ;
+  STAGE->NVAR_STAGE = 0 ;
+  STAGE->CACHEFILE[0] = 0 ;
+  sprintf(STAGE->FILENAME,  "%s", FILENAME );
+  sprintf(STAGE->TABLENAME, "%s", TABLENAME);
+
+#ifdef USE_TEXT
+  set_CACHEFILE_STAGE_TEXT(ISTAGE);
+  if ( read_stagecache_TEXT(ISTAGE) ) {
+    load_READTABLE_POINTERS_STAGE(ISTAGE);
+    printf("   Read %d table varNames from stage file %s\n",
+	   STAGE->NVAR_TOT, STAGE->CACHEFILE );
+    fflush(stdout);
+    return(ISTAGE);
+  }
+#endif
+
+  IFILETYPE = TABLEFILE_OPEN(FILENAME,"read");
+  if ( IFILETYPE != IFILETYPE_TEXT ) {
+    sprintf(MSGERR1,"Staged read is only for TEXT tables, but");
+    sprintf(MSGERR2,"%s is %s", FILENAME, STRING_TABLEFILE_TYPE[IFILETYPE]);
+    errmsg(SEV_FATAL, 0, fnam, MSGERR1, MSGERR2); 
+  }
+  SNTABLE_READPREP(IFILETYPE,TABLENAME);
+
+  // store header for SNTABLE_READPREP_STAGE
+  STAGE->NVAR_TOT = READTABLE_POINTERS.NVAR_TOT ;
+  for(ivar=0; ivar < STAGE->NVAR_TOT; ivar++ ) {
+    sprintf(STAGE->VARNAME[ivar], "%s", READTABLE_POINTERS.VARNAME[ivar]);
+    STAGE->ICAST_READ[ivar] = READTABLE_POINTERS.ICAST_READ[ivar] ;
+  }
+
+  READTABLE_POINTERS.ISTAGE = ISTAGE ;
+
+  return(ISTAGE);
+
+} // end SNTABLE_STAGE_OPEN
+
+
+// ==================================================
+int SNTABLE_STAGE_READ(void) {
+
+  // Created Oct 2026
+  // Stage the columns requested by SNTABLE_READPREP_VARDEF calls
+  // after SNTABLE_STAGE_OPEN; user pointers are not used, so these
+  // calls can have mxlen=0. If the columns were already read from
+  // the binary stage file, there is nothing to do. Otherwise the
+  // TEXT file is parsed and the stage file is (re)written with the
+  // union of previously staged and requested columns, so that codes
+  // requesting different columns (or casts) from the same table file
+  // (e.g., biasCor and CCprior in SALT2mu) share one stage file
+  // instead of overwriting each other's.
+  // Function returns number of rows.
+
+  int  ISTAGE   = READTABLE_POINTERS.ISTAGE ;
+  int  NVAR_TOT = READTABLE_POINTERS.NVAR_TOT ;
+  int  NREQ, NFOUND, NUNION, ivar, j, k, ICAST ;
+  int  IVAR_REQ[MXVAR_TABLE], ICAST_REQ[MXVAR_TABLE];
+  READTABLE_STAGE_DEF *STAGE ;
+  char fnam[] = "SNTABLE_STAGE_READ" ;
+
+  // ------------ BEGIN ------------
+
+  if ( ISTAGE < 0 ) {
+    sprintf(MSGERR1,"No staged table (ISTAGE=%d).", ISTAGE);
+    sprintf(MSGERR2,"Must call SNTABLE_STAGE_OPEN first.");
+    errmsg(SEV_FATAL, 0, fnam, MSGERR1, MSGERR2); 
+  }
+
+  STAGE = &READTABLE_STAGE[ISTAGE] ;
+
+  // list requested columns and check which are already staged
+  NREQ = NFOUND = 0 ;
+  for(ivar=0; ivar < NVAR_TOT; ivar++ ) {
+    if ( READTABLE_POINTERS.NPTR[ivar] == 0 ) { continue ; }
+    ICAST = READTABLE_POINTERS.ICAST_STORE[ivar] ;
+    IVAR_REQ[NREQ]  = ivar ;
+    ICAST_REQ[NREQ] = ICAST ;
+    NREQ++ ;
+    for(j=0; j < STAGE->NVAR_STAGE; j++ ) {
+      if ( STAGE->IVAR[j] == ivar && STAGE->ICAST[j] == ICAST ) 
+	{ NFOUND++ ; break ; }
+    }
+  }
+
+  if ( STAGE->NVAR_STAGE > 0 && NFOUND == NREQ ) 
+    { return(STAGE->NROW); }
+
+  // add previously staged columns that were not requested; 
+  // if union is too large, stage only the requested columns.
+  NUNION = NREQ ;
+  for(j=0; j < STAGE->NVAR_STAGE; j++ ) {
+    for(k=0; k < NREQ; k++ ) {
+      if ( STAGE->IVAR[j] == IVAR_REQ[k] && STAGE->ICAST[j] == ICAST_REQ[k] )
+	{ break ; }
+    }
+    if ( k < NREQ ) { continue ; }
+    if ( NUNION == MXVAR_TABLE ) { NUNION = NREQ ; break ; }
+    IVAR_REQ[NUNION]  = STAGE->IVAR[j] ;
+    ICAST_REQ[NUNION] = STAGE->ICAST[j] ;
+    NUNION++ ;
+  }
+
+  // parse columns from TEXT file
+  free_READTABLE_STAGE(ISTAGE);
+  STAGE->NVAR_STAGE = NUNION ;
+  for(j=0; j < NUNION; j++ ) {
+    STAGE->IVAR[j]  = IVAR_REQ[j] ;
+    STAGE->ICAST[j] = ICAST_REQ[j] ;
+  }
+
+#ifdef USE_TEXT
+  STAGE->NROW = SNTABLE_STAGE_PARSE_TEXT(ISTAGE);
+  if ( strlen(STAGE->CACHEFILE) > 0 ) { write_stagecache_TEXT(ISTAGE); }
+#endif
+
+  return(STAGE->NROW);
+
+} // end SNTABLE_STAGE_READ
+
+
+// ==================================================
+int SNTABLE_READPREP_STAGE(int ISTAGE) {
+
+  // Created Oct 2026
+  // Analog of SNTABLE_READPREP for table staged by SNTABLE_STAGE_OPEN;
+  // restore table header so that SNTABLE_READPREP_VARDEF can define
+  // user pointers. Returns number of variables in table.
+
+  char fnam[] = "SNTABLE_READPREP_STAGE" ;
+
+  // ------------ BEGIN ------------
+
+  if ( ISTAGE < 0 || ISTAGE >= MXSTAGE_READTABLE ) {
+    sprintf(MSGERR1,"Invalid ISTAGE=%d", ISTAGE);
+    sprintf(MSGERR2,"Valid range is 0 to %d", MXSTAGE_READTABLE-1);
+    errmsg(SEV_FATAL, 0, fnam, MSGERR1, MSGERR2); 
+  }
+  if ( READTABLE_STAGE[ISTAGE].USE == 0 ) {
+    sprintf(MSGERR1,"ISTAGE=%d is not used.", ISTAGE);
+    sprintf(MSGERR2,"Must call SNTABLE_STAGE_OPEN first.");
+    errmsg(SEV_FATAL, 0, fnam, MSGERR1, MSGERR2); 
+  }
+
+  load_READTABLE_POINTERS_STAGE(ISTAGE);
+
+  printf("   Read %d table varNames from staged table=%s \n",
+	 READTABLE_POINTERS.NVAR_TOT, READTABLE_STAGE[ISTAGE].TABLENAME);
+  fflush(stdout);
+
+  return(READTABLE_POINTERS.NVAR_TOT);
+
+} // end SNTABLE_READPREP_STAGE
+
+
+// ==================================================
+void load_READTABLE_POINTERS_STAGE(int ISTAGE) {
+
+  // Created Oct 2026
+  // Init READTABLE_POINTERS and load header of staged table.
+
+  READTABLE_STAGE_DEF *STAGE = &READTABLE_STAGE[ISTAGE] ;
+  int ivar ;
+
+  init_READTABLE_POINTERS();
+
+  READTABLE_POINTERS.IFILETYPE = IFILETYPE_TEXT ;
+  READTABLE_POINTERS.NVAR_TOT  = STAGE->NVAR_TOT ;
+  READTABLE_POINTERS.ISTAGE    = ISTAGE ;
+  sprintf(READTABLE_POINTERS.TABLENAME, "%s", STAGE->TABLENAME);
+  for(ivar=0; ivar < STAGE->NVAR_TOT; ivar++ ) {
+    sprintf(READTABLE_POINTERS.VARNAME[ivar], "%s", STAGE->VARNAME[ivar]);
+    READTABLE_POINTERS.ICAST_READ[ivar]  = STAGE->ICAST_READ[ivar] ;
+    READTABLE_POINTERS.ICAST_STORE[ivar] = STAGE->ICAST_READ[ivar] ;
+  }
+
+} // end load_READTABLE_POINTERS_STAGE
+
+
+// ==================================================
+int SNTABLE_READ_EXEC_STAGE(void) {
+
+  // Created Oct 2026
+  // Copy staged columns into user arrays defined by 
+  // SNTABLE_READPREP_VARDEF, then free the staged table.
+  // If the columns are not yet staged (i.e., SNTABLE_STAGE_READ 
+  // was not called), they are staged here.
+  // Function returns number of rows.
+
+  int  ISTAGE   = READTABLE_POINTERS.ISTAGE ;
+  int  NVAR_TOT = READTABLE_POINTERS.NVAR_TOT ;
+  int  NROW, ivar, j, JCOL, nptr, ICAST, SIZE, irow ;
+  size_t NBYTE ;
+  READTABLE_STAGE_DEF *STAGE = &READTABLE_STAGE[ISTAGE] ;
+  char *COL ;
+  char fnam[] = "SNTABLE_READ_EXEC_STAGE" ;
+
+  // ------------ BEGIN ------------
+
+  NROW = SNTABLE_STAGE_READ();
+
+  if ( NROW > READTABLE_POINTERS.MXLEN && READTABLE_POINTERS.NVAR_READ>0 ) {
+    sprintf(MSGERR1,"NROW=%d exceeds user-defined array bound=%d", 
+	    NROW, READTABLE_POINTERS.MXLEN );
+    sprintf(MSGERR2,"for staged table from %s", STAGE->FILENAME);
+    errmsg(SEV_FATAL, 0, fnam, MSGERR1, MSGERR2);
+  }
+
+  for(ivar=0; ivar < NVAR_TOT; ivar++ ) {
+    if ( READTABLE_POINTERS.NPTR[ivar] == 0 ) { continue ; }
+
+    ICAST = READTABLE_POINTERS.ICAST_STORE[ivar] ;
+    JCOL  = -9 ;
+    for(j=0; j < STAGE->NVAR_STAGE; j++ ) 
+      { if ( STAGE->IVAR[j] == ivar && STAGE->ICAST[j] == ICAST ) {JCOL=j;} }
+    if ( JCOL < 0 ) {
+      sprintf(MSGERR1,"Cannot find staged column for '%s' (ICAST=%d)",
+	      READTABLE_POINTERS.VARNAME[ivar], ICAST );
+      sprintf(MSGERR2,"Check SNTABLE_READPREP_VARDEF calls.");
+      errmsg(SEV_FATAL, 0, fnam, MSGERR1, MSGERR2);
+    }
+
+    COL   = (char*)STAGE->COL[JCOL] ;
+    SIZE  = sizeof_ICAST_STAGE(ICAST);
+    NBYTE = (size_t)NROW * (size_t)SIZE ;
+    for(nptr=0; nptr < READTABLE_POINTERS.NPTR[ivar]; nptr++ ) {
+      if ( ICAST == ICAST_D ) 
+	{ memcpy(READTABLE_POINTERS.PTRVAL_D[nptr][ivar], COL, NBYTE); }
+      else if ( ICAST == ICAST_F ) 
+	{ memcpy(READTABLE_POINTERS.PTRVAL_F[nptr][ivar], COL, NBYTE); }
+      else if ( ICAST == ICAST_I ) 
+	{ memcpy(READTABLE_POINTERS.PTRVAL_I[nptr][ivar], COL, NBYTE); }
+      else if ( ICAST == ICAST_L ) 
+	{ memcpy(READTABLE_POINTERS.PTRVAL_L[nptr][ivar], COL, NBYTE); }
+      else if ( ICAST == ICAST_C ) {
+	for(irow=0; irow < NROW; irow++ ) {
+	  sprintf(READTABLE_POINTERS.PTRVAL_C[nptr][ivar][irow], "%s", 
+		  &COL[irow*SIZE] );
+	}
+      }
+    } // end nptr
+
+  } // end ivar
+
+  free_READTABLE_STAGE(ISTAGE);
+  STAGE->USE = 0 ;
+  READTABLE_POINTERS.ISTAGE = -9 ;
+
+  return(NROW);
+
+} // end SNTABLE_READ_EXEC_STAGE
+
+
+// ==================================================
+void free_READTABLE_STAGE(int ISTAGE) {
+
+  // Created Oct 2026: free staged columns.
+  READTABLE_STAGE_DEF *STAGE = &READTABLE_STAGE[ISTAGE] ;
+  int j ;
+
+  for(j=0; j < STAGE->NVAR_STAGE; j++ ) { free(STAGE->COL[j]); }
+  STAGE->NVAR_STAGE = 0 ;
+  STAGE->NROW       = 0 ;
+
+} // end free_READTABLE_STAGE
+
+
+// ==================================================
+int sizeof_ICAST_STAGE(int ICAST) {
+
+  // Created Oct 2026
+  // Return number of bytes per row for staged column with ICAST.
+  if ( ICAST == ICAST_D ) { return sizeof(double); }
+  if ( ICAST == ICAST_F ) { return sizeof(float);  }
+  if ( ICAST == ICAST_I ) { return sizeof(int);    }
+  if ( ICAST == ICAST_L ) { return sizeof(long long int); }
+  if ( ICAST == ICAST_C ) { return MXCHAR_STAGE_C ; }
+  return 0 ;
+
+} // end sizeof_ICAST_STAGE
+
 // =====================================
 void SNTABLE_LIST(char *FILENAME) {
 
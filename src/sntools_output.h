@@ -24,6 +24,10 @@
  May 11 2017: declare IVAR_READTABLE_POINTER
 
  Apr 4 2019: preproc flags HBOOK,ROOT,TEXT -> USE_[HBOOK,ROOT,TEXT]
+
+ Oct 2026: staged read of TEXT tables (READTABLE_STAGE): only the
+           requested columns are parsed, with NTHREAD_STAGE threads,
+           and optionally stored in a binary file under CACHEDIR_STAGE.
 *******************************************/
 
 
@@ -97,6 +101,8 @@ char LINE_TABLECOMMENT[MXLINE_TABLECOMMENT][MXCHAR_FILENAME];
 #define MXFILTINDX 100   // must match value in sndata.h
 #define SEV_FATAL  4    // must match value in sntools.h, for errmsg call
 #define MXEPOCH   2000   // should match MXEPOCH in snana.car (Aug 2 2014)
+#define CKSUM_INIT_FNV1A  14695981039346656037ULL // must match sntools.h
+#define SUCCESS   +1    // must match sntools.h (close_TEMPFILE)
 
 
 #define ICAST_L   16  // long long int (64 bits)
@@ -159,9 +165,44 @@ struct READTABLE_POINTERS {
   int    MXLEN ;     // max size of PTRVAL_X arrays (for internal check)
   int    NROW;       // number of rows read from table
 
+  int    ISTAGE ;    // >=0 -> read from READTABLE_STAGE[ISTAGE] (Oct 2026)
+
 } READTABLE_POINTERS ;
 
 
+// Oct 2026: columns of a TEXT table staged in memory by SNTABLE_STAGE_READ;
+// i.e., rows are parsed before the user arrays are allocated, so that
+// a separate SNTABLE_NEVT pass is not needed. Each staged column has
+// the ICAST_STORE cast; char columns have MXCHAR_STAGE_C bytes per row.
+#define MXSTAGE_READTABLE  20   // max number of staged tables
+#define MXTHREAD_STAGE     64   // max number of threads to parse TEXT
+#define MXCHAR_STAGE_C     60   // max string length for char column
+#define MXCHUNK_PER_THREAD  4   // number of file chunks per thread
+
+typedef struct {
+  int    USE ;                        // 1 -> slot is used
+  char   FILENAME[MXCHAR_FILENAME] ;
+  char   TABLENAME[100];
+  char   CACHEFILE[MXCHAR_FILENAME];  // binary stage file ('' -> none)
+
+  // table header
+  int    NVAR_TOT ;
+  char   VARNAME[MXVAR_TABLE][MXCHAR_VARNAME];
+  int    ICAST_READ[MXVAR_TABLE];
+
+  // staged columns
+  int    NROW ;
+  int    NVAR_STAGE ;
+  int    IVAR[MXVAR_TABLE];    // absolute column index
+  int    ICAST[MXVAR_TABLE];   // cast of staged column
+  void  *COL[MXVAR_TABLE];     // NROW values per column
+} READTABLE_STAGE_DEF ;
+
+READTABLE_STAGE_DEF READTABLE_STAGE[MXSTAGE_READTABLE] ;
+int   NTHREAD_STAGE ;                    // number of parse threads
+char  CACHEDIR_STAGE[MXCHAR_FILENAME] ;  // dir for binary stage files
+
+
 // ----------------------------
 // SNLCPAK global declarations
 
@@ -366,6 +407,11 @@ extern"C" {
 
   int  IGNOREFILE(char *fileName);
 
+  // cache-file utilities in sntools.c (Oct 2026)
+  void  cksum_FNV1a(void *buf, size_t nbyte, unsigned long long *CKSUM);
+  FILE *open_TEMPFILE(char *fileName, char *tmpFile);
+  int   close_TEMPFILE(FILE *fp, int NERR, char *tmpFile, char *fileName);
+
   // ------------------------------
   // functions added 4/26/2104 
 
@@ -438,6 +484,17 @@ extern"C" {
 			       int mxlen, int vboseflag, char *varName_noCast);
   int SNTABLE_READ_EXEC(void);
 
+  // staged read (Oct 2026)
+  void SNTABLE_STAGE_CONFIG(int NTHREAD, char *CACHEDIR);
+  int  SNTABLE_STAGE_OPEN(char *FILENAME, char *TABLENAME);
+  int  SNTABLE_STAGE_READ(void);
+  int  SNTABLE_READPREP_STAGE(int ISTAGE);
+  int  SNTABLE_READ_EXEC_STAGE(void);
+  void init_READTABLE_POINTERS(void);
+  void load_READTABLE_POINTERS_STAGE(int ISTAGE);
+  void free_READTABLE_STAGE(int ISTAGE);
+  int  sizeof_ICAST_STAGE(int ICAST);
+
   int  IVAR_READTABLE_POINTER(char *varName) ;
   void load_READTABLE_POINTER(int IROW, int IVAR, double DVAL, char *CVAL) ;
   void load_DUMPLINE(char *LINE, double DVAL ) ;
@@ -44,6 +44,11 @@
 //
 // Apr 17 2019: in SNTABLE_NEVT_TEXT, rewind -> snana_rewind.
 //
+// Oct 2026: staged read, SNTABLE_STAGE_PARSE_TEXT; file is split into
+//           byte-range chunks parsed by threads, and only requested
+//           columns are converted. Binary stage file written/read by
+//           write_stagecache_TEXT/read_stagecache_TEXT.
+//
 // **********************************************
 
 char FILEPREFIX_TEXT[100];
@@ -109,6 +114,23 @@ struct TABLEINFO_TEXT {
 } TABLEINFO_TEXT ;
 
 
+// Oct 2026: byte-range chunk of TEXT file for staged read
+typedef struct {
+  long long BYTE0, BYTE1 ;     // parse rows starting in [BYTE0,BYTE1)
+  int       NROW, MXROW ;      // number of rows parsed, and malloc size
+  void     *COL[MXVAR_TABLE] ; // staged columns for this chunk
+} STAGE_CHUNK_TEXT_DEF ;
+
+typedef struct {
+  int    ISTAGE, ITHREAD, NTHREAD, NCHUNK ;
+  STAGE_CHUNK_TEXT_DEF *CHUNK ;
+  FILE  *FP ;     // gzip pipe (1 chunk), or NULL -> open own FILE
+  int    ISTAT ;  // 0=OK, -1=malloc error, -2=open error
+} STAGE_THREAD_TEXT_DEF ;
+
+#define MAGIC_STAGEFILE_TEXT  "SNSTAGE1"
+
+
 
 // -----------------------------
 
@@ -160,6 +182,14 @@ extern"C" {
   int  SNTABLE_READPREP_TEXT(void);
   int  SNTABLE_READ_EXEC_TEXT(void);
 
+  int  SNTABLE_STAGE_PARSE_TEXT(int ISTAGE);
+  void *thread_stage_parse_TEXT(void *thread_arg);
+  int  parse_stage_chunk_TEXT(int ISTAGE, FILE *fp, 
+			      STAGE_CHUNK_TEXT_DEF *CHUNK);
+  void set_CACHEFILE_STAGE_TEXT(int ISTAGE);
+  int  read_stagecache_TEXT(int ISTAGE);
+  void write_stagecache_TEXT(int ISTAGE);
+
   int validRowKey_TEXT(char *string) ;
   int ICAST_for_textVar(char *varName) ;
 
@@ -1237,6 +1267,473 @@ int SNTABLE_READ_EXEC_TEXT(void) {
 } // end of SNTABLE_READ_EXEC_TEXT
 
 
+// ==============================================
+int SNTABLE_STAGE_PARSE_TEXT(int ISTAGE) {
+
+  // Created Oct 2026
+  // Parse staged columns of TEXT table READTABLE_STAGE[ISTAGE].
+  // Uncompressed file is split into NTHREAD_STAGE*MXCHUNK_PER_THREAD
+  // byte-range chunks; each thread parses its chunks with its own 
+  // FILE, and chunks are then appended in file order so that rows
+  // are in the same order as for SNTABLE_READ_EXEC_TEXT.
+  // A gzipped file is parsed from a single gunzip pipe.
+  // Function returns number of rows.
+
+  READTABLE_STAGE_DEF   *STAGE = &READTABLE_STAGE[ISTAGE] ;
+  int   NVAR_STAGE = STAGE->NVAR_STAGE ;
+  int   NTHREAD    = NTHREAD_STAGE ;
+  int   NCHUNK, ichunk, ithread, j, GZIPFLAG, NROW, SIZE, ISTAT ;
+  long long FILESIZE ;
+  struct stat statbuf ;
+  FILE *fp ;
+  char *ptr ;
+  STAGE_CHUNK_TEXT_DEF  *CHUNK ;
+  STAGE_THREAD_TEXT_DEF  THREAD[MXTHREAD_STAGE] ;
+  pthread_t              THREAD_ID[MXTHREAD_STAGE] ;
+  time_t t0 = time(NULL);
+  char fnam[] = "SNTABLE_STAGE_PARSE_TEXT" ;
+
+  // ------------ BEGIN -----------
+
+  // close file left open by SNTABLE_READPREP_TEXT
+  if ( USE_TABLEFILE[OPENFLAG_READ][IFILETYPE_TEXT] ) {
+    fclose(PTRFILE_TEXT);
+    NAME_TABLEFILE[OPENFLAG_READ][IFILETYPE_TEXT][0] = 0 ;
+    USE_TABLEFILE[OPENFLAG_READ][IFILETYPE_TEXT]     = 0 ;
+  }
+
+  fp = open_TEXTgz(STAGE->FILENAME, TEXTMODE_rt, &GZIPFLAG);
+  if ( !fp ) {
+    sprintf(MSGERR1, "Could not open ascii table file: ");
+    sprintf(MSGERR2, "'%s' ", STAGE->FILENAME);
+    errmsg(SEV_FATAL, 0, fnam, MSGERR1, MSGERR2);
+  }
+
+  if ( GZIPFLAG ) { 
+    NTHREAD = NCHUNK = 1;  FILESIZE = -1 ; 
+  }
+  else {
+    fclose(fp);  fp = NULL ;
+    stat(STAGE->FILENAME, &statbuf);
+    FILESIZE = (long long)statbuf.st_size ;
+    NCHUNK   = NTHREAD * MXCHUNK_PER_THREAD ;
+    if ( NTHREAD == 1 ) { NCHUNK = 1; }
+  }
+
+  CHUNK = (STAGE_CHUNK_TEXT_DEF*)malloc(NCHUNK*sizeof(STAGE_CHUNK_TEXT_DEF));
+  for(ichunk=0; ichunk < NCHUNK; ichunk++ ) {
+    if ( FILESIZE < 0 ) 
+      { CHUNK[ichunk].BYTE0 = 0;  CHUNK[ichunk].BYTE1 = -1; }
+    else {
+      CHUNK[ichunk].BYTE0 = (FILESIZE*ichunk)     / NCHUNK ;
+      CHUNK[ichunk].BYTE1 = (FILESIZE*(ichunk+1)) / NCHUNK ;
+    }
+  }
+
+  for(ithread=0; ithread < NTHREAD; ithread++ ) {
+    THREAD[ithread].ISTAGE  = ISTAGE ;
+    THREAD[ithread].ITHREAD = ithread ;
+    THREAD[ithread].NTHREAD = NTHREAD ;
+    THREAD[ithread].NCHUNK  = NCHUNK ;
+    THREAD[ithread].CHUNK   = CHUNK ;
+    THREAD[ithread].FP      = fp ;
+    THREAD[ithread].ISTAT   = 0 ;
+  }
+
+  if ( NTHREAD == 1 ) 
+    { thread_stage_parse_TEXT(&THREAD[0]); }
+  else {
+    for(ithread=0; ithread < NTHREAD; ithread++ ) {
+      pthread_create(&THREAD_ID[ithread], NULL, 
+		     thread_stage_parse_TEXT, (void*)&THREAD[ithread]);
+    }
+    for(ithread=0; ithread < NTHREAD; ithread++ ) 
+      { pthread_join(THREAD_ID[ithread], NULL); }
+  }
+
+  if ( GZIPFLAG ) { pclose(fp); }
+
+  for(ithread=0; ithread < NTHREAD; ithread++ ) {
+    ISTAT = THREAD[ithread].ISTAT ;
+    if ( ISTAT == 0 ) { continue ; }
+    if ( ISTAT == -1 ) 
+      { sprintf(MSGERR1,"Could not malloc staged columns (ithread=%d)",
+		ithread); }
+    else
+      { sprintf(MSGERR1,"Could not open file (ithread=%d)", ithread); }
+    sprintf(MSGERR2,"for '%s'", STAGE->FILENAME);
+    errmsg(SEV_FATAL, 0, fnam, MSGERR1, MSGERR2);
+  }
+
+  // append chunks in file order
+  NROW = 0 ;
+  for(ichunk=0; ichunk < NCHUNK; ichunk++ ) { NROW += CHUNK[ichunk].NROW; }
+
+  for(j=0; j < NVAR_STAGE; j++ ) {
+    SIZE = sizeof_ICAST_STAGE(STAGE->ICAST[j]) ;
+    STAGE->COL[j] = malloc( (size_t)(NROW+1)*SIZE );
+    if ( STAGE->COL[j] == NULL ) {
+      sprintf(MSGERR1,"Could not malloc %d rows for staged column", NROW);
+      sprintf(MSGERR2,"'%s' in '%s'", 
+	      STAGE->VARNAME[STAGE->IVAR[j]], STAGE->FILENAME);
+      errmsg(SEV_FATAL, 0, fnam, MSGERR1, MSGERR2);
+    }
+    ptr = (char*)STAGE->COL[j] ;
+    for(ichunk=0; ichunk < NCHUNK; ichunk++ ) {
+      if ( CHUNK[ichunk].NROW == 0 ) { continue ; }
+      memcpy(ptr, CHUNK[ichunk].COL[j], (size_t)CHUNK[ichunk].NROW*SIZE);
+      ptr += (size_t)CHUNK[ichunk].NROW*SIZE ;
+      free(CHUNK[ichunk].COL[j]);
+    }
+  }
+  free(CHUNK);
+
+  STAGE->NROW = NROW ;
+
+  printf("\t Staged %d rows (%d of %d variables) from %s \n"
+	 "\t    (%d threads, %d sec)\n",
+	 NROW, NVAR_STAGE, STAGE->NVAR_TOT, STAGE->FILENAME,
+	 NTHREAD, (int)(time(NULL)-t0) );
+  fflush(stdout);
+
+  return(NROW);
+
+} // end SNTABLE_STAGE_PARSE_TEXT
+
+
+// ==============================================
+void *thread_stage_parse_TEXT(void *thread_arg) {
+
+  // Created Oct 2026
+  // Parse chunks ITHREAD, ITHREAD+NTHREAD, ... of staged TEXT table.
+  // Errors are returned in ISTAT and reported after the join.
+
+  STAGE_THREAD_TEXT_DEF *THREAD = (STAGE_THREAD_TEXT_DEF*)thread_arg ;
+  READTABLE_STAGE_DEF   *STAGE  = &READTABLE_STAGE[THREAD->ISTAGE] ;
+  FILE *fp = THREAD->FP ;
+  int  ichunk, j ;
+
+  // ---------- BEGIN ---------
+
+  for(ichunk=THREAD->ITHREAD; ichunk < THREAD->NCHUNK; 
+      ichunk += THREAD->NTHREAD ) {
+    THREAD->CHUNK[ichunk].NROW = THREAD->CHUNK[ichunk].MXROW = 0 ;
+    for(j=0; j < STAGE->NVAR_STAGE; j++ ) 
+      { THREAD->CHUNK[ichunk].COL[j] = NULL; }
+  }
+
+  if ( fp == NULL ) {
+    fp = fopen(STAGE->FILENAME, TEXTMODE_rt);
+    if ( !fp ) { THREAD->ISTAT = -2 ; return(NULL); }
+  }
+
+  for(ichunk=THREAD->ITHREAD; ichunk < THREAD->NCHUNK; 
+      ichunk += THREAD->NTHREAD ) {
+    THREAD->ISTAT = parse_stage_chunk_TEXT(THREAD->ISTAGE, fp, 
+					   &THREAD->CHUNK[ichunk]);
+    if ( THREAD->ISTAT != 0 ) { break ; }
+  }
+
+  if ( THREAD->FP == NULL ) { fclose(fp); }
+
+  return(NULL);
+
+} // end thread_stage_parse_TEXT
+
+
+// ==============================================
+int parse_stage_chunk_TEXT(int ISTAGE, FILE *fp, 
+			   STAGE_CHUNK_TEXT_DEF *CHUNK) {
+
+  // Created Oct 2026
+  // Parse rows that start in byte range [BYTE0,BYTE1) of TEXT file
+  // and append staged columns to CHUNK->COL; BYTE1<0 -> read to EOF.
+  // Lines are split on blanks as in SNTABLE_READ_EXEC_TEXT (but with
+  // thread-safe strtok_r and no line-length limit), and only staged 
+  // columns are converted. Numbers are converted with strtold, as in 
+  // sscanf("%Lf"), so that values are identical to the serial read.
+  // A column may be staged with more than one cast (e.g., F and D);
+  // JCOL[ivar] is the first staged column and JNEXT chains the rest.
+  // Returns 0, or -1 if malloc fails.
+
+  READTABLE_STAGE_DEF *STAGE = &READTABLE_STAGE[ISTAGE] ;
+  int    NVAR_TOT   = STAGE->NVAR_TOT ;
+  int    NVAR_STAGE = STAGE->NVAR_STAGE ;
+  int    JCOL[MXVAR_TABLE], JNEXT[MXVAR_TABLE];
+  int    SIZE[MXVAR_TABLE], ICAST[MXVAR_TABLE] ;
+  int    ivar, j, irow, MXROW, i ;
+  long long POS ;
+  long double DVAL ;
+  char   *LINE = NULL, *ptrtok, *saveptr, *ptrval ;
+  size_t  LEN_LINE = 0 ;
+  ssize_t NRD ;
+  void   *ptrtmp ;
+
+  // ---------- BEGIN ---------
+
+  for(ivar=0; ivar < NVAR_TOT; ivar++ ) { JCOL[ivar] = -1 ; }
+  for(j=NVAR_STAGE-1; j >= 0; j-- ) {
+    ivar     = STAGE->IVAR[j] ;
+    JNEXT[j] = JCOL[ivar] ;
+    JCOL[ivar] = j ;
+    ICAST[j] = STAGE->ICAST[j] ;
+    SIZE[j]  = sizeof_ICAST_STAGE(ICAST[j]);
+  }
+
+  // skip partial line before BYTE0; row starting at BYTE0 is kept
+  POS = CHUNK->BYTE0 ;
+  if ( POS > 0 ) {
+    fseeko(fp, (off_t)(POS-1), SEEK_SET);
+    NRD = getline(&LINE, &LEN_LINE, fp);
+    if ( NRD > 0 ) { POS += (long long)(NRD - 1) ; }
+  }
+
+  while ( CHUNK->BYTE1 < 0 || POS < CHUNK->BYTE1 ) {
+
+    NRD = getline(&LINE, &LEN_LINE, fp) ;
+    if ( NRD < 0 ) { break ; }
+    POS += (long long)NRD ;
+
+    // check first word in the line
+    ptrtok = strtok_r(LINE, " ", &saveptr);
+    if ( ptrtok == NULL )                 { continue ; }
+    if ( ptrtok[0] == '#' )               { continue ; } 
+    if ( validRowKey_TEXT(ptrtok) == 0 )  { continue ; }
+
+    if ( CHUNK->NROW == CHUNK->MXROW ) {
+      MXROW = ( CHUNK->MXROW == 0 ) ? 10000 : 2*CHUNK->MXROW ;
+      for(j=0; j < NVAR_STAGE; j++ ) {
+	ptrtmp = realloc(CHUNK->COL[j], (size_t)MXROW*SIZE[j]) ;
+	if ( ptrtmp == NULL ) { free(LINE);  return(-1); }
+	CHUNK->COL[j] = ptrtmp ;
+      }
+      CHUNK->MXROW = MXROW ;
+    }
+    irow = CHUNK->NROW ;  CHUNK->NROW++ ;
+
+    ptrtok = strtok_r(NULL, " ", &saveptr);  ivar = 0 ;
+    while ( ivar < NVAR_TOT ) {
+      for(j=JCOL[ivar]; j >= 0; j=JNEXT[j] ) {
+	ptrval = (char*)CHUNK->COL[j] + (size_t)irow*SIZE[j] ;
+	if ( ptrtok == NULL ) 
+	  { memset(ptrval, 0, SIZE[j]); } // missing value 
+	else if ( ICAST[j] == ICAST_C ) {
+	  for(i=0; i < MXCHAR_STAGE_C-1 && ptrtok[i] != 0 && 
+		!isspace((unsigned char)ptrtok[i]); i++ ) 
+	    { ptrval[i] = ptrtok[i]; }
+	  ptrval[i] = 0 ;
+	}
+	else {
+	  DVAL = strtold(ptrtok, NULL);
+	  if ( ICAST[j] == ICAST_D ) 
+	    { *(double*)ptrval = (double)DVAL ; }
+	  else if ( ICAST[j] == ICAST_F ) 
+	    { *(float*)ptrval = (float)DVAL ; }
+	  else if ( ICAST[j] == ICAST_I ) 
+	    { *(int*)ptrval = (int)DVAL ; }
+	  else if ( ICAST[j] == ICAST_L ) 
+	    { *(long long int*)ptrval = (long long int)DVAL ; }
+	}
+      } // end j
+      if ( ptrtok != NULL ) { ptrtok = strtok_r(NULL, " ", &saveptr); }
+      ivar++ ;
+    }
+
+  } // end while
+
+  free(LINE);
+  return(0);
+
+} // end parse_stage_chunk_TEXT
+
+
+// ==============================================
+void set_CACHEFILE_STAGE_TEXT(int ISTAGE) {
+
+  // Created Oct 2026
+  // If CACHEDIR_STAGE is set, set name of binary stage file.
+  // File name includes a 64-bit FNV-1a checksum of the full 
+  // table-file name, its size and modification time, and the
+  // table name, so that a modified table file results in a 
+  // new stage file. The staged columns are not part of the key;
+  // the file holds the union of columns requested by all readers
+  // (see SNTABLE_STAGE_READ).
+
+  READTABLE_STAGE_DEF *STAGE = &READTABLE_STAGE[ISTAGE] ;
+  unsigned long long CHECKSUM = CKSUM_INIT_FNV1A ;
+  struct stat statbuf ;
+  long long KEY[2] ;
+  char FILENAME[MXCHAR_FILENAME], base[MXCHAR_FILENAME];
+  char *FULLNAME, *ptr ;
+
+  // ---------- BEGIN ---------
+
+  STAGE->CACHEFILE[0] = 0 ;
+  if ( strlen(CACHEDIR_STAGE) == 0 ) { return ; }
+
+  sprintf(FILENAME, "%s", STAGE->FILENAME);
+  if ( stat(FILENAME, &statbuf) != 0 ) {
+    sprintf(FILENAME, "%s.gz", STAGE->FILENAME);
+    if ( stat(FILENAME, &statbuf) != 0 ) { return ; } // abort later
+  }
+
+  KEY[0] = (long long)statbuf.st_size ;
+  KEY[1] = (long long)statbuf.st_mtime ;
+
+  FULLNAME = realpath(FILENAME, NULL);
+  if ( FULLNAME != NULL ) {
+    cksum_FNV1a(FULLNAME, strlen(FULLNAME), &CHECKSUM);
+    free(FULLNAME);
+  }
+  else
+    { cksum_FNV1a(FILENAME, strlen(FILENAME), &CHECKSUM); }
+  cksum_FNV1a(KEY, sizeof(KEY), &CHECKSUM);
+  cksum_FNV1a(STAGE->TABLENAME, strlen(STAGE->TABLENAME), &CHECKSUM);
+
+  // strip path and .gz suffix
+  ptr = strrchr(STAGE->FILENAME,'/');
+  if ( ptr == NULL ) 
+    { sprintf(base, "%s", STAGE->FILENAME); }
+  else
+    { sprintf(base, "%s", ptr+1 ); }
+  if ( (ptr=strstr(base,".gz")) != NULL ) { *ptr = 0 ; }
+
+  sprintf(STAGE->CACHEFILE, "%s/%s_%016llx.stage", 
+	  CACHEDIR_STAGE, base, CHECKSUM );
+
+} // end set_CACHEFILE_STAGE_TEXT
+
+
+// ==============================================
+int read_stagecache_TEXT(int ISTAGE) {
+
+  // Created Oct 2026
+  // Read header and staged columns from binary stage file.
+  // Returns 1 if file is read; returns 0 if there is no file,
+  // or if file cannot be read (then TEXT file is parsed).
+  //
+  // Format: MAGIC, NVAR_TOT, VARNAME[NVAR_TOT], ICAST_READ[NVAR_TOT],
+  //         NROW, NVAR_STAGE, IVAR[NVAR_STAGE], ICAST[NVAR_STAGE],
+  //         then NROW values for each staged column.
+
+  READTABLE_STAGE_DEF *STAGE = &READTABLE_STAGE[ISTAGE] ;
+  FILE  *fp ;
+  char   MAGIC[8] ;
+  int    NVAR_TOT, NVAR_STAGE, NROW, j, SIZE, NERR=0 ;
+  size_t NBYTE ;
+
+  // ---------- BEGIN ---------
+
+  if ( strlen(STAGE->CACHEFILE) == 0 ) { return(0); }
+  fp = fopen(STAGE->CACHEFILE, "rb");
+  if ( !fp ) { return(0); }
+
+  if ( fread(MAGIC, 1, 8, fp) != 8 ) { NERR++ ; }
+  if ( memcmp(MAGIC, MAGIC_STAGEFILE_TEXT, 8) != 0 ) { NERR++ ; }
+  if ( fread(&NVAR_TOT, sizeof(int), 1, fp) != 1 ) { NERR++ ; }
+  if ( NERR > 0 || NVAR_TOT <= 0 || NVAR_TOT > MXVAR_TABLE ) 
+    { goto READ_FAIL ; }
+
+  STAGE->NVAR_TOT = NVAR_TOT ;
+  NBYTE = (size_t)NVAR_TOT * MXCHAR_VARNAME ;
+  if ( fread(STAGE->VARNAME, 1, NBYTE, fp) != NBYTE ) { goto READ_FAIL ; }
+  if ( fread(STAGE->ICAST_READ, sizeof(int), NVAR_TOT, fp) != 
+       (size_t)NVAR_TOT ) { goto READ_FAIL ; }
+
+  if ( fread(&NROW,       sizeof(int), 1, fp) != 1 ) { goto READ_FAIL; }
+  if ( fread(&NVAR_STAGE, sizeof(int), 1, fp) != 1 ) { goto READ_FAIL; }
+  if ( NROW < 0 || NVAR_STAGE < 0 || NVAR_STAGE > MXVAR_TABLE ) 
+    { goto READ_FAIL; }
+  if ( fread(STAGE->IVAR,  sizeof(int), NVAR_STAGE, fp) != 
+       (size_t)NVAR_STAGE ) { goto READ_FAIL; }
+  if ( fread(STAGE->ICAST, sizeof(int), NVAR_STAGE, fp) != 
+       (size_t)NVAR_STAGE ) { goto READ_FAIL; }
+  for(j=0; j < NVAR_STAGE; j++ ) {
+    if ( STAGE->IVAR[j] < 0 || STAGE->IVAR[j] >= NVAR_TOT ) 
+      { goto READ_FAIL; }
+  }
+
+  STAGE->NROW = NROW ;
+  for(j=0; j < NVAR_STAGE; j++ ) {
+    SIZE  = sizeof_ICAST_STAGE(STAGE->ICAST[j]);
+    NBYTE = (size_t)NROW * SIZE ;
+    STAGE->COL[j] = malloc(NBYTE + SIZE);
+    STAGE->NVAR_STAGE = j+1 ; // so that free_READTABLE_STAGE frees it
+    if ( SIZE == 0 || STAGE->COL[j] == NULL ) { goto READ_FAIL; }
+    if ( fread(STAGE->COL[j], 1, NBYTE, fp) != NBYTE ) { goto READ_FAIL; }
+  }
+
+  fclose(fp);
+  return(1);
+
+ READ_FAIL:
+  fclose(fp);
+  free_READTABLE_STAGE(ISTAGE);
+  printf("\t WARNING: cannot read stage file %s;\n"
+	 "\t          parse TEXT file instead.\n", STAGE->CACHEFILE);
+  fflush(stdout);
+  return(0);
+
+} // end read_stagecache_TEXT
+
+
+// ==============================================
+void write_stagecache_TEXT(int ISTAGE) {
+
+  // Created Oct 2026
+  // Write header and staged columns to binary stage file; see format
+  // in read_stagecache_TEXT. Write temp file and then rename
+  // (open/close_TEMPFILE) so that other jobs never read a partial 
+  // file. If the file cannot be written, give warning and continue.
+
+  READTABLE_STAGE_DEF *STAGE = &READTABLE_STAGE[ISTAGE] ;
+  int    NVAR_TOT   = STAGE->NVAR_TOT ;
+  int    NVAR_STAGE = STAGE->NVAR_STAGE ;
+  int    NROW       = STAGE->NROW ;
+  int    j, NERR = 0 ;
+  size_t NBYTE ;
+  FILE  *fp ;
+  char   tmpFile[MXCHAR_FILENAME+20] ;
+  char fnam[] = "write_stagecache_TEXT" ;
+
+  // ---------- BEGIN ---------
+
+  fp = open_TEMPFILE(STAGE->CACHEFILE, tmpFile);
+  if ( !fp ) { NERR++ ; goto WRITE_DONE ; }
+
+  NBYTE = (size_t)NVAR_TOT * MXCHAR_VARNAME ;
+  if ( fwrite(MAGIC_STAGEFILE_TEXT, 1, 8, fp) != 8 )      { NERR++ ; }
+  if ( fwrite(&NVAR_TOT, sizeof(int), 1, fp) != 1 )       { NERR++ ; }
+  if ( fwrite(STAGE->VARNAME, 1, NBYTE, fp) != NBYTE )    { NERR++ ; }
+  if ( fwrite(STAGE->ICAST_READ, sizeof(int), NVAR_TOT, fp) != 
+       (size_t)NVAR_TOT ) { NERR++ ; }
+  if ( fwrite(&NROW,       sizeof(int), 1, fp) != 1 )     { NERR++ ; }
+  if ( fwrite(&NVAR_STAGE, sizeof(int), 1, fp) != 1 )     { NERR++ ; }
+  if ( fwrite(STAGE->IVAR,  sizeof(int), NVAR_STAGE, fp) != 
+       (size_t)NVAR_STAGE ) { NERR++ ; }
+  if ( fwrite(STAGE->ICAST, sizeof(int), NVAR_STAGE, fp) != 
+       (size_t)NVAR_STAGE ) { NERR++ ; }
+
+  for(j=0; j < NVAR_STAGE; j++ ) {
+    NBYTE = (size_t)NROW * sizeof_ICAST_STAGE(STAGE->ICAST[j]) ;
+    if ( fwrite(STAGE->COL[j], 1, NBYTE, fp) != NBYTE ) { NERR++ ; }
+  }
+
+ WRITE_DONE:
+  if ( close_TEMPFILE(fp, NERR, tmpFile, STAGE->CACHEFILE) == SUCCESS ) {
+    printf("\t Wrote stage file %s \n", STAGE->CACHEFILE);
+  }
+  else {
+    printf("\t WARNING: %s could not write %s \n", 
+	   fnam, STAGE->CACHEFILE);
+  }
+  fflush(stdout);
+
+} // end write_stagecache_TEXT
+
+
+
+
 
 // =========================================
 int validRowKey_TEXT(char *string) {
@@ -203,6 +203,11 @@
 
  May 07, 2019: use MUREF column if it's there (for MUDIF option)
 
+ Oct 2026: codist uses tabulated integral from sntools (DLTAB) for
+           z < DLTAB.ZMAX, so that all SN share one integration for
+           each (OM,w) grid point. CMB redshift still uses simpint.
+           DLTAB.ZMAX = max redshift of data (or z1) + 0.1.
+
 *****************************************************************************/
 
 int compare_double_reverse (const void *, const void *);
@@ -1729,6 +1734,15 @@ void read_fitres(char *inFile) {
   printf(" Done reading file -- NCIDLIST: %d, NSNE_NBIN: %d \n", 
 	 NCIDLIST, NSNE_NBIN);
 
+  // Oct 2026: size DLTAB z-grid for the selected SNe and BAO z1
+  double ZMAX_TAB = z1 ;
+  for(i=0; i < NCIDLIST; i++ ) 
+    { if ( z[i] > ZMAX_TAB ) { ZMAX_TAB = z[i]; } }
+  ZMAX_TAB += 0.1 ;
+  if ( ZMAX_TAB > ZMAX_SNANA ) { ZMAX_TAB = ZMAX_SNANA; }
+  init_DLTAB(ZMAX_TAB, ZBIN_DLTAB);
+  printf(" Tabulate comoving distance for z < %.3f \n", DLTAB.ZMAX );
+
   fflush(stdout);
 
   return ;
@@ -2285,6 +2299,15 @@ double codist(double z, Cosparam *cptr)
 /* Returns dimensionless comoving distance. */
 {
   double zero = 0.0 ;
+  int    islot ;
+
+  // Oct 2026: tabulated integral shared by all SN with same cosmology
+  if ( DLTAB.INIT_FLAG == 0 ) { init_DLTAB(ZMAX_SNANA, ZBIN_DLTAB); }
+  if ( z < DLTAB.ZMAX ) {
+    islot = get_DLTAB(cptr->omm, cptr->ome, cptr->w0, cptr->wa);
+    return chi_DLTAB(islot, z);
+  }
+
   return simpint(one_over_EofZ, zero, z, cptr);
 }
 
@@ -0,0 +1,314 @@
+#!/usr/bin/env python
+#
+# Created Oct 2026
+#
+# Merge the output of 'snlc_sim.exe <inFile> --shard i/N' jobs
+# into a single GENVERSION. Each shard writes
+#    $PATH_SNDATA_SIM/<GENVERSION>_SHARD[i]/
+# and this script creates
+#    $PATH_SNDATA_SIM/<GENVERSION>/
+# with
+#   + FITS format: HEAD & PHOT tables concatenated in shard (CID) order,
+#       with PTROBS_MIN/MAX shifted by the number of PHOT rows in
+#       previous shards. If astropy is not available, or if there
+#       are SPEC files, the shard FITS files are copied and each
+#       HEAD file is listed in the LIST file (as for batch jobs).
+#   + TEXT format: copy all data files and concatenate LIST files.
+#   + DUMP file: header from 1st shard + 'SN:' rows from all shards.
+#   + TIMING file: header from 1st shard + one 'ROW:' per stage with
+#       NCALL and times summed over shards.
+#   + README: README from 1st shard, with SIMSTATS counters and
+#       efficiency summed over all shards.
+#   + empty IGNORE file.
+#
+# Usage:
+#   merge_simShards.py <GENVERSION> <NSHARD> [-p PATH_SNDATA_SIM] [-c]
+#
+#     -p : path for sim output (default = $SNDATA_ROOT/SIM)
+#     -c : clean (remove) shard directories after merge
+#
+# Shard directories are processed in order 1 to NSHARD, and
+# the merge aborts if any shard is missing or has not finished
+# (no SIMSTATS line in README).
+#
+# ====================================
+
+import os
+import sys
+import math
+import shutil
+import argparse
+
+SHARD_FORMAT  = '_SHARD%3.3d'
+KEY_SIMSTATS  = 'SIMSTATS:'
+KEY_END_INIT  = 'END OF SIMULATION SUMMARY'
+
+# ========== BEGIN ===========
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description='Merge snlc_sim.exe --shard jobs into one GENVERSION')
+    parser.add_argument('GENVERSION', help='GENVERSION without _SHARD suffix')
+    parser.add_argument('NSHARD', type=int, help='number of shards')
+    parser.add_argument('-p', '--path', default=None,
+                        help='PATH_SNDATA_SIM (default=$SNDATA_ROOT/SIM)')
+    parser.add_argument('-c', '--clean', action='store_true',
+                        help='remove shard directories after merge')
+    return parser.parse_args()
+
+def abort(msg):
+    print('\n FATAL ERROR: %s' % msg)
+    sys.exit(1)
+
+def get_path_sim(path):
+    # SNDATA_ROOT is needed only for default path
+    if path is not None : return path
+    SNDATA_ROOT = os.environ.get('SNDATA_ROOT')
+    if SNDATA_ROOT is None :
+        abort('SNDATA_ROOT is not set; use -p PATH_SNDATA_SIM')
+    return SNDATA_ROOT + '/SIM'
+
+def read_lines(fileName):
+    with open(fileName,'rt') as f:
+        return f.readlines()
+
+def parse_simstats(readmeFile):
+    # return dictionary of SIMSTATS counters from README file
+    for line in read_lines(readmeFile) :
+        if KEY_SIMSTATS in line :
+            words = line.split(KEY_SIMSTATS)[1].split()
+            return { w.split('=')[0]:int(w.split('=')[1]) for w in words }
+    abort('No %s line in %s (did shard finish ?)' %
+          (KEY_SIMSTATS,readmeFile) )
+
+def geneff(STATS):
+    # same as geneff_calc() in snlc_sim.c
+    N0 = STATS['NGEN'] - STATS['NREJ_GENRANGE']
+    N1 = STATS['NWRITE']
+    if N0 <= 0 : return (0.0, 0.0)
+    EFF   = float(N1)/float(N0)
+    SQERR = float(N1)*float(N0-N1)/float(N0)**3
+    return (EFF, math.sqrt(max(SQERR,0.0)))
+
+def merge_table(shardDirs, shards, outFile, ext, rowKey):
+    # header from 1st shard, then rows (SN: or ROW:) from each shard
+    NROW = 0
+    with open(outFile,'wt') as fout :
+        for ishard, shardDir in enumerate(shardDirs) :
+            tableFile = '%s/%s.%s' % (shardDir,shards[ishard],ext)
+            if not os.path.exists(tableFile) : return 0
+            for line in read_lines(tableFile) :
+                if line.startswith(rowKey) :
+                    fout.write(line) ; NROW += 1
+                elif ishard == 0 :
+                    fout.write(line)
+    return NROW
+
+def merge_timing(shardDirs, shards, outFile):
+    # header from 1st shard, then one ROW per stage (NAME) with
+    # NCALL, TSUM_CPU & TSUM_WALL summed over shards
+    ROWS = {} ; NAMES = [] ; header = []
+    for ishard, shardDir in enumerate(shardDirs) :
+        tableFile = '%s/%s.TIMING' % (shardDir,shards[ishard])
+        if not os.path.exists(tableFile) : return 0
+        for line in read_lines(tableFile) :
+            if line.startswith('ROW:') :
+                words = line.split()
+                NAME  = words[2]
+                SUMS  = [ int(words[3]), float(words[4]), float(words[5]) ]
+                if NAME not in ROWS :
+                    ROWS[NAME] = SUMS ; NAMES.append(NAME)
+                else :
+                    ROWS[NAME] = [ a+b for (a,b) in zip(ROWS[NAME],SUMS) ]
+            elif ishard == 0 :
+                header.append(line)
+
+    with open(outFile,'wt') as fout :
+        fout.writelines(header)
+        for irow, NAME in enumerate(NAMES) :
+            NCALL, TCPU, TWALL = ROWS[NAME]
+            fout.write('ROW: %2d %-20s %9d %10.3f %10.3f \n' %
+                       (irow+1, NAME, NCALL, TCPU, TWALL) )
+    return len(NAMES)
+
+def merge_README(shardDirs, shards, outFile, STATS_SUM):
+    # copy README-init from 1st shard, then summary with summed stats
+    readme0 = '%s/%s.README' % (shardDirs[0],shards[0])
+    with open(outFile,'wt') as fout :
+        for line in read_lines(readme0) :
+            if KEY_END_INIT in line : break
+            fout.write(line)
+
+        EFF, EFFERR = geneff(STATS_SUM)
+        fout.write('\n ============ %s ============== \n' % KEY_END_INIT)
+        fout.write('\n  Merged %d shards with merge_simShards.py \n' %
+                   len(shards) )
+        fout.write('\t Generated %5d simulated light curves \n' %
+                   STATS_SUM['NGEN'])
+        fout.write('\t Wrote     %5d simulated light curves '
+                   'to SNDATA files \n' % STATS_SUM['NWRITE'])
+        if STATS_SUM['NSPEC'] > 0 :
+            fout.write('\t Wrote     %5d simulated spectra '
+                       'to SNDATA files \n' % STATS_SUM['NSPEC'])
+        fout.write('  Rejection Statistics: \n')
+        fout.write('\t %5d rejected by NEPOCH \n' % STATS_SUM['NREJ_NEPOCH'])
+        fout.write('\t %5d rejected by GENRANGE_PEAKMAG \n' %
+                   STATS_SUM['NREJ_GENMAG'])
+        fout.write('\t %5d rejected by GENRANGEs \n' %
+                   STATS_SUM['NREJ_GENRANGE'])
+        fout.write('\t %5d rejected by SEARCH-TRIGGER \n' %
+                   STATS_SUM['NREJ_SEARCH'])
+        fout.write('\t %5d rejected by CUTWIN-SELECTION \n' %
+                   STATS_SUM['NREJ_CUTWIN'])
+        fout.write('  SEARCH+CUTS Efficiency: %7.4f +- %7.4f \n' %
+                   (EFF,EFFERR) )
+        line = '  %s' % KEY_SIMSTATS
+        for key in STATS_SUM : line += ' %s=%d' % (key,STATS_SUM[key])
+        fout.write(line + ' \n')
+
+        # append summary from each shard for reference
+        for ishard, shardDir in enumerate(shardDirs) :
+            readme = '%s/%s.README' % (shardDir,shards[ishard])
+            fout.write('\n ===== SUMMARY FOR %s ===== \n' % shards[ishard])
+            COPY = False
+            for line in read_lines(readme) :
+                if KEY_END_INIT in line : COPY = True ; continue
+                if COPY : fout.write(line)
+
+def list_shard_files(shardDirs, shards):
+    # return list of data files (from LIST file) for each shard
+    fileLists = []
+    for ishard, shardDir in enumerate(shardDirs) :
+        listFile = '%s/%s.LIST' % (shardDir,shards[ishard])
+        fileLists.append( [ l.split()[0] for l in read_lines(listFile)
+                            if len(l.split()) > 0 ] )
+    return fileLists
+
+def copy_shard_files(shardDirs, fileLists, outDir, listFile):
+    # copy data files (and FITS PHOT/SPEC partners) and list them
+    with open(listFile,'wt') as fout :
+        for ishard, shardDir in enumerate(shardDirs) :
+            for f in fileLists[ishard] :
+                partners = [ f ]
+                if f.endswith('_HEAD.FITS') :
+                    base = f[:-len('_HEAD.FITS')]
+                    partners += [ base + '_PHOT.FITS', base + '_SPEC.FITS' ]
+                for p in partners :
+                    if os.path.exists('%s/%s' % (shardDir,p)) :
+                        shutil.copy('%s/%s' % (shardDir,p), outDir)
+                fout.write('%s\n' % f)
+
+def concat_fits(shardDirs, fileLists, outDir, outPrefix, GENVERSION,
+                listFile):
+    # concatenate HEAD and PHOT tables into one HEAD/PHOT pair;
+    # return False if this is not possible so that caller can copy.
+    headFiles = []
+    for ishard, shardDir in enumerate(shardDirs) :
+        for f in fileLists[ishard] :
+            if not f.endswith('_HEAD.FITS') : return False
+            if os.path.exists('%s/%s' % (shardDir, f.replace('_HEAD','_SPEC'))):
+                print('\t Found SPEC file -> copy FITS files instead of concat')
+                return False
+            headFiles.append( '%s/%s' % (shardDir,f) )
+
+    if len(headFiles) == 0 : return False
+
+    try:
+        from astropy.io import fits
+        import numpy as np
+    except ImportError:
+        print('\t astropy not found -> copy FITS files instead of concat')
+        return False
+
+    headOut = '%s_HEAD.FITS' % outPrefix
+    photOut = '%s_PHOT.FITS' % outPrefix
+    headData = [] ; photData = [] ; NROW_PHOT = 0
+    for headFile in headFiles :
+        photFile = headFile.replace('_HEAD.FITS','_PHOT.FITS')
+        with fits.open(headFile) as hh, fits.open(photFile) as hp :
+            head = np.array(hh[1].data)
+            head['PTROBS_MIN'] += NROW_PHOT
+            head['PTROBS_MAX'] += NROW_PHOT
+            headData.append(head)
+            photData.append(np.array(hp[1].data))
+            NROW_PHOT += len(hp[1].data)
+
+    for (fileIn, fileOut, data) in [ (headFiles[0],headOut,headData),
+        (headFiles[0].replace('_HEAD.FITS','_PHOT.FITS'),photOut,photData) ] :
+        with fits.open(fileIn) as hdul :
+            prim = fits.PrimaryHDU(header=hdul[0].header)
+            tbl  = fits.BinTableHDU(data=np.concatenate(data),
+                                    header=hdul[1].header)
+            for hdu in [prim, tbl] :
+                if 'PHOTFILE' in hdu.header : hdu.header['PHOTFILE'] = photOut
+                if 'VERSION'  in hdu.header : hdu.header['VERSION'] = GENVERSION
+            fits.HDUList([prim,tbl]).writeto('%s/%s' % (outDir,fileOut),
+                                             overwrite=True)
+
+    with open(listFile,'wt') as fout : fout.write('%s\n' % headOut)
+    print('\t Concatenated %d HEAD/PHOT files (%d PHOT rows)' %
+          (len(headFiles), NROW_PHOT) )
+    return True
+
+def main():
+    args       = parse_args()
+    GENVERSION = args.GENVERSION
+    NSHARD     = args.NSHARD
+    PATH       = os.path.expandvars(get_path_sim(args.path))
+    outDir     = '%s/%s' % (PATH,GENVERSION)
+
+    shards    = [ GENVERSION + SHARD_FORMAT % i for i in range(1,NSHARD+1) ]
+    shardDirs = [ '%s/%s' % (PATH,s) for s in shards ]
+    for d in shardDirs :
+        if not os.path.isdir(d) : abort('Missing shard directory %s' % d)
+
+    print(' Merge %d shards into %s ' % (NSHARD,outDir) )
+    sys.stdout.flush()
+
+    # sum counters before touching output dir
+    STATS_SUM = None
+    for ishard, shardDir in enumerate(shardDirs) :
+        STATS = parse_simstats('%s/%s.README' % (shardDir,shards[ishard]))
+        if STATS_SUM is None : STATS_SUM = STATS
+        else :
+            for key in STATS_SUM : STATS_SUM[key] += STATS[key]
+
+    if os.path.exists(outDir) : shutil.rmtree(outDir)
+    os.makedirs(outDir)
+
+    listFile  = '%s/%s.LIST' % (outDir,GENVERSION)
+    fileLists = list_shard_files(shardDirs, shards)
+    outPrefix = fileLists[0][0].split(SHARD_FORMAT % 1)[0] \
+                if len(fileLists[0]) > 0 else GENVERSION
+    if not concat_fits(shardDirs, fileLists, outDir, outPrefix,
+                       GENVERSION, listFile) :
+        copy_shard_files(shardDirs, fileLists, outDir, listFile)
+
+    for ext in [ 'DUMP', 'TIMING' ] :
+        outFile = '%s/%s.%s' % (outDir,GENVERSION,ext)
+        if ext == 'DUMP' :
+            NROW = merge_table(shardDirs, shards, outFile, ext, 'SN:')
+        else :
+            NROW = merge_timing(shardDirs, shards, outFile)
+        if NROW > 0 :
+            print('\t Merged %d rows into %s file' % (NROW,ext))
+        elif os.path.exists(outFile) :
+            os.remove(outFile)
+
+    merge_README(shardDirs, shards, '%s/%s.README' % (outDir,GENVERSION),
+                 STATS_SUM)
+    open('%s/%s.IGNORE' % (outDir,GENVERSION),'wt').close()
+
+    EFF, EFFERR = geneff(STATS_SUM)
+    print('\t NGEN=%d  NWRITE=%d  EFF=%.4f +- %.4f ' %
+          (STATS_SUM['NGEN'], STATS_SUM['NWRITE'], EFF, EFFERR) )
+
+    if args.clean :
+        for d in shardDirs : shutil.rmtree(d)
+        print('\t Removed %d shard directories' % NSHARD)
+
+    print(' Done merging %s ' % GENVERSION)
+
+# =========================
+if __name__ == "__main__":
+    main()